@@ -0,0 +1,99 @@
+# Checks that the AVX2 kernels of LowLevelDynamics don't leak VEX code into functions that SSE2 code can link against.
+#
+# The AVX2 translation units (see DySolverAvx2.h) may only export VEX code from Dy::Avx2 or from the aos fma inline
+# namespace. Any other externally visible function of such an object that contains VEX instructions is an out-of-line
+# copy of a shared inline function, which the linker is free to pick for the SSE2 callers as well.
+#
+# Usage: python check_avx2_isolation.py <object files or static libraries>
+#
+# Uses dumpbin on Windows, nm/objdump/c++filt elsewhere. Returns 1 and prints the offending functions if any are found.
+
+import os
+import re
+import subprocess
+import sys
+
+ALLOWED_NAMESPACES = ['Dy::Avx2::', '::fma::']
+
+VEX_INSTRUCTION = re.compile(r'\s(v[a-z][a-z0-9]*)\s|ymm')
+
+
+def run(args):
+    return subprocess.check_output(args, universal_newlines=True)
+
+
+def isVexCode(lines):
+    return any(VEX_INSTRUCTION.search(line) for line in lines)
+
+
+def isAllowed(name):
+    return any(ns in name for ns in ALLOWED_NAMESPACES)
+
+
+# Returns {symbol: demangled name} of the external functions and {symbol: instruction lines} of all functions.
+def readDumpbin(path):
+    external = {}
+    # 008 00000000 SECT3  notype ()    External     | ?solve@Avx2@Dy@physx@@YAXXZ (void __cdecl physx::Dy::Avx2::solve(void))
+    symbolLine = re.compile(r'\bSECT[0-9A-F]+\s+notype \(\)\s+External\s+\|\s+(\S+)\s+\((.*)\)\s*$')
+    for line in run(['dumpbin', '/nologo', '/symbols', path]).splitlines():
+        m = symbolLine.search(line)
+        if m:
+            external[m.group(1)] = m.group(2)
+
+    code = {}
+    current = None
+    for line in run(['dumpbin', '/nologo', '/disasm', path]).splitlines():
+        m = re.match(r'^(\S+):$', line)
+        if m:
+            current = code.setdefault(m.group(1), [])
+        elif current is not None and line.startswith('  '):
+            current.append(line)
+    return external, code
+
+
+def readBinutils(path):
+    external = {}
+    for line in run(['nm', '--defined-only', path]).splitlines():
+        fields = line.split()
+        if len(fields) == 3 and fields[1] in ('T', 'W'):
+            external[fields[2]] = None
+
+    demangled = run(['c++filt'] + list(external.keys())).splitlines() if external else []
+    for symbol, name in zip(list(external.keys()), demangled):
+        external[symbol] = name
+
+    code = {}
+    current = None
+    for line in run(['objdump', '-d', '-M', 'intel', '--no-show-raw-insn', path]).splitlines():
+        m = re.match(r'^[0-9a-f]+ <(\S+)>:$', line)
+        if m:
+            current = code.setdefault(m.group(1), [])
+        elif current is not None and line.startswith(' '):
+            current.append(line)
+    return external, code
+
+
+def main():
+    if len(sys.argv) < 2:
+        print('Usage: check_avx2_isolation.py <object files or static libraries>')
+        return 1
+
+    useDumpbin = sys.platform == 'win32'
+    failures = []
+    for path in sys.argv[1:]:
+        external, code = readDumpbin(path) if useDumpbin else readBinutils(path)
+        for symbol, name in external.items():
+            if not isAllowed(name) and isVexCode(code.get(symbol, [])):
+                failures.append((os.path.basename(path), name))
+
+    for objectName, name in sorted(set(failures)):
+        print('%s: VEX code in %s' % (objectName, name))
+
+    if failures:
+        print('%d externally visible functions outside %s contain VEX code' % (len(set(failures)), ' and '.join(ALLOWED_NAMESPACES)))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
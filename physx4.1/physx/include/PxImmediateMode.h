@@ -36,6 +36,7 @@
 #include "solver/PxSolverDefs.h"
 #include "collision/PxCollisionDefs.h"
 #include "PxArticulationReducedCoordinate.h"
+#include "PxBroadPhase.h"
 
 #if !PX_DOXYGEN
 namespace physx
@@ -659,6 +660,156 @@ namespace immediate
 	*/
 	PX_C_EXPORT PX_PHYSX_CORE_API void PxIntegrateSolverBodiesTGS(PxTGSSolverBodyVel* solverBody, PxTGSSolverBodyTxInertia* txInertia, PxTransform* poses, const PxU32 nbBodiesToIntegrate, const PxReal dt);
 
+	/**
+	\brief Immediate-mode broadphase. This is an opaque handle, see PxCreateImmediateBroadPhase.
+	*/
+	class PxImmediateBroadPhase;
+
+	/**
+	\brief Descriptor for immediate-mode broadphases.
+
+	@see PxCreateImmediateBroadPhase
+	*/
+	struct PxImmediateBroadPhaseDesc
+	{
+		PxImmediateBroadPhaseDesc() :
+			type					(PxBroadPhaseType::eABP),
+			maxNbRegions			(0),
+			maxNbOverlaps			(0),
+			maxNbStaticObjects		(0),
+			maxNbDynamicObjects		(0),
+			discardStaticKinematic	(true),
+			discardKinematicKinematic(true),
+			contextID				(0)
+		{
+		}
+
+		PxBroadPhaseType::Enum	type;						//!< Broadphase algorithm. eGPU is not supported.
+		PxU32					maxNbRegions;				//!< Expected maximum number of regions. Only used by eMBP.
+		PxU32					maxNbOverlaps;				//!< Expected maximum number of overlaps. Only used for preallocation.
+		PxU32					maxNbStaticObjects;			//!< Expected maximum number of static objects. Only used for preallocation.
+		PxU32					maxNbDynamicObjects;		//!< Expected maximum number of dynamic & kinematic objects. Only used for preallocation.
+		bool					discardStaticKinematic;		//!< Do not report static-vs-kinematic pairs. Same as PxPairFilteringMode::eKILL in PxSceneDesc.
+		bool					discardKinematicKinematic;	//!< Do not report kinematic-vs-kinematic pairs. Same as PxPairFilteringMode::eKILL in PxSceneDesc.
+		PxU64					contextID;					//!< Context ID sent to the profiler.
+	};
+
+	/**
+	\brief Type of immediate-mode broadphase objects, used for pair filtering. Static-vs-static pairs are never reported.
+	*/
+	struct PxImmediateBroadPhaseObjectType
+	{
+		enum Enum
+		{
+			eSTATIC,
+			eKINEMATIC,
+			eDYNAMIC
+		};
+	};
+
+	/**
+	\brief Overlap pair reported by immediate-mode broadphases. The ids are the handles returned by PxImmediateBroadPhaseAddBounds, with id0 < id1.
+	*/
+	struct PxImmediateBroadPhasePair
+	{
+		PxU32	id0;
+		PxU32	id1;
+	};
+
+	/**
+	\brief Creates an immediate-mode broadphase, backed by the same broadphase implementations as PxScene.
+
+	The broadphase does not need a PxScene and is single-threaded. It is not thread-safe, but different instances can be used
+	from different threads.
+
+	\param	[in] desc	Broadphase descriptor
+	\return	Broadphase handle, or NULL if the descriptor is invalid
+
+	@see PxReleaseImmediateBroadPhase
+	*/
+	PX_C_EXPORT PX_PHYSX_CORE_API PxImmediateBroadPhase* PxCreateImmediateBroadPhase(const PxImmediateBroadPhaseDesc& desc);
+
+	/**
+	\brief Releases an immediate-mode broadphase.
+	\param	[in] broadPhase	Broadphase handle
+
+	@see PxCreateImmediateBroadPhase
+	*/
+	PX_C_EXPORT PX_PHYSX_CORE_API void PxReleaseImmediateBroadPhase(PxImmediateBroadPhase* broadPhase);
+
+	/**
+	\brief Adds a broadphase region. Only supported by PxBroadPhaseType::eMBP, where objects outside of all regions do not generate pairs.
+
+	Existing objects touching the region are added to it.
+
+	\param	[in] broadPhase	Broadphase handle
+	\param	[in] region		Region data
+	\return	Region handle, or 0xffffffff in case of failure
+
+	@see PxBroadPhaseRegion
+	*/
+	PX_C_EXPORT PX_PHYSX_CORE_API PxU32 PxImmediateBroadPhaseAddRegion(PxImmediateBroadPhase* broadPhase, const PxBroadPhaseRegion& region);
+
+	/**
+	\brief Adds bounds to the broadphase. The object only takes part in overlap tests after the next PxImmediateBroadPhaseUpdate call.
+
+	Dynamic (resp. kinematic) objects with the same group never overlap each other, e.g. the shapes of a same rigid body. The group is ignored for static objects.
+
+	\param	[in] broadPhase			Broadphase handle
+	\param	[in] bounds				World-space bounds
+	\param	[in] type				Object type, used for pair filtering
+	\param	[in] group				Object group, used for pair filtering. Must be smaller than 0x3ffffffe.
+	\param	[in] contactDistance	Bounds are inflated by this distance in all directions
+	\return	Object handle. Handles of removed objects are recycled after the next PxImmediateBroadPhaseUpdate call.
+
+	@see PxImmediateBroadPhaseUpdateBounds PxImmediateBroadPhaseRemoveBounds
+	*/
+	PX_C_EXPORT PX_PHYSX_CORE_API PxU32 PxImmediateBroadPhaseAddBounds(PxImmediateBroadPhase* broadPhase, const PxBounds3& bounds, PxImmediateBroadPhaseObjectType::Enum type, PxU32 group, PxReal contactDistance);
+
+	/**
+	\brief Updates the bounds of an object. Objects whose bounds have not been updated are considered sleeping by the broadphase.
+
+	\param	[in] broadPhase	Broadphase handle
+	\param	[in] handle		Object handle, as returned by PxImmediateBroadPhaseAddBounds
+	\param	[in] bounds		New world-space bounds
+	*/
+	PX_C_EXPORT PX_PHYSX_CORE_API void PxImmediateBroadPhaseUpdateBounds(PxImmediateBroadPhase* broadPhase, PxU32 handle, const PxBounds3& bounds);
+
+	/**
+	\brief Removes an object from the broadphase. Pairs involving this object are dropped without being reported as deleted pairs.
+
+	\param	[in] broadPhase	Broadphase handle
+	\param	[in] handle		Object handle, as returned by PxImmediateBroadPhaseAddBounds
+	*/
+	PX_C_EXPORT PX_PHYSX_CORE_API void PxImmediateBroadPhaseRemoveBounds(PxImmediateBroadPhase* broadPhase, PxU32 handle);
+
+	/**
+	\brief Runs the broadphase on the objects added, updated and removed since the previous call, and computes the created and deleted pairs.
+
+	\param	[in] broadPhase	Broadphase handle
+
+	@see PxImmediateBroadPhaseGetCreatedPairs PxImmediateBroadPhaseGetDeletedPairs
+	*/
+	PX_C_EXPORT PX_PHYSX_CORE_API void PxImmediateBroadPhaseUpdate(PxImmediateBroadPhase* broadPhase);
+
+	/**
+	\brief Retrieves the pairs that started overlapping during the last PxImmediateBroadPhaseUpdate call.
+
+	\param	[in] broadPhase	Broadphase handle
+	\param	[out] pairs		Created pairs. Valid until the next PxImmediateBroadPhaseUpdate call.
+	\return	Number of created pairs
+	*/
+	PX_C_EXPORT PX_PHYSX_CORE_API PxU32 PxImmediateBroadPhaseGetCreatedPairs(PxImmediateBroadPhase* broadPhase, const PxImmediateBroadPhasePair*& pairs);
+
+	/**
+	\brief Retrieves the pairs that stopped overlapping during the last PxImmediateBroadPhaseUpdate call.
+
+	\param	[in] broadPhase	Broadphase handle
+	\param	[out] pairs		Deleted pairs. Valid until the next PxImmediateBroadPhaseUpdate call.
+	\return	Number of deleted pairs
+	*/
+	PX_C_EXPORT PX_PHYSX_CORE_API PxU32 PxImmediateBroadPhaseGetDeletedPairs(PxImmediateBroadPhase* broadPhase, const PxImmediateBroadPhasePair*& pairs);
+
 
 #if !PX_DOXYGEN
 }
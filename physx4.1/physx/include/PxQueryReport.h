@@ -205,6 +205,38 @@ struct PxSweepHit : public PxLocationHit
 };
 
 
+/**
+\brief Stores results of closest shape queries.
+
+position is the point of the shape closest to the query point and distance is the distance between them. normal is the
+direction from position to the query point, and is only set when the query point is outside the shape. For triangle
+meshes and height fields, faceIndex is the index of the closest triangle.
+
+@see PxScene.closestShapes
+*/
+struct PxClosestHit : public PxLocationHit
+{
+	PX_INLINE			PxClosestHit() {}
+
+	PxU32				padTo16Bytes;
+};
+
+
+/**
+\brief Stores results of culling queries.
+
+inside is true when the shape's bounds are fully inside all the culling planes, and false when they cross at least one of them.
+
+@see PxScene.cullShapes
+*/
+struct PxCullHit : public PxQueryHit
+{
+	PX_INLINE			PxCullHit() : inside(false) {}
+
+	bool				inside;
+};
+
+
 /**
 \brief Describes query behavior after returning a partial query result via a callback.
 
@@ -350,6 +382,9 @@ typedef PxHitCallback<PxOverlapHit> PxOverlapCallback;
 /** \brief Sweep query callback. */
 typedef PxHitCallback<PxSweepHit> PxSweepCallback;
 
+/** \brief Culling query callback. */
+typedef PxHitCallback<PxCullHit> PxCullCallback;
+
 /** \brief Raycast query buffer. */
 typedef PxHitBuffer<PxRaycastHit> PxRaycastBuffer;
 
@@ -359,6 +394,9 @@ typedef PxHitBuffer<PxOverlapHit> PxOverlapBuffer;
 /** \brief Sweep query buffer. */
 typedef PxHitBuffer<PxSweepHit> PxSweepBuffer;
 
+/** \brief Culling query buffer. */
+typedef PxHitBuffer<PxCullHit> PxCullBuffer;
+
 /** \brief	Returns touching raycast hits to the user in a fixed size array embedded in the buffer class. **/
 template <int N>
 struct PxRaycastBufferN : public PxHitBuffer<PxRaycastHit>
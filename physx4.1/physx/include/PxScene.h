@@ -54,6 +54,7 @@ class PxRigidDynamic;
 class PxConstraint;
 class PxMaterial;
 class PxSimulationEventCallback;
+struct PxContactReportRecords;
 class PxPhysics;
 class PxBatchQueryDesc;
 class PxBatchQuery;
@@ -63,6 +64,7 @@ class PxRenderBuffer;
 class PxSphereGeometry;
 class PxBoxGeometry;
 class PxCapsuleGeometry;
+class PxPlane;
 
 class PxPruningStructure;
 class PxBVHStructure;
@@ -472,6 +474,69 @@ class PxScene
 	*/
 	virtual PxActor**		getActiveActors(PxU32& nbActorsOut) = 0;
 
+	/**
+	\brief Copies the state of the active actors into user arrays, in the order of getActiveActors().
+
+	This is equivalent to calling getGlobalPose(), getLinearVelocity(), getAngularVelocity() and reading userData for each
+	actor returned by getActiveActors(), at a fraction of the cost. Large copies are split over the worker threads of the
+	scene's CPU dispatcher. The calling thread takes part in the copy, so this can also be called from a task.
+
+	Any of the arrays can be NULL, in which case that property is not written. The arrays must not overlap.
+
+	\note PxSceneFlag::eENABLE_ACTIVE_ACTORS must be set.
+
+	\note Do not use this method while the simulation is running. Calls to this method while the simulation is running will be ignored and 0 will be returned.
+
+	\param[out] globalPoses Receives the global pose of each actor, see PxRigidActor::getGlobalPose().
+	\param[out] linearVelocities Receives the linear velocity of each actor, see PxRigidBody::getLinearVelocity().
+	\param[out] angularVelocities Receives the angular velocity of each actor, see PxRigidBody::getAngularVelocity().
+	\param[out] userData Receives the userData pointer of each actor.
+	\param[in] bufferSize Number of elements of each provided array.
+	\param[in] startIndex Index of the first active actor to retrieve.
+	\return Number of actors written to the arrays.
+
+	@see getActiveActors() PxSceneFlag::eENABLE_ACTIVE_ACTORS
+	*/
+	virtual PxU32			getActiveActorStates(PxTransform* globalPoses, PxVec3* linearVelocities, PxVec3* angularVelocities, void** userData, PxU32 bufferSize, PxU32 startIndex=0) = 0;
+
+	/**
+	\brief Sets the kinematic targets of several actors at once.
+
+	This is equivalent to calling PxRigidDynamic::setKinematicTarget() for each actor, at a fraction of the cost. When the simulation
+	is not running, targets are written straight to the simulation objects, and large batches are split over the worker threads of the
+	scene's CPU dispatcher. Scene query and sleep state updates that cannot be made in parallel run on the calling thread afterwards.
+	While the simulation is running, targets are buffered as with setKinematicTarget().
+
+	\param[in] actors The kinematic actors to move. They must belong to this scene and appear only once.
+	\param[in] targets The target pose of each actor, see PxRigidDynamic::setKinematicTarget().
+	\param[in] nbActors Number of actors and targets.
+
+	@see PxRigidDynamic::setKinematicTarget() setRigidDynamicStates()
+	*/
+	virtual void			setKinematicTargets(PxRigidDynamic*const* actors, const PxTransform* targets, PxU32 nbActors) = 0;
+
+	/**
+	\brief Sets the global poses and velocities of several actors at once.
+
+	This is equivalent to calling PxRigidDynamic::setGlobalPose(), setLinearVelocity() and setAngularVelocity() for each actor, with the
+	same wake up rules, at a fraction of the cost. Any of the arrays can be NULL, in which case that property is not changed. Velocities
+	can only be set on non-kinematic actors.
+
+	When the simulation is not running and PVD is not connected, the new states are written straight to the simulation objects, and
+	large batches are split over the worker threads of the scene's CPU dispatcher. Broad phase, scene query and sleep state updates
+	that cannot be made in parallel run on the calling thread afterwards.
+
+	\param[in] actors The actors to update. They must belong to this scene and appear only once.
+	\param[in] globalPoses The global pose of each actor, or NULL.
+	\param[in] linearVelocities The linear velocity of each actor, or NULL.
+	\param[in] angularVelocities The angular velocity of each actor, or NULL.
+	\param[in] nbActors Number of actors and of elements of each provided array.
+	\param[in] autowake Whether to wake the actors up if they are asleep, see PxRigidDynamic::setGlobalPose().
+
+	@see PxRigidDynamic::setGlobalPose() PxRigidDynamic::setLinearVelocity() PxRigidDynamic::setAngularVelocity() setKinematicTargets()
+	*/
+	virtual void			setRigidDynamicStates(PxRigidDynamic*const* actors, const PxTransform* globalPoses, const PxVec3* linearVelocities, const PxVec3* angularVelocities, PxU32 nbActors, bool autowake = true) = 0;
+
 	/**
 	\brief Returns the number of articulations in the scene.
 
@@ -670,6 +735,34 @@ class PxScene
 	*/
 	virtual PxSimulationEventCallback*	getSimulationEventCallback() const = 0;
 
+	/**
+	\brief Sets caller-provided arrays that receive contact reports as fixed-layout records.
+
+	When set, contact reports are no longer sent through PxSimulationEventCallback::onContact(). They are instead filtered and
+	written to the arrays of the records object during fetchResults() (or flushSimulation() with sendPendingReports set), one
+	record per pair of actors. No PxContactPairHeader or PxContactPair arrays are built for the user. The other
+	PxSimulationEventCallback reports are unaffected. fetchResultsStart() still returns the contact pair headers.
+
+	The records object, and the arrays it points to, must remain valid until it is replaced. It can be modified between
+	simulation steps, for example to change the filters. Pass NULL to go back to PxSimulationEventCallback::onContact().
+
+	\note Do not set the records while the simulation is running. Calls to this method while the simulation is running will be ignored.
+
+	\param[in] records Records object to write contact reports to, or NULL. See #PxContactReportRecords.
+
+	@see PxContactReportRecords getContactReportRecords() PxSimulationEventCallback::onContact()
+	*/
+	virtual void				setContactReportRecords(PxContactReportRecords* records) = 0;
+
+	/**
+	\brief Retrieves the records object set with setContactReportRecords().
+
+	\return The current records object, or NULL. See #PxContactReportRecords.
+
+	@see PxContactReportRecords setContactReportRecords()
+	*/
+	virtual PxContactReportRecords*	getContactReportRecords() const = 0;
+
 	/**
 	\brief Sets a user callback object, which receives callbacks on all contacts generated for specified actors.
 
@@ -1172,6 +1265,87 @@ class PxScene
 	@see PxSimulationStatistics
 	*/
 	virtual	void				getSimulationStatistics(PxSimulationStatistics& stats) const = 0;
+
+	/**
+	\brief Computes a checksum of the dynamic state of the scene.
+
+	The checksum covers the global pose, linear velocity and angular velocity of every rigid dynamic actor and articulation link in the scene.
+	It is bit exact: two scenes that were created and updated the same way, and simulated with PxSceneFlag::eENABLE_ENHANCED_DETERMINISM,
+	return the same checksum whatever their number of worker threads. This makes it cheap to detect diverging simulations every frame,
+	for example in lockstep networking.
+
+	\note Do not use this method while the simulation is running. Calls to this method while the simulation is running will be ignored and return 0.
+
+	\return The checksum of the dynamic state.
+
+	@see PxSceneFlag::eENABLE_ENHANCED_DETERMINISM
+	*/
+	virtual	PxU64				getSimulationStateChecksum() const = 0;
+
+	/**
+	\brief Returns the buffer size needed by saveSimulationState().
+
+	\param[in] baseState A full simulation state of this scene to save a delta against, or NULL to size a full simulation state.
+	When baseState is set, the returned size is an upper bound: the delta only contains the bodies that differ from the base.
+
+	\return The size in bytes.
+
+	@see saveSimulationState()
+	*/
+	virtual	PxU32				getSimulationStateSize(const void* baseState = NULL) const = 0;
+
+	/**
+	\brief Copies the dynamic simulation state of the scene into a user buffer, for later use with restoreSimulationState().
+
+	The state contains, for every rigid dynamic actor: the pose, linear and angular velocities, the wake counter and sleep state,
+	and the sleep and stabilization filters of the solver. It also contains, for every pair of shapes found by the broad phase:
+	the touch state of the pair and, when the pair has a contact manager, the persistent contact manifold or cached contact data of
+	the narrow phase and the friction patches kept by the solver from the last frame, as well as the pairs of bodies that lost touch
+	in the last step and are woken up by the next one. Restoring it puts the bodies back, creates or releases shape pairs so that
+	they match the saved ones, and restores their touch states and the islands they form. Contacts resume warm, instead of
+	starting from empty caches as they do after setGlobalPose() and setLinearVelocity().
+
+	With PxSceneFlag::eENABLE_ENHANCED_DETERMINISM and the rigid body pipeline on the CPU, for both PxSolverType::ePGS and
+	PxSolverType::eTGS, simulating again from a restored state is bit exact with the simulation that followed the save: getSimulationStateChecksum() returns the same values
+	frame after frame, and the same state can be restored any number of times. Without it, the order in which pairs and islands
+	are processed depends on the history of the scene and the results are only close to the original ones.
+
+	When baseState is set, only the bodies and shape pairs that differ from baseState are stored. Bodies that sleep or did not move
+	since baseState was saved, and pairs whose contact data did not change, cost one bit each.
+
+	The state is a raw copy of internal data: it is only valid for this scene, in this process, and for the same PhysX version.
+	It does not include articulations, constraints or contact report state. Contact reports, trigger reports and filter callbacks
+	are not sent again for the pairs a restore creates or releases. No shape may be removed from the scene between the save and
+	the restore, otherwise restoreSimulationState() fails.
+
+	\note Do not use this method while the simulation is running. Calls to this method while the simulation is running will be ignored and return 0.
+	\note Contact data is only saved when the rigid body pipeline runs on the CPU.
+
+	\param[out] buffer The buffer to write the state to. Must be 16-byte aligned.
+	\param[in] bufferSize The size of the buffer in bytes, see getSimulationStateSize().
+	\param[in] baseState A full simulation state of this scene to save a delta against, or NULL to save a full simulation state.
+	\return The number of bytes written, or 0 if the buffer was too small or baseState did not match the scene.
+
+	@see restoreSimulationState() getSimulationStateSize() getSimulationStateChecksum()
+	*/
+	virtual	PxU32				saveSimulationState(void* buffer, PxU32 bufferSize, const void* baseState = NULL) const = 0;
+
+	/**
+	\brief Restores a simulation state written by saveSimulationState().
+
+	The rigid dynamic actors of the scene must be the same, in the same order, as when the state was saved.
+	Scene queries are updated to the restored poses. See saveSimulationState() for what is restored, and for the conditions
+	under which the following simulation steps are bit exact with the ones that followed the save.
+
+	\note Do not use this method while the simulation is running. Calls to this method while the simulation is running will be ignored and return false.
+
+	\param[in] state The simulation state to restore. Must be 16-byte aligned.
+	\param[in] baseState The full simulation state that state was saved against, if state is a delta. NULL otherwise.
+	\return True if the state was restored, false if it does not match the scene or if a shape was removed since it was saved.
+
+	@see saveSimulationState()
+	*/
+	virtual	bool				restoreSimulationState(const void* state, const void* baseState = NULL) = 0;
 	
 	
 	//@}
@@ -1242,6 +1416,36 @@ class PxScene
 	*/
 	virtual PxU32				getDynamicTreeRebuildRateHint() const = 0;
 
+	/**
+	\brief Sets a time budget for the rebuild of the dynamic tree pruning structures.
+
+	By default the new trees are built a fixed number of steps per frame, paced by the rebuild rate hint, inside fetchResults().
+	With a time budget, the build steps run instead on a worker thread of the scene's CPU dispatcher, concurrently with the
+	simulation: starting with simulate(), the new trees are built for up to the given time per frame. The steps are joined in
+	fetchResults(), and the new trees are switched in when they are committed, as before. Queries keep using the current trees
+	until then.
+
+	The rebuild is paced by time instead of steps, so a rebuild takes as many frames as the budget requires, regardless of the
+	rebuild rate hint. The time budget is not used when scene query update mode is eBUILD_DISABLED_COMMIT_DISABLED, in which
+	case the trees are built by sceneQueriesUpdate().
+
+	\param[in] budget	Time budget per frame and per tree, in microseconds. 0 to disable it and use the rebuild rate hint.
+
+	<b>Default:</b> 0
+
+	@see getDynamicTreeRebuildTimeBudget() setDynamicTreeRebuildRateHint() PxPruningStructureType::eDYNAMIC_AABB_TREE
+	*/
+	virtual	void				setDynamicTreeRebuildTimeBudget(PxU32 budget) = 0;
+
+	/**
+	\brief Retrieves the time budget for the rebuild of the dynamic tree pruning structures.
+
+	\return The time budget per frame and per tree, in microseconds. 0 if the rebuild is paced by the rebuild rate hint.
+
+	@see setDynamicTreeRebuildTimeBudget()
+	*/
+	virtual	PxU32				getDynamicTreeRebuildTimeBudget() const = 0;
+
 	/**
 	\brief Forces dynamic trees to be immediately rebuilt.
 
@@ -1341,6 +1545,45 @@ class PxScene
 									const PxQueryFilterData& filterData = PxQueryFilterData(), PxQueryFilterCallback* filterCall = NULL,
 									const PxQueryCache* cache = NULL) const = 0;
 
+	/**
+	\brief Performs a set of raycasts against objects in the scene, returns results in one PxRaycastBuffer object per ray.
+
+	Consecutive rays are grouped in packets of up to 16 rays, and the rays of a packet are traversed together through the scene
+	query structures when their directions are similar, e.g. rays shot from the same location towards the same area. Packets of
+	incoherent rays are automatically raycast one ray at a time.
+
+	Each ray finds the same blocking hit distance and the same set of touching hits as with #raycast(). Shapes are however not
+	visited in the same order, since a packet is traversed along the average direction of its rays. Results that depend on the
+	visit order can therefore differ from #raycast():
+	\li with PxQueryFlag::eANY_HIT, the reported hit can be another shape touched by the ray,
+	\li when a hit buffer has no room left for the touching hits, the subset of touches it keeps can differ,
+	\li among blocking hits at exactly the same distance, another shape can be reported,
+	\li among triangles of a mesh hit at exactly the same distance, another triangle can be reported.
+
+	\note	Touching hits are not ordered.
+	\note	Rays are not traversed together if PVD scene query recording is enabled.
+	\note	The rays of a packet are also traversed together through the midphase of triangle meshes using PxMeshMidPhase::eBVH34,
+			unless PxHitFlag::eMESH_MULTIPLE or PxHitFlag::eMESH_ANY is used. The narrow phase against other shapes is performed
+			one ray at a time.
+
+	\param[in] nbRays		Number of rays.
+	\param[in] origins		Origins of the rays.
+	\param[in] unitDirs		Normalized directions of the rays.
+	\param[in] distances	Lengths of the rays. Have to be in the [0, inf) range.
+	\param[out] hitBuffers	Raycast hit buffers, one per ray.
+	\param[in] hitFlags		Specifies which properties per hit should be computed and returned in the hit buffers.
+	\param[in] filterData	Filtering data passed to the filter shader. See #PxQueryFilterData
+	\param[in] filterCall	Custom filtering logic (optional). Only used if the corresponding #PxQueryFlag flags are set. If NULL, all hits are assumed to be blocking.
+
+	\return The number of rays for which touching or blocking hits were found, or any hit was found in case PxQueryFlag::eANY_HIT was specified.
+
+	@see raycast PxRaycastBuffer PxQueryFilterData PxQueryFilterCallback PxRaycastHit PxQueryFlag PxQueryFlag::eANY_HIT
+	*/
+	virtual PxU32				raycastPacket(
+									PxU32 nbRays, const PxVec3* origins, const PxVec3* unitDirs, const PxReal* distances,
+									PxRaycastBuffer* hitBuffers, PxHitFlags hitFlags = PxHitFlags(PxHitFlag::eDEFAULT),
+									const PxQueryFilterData& filterData = PxQueryFilterData(), PxQueryFilterCallback* filterCall = NULL) const = 0;
+
 	/**
 	\brief Performs a sweep test against objects in the scene, returns results in a PxSweepBuffer object
 	or via a custom user callback implementation inheriting from PxSweepCallback.
@@ -1397,6 +1640,59 @@ class PxScene
 									const PxQueryFilterData& filterData = PxQueryFilterData(), PxQueryFilterCallback* filterCall = NULL
 									) const = 0;
 
+	/**
+	\brief Finds the shapes closest to a point, up to a maximum distance.
+
+	The scene query structures are traversed by increasing distance to the point, and the search distance shrinks to the distance
+	of the farthest kept shape once maxNbHits shapes have been found, so that most of the scene is never visited.
+	Distances are exact: closest points are computed on the shapes themselves, and on the triangles of meshes and height fields.
+	A shape containing the point is at distance zero (triangle meshes and height fields are treated as surfaces).
+
+	\note	Hits are sorted by increasing distance.
+	\note	Filtering: shapes for which the pre or post filter returns PxQueryHitType::eNONE are skipped, eTOUCH and eBLOCK are treated the same.
+			The PxQueryFlag::eANY_HIT and PxQueryFlag::eNO_BLOCK flags are ignored.
+
+	\param[in] point		The query point.
+	\param[in] maxDistance	Maximum distance from the point to the reported shapes. Has to be in the [0, inf) range.
+	\param[out] hits		Hit buffer, receives the closest shapes.
+	\param[in] maxNbHits	Size of the hit buffer, i.e. maximum number of shapes to find.
+	\param[in] filterData	Filtering data and simple logic. See #PxQueryFilterData #PxQueryFilterCallback
+	\param[in] filterCall	Custom filtering logic (optional). Only used if the corresponding #PxQueryFlag flags are set.
+
+	\return The number of hits written to the hit buffer.
+
+	@see PxClosestHit PxQueryFilterData PxQueryFilterCallback PxGeometryQuery.pointDistance
+	*/
+	virtual PxU32				closestShapes(const PxVec3& point, PxReal maxDistance, PxClosestHit* hits, PxU32 maxNbHits,
+									const PxQueryFilterData& filterData = PxQueryFilterData(), PxQueryFilterCallback* filterCall = NULL) const = 0;
+
+	/**
+	\brief Finds the shapes visible from a convex set of planes, e.g. the 6 planes of a view frustum.
+
+	A shape is reported when its scene query bounds are not fully outside any of the planes, along with whether they are fully
+	inside all of them or cross at least one. The point p is inside a plane when plane.distance(p) <= 0, i.e. the plane normals
+	point out of the culling volume. The scene query structures are traversed with the planes, and subtrees whose bounds are
+	fully inside are reported without testing their shapes.
+
+	\note	The classification uses the bounds stored in the scene query structures, not the shapes' geometries. Shapes crossing a
+			plane can be reported as visible even though only their bounds reach into the culling volume.
+	\note	Touches are not sorted. Shapes for which the pre or post filter returns PxQueryHitType::eNONE are skipped, eTOUCH and
+			eBLOCK are treated the same and all hits are reported as touches. With PxQueryFlag::eANY_HIT, or if hitCall has no touch
+			buffer, the first hit found is returned as the blocking hit and the query stops.
+
+	\param[in] nbPlanes		Number of culling planes, between 1 and 32.
+	\param[in] planes		The culling planes.
+	\param[out] hitCall		Cull hit buffer or callback object used to report the visible shapes.
+	\param[in] filterData	Filtering data and simple logic. See #PxQueryFilterData #PxQueryFilterCallback
+	\param[in] filterCall	Custom filtering logic (optional). Only used if the corresponding #PxQueryFlag flags are set.
+
+	\return True if any shape was found.
+
+	@see PxCullHit PxCullCallback PxCullBuffer PxQueryFilterData PxQueryFilterCallback
+	*/
+	virtual bool				cullShapes(PxU32 nbPlanes, const PxPlane* planes, PxCullCallback& hitCall,
+									const PxQueryFilterData& filterData = PxQueryFilterData(), PxQueryFilterCallback* filterCall = NULL) const = 0;
+
 
 	/**
 	\brief Retrieves the scene's internal scene query timestamp, increased each time a change to the
@@ -66,6 +66,12 @@ objects, if no static objects are added, moved or removed after the scene has be
 created. If there is no such guarantee (e.g. when streaming parts of the world in and out),
 then the dynamic version is a better choice even for static objects.
 
+eWIDE_AABB_TREE uses a 4-wide AABB tree with quantized bounds, where all the children of a node
+are tested at once using SIMD instructions. It is usually faster to query and smaller than the
+other trees. Like the static AABB tree it is fully rebuilt when objects are added or removed,
+but it is refit when objects move. It is a good choice for static objects, and for dynamic
+objects that are rarely added or removed.
+
 */
 struct PxPruningStructureType
 {
@@ -74,6 +80,7 @@ struct PxPruningStructureType
 		eNONE,					//!< Using a simple data structure
 		eDYNAMIC_AABB_TREE,		//!< Using a dynamic AABB tree
 		eSTATIC_AABB_TREE,		//!< Using a static AABB tree
+		eWIDE_AABB_TREE,		//!< Using a 4-wide AABB tree with quantized bounds
 
 		eLAST
 	};
@@ -323,6 +330,9 @@ struct PxSceneFlag
 		with the existing actors in the scene. Determinism is only guaranteed if the actors are inserted in a consistent order each run in a newly-created scene and simulated using a consistent time-stepping
 		scheme.
 
+		The simulation results also do not depend on the number of worker threads of the CPU dispatcher, nor on the SIMD instruction sets supported by the CPU, so that
+		the same scene simulated on machines with different core counts stays bit-identical. PxScene::getSimulationStateChecksum() can be used to verify this every frame.
+
 		Note that this flag is not mutable and must be set at scene creation.
 
 		Note that enabling this flag can have a negative impact on performance.
@@ -349,6 +359,24 @@ struct PxSceneFlag
 		*/
 		eENABLE_FRICTION_EVERY_ITERATION = (1 << 15),
 
+		/**
+		\brief Assigns the constraints of large islands to solver partitions over the worker threads.
+
+		By default, the constraints of an island are assigned to partitions serially, before the island can be solved in parallel.
+		For very large islands, e.g. a collapsing building, this can become a bottleneck. This flag assigns them in parallel
+		instead, for rigid body islands with more than a few thousand constraints.
+
+		The partitions differ from the default ones, so the simulation results differ from a simulation without this flag. They
+		remain deterministic, and do not depend on the number of worker threads.
+
+		Note that this flag is not mutable and must be set at scene creation.
+
+		Note that this flag has no effect on islands with articulations, nor with GPU dynamics.
+
+		<b>Default</b> false
+		*/
+		eENABLE_PARALLEL_PARTITIONING = (1 << 16),
+
 		eMUTABLE_FLAGS = eENABLE_ACTIVE_ACTORS|eEXCLUDE_KINEMATICS_FROM_ACTIVE_ACTORS
 	};
 };
@@ -689,7 +717,7 @@ public:
 	/**
 	\brief Defines the structure used to store static objects.
 
-	\note Only PxPruningStructureType::eSTATIC_AABB_TREE and PxPruningStructureType::eDYNAMIC_AABB_TREE are allowed here.
+	\note Only PxPruningStructureType::eSTATIC_AABB_TREE, PxPruningStructureType::eDYNAMIC_AABB_TREE and PxPruningStructureType::eWIDE_AABB_TREE are allowed here.
 	*/
 	PxPruningStructureType::Enum	staticStructure;
 
@@ -1020,7 +1048,7 @@ PX_INLINE bool PxSceneDesc::isValid() const
 	if(!limits.isValid())
 		return false;
 
-	if(staticStructure!=PxPruningStructureType::eSTATIC_AABB_TREE && staticStructure!=PxPruningStructureType::eDYNAMIC_AABB_TREE)
+	if(staticStructure!=PxPruningStructureType::eSTATIC_AABB_TREE && staticStructure!=PxPruningStructureType::eDYNAMIC_AABB_TREE && staticStructure!=PxPruningStructureType::eWIDE_AABB_TREE)
 		return false;
 
 	if(dynamicTreeRebuildRateHint < 4)
@@ -774,6 +774,53 @@ struct PxConstraintInfo
 };
 
 
+/**
+\brief Caller-provided arrays that receive contact reports as fixed-layout records, see PxScene::setContactReportRecords().
+
+Contact reports are normally sent through PxSimulationEventCallback::onContact(). When a PxContactReportRecords object is set on the
+scene, they are instead written to the arrays below during PxScene::fetchResults(), as one record per pair of actors. Record i is made of
+element i of each array. Any array can be NULL, in which case that property is not written.
+
+Which pairs are reported, and with which events, is still defined by the pair flags returned by the simulation filter shader. The contact
+point, normal and impulse are only available for pairs with PxPairFlag::eNOTIFY_CONTACT_POINTS, and the impulse only with
+PxPairFlag::eSOLVE_CONTACT. They are zero otherwise, and for pairs that only lost touch.
+
+@see PxScene::setContactReportRecords() PxSimulationEventCallback::onContact()
+*/
+struct PxContactReportRecords
+{
+	PxContactReportRecords() :
+		actors0			(NULL),
+		actors1			(NULL),
+		points			(NULL),
+		normals			(NULL),
+		impulses		(NULL),
+		events			(NULL),
+		maxNbRecords	(0),
+		eventMask		(PxPairFlag::eNOTIFY_TOUCH_FOUND | PxPairFlag::eNOTIFY_TOUCH_PERSISTS | PxPairFlag::eNOTIFY_TOUCH_LOST | PxPairFlag::eNOTIFY_TOUCH_CCD |
+						 PxPairFlag::eNOTIFY_THRESHOLD_FORCE_FOUND | PxPairFlag::eNOTIFY_THRESHOLD_FORCE_PERSISTS | PxPairFlag::eNOTIFY_THRESHOLD_FORCE_LOST),
+		minImpulse		(0.0f),
+		nbRecords		(0),
+		nbDroppedRecords(0)
+	{
+	}
+
+	PxActor**		actors0;		//!< First actor of each pair. NULL if the actor has been removed from the scene.
+	PxActor**		actors1;		//!< Second actor of each pair. NULL if the actor has been removed from the scene.
+	PxVec3*			points;			//!< Contact point, averaged over the contacts of the pair and weighted by their impulses. Plain average if the impulses sum to zero.
+	PxVec3*			normals;		//!< Contact normal of the contact with the largest impulse, or of the first contact. Points from the second actor to the first.
+	PxReal*			impulses;		//!< Sum of the contact impulses of the pair, along the contact normals.
+	PxU16*			events;			//!< Events of the pair, combination of the event bits of #PxPairFlag.
+	PxU32			maxNbRecords;	//!< Number of elements of each array.
+
+	PxPairFlags		eventMask;		//!< Only pairs with one of these events are written.
+	PxReal			minImpulse;		//!< Only pairs with an impulse sum of at least this value are written.
+
+	PxU32			nbRecords;		//!< Written by the SDK: number of records written during the last fetchResults().
+	PxU32			nbDroppedRecords;	//!< Written by the SDK: number of records that passed the filters but did not fit in the arrays.
+};
+
+
 /**
 \brief An interface class that the user can implement in order to receive simulation events.
 
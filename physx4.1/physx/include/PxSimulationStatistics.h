@@ -271,9 +271,36 @@ public:
 
 	/**
 	\brief Number of partitions used by the solver this frame
+
+	\note This is the largest number of partitions of the islands simulated this frame.
 	*/
 	PxU32	nbPartitions;
 
+	/**
+	\brief Time spent partitioning the solver constraints this frame, in milliseconds
+
+	\note Summed over all island batches. Different batches are partitioned concurrently, so this can exceed the elapsed time.
+	\note Within a batch, the assignment of constraints to partitions is serial. Only the write of the partitioned constraints
+	of large islands is spread over the worker threads.
+	*/
+	PxReal	partitionTime;
+
+	/**
+	\brief Number of CCD passes that swept fast-moving pairs this frame
+
+	\note At most PxSceneDesc::ccdMaxPasses. Passes skipped because there was nothing left to sweep are not counted.
+
+	@see PxSceneFlag::eENABLE_CCD
+	*/
+	PxU32	nbCCDPasses;
+
+	/**
+	\brief Number of CCD pairs advanced to their time of impact this frame, summed over all CCD passes
+
+	\note The number of CCD pairs processed is reported per geometry type, see getRbPairStats() with eCCD_PAIRS.
+	*/
+	PxU32	nbCCDHits;
+
 	PxSimulationStatistics() :
 		nbActiveConstraints					(0),
 		nbActiveDynamicBodies				(0),
@@ -294,7 +321,10 @@ public:
 		nbLostPairs							(0),
 		nbNewTouches						(0),
 		nbLostTouches						(0),
-		nbPartitions						(0)
+		nbPartitions						(0),
+		partitionTime						(0.0f),
+		nbCCDPasses							(0),
+		nbCCDHits							(0)
 	{
 		nbBroadPhaseAdds = 0;
 		nbBroadPhaseRemoves = 0;
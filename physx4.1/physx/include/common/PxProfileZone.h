@@ -31,7 +31,8 @@
 #include "foundation/PxProfiler.h"
 #include "PxFoundation.h"
 
-#if PX_DEBUG || PX_CHECKED || PX_PROFILE
+// PX_PROFILE_ZONES keeps the zones in release builds, see the PX_PROFILE_ZONES_IN_RELEASE CMake option.
+#if PX_DEBUG || PX_CHECKED || PX_PROFILE || PX_PROFILE_ZONES
 	#define PX_PROFILE_ZONE(x, y)										\
 		physx::PxProfileScoped PX_CONCAT(_scoped, __LINE__)(PxGetProfilerCallback(), x, false, y)
 	#define PX_PROFILE_START_CROSSTHREAD(x, y)							\
@@ -0,0 +1,184 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef PX_BATCH_QUERY_EXT_H
+#define PX_BATCH_QUERY_EXT_H
+/** \addtogroup extensions
+@{
+*/
+
+#include "PxPhysXConfig.h"
+#include "PxScene.h"
+
+#if !PX_DOXYGEN
+namespace physx
+{
+#endif
+
+	class PxCpuDispatcher;
+
+	/**
+	\brief Multithreaded batched scene queries.
+
+	Queries are recorded with raycast(), sweep() and overlap(), then all run at once with execute(), spread over the worker threads
+	of a CPU dispatcher. Unlike PxBatchQuery, which runs its queries on the calling thread, this is built on top of the regular
+	PxScene queries, which can run concurrently.
+
+	All memory is allocated when the object is created. Each recorded query gets its own result buffer, and its touching hits are
+	written to a range of the batch's touch buffer reserved when the query is recorded, so threads never share results and no locks
+	are needed.
+
+	Results are the same as running the queries one after the other with the PxScene functions, except for raycasts cast as packets,
+	whose order-dependent results can differ as described in PxScene::raycastPacket.
+
+	\note The scene must not be modified during execute().
+	\note The filter callback is called from the worker threads and must be thread-safe.
+
+	@see PxCreateBatchQueryExt PxScene::raycast PxScene::sweep PxScene::overlap
+	*/
+	class PxBatchQueryExt
+	{
+	public:
+
+		/**
+		\brief Records a raycast.
+
+		\param[in] origin		Origin of the ray.
+		\param[in] unitDir		Normalized direction of the ray.
+		\param[in] distance		Length of the ray.
+		\param[in] maxNbTouches	Number of touching hits to reserve for the query in the raycast touch buffer. 0 to only report a blocking hit.
+		\param[in] hitFlags		Specifies which properties per hit should be computed and returned.
+		\param[in] filterData	Filtering data and simple logic.
+		\param[in] cache		Cached hit shape (optional). The cache is copied, it doesn't need to persist until execute().
+
+		\return Buffer receiving the results of the raycast when execute() is called, or NULL if the batch is full. The buffer is
+		valid until reset() or release() is called.
+
+		@see PxScene::raycast
+		*/
+		virtual	PxRaycastBuffer*	raycast(const PxVec3& origin, const PxVec3& unitDir, PxReal distance, PxU32 maxNbTouches = 0,
+										PxHitFlags hitFlags = PxHitFlags(PxHitFlag::eDEFAULT),
+										const PxQueryFilterData& filterData = PxQueryFilterData(), const PxQueryCache* cache = NULL) = 0;
+
+		/**
+		\brief Records a sweep.
+
+		\param[in] geometry		Geometry of object to sweep (supported types are: box, sphere, capsule, convex). The geometry is copied.
+		\param[in] pose			Pose of the sweep object.
+		\param[in] unitDir		Normalized direction of the sweep.
+		\param[in] distance		Sweep distance.
+		\param[in] maxNbTouches	Number of touching hits to reserve for the query in the sweep touch buffer. 0 to only report a blocking hit.
+		\param[in] hitFlags		Specifies which properties per hit should be computed and returned.
+		\param[in] filterData	Filtering data and simple logic.
+		\param[in] cache		Cached hit shape (optional). The cache is copied, it doesn't need to persist until execute().
+		\param[in] inflation	Skin around the swept geometry, see PxScene::sweep.
+
+		\return Buffer receiving the results of the sweep when execute() is called, or NULL if the batch is full. The buffer is
+		valid until reset() or release() is called.
+
+		@see PxScene::sweep
+		*/
+		virtual	PxSweepBuffer*		sweep(const PxGeometry& geometry, const PxTransform& pose, const PxVec3& unitDir, PxReal distance,
+										PxU32 maxNbTouches = 0, PxHitFlags hitFlags = PxHitFlags(PxHitFlag::eDEFAULT),
+										const PxQueryFilterData& filterData = PxQueryFilterData(), const PxQueryCache* cache = NULL,
+										PxReal inflation = 0.0f) = 0;
+
+		/**
+		\brief Records an overlap.
+
+		\param[in] geometry		Geometry of object to check for overlap (supported types are: box, sphere, capsule, convex). The geometry is copied.
+		\param[in] pose			Pose of the object.
+		\param[in] maxNbTouches	Number of touching hits to reserve for the query in the overlap touch buffer. 0 to only report a blocking hit.
+		\param[in] filterData	Filtering data and simple logic.
+
+		\return Buffer receiving the results of the overlap when execute() is called, or NULL if the batch is full. The buffer is
+		valid until reset() or release() is called.
+
+		@see PxScene::overlap
+		*/
+		virtual	PxOverlapBuffer*	overlap(const PxGeometry& geometry, const PxTransform& pose, PxU32 maxNbTouches = 0,
+										const PxQueryFilterData& filterData = PxQueryFilterData()) = 0;
+
+		/**
+		\brief Runs all recorded queries and writes their results to the buffers returned when they were recorded.
+
+		Queries are split in chunks processed by the calling thread and by the worker threads of the dispatcher. Small batches run on
+		the calling thread only. Consecutive raycasts with the same hit flags and filter data and no cache are cast as packets, see
+		PxScene::raycastPacket.
+
+		If the scene uses PxSceneFlag::eREQUIRE_RW_LOCK, the queries run on the calling thread, which must hold the scene's read lock.
+
+		The queries are kept, so that the batch can be executed again after the scene changed. Call reset() to record new queries.
+
+		\param[in] dispatcher	Dispatcher whose worker threads run the queries. NULL to use the scene's dispatcher. With a
+								PxTaskManager, pass PxTaskManager::getCpuDispatcher().
+		*/
+		virtual	void				execute(PxCpuDispatcher* dispatcher = NULL) = 0;
+
+		/**
+		\brief Removes all recorded queries. The result buffers returned so far become invalid.
+		*/
+		virtual	void				reset() = 0;
+
+		/**
+		\brief Releases the batch and its buffers.
+		*/
+		virtual	void				release() = 0;
+
+	protected:
+		virtual						~PxBatchQueryExt()	{}
+	};
+
+	/**
+	\brief Creates a multithreaded batch query.
+
+	\param[in] scene				Scene to run the queries against.
+	\param[in] filterCall			Custom filtering logic (optional), used by all queries of the batch. Must be thread-safe.
+	\param[in] maxNbRaycasts		Maximum number of raycasts recorded between two reset() calls.
+	\param[in] maxNbRaycastTouches	Size of the touch buffer shared by all raycasts.
+	\param[in] maxNbSweeps			Maximum number of sweeps recorded between two reset() calls.
+	\param[in] maxNbSweepTouches	Size of the touch buffer shared by all sweeps.
+	\param[in] maxNbOverlaps		Maximum number of overlaps recorded between two reset() calls.
+	\param[in] maxNbOverlapTouches	Size of the touch buffer shared by all overlaps.
+
+	\return The new batch query, or NULL in case of failure.
+
+	@see PxBatchQueryExt
+	*/
+	PxBatchQueryExt*	PxCreateBatchQueryExt(PxScene& scene, PxQueryFilterCallback* filterCall,
+							PxU32 maxNbRaycasts, PxU32 maxNbRaycastTouches,
+							PxU32 maxNbSweeps, PxU32 maxNbSweepTouches,
+							PxU32 maxNbOverlaps, PxU32 maxNbOverlapTouches);
+
+#if !PX_DOXYGEN
+} // namespace physx
+#endif
+
+/** @} */
+#endif
@@ -77,18 +77,43 @@ public:
 };
 
 
+/**
+\brief Scheduling strategy used by the default dispatcher.
+
+@see PxDefaultCpuDispatcherCreate()
+*/
+struct PxDefaultCpuDispatcherMode
+{
+	enum Enum
+	{
+		/**
+		\brief All workers pull tasks from one shared queue and are woken up together when work is submitted.
+		*/
+		eSHARED_QUEUE,
+
+		/**
+		\brief Each worker owns a work-stealing deque. Tasks spawned on a worker stay on its deque, idle workers
+		steal from random victims and park individually, so a submission wakes at most one worker.
+
+		\note Preferable with many worker threads, where the shared queue and group wake-ups become contended.
+		*/
+		eWORK_STEALING
+	};
+};
+
 /**
 \brief Create default dispatcher, extensions SDK needs to be initialized first.
 
 \param[in] numThreads Number of worker threads the dispatcher should use.
 \param[in] affinityMasks Array with affinity mask for each thread. If not defined, default masks will be used.
+\param[in] mode Scheduling strategy of the dispatcher. See #PxDefaultCpuDispatcherMode.
 
 \note numThreads may be zero in which case no worker thread are initialized and
 simulation tasks will be executed on the thread that calls PxScene::simulate()
 
-@see PxDefaultCpuDispatcher
+@see PxDefaultCpuDispatcher PxDefaultCpuDispatcherMode
 */
-PxDefaultCpuDispatcher* PxDefaultCpuDispatcherCreate(PxU32 numThreads, PxU32* affinityMasks = NULL);
+PxDefaultCpuDispatcher* PxDefaultCpuDispatcherCreate(PxU32 numThreads, PxU32* affinityMasks = NULL, PxDefaultCpuDispatcherMode::Enum mode = PxDefaultCpuDispatcherMode::eSHARED_QUEUE);
 
 #if !PX_DOXYGEN
 } // namespace physx
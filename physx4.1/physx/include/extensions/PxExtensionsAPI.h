@@ -59,6 +59,8 @@
 #include "extensions/PxBroadPhaseExt.h"
 #include "extensions/PxMassProperties.h"
 #include "extensions/PxSceneQueryExt.h"
+#include "extensions/PxBatchQueryExt.h"
+#include "extensions/PxProfileTraceRecorder.h"
 
 /** \brief Initialize the PhysXExtensions library. 
 
@@ -0,0 +1,117 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef PX_PHYSICS_EXTENSIONS_PROFILE_TRACE_RECORDER_H
+#define PX_PHYSICS_EXTENSIONS_PROFILE_TRACE_RECORDER_H
+/** \addtogroup extensions
+  @{
+*/
+
+#include "common/PxPhysXCommonConfig.h"
+#include "foundation/PxProfiler.h"
+
+#if !PX_DOXYGEN
+namespace physx
+{
+#endif
+
+class PxOutputStream;
+
+/**
+\brief A low-overhead profiler callback that records PX_PROFILE_ZONE events into per-thread ring buffers.
+
+Each thread that emits profile events gets its own fixed-size ring buffer the first time it records an event.
+Recording an event takes no lock: the recording thread writes into its own buffer and publishes the new
+write position. Once a buffer is full the oldest events are overwritten, so the recorder can stay installed
+permanently and the most recent activity can be written out at any time, for example when a frame spike is
+detected.
+
+Register the recorder with PxSetProfilerCallback(). The SDK only emits profile zones in debug, checked and
+profile builds, or in release builds generated with the PX_PROFILE_ZONES_IN_RELEASE CMake option.
+
+@see PxProfileTraceRecorderCreate() PxSetProfilerCallback()
+*/
+class PxProfileTraceRecorder : public PxProfilerCallback
+{
+public:
+	/**
+	\brief Marks the beginning of a new frame.
+
+	Frame markers delimit the range written by writeChromeTrace(). Call this once per frame from the thread
+	driving the simulation, for example right before PxScene::simulate().
+	*/
+	virtual	void	markFrame() = 0;
+
+	/**
+	\brief Returns the number of frames marked so far.
+	*/
+	virtual	PxU32	getNbFrames() const = 0;
+
+	/**
+	\brief Writes the events of the last frames in the Chrome trace event format.
+
+	The output is a JSON file that can be loaded in chrome://tracing or in the Perfetto UI. It can be called
+	while other threads keep recording: events overwritten during the call are skipped.
+
+	\param[in] stream		The stream to write the JSON text to.
+	\param[in] nbFrames		Number of frames to write, counted back from the last frame marker. Events recorded after
+							the last marker are always included. Zero writes everything still held in the buffers.
+	\return False if the stream failed, true otherwise.
+	*/
+	virtual	bool	writeChromeTrace(PxOutputStream& stream, PxU32 nbFrames) = 0;
+
+	/**
+	\brief Deletes the recorder and its buffers.
+
+	The recorder must not be registered as profiler callback anymore, and no thread may be recording events.
+	*/
+	virtual	void	release() = 0;
+
+protected:
+	virtual	~PxProfileTraceRecorder()	{}
+};
+
+/**
+\brief Creates a profile trace recorder.
+
+\param[in] maxNbEventsPerThread	Capacity of each per-thread ring buffer, in events. Rounded up to a power of two. Each event
+								uses 32 bytes.
+\param[in] maxNbFrames			Number of frame markers kept by the recorder.
+\return The new recorder.
+
+@see PxProfileTraceRecorder
+*/
+PxProfileTraceRecorder* PxProfileTraceRecorderCreate(PxU32 maxNbEventsPerThread = 65536, PxU32 maxNbFrames = 64);
+
+#if !PX_DOXYGEN
+} // namespace physx
+#endif
+
+/** @} */
+#endif
@@ -44,6 +44,7 @@ namespace physx
 	class PxScene;
 	class PxShape;
 	class PxRigidDynamic;
+	class PxCpuDispatcher;
 	class RaycastCCDManagerInternal;
 
 	/**
@@ -88,6 +89,22 @@ namespace physx
 			*/
 			void	doRaycastCCD(bool doDynamicDynamicCCD);
 
+			/**
+			\brief Perform raycast CCD for all registered objects at once, with the raycasts spread over worker threads. Call this after your simulate/fetchResults calls.
+
+			The rays of all awake objects are gathered first, cast in parallel, then the objects are moved in registration order. Rays are cast
+			in spatially coherent order, so that consecutive rays traverse the same parts of the scene-query trees.
+
+			This gives the same results as doRaycastCCD(), except for dynamic-vs-dynamic CCD: here all rays see the dynamic objects at their poses
+			from before the call, while doRaycastCCD() lets later rays see the objects moved by earlier ones.
+
+			The scene must not be modified during the call. If the scene uses PxSceneFlag::eREQUIRE_RW_LOCK, the rays are cast on the calling thread.
+
+			\param[in] doDynamicDynamicCCD	True to enable dynamic-vs-dynamic CCD (more expensive, not always needed)
+			\param[in] dispatcher			Dispatcher whose worker threads cast the rays. NULL to use the scene's dispatcher.
+			*/
+			void	doRaycastCCDBatched(bool doDynamicDynamicCCD, PxCpuDispatcher* dispatcher = NULL);
+
 		private:
 			RaycastCCDManagerInternal*	mImpl;
 	};
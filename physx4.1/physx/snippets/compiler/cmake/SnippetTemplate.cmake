@@ -50,6 +50,27 @@ TARGET_INCLUDE_DIRECTORIES(Snippet${SNIPPET_NAME}
 	PRIVATE ${PHYSX_ROOT_DIR}/source/physxextensions/src
 )
 
+# SnippetRadixSort tests the PhysXCommon radix sort directly
+IF(${SNIPPET_NAME} STREQUAL "RadixSort")
+	TARGET_INCLUDE_DIRECTORIES(Snippet${SNIPPET_NAME}
+		PRIVATE ${PHYSX_ROOT_DIR}/source/common/src
+	)
+ENDIF()
+
+# SnippetContactBlock8 toggles the 8-wide contact blocks of the low level solver
+IF(${SNIPPET_NAME} STREQUAL "ContactBlock8")
+	TARGET_INCLUDE_DIRECTORIES(Snippet${SNIPPET_NAME}
+		PRIVATE $<TARGET_PROPERTY:LowLevelDynamics,INCLUDE_DIRECTORIES>
+	)
+ENDIF()
+
+# SnippetIslandDeterminism reads the island ids from the simulation controller's island sim
+IF(${SNIPPET_NAME} STREQUAL "IslandDeterminism")
+	TARGET_INCLUDE_DIRECTORIES(Snippet${SNIPPET_NAME}
+		PRIVATE $<TARGET_PROPERTY:PhysX,INCLUDE_DIRECTORIES>
+	)
+ENDIF()
+
 TARGET_COMPILE_DEFINITIONS(Snippet${SNIPPET_NAME}
 	PRIVATE ${SNIPPET_COMPILE_DEFS}
 )
@@ -75,7 +96,7 @@ ELSE()
 ENDIF()
 
 TARGET_LINK_LIBRARIES(Snippet${SNIPPET_NAME} 
-	PUBLIC PhysXExtensions PhysX PhysXPvdSDK PhysXVehicle PhysXCharacterKinematic PhysXCooking PhysXCommon PhysXFoundation SnippetUtils
+	PUBLIC PhysXCharacterKinematic PhysXExtensions PhysX PhysXPvdSDK PhysXVehicle PhysXCooking PhysXCommon PhysXFoundation SnippetUtils
 	PUBLIC ${SNIPPET_PLATFORM_LINKED_LIBS})
 
 IF(CUSTOM_SNIPPET_TARGET_PROPERTIES)
@@ -0,0 +1,420 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+// ****************************************************************************
+// This snippet is a headless benchmark suite. It simulates a set of canonical
+// scenes (kapla tower, convex pile, ragdolls, vehicles, character controllers,
+// scene queries and world streaming) for a fixed number of frames with fixed
+// seeds, and records per-phase timings and simulation counters.
+//
+// Results can be written to a JSON file and compared against a previous run,
+// in which case phases that got slower than a threshold are reported as
+// regressions and the snippet returns a non-zero exit code.
+//
+// With --trace, a PxProfileTraceRecorder is installed as profiler callback and
+// the slowest frame of each scene is written as a Chrome trace file, which can
+// be opened in chrome://tracing or Perfetto. The SDK only emits profile zones
+// in debug, checked and profile builds, or with PX_PROFILE_ZONES_IN_RELEASE.
+//
+// Usage: SnippetBenchmark [--frames=N] [--warmup=N] [--threads=N] [--scene=name]
+//                         [--output=file.json] [--baseline=file.json] [--threshold=percent]
+//                         [--trace=prefix]
+//        SnippetBenchmark --compare=baseline.json current.json [--threshold=percent]
+// ****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "PxPhysicsAPI.h"
+
+#include "SnippetBenchmarkScenes.h"
+#include "SnippetBenchmarkReport.h"
+
+#include "../snippetutils/SnippetUtils.h"
+
+using namespace physx;
+using namespace snippetbenchmark;
+
+PxDefaultAllocator		gAllocator;
+PxDefaultErrorCallback	gErrorCallback;
+
+PxFoundation*			gFoundation = NULL;
+PxPhysics*				gPhysics	= NULL;
+PxCooking*				gCooking	= NULL;
+PxMaterial*				gMaterial	= NULL;
+PxDefaultCpuDispatcher*	gDispatcher	= NULL;
+PxProfileTraceRecorder*	gRecorder	= NULL;
+
+static const PxReal		gTimestep	= 1.0f/60.0f;
+
+struct CmdLineParameters
+{
+	CmdLineParameters() :
+		nbFrames		(300),
+		nbWarmupFrames	(10),
+		nbThreads		(0xffffffff),
+		scene			(NULL),
+		output			(NULL),
+		baseline		(NULL),
+		compare			(NULL),
+		current			(NULL),
+		trace			(NULL),
+		threshold		(10.0)
+	{
+	}
+
+	PxU32		nbFrames;
+	PxU32		nbWarmupFrames;
+	PxU32		nbThreads;
+	const char*	scene;
+	const char*	output;
+	const char*	baseline;
+	const char*	compare;
+	const char*	current;
+	const char*	trace;
+	PxF64		threshold;
+} gParameters;
+
+static void printHelpMsg()
+{
+	printf("SnippetBenchmark usage:\n"
+		"SnippetBenchmark [options]\n"
+		"SnippetBenchmark --compare=<baseline.json> <current.json> [--threshold=<percent>]\n\n"
+		"Options:\n"
+		"  --frames=<n>          number of measured frames per scene (default 300)\n"
+		"  --warmup=<n>          number of frames simulated before measuring (default 10)\n"
+		"  --threads=<n>         number of dispatcher worker threads (default: physical cores - 1)\n"
+		"  --scene=<name>        only run the named scene\n"
+		"  --output=<file>       write the results as JSON\n"
+		"  --baseline=<file>     compare the results against a previous JSON output\n"
+		"  --threshold=<percent> slowdown reported as a regression (default 10)\n"
+		"  --trace=<prefix>      write the slowest frame of each scene to <prefix>_<scene>.json as a Chrome trace\n\n"
+		"Scenes:");
+
+	for(PxU32 i=0;i<getNbBenchmarkScenes();i++)
+	{
+		BenchmarkScene* scene = createBenchmarkScene(i);
+		printf(" %s", scene->getName());
+		delete scene;
+	}
+	printf("\n");
+}
+
+static bool match(const char* opt, const char* ref)
+{
+	return !strncmp(opt, ref, strlen(ref));
+}
+
+static bool parseCommandLine(CmdLineParameters& result, int argc, const char*const* argv)
+{
+	for(int i=1;i<argc;i++)
+	{
+		if(argv[i][0] != '-' || argv[i][1] != '-')
+		{
+			if(!result.current)
+				result.current = argv[i];
+			else
+			{
+				printf("[ERROR] Unexpected command line parameter \"%s\"\n", argv[i]);
+				return false;
+			}
+		}
+		else if(match(argv[i], "--frames="))
+			result.nbFrames = PxU32(atoi(argv[i] + strlen("--frames=")));
+		else if(match(argv[i], "--warmup="))
+			result.nbWarmupFrames = PxU32(atoi(argv[i] + strlen("--warmup=")));
+		else if(match(argv[i], "--threads="))
+			result.nbThreads = PxU32(atoi(argv[i] + strlen("--threads=")));
+		else if(match(argv[i], "--scene="))
+			result.scene = argv[i] + strlen("--scene=");
+		else if(match(argv[i], "--output="))
+			result.output = argv[i] + strlen("--output=");
+		else if(match(argv[i], "--baseline="))
+			result.baseline = argv[i] + strlen("--baseline=");
+		else if(match(argv[i], "--compare="))
+			result.compare = argv[i] + strlen("--compare=");
+		else if(match(argv[i], "--trace="))
+			result.trace = argv[i] + strlen("--trace=");
+		else if(match(argv[i], "--threshold="))
+			result.threshold = atof(argv[i] + strlen("--threshold="));
+		else if(match(argv[i], "--help"))
+		{
+			printHelpMsg();
+			return false;
+		}
+		else
+		{
+			printf("[ERROR] Unknown command line parameter \"%s\"\n", argv[i]);
+			printHelpMsg();
+			return false;
+		}
+	}
+
+	if(result.compare && !result.current)
+	{
+		printf("[ERROR] --compare needs the baseline and the current JSON files\n");
+		return false;
+	}
+	if(!result.compare && result.current)
+	{
+		printf("[ERROR] Unexpected command line parameter \"%s\"\n", result.current);
+		return false;
+	}
+	return true;
+}
+
+static const char* getConfigName()
+{
+#if PX_DEBUG
+	return "debug";
+#elif PX_CHECKED
+	return "checked";
+#elif PX_PROFILE
+	return "profile";
+#else
+	return "release";
+#endif
+}
+
+static void addSimulationCounters(BenchmarkStats& stats, const PxSimulationStatistics& simStats)
+{
+	stats.addCounter("activeBodies", PxF64(simStats.nbActiveDynamicBodies));
+	stats.addCounter("activeConstraints", PxF64(simStats.nbActiveConstraints));
+	stats.addCounter("axisConstraints", PxF64(simStats.nbAxisSolverConstraints));
+	stats.addCounter("partitions", PxF64(simStats.nbPartitions));
+	stats.addCounter("partitionTimeMs", PxF64(simStats.partitionTime));
+	stats.addCounter("ccdPasses", PxF64(simStats.nbCCDPasses));
+	stats.addCounter("ccdHits", PxF64(simStats.nbCCDHits));
+	stats.addCounter("contactPairs", PxF64(simStats.nbDiscreteContactPairsTotal));
+	stats.addCounter("newPairs", PxF64(simStats.nbNewPairs));
+	stats.addCounter("lostPairs", PxF64(simStats.nbLostPairs));
+	stats.addCounter("broadPhaseAdds", PxF64(simStats.getNbBroadPhaseAdds()));
+	stats.addCounter("broadPhaseRemoves", PxF64(simStats.getNbBroadPhaseRemoves()));
+}
+
+static void writeTrace(const char* sceneName)
+{
+	char filename[256];
+	snprintf(filename, sizeof(filename), "%s_%s.json", gParameters.trace, sceneName);
+	PxDefaultFileOutputStream stream(filename);
+	if(!stream.isValid() || !gRecorder->writeChromeTrace(stream, 1))
+		printf("[ERROR] Cannot write trace to \"%s\"\n", filename);
+}
+
+static void runScene(BenchmarkScene& benchmarkScene, BenchmarkReport& report)
+{
+	PxSceneDesc sceneDesc(gPhysics->getTolerancesScale());
+	sceneDesc.gravity		= PxVec3(0.0f, -9.81f, 0.0f);
+	sceneDesc.cpuDispatcher	= gDispatcher;
+	sceneDesc.filterShader	= PxDefaultSimulationFilterShader;
+	benchmarkScene.configure(sceneDesc);
+
+	const PxU64 setupStart = SnippetUtils::getCurrentTimeCounterValue();
+	PxScene* scene = gPhysics->createScene(sceneDesc);
+
+	BenchmarkContext context;
+	context.physics		= gPhysics;
+	context.cooking		= gCooking;
+	context.material	= gMaterial;
+	context.allocator	= &gAllocator;
+	benchmarkScene.create(context, *scene);
+	const PxF64 setupMs = PxF64(SnippetUtils::getElapsedTimeInMilliseconds(SnippetUtils::getCurrentTimeCounterValue() - setupStart));
+
+	const PxU32 nbActors = scene->getNbActors(PxActorTypeFlag::eRIGID_STATIC | PxActorTypeFlag::eRIGID_DYNAMIC);
+
+	//Warmup frames are simulated exactly like measured frames, but their stats are discarded.
+	BenchmarkStats warmupStats;
+	BenchmarkStats stats;
+	PxF64 slowestFrameMs = 0.0;
+	const PxU32 nbFrames = gParameters.nbWarmupFrames + gParameters.nbFrames;
+	for(PxU32 i=0;i<nbFrames;i++)
+	{
+		BenchmarkStats& frameStats = i<gParameters.nbWarmupFrames ? warmupStats : stats;
+		const PxU32 framePhase = frameStats.getPhase("frame");
+		const PxU32 simulatePhase = frameStats.getPhase("simulate");
+
+		if(gRecorder)
+			gRecorder->markFrame();
+
+		frameStats.beginFrame();
+		{
+			BenchmarkPhaseScope frameScope(frameStats, framePhase);
+
+			benchmarkScene.update(*scene, i, gTimestep, frameStats);
+
+			BenchmarkPhaseScope simulateScope(frameStats, simulatePhase);
+			scene->simulate(gTimestep);
+			scene->fetchResults(true);
+		}
+		frameStats.endFrame();
+
+		//Capture spikes: the trace of a measured frame is written whenever it is the slowest one so far.
+		if(gRecorder && &frameStats == &stats && frameStats.getPhaseData(framePhase).maxMs > slowestFrameMs)
+		{
+			slowestFrameMs = frameStats.getPhaseData(framePhase).maxMs;
+			writeTrace(benchmarkScene.getName());
+		}
+
+		PxSimulationStatistics simStats;
+		scene->getSimulationStatistics(simStats);
+		addSimulationCounters(frameStats, simStats);
+	}
+
+	benchmarkScene.release(*scene);
+	PX_RELEASE(scene);
+
+	report.addScene(benchmarkScene.getName(), nbActors, setupMs, stats);
+
+	const SceneReport& sceneReport = report.scenes[report.nbScenes - 1];
+	printf("%-12s %6u actors, setup %8.1f ms\n", sceneReport.name, nbActors, setupMs);
+	for(PxU32 i=0;i<sceneReport.nbPhases;i++)
+	{
+		const PhaseReport& phase = sceneReport.phases[i];
+		printf("    %-12s avg %8.3f ms  min %8.3f ms  max %8.3f ms\n", phase.name, phase.avgMs, phase.minMs, phase.maxMs);
+	}
+}
+
+void initPhysics()
+{
+	gFoundation = PxCreateFoundation(PX_PHYSICS_VERSION, gAllocator, gErrorCallback);
+	gPhysics = PxCreatePhysics(PX_PHYSICS_VERSION, *gFoundation, PxTolerancesScale(), true);
+	gCooking = PxCreateCooking(PX_PHYSICS_VERSION, *gFoundation, PxCookingParams(PxTolerancesScale()));
+	PxInitExtensions(*gPhysics, NULL);
+	gMaterial = gPhysics->createMaterial(0.5f, 0.5f, 0.6f);
+
+	PxU32 nbThreads = gParameters.nbThreads;
+	if(nbThreads == 0xffffffff)
+	{
+		const PxU32 nbCores = SnippetUtils::getNbPhysicalCores();
+		nbThreads = nbCores > 1 ? nbCores - 1 : 1;
+	}
+	gParameters.nbThreads = nbThreads;
+	gDispatcher = PxDefaultCpuDispatcherCreate(nbThreads);
+
+	if(gParameters.trace)
+	{
+		gRecorder = PxProfileTraceRecorderCreate();
+		PxSetProfilerCallback(gRecorder);
+	}
+}
+
+void cleanupPhysics()
+{
+	PX_RELEASE(gDispatcher);
+	if(gRecorder)
+	{
+		PxSetProfilerCallback(NULL);
+		PX_RELEASE(gRecorder);
+	}
+	PX_RELEASE(gMaterial);
+	PxCloseExtensions();
+	PX_RELEASE(gCooking);
+	PX_RELEASE(gPhysics);
+	PX_RELEASE(gFoundation);
+
+	printf("SnippetBenchmark done.\n");
+}
+
+static int compareFiles(const char* baselineFile, const char* currentFile)
+{
+	BenchmarkReport* baseline = new BenchmarkReport;
+	BenchmarkReport* current = new BenchmarkReport;
+
+	int result = 1;
+	if(!readReport(*baseline, baselineFile))
+		printf("[ERROR] Cannot read benchmark results from \"%s\"\n", baselineFile);
+	else if(!readReport(*current, currentFile))
+		printf("[ERROR] Cannot read benchmark results from \"%s\"\n", currentFile);
+	else
+		result = compareReports(*baseline, *current, gParameters.threshold) ? 1 : 0;
+
+	delete current;
+	delete baseline;
+	return result;
+}
+
+int snippetMain(int argc, const char*const* argv)
+{
+	if(!parseCommandLine(gParameters, argc, argv))
+		return 1;
+
+	if(gParameters.compare)
+		return compareFiles(gParameters.compare, gParameters.current);
+
+	initPhysics();
+
+	BenchmarkReport* report = new BenchmarkReport;
+	sprintf(report->version, "%d.%d.%d", PX_PHYSICS_VERSION_MAJOR, PX_PHYSICS_VERSION_MINOR, PX_PHYSICS_VERSION_BUGFIX);
+	strcpy(report->config, getConfigName());
+	report->nbThreads		= gParameters.nbThreads;
+	report->nbFrames		= gParameters.nbFrames;
+	report->nbWarmupFrames	= gParameters.nbWarmupFrames;
+
+	printf("SnippetBenchmark: %s build, %u threads, %u frames\n", report->config, report->nbThreads, report->nbFrames);
+
+	for(PxU32 i=0;i<getNbBenchmarkScenes();i++)
+	{
+		BenchmarkScene* benchmarkScene = createBenchmarkScene(i);
+		if(!gParameters.scene || !strcmp(gParameters.scene, benchmarkScene->getName()))
+			runScene(*benchmarkScene, *report);
+		delete benchmarkScene;
+	}
+
+	cleanupPhysics();
+
+	int result = 0;
+	if(!report->nbScenes)
+	{
+		printf("[ERROR] Unknown scene \"%s\"\n", gParameters.scene);
+		result = 1;
+	}
+
+	if(gParameters.output && !writeReport(*report, gParameters.output))
+	{
+		printf("[ERROR] Cannot write benchmark results to \"%s\"\n", gParameters.output);
+		result = 1;
+	}
+
+	if(gParameters.baseline)
+	{
+		BenchmarkReport* baseline = new BenchmarkReport;
+		if(!readReport(*baseline, gParameters.baseline))
+		{
+			printf("[ERROR] Cannot read benchmark results from \"%s\"\n", gParameters.baseline);
+			result = 1;
+		}
+		else if(compareReports(*baseline, *report, gParameters.threshold))
+			result = 1;
+		delete baseline;
+	}
+
+	delete report;
+	return result;
+}
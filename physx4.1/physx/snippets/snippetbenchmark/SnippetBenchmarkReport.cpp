@@ -0,0 +1,481 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#include "SnippetBenchmarkReport.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace snippetbenchmark
+{
+
+static void copyName(char* dst, const char* src)
+{
+	strncpy(dst, src, MAX_NAME_LENGTH - 1);
+	dst[MAX_NAME_LENGTH - 1] = 0;
+}
+
+BenchmarkReport::BenchmarkReport() : nbThreads(0), nbFrames(0), nbWarmupFrames(0), nbScenes(0)
+{
+	version[0] = 0;
+	config[0] = 0;
+}
+
+void BenchmarkReport::addScene(const char* name, PxU32 nbActors, PxF64 setupMs, const BenchmarkStats& stats)
+{
+	PX_ASSERT(nbScenes<MAX_NB_SCENES);
+	SceneReport& scene = scenes[nbScenes++];
+	copyName(scene.name, name);
+	scene.nbActors = nbActors;
+	scene.setupMs = setupMs;
+
+	const PxF64 nbFramesF = PxF64(PxMax(stats.getNbFrames(), 1u));
+
+	scene.nbPhases = stats.getNbPhases();
+	for(PxU32 i=0;i<scene.nbPhases;i++)
+	{
+		const BenchmarkStats::Phase& phase = stats.getPhaseData(i);
+		copyName(scene.phases[i].name, phase.name);
+		scene.phases[i].avgMs = phase.totalMs / nbFramesF;
+		scene.phases[i].minMs = stats.getNbFrames() ? phase.minMs : 0.0;
+		scene.phases[i].maxMs = phase.maxMs;
+	}
+
+	scene.nbCounters = stats.getNbCounters();
+	for(PxU32 i=0;i<scene.nbCounters;i++)
+	{
+		const BenchmarkStats::Counter& counter = stats.getCounterData(i);
+		copyName(scene.counters[i].name, counter.name);
+		scene.counters[i].value = counter.total / nbFramesF;
+	}
+}
+
+const SceneReport* BenchmarkReport::findScene(const char* name) const
+{
+	for(PxU32 i=0;i<nbScenes;i++)
+	{
+		if(!strcmp(scenes[i].name, name))
+			return &scenes[i];
+	}
+	return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool writeReport(const BenchmarkReport& report, const char* filename)
+{
+	FILE* fp = fopen(filename, "w");
+	if(!fp)
+		return false;
+
+	fprintf(fp, "{\n");
+	fprintf(fp, "\t\"version\": \"%s\",\n", report.version);
+	fprintf(fp, "\t\"config\": \"%s\",\n", report.config);
+	fprintf(fp, "\t\"threads\": %u,\n", report.nbThreads);
+	fprintf(fp, "\t\"frames\": %u,\n", report.nbFrames);
+	fprintf(fp, "\t\"warmupFrames\": %u,\n", report.nbWarmupFrames);
+	fprintf(fp, "\t\"scenes\": [");
+	for(PxU32 i=0;i<report.nbScenes;i++)
+	{
+		const SceneReport& scene = report.scenes[i];
+		fprintf(fp, "%s\n\t\t{\n", i ? "," : "");
+		fprintf(fp, "\t\t\t\"name\": \"%s\",\n", scene.name);
+		fprintf(fp, "\t\t\t\"actors\": %u,\n", scene.nbActors);
+		fprintf(fp, "\t\t\t\"setupMs\": %.4f,\n", scene.setupMs);
+
+		fprintf(fp, "\t\t\t\"phases\": {");
+		for(PxU32 j=0;j<scene.nbPhases;j++)
+		{
+			const PhaseReport& phase = scene.phases[j];
+			fprintf(fp, "%s\n\t\t\t\t\"%s\": { \"avgMs\": %.4f, \"minMs\": %.4f, \"maxMs\": %.4f }", j ? "," : "", phase.name, phase.avgMs, phase.minMs, phase.maxMs);
+		}
+		fprintf(fp, "\n\t\t\t},\n");
+
+		fprintf(fp, "\t\t\t\"counters\": {");
+		for(PxU32 j=0;j<scene.nbCounters;j++)
+			fprintf(fp, "%s\n\t\t\t\t\"%s\": %.4f", j ? "," : "", scene.counters[j].name, scene.counters[j].value);
+		fprintf(fp, "\n\t\t\t}\n");
+
+		fprintf(fp, "\t\t}");
+	}
+	fprintf(fp, "\n\t]\n}\n");
+
+	const bool ok = !ferror(fp);
+	fclose(fp);
+	return ok;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	//Minimal JSON reader, sufficient for the files written by writeReport.
+	class JsonReader
+	{
+	public:
+		JsonReader(const char* text) : mText(text), mError(false)	{}
+
+		bool	failed()	const	{ return mError;	}
+
+		void	skipWhitespace()
+		{
+			while(*mText==' ' || *mText=='\t' || *mText=='\n' || *mText=='\r')
+				mText++;
+		}
+
+		bool	expect(char c)
+		{
+			skipWhitespace();
+			if(*mText!=c)
+			{
+				mError = true;
+				return false;
+			}
+			mText++;
+			return true;
+		}
+
+		bool	accept(char c)
+		{
+			skipWhitespace();
+			if(*mText!=c)
+				return false;
+			mText++;
+			return true;
+		}
+
+		void	readString(char* buffer)
+		{
+			if(!expect('"'))
+				return;
+			PxU32 length = 0;
+			while(*mText && *mText!='"')
+			{
+				if(*mText=='\\' && mText[1])
+					mText++;
+				if(length<MAX_NAME_LENGTH-1)
+					buffer[length++] = *mText;
+				mText++;
+			}
+			buffer[length] = 0;
+			expect('"');
+		}
+
+		PxF64	readNumber()
+		{
+			skipWhitespace();
+			char* end;
+			const PxF64 value = strtod(mText, &end);
+			if(end==mText)
+				mError = true;
+			mText = end;
+			return value;
+		}
+
+		void	skipValue()
+		{
+			skipWhitespace();
+			if(*mText=='"')
+			{
+				char buffer[MAX_NAME_LENGTH];
+				readString(buffer);
+			}
+			else if(accept('{'))
+			{
+				if(accept('}'))
+					return;
+				do
+				{
+					char key[MAX_NAME_LENGTH];
+					readString(key);
+					expect(':');
+					skipValue();
+				}
+				while(!mError && accept(','));
+				expect('}');
+			}
+			else if(accept('['))
+			{
+				if(accept(']'))
+					return;
+				do
+				{
+					skipValue();
+				}
+				while(!mError && accept(','));
+				expect(']');
+			}
+			else if(!strncmp(mText, "true", 4) || !strncmp(mText, "null", 4))
+				mText += 4;
+			else if(!strncmp(mText, "false", 5))
+				mText += 5;
+			else
+				readNumber();
+		}
+
+	private:
+		const char*	mText;
+		bool		mError;
+	};
+
+	void readPhases(JsonReader& reader, SceneReport& scene)
+	{
+		scene.nbPhases = 0;
+		reader.expect('{');
+		if(reader.accept('}'))
+			return;
+		do
+		{
+			PhaseReport dummy;
+			PhaseReport& phase = scene.nbPhases<MAX_NB_PHASES ? scene.phases[scene.nbPhases++] : dummy;
+			phase.avgMs = phase.minMs = phase.maxMs = 0.0;
+			reader.readString(phase.name);
+			reader.expect(':');
+			reader.expect('{');
+			if(reader.accept('}'))
+				continue;
+			do
+			{
+				char key[MAX_NAME_LENGTH];
+				reader.readString(key);
+				reader.expect(':');
+				if(!strcmp(key, "avgMs"))
+					phase.avgMs = reader.readNumber();
+				else if(!strcmp(key, "minMs"))
+					phase.minMs = reader.readNumber();
+				else if(!strcmp(key, "maxMs"))
+					phase.maxMs = reader.readNumber();
+				else
+					reader.skipValue();
+			}
+			while(!reader.failed() && reader.accept(','));
+			reader.expect('}');
+		}
+		while(!reader.failed() && reader.accept(','));
+		reader.expect('}');
+	}
+
+	void readCounters(JsonReader& reader, SceneReport& scene)
+	{
+		scene.nbCounters = 0;
+		reader.expect('{');
+		if(reader.accept('}'))
+			return;
+		do
+		{
+			CounterReport dummy;
+			CounterReport& counter = scene.nbCounters<MAX_NB_COUNTERS ? scene.counters[scene.nbCounters++] : dummy;
+			reader.readString(counter.name);
+			reader.expect(':');
+			counter.value = reader.readNumber();
+		}
+		while(!reader.failed() && reader.accept(','));
+		reader.expect('}');
+	}
+
+	void readScene(JsonReader& reader, SceneReport& scene)
+	{
+		scene.name[0] = 0;
+		scene.nbActors = 0;
+		scene.setupMs = 0.0;
+		scene.nbPhases = 0;
+		scene.nbCounters = 0;
+
+		reader.expect('{');
+		if(reader.accept('}'))
+			return;
+		do
+		{
+			char key[MAX_NAME_LENGTH];
+			reader.readString(key);
+			reader.expect(':');
+			if(!strcmp(key, "name"))
+				reader.readString(scene.name);
+			else if(!strcmp(key, "actors"))
+				scene.nbActors = PxU32(reader.readNumber());
+			else if(!strcmp(key, "setupMs"))
+				scene.setupMs = reader.readNumber();
+			else if(!strcmp(key, "phases"))
+				readPhases(reader, scene);
+			else if(!strcmp(key, "counters"))
+				readCounters(reader, scene);
+			else
+				reader.skipValue();
+		}
+		while(!reader.failed() && reader.accept(','));
+		reader.expect('}');
+	}
+
+	void readScenes(JsonReader& reader, BenchmarkReport& report)
+	{
+		report.nbScenes = 0;
+		reader.expect('[');
+		if(reader.accept(']'))
+			return;
+		do
+		{
+			if(report.nbScenes<MAX_NB_SCENES)
+				readScene(reader, report.scenes[report.nbScenes++]);
+			else
+				reader.skipValue();
+		}
+		while(!reader.failed() && reader.accept(','));
+		reader.expect(']');
+	}
+}
+
+bool readReport(BenchmarkReport& report, const char* filename)
+{
+	FILE* fp = fopen(filename, "rb");
+	if(!fp)
+		return false;
+
+	fseek(fp, 0, SEEK_END);
+	const long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	if(size<=0)
+	{
+		fclose(fp);
+		return false;
+	}
+
+	char* text = reinterpret_cast<char*>(malloc(size_t(size) + 1));
+	const size_t nbRead = fread(text, 1, size_t(size), fp);
+	fclose(fp);
+	text[nbRead] = 0;
+
+	JsonReader reader(text);
+	reader.expect('{');
+	if(!reader.accept('}'))
+	{
+		do
+		{
+			char key[MAX_NAME_LENGTH];
+			reader.readString(key);
+			reader.expect(':');
+			if(!strcmp(key, "version"))
+				reader.readString(report.version);
+			else if(!strcmp(key, "config"))
+				reader.readString(report.config);
+			else if(!strcmp(key, "threads"))
+				report.nbThreads = PxU32(reader.readNumber());
+			else if(!strcmp(key, "frames"))
+				report.nbFrames = PxU32(reader.readNumber());
+			else if(!strcmp(key, "warmupFrames"))
+				report.nbWarmupFrames = PxU32(reader.readNumber());
+			else if(!strcmp(key, "scenes"))
+				readScenes(reader, report);
+			else
+				reader.skipValue();
+		}
+		while(!reader.failed() && reader.accept(','));
+		reader.expect('}');
+	}
+
+	free(text);
+	return !reader.failed();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+//Phases whose average time changes by less than this are never reported, whatever the relative change.
+static const PxF64 MIN_SIGNIFICANT_DELTA_MS = 0.05;
+
+//Counter changes above this relative amount are printed for information. They usually mean that the
+//simulated content changed, which makes the timings of the two runs hard to compare.
+static const PxF64 COUNTER_CHANGE_PERCENT = 1.0;
+
+PxU32 compareReports(const BenchmarkReport& baseline, const BenchmarkReport& current, PxF64 thresholdPercent)
+{
+	printf("Comparing against baseline (%s, %s, %u threads, %u frames)\n", baseline.version, baseline.config, baseline.nbThreads, baseline.nbFrames);
+	if(strcmp(baseline.config, current.config) || baseline.nbThreads!=current.nbThreads || baseline.nbFrames!=current.nbFrames)
+		printf("Warning: runs use different settings (%s, %u threads, %u frames)\n", current.config, current.nbThreads, current.nbFrames);
+
+	PxU32 nbRegressions = 0;
+	PxU32 nbImprovements = 0;
+	for(PxU32 i=0;i<current.nbScenes;i++)
+	{
+		const SceneReport& scene = current.scenes[i];
+		const SceneReport* baseScene = baseline.findScene(scene.name);
+		if(!baseScene)
+		{
+			printf("%-12s not in baseline\n", scene.name);
+			continue;
+		}
+
+		for(PxU32 j=0;j<scene.nbPhases;j++)
+		{
+			const PhaseReport& phase = scene.phases[j];
+			const PhaseReport* basePhase = NULL;
+			for(PxU32 k=0;k<baseScene->nbPhases;k++)
+			{
+				if(!strcmp(baseScene->phases[k].name, phase.name))
+					basePhase = &baseScene->phases[k];
+			}
+			if(!basePhase)
+				continue;
+
+			const PxF64 delta = phase.avgMs - basePhase->avgMs;
+			const PxF64 percent = basePhase->avgMs>0.0 ? 100.0 * delta / basePhase->avgMs : 0.0;
+			const char* status = "";
+			if(PxAbs(delta)>MIN_SIGNIFICANT_DELTA_MS && percent>thresholdPercent)
+			{
+				status = "REGRESSION";
+				nbRegressions++;
+			}
+			else if(PxAbs(delta)>MIN_SIGNIFICANT_DELTA_MS && percent<-thresholdPercent)
+			{
+				status = "improvement";
+				nbImprovements++;
+			}
+			printf("%-12s %-12s %10.3f ms -> %10.3f ms  %+7.1f%%  %s\n", scene.name, phase.name, basePhase->avgMs, phase.avgMs, percent, status);
+		}
+
+		for(PxU32 j=0;j<scene.nbCounters;j++)
+		{
+			const CounterReport& counter = scene.counters[j];
+			for(PxU32 k=0;k<baseScene->nbCounters;k++)
+			{
+				const CounterReport& baseCounter = baseScene->counters[k];
+				if(strcmp(baseCounter.name, counter.name))
+					continue;
+
+				const PxF64 reference = PxMax(PxAbs(baseCounter.value), 1e-6);
+				if(100.0 * PxAbs(counter.value - baseCounter.value) / reference > COUNTER_CHANGE_PERCENT)
+					printf("%-12s counter %s changed: %.2f -> %.2f\n", scene.name, counter.name, baseCounter.value, counter.value);
+			}
+		}
+	}
+
+	printf("%u regression(s), %u improvement(s) with a %.1f%% threshold\n", nbRegressions, nbImprovements, thresholdPercent);
+	return nbRegressions;
+}
+
+} // namespace snippetbenchmark
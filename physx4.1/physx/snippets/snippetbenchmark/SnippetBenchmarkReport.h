@@ -0,0 +1,98 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef SNIPPET_BENCHMARK_REPORT_H
+#define SNIPPET_BENCHMARK_REPORT_H
+
+#include "SnippetBenchmarkScenes.h"
+
+namespace snippetbenchmark
+{
+
+static const PxU32 MAX_NB_SCENES	= 16;
+static const PxU32 MAX_NAME_LENGTH	= 64;
+
+struct PhaseReport
+{
+	char	name[MAX_NAME_LENGTH];
+	PxF64	avgMs;
+	PxF64	minMs;
+	PxF64	maxMs;
+};
+
+struct CounterReport
+{
+	char	name[MAX_NAME_LENGTH];
+	PxF64	value;		//average per measured frame
+};
+
+struct SceneReport
+{
+	char			name[MAX_NAME_LENGTH];
+	PxU32			nbActors;
+	PxF64			setupMs;
+	PxU32			nbPhases;
+	PhaseReport		phases[MAX_NB_PHASES];
+	PxU32			nbCounters;
+	CounterReport	counters[MAX_NB_COUNTERS];
+};
+
+//Results of one benchmark run, as written to and read back from JSON.
+struct BenchmarkReport
+{
+	BenchmarkReport();
+
+	//Adds a scene report built from the stats gathered over the measured frames.
+	void	addScene(const char* name, PxU32 nbActors, PxF64 setupMs, const BenchmarkStats& stats);
+
+	const SceneReport*	findScene(const char* name)	const;
+
+	char			version[MAX_NAME_LENGTH];
+	char			config[MAX_NAME_LENGTH];
+	PxU32			nbThreads;
+	PxU32			nbFrames;
+	PxU32			nbWarmupFrames;
+	PxU32			nbScenes;
+	SceneReport		scenes[MAX_NB_SCENES];
+};
+
+//Writes a report as JSON. Returns false if the file cannot be written.
+bool	writeReport(const BenchmarkReport& report, const char* filename);
+
+//Reads a report written by writeReport. Unknown keys are skipped. Returns false on I/O or parse errors.
+bool	readReport(BenchmarkReport& report, const char* filename);
+
+//Compares the phase timings of a run against a baseline and prints a summary. A phase regresses when
+//its average time grows by more than thresholdPercent, and by more than a small absolute amount so that
+//the noise of near-empty phases is ignored. Returns the number of regressions.
+PxU32	compareReports(const BenchmarkReport& baseline, const BenchmarkReport& current, PxF64 thresholdPercent);
+
+} // namespace snippetbenchmark
+
+#endif //SNIPPET_BENCHMARK_REPORT_H
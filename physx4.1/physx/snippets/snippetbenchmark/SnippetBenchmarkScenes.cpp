@@ -0,0 +1,855 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+// ****************************************************************************
+// Canonical scenes used by SnippetBenchmark. Every scene is built from fixed
+// seeds and driven by the frame index only, so that two runs of the same
+// build simulate exactly the same content.
+// ****************************************************************************
+
+#include "SnippetBenchmarkScenes.h"
+
+#include "vehicle/PxVehicleUtil.h"
+
+#include "../snippetvehiclecommon/SnippetVehicleCreate.h"
+#include "../snippetvehiclecommon/SnippetVehicleSceneQuery.h"
+#include "../snippetvehiclecommon/SnippetVehicleFilterShader.h"
+#include "../snippetvehiclecommon/SnippetVehicleTireFriction.h"
+
+#include "../snippetutils/SnippetUtils.h"
+
+#include "PsArray.h"
+
+using namespace physx;
+using namespace snippetvehicle;
+
+namespace snippetbenchmark
+{
+
+///////////////////////////////////////////////////////////////////////////////
+
+BenchmarkStats::BenchmarkStats() : mNbPhases(0), mNbCounters(0), mNbFrames(0)
+{
+}
+
+PxU32 BenchmarkStats::getPhase(const char* name)
+{
+	for(PxU32 i=0;i<mNbPhases;i++)
+	{
+		if(!strcmp(mPhases[i].name, name))
+			return i;
+	}
+
+	PX_ASSERT(mNbPhases<MAX_NB_PHASES);
+	Phase& phase = mPhases[mNbPhases];
+	phase.name			= name;
+	phase.frameTicks	= 0;
+	phase.totalMs		= 0.0;
+	phase.minMs			= PX_MAX_F64;
+	phase.maxMs			= 0.0;
+	return mNbPhases++;
+}
+
+void BenchmarkStats::addCounter(const char* name, PxF64 value)
+{
+	for(PxU32 i=0;i<mNbCounters;i++)
+	{
+		if(!strcmp(mCounters[i].name, name))
+		{
+			mCounters[i].total += value;
+			return;
+		}
+	}
+
+	PX_ASSERT(mNbCounters<MAX_NB_COUNTERS);
+	mCounters[mNbCounters].name = name;
+	mCounters[mNbCounters].total = value;
+	mNbCounters++;
+}
+
+void BenchmarkStats::beginFrame()
+{
+	for(PxU32 i=0;i<mNbPhases;i++)
+		mPhases[i].frameTicks = 0;
+}
+
+void BenchmarkStats::endFrame()
+{
+	for(PxU32 i=0;i<mNbPhases;i++)
+	{
+		Phase& phase = mPhases[i];
+		const PxF64 ms = PxF64(SnippetUtils::getElapsedTimeInMilliseconds(phase.frameTicks));
+		phase.totalMs += ms;
+		phase.minMs = PxMin(phase.minMs, ms);
+		phase.maxMs = PxMax(phase.maxMs, ms);
+	}
+	mNbFrames++;
+}
+
+BenchmarkPhaseScope::BenchmarkPhaseScope(BenchmarkStats& stats, PxU32 phase) :
+	mStats		(stats),
+	mPhase		(phase),
+	mStartTime	(SnippetUtils::getCurrentTimeCounterValue())
+{
+}
+
+BenchmarkPhaseScope::~BenchmarkPhaseScope()
+{
+	mStats.addPhaseTime(mPhase, SnippetUtils::getCurrentTimeCounterValue() - mStartTime);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Kapla tower, following the cylindrical towers of the kapla demo's SceneKaplaTower. The planks
+// start asleep and a projectile is fired at the tower every second.
+class KaplaTowerScene : public BenchmarkScene
+{
+public:
+	KaplaTowerScene() : mPhysics(NULL), mMaterial(NULL), mRandom(0x4b61706c)	{}
+
+	virtual	const char*	getName()	const	{ return "kapla";	}
+
+	virtual	void	create(const BenchmarkContext& context, PxScene& scene)
+	{
+		mPhysics = context.physics;
+		mMaterial = mPhysics->createMaterial(0.5f, 0.25f, 0.1f);
+
+		scene.addActor(*PxCreatePlane(*mPhysics, PxPlane(0,1,0,0), *context.material));
+
+		const PxVec3 dims(0.08f, 0.25f, 1.0f);
+		PxShape* shape = mPhysics->createShape(PxBoxGeometry(dims), *mMaterial);
+
+		createCylindricalTower(scene, *shape, 40, 2.5f, 22, dims);
+		createCylindricalTower(scene, *shape, 48, 4.5f, 15, dims);
+		createCylindricalTower(scene, *shape, 72, 6.5f, 11, dims);
+		createCylindricalTower(scene, *shape, 96, 8.5f, 8, dims);
+		createCylindricalTower(scene, *shape, 128, 10.5f, 6, dims);
+
+		shape->release();
+	}
+
+	virtual	void	update(PxScene& scene, PxU32 frame, PxReal /*dt*/, BenchmarkStats& /*stats*/)
+	{
+		if((frame % 60) != 30)
+			return;
+
+		const PxReal angle = mRandom.next(0.0f, PxTwoPi);
+		const PxVec3 target(0.0f, mRandom.next(1.0f, 8.0f), 0.0f);
+		const PxVec3 origin(PxCos(angle)*20.0f, 4.0f, PxSin(angle)*20.0f);
+		PxRigidDynamic* projectile = PxCreateDynamic(*mPhysics, PxTransform(origin), PxSphereGeometry(0.5f), *mMaterial, 50.0f);
+		projectile->setLinearVelocity((target - origin).getNormalized() * 40.0f);
+		scene.addActor(*projectile);
+	}
+
+	virtual	void	release(PxScene& /*scene*/)
+	{
+		PX_RELEASE(mMaterial);
+	}
+
+private:
+	void	createPlank(PxScene& scene, PxShape& shape, const PxTransform& pose, PxReal density)
+	{
+		PxRigidDynamic* body = mPhysics->createRigidDynamic(pose);
+		body->attachShape(shape);
+		body->setSolverIterationCounts(8);
+		body->setMaxDepenetrationVelocity(2.0f);
+		PxRigidBodyExt::updateMassAndInertia(*body, density);
+		body->setMassSpaceInertiaTensor(body->getMassSpaceInertiaTensor() * 4.0f);
+		scene.addActor(*body);
+		body->putToSleep();
+	}
+
+	void	createRing(PxScene& scene, PxShape& shape, PxReal radius, PxReal y, PxReal plankLength, PxReal density)
+	{
+		const PxU32 nbSlabs = PxU32(radius * PxTwoPi / plankLength);
+		for(PxU32 a=0;a<nbSlabs;a++)
+		{
+			const PxReal angle = PxTwoPi*PxReal(a)/PxReal(nbSlabs);
+			const PxVec3 pos(PxCos(angle)*radius, y, PxSin(angle)*radius);
+			createPlank(scene, shape, PxTransform(pos, PxQuat(-angle, PxVec3(0.0f, 1.0f, 0.0f))), density);
+		}
+	}
+
+	void	createCylindricalTower(PxScene& scene, PxShape& shape, PxU32 nbRadialPoints, PxReal radius, PxU32 height, const PxVec3& dims)
+	{
+		PxReal startHeight = 0.0f;
+		PxReal density = 1.0f;
+		for(PxU32 i=0;i<height;i++)
+		{
+			for(PxU32 a=0;a<nbRadialPoints;a++)
+			{
+				const PxReal angle = PxTwoPi*PxReal(a)/PxReal(nbRadialPoints);
+				const PxVec3 pos(PxCos(angle)*radius, dims.y + startHeight, PxSin(angle)*radius);
+				createPlank(scene, shape, PxTransform(pos, PxQuat(PxHalfPi - angle, PxVec3(0.0f, 1.0f, 0.0f))), density);
+			}
+
+			const PxReal slabY = 3.0f*dims.y + startHeight;
+			createRing(scene, shape, radius - (dims.z - dims.x), slabY, dims.z*2.0f, density);
+			createRing(scene, shape, radius, slabY, dims.z*2.0f, density);
+			createRing(scene, shape, radius + (dims.z - dims.x), slabY, dims.z*2.0f, density);
+
+			startHeight += 4.0f*dims.y;
+			density *= 0.975f;
+		}
+	}
+
+	PxPhysics*		mPhysics;
+	PxMaterial*		mMaterial;
+	BenchmarkRandom	mRandom;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// A large pile of random convexes dropped into a bin.
+class ConvexPileScene : public BenchmarkScene
+{
+public:
+	virtual	const char*	getName()	const	{ return "convexes";	}
+
+	virtual	void	create(const BenchmarkContext& context, PxScene& scene)
+	{
+		PxPhysics& physics = *context.physics;
+		PxMaterial& material = *context.material;
+		BenchmarkRandom random(0x436f6e76);
+
+		scene.addActor(*PxCreatePlane(physics, PxPlane(0,1,0,0), material));
+
+		const PxReal binSize = 12.0f;
+		const PxReal wallHeight = 4.0f;
+		for(PxU32 i=0;i<4;i++)
+		{
+			const PxQuat rot(PxHalfPi*PxReal(i), PxVec3(0.0f, 1.0f, 0.0f));
+			scene.addActor(*PxCreateStatic(physics, PxTransform(rot.rotate(PxVec3(binSize + 0.5f, wallHeight, 0.0f)), rot), PxBoxGeometry(0.5f, wallHeight, binSize + 1.0f), material));
+		}
+
+		static const PxU32 nbMeshes = 8;
+		static const PxU32 nbVerts = 16;
+		PxShape* shapes[nbMeshes];
+		for(PxU32 i=0;i<nbMeshes;i++)
+		{
+			PxVec3 verts[nbVerts];
+			for(PxU32 j=0;j<nbVerts;j++)
+				verts[j] = random.nextVec3(-0.5f, 0.5f);
+
+			PxConvexMeshDesc convexDesc;
+			convexDesc.points.count		= nbVerts;
+			convexDesc.points.stride	= sizeof(PxVec3);
+			convexDesc.points.data		= verts;
+			convexDesc.flags			= PxConvexFlag::eCOMPUTE_CONVEX;
+
+			PxConvexMesh* mesh = context.cooking->createConvexMesh(convexDesc, physics.getPhysicsInsertionCallback());
+			shapes[i] = physics.createShape(PxConvexMeshGeometry(mesh), material);
+			mesh->release();
+		}
+
+		const PxU32 nbX = 16, nbY = 12, nbZ = 16;
+		for(PxU32 y=0;y<nbY;y++)
+		{
+			for(PxU32 x=0;x<nbX;x++)
+			{
+				for(PxU32 z=0;z<nbZ;z++)
+				{
+					const PxVec3 pos(PxReal(x)*1.4f - PxReal(nbX)*0.7f, 1.0f + PxReal(y)*1.4f, PxReal(z)*1.4f - PxReal(nbZ)*0.7f);
+					const PxQuat rot = PxQuat(random.next(0.0f, PxTwoPi), random.nextVec3(-1.0f, 1.0f).getNormalized());
+					PxRigidDynamic* body = physics.createRigidDynamic(PxTransform(pos, rot.getNormalized()));
+					body->attachShape(*shapes[random.nextU32() % nbMeshes]);
+					PxRigidBodyExt::updateMassAndInertia(*body, 1.0f);
+					scene.addActor(*body);
+				}
+			}
+		}
+
+		for(PxU32 i=0;i<nbMeshes;i++)
+			shapes[i]->release();
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Jointed capsule ragdolls dropped on stairs. Each ragdoll lives in its own aggregate.
+class RagdollScene : public BenchmarkScene
+{
+public:
+	virtual	const char*	getName()	const	{ return "ragdolls";	}
+
+	virtual	void	create(const BenchmarkContext& context, PxScene& scene)
+	{
+		PxPhysics& physics = *context.physics;
+		BenchmarkRandom random(0x52616764);
+
+		scene.addActor(*PxCreatePlane(physics, PxPlane(0,1,0,0), *context.material));
+		for(PxU32 i=0;i<8;i++)
+			scene.addActor(*PxCreateStatic(physics, PxTransform(PxVec3(0.0f, 0.25f + PxReal(i)*0.5f, PxReal(i)*-1.0f)), PxBoxGeometry(12.0f, 0.25f + PxReal(i)*0.5f, 0.5f), *context.material));
+
+		for(PxU32 x=0;x<8;x++)
+		{
+			for(PxU32 z=0;z<8;z++)
+			{
+				const PxVec3 pos(PxReal(x)*2.5f - 10.0f, 6.0f + random.next(0.0f, 4.0f), PxReal(z)*-1.0f - 1.0f);
+				const PxQuat rot(random.next(0.0f, PxTwoPi), random.nextVec3(-1.0f, 1.0f).getNormalized());
+				createRagdoll(physics, scene, *context.material, PxTransform(pos, rot.getNormalized()), random.nextVec3(-2.0f, 2.0f));
+			}
+		}
+	}
+
+private:
+	struct BodyPart
+	{
+		PxVec3	pos;
+		PxReal	radius;
+		PxReal	halfHeight;
+		bool	vertical;
+	};
+
+	struct JointDesc
+	{
+		PxU32	parent;
+		PxU32	child;
+		PxVec3	anchor;
+		PxVec3	axis;
+		PxReal	limit;
+	};
+
+	static void createRagdoll(PxPhysics& physics, PxScene& scene, PxMaterial& material, const PxTransform& pose, const PxVec3& velocity)
+	{
+		static const PxU32 nbParts = 11;
+		static const BodyPart parts[nbParts] =
+		{
+			{ PxVec3(0.0f, 1.0f, 0.0f),		0.15f, 0.10f, false },	// pelvis
+			{ PxVec3(0.0f, 1.35f, 0.0f),	0.15f, 0.15f, true },	// torso
+			{ PxVec3(0.0f, 1.8f, 0.0f),		0.12f, 0.02f, true },	// head
+			{ PxVec3(-0.45f, 1.55f, 0.0f),	0.06f, 0.15f, false },	// upper arms
+			{ PxVec3(0.45f, 1.55f, 0.0f),	0.06f, 0.15f, false },
+			{ PxVec3(-0.8f, 1.55f, 0.0f),	0.05f, 0.15f, false },	// lower arms
+			{ PxVec3(0.8f, 1.55f, 0.0f),	0.05f, 0.15f, false },
+			{ PxVec3(-0.12f, 0.7f, 0.0f),	0.08f, 0.15f, true },	// upper legs
+			{ PxVec3(0.12f, 0.7f, 0.0f),	0.08f, 0.15f, true },
+			{ PxVec3(-0.12f, 0.25f, 0.0f),	0.07f, 0.15f, true },	// lower legs
+			{ PxVec3(0.12f, 0.25f, 0.0f),	0.07f, 0.15f, true },
+		};
+
+		static const PxU32 nbJoints = 10;
+		static const JointDesc joints[nbJoints] =
+		{
+			{ 0, 1, PxVec3(0.0f, 1.12f, 0.0f),		PxVec3(0.0f, 1.0f, 0.0f),	0.5f },
+			{ 1, 2, PxVec3(0.0f, 1.65f, 0.0f),		PxVec3(0.0f, 1.0f, 0.0f),	0.6f },
+			{ 1, 3, PxVec3(-0.28f, 1.55f, 0.0f),	PxVec3(-1.0f, 0.0f, 0.0f),	1.2f },
+			{ 1, 4, PxVec3(0.28f, 1.55f, 0.0f),		PxVec3(1.0f, 0.0f, 0.0f),	1.2f },
+			{ 3, 5, PxVec3(-0.63f, 1.55f, 0.0f),	PxVec3(-1.0f, 0.0f, 0.0f),	1.0f },
+			{ 4, 6, PxVec3(0.63f, 1.55f, 0.0f),		PxVec3(1.0f, 0.0f, 0.0f),	1.0f },
+			{ 0, 7, PxVec3(-0.12f, 0.9f, 0.0f),		PxVec3(0.0f, -1.0f, 0.0f),	0.8f },
+			{ 0, 8, PxVec3(0.12f, 0.9f, 0.0f),		PxVec3(0.0f, -1.0f, 0.0f),	0.8f },
+			{ 7, 9, PxVec3(-0.12f, 0.47f, 0.0f),	PxVec3(0.0f, -1.0f, 0.0f),	0.7f },
+			{ 8, 10, PxVec3(0.12f, 0.47f, 0.0f),	PxVec3(0.0f, -1.0f, 0.0f),	0.7f },
+		};
+
+		PxAggregate* aggregate = physics.createAggregate(nbParts, false);
+
+		const PxTransform verticalPose(PxQuat(PxHalfPi, PxVec3(0.0f, 0.0f, 1.0f)));
+		PxRigidDynamic* bodies[nbParts];
+		for(PxU32 i=0;i<nbParts;i++)
+		{
+			const BodyPart& part = parts[i];
+			bodies[i] = physics.createRigidDynamic(pose.transform(PxTransform(part.pos)));
+			PxShape* shape = PxRigidActorExt::createExclusiveShape(*bodies[i], PxCapsuleGeometry(part.radius, part.halfHeight), material);
+			if(part.vertical)
+				shape->setLocalPose(verticalPose);
+			PxRigidBodyExt::updateMassAndInertia(*bodies[i], 1000.0f);
+			bodies[i]->setLinearVelocity(velocity);
+			bodies[i]->setSolverIterationCounts(8, 2);
+			aggregate->addActor(*bodies[i]);
+		}
+
+		for(PxU32 i=0;i<nbJoints;i++)
+		{
+			const JointDesc& desc = joints[i];
+			const PxQuat frameRot = PxShortestRotation(PxVec3(1.0f, 0.0f, 0.0f), desc.axis);
+			const PxTransform frame0(desc.anchor - parts[desc.parent].pos, frameRot);
+			const PxTransform frame1(desc.anchor - parts[desc.child].pos, frameRot);
+			PxSphericalJoint* joint = PxSphericalJointCreate(physics, bodies[desc.parent], frame0, bodies[desc.child], frame1);
+			joint->setLimitCone(PxJointLimitCone(desc.limit, desc.limit));
+			joint->setSphericalJointFlag(PxSphericalJointFlag::eLIMIT_ENABLED, true);
+		}
+
+		scene.addAggregate(*aggregate);
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// 100 4-wheeled vehicles driving and steering on a plane, with batched suspension raycasts.
+class VehicleFleetScene : public BenchmarkScene
+{
+public:
+	static const PxU32 NB_VEHICLES = 100;
+
+	VehicleFleetScene() : mFrictionPairs(NULL), mSceneQueryData(NULL), mBatchQuery(NULL), mAllocator(NULL), mMaterial(NULL)	{}
+
+	virtual	const char*	getName()	const	{ return "vehicles";	}
+
+	virtual	void	configure(PxSceneDesc& sceneDesc)
+	{
+		sceneDesc.filterShader = VehicleFilterShader;
+	}
+
+	virtual	void	create(const BenchmarkContext& context, PxScene& scene)
+	{
+		PxPhysics& physics = *context.physics;
+		BenchmarkRandom random(0x56656869);
+
+		mAllocator = context.allocator;
+		mMaterial = physics.createMaterial(0.5f, 0.5f, 0.6f);
+
+		PxInitVehicleSDK(physics);
+		PxVehicleSetBasisVectors(PxVec3(0,1,0), PxVec3(0,0,1));
+		PxVehicleSetUpdateMode(PxVehicleUpdateMode::eVELOCITY_CHANGE);
+
+		mSceneQueryData = VehicleSceneQueryData::allocate(NB_VEHICLES, PX_MAX_NB_WHEELS, 1, NB_VEHICLES, WheelSceneQueryPreFilterBlocking, NULL, *mAllocator);
+		mBatchQuery = VehicleSceneQueryData::setUpBatchedSceneQuery(0, *mSceneQueryData, &scene);
+
+		mFrictionPairs = createFrictionPairs(mMaterial);
+
+		const PxFilterData groundPlaneSimFilterData(COLLISION_FLAG_GROUND, COLLISION_FLAG_GROUND_AGAINST, 0, 0);
+		scene.addActor(*createDrivablePlane(groundPlaneSimFilterData, mMaterial, &physics));
+
+		const VehicleDesc vehicleDesc = initVehicleDesc();
+		for(PxU32 i=0;i<NB_VEHICLES;i++)
+		{
+			PxVehicleDrive4W* vehicle = createVehicle4W(vehicleDesc, &physics, context.cooking);
+			const PxVec3 pos(PxReal(i % 10)*8.0f - 40.0f, vehicleDesc.chassisDims.y*0.5f + vehicleDesc.wheelRadius + 1.0f, PxReal(i / 10)*12.0f - 60.0f);
+			vehicle->getRigidDynamicActor()->setGlobalPose(PxTransform(pos, PxQuat(random.next(-0.5f, 0.5f), PxVec3(0.0f, 1.0f, 0.0f))));
+			scene.addActor(*vehicle->getRigidDynamicActor());
+
+			vehicle->setToRestState();
+			vehicle->mDriveDynData.forceGearChange(PxVehicleGearsData::eFIRST);
+			vehicle->mDriveDynData.setUseAutoGears(true);
+
+			mVehicles[i] = vehicle;
+			mSteerPhases[i] = random.next(0.0f, PxTwoPi);
+		}
+	}
+
+	virtual	void	update(PxScene& scene, PxU32 frame, PxReal dt, BenchmarkStats& stats)
+	{
+		const PxU32 phase = stats.getPhase("vehicles");
+		BenchmarkPhaseScope scope(stats, phase);
+
+		PxReal forwardSpeed = 0.0f;
+		for(PxU32 i=0;i<NB_VEHICLES;i++)
+		{
+			PxVehicleDrive4W* vehicle = static_cast<PxVehicleDrive4W*>(mVehicles[i]);
+			vehicle->mDriveDynData.setAnalogInput(PxVehicleDrive4WControl::eANALOG_INPUT_ACCEL, 1.0f);
+			vehicle->mDriveDynData.setAnalogInput(PxVehicleDrive4WControl::eANALOG_INPUT_STEER_LEFT, 0.5f + 0.5f*PxSin(PxReal(frame)*0.02f + mSteerPhases[i]));
+			forwardSpeed += vehicle->computeForwardSpeed();
+		}
+
+		PxRaycastQueryResult* raycastResults = mSceneQueryData->getRaycastQueryResultBuffer(0);
+		const PxU32 raycastResultsSize = mSceneQueryData->getQueryResultBufferSize();
+		PxVehicleSuspensionRaycasts(mBatchQuery, NB_VEHICLES, mVehicles, raycastResultsSize, raycastResults);
+
+		PxVehicleUpdates(dt, scene.getGravity(), *mFrictionPairs, NB_VEHICLES, mVehicles, NULL);
+
+		stats.addCounter("forwardSpeed", PxF64(forwardSpeed / PxReal(NB_VEHICLES)));
+	}
+
+	virtual	void	release(PxScene& /*scene*/)
+	{
+		for(PxU32 i=0;i<NB_VEHICLES;i++)
+		{
+			mVehicles[i]->getRigidDynamicActor()->release();
+			static_cast<PxVehicleDrive4W*>(mVehicles[i])->free();
+		}
+		PX_RELEASE(mFrictionPairs);
+		PX_RELEASE(mBatchQuery);
+		mSceneQueryData->free(*mAllocator);
+		PX_RELEASE(mMaterial);
+		PxCloseVehicleSDK();
+	}
+
+private:
+	VehicleDesc	initVehicleDesc()	const
+	{
+		//Same vehicle as SnippetVehicle4W.
+		const PxF32 chassisMass = 1500.0f;
+		const PxVec3 chassisDims(2.5f,2.0f,5.0f);
+		const PxVec3 chassisMOI
+			((chassisDims.y*chassisDims.y + chassisDims.z*chassisDims.z)*chassisMass/12.0f,
+			 (chassisDims.x*chassisDims.x + chassisDims.z*chassisDims.z)*0.8f*chassisMass/12.0f,
+			 (chassisDims.x*chassisDims.x + chassisDims.y*chassisDims.y)*chassisMass/12.0f);
+		const PxVec3 chassisCMOffset(0.0f, -chassisDims.y*0.5f + 0.65f, 0.25f);
+
+		const PxF32 wheelMass = 20.0f;
+		const PxF32 wheelRadius = 0.5f;
+		const PxF32 wheelWidth = 0.4f;
+		const PxF32 wheelMOI = 0.5f*wheelMass*wheelRadius*wheelRadius;
+
+		VehicleDesc vehicleDesc;
+		vehicleDesc.chassisMass = chassisMass;
+		vehicleDesc.chassisDims = chassisDims;
+		vehicleDesc.chassisMOI = chassisMOI;
+		vehicleDesc.chassisCMOffset = chassisCMOffset;
+		vehicleDesc.chassisMaterial = mMaterial;
+		vehicleDesc.chassisSimFilterData = PxFilterData(COLLISION_FLAG_CHASSIS, COLLISION_FLAG_CHASSIS_AGAINST, 0, 0);
+
+		vehicleDesc.wheelMass = wheelMass;
+		vehicleDesc.wheelRadius = wheelRadius;
+		vehicleDesc.wheelWidth = wheelWidth;
+		vehicleDesc.wheelMOI = wheelMOI;
+		vehicleDesc.numWheels = 4;
+		vehicleDesc.wheelMaterial = mMaterial;
+		vehicleDesc.wheelSimFilterData = PxFilterData(COLLISION_FLAG_WHEEL, COLLISION_FLAG_WHEEL_AGAINST, 0, 0);
+		return vehicleDesc;
+	}
+
+	PxVehicleWheels*								mVehicles[NB_VEHICLES];
+	PxReal											mSteerPhases[NB_VEHICLES];
+	PxVehicleDrivableSurfaceToTireFrictionPairs*	mFrictionPairs;
+	VehicleSceneQueryData*							mSceneQueryData;
+	PxBatchQuery*									mBatchQuery;
+	PxAllocatorCallback*							mAllocator;
+	PxMaterial*										mMaterial;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// A crowd of capsule character controllers walking to random targets between obstacles.
+class ControllerCrowdScene : public BenchmarkScene
+{
+public:
+	static const PxU32 NB_CONTROLLERS = 256;
+
+	ControllerCrowdScene() : mManager(NULL), mRandom(0x43435443)	{}
+
+	virtual	const char*	getName()	const	{ return "cct";	}
+
+	virtual	void	create(const BenchmarkContext& context, PxScene& scene)
+	{
+		PxPhysics& physics = *context.physics;
+
+		scene.addActor(*PxCreatePlane(physics, PxPlane(0,1,0,0), *context.material));
+		for(PxU32 i=0;i<64;i++)
+		{
+			const PxVec3 extents = mRandom.nextVec3(0.5f, 2.0f);
+			const PxVec3 pos(mRandom.next(-30.0f, 30.0f), extents.y, mRandom.next(-30.0f, 30.0f));
+			scene.addActor(*PxCreateStatic(physics, PxTransform(pos, PxQuat(mRandom.next(0.0f, PxPi), PxVec3(0.0f, 1.0f, 0.0f))), PxBoxGeometry(extents), *context.material));
+		}
+
+		mManager = PxCreateControllerManager(scene);
+
+		PxCapsuleControllerDesc desc;
+		desc.radius			= 0.4f;
+		desc.height			= 1.2f;
+		desc.stepOffset		= 0.3f;
+		desc.contactOffset	= 0.05f;
+		desc.material		= context.material;
+		for(PxU32 i=0;i<NB_CONTROLLERS;i++)
+		{
+			desc.position = PxExtendedVec3(PxReal(i % 16)*4.0f - 32.0f, 1.5f, PxReal(i / 16)*4.0f - 32.0f);
+			mControllers[i] = mManager->createController(desc);
+			mTargets[i] = nextTarget();
+			mVerticalSpeeds[i] = 0.0f;
+		}
+	}
+
+	virtual	void	update(PxScene& scene, PxU32 /*frame*/, PxReal dt, BenchmarkStats& stats)
+	{
+		const PxU32 phase = stats.getPhase("controllers");
+		BenchmarkPhaseScope scope(stats, phase);
+
+		PxU32 nbSideCollisions = 0;
+		PxU32 nbDownCollisions = 0;
+		const PxControllerFilters filters;
+		for(PxU32 i=0;i<NB_CONTROLLERS;i++)
+		{
+			PxController* controller = mControllers[i];
+			const PxExtendedVec3& pos = controller->getFootPosition();
+			PxVec3 dir(mTargets[i].x - PxReal(pos.x), 0.0f, mTargets[i].z - PxReal(pos.z));
+			const PxReal dist = dir.normalize();
+			if(dist<1.0f)
+				mTargets[i] = nextTarget();
+
+			mVerticalSpeeds[i] += scene.getGravity().y * dt;
+			const PxVec3 disp = dir * (3.0f * dt) + PxVec3(0.0f, mVerticalSpeeds[i] * dt, 0.0f);
+			const PxControllerCollisionFlags flags = controller->move(disp, 0.001f, dt, filters);
+			if(flags & PxControllerCollisionFlag::eCOLLISION_SIDES)
+				nbSideCollisions++;
+			if(flags & PxControllerCollisionFlag::eCOLLISION_DOWN)
+			{
+				nbDownCollisions++;
+				mVerticalSpeeds[i] = 0.0f;
+			}
+		}
+
+		stats.addCounter("sideCollisions", PxF64(nbSideCollisions));
+		stats.addCounter("downCollisions", PxF64(nbDownCollisions));
+	}
+
+	virtual	void	release(PxScene& /*scene*/)
+	{
+		PX_RELEASE(mManager);
+	}
+
+private:
+	PxVec3	nextTarget()
+	{
+		return PxVec3(mRandom.next(-36.0f, 36.0f), 0.0f, mRandom.next(-36.0f, 36.0f));
+	}
+
+	PxControllerManager*	mManager;
+	PxController*			mControllers[NB_CONTROLLERS];
+	PxVec3					mTargets[NB_CONTROLLERS];
+	PxReal					mVerticalSpeeds[NB_CONTROLLERS];
+	BenchmarkRandom			mRandom;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Raycasts, sweeps and overlaps against a scene of static and dynamic shapes.
+class SceneQueryStormScene : public BenchmarkScene
+{
+public:
+	SceneQueryStormScene() : mRandom(0x53514c53)	{}
+
+	virtual	const char*	getName()	const	{ return "queries";	}
+
+	virtual	void	create(const BenchmarkContext& context, PxScene& scene)
+	{
+		PxPhysics& physics = *context.physics;
+		PxMaterial& material = *context.material;
+
+		scene.addActor(*PxCreatePlane(physics, PxPlane(0,1,0,0), material));
+
+		for(PxU32 i=0;i<4096;i++)
+		{
+			const PxTransform pose(PxVec3(mRandom.next(-100.0f, 100.0f), mRandom.next(0.0f, 50.0f), mRandom.next(-100.0f, 100.0f)));
+			scene.addActor(*PxCreateStatic(physics, pose, randomGeometry().any(), material));
+		}
+
+		for(PxU32 i=0;i<1024;i++)
+		{
+			const PxTransform pose(PxVec3(mRandom.next(-50.0f, 50.0f), mRandom.next(5.0f, 60.0f), mRandom.next(-50.0f, 50.0f)));
+			scene.addActor(*PxCreateDynamic(physics, pose, randomGeometry().any(), material, 1.0f));
+		}
+	}
+
+	virtual	void	update(PxScene& scene, PxU32 /*frame*/, PxReal /*dt*/, BenchmarkStats& stats)
+	{
+		const PxU32 phase = stats.getPhase("queries");
+		BenchmarkPhaseScope scope(stats, phase);
+
+		PxU32 nbRaycastHits = 0;
+		for(PxU32 i=0;i<4096;i++)
+		{
+			const PxVec3 origin(mRandom.next(-100.0f, 100.0f), mRandom.next(0.0f, 50.0f), mRandom.next(-100.0f, 100.0f));
+			const PxVec3 dir = mRandom.nextVec3(-1.0f, 1.0f).getNormalized();
+			PxRaycastBuffer hit;
+			if(scene.raycast(origin, dir, 100.0f, hit))
+				nbRaycastHits++;
+		}
+
+		PxU32 nbSweepHits = 0;
+		const PxSphereGeometry sweptSphere(0.5f);
+		for(PxU32 i=0;i<512;i++)
+		{
+			const PxTransform pose(PxVec3(mRandom.next(-100.0f, 100.0f), mRandom.next(0.0f, 50.0f), mRandom.next(-100.0f, 100.0f)));
+			const PxVec3 dir = mRandom.nextVec3(-1.0f, 1.0f).getNormalized();
+			PxSweepBuffer hit;
+			if(scene.sweep(sweptSphere, pose, dir, 50.0f, hit))
+				nbSweepHits++;
+		}
+
+		PxU32 nbOverlapHits = 0;
+		const PxBoxGeometry overlapBox(4.0f, 4.0f, 4.0f);
+		const PxQueryFilterData overlapFilterData(PxQueryFlag::eSTATIC | PxQueryFlag::eDYNAMIC | PxQueryFlag::eNO_BLOCK);
+		PxOverlapHit overlapHits[256];
+		for(PxU32 i=0;i<512;i++)
+		{
+			const PxTransform pose(PxVec3(mRandom.next(-100.0f, 100.0f), mRandom.next(0.0f, 50.0f), mRandom.next(-100.0f, 100.0f)));
+			PxOverlapBuffer hits(overlapHits, 256);
+			scene.overlap(overlapBox, pose, hits, overlapFilterData);
+			nbOverlapHits += hits.getNbTouches();
+		}
+
+		stats.addCounter("raycastHits", PxF64(nbRaycastHits));
+		stats.addCounter("sweepHits", PxF64(nbSweepHits));
+		stats.addCounter("overlapHits", PxF64(nbOverlapHits));
+	}
+
+private:
+	PxGeometryHolder	randomGeometry()
+	{
+		PxGeometryHolder holder;
+		switch(mRandom.nextU32() % 3)
+		{
+			case 0:		holder.storeAny(PxBoxGeometry(mRandom.nextVec3(0.25f, 1.5f)));					break;
+			case 1:		holder.storeAny(PxSphereGeometry(mRandom.next(0.25f, 1.5f)));					break;
+			default:	holder.storeAny(PxCapsuleGeometry(mRandom.next(0.25f, 1.0f), mRandom.next(0.25f, 1.0f)));	break;
+		}
+		return holder;
+	}
+
+	BenchmarkRandom	mRandom;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// A large world streamed in and out around a moving viewer. The world is made of square tiles with
+// static buildings and dynamic crates. Tile columns are added in front of the viewer and removed
+// behind it, so actors are added to and removed from the scene every few frames.
+class StreamingScene : public BenchmarkScene
+{
+public:
+	static const PxU32	NB_TILES_PER_COLUMN	= 9;
+	static const PxU32	NB_LOADED_COLUMNS	= 9;
+
+	StreamingScene() : mPhysics(NULL), mMaterial(NULL), mFirstColumn(0)	{}
+
+	virtual	const char*	getName()	const	{ return "streaming";	}
+
+	virtual	void	create(const BenchmarkContext& context, PxScene& scene)
+	{
+		mPhysics = context.physics;
+		mMaterial = context.material;
+
+		//Columns are loaded around the viewer, which starts at the origin.
+		mFirstColumn = -PxI32(NB_LOADED_COLUMNS/2);
+		for(PxU32 i=0;i<NB_LOADED_COLUMNS;i++)
+			loadColumn(scene, mFirstColumn + PxI32(i));
+	}
+
+	virtual	void	update(PxScene& scene, PxU32 frame, PxReal /*dt*/, BenchmarkStats& stats)
+	{
+		const PxU32 phase = stats.getPhase("streaming");
+		BenchmarkPhaseScope scope(stats, phase);
+
+		//The viewer moves by one meter per frame, i.e. one tile every 16 frames.
+		const PxReal viewerX = PxReal(frame);
+		const PxI32 viewerColumn = PxI32(viewerX / TILE_SIZE);
+		const PxI32 firstColumn = viewerColumn - PxI32(NB_LOADED_COLUMNS/2);
+
+		PxU32 nbAdded = 0;
+		PxU32 nbRemoved = 0;
+		while(mFirstColumn < firstColumn)
+		{
+			nbRemoved += unloadColumn(scene, mFirstColumn);
+			nbAdded += loadColumn(scene, mFirstColumn + PxI32(NB_LOADED_COLUMNS));
+			mFirstColumn++;
+		}
+
+		stats.addCounter("actorsAdded", PxF64(nbAdded));
+		stats.addCounter("actorsRemoved", PxF64(nbRemoved));
+	}
+
+	virtual	void	release(PxScene& scene)
+	{
+		for(PxU32 i=0;i<NB_LOADED_COLUMNS;i++)
+			unloadColumn(scene, mFirstColumn + PxI32(i));
+	}
+
+private:
+	static const PxReal TILE_SIZE;
+
+	shdfnd::Array<PxRigidActor*>&	getColumn(PxI32 column)
+	{
+		return mColumns[PxU32(column + 1024*PxI32(NB_LOADED_COLUMNS)) % NB_LOADED_COLUMNS];
+	}
+
+	PxU32	loadColumn(PxScene& scene, PxI32 column)
+	{
+		shdfnd::Array<PxRigidActor*>& actors = getColumn(column);
+		PX_ASSERT(actors.empty());
+
+		for(PxU32 i=0;i<NB_TILES_PER_COLUMN;i++)
+		{
+			const PxI32 row = PxI32(i) - PxI32(NB_TILES_PER_COLUMN/2);
+			BenchmarkRandom random(PxU32(column)*7919u + PxU32(row + 1000)*104729u);
+
+			const PxVec3 tileCenter(PxReal(column)*TILE_SIZE, 0.0f, PxReal(row)*TILE_SIZE);
+			actors.pushBack(PxCreateStatic(*mPhysics, PxTransform(tileCenter - PxVec3(0.0f, 0.5f, 0.0f)), PxBoxGeometry(TILE_SIZE*0.5f, 0.5f, TILE_SIZE*0.5f), *mMaterial));
+
+			for(PxU32 j=0;j<6;j++)
+			{
+				const PxVec3 extents(random.next(0.5f, 2.0f), random.next(1.0f, 6.0f), random.next(0.5f, 2.0f));
+				const PxVec3 pos = tileCenter + PxVec3(random.next(-6.0f, 6.0f), extents.y, random.next(-6.0f, 6.0f));
+				actors.pushBack(PxCreateStatic(*mPhysics, PxTransform(pos), PxBoxGeometry(extents), *mMaterial));
+			}
+
+			for(PxU32 j=0;j<12;j++)
+			{
+				const PxVec3 pos = tileCenter + PxVec3(random.next(-7.0f, 7.0f), random.next(1.0f, 12.0f), random.next(-7.0f, 7.0f));
+				actors.pushBack(PxCreateDynamic(*mPhysics, PxTransform(pos), PxBoxGeometry(0.4f, 0.4f, 0.4f), *mMaterial, 1.0f));
+			}
+		}
+
+		scene.addActors(reinterpret_cast<PxActor*const*>(actors.begin()), actors.size());
+		return actors.size();
+	}
+
+	PxU32	unloadColumn(PxScene& scene, PxI32 column)
+	{
+		shdfnd::Array<PxRigidActor*>& actors = getColumn(column);
+		const PxU32 nbActors = actors.size();
+		scene.removeActors(reinterpret_cast<PxActor*const*>(actors.begin()), nbActors);
+		for(PxU32 i=0;i<nbActors;i++)
+			actors[i]->release();
+		actors.clear();
+		return nbActors;
+	}
+
+	PxPhysics*						mPhysics;
+	PxMaterial*						mMaterial;
+	shdfnd::Array<PxRigidActor*>	mColumns[NB_LOADED_COLUMNS];
+	PxI32							mFirstColumn;
+};
+
+const PxReal StreamingScene::TILE_SIZE = 16.0f;
+
+///////////////////////////////////////////////////////////////////////////////
+
+PxU32 getNbBenchmarkScenes()
+{
+	return 7;
+}
+
+BenchmarkScene* createBenchmarkScene(PxU32 index)
+{
+	switch(index)
+	{
+		case 0:	return new KaplaTowerScene;
+		case 1:	return new ConvexPileScene;
+		case 2:	return new RagdollScene;
+		case 3:	return new VehicleFleetScene;
+		case 4:	return new ControllerCrowdScene;
+		case 5:	return new SceneQueryStormScene;
+		case 6:	return new StreamingScene;
+	}
+	return NULL;
+}
+
+} // namespace snippetbenchmark
@@ -0,0 +1,148 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef SNIPPET_BENCHMARK_SCENES_H
+#define SNIPPET_BENCHMARK_SCENES_H
+
+#include "PxPhysicsAPI.h"
+
+namespace snippetbenchmark
+{
+
+using namespace physx;
+
+static const PxU32 MAX_NB_PHASES	= 8;
+static const PxU32 MAX_NB_COUNTERS	= 24;
+
+//Per-phase timings and counters gathered while a benchmark scene runs. Phase and counter names
+//must be string literals, they are stored by pointer.
+class BenchmarkStats
+{
+public:
+	struct Phase
+	{
+		const char*	name;
+		PxU64		frameTicks;		//time spent in the phase during the current frame
+		PxF64		totalMs;
+		PxF64		minMs;
+		PxF64		maxMs;
+	};
+
+	struct Counter
+	{
+		const char*	name;
+		PxF64		total;
+	};
+
+	BenchmarkStats();
+
+	PxU32	getPhase(const char* name);
+	void	addPhaseTime(PxU32 phase, PxU64 ticks)	{ mPhases[phase].frameTicks += ticks;	}
+	void	addCounter(const char* name, PxF64 value);
+
+	void	beginFrame();
+	void	endFrame();
+
+	PxU32			getNbFrames()				const	{ return mNbFrames;		}
+	PxU32			getNbPhases()				const	{ return mNbPhases;		}
+	const Phase&	getPhaseData(PxU32 i)		const	{ return mPhases[i];	}
+	PxU32			getNbCounters()				const	{ return mNbCounters;	}
+	const Counter&	getCounterData(PxU32 i)		const	{ return mCounters[i];	}
+
+private:
+	Phase		mPhases[MAX_NB_PHASES];
+	Counter		mCounters[MAX_NB_COUNTERS];
+	PxU32		mNbPhases;
+	PxU32		mNbCounters;
+	PxU32		mNbFrames;
+};
+
+//Times a block of code and adds the result to a phase of the current frame.
+class BenchmarkPhaseScope
+{
+public:
+	BenchmarkPhaseScope(BenchmarkStats& stats, PxU32 phase);
+	~BenchmarkPhaseScope();
+private:
+	BenchmarkPhaseScope& operator=(const BenchmarkPhaseScope&);
+	BenchmarkStats&	mStats;
+	const PxU32		mPhase;
+	const PxU64		mStartTime;
+};
+
+//Small deterministic random number generator, so that every run creates and drives the same scenes.
+class BenchmarkRandom
+{
+public:
+	BenchmarkRandom(PxU32 seed) : mState(seed)	{}
+
+	PxU32	nextU32()	{ mState = mState * 1664525u + 1013904223u; return mState >> 8;		}
+	PxReal	next()		{ return PxReal(nextU32() & 0xffff) / 65535.0f;						}
+	PxReal	next(PxReal minValue, PxReal maxValue)	{ return minValue + (maxValue - minValue) * next();	}
+	PxVec3	nextVec3(PxReal minValue, PxReal maxValue)
+	{
+		const PxReal x = next(minValue, maxValue);
+		const PxReal y = next(minValue, maxValue);
+		const PxReal z = next(minValue, maxValue);
+		return PxVec3(x, y, z);
+	}
+
+private:
+	PxU32	mState;
+};
+
+struct BenchmarkContext
+{
+	PxPhysics*		physics;
+	PxCooking*		cooking;
+	PxMaterial*		material;
+	PxAllocatorCallback*	allocator;
+};
+
+//A canonical benchmark scene. The runner creates the PxScene, calls create() once, then calls update()
+//before each simulate() call. Work done outside of simulate() (vehicles, controllers, queries, streaming)
+//is timed by the scene itself with its own phases.
+class BenchmarkScene
+{
+public:
+	virtual					~BenchmarkScene()	{}
+
+	virtual	const char*		getName()	const	= 0;
+	virtual	void			configure(PxSceneDesc& /*sceneDesc*/)	{}
+	virtual	void			create(const BenchmarkContext& context, PxScene& scene)	= 0;
+	virtual	void			update(PxScene& /*scene*/, PxU32 /*frame*/, PxReal /*dt*/, BenchmarkStats& /*stats*/)	{}
+	virtual	void			release(PxScene& /*scene*/)	{}
+};
+
+PxU32			getNbBenchmarkScenes();
+BenchmarkScene*	createBenchmarkScene(PxU32 index);
+
+} // namespace snippetbenchmark
+
+#endif //SNIPPET_BENCHMARK_SCENES_H
@@ -0,0 +1,220 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+// ****************************************************************************
+// This snippet checks PxScene::closestShapes against a brute force search. A
+// scene of boxes, spheres and capsules is queried from random points, with
+// each pruning structure type. Some actors are added after the first
+// simulation step and some are moved, so that they are found in the pruners'
+// incremental structures, and some are added through a PxPruningStructure.
+// The distances found must match the k smallest point-shape distances
+// computed with PxGeometryQuery::pointDistance for every shape.
+// ****************************************************************************
+
+#include <stdlib.h>
+#include "PxPhysicsAPI.h"
+
+#include "../snippetutils/SnippetUtils.h"
+#include "../snippetcommon/SnippetPrint.h"
+
+using namespace physx;
+
+PxDefaultAllocator		gAllocator;
+PxDefaultErrorCallback	gErrorCallback;
+
+PxFoundation*			gFoundation = NULL;
+PxPhysics*				gPhysics	= NULL;
+PxDefaultCpuDispatcher*	gDispatcher = NULL;
+PxMaterial*				gMaterial	= NULL;
+
+static const PxU32		gNbActors		= 2000;
+static const PxU32		gNbLateActors	= 200;
+static const PxU32		gNbQueries		= 500;
+static const PxU32		gMaxNbHits		= 16;
+static const PxReal		gTolerance		= 1e-4f;
+
+static const PxPruningStructureType::Enum	gStructures[] = { PxPruningStructureType::eSTATIC_AABB_TREE, PxPruningStructureType::eDYNAMIC_AABB_TREE, PxPruningStructureType::eWIDE_AABB_TREE };
+static const char*							gStructureNames[] = { "static AABB tree", "dynamic AABB tree", "wide AABB tree" };
+
+static PxReal random(PxU32& seed)
+{
+	seed = seed * 1664525 + 1013904223;
+	return PxReal(seed >> 8) / PxReal(1 << 24);
+}
+
+static PxVec3 randomPosition(PxU32& seed)
+{
+	return PxVec3(random(seed)*200.0f - 100.0f, random(seed)*50.0f, random(seed)*200.0f - 100.0f);
+}
+
+static PxRigidActor* createActor(PxU32& seed, bool isStatic)
+{
+	const PxTransform pose(randomPosition(seed), PxQuat(random(seed)*PxTwoPi, PxVec3(random(seed), random(seed), random(seed) + 0.1f).getNormalized()));
+	PxRigidActor* actor = isStatic ? static_cast<PxRigidActor*>(gPhysics->createRigidStatic(pose)) : static_cast<PxRigidActor*>(gPhysics->createRigidDynamic(pose));
+	if(!isStatic)
+		static_cast<PxRigidDynamic*>(actor)->setRigidBodyFlag(PxRigidBodyFlag::eKINEMATIC, true);
+
+	const PxReal r = random(seed);
+	if(r < 0.4f)
+		PxRigidActorExt::createExclusiveShape(*actor, PxBoxGeometry(random(seed)*2.0f + 0.1f, random(seed)*2.0f + 0.1f, random(seed)*2.0f + 0.1f), *gMaterial);
+	else if(r < 0.7f)
+		PxRigidActorExt::createExclusiveShape(*actor, PxSphereGeometry(random(seed)*2.0f + 0.1f), *gMaterial);
+	else
+		PxRigidActorExt::createExclusiveShape(*actor, PxCapsuleGeometry(random(seed) + 0.1f, random(seed)*2.0f + 0.1f), *gMaterial);
+	return actor;
+}
+
+static PxScene* createScene(PxPruningStructureType::Enum structure)
+{
+	PxSceneDesc sceneDesc(gPhysics->getTolerancesScale());
+	sceneDesc.cpuDispatcher	= gDispatcher;
+	sceneDesc.filterShader	= PxDefaultSimulationFilterShader;
+	sceneDesc.staticStructure = structure;
+	sceneDesc.dynamicStructure = structure==PxPruningStructureType::eSTATIC_AABB_TREE ? PxPruningStructureType::eDYNAMIC_AABB_TREE : structure;
+	PxScene* scene = gPhysics->createScene(sceneDesc);
+
+	PxU32 seed = 1;
+	for(PxU32 i=0; i<gNbActors; i++)
+		scene->addActor(*createActor(seed, (i&1)!=0));
+
+	scene->simulate(1.0f/60.0f);
+	scene->fetchResults(true);
+
+	// Late actors go to the incremental parts of the pruners, and moved ones are refit or reinserted.
+	for(PxU32 i=0; i<gNbLateActors; i++)
+		scene->addActor(*createActor(seed, (i&1)!=0));
+
+	PxRigidActor* merged[gNbLateActors];
+	for(PxU32 i=0; i<gNbLateActors; i++)
+		merged[i] = createActor(seed, (i&1)!=0);
+	PxPruningStructure* pruningStructure = gPhysics->createPruningStructure(merged, gNbLateActors);
+	scene->addActors(*pruningStructure);
+	pruningStructure->release();
+
+	PxActor* actors[gNbActors];
+	const PxU32 nbDynamics = scene->getActors(PxActorTypeFlag::eRIGID_DYNAMIC, actors, gNbActors);
+	for(PxU32 i=0; i<nbDynamics; i+=3)
+		static_cast<PxRigidDynamic*>(actors[i])->setGlobalPose(PxTransform(randomPosition(seed)));
+
+	return scene;
+}
+
+// Returns the sorted distances of the k closest shapes of the scene
+static PxU32 bruteForceClosest(PxActor*const* actors, PxU32 nbActors, const PxVec3& point, PxReal maxDistance, PxReal* distances)
+{
+	PxU32 nbHits = 0;
+	for(PxU32 i=0; i<nbActors; i++)
+	{
+		PxRigidActor* rigidActor = static_cast<PxRigidActor*>(actors[i]);
+
+		PxShape* shape;
+		rigidActor->getShapes(&shape, 1);
+		const PxReal d = PxSqrt(PxGeometryQuery::pointDistance(point, shape->getGeometry().any(), PxShapeExt::getGlobalPose(*shape, *rigidActor)));
+		if(d > maxDistance)
+			continue;
+
+		// Insertion in the sorted list of the closest distances
+		PxU32 j = PxMin(nbHits, gMaxNbHits-1);
+		if(nbHits==gMaxNbHits && d >= distances[j])
+			continue;
+		while(j && distances[j-1] > d)
+		{
+			distances[j] = distances[j-1];
+			j--;
+		}
+		distances[j] = d;
+		nbHits = PxMin(nbHits+1, gMaxNbHits);
+	}
+	return nbHits;
+}
+
+static bool checkScene(PxScene* scene, const char* name)
+{
+	const PxActorTypeFlags actorTypes = PxActorTypeFlag::eRIGID_STATIC|PxActorTypeFlag::eRIGID_DYNAMIC;
+	const PxU32 nbActors = scene->getNbActors(actorTypes);
+	PxActor** actors = new PxActor*[nbActors];
+	scene->getActors(actorTypes, actors, nbActors);
+
+	PxU32 seed = 1234;
+	PxU32 nbErrors = 0;
+	PxU32 nbFound = 0;
+	for(PxU32 q=0; q<gNbQueries; q++)
+	{
+		const PxVec3 point = randomPosition(seed);
+		// Small, medium and unbounded search distances
+		const PxReal maxDistance = (q%3)==0 ? 5.0f : (q%3)==1 ? 30.0f : PX_MAX_F32;
+		const PxU32 maxNbHits = 1 + q % gMaxNbHits;
+
+		PxClosestHit hits[gMaxNbHits];
+		const PxU32 nbHits = scene->closestShapes(point, maxDistance, hits, maxNbHits);
+
+		PxReal expected[gMaxNbHits];
+		const PxU32 nbExpected = PxMin(bruteForceClosest(actors, nbActors, point, maxDistance, expected), maxNbHits);
+
+		bool ok = nbHits==nbExpected;
+		for(PxU32 i=0; ok && i<nbHits; i++)
+			ok = PxAbs(hits[i].distance - expected[i]) <= gTolerance * PxMax(1.0f, expected[i]);
+		if(!ok)
+		{
+			if(nbErrors < 5)
+				printf("%s, query %d: %d hits, %d expected\n", name, q, nbHits, nbExpected);
+			nbErrors++;
+		}
+		nbFound += nbHits;
+	}
+	delete [] actors;
+
+	printf("%-20s %s (%d queries, %d hits)\n", name, nbErrors ? "FAILED" : "ok", gNbQueries, nbFound);
+	return !nbErrors;
+}
+
+int snippetMain(int, const char*const*)
+{
+	gFoundation = PxCreateFoundation(PX_PHYSICS_VERSION, gAllocator, gErrorCallback);
+	gPhysics = PxCreatePhysics(PX_PHYSICS_VERSION, *gFoundation, PxTolerancesScale());
+	gDispatcher = PxDefaultCpuDispatcherCreate(2);
+	gMaterial = gPhysics->createMaterial(0.5f, 0.5f, 0.6f);
+
+	bool success = true;
+	for(PxU32 i=0; i<sizeof(gStructures)/sizeof(gStructures[0]); i++)
+	{
+		PxScene* scene = createScene(gStructures[i]);
+		success &= checkScene(scene, gStructureNames[i]);
+		scene->release();
+	}
+
+	PX_RELEASE(gMaterial);
+	PX_RELEASE(gDispatcher);
+	PX_RELEASE(gPhysics);
+	PX_RELEASE(gFoundation);
+
+	printf("SnippetClosestShapes %s.\n", success ? "done" : "failed");
+
+	return success ? 0 : 1;
+}
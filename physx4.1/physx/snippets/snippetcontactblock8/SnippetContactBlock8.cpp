@@ -0,0 +1,189 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+
+// ****************************************************************************
+// This snippet compares the 8-wide contact blocks built for patch friction on
+// AVX2 CPUs with the 4-wide blocks they replace. The same scene of box stacks
+// and box pyramids is simulated with the 8-wide blocks enabled and disabled, and
+// the poses of all boxes must stay within a small tolerance of each other. The
+// best average simulation time of a few runs is printed for both, with a high solver
+// iteration count so that it is dominated by the solver iteration loops.
+// ****************************************************************************
+
+#include "PxPhysicsAPI.h"
+#include "CmPhysXCommon.h"
+#include "DySolverBody.h"
+#include "DySolverControl.h"
+
+#include "../snippetutils/SnippetUtils.h"
+#include "../snippetcommon/SnippetPrint.h"
+
+using namespace physx;
+
+PxDefaultAllocator		gAllocator;
+PxDefaultErrorCallback	gErrorCallback;
+
+PxFoundation*			gFoundation = NULL;
+PxPhysics*				gPhysics	= NULL;
+PxMaterial*				gMaterial	= NULL;
+
+static const PxU32		gNbStacksPerSide	= 6;
+static const PxU32		gStackHeight		= 10;
+static const PxU32		gNbPyramids			= 6;
+static const PxU32		gPyramidSize		= 10;
+static const PxU32		gNbFrames			= 300;
+static const PxU32		gNbIterations		= 32;
+static const PxU32		gNbRuns				= 3;
+static const PxReal		gTolerance			= 0.01f;
+
+static PxU32			gNbBoxes			= 0;
+
+static void createScene(PxScene* scene)
+{
+	scene->addActor(*PxCreatePlane(*gPhysics, PxPlane(0.0f, 1.0f, 0.0f, 0.0f), *gMaterial));
+
+	const PxReal halfExtent = 0.5f;
+	const PxBoxGeometry box(halfExtent, halfExtent, halfExtent);
+
+	// Single box stacks, one contact pair per level and many independent pairs to batch
+	const PxReal spacing = 3.0f;
+	for(PxU32 i=0; i<gNbStacksPerSide; i++)
+	{
+		for(PxU32 j=0; j<gNbStacksPerSide; j++)
+		{
+			const PxVec3 base(PxReal(i) * spacing, halfExtent, PxReal(j) * spacing);
+			for(PxU32 level=0; level<gStackHeight; level++)
+			{
+				PxRigidDynamic* actor = PxCreateDynamic(*gPhysics, PxTransform(base + PxVec3(0.0f, PxReal(level)*halfExtent*2.0f, 0.0f)), box, *gMaterial, 1.0f);
+				actor->setSolverIterationCounts(gNbIterations);
+				actor->setSleepThreshold(0.0f);
+				scene->addActor(*actor);
+			}
+		}
+	}
+
+	// Box pyramids, where each box rests on two others
+	for(PxU32 k=0; k<gNbPyramids; k++)
+	{
+		const PxVec3 base(0.0f, halfExtent, -5.0f - PxReal(k) * spacing);
+		for(PxU32 i=0; i<gPyramidSize; i++)
+		{
+			for(PxU32 j=0; j<gPyramidSize-i; j++)
+			{
+				const PxVec3 offset(PxReal(j*2) - PxReal(gPyramidSize-i), PxReal(i*2), 0.0f);
+				PxRigidDynamic* actor = PxCreateDynamic(*gPhysics, PxTransform(base + offset*halfExtent), box, *gMaterial, 1.0f);
+				actor->setSolverIterationCounts(gNbIterations);
+				actor->setSleepThreshold(0.0f);
+				scene->addActor(*actor);
+			}
+		}
+	}
+}
+
+// Returns the average simulation time in milliseconds and the final poses of the boxes
+static PxReal simulate(bool block8, PxTransform* poses)
+{
+	Dy::setContactBlock8Enabled(block8);
+
+	PxDefaultCpuDispatcher* dispatcher = PxDefaultCpuDispatcherCreate(0);
+
+	PxSceneDesc sceneDesc(gPhysics->getTolerancesScale());
+	sceneDesc.gravity = PxVec3(0.0f, -9.81f, 0.0f);
+	sceneDesc.cpuDispatcher	= dispatcher;
+	sceneDesc.filterShader	= PxDefaultSimulationFilterShader;
+	sceneDesc.frictionType	= PxFrictionType::ePATCH;
+	PxScene* scene = gPhysics->createScene(sceneDesc);
+
+	createScene(scene);
+
+	PxU64 time = 0;
+	for(PxU32 frame=0; frame<gNbFrames; frame++)
+	{
+		const PxU64 startTime = SnippetUtils::getCurrentTimeCounterValue();
+		scene->simulate(1.0f/60.0f);
+		scene->fetchResults(true);
+		time += SnippetUtils::getCurrentTimeCounterValue() - startTime;
+	}
+
+	gNbBoxes = scene->getNbActors(PxActorTypeFlag::eRIGID_DYNAMIC);
+	for(PxU32 i=0; i<gNbBoxes; i++)
+	{
+		PxActor* actor;
+		scene->getActors(PxActorTypeFlag::eRIGID_DYNAMIC, &actor, 1, i);
+		poses[i] = static_cast<PxRigidDynamic*>(actor)->getGlobalPose();
+	}
+
+	scene->release();
+	dispatcher->release();
+
+	Dy::setContactBlock8Enabled(true);
+
+	return SnippetUtils::getElapsedTimeInMilliseconds(time) / PxReal(gNbFrames);
+}
+
+int snippetMain(int, const char*const*)
+{
+	gFoundation = PxCreateFoundation(PX_PHYSICS_VERSION, gAllocator, gErrorCallback);
+	gPhysics = PxCreatePhysics(PX_PHYSICS_VERSION, *gFoundation, PxTolerancesScale());
+	gMaterial = gPhysics->createMaterial(0.5f, 0.5f, 0.1f);
+
+	const PxU32 maxNbBoxes = gNbStacksPerSide*gNbStacksPerSide*gStackHeight + gNbPyramids*gPyramidSize*(gPyramidSize+1)/2;
+	PxTransform* poses4 = new PxTransform[maxNbBoxes];
+	PxTransform* poses8 = new PxTransform[maxNbBoxes];
+
+	// The runs alternate between both modes and the fastest one is kept, to reduce the noise of the timings
+	PxReal time4 = PX_MAX_F32;
+	PxReal time8 = PX_MAX_F32;
+	for(PxU32 run=0; run<gNbRuns; run++)
+	{
+		time4 = PxMin(time4, simulate(false, poses4));
+		time8 = PxMin(time8, simulate(true, poses8));
+	}
+
+	PxReal maxError = 0.0f;
+	for(PxU32 i=0; i<gNbBoxes; i++)
+		maxError = PxMax(maxError, (poses8[i].p - poses4[i].p).magnitude());
+
+	printf("%u boxes, %u solver iterations\n", gNbBoxes, gNbIterations);
+	printf("4-wide blocks: %.3f ms/frame\n", double(time4));
+	printf("8-wide blocks: %.3f ms/frame%s\n", double(time8), Dy::isContactBlock8Supported() ? "" : " (not supported, same as 4-wide)");
+	printf("max position difference: %f\n", double(maxError));
+
+	const bool success = maxError <= gTolerance;
+
+	delete [] poses8;
+	delete [] poses4;
+
+	PX_RELEASE(gMaterial);
+	PX_RELEASE(gPhysics);
+	PX_RELEASE(gFoundation);
+
+	printf("SnippetContactBlock8 %s.\n", success ? "done" : "failed");
+
+	return success ? 0 : 1;
+}
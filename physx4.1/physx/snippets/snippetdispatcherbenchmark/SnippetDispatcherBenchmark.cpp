@@ -0,0 +1,204 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+// ****************************************************************************
+// This snippet compares the two scheduling modes of the default CPU dispatcher.
+// The same scenes are simulated for a fixed number of frames, once with the
+// shared-queue dispatcher and once with the work-stealing dispatcher, for a
+// range of worker thread counts. The average frame time is printed for each
+// combination.
+// ****************************************************************************
+
+#include "PxPhysicsAPI.h"
+
+#include "../snippetutils/SnippetUtils.h"
+#include "../snippetcommon/SnippetPrint.h"
+
+using namespace physx;
+
+PxDefaultAllocator		gAllocator;
+PxDefaultErrorCallback	gErrorCallback;
+
+PxFoundation*			gFoundation = NULL;
+PxPhysics*				gPhysics	= NULL;
+PxMaterial*				gMaterial	= NULL;
+
+static const PxU32		gNbWarmupFrames	= 20;
+static const PxU32		gNbFrames		= 200;
+
+enum BenchmarkScene
+{
+	eSCENE_STACKS,
+	eSCENE_PILE,
+
+	eSCENE_COUNT
+};
+
+static const char* gSceneNames[eSCENE_COUNT] = { "stacks", "pile" };
+
+static void createStack(PxScene* scene, const PxTransform& t, PxU32 size, PxReal halfExtent)
+{
+	PxShape* shape = gPhysics->createShape(PxBoxGeometry(halfExtent, halfExtent, halfExtent), *gMaterial);
+	for(PxU32 i=0; i<size;i++)
+	{
+		for(PxU32 j=0;j<size-i;j++)
+		{
+			PxTransform localTm(PxVec3(PxReal(j*2) - PxReal(size-i), PxReal(i*2+1), 0) * halfExtent);
+			PxRigidDynamic* body = gPhysics->createRigidDynamic(t.transform(localTm));
+			body->attachShape(*shape);
+			PxRigidBodyExt::updateMassAndInertia(*body, 10.0f);
+			scene->addActor(*body);
+		}
+	}
+	shape->release();
+}
+
+static void createPile(PxScene* scene, PxU32 nbX, PxU32 nbY, PxU32 nbZ)
+{
+	// Fixed seed so that every run simulates exactly the same pile.
+	PxU32 seed = 42;
+	PxShape* box = gPhysics->createShape(PxBoxGeometry(0.5f, 0.5f, 0.5f), *gMaterial);
+	PxShape* sphere = gPhysics->createShape(PxSphereGeometry(0.5f), *gMaterial);
+	PxShape* capsule = gPhysics->createShape(PxCapsuleGeometry(0.3f, 0.4f), *gMaterial);
+	PxShape* shapes[3] = { box, sphere, capsule };
+
+	for(PxU32 y=0; y<nbY; y++)
+	{
+		for(PxU32 x=0; x<nbX; x++)
+		{
+			for(PxU32 z=0; z<nbZ; z++)
+			{
+				seed = seed * 1664525u + 1013904223u;
+				const PxVec3 pos(PxReal(x)*1.2f - PxReal(nbX)*0.6f, 1.0f + PxReal(y)*1.2f, PxReal(z)*1.2f - PxReal(nbZ)*0.6f);
+				PxRigidDynamic* body = gPhysics->createRigidDynamic(PxTransform(pos));
+				body->attachShape(*shapes[(seed >> 16) % 3]);
+				PxRigidBodyExt::updateMassAndInertia(*body, 1.0f);
+				scene->addActor(*body);
+			}
+		}
+	}
+
+	box->release();
+	sphere->release();
+	capsule->release();
+}
+
+static PxScene* createScene(BenchmarkScene sceneType, PxCpuDispatcher* dispatcher)
+{
+	PxSceneDesc sceneDesc(gPhysics->getTolerancesScale());
+	sceneDesc.gravity = PxVec3(0.0f, -9.81f, 0.0f);
+	sceneDesc.cpuDispatcher	= dispatcher;
+	sceneDesc.filterShader	= PxDefaultSimulationFilterShader;
+
+	PxScene* scene = gPhysics->createScene(sceneDesc);
+
+	PxRigidStatic* groundPlane = PxCreatePlane(*gPhysics, PxPlane(0,1,0,0), *gMaterial);
+	scene->addActor(*groundPlane);
+
+	if(sceneType == eSCENE_STACKS)
+	{
+		for(PxU32 i=0;i<20;i++)
+			createStack(scene, PxTransform(PxVec3(0,0,i*10.0f)), 20, 1.0f);
+	}
+	else
+	{
+		createPile(scene, 16, 16, 16);
+	}
+	return scene;
+}
+
+static PxReal runBenchmark(BenchmarkScene sceneType, PxU32 nbThreads, PxDefaultCpuDispatcherMode::Enum mode)
+{
+	PxDefaultCpuDispatcher* dispatcher = PxDefaultCpuDispatcherCreate(nbThreads, NULL, mode);
+	PxScene* scene = createScene(sceneType, dispatcher);
+
+	for(PxU32 i=0; i<gNbWarmupFrames; i++)
+	{
+		scene->simulate(1.0f/60.0f);
+		scene->fetchResults(true);
+	}
+
+	const PxU64 startTime = SnippetUtils::getCurrentTimeCounterValue();
+	for(PxU32 i=0; i<gNbFrames; i++)
+	{
+		scene->simulate(1.0f/60.0f);
+		scene->fetchResults(true);
+	}
+	const PxU64 endTime = SnippetUtils::getCurrentTimeCounterValue();
+
+	PX_RELEASE(scene);
+	PX_RELEASE(dispatcher);
+
+	return SnippetUtils::getElapsedTimeInMilliseconds(endTime - startTime) / PxReal(gNbFrames);
+}
+
+void initPhysics()
+{
+	gFoundation = PxCreateFoundation(PX_PHYSICS_VERSION, gAllocator, gErrorCallback);
+	gPhysics = PxCreatePhysics(PX_PHYSICS_VERSION, *gFoundation, PxTolerancesScale(), true);
+	gMaterial = gPhysics->createMaterial(0.5f, 0.5f, 0.6f);
+}
+
+void cleanupPhysics()
+{
+	PX_RELEASE(gPhysics);
+	PX_RELEASE(gFoundation);
+
+	printf("SnippetDispatcherBenchmark done.\n");
+}
+
+int snippetMain(int, const char*const*)
+{
+	initPhysics();
+
+	const PxU32 nbCores = SnippetUtils::getNbPhysicalCores();
+	const PxU32 maxThreads = nbCores > 1 ? nbCores - 1 : 1;
+
+	printf("%-8s %-8s %14s %14s\n", "scene", "threads", "shared (ms)", "stealing (ms)");
+	for(PxU32 s=0; s<eSCENE_COUNT; s++)
+	{
+		for(PxU32 nbThreads=1; ; nbThreads*=2)
+		{
+			if(nbThreads > maxThreads)
+				nbThreads = maxThreads;
+
+			const BenchmarkScene sceneType = BenchmarkScene(s);
+			const PxReal sharedTime = runBenchmark(sceneType, nbThreads, PxDefaultCpuDispatcherMode::eSHARED_QUEUE);
+			const PxReal stealingTime = runBenchmark(sceneType, nbThreads, PxDefaultCpuDispatcherMode::eWORK_STEALING);
+			printf("%-8s %-8u %14.3f %14.3f\n", gSceneNames[s], nbThreads, double(sharedTime), double(stealingTime));
+
+			if(nbThreads == maxThreads)
+				break;
+		}
+	}
+
+	cleanupPhysics();
+
+	return 0;
+}
@@ -39,6 +39,7 @@
 #include "../snippetcommon/SnippetPVD.h"
 #include "../snippetutils/SnippetUtils.h"
 #include "PsArray.h"
+#include "PsHashSet.h"
 #include "PxImmediateMode.h"
 #include "extensions/PxMassProperties.h"
 #include "../snippetcommon/SnippetPrint.h"
@@ -102,6 +103,16 @@ struct PersistentContactPair
 Array<PersistentContactPair>* allContactCache;
 #endif
 
+//The immediate-mode broadphase only reports pairs that started or stopped overlapping, so we track the current overlaps ourselves.
+//Broadphase handles are actor indices, so both are rebuilt when actors are added.
+immediate::PxImmediateBroadPhase*	gBroadPhase = NULL;
+CoalescedHashSet<PxU64>*			gOverlaps = NULL;
+
+static PX_FORCE_INLINE PxU64 encodeOverlap(PxU32 idx0, PxU32 idx1)
+{
+	return (PxU64(idx0)<<32) | PxU64(idx1);
+}
+
 class BlockBasedAllocator
 {
 	struct AllocationPage
@@ -419,6 +430,13 @@ static PxTriangleMesh* createMeshGround()
 
 static void updateContactPairs()
 {
+	if(gBroadPhase)
+	{
+		immediate::PxReleaseImmediateBroadPhase(gBroadPhase);
+		gBroadPhase = NULL;
+	}
+	gOverlaps->clear();
+
 #if WITH_PERSISTENCY
 	allContactCache->clear();
 
@@ -508,6 +526,7 @@ void initPhysics(bool /*interactive*/)
 #if WITH_PERSISTENCY
 	allContactCache = new shdfnd::Array<PersistentContactPair>();
 #endif
+	gOverlaps = new CoalescedHashSet<PxU64>();
 
 	updateContactPairs();
 }
@@ -545,7 +564,7 @@ void stepPhysics(bool /*interactive*/)
 
 	gScene->getActors(PxActorTypeFlag::eRIGID_STATIC, actors.begin() + nbDynamics, nbStatics);
 
-	//Now do collision detection...Brute force every dynamic against every dynamic/static
+	//Now do collision detection...Compute the AABBs of every dynamic/static
 	for (PxU32 a = 0; a < totalActors; ++a)
 	{
 		PxRigidActor* actor = actors[a]->is<PxRigidActor>();
@@ -553,46 +572,66 @@ void stepPhysics(bool /*interactive*/)
 		PxShape* shape;
 		actor->getShapes(&shape, 1);
 
-		//Compute the AABBs. We inflate these by 2cm margins
 		shapeBounds[a] = PxShapeExt::getWorldBounds(*shape, *actor, 1.f);
-		shapeBounds[a].minimum -= PxVec3(0.02f)*gUnitScale;
-		shapeBounds[a].maximum += PxVec3(0.02f)*gUnitScale;
 
 		mGeometries[a] = shape->getGeometry();
 	}
 
-	//Broad phase for active pairs...
-	for (PxU32 a = 0; a < nbDynamics; ++a)
+	//Broad phase for active pairs. Bounds are inflated by 2cm margins. The first update adds all the actors, the following ones only move the dynamics.
+	if (!gBroadPhase)
 	{
-		PxRigidDynamic* dyn0 = actors[a]->is<PxRigidDynamic>();
-		for (PxU32 b = a + 1; b < totalActors; ++b)
+		gBroadPhase = immediate::PxCreateImmediateBroadPhase(immediate::PxImmediateBroadPhaseDesc());
+		for (PxU32 a = 0; a < totalActors; ++a)
 		{
-			PxRigidActor* actor1 = actors[b]->is<PxRigidActor>();
+			const bool isDynamic = a < nbDynamics;
+			const PxU32 handle = immediate::PxImmediateBroadPhaseAddBounds(gBroadPhase, shapeBounds[a], isDynamic ? immediate::PxImmediateBroadPhaseObjectType::eDYNAMIC : immediate::PxImmediateBroadPhaseObjectType::eSTATIC, a, 0.02f*gUnitScale);
+			PX_ASSERT(handle == a);
+			PX_UNUSED(handle);
+		}
+	}
+	else
+	{
+		for (PxU32 a = 0; a < nbDynamics; ++a)
+			immediate::PxImmediateBroadPhaseUpdateBounds(gBroadPhase, a, shapeBounds[a]);
+	}
 
-			if (shapeBounds[a].intersects(shapeBounds[b]))
-			{
-				ContactPair pair;
-				pair.actor0 = dyn0;
-				pair.actor1 = actor1;
-				pair.idx0 = a;
-				pair.idx1 = b;
+	immediate::PxImmediateBroadPhaseUpdate(gBroadPhase);
 
-				activeContactPairs.pushBack(pair);
-			}
+	{
+		//Dynamics come first in the actors array and static pairs are not reported, so idx0 is always a dynamic actor
+		const immediate::PxImmediateBroadPhasePair* pairs;
+		const PxU32 nbDeleted = immediate::PxImmediateBroadPhaseGetDeletedPairs(gBroadPhase, pairs);
+		for (PxU32 a = 0; a < nbDeleted; ++a)
+		{
+			gOverlaps->erase(encodeOverlap(pairs[a].id0, pairs[a].id1));
 #if WITH_PERSISTENCY
-			else
-			{
-				const PxU32 startIndex = a == 0 ? 0 : (a * totalActors) - (a * (a + 1)) / 2;
+			const PxU32 startIndex = pairs[a].id0 == 0 ? 0 : (pairs[a].id0 * totalActors) - (pairs[a].id0 * (pairs[a].id0 + 1)) / 2;
 
-				PersistentContactPair& persistentData = (*allContactCache)[startIndex + (b - a - 1)];
+			PersistentContactPair& persistentData = (*allContactCache)[startIndex + (pairs[a].id1 - pairs[a].id0 - 1)];
 
-				//No collision detection performed at all so clear contact cache and friction data
-				persistentData.frictions = NULL;
-				persistentData.nbFrictions = 0;
-				persistentData.cache = PxCache();
-			}
+			//No collision detection performed at all so clear contact cache and friction data
+			persistentData.frictions = NULL;
+			persistentData.nbFrictions = 0;
+			persistentData.cache = PxCache();
 #endif
 		}
+
+		const PxU32 nbCreated = immediate::PxImmediateBroadPhaseGetCreatedPairs(gBroadPhase, pairs);
+		for (PxU32 a = 0; a < nbCreated; ++a)
+			gOverlaps->insert(encodeOverlap(pairs[a].id0, pairs[a].id1));
+	}
+
+	const PxU32 nbOverlaps = gOverlaps->size();
+	const PxU64* overlaps = gOverlaps->getEntries();
+	for (PxU32 a = 0; a < nbOverlaps; ++a)
+	{
+		ContactPair pair;
+		pair.idx0 = PxU32(overlaps[a]>>32);
+		pair.idx1 = PxU32(overlaps[a]);
+		pair.actor0 = actors[pair.idx0]->is<PxRigidDynamic>();
+		pair.actor1 = actors[pair.idx1]->is<PxRigidActor>();
+
+		activeContactPairs.pushBack(pair);
 	}
 
 	const PxU32 nbActivePairs = activeContactPairs.size();
@@ -1044,6 +1083,9 @@ void cleanupPhysics(bool /*interactive*/)
 #if WITH_PERSISTENCY
 	delete allContactCache;
 #endif
+	if(gBroadPhase)
+		immediate::PxReleaseImmediateBroadPhase(gBroadPhase);
+	delete gOverlaps;
 
 	PX_RELEASE(gFoundation);
 
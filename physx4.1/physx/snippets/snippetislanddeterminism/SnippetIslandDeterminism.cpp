@@ -0,0 +1,198 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+// ****************************************************************************
+// This snippet checks that the simulation does not depend on the number of
+// worker threads, including the island generation whose split detection runs
+// over the worker threads. Towers of boxes are knocked over by projectiles,
+// which keeps creating, merging and splitting islands. The scene is simulated
+// with enhanced determinism and 0, 1, 2, 4 and 8 workers. Every frame, the
+// state checksum and the island id of every island graph node must be the
+// same as with 0 workers.
+// ****************************************************************************
+
+#include "PxPhysicsAPI.h"
+#include "NpScene.h"
+#include "PxsSimpleIslandManager.h"
+
+#include "../snippetutils/SnippetUtils.h"
+#include "../snippetcommon/SnippetPrint.h"
+
+using namespace physx;
+
+PxDefaultAllocator		gAllocator;
+PxDefaultErrorCallback	gErrorCallback;
+
+PxFoundation*			gFoundation = NULL;
+PxPhysics*				gPhysics	= NULL;
+PxMaterial*				gMaterial	= NULL;
+
+static const PxU32		gNbTowersPerSide	= 6;
+static const PxU32		gTowerHeight		= 12;
+static const PxU32		gNbFrames			= 400;
+static const PxU32		gShotPeriod			= 20;
+static const PxU32		gWorkerCounts[]		= { 0, 1, 2, 4, 8 };
+static const PxU32		gNbWorkerCounts		= sizeof(gWorkerCounts)/sizeof(gWorkerCounts[0]);
+
+struct FrameState
+{
+	PxU64	mChecksum;		// PxScene::getSimulationStateChecksum()
+	PxU64	mIslandHash;	// hash of the island id of every node of the island graph
+	PxU32	mNbActiveIslands;
+};
+
+static PxU64 hashIslands(const PxScene* scene, PxU32& nbActiveIslands)
+{
+	// PT: the island ids are internal, they are read from the accurate island sim
+	const IG::IslandSim& islandSim = static_cast<const NpScene*>(scene)->getScene().getScScene().getSimpleIslandManager()->getAccurateIslandSim();
+	const PxU32 nbNodes = islandSim.getNbNodes();
+	const PxU32* islandIds = islandSim.getIslandIds();
+	nbActiveIslands = islandSim.getNbActiveIslands();
+
+	PxU64 hash = 14695981039346656037ull;	// FNV-1a
+	for(PxU32 i=0; i<nbNodes; i++)
+		hash = (hash ^ islandIds[i]) * 1099511628211ull;
+	return hash;
+}
+
+static void shoot(PxScene* scene, PxU32 shotIndex)
+{
+	// Projectiles go through a row or a column of towers, in turn
+	const PxReal spacing = 6.0f;
+	const PxReal lane = (PxReal(shotIndex % gNbTowersPerSide) - PxReal(gNbTowersPerSide-1)*0.5f) * spacing;
+	const bool alongX = (shotIndex & 1)!=0;
+	const PxVec3 position = alongX ? PxVec3(-40.0f, 3.0f, lane) : PxVec3(lane, 3.0f, -40.0f);
+	const PxVec3 velocity = alongX ? PxVec3(60.0f, 0.0f, 0.0f) : PxVec3(0.0f, 0.0f, 60.0f);
+
+	PxRigidDynamic* projectile = PxCreateDynamic(*gPhysics, PxTransform(position), PxSphereGeometry(1.0f), *gMaterial, 20.0f);
+	projectile->setLinearVelocity(velocity);
+	scene->addActor(*projectile);
+}
+
+static void simulate(PxU32 nbWorkers, FrameState* states)
+{
+	PxDefaultCpuDispatcher* dispatcher = PxDefaultCpuDispatcherCreate(nbWorkers);
+
+	PxSceneDesc sceneDesc(gPhysics->getTolerancesScale());
+	sceneDesc.gravity = PxVec3(0.0f, -9.81f, 0.0f);
+	sceneDesc.cpuDispatcher	= dispatcher;
+	sceneDesc.filterShader	= PxDefaultSimulationFilterShader;
+	sceneDesc.flags |= PxSceneFlag::eENABLE_ENHANCED_DETERMINISM;
+	PxScene* scene = gPhysics->createScene(sceneDesc);
+
+	scene->addActor(*PxCreatePlane(*gPhysics, PxPlane(0.0f, 1.0f, 0.0f, 0.0f), *gMaterial));
+
+	// Towers of 2x2 boxes per level, each one its own island until projectiles and debris connect them
+	const PxReal halfExtent = 0.5f;
+	const PxBoxGeometry box(halfExtent, halfExtent, halfExtent);
+	const PxReal spacing = 6.0f;
+	for(PxU32 i=0; i<gNbTowersPerSide; i++)
+	{
+		for(PxU32 j=0; j<gNbTowersPerSide; j++)
+		{
+			const PxVec3 base((PxReal(i) - PxReal(gNbTowersPerSide-1)*0.5f) * spacing, halfExtent, (PxReal(j) - PxReal(gNbTowersPerSide-1)*0.5f) * spacing);
+			for(PxU32 level=0; level<gTowerHeight; level++)
+			{
+				for(PxU32 k=0; k<4; k++)
+				{
+					const PxVec3 offset(((k&1) ? halfExtent : -halfExtent), PxReal(level)*halfExtent*2.0f, ((k&2) ? halfExtent : -halfExtent));
+					scene->addActor(*PxCreateDynamic(*gPhysics, PxTransform(base + offset), box, *gMaterial, 1.0f));
+				}
+			}
+		}
+	}
+
+	for(PxU32 frame=0; frame<gNbFrames; frame++)
+	{
+		if(frame && !(frame % gShotPeriod))
+			shoot(scene, frame / gShotPeriod);
+
+		scene->simulate(1.0f/60.0f);
+		scene->fetchResults(true);
+
+		states[frame].mChecksum = scene->getSimulationStateChecksum();
+		states[frame].mIslandHash = hashIslands(scene, states[frame].mNbActiveIslands);
+	}
+
+	scene->release();
+	dispatcher->release();
+}
+
+int snippetMain(int, const char*const*)
+{
+	gFoundation = PxCreateFoundation(PX_PHYSICS_VERSION, gAllocator, gErrorCallback);
+	gPhysics = PxCreatePhysics(PX_PHYSICS_VERSION, *gFoundation, PxTolerancesScale());
+	gMaterial = gPhysics->createMaterial(0.5f, 0.5f, 0.1f);
+
+	FrameState* reference = new FrameState[gNbFrames];
+	FrameState* states = new FrameState[gNbFrames];
+
+	bool success = true;
+	for(PxU32 w=0; w<gNbWorkerCounts; w++)
+	{
+		simulate(gWorkerCounts[w], w ? states : reference);
+		if(!w)
+		{
+			PxU32 maxNbActiveIslands = 0;
+			for(PxU32 frame=0; frame<gNbFrames; frame++)
+				maxNbActiveIslands = PxMax(maxNbActiveIslands, reference[frame].mNbActiveIslands);
+			printf("0 workers: reference, up to %u active islands\n", maxNbActiveIslands);
+			continue;
+		}
+
+		PxU32 firstChecksumDiff = gNbFrames;
+		PxU32 firstIslandDiff = gNbFrames;
+		for(PxU32 frame=0; frame<gNbFrames; frame++)
+		{
+			if(firstChecksumDiff==gNbFrames && states[frame].mChecksum != reference[frame].mChecksum)
+				firstChecksumDiff = frame;
+			if(firstIslandDiff==gNbFrames && (states[frame].mIslandHash != reference[frame].mIslandHash || states[frame].mNbActiveIslands != reference[frame].mNbActiveIslands))
+				firstIslandDiff = frame;
+		}
+
+		if(firstChecksumDiff==gNbFrames && firstIslandDiff==gNbFrames)
+			printf("%u workers: ok\n", gWorkerCounts[w]);
+		else
+		{
+			printf("%u workers: FAILED, checksum differs from frame %u, island ids from frame %u\n", gWorkerCounts[w], firstChecksumDiff, firstIslandDiff);
+			success = false;
+		}
+	}
+
+	delete [] states;
+	delete [] reference;
+
+	PX_RELEASE(gMaterial);
+	PX_RELEASE(gPhysics);
+	PX_RELEASE(gFoundation);
+
+	printf("SnippetIslandDeterminism %s.\n", success ? "done" : "failed");
+
+	return success ? 0 : 1;
+}
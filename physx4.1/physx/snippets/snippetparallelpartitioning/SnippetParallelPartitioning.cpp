@@ -0,0 +1,183 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+// ****************************************************************************
+// This snippet checks PxSceneFlag::eENABLE_PARALLEL_PARTITIONING. A block of
+// boxes forms one large island, which is knocked over by projectiles. The
+// scene is simulated with the default serial partitioning, then with the
+// parallel partitioning and 0, 1, 2 and 4 workers. With the parallel
+// partitioning, the state checksum must be the same every frame whatever the
+// number of workers. The partition counts and partitioning times reported in
+// PxSimulationStatistics are printed for both partitionings.
+// ****************************************************************************
+
+#include "PxPhysicsAPI.h"
+
+#include "../snippetutils/SnippetUtils.h"
+#include "../snippetcommon/SnippetPrint.h"
+
+using namespace physx;
+
+PxDefaultAllocator		gAllocator;
+PxDefaultErrorCallback	gErrorCallback;
+
+PxFoundation*			gFoundation = NULL;
+PxPhysics*				gPhysics	= NULL;
+PxMaterial*				gMaterial	= NULL;
+
+static const PxU32		gBlockSize		= 20;
+static const PxU32		gBlockHeight	= 10;
+static const PxU32		gNbFrames		= 120;
+static const PxU32		gShotPeriod		= 30;
+static const PxU32		gWorkerCounts[]	= { 0, 1, 2, 4 };
+static const PxU32		gNbWorkerCounts	= sizeof(gWorkerCounts)/sizeof(gWorkerCounts[0]);
+
+struct RunStats
+{
+	PxU32	mMaxNbPartitions;
+	PxReal	mPartitionTime;		// Summed over all frames, in milliseconds
+	PxReal	mSimulationTime;	// Summed over all frames, in milliseconds
+	PxReal	mAverageHeight;		// Of the boxes, in the last frame
+};
+
+static void simulate(bool parallelPartitioning, PxU32 nbWorkers, PxU64* checksums, RunStats& stats)
+{
+	PxDefaultCpuDispatcher* dispatcher = PxDefaultCpuDispatcherCreate(nbWorkers);
+
+	PxSceneDesc sceneDesc(gPhysics->getTolerancesScale());
+	sceneDesc.gravity = PxVec3(0.0f, -9.81f, 0.0f);
+	sceneDesc.cpuDispatcher	= dispatcher;
+	sceneDesc.filterShader	= PxDefaultSimulationFilterShader;
+	if(parallelPartitioning)
+		sceneDesc.flags |= PxSceneFlag::eENABLE_PARALLEL_PARTITIONING;
+	PxScene* scene = gPhysics->createScene(sceneDesc);
+
+	scene->addActor(*PxCreatePlane(*gPhysics, PxPlane(0.0f, 1.0f, 0.0f, 0.0f), *gMaterial));
+
+	// Boxes in contact with their neighbors, so that the whole block is a single island
+	const PxReal halfExtent = 0.5f;
+	const PxBoxGeometry box(halfExtent, halfExtent, halfExtent);
+	for(PxU32 y=0; y<gBlockHeight; y++)
+		for(PxU32 z=0; z<gBlockSize; z++)
+			for(PxU32 x=0; x<gBlockSize; x++)
+			{
+				const PxVec3 position((PxReal(x) - PxReal(gBlockSize)*0.5f) * halfExtent * 2.0f, halfExtent + PxReal(y) * halfExtent * 2.0f, (PxReal(z) - PxReal(gBlockSize)*0.5f) * halfExtent * 2.0f);
+				scene->addActor(*PxCreateDynamic(*gPhysics, PxTransform(position), box, *gMaterial, 1.0f));
+			}
+
+	stats.mMaxNbPartitions = 0;
+	stats.mPartitionTime = 0.0f;
+	stats.mSimulationTime = 0.0f;
+
+	for(PxU32 frame=0; frame<gNbFrames; frame++)
+	{
+		if(frame && !(frame % gShotPeriod))
+		{
+			const PxReal height = PxReal(frame / gShotPeriod) * 2.0f;
+			PxRigidDynamic* projectile = PxCreateDynamic(*gPhysics, PxTransform(PxVec3(-20.0f, height, 0.0f)), PxSphereGeometry(1.5f), *gMaterial, 50.0f);
+			projectile->setLinearVelocity(PxVec3(40.0f, 0.0f, 0.0f));
+			scene->addActor(*projectile);
+		}
+
+		const PxU64 startTime = SnippetUtils::getCurrentTimeCounterValue();
+		scene->simulate(1.0f/60.0f);
+		scene->fetchResults(true);
+		stats.mSimulationTime += SnippetUtils::getElapsedTimeInMilliseconds(SnippetUtils::getCurrentTimeCounterValue() - startTime);
+
+		checksums[frame] = scene->getSimulationStateChecksum();
+
+		PxSimulationStatistics simStats;
+		scene->getSimulationStatistics(simStats);
+		stats.mMaxNbPartitions = PxMax(stats.mMaxNbPartitions, simStats.nbPartitions);
+		stats.mPartitionTime += simStats.partitionTime;
+	}
+
+	PxActor* actors[gBlockSize*gBlockSize*gBlockHeight];
+	const PxU32 nbBoxes = scene->getActors(PxActorTypeFlag::eRIGID_DYNAMIC, actors, gBlockSize*gBlockSize*gBlockHeight);
+	PxReal height = 0.0f;
+	for(PxU32 i=0; i<nbBoxes; i++)
+		height += static_cast<PxRigidDynamic*>(actors[i])->getGlobalPose().p.y;
+	stats.mAverageHeight = height / PxReal(nbBoxes);
+
+	scene->release();
+	dispatcher->release();
+}
+
+static void printStats(const char* name, const RunStats& stats)
+{
+	printf("%-32s up to %u partitions, partitioning %.2f ms, simulation %.1f ms, average height %.3f\n", name,
+		stats.mMaxNbPartitions, stats.mPartitionTime, stats.mSimulationTime, stats.mAverageHeight);
+}
+
+int snippetMain(int, const char*const*)
+{
+	gFoundation = PxCreateFoundation(PX_PHYSICS_VERSION, gAllocator, gErrorCallback);
+	gPhysics = PxCreatePhysics(PX_PHYSICS_VERSION, *gFoundation, PxTolerancesScale());
+	gMaterial = gPhysics->createMaterial(0.5f, 0.5f, 0.1f);
+
+	PxU64* reference = new PxU64[gNbFrames];
+	PxU64* checksums = new PxU64[gNbFrames];
+	RunStats stats;
+
+	simulate(false, 0, checksums, stats);
+	printStats("serial partitioning, 0 workers:", stats);
+
+	bool success = true;
+	for(PxU32 w=0; w<gNbWorkerCounts; w++)
+	{
+		simulate(true, gWorkerCounts[w], w ? checksums : reference, stats);
+
+		char name[64];
+		sprintf(name, "parallel partitioning, %u workers:", gWorkerCounts[w]);
+		printStats(name, stats);
+
+		PxU32 firstDiff = gNbFrames;
+		for(PxU32 frame=0; w && frame<gNbFrames && firstDiff==gNbFrames; frame++)
+		{
+			if(checksums[frame] != reference[frame])
+				firstDiff = frame;
+		}
+		if(firstDiff != gNbFrames)
+		{
+			printf("    FAILED, checksum differs from 0 workers from frame %u\n", firstDiff);
+			success = false;
+		}
+	}
+
+	delete [] checksums;
+	delete [] reference;
+
+	PX_RELEASE(gMaterial);
+	PX_RELEASE(gPhysics);
+	PX_RELEASE(gFoundation);
+
+	printf("SnippetParallelPartitioning %s.\n", success ? "done" : "failed");
+
+	return success ? 0 : 1;
+}
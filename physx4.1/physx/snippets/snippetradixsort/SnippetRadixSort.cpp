@@ -0,0 +1,196 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+// ****************************************************************************
+// This snippet checks that the radix sort used by the broadphases returns the
+// same ranks whatever the number of worker threads of its dispatcher. Large
+// float inputs with many equal negative, zero and positive keys are sorted
+// with 0, 1, 2, 4 and 8 workers, first from scratch and then again from the
+// previous ranks after a few keys changed. The ranks must be identical for
+// all thread counts, and must be a stable sort of the keys.
+// ****************************************************************************
+
+#include <string.h>
+#include "PxPhysicsAPI.h"
+#include "CmRadixSort.h"
+
+#include "../snippetutils/SnippetUtils.h"
+#include "../snippetcommon/SnippetPrint.h"
+
+using namespace physx;
+
+PxDefaultAllocator		gAllocator;
+PxDefaultErrorCallback	gErrorCallback;
+
+PxFoundation*			gFoundation = NULL;
+
+static const PxU32		gNbKeys			= 200000;
+static const PxU32		gNbKeyValues	= 500;
+static const PxU32		gNbRuns			= 5;
+static const PxU32		gWorkerCounts[]	= { 0, 1, 2, 4, 8 };
+static const PxU32		gNbWorkerCounts	= sizeof(gWorkerCounts)/sizeof(gWorkerCounts[0]);
+
+static PxU32 random(PxU32& seed)
+{
+	seed = seed * 1664525 + 1013904223;
+	return seed >> 8;
+}
+
+// Sorter with its own buffers, set up for the parallel path
+class Sorter
+{
+public:
+	Sorter(PxCpuDispatcher* dispatcher)
+	{
+		mRanks0 = new PxU32[gNbKeys];
+		mRanks1 = new PxU32[gNbKeys];
+		mSort.SetBuffers(mRanks0, mRanks1, mHistogram1024, mLinks256);
+		mSort.SetDispatcher(dispatcher);
+	}
+
+	~Sorter()
+	{
+		delete [] mRanks1;
+		delete [] mRanks0;
+	}
+
+	Cm::RadixSort	mSort;
+private:
+	PxU32*			mRanks0;
+	PxU32*			mRanks1;
+	PxU32			mHistogram1024[1024];
+	PxU32*			mLinks256[256];
+};
+
+// Same order as the radix sort: -0.0 sorts before 0.0.
+static PxU32 getSortKey(float f)
+{
+	const PxU32 key = PxUnionCast<PxU32>(f);
+	return key ^ (PxU32(PxI32(key)>>31) | 0x80000000);
+}
+
+static bool isStableSort(const float* keys, const PxU32* ranks, const PxU32* previousRanks)
+{
+	// Ties keep the order they had in the input sequence, i.e. the order of the previous ranks if there are some.
+	PxU32* positions = NULL;
+	if(previousRanks)
+	{
+		positions = new PxU32[gNbKeys];
+		for(PxU32 i=0; i<gNbKeys; i++)
+			positions[previousRanks[i]] = i;
+	}
+
+	bool success = true;
+	for(PxU32 i=1; i<gNbKeys && success; i++)
+	{
+		const PxU32 k0 = getSortKey(keys[ranks[i-1]]);
+		const PxU32 k1 = getSortKey(keys[ranks[i]]);
+		const PxU32 p0 = positions ? positions[ranks[i-1]] : ranks[i-1];
+		const PxU32 p1 = positions ? positions[ranks[i]] : ranks[i];
+		if(k0>k1 || (k0==k1 && p0>p1))
+			success = false;
+	}
+	delete [] positions;
+	return success;
+}
+
+int snippetMain(int, const char*const*)
+{
+	gFoundation = PxCreateFoundation(PX_PHYSICS_VERSION, gAllocator, gErrorCallback);
+
+	float* keys = new float[gNbKeys];
+	PxU32* referenceRanks[2] = { new PxU32[gNbKeys], new PxU32[gNbKeys] };
+	PxU32* firstRanks = new PxU32[gNbKeys];
+
+	bool success = true;
+	PxU32 seed = 42;
+	for(PxU32 run=0; run<gNbRuns; run++)
+	{
+		// Few distinct values so that there are many ties, half of them negative, plus some signed zeros.
+		for(PxU32 i=0; i<gNbKeys; i++)
+		{
+			const PxU32 r = random(seed);
+			keys[i] = (r % 17)==0 ? ((r & 1) ? -0.0f : 0.0f) : float(PxI32(r % gNbKeyValues) - PxI32(gNbKeyValues/2)) * 0.25f;
+		}
+
+		bool runSuccess = true;
+		for(PxU32 w=0; w<gNbWorkerCounts; w++)
+		{
+			PxDefaultCpuDispatcher* dispatcher = PxDefaultCpuDispatcherCreate(gWorkerCounts[w]);
+			Sorter* sorter = new Sorter(dispatcher);
+
+			// Sort from scratch, then again from the previous ranks with a few keys moved.
+			float* movedKeys = new float[gNbKeys];
+			for(PxU32 i=0; i<gNbKeys; i++)
+				movedKeys[i] = (i % 97)==run ? -keys[i] - 1.0f : keys[i];
+
+			for(PxU32 pass=0; pass<2; pass++)
+			{
+				const float* input = pass ? movedKeys : keys;
+				sorter->mSort.Sort(input, gNbKeys);
+				const PxU32* ranks = sorter->mSort.GetRanks();
+
+				if(!isStableSort(input, ranks, pass ? firstRanks : NULL))
+				{
+					printf("Run %d, %d workers, pass %d: ranks are not a stable sort of the keys.\n", run, gWorkerCounts[w], pass);
+					runSuccess = false;
+				}
+
+				if(!w)
+					PxMemCopy(referenceRanks[pass], ranks, sizeof(PxU32)*gNbKeys);
+				else if(memcmp(referenceRanks[pass], ranks, sizeof(PxU32)*gNbKeys))
+				{
+					printf("Run %d, %d workers, pass %d: ranks differ from the ranks with 0 workers.\n", run, gWorkerCounts[w], pass);
+					runSuccess = false;
+				}
+
+				if(!pass)
+					PxMemCopy(firstRanks, ranks, sizeof(PxU32)*gNbKeys);
+			}
+
+			delete [] movedKeys;
+			delete sorter;
+			PX_RELEASE(dispatcher);
+		}
+
+		printf("Run %d: %s\n", run, runSuccess ? "ok" : "FAILED");
+		success &= runSuccess;
+	}
+
+	delete [] firstRanks;
+	delete [] referenceRanks[1];
+	delete [] referenceRanks[0];
+	delete [] keys;
+
+	PX_RELEASE(gFoundation);
+
+	printf("SnippetRadixSort %s.\n", success ? "done" : "failed");
+
+	return success ? 0 : 1;
+}
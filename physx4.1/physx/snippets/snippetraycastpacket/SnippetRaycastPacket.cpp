@@ -0,0 +1,310 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+// ****************************************************************************
+// This snippet checks PxScene::raycastPacket against PxScene::raycast. Packets
+// of coherent rays are cast against terrain meshes and boxes, with each
+// pruning structure type. The meshes use the BVH34 midphase, traversed once
+// per packet, with identity, non-uniform and mirroring scales, and one mesh
+// uses the BVH33 midphase. Every ray must find the same hits as with
+// raycast(), with block-only and touch buffers. Only the triangle reported
+// among several triangles hit at exactly the same distance may differ, which
+// is counted as a tie. The time taken by both functions is printed.
+// ****************************************************************************
+
+#include <stdlib.h>
+#include "PxPhysicsAPI.h"
+
+#include "../snippetutils/SnippetUtils.h"
+#include "../snippetcommon/SnippetPrint.h"
+
+using namespace physx;
+
+PxDefaultAllocator		gAllocator;
+PxDefaultErrorCallback	gErrorCallback;
+
+PxFoundation*			gFoundation = NULL;
+PxPhysics*				gPhysics	= NULL;
+PxCooking*				gCooking	= NULL;
+PxDefaultCpuDispatcher*	gDispatcher = NULL;
+PxMaterial*				gMaterial	= NULL;
+PxTriangleMesh*			gMeshBV4	= NULL;
+PxTriangleMesh*			gMeshRTree	= NULL;
+
+static const PxU32		gGridSize		= 64;
+static const PxReal		gCellSize		= 2.0f;
+static const PxU32		gNbBoxes		= 500;
+static const PxU32		gNbPackets		= 2000;
+static const PxU32		gPacketSize		= 16;
+static const PxU32		gMaxNbTouches	= 32;
+
+static const PxPruningStructureType::Enum	gStructures[] = { PxPruningStructureType::eSTATIC_AABB_TREE, PxPruningStructureType::eDYNAMIC_AABB_TREE, PxPruningStructureType::eWIDE_AABB_TREE };
+static const char*							gStructureNames[] = { "static AABB tree", "dynamic AABB tree", "wide AABB tree" };
+
+static PxReal random(PxU32& seed)
+{
+	seed = seed * 1664525 + 1013904223;
+	return PxReal(seed >> 8) / PxReal(1 << 24);
+}
+
+static PxTriangleMesh* createTerrainMesh(PxMeshMidPhase::Enum midphase)
+{
+	const PxU32 nbVerts = (gGridSize+1)*(gGridSize+1);
+	PxVec3* verts = new PxVec3[nbVerts];
+	PxU32 seed = 42;
+	for(PxU32 z=0; z<=gGridSize; z++)
+	{
+		for(PxU32 x=0; x<=gGridSize; x++)
+		{
+			const PxReal h = 4.0f*PxSin(PxReal(x)*0.3f)*PxCos(PxReal(z)*0.2f) + random(seed)*0.5f;
+			verts[z*(gGridSize+1)+x] = PxVec3((PxReal(x) - PxReal(gGridSize)*0.5f)*gCellSize, h, (PxReal(z) - PxReal(gGridSize)*0.5f)*gCellSize);
+		}
+	}
+	// Flat cells create triangles hit at exactly the same distance along their shared edges
+	for(PxU32 x=0; x<=8; x++)
+		for(PxU32 z=0; z<=8; z++)
+			verts[z*(gGridSize+1)+x].y = 0.0f;
+
+	const PxU32 nbTris = gGridSize*gGridSize*2;
+	PxU32* indices = new PxU32[nbTris*3];
+	PxU32* index = indices;
+	for(PxU32 z=0; z<gGridSize; z++)
+	{
+		for(PxU32 x=0; x<gGridSize; x++)
+		{
+			const PxU32 v = z*(gGridSize+1)+x;
+			*index++ = v;	*index++ = v+gGridSize+1;	*index++ = v+1;
+			*index++ = v+1;	*index++ = v+gGridSize+1;	*index++ = v+gGridSize+2;
+		}
+	}
+
+	PxTriangleMeshDesc meshDesc;
+	meshDesc.points.count = nbVerts;
+	meshDesc.points.data = verts;
+	meshDesc.points.stride = sizeof(PxVec3);
+	meshDesc.triangles.count = nbTris;
+	meshDesc.triangles.data = indices;
+	meshDesc.triangles.stride = 3*sizeof(PxU32);
+
+	PxCookingParams params = gCooking->getParams();
+	params.midphaseDesc = midphase;
+	gCooking->setParams(params);
+	PxTriangleMesh* mesh = gCooking->createTriangleMesh(meshDesc, gPhysics->getPhysicsInsertionCallback());
+
+	delete [] indices;
+	delete [] verts;
+	return mesh;
+}
+
+static void addMeshActor(PxScene* scene, PxTriangleMesh* mesh, const PxTransform& pose, const PxMeshScale& scale, PxMeshGeometryFlags flags)
+{
+	PxRigidStatic* actor = gPhysics->createRigidStatic(pose);
+	PxRigidActorExt::createExclusiveShape(*actor, PxTriangleMeshGeometry(mesh, scale, flags), *gMaterial);
+	scene->addActor(*actor);
+}
+
+static PxScene* createScene(PxPruningStructureType::Enum structure)
+{
+	PxSceneDesc sceneDesc(gPhysics->getTolerancesScale());
+	sceneDesc.cpuDispatcher	= gDispatcher;
+	sceneDesc.filterShader	= PxDefaultSimulationFilterShader;
+	sceneDesc.staticStructure = structure;
+	sceneDesc.dynamicStructure = structure==PxPruningStructureType::eSTATIC_AABB_TREE ? PxPruningStructureType::eDYNAMIC_AABB_TREE : structure;
+	PxScene* scene = gPhysics->createScene(sceneDesc);
+
+	// One terrain per quadrant, to cover the identity, scaled, mirrored and BVH33 code paths
+	const PxReal offset = PxReal(gGridSize)*gCellSize*0.5f;
+	addMeshActor(scene, gMeshBV4, PxTransform(PxVec3(-offset, 0.0f, -offset)), PxMeshScale(), PxMeshGeometryFlags());
+	addMeshActor(scene, gMeshBV4, PxTransform(PxVec3(offset, 0.0f, -offset), PxQuat(0.3f, PxVec3(0.0f, 1.0f, 0.0f))),
+		PxMeshScale(PxVec3(1.0f, 2.0f, 0.7f), PxQuat(0.5f, PxVec3(1.0f, 0.0f, 0.0f))), PxMeshGeometryFlags());
+	addMeshActor(scene, gMeshBV4, PxTransform(PxVec3(-offset, 0.0f, offset)), PxMeshScale(PxVec3(-1.0f, 1.0f, 1.0f)), PxMeshGeometryFlag::eDOUBLE_SIDED);
+	addMeshActor(scene, gMeshRTree, PxTransform(PxVec3(offset, 0.0f, offset)), PxMeshScale(), PxMeshGeometryFlags());
+
+	PxU32 seed = 1;
+	for(PxU32 i=0; i<gNbBoxes; i++)
+	{
+		const PxTransform pose(PxVec3(random(seed)*240.0f - 120.0f, random(seed)*20.0f + 4.0f, random(seed)*240.0f - 120.0f), PxQuat(random(seed)*PxTwoPi, PxVec3(0.0f, 1.0f, 0.0f)));
+		PxRigidDynamic* actor = gPhysics->createRigidDynamic(pose);
+		actor->setRigidBodyFlag(PxRigidBodyFlag::eKINEMATIC, true);
+		PxRigidActorExt::createExclusiveShape(*actor, PxBoxGeometry(random(seed)*2.0f + 0.5f, random(seed)*2.0f + 0.5f, random(seed)*2.0f + 0.5f), *gMaterial);
+		scene->addActor(*actor);
+	}
+
+	scene->simulate(1.0f/60.0f);
+	scene->fetchResults(true);
+	return scene;
+}
+
+// Packets of rays shot from one point towards a small area of the scene
+static void createPacket(PxU32& seed, PxVec3* origins, PxVec3* dirs, PxReal* distances)
+{
+	const PxVec3 eye(random(seed)*300.0f - 150.0f, random(seed)*60.0f + 20.0f, random(seed)*300.0f - 150.0f);
+	const PxVec3 target(random(seed)*260.0f - 130.0f, 0.0f, random(seed)*260.0f - 130.0f);
+	const PxVec3 dir = (target - eye).getNormalized();
+	const PxVec3 right = dir.cross(PxVec3(0.0f, 1.0f, 0.0f)).getNormalized();
+	const PxVec3 up = right.cross(dir);
+	// Some packets are too short to reach the ground
+	const PxReal length = random(seed) < 0.2f ? (target - eye).magnitude()*0.5f : 500.0f;
+	for(PxU32 i=0; i<gPacketSize; i++)
+	{
+		const PxReal u = (PxReal(i&3) - 1.5f)*0.02f;
+		const PxReal v = (PxReal(i>>2) - 1.5f)*0.02f;
+		origins[i] = eye;
+		dirs[i] = (dir + right*u + up*v).getNormalized();
+		distances[i] = length;
+	}
+}
+
+static bool sameHit(const PxRaycastHit& a, const PxRaycastHit& b, PxU32& nbTies)
+{
+	if(a.shape!=b.shape || a.actor!=b.actor || a.flags!=b.flags || a.distance!=b.distance)
+		return false;
+	if(a.faceIndex!=b.faceIndex)
+	{
+		// Another triangle hit at the same distance
+		nbTies++;
+		return true;
+	}
+	return a.position==b.position && a.normal==b.normal && a.u==b.u && a.v==b.v;
+}
+
+static bool sameResults(const PxRaycastBuffer& a, const PxRaycastBuffer& b, PxU32& nbTies)
+{
+	if(a.hasBlock!=b.hasBlock || (a.hasBlock && !sameHit(a.block, b.block, nbTies)) || a.nbTouches!=b.nbTouches)
+		return false;
+
+	// Touching hits are not ordered
+	for(PxU32 i=0; i<a.nbTouches; i++)
+	{
+		bool found = false;
+		for(PxU32 j=0; !found && j<b.nbTouches; j++)
+			found = a.touches[i].shape==b.touches[j].shape && sameHit(a.touches[i], b.touches[j], nbTies);
+		if(!found)
+			return false;
+	}
+	return true;
+}
+
+static bool checkScene(PxScene* scene, const char* name)
+{
+	const PxHitFlags hitFlags[] = { PxHitFlag::eDEFAULT, PxHitFlag::eDEFAULT|PxHitFlag::eMESH_BOTH_SIDES, PxHitFlag::ePOSITION };
+
+	PxU32 nbErrors = 0;
+	PxU32 nbTies = 0;
+	PxU32 nbHits = 0;
+	PxU64 rayTime = 0;
+	PxU64 packetTime = 0;
+
+	PxRaycastHit touches[2][gPacketSize][gMaxNbTouches];
+	for(PxU32 mode=0; mode<6; mode++)
+	{
+		const PxHitFlags flags = hitFlags[mode>>1];
+		const bool useTouches = (mode&1)!=0;
+
+		PxU32 seed = 1234;
+		for(PxU32 p=0; p<gNbPackets; p++)
+		{
+			PxVec3 origins[gPacketSize];
+			PxVec3 dirs[gPacketSize];
+			PxReal distances[gPacketSize];
+			createPacket(seed, origins, dirs, distances);
+
+			PxRaycastBuffer rayBuffers[gPacketSize];
+			PxRaycastBuffer packetBuffers[gPacketSize];
+			for(PxU32 i=0; useTouches && i<gPacketSize; i++)
+			{
+				rayBuffers[i] = PxRaycastBuffer(touches[0][i], gMaxNbTouches);
+				packetBuffers[i] = PxRaycastBuffer(touches[1][i], gMaxNbTouches);
+			}
+
+			// Both functions run first in turn, so that neither always benefits from the cache warmed up by the other
+			for(PxU32 pass=0; pass<2; pass++)
+			{
+				const PxU64 startTime = SnippetUtils::getCurrentTimeCounterValue();
+				if(pass==(p&1))
+				{
+					for(PxU32 i=0; i<gPacketSize; i++)
+						scene->raycast(origins[i], dirs[i], distances[i], rayBuffers[i], flags);
+					rayTime += SnippetUtils::getCurrentTimeCounterValue() - startTime;
+				}
+				else
+				{
+					scene->raycastPacket(gPacketSize, origins, dirs, distances, packetBuffers, flags);
+					packetTime += SnippetUtils::getCurrentTimeCounterValue() - startTime;
+				}
+			}
+
+			for(PxU32 i=0; i<gPacketSize; i++)
+			{
+				if(!sameResults(rayBuffers[i], packetBuffers[i], nbTies))
+				{
+					if(nbErrors < 5)
+						printf("%s, mode %d, packet %d, ray %d: results differ from raycast()\n", name, mode, p, i);
+					nbErrors++;
+				}
+				nbHits += rayBuffers[i].getNbAnyHits();
+			}
+		}
+	}
+
+	printf("%-20s %s (%d rays, %d hits, %d ties, raycast %.2f ms, raycastPacket %.2f ms)\n", name, nbErrors ? "FAILED" : "ok",
+		6*gNbPackets*gPacketSize, nbHits, nbTies, SnippetUtils::getElapsedTimeInMilliseconds(rayTime), SnippetUtils::getElapsedTimeInMilliseconds(packetTime));
+	return !nbErrors;
+}
+
+int snippetMain(int, const char*const*)
+{
+	gFoundation = PxCreateFoundation(PX_PHYSICS_VERSION, gAllocator, gErrorCallback);
+	gPhysics = PxCreatePhysics(PX_PHYSICS_VERSION, *gFoundation, PxTolerancesScale());
+	gCooking = PxCreateCooking(PX_PHYSICS_VERSION, *gFoundation, PxCookingParams(PxTolerancesScale()));
+	gDispatcher = PxDefaultCpuDispatcherCreate(2);
+	gMaterial = gPhysics->createMaterial(0.5f, 0.5f, 0.6f);
+	gMeshBV4 = createTerrainMesh(PxMeshMidPhase::eBVH34);
+	gMeshRTree = createTerrainMesh(PxMeshMidPhase::eBVH33);
+
+	bool success = true;
+	for(PxU32 i=0; i<sizeof(gStructures)/sizeof(gStructures[0]); i++)
+	{
+		PxScene* scene = createScene(gStructures[i]);
+		success &= checkScene(scene, gStructureNames[i]);
+		scene->release();
+	}
+
+	PX_RELEASE(gMeshRTree);
+	PX_RELEASE(gMeshBV4);
+	PX_RELEASE(gMaterial);
+	PX_RELEASE(gDispatcher);
+	PX_RELEASE(gCooking);
+	PX_RELEASE(gPhysics);
+	PX_RELEASE(gFoundation);
+
+	printf("SnippetRaycastPacket %s.\n", success ? "done" : "failed");
+
+	return success ? 0 : 1;
+}
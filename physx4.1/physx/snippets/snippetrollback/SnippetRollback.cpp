@@ -0,0 +1,189 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+// ****************************************************************************
+// This snippet checks that a restored simulation state replays bit exact.
+// Boxes stacked in pyramids are hit by a rain of spheres, capsules and boxes,
+// which keeps creating and losing contact pairs, waking bodies up and putting
+// them to sleep. After a warm up, a full state and a delta state against it
+// are saved, and the checksum of the following frames is recorded. The delta
+// state is then restored several times, and every frame of every replay must
+// return the recorded checksum. This is done with the PGS and TGS solvers,
+// with enhanced determinism.
+// ****************************************************************************
+
+#include "PxPhysicsAPI.h"
+
+#include "../snippetutils/SnippetUtils.h"
+#include "../snippetcommon/SnippetPrint.h"
+
+using namespace physx;
+
+PxDefaultAllocator		gAllocator;
+PxDefaultErrorCallback	gErrorCallback;
+
+PxFoundation*			gFoundation = NULL;
+PxPhysics*				gPhysics	= NULL;
+PxDefaultCpuDispatcher*	gDispatcher = NULL;
+PxMaterial*				gMaterial	= NULL;
+
+static const PxU32		gNbPyramids		= 4;
+static const PxU32		gPyramidSize	= 10;
+static const PxU32		gNbFallingBodies= 300;
+static const PxU32		gNbWarmUpFrames	= 120;
+static const PxU32		gNbDeltaFrames	= 5;	// frames between the full state and the delta state
+static const PxU32		gNbFrames		= 60;	// frames replayed after each restore
+static const PxU32		gNbReplays		= 3;
+
+static PxScene* createScene(PxSolverType::Enum solverType)
+{
+	PxSceneDesc sceneDesc(gPhysics->getTolerancesScale());
+	sceneDesc.gravity = PxVec3(0.0f, -9.81f, 0.0f);
+	sceneDesc.cpuDispatcher	= gDispatcher;
+	sceneDesc.filterShader	= PxDefaultSimulationFilterShader;
+	sceneDesc.solverType	= solverType;
+	sceneDesc.flags |= PxSceneFlag::eENABLE_ENHANCED_DETERMINISM;
+	PxScene* scene = gPhysics->createScene(sceneDesc);
+
+	scene->addActor(*PxCreatePlane(*gPhysics, PxPlane(0.0f, 1.0f, 0.0f, 0.0f), *gMaterial));
+
+	const PxBoxGeometry box(0.5f, 0.5f, 0.5f);
+	for(PxU32 i=0; i<gNbPyramids; i++)
+	{
+		for(PxU32 level=0; level<gPyramidSize; level++)
+		{
+			for(PxU32 j=0; j<gPyramidSize-level; j++)
+			{
+				const PxVec3 position(PxReal(i)*14.0f - 20.0f + PxReal(j) + PxReal(level)*0.5f, 0.5f + PxReal(level), 0.0f);
+				scene->addActor(*PxCreateDynamic(*gPhysics, PxTransform(position), box, *gMaterial, 1.0f));
+			}
+		}
+	}
+
+	// PT: the bodies fall in a fixed pseudo-random order, so that all scenes are the same
+	PxU32 seed = 1;
+	for(PxU32 i=0; i<gNbFallingBodies; i++)
+	{
+		seed = seed * 1664525 + 1013904223;
+		const PxVec3 position(PxReal((seed>>8)%40) - 20.0f, 12.0f + PxReal((seed>>16)%20), PxReal((seed>>24)%10) - 5.0f);
+		PxRigidDynamic* body;
+		if(i%3==0)
+			body = PxCreateDynamic(*gPhysics, PxTransform(position), PxSphereGeometry(0.4f), *gMaterial, 1.0f);
+		else if(i%3==1)
+			body = PxCreateDynamic(*gPhysics, PxTransform(position), PxCapsuleGeometry(0.3f, 0.4f), *gMaterial, 1.0f);
+		else
+			body = PxCreateDynamic(*gPhysics, PxTransform(position), PxBoxGeometry(0.3f, 0.2f, 0.4f), *gMaterial, 1.0f);
+		scene->addActor(*body);
+	}
+	return scene;
+}
+
+static void step(PxScene* scene)
+{
+	scene->simulate(1.0f/60.0f);
+	scene->fetchResults(true);
+}
+
+static bool checkRollback(PxSolverType::Enum solverType, const char* name)
+{
+	PxScene* scene = createScene(solverType);
+
+	for(PxU32 frame=0; frame<gNbWarmUpFrames; frame++)
+		step(scene);
+
+	const PxU32 baseSize = scene->getSimulationStateSize();
+	void* baseState = gAllocator.allocate(baseSize, "SimulationState", __FILE__, __LINE__);
+	scene->saveSimulationState(baseState, baseSize);
+
+	for(PxU32 frame=0; frame<gNbDeltaFrames; frame++)
+		step(scene);
+
+	const PxU32 deltaSize = scene->getSimulationStateSize(baseState);
+	void* deltaState = gAllocator.allocate(deltaSize, "SimulationState", __FILE__, __LINE__);
+	const PxU32 usedSize = scene->saveSimulationState(deltaState, deltaSize, baseState);
+
+	PxU64 reference[gNbFrames];
+	for(PxU32 frame=0; frame<gNbFrames; frame++)
+	{
+		step(scene);
+		reference[frame] = scene->getSimulationStateChecksum();
+	}
+
+	bool success = usedSize!=0;
+	if(!success)
+		printf("%s: FAILED, the delta state could not be saved\n", name);
+	for(PxU32 replay=0; replay<gNbReplays && success; replay++)
+	{
+		if(!scene->restoreSimulationState(deltaState, baseState))
+		{
+			printf("%s: FAILED, replay %u could not restore the state\n", name, replay);
+			success = false;
+			break;
+		}
+
+		for(PxU32 frame=0; frame<gNbFrames; frame++)
+		{
+			step(scene);
+			if(scene->getSimulationStateChecksum() != reference[frame])
+			{
+				printf("%s: FAILED, replay %u differs from frame %u\n", name, replay, frame);
+				success = false;
+				break;
+			}
+		}
+	}
+
+	if(success)
+		printf("%s: ok, %u replays of %u frames\n", name, gNbReplays, gNbFrames);
+
+	gAllocator.deallocate(deltaState);
+	gAllocator.deallocate(baseState);
+	scene->release();
+	return success;
+}
+
+int snippetMain(int, const char*const*)
+{
+	gFoundation = PxCreateFoundation(PX_PHYSICS_VERSION, gAllocator, gErrorCallback);
+	gPhysics = PxCreatePhysics(PX_PHYSICS_VERSION, *gFoundation, PxTolerancesScale());
+	gDispatcher = PxDefaultCpuDispatcherCreate(2);
+	gMaterial = gPhysics->createMaterial(0.5f, 0.5f, 0.1f);
+
+	bool success = checkRollback(PxSolverType::ePGS, "PGS");
+	success = checkRollback(PxSolverType::eTGS, "TGS") && success;
+
+	PX_RELEASE(gMaterial);
+	PX_RELEASE(gDispatcher);
+	PX_RELEASE(gPhysics);
+	PX_RELEASE(gFoundation);
+
+	printf("SnippetRollback %s.\n", success ? "done" : "failed");
+
+	return success ? 0 : 1;
+}
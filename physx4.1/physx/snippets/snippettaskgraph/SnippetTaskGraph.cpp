@@ -0,0 +1,265 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+// ****************************************************************************
+// This snippet stress tests the task manager with large random task graphs.
+// Tasks are submitted and wired together from several user threads at once,
+// some through named placeholders, and some are held back with extra
+// references that the main thread removes while the graph is running. After
+// each frame the snippet checks that every task ran exactly once and only
+// after all of its predecessors.
+// ****************************************************************************
+
+#include "PxPhysicsAPI.h"
+#include "task/PxTask.h"
+#include "task/PxTaskManager.h"
+
+#include "../snippetutils/SnippetUtils.h"
+#include "../snippetcommon/SnippetPrint.h"
+
+using namespace physx;
+
+PxDefaultAllocator		gAllocator;
+PxDefaultErrorCallback	gErrorCallback;
+
+PxFoundation*			gFoundation = NULL;
+PxTaskManager*			gTaskManager = NULL;
+
+static const PxU32		gNbTasks			= 50000;
+static const PxU32		gNbNamedTasks		= 64;
+static const PxU32		gMaxPredecessors	= 3;
+static const PxU32		gNbUserThreads		= 4;
+static const PxU32		gNbWorkerThreads	= 4;
+static const PxU32		gNbFrames			= 10;
+
+static volatile PxI32		gRunStamp;
+static volatile PxI32		gNbCompleted;
+static SnippetUtils::Sync*	gGraphDoneSync = NULL;
+
+static char gTaskNames[gNbNamedTasks][32];
+
+class StressTask : public PxTask
+{
+public:
+	void reset()
+	{
+		mNbPredecessors = 0;
+		mStamp = -1;
+		mRunCount = 0;
+	}
+
+	virtual void run()
+	{
+		// a little busy work so that tasks overlap
+		PxU32 x = mTaskID;
+		for(PxU32 i=0; i<64; i++)
+			x = x * 1664525u + 1013904223u;
+		mResult = x;
+
+		mStamp = SnippetUtils::atomicIncrement(&gRunStamp);
+		SnippetUtils::atomicIncrement(&mRunCount);
+	}
+
+	virtual void release()
+	{
+		PxTask::release();
+
+		if(SnippetUtils::atomicIncrement(&gNbCompleted) == PxI32(gNbTasks))
+			SnippetUtils::syncSet(gGraphDoneSync);
+	}
+
+	virtual const char* getName() const { return "StressTask"; }
+
+	PxU32			mPredecessors[gMaxPredecessors];
+	PxU32			mNbPredecessors;
+	volatile PxI32	mStamp;
+	volatile PxI32	mRunCount;
+	PxU32			mResult;
+};
+
+static StressTask gTasks[gNbTasks];
+
+struct UserThread
+{
+	SnippetUtils::Thread*	mThread;
+	PxU32					mIndex;
+	PxU32					mFrame;
+};
+
+static UserThread gUserThreads[gNbUserThreads];
+
+static PX_FORCE_INLINE PxU32 nextRandom(PxU32& seed)
+{
+	seed = seed * 1664525u + 1013904223u;
+	return seed >> 8;
+}
+
+static void submitTasks(void* data)
+{
+	const UserThread* thread = static_cast<const UserThread*>(data);
+	const PxU32 begin = thread->mIndex * gNbTasks / gNbUserThreads;
+	const PxU32 end = (thread->mIndex + 1) * gNbTasks / gNbUserThreads;
+
+	for(PxU32 i=begin; i<end; i++)
+	{
+		gTasks[i].reset();
+		if(i < gNbNamedTasks)
+			gTaskManager->submitNamedTask(&gTasks[i], gTaskNames[i]);
+		else
+			gTaskManager->submitUnnamedTask(gTasks[i]);
+	}
+}
+
+static void addDependencies(void* data)
+{
+	const UserThread* thread = static_cast<const UserThread*>(data);
+	const PxU32 begin = thread->mIndex * gNbTasks / gNbUserThreads;
+	const PxU32 end = (thread->mIndex + 1) * gNbTasks / gNbUserThreads;
+	PxU32 seed = thread->mFrame * 7919u + thread->mIndex;
+
+	for(PxU32 i=PxMax(begin, 1u); i<end; i++)
+	{
+		StressTask& task = gTasks[i];
+		const PxU32 nbPredecessors = nextRandom(seed) % (gMaxPredecessors + 1);
+		for(PxU32 k=0; k<nbPredecessors; k++)
+		{
+			// mostly nearby predecessors to build deep chains, sometimes far ones across thread ranges
+			const PxU32 distance = (nextRandom(seed) & 7) ? 1 + nextRandom(seed) % 32 : 1 + nextRandom(seed) % i;
+			const PxU32 predecessor = distance > i ? 0 : i - distance;
+
+			if(k & 1)
+				task.startAfter(gTasks[predecessor].getTaskID());
+			else
+				gTasks[predecessor].finishBefore(task.getTaskID());
+
+			task.mPredecessors[task.mNbPredecessors++] = predecessor;
+		}
+
+		// held back until the main thread removes the reference during the frame
+		if((i & 7) == 0)
+			task.addReference();
+	}
+}
+
+static void runUserThreads(SnippetUtils::ThreadEntryPoint entryPoint, PxU32 frame)
+{
+	for(PxU32 i=0; i<gNbUserThreads; i++)
+	{
+		gUserThreads[i].mIndex = i;
+		gUserThreads[i].mFrame = frame;
+		gUserThreads[i].mThread = SnippetUtils::threadCreate(entryPoint, &gUserThreads[i]);
+	}
+
+	for(PxU32 i=0; i<gNbUserThreads; i++)
+	{
+		SnippetUtils::threadWaitForQuit(gUserThreads[i].mThread);
+		SnippetUtils::threadRelease(gUserThreads[i].mThread);
+	}
+}
+
+static bool runFrame(PxU32 frame)
+{
+	gTaskManager->resetDependencies();
+	gRunStamp = 0;
+	gNbCompleted = 0;
+	SnippetUtils::syncReset(gGraphDoneSync);
+
+	// Register placeholders first so that the named submissions have to fill them in.
+	for(PxU32 i=0; i<gNbNamedTasks; i++)
+		gTaskManager->getNamedTask(gTaskNames[i]);
+
+	runUserThreads(submitTasks, frame);
+	runUserThreads(addDependencies, frame);
+
+	const PxU64 startTime = SnippetUtils::getCurrentTimeCounterValue();
+
+	gTaskManager->startSimulation();
+
+	// Remove the extra references while the graph is already executing.
+	for(PxU32 i=8; i<gNbTasks; i+=8)
+		gTasks[i].removeReference();
+
+	SnippetUtils::syncWait(gGraphDoneSync);
+	gTaskManager->stopSimulation();
+
+	const PxU64 endTime = SnippetUtils::getCurrentTimeCounterValue();
+
+	bool success = true;
+	for(PxU32 i=0; i<gNbTasks && success; i++)
+	{
+		const StressTask& task = gTasks[i];
+		if(task.mRunCount != 1)
+		{
+			printf("Task %d ran %d times.\n", i, task.mRunCount);
+			success = false;
+		}
+
+		for(PxU32 k=0; k<task.mNbPredecessors; k++)
+		{
+			if(gTasks[task.mPredecessors[k]].mStamp >= task.mStamp)
+			{
+				printf("Task %d ran before its predecessor %d.\n", i, task.mPredecessors[k]);
+				success = false;
+			}
+		}
+	}
+
+	printf("Frame %d: %d tasks in %.3f ms, %s\n", frame, gNbTasks, double(SnippetUtils::getElapsedTimeInMilliseconds(endTime - startTime)), success ? "ok" : "FAILED");
+	return success;
+}
+
+int snippetMain(int, const char*const*)
+{
+	gFoundation = PxCreateFoundation(PX_PHYSICS_VERSION, gAllocator, gErrorCallback);
+	gGraphDoneSync = SnippetUtils::syncCreate();
+
+	for(PxU32 i=0; i<gNbNamedTasks; i++)
+		sprintf(gTaskNames[i], "StressTask%d", i);
+
+	bool success = true;
+	const PxDefaultCpuDispatcherMode::Enum modes[2] = { PxDefaultCpuDispatcherMode::eSHARED_QUEUE, PxDefaultCpuDispatcherMode::eWORK_STEALING };
+	for(PxU32 m=0; m<2; m++)
+	{
+		PxDefaultCpuDispatcher* dispatcher = PxDefaultCpuDispatcherCreate(gNbWorkerThreads, NULL, modes[m]);
+		gTaskManager = PxTaskManager::createTaskManager(gErrorCallback, dispatcher);
+
+		for(PxU32 i=0; i<gNbFrames; i++)
+			success &= runFrame(i);
+
+		PX_RELEASE(gTaskManager);
+		PX_RELEASE(dispatcher);
+	}
+
+	SnippetUtils::syncRelease(gGraphDoneSync);
+	PX_RELEASE(gFoundation);
+
+	printf("SnippetTaskGraph %s.\n", success ? "done" : "failed");
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,181 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef PX_PHYSICS_COMMON_CHUNKED_JOB
+#define PX_PHYSICS_COMMON_CHUNKED_JOB
+
+#include "task/PxCpuDispatcher.h"
+#include "CmPhysXCommon.h"
+#include "CmTask.h"
+#include "PsUserAllocated.h"
+#include "PsAtomic.h"
+#include "PsThread.h"
+
+namespace physx
+{
+namespace Cm
+{
+	class ChunkedJob;
+
+	class ChunkedJobTask : public Cm::BaseTask, public Ps::UserAllocated
+	{
+	public:
+								ChunkedJobTask(ChunkedJob& job) : mJob(job)	{}
+
+		virtual	void			runInternal();
+		virtual	const char*		getName()	const	{ return "Cm.ChunkedJob";	}
+		virtual	void			release();
+		virtual	void			addReference()			{}
+		virtual	void			removeReference()		{}
+		virtual	PxI32			getReference()	const	{ return 1;	}
+	private:
+		PX_NOCOPY(ChunkedJobTask)
+
+				ChunkedJob&		mJob;
+	};
+
+	// Work over a range of items, processed in chunks claimed by the calling thread and by helper tasks submitted straight to the
+	// dispatcher. The caller always takes part, so this also works from a task or with a dispatcher without workers. Helpers may
+	// run after the job is over, so the job is reference counted and released by its last user.
+	class ChunkedJob : public Ps::UserAllocated
+	{
+	public:
+		ChunkedJob(PxU32 nbItems, PxU32 chunkSize) :
+			mNbItems	(nbItems),
+			mChunkSize	(chunkSize),
+			mNbChunks	((nbItems + chunkSize - 1)/chunkSize),
+			mRefCount	(1),
+			mNextChunk	(0),
+			mNbDone		(0)
+		{
+		}
+
+		virtual	~ChunkedJob()	{}
+
+		// Processes items [start, end). Calls for different chunks can run in parallel.
+		virtual	void	process(PxU32 start, PxU32 end)	= 0;
+
+		PX_FORCE_INLINE	PxU32	getNbItems()	const	{ return mNbItems;		}
+		PX_FORCE_INLINE	PxU32	getChunkSize()	const	{ return mChunkSize;	}
+		PX_FORCE_INLINE	PxU32	getNbChunks()	const	{ return mNbChunks;		}
+
+		void	addRef()	{ Ps::atomicIncrement(&mRefCount);	}
+		void	releaseRef()
+		{
+			if(!Ps::atomicDecrement(&mRefCount))
+				PX_DELETE(this);
+		}
+
+		// Submits helper tasks for the chunks, up to one per worker thread. Does nothing without a dispatcher or workers.
+		void	start(PxCpuDispatcher* dispatcher)
+		{
+			if(!dispatcher)
+				return;
+
+			const PxU32 nbHelpers = PxMin(dispatcher->getWorkerCount(), mNbChunks);
+			for(PxU32 i=0;i<nbHelpers;i++)
+			{
+				addRef();
+				dispatcher->submitTask(*PX_NEW(ChunkedJobTask)(*this));
+			}
+		}
+
+		// Processes the chunks not claimed by helpers yet, then waits for the helpers.
+		void	wait()
+		{
+			processChunks();
+
+			// Remaining chunks have been claimed by helpers that are running, wait for them.
+			while(PxU32(Ps::atomicAdd(&mNbDone, 0))!=mNbChunks)
+				Ps::Thread::yield();
+		}
+
+		// Processes all items, over the worker threads of the dispatcher if there are at least parallelThreshold of them.
+		void	run(PxCpuDispatcher* dispatcher, PxU32 parallelThreshold)
+		{
+			if(mNbItems<parallelThreshold || mNbChunks<2)
+			{
+				process(0, mNbItems);
+				return;
+			}
+
+			if(dispatcher && dispatcher->getWorkerCount())
+			{
+				// PT: the caller takes a chunk as well, no need for a helper per chunk
+				const PxU32 nbHelpers = PxMin(dispatcher->getWorkerCount(), mNbChunks-1);
+				for(PxU32 i=0;i<nbHelpers;i++)
+				{
+					addRef();
+					dispatcher->submitTask(*PX_NEW(ChunkedJobTask)(*this));
+				}
+			}
+			wait();
+		}
+
+		void	processChunks()
+		{
+			for(;;)
+			{
+				const PxU32 chunk = PxU32(Ps::atomicIncrement(&mNextChunk) - 1);
+				if(chunk>=mNbChunks)
+					return;
+
+				const PxU32 start = chunk*mChunkSize;
+				process(start, PxMin(start + mChunkSize, mNbItems));
+				Ps::atomicIncrement(&mNbDone);
+			}
+		}
+	private:
+		PX_NOCOPY(ChunkedJob)
+
+		const	PxU32			mNbItems;
+		const	PxU32			mChunkSize;
+		const	PxU32			mNbChunks;
+				volatile PxI32	mRefCount;
+				volatile PxI32	mNextChunk;
+				volatile PxI32	mNbDone;	// number of processed chunks
+	};
+
+	PX_INLINE void ChunkedJobTask::runInternal()
+	{
+		mJob.processChunks();
+	}
+
+	PX_INLINE void ChunkedJobTask::release()
+	{
+		ChunkedJob& job = mJob;
+		PX_DELETE(this);
+		job.releaseRef();
+	}
+
+} // namespace Cm
+
+}
+
+#endif
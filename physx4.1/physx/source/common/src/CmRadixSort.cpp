@@ -153,7 +153,7 @@ PX_INLINE const PxU32* CheckPassValidity(PxU32 pass, const PxU32* mHistogram1024
  */
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-RadixSort::RadixSort() : mCurrentSize(0), mRanks(NULL), mRanks2(NULL), mHistogram1024(0), mLinks256(0), mTotalCalls(0), mNbHits(0), mDeleteRanks(true)
+RadixSort::RadixSort() : mCurrentSize(0), mRanks(NULL), mRanks2(NULL), mHistogram1024(0), mLinks256(0), mDispatcher(NULL), mTotalCalls(0), mNbHits(0), mDeleteRanks(true)
 {
 	// Initialize indices
 	INVALIDATE_RANKS;
@@ -194,6 +194,10 @@ RadixSort& RadixSort::Sort(const PxU32* input, PxU32 nb, RadixHint hint)
 	// Stats
 	mTotalCalls++;
 
+	// Large inputs are sorted in parallel when a dispatcher is available
+	if(mDispatcher && SortParallel(input, nb, hint==RADIX_UNSIGNED ? 0 : 1))
+		return *this;
+
 	// Create histograms (counters). Counters for all passes are created in one run.
 	// Pros:	read input buffer once instead of four times
 	// Cons:	mHistogram1024 is 4Kb instead of 1Kb
@@ -304,6 +308,10 @@ RadixSort& RadixSort::Sort(const float* input2, PxU32 nb)
 
 	const PxU32* PX_RESTRICT input = reinterpret_cast<const PxU32*>(input2);
 
+	// Large inputs are sorted in parallel when a dispatcher is available
+	if(mDispatcher && SortParallel(input, nb, 2))
+		return *this;
+
 	// Allocate histograms & offsets on the stack
 	//PxU32 mHistogram1024[256*4];
 	//PxU32* mLinks256[256];
@@ -34,6 +34,8 @@
 
 namespace physx
 {
+	class PxCpuDispatcher;
+
 namespace Cm
 {
 
@@ -73,15 +75,21 @@ namespace Cm
 		PX_FORCE_INLINE	void			invalidateRanks()			{ INVALIDATE_RANKS;		}
 
 						bool			SetBuffers(PxU32* ranks0, PxU32* ranks1, PxU32* histogram1024, PxU32** links256);
+
+		//! Large inputs are sorted in parallel on this dispatcher's worker threads. NULL (default) to always sort on the calling thread.
+		PX_FORCE_INLINE	void			SetDispatcher(PxCpuDispatcher* dispatcher)	{ mDispatcher = dispatcher;	}
+		PX_FORCE_INLINE	PxCpuDispatcher*	GetDispatcher()		const	{ return mDispatcher;	}
 		private:
 										RadixSort(const RadixSort& object);
 										RadixSort& operator=(const RadixSort& object);
+						bool			SortParallel(const PxU32* input, PxU32 nb, PxU32 keyType);
 		protected:
 						PxU32			mCurrentSize;		//!< Current size of the indices list
 						PxU32*			mRanks;				//!< Two lists, swapped each pass
 						PxU32*			mRanks2;
 						PxU32*			mHistogram1024;
 						PxU32**			mLinks256;
+						PxCpuDispatcher*	mDispatcher;		//!< Optional dispatcher for large inputs
 		// Stats
 						PxU32			mTotalCalls;		//!< Total number of calls to the sort routine
 						PxU32			mNbHits;			//!< Number of early exits due to coherence
@@ -0,0 +1,343 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#include "foundation/PxMemory.h"
+#include "foundation/PxAssert.h"
+#include "foundation/PxMath.h"
+#include "task/PxCpuDispatcher.h"
+#include "CmRadixSort.h"
+#include "CmChunkedJob.h"
+#include "PsAllocator.h"
+
+using namespace physx;
+using namespace Cm;
+
+// Multi-threaded LSD radix sort, used by RadixSort::Sort for large inputs when a dispatcher has been set.
+//
+// Keys are first converted to unsigned keys with the same ordering (sign flip for signed integers, sign flip
+// or full flip for floats) and sorted together with their indices in four 8-bit passes. Each pass runs two
+// parallel phases over fixed chunks of the current sequence:
+// - histogram phase: each chunk counts its digits,
+// - scatter phase: each chunk writes its keys to its own slice of each destination bucket.
+// The bucket offsets of each chunk are computed on the calling thread between both phases. Each phase is a
+// Cm::ChunkedJob, so the calling thread processes chunks as well and this also works when called from a task.
+//
+// The result is a stable sort of the converted keys, and the chunk layout only depends on the number of keys.
+// This path runs for every large input once a dispatcher is set, whatever its number of workers (the calling
+// thread then processes all chunks), so the ranks never depend on the thread count. They match the serial
+// sort, except for the order of equal negative floats, which the serial path reverses.
+
+namespace
+{
+	enum KeyType
+	{
+		eKEY_UNSIGNED,
+		eKEY_SIGNED,
+		eKEY_FLOAT
+	};
+
+	static const PxU32 PARALLEL_THRESHOLD	= 32768;	// smaller inputs are sorted by the serial version
+	static const PxU32 MIN_CHUNK_SIZE		= 8192;
+	static const PxU32 MAX_NB_CHUNKS		= 64;
+
+	enum Phase
+	{
+		ePHASE_INIT,		// converts keys, gathers initial indices and counts all four digits
+		ePHASE_HISTOGRAM,
+		ePHASE_SCATTER
+	};
+
+	PX_FORCE_INLINE PxU32 convertKey(PxU32 key, KeyType type)
+	{
+		if(type==eKEY_SIGNED)
+			return key ^ 0x80000000;
+		if(type==eKEY_FLOAT)
+		{
+			// Negative floats: flip all bits so that larger magnitudes come first. Positive floats: flip the sign bit.
+			const PxU32 mask = PxU32(PxI32(key)>>31) | 0x80000000;
+			return key ^ mask;
+		}
+		return key;
+	}
+
+	// State of one parallel sort, shared by the chunk jobs of its phases. It lives on the calling thread's stack:
+	// a helper task that starts after its phase is over finds no chunk to claim and never touches it.
+	class RadixSortData
+	{
+	public:
+		RadixSortData(const PxU32* input, PxU32 nb, KeyType type, const PxU32* initialRanks, PxU32 nbChunks) :
+			mInput			(input),
+			mInitialRanks	(initialRanks),
+			mNb				(nb),
+			mType			(type),
+			mChunkSize		((nb + nbChunks - 1)/nbChunks),
+			mNbChunks		((nb + mChunkSize - 1)/mChunkSize),
+			mPass			(0),
+			mSrc			(0)
+		{
+			mKeys[0]	= reinterpret_cast<PxU32*>(PX_ALLOC(sizeof(PxU32)*nb*2, "RadixSortData:mKeys"));
+			mKeys[1]	= mKeys[0] + nb;
+			mIndices[0]	= NULL;
+			mIndices[1]	= NULL;
+			mCounts		= reinterpret_cast<PxU32*>(PX_ALLOC(sizeof(PxU32)*mNbChunks*256*4, "RadixSortData:mCounts"));
+		}
+
+		~RadixSortData()
+		{
+			PX_FREE(mCounts);
+			PX_FREE(mKeys[0]);
+		}
+
+		void	runPhase(Phase phase, PxCpuDispatcher* dispatcher);
+
+		void	initChunk(PxU32 chunk, PxU32 start, PxU32 end)
+		{
+			PxU32* PX_RESTRICT counts = mCounts + chunk*256*4;
+			PxMemZero(counts, sizeof(PxU32)*256*4);
+
+			const KeyType type = mType;
+			const PxU32* PX_RESTRICT input = mInput;
+			PxU32* PX_RESTRICT keys = mKeys[0];
+			PxU32* PX_RESTRICT indices = mIndices[0];
+			for(PxU32 i=start;i<end;i++)
+			{
+				const PxU32 index = mInitialRanks ? mInitialRanks[i] : i;
+				const PxU32 key = convertKey(input[index], type);
+				keys[i] = key;
+				indices[i] = index;
+				counts[key & 0xff]++;
+				counts[256 + ((key>>8) & 0xff)]++;
+				counts[512 + ((key>>16) & 0xff)]++;
+				counts[768 + (key>>24)]++;
+			}
+		}
+
+		void	histogramChunk(PxU32 chunk, PxU32 start, PxU32 end)
+		{
+			// Interleaved sub-histograms break the dependency between consecutive increments of the same bucket.
+			PxU32 counts[4][256];
+			PxMemZero(counts, sizeof(counts));
+
+			const PxU32 shift = mPass*8;
+			const PxU32* PX_RESTRICT keys = mKeys[mSrc];
+			PxU32 i = start;
+			for(;i+4<=end;i+=4)
+			{
+				counts[0][(keys[i+0]>>shift) & 0xff]++;
+				counts[1][(keys[i+1]>>shift) & 0xff]++;
+				counts[2][(keys[i+2]>>shift) & 0xff]++;
+				counts[3][(keys[i+3]>>shift) & 0xff]++;
+			}
+			for(;i<end;i++)
+				counts[0][(keys[i]>>shift) & 0xff]++;
+
+			PxU32* PX_RESTRICT dst = mCounts + chunk*256;
+			for(PxU32 j=0;j<256;j++)
+				dst[j] = counts[0][j] + counts[1][j] + counts[2][j] + counts[3][j];
+		}
+
+		void	scatterChunk(PxU32 chunk, PxU32 start, PxU32 end)
+		{
+			PxU32 offsets[256];
+			PxMemCopy(offsets, mCounts + chunk*256, sizeof(PxU32)*256);
+
+			const PxU32 shift = mPass*8;
+			const PxU32* PX_RESTRICT srcKeys = mKeys[mSrc];
+			const PxU32* PX_RESTRICT srcIndices = mIndices[mSrc];
+			PxU32* PX_RESTRICT dstKeys = mKeys[1-mSrc];
+			PxU32* PX_RESTRICT dstIndices = mIndices[1-mSrc];
+			for(PxU32 i=start;i<end;i++)
+			{
+				const PxU32 key = srcKeys[i];
+				const PxU32 dst = offsets[(key>>shift) & 0xff]++;
+				dstKeys[dst] = key;
+				dstIndices[dst] = srcIndices[i];
+			}
+		}
+
+		// Turns the per-chunk counts of the current pass into per-chunk write offsets. Chunk counts are stored
+		// with a stride of 256 for histogram phases, and 1024 (one set per digit) after the init phase.
+		void	computeOffsets(PxU32 countsStride, PxU32 countsOffset)
+		{
+			PxU32 offset = 0;
+			for(PxU32 digit=0;digit<256;digit++)
+			{
+				for(PxU32 chunk=0;chunk<mNbChunks;chunk++)
+				{
+					const PxU32 count = mCounts[chunk*countsStride + countsOffset + digit];
+					// Offsets are written in place. With a stride of 1024 a write never hits counts that are still to be read.
+					mCounts[chunk*256 + digit] = offset;
+					offset += count;
+				}
+			}
+			PX_ASSERT(offset==mNb);
+		}
+
+		const PxU32*		mInput;
+		const PxU32*		mInitialRanks;
+		PxU32*				mKeys[2];
+		PxU32*				mIndices[2];
+		PxU32*				mCounts;
+		const PxU32			mNb;
+		const KeyType		mType;
+		const PxU32			mChunkSize;
+		const PxU32			mNbChunks;
+		PxU32				mPass;		// current digit
+		PxU32				mSrc;		// index of the source buffers of the current pass
+	private:
+		PX_NOCOPY(RadixSortData)
+	};
+
+	class RadixSortPhaseJob : public Cm::ChunkedJob
+	{
+	public:
+		RadixSortPhaseJob(RadixSortData& data, Phase phase) :
+			Cm::ChunkedJob	(data.mNb, data.mChunkSize),
+			mData			(data),
+			mPhase			(phase)
+		{
+			PX_ASSERT(getNbChunks()==data.mNbChunks);
+		}
+
+		virtual	void	process(PxU32 start, PxU32 end)
+		{
+			const PxU32 chunk = start/mData.mChunkSize;
+			if(mPhase==ePHASE_INIT)
+				mData.initChunk(chunk, start, end);
+			else if(mPhase==ePHASE_HISTOGRAM)
+				mData.histogramChunk(chunk, start, end);
+			else
+				mData.scatterChunk(chunk, start, end);
+		}
+	private:
+		PX_NOCOPY(RadixSortPhaseJob)
+
+				RadixSortData&	mData;
+		const	Phase			mPhase;
+	};
+
+	void RadixSortData::runPhase(Phase phase, PxCpuDispatcher* dispatcher)
+	{
+		RadixSortPhaseJob* job = PX_NEW(RadixSortPhaseJob)(*this, phase);
+		job->run(dispatcher, 0);
+		job->releaseRef();
+	}
+}
+
+bool RadixSort::SortParallel(const PxU32* input, PxU32 nb, PxU32 keyType)
+{
+	PX_ASSERT(mDispatcher);
+
+	if(nb<PARALLEL_THRESHOLD)
+		return false;
+	const PxU32 nbChunks = PxMin(nb/MIN_CHUNK_SIZE, MAX_NB_CHUNKS);
+
+	const KeyType type = KeyType(keyType);
+
+	// Temporal coherence: same early exit as the serial version when the input is already sorted in the
+	// order of the previous ranks.
+	const PxU32* initialRanks = INVALID_RANKS ? NULL : mRanks;
+	{
+		PxU32 prev = convertKey(input[initialRanks ? initialRanks[0] : 0], type);
+		PxU32 i = 1;
+		for(;i<nb;i++)
+		{
+			const PxU32 key = convertKey(input[initialRanks ? initialRanks[i] : i], type);
+			if(key<prev)
+				break;
+			prev = key;
+		}
+		if(i==nb)
+		{
+			mNbHits++;
+			if(!initialRanks)
+			{
+				for(PxU32 j=0;j<nb;j++)
+					mRanks[j] = j;
+			}
+			return true;
+		}
+	}
+
+	// The initial ranks are read and overwritten in the init phase, move them out of the way first.
+	if(initialRanks)
+	{
+		PxMemCopy(mRanks2, mRanks, sizeof(PxU32)*nb);
+		initialRanks = mRanks2;
+	}
+
+	RadixSortData data(input, nb, type, initialRanks, nbChunks);
+	data.mIndices[0] = mRanks;
+	data.mIndices[1] = mRanks2;
+
+	data.runPhase(ePHASE_INIT, mDispatcher);
+
+	// Passes where all keys share the same digit are skipped.
+	bool skipPass[4];
+	for(PxU32 pass=0;pass<4;pass++)
+	{
+		const PxU32 digit = (data.mKeys[0][0]>>(pass*8)) & 0xff;
+		PxU32 count = 0;
+		for(PxU32 chunk=0;chunk<data.mNbChunks;chunk++)
+			count += data.mCounts[chunk*1024 + pass*256 + digit];
+		skipPass[pass] = count==nb;
+	}
+
+	PxU32 src = 0;
+	bool firstPass = true;
+	for(PxU32 pass=0;pass<4;pass++)
+	{
+		if(skipPass[pass])
+			continue;
+
+		data.mPass = pass;
+		data.mSrc = src;
+		if(firstPass)
+		{
+			// The init phase counted the keys in their initial order, which is the order of the first pass.
+			data.computeOffsets(1024, pass*256);
+			firstPass = false;
+		}
+		else
+		{
+			data.runPhase(ePHASE_HISTOGRAM, mDispatcher);
+			data.computeOffsets(256, 0);
+		}
+		data.runPhase(ePHASE_SCATTER, mDispatcher);
+		src = 1 - src;
+	}
+
+	// Sorted indices are in the last destination buffer.
+	if(src)
+	{
+		PxU32* tmp = mRanks;	mRanks = mRanks2; mRanks2 = tmp;
+	}
+	VALIDATE_RANKS;
+	return true;
+}
@@ -46,6 +46,7 @@ SOURCE_GROUP("includes" FILES ${LLAABB_HEADERS})
 
 SET(LLAABB_SOURCE	
 	${LLAABB_DIR}/src/BpAABBManager.cpp
+	${LLAABB_DIR}/src/BpABPTasks.h
 	${LLAABB_DIR}/src/BpBroadPhase.cpp
 	${LLAABB_DIR}/src/BpBroadPhaseABP.cpp
 	${LLAABB_DIR}/src/BpBroadPhaseABP.h
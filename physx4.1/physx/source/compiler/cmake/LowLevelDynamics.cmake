@@ -68,6 +68,7 @@ SET(LLDYNAMICS_SOURCE
 	${LLDYNAMICS_BASE_DIR}/src/DyConstraintSetupBlock.cpp
 	${LLDYNAMICS_BASE_DIR}/src/DyContactPrep.cpp
 	${LLDYNAMICS_BASE_DIR}/src/DyContactPrep4.cpp
+	${LLDYNAMICS_BASE_DIR}/src/DyContactPrep8.cpp
 	${LLDYNAMICS_BASE_DIR}/src/DyContactPrep4PF.cpp
 	${LLDYNAMICS_BASE_DIR}/src/DyContactPrepPF.cpp
 	${LLDYNAMICS_BASE_DIR}/src/DyDynamics.cpp
@@ -88,6 +89,16 @@ SET(LLDYNAMICS_SOURCE
 )
 SOURCE_GROUP("Dynamics Source" FILES ${LLDYNAMICS_SOURCE})
 
+IF(LOWLEVELDYNAMICS_AVX2_SOURCE)
+	IF(NOT LOWLEVELDYNAMICS_AVX2_DEFS)
+		SET(LOWLEVELDYNAMICS_AVX2_DEFS PX_DY_AVX2_KERNELS=1)
+	ENDIF()
+	SET_SOURCE_FILES_PROPERTIES(${LOWLEVELDYNAMICS_AVX2_SOURCE} PROPERTIES COMPILE_OPTIONS "${LOWLEVELDYNAMICS_AVX2_FLAGS}")
+	SOURCE_GROUP("Dynamics Source\\AVX2" FILES ${LOWLEVELDYNAMICS_AVX2_SOURCE})
+	LIST(APPEND LLDYNAMICS_SOURCE ${LOWLEVELDYNAMICS_AVX2_SOURCE})
+	LIST(APPEND LOWLEVELDYNAMICS_COMPILE_DEFS ${LOWLEVELDYNAMICS_AVX2_DEFS})
+ENDIF()
+
 SET(LLDYNAMICS_INTERNAL_INCLUDES			
 	${LLDYNAMICS_BASE_DIR}/src/DyArticulationContactPrep.h
 	${LLDYNAMICS_BASE_DIR}/src/DyArticulationFnsDebug.h
@@ -109,6 +120,7 @@ SET(LLDYNAMICS_INTERNAL_INCLUDES
 	${LLDYNAMICS_BASE_DIR}/src/DyDynamics.h
 	${LLDYNAMICS_BASE_DIR}/src/DyFrictionPatch.h
 	${LLDYNAMICS_BASE_DIR}/src/DyFrictionPatchStreamPair.h
+	${LLDYNAMICS_BASE_DIR}/src/DySolverAvx2.h
 	${LLDYNAMICS_BASE_DIR}/src/DySolverBody.h
 	${LLDYNAMICS_BASE_DIR}/src/DySolverConstraint1D.h
 	${LLDYNAMICS_BASE_DIR}/src/DySolverConstraint1D4.h
@@ -118,6 +130,7 @@ SET(LLDYNAMICS_INTERNAL_INCLUDES
 	${LLDYNAMICS_BASE_DIR}/src/DySolverConstraintTypes.h
 	${LLDYNAMICS_BASE_DIR}/src/DySolverContact.h
 	${LLDYNAMICS_BASE_DIR}/src/DySolverContact4.h
+	${LLDYNAMICS_BASE_DIR}/src/DySolverContact8.h
 	${LLDYNAMICS_BASE_DIR}/src/DySolverContactPF.h
 	${LLDYNAMICS_BASE_DIR}/src/DySolverContactPF4.h
 	${LLDYNAMICS_BASE_DIR}/src/DySolverContext.h
@@ -196,3 +209,22 @@ ENDIF()
 
 # enable -fPIC so we can link static libs with the editor
 SET_TARGET_PROPERTIES(LowLevelDynamics PROPERTIES POSITION_INDEPENDENT_CODE TRUE)
+
+# Checks that the AVX2 kernels don't export VEX code outside Dy::Avx2 and the aos fma namespace, see DySolverAvx2.h.
+# Not part of the default build, run it with "cmake --build . --target LowLevelDynamicsAvx2Check".
+IF(LOWLEVELDYNAMICS_AVX2_SOURCE)
+	FIND_PACKAGE(PythonInterp 3 QUIET)
+	IF(PYTHONINTERP_FOUND)
+		IF(LOWLEVELDYNAMICS_LIBTYPE STREQUAL "OBJECT")
+			SET(LOWLEVELDYNAMICS_AVX2_CHECK_INPUT $<TARGET_OBJECTS:LowLevelDynamics>)
+		ELSE()
+			SET(LOWLEVELDYNAMICS_AVX2_CHECK_INPUT $<TARGET_FILE:LowLevelDynamics>)
+		ENDIF()
+		ADD_CUSTOM_TARGET(LowLevelDynamicsAvx2Check
+			COMMAND ${PYTHON_EXECUTABLE} ${PHYSX_ROOT_DIR}/buildtools/check_avx2_isolation.py ${LOWLEVELDYNAMICS_AVX2_CHECK_INPUT}
+			COMMAND_EXPAND_LISTS
+			VERBATIM
+		)
+		ADD_DEPENDENCIES(LowLevelDynamicsAvx2Check LowLevelDynamics)
+	ENDIF()
+ENDIF()
@@ -47,10 +47,12 @@ SET(PHYSX_COMMON_SOURCE
 	${COMMON_SRC_DIR}/CmPtrTable.cpp
 	${COMMON_SRC_DIR}/CmRadixSort.cpp
 	${COMMON_SRC_DIR}/CmRadixSortBuffered.cpp
+	${COMMON_SRC_DIR}/CmRadixSortParallel.cpp
 	${COMMON_SRC_DIR}/CmRenderOutput.cpp
 	${COMMON_SRC_DIR}/CmVisualization.cpp
 	${COMMON_SRC_DIR}/CmBitMap.h
 	${COMMON_SRC_DIR}/CmBlockArray.h
+	${COMMON_SRC_DIR}/CmChunkedJob.h
 	${COMMON_SRC_DIR}/CmCollection.h
 	${COMMON_SRC_DIR}/CmConeLimitHelper.h
 	${COMMON_SRC_DIR}/CmFlushPool.h
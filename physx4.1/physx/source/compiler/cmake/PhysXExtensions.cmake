@@ -38,6 +38,7 @@ include(${PHYSX_ROOT_DIR}/${PROJECT_CMAKE_FILES_DIR}/${TARGET_BUILD_PLATFORM}/Ph
 
 
 SET(PHYSX_EXTENSIONS_SOURCE
+	${LL_SOURCE_DIR}/ExtBatchQueryExt.cpp
 	${LL_SOURCE_DIR}/ExtBroadPhase.cpp
 	${LL_SOURCE_DIR}/ExtCollection.cpp
 	${LL_SOURCE_DIR}/ExtConvexMeshExt.cpp
@@ -55,6 +56,7 @@ SET(PHYSX_EXTENSIONS_SOURCE
 	${LL_SOURCE_DIR}/ExtJoint.cpp
 	${LL_SOURCE_DIR}/ExtMetaData.cpp
 	${LL_SOURCE_DIR}/ExtPrismaticJoint.cpp
+	${LL_SOURCE_DIR}/ExtProfileTraceRecorder.cpp
 	${LL_SOURCE_DIR}/ExtPvd.cpp
 	${LL_SOURCE_DIR}/ExtPxStringTable.cpp
 	${LL_SOURCE_DIR}/ExtRaycastCCD.cpp
@@ -66,6 +68,7 @@ SET(PHYSX_EXTENSIONS_SOURCE
 	${LL_SOURCE_DIR}/ExtSmoothNormals.cpp
 	${LL_SOURCE_DIR}/ExtSphericalJoint.cpp
 	${LL_SOURCE_DIR}/ExtTriangleMeshExt.cpp
+	${LL_SOURCE_DIR}/ExtWorkStealingCpuDispatcher.cpp
 	${LL_SOURCE_DIR}/ExtConstraintHelper.h
 	${LL_SOURCE_DIR}/ExtCpuWorkerThread.h
 	${LL_SOURCE_DIR}/ExtD6Joint.h
@@ -79,12 +82,15 @@ SET(PHYSX_EXTENSIONS_SOURCE
 	${LL_SOURCE_DIR}/ExtJointMetaDataExtensions.h
 	${LL_SOURCE_DIR}/ExtPlatform.h
 	${LL_SOURCE_DIR}/ExtPrismaticJoint.h
+	${LL_SOURCE_DIR}/ExtProfileTraceRecorder.h
 	${LL_SOURCE_DIR}/ExtPvd.h
 	${LL_SOURCE_DIR}/ExtRevoluteJoint.h
 	${LL_SOURCE_DIR}/ExtSerialization.h
 	${LL_SOURCE_DIR}/ExtSharedQueueEntryPool.h
 	${LL_SOURCE_DIR}/ExtSphericalJoint.h
 	${LL_SOURCE_DIR}/ExtTaskQueueHelper.h	
+	${LL_SOURCE_DIR}/ExtWorkStealingCpuDispatcher.h
+	${LL_SOURCE_DIR}/ExtWorkStealingQueue.h
 )
 SOURCE_GROUP(src FILES ${PHYSX_EXTENSIONS_SOURCE})
 
@@ -98,6 +104,7 @@ SOURCE_GROUP(src\\metadata FILES ${PHYSX_EXTENSIONS_METADATA_SOURCE})
 
 SET(PHYSX_EXTENSIONS_HEADERS
 	${PHYSX_ROOT_DIR}/include/extensions/PxBinaryConverter.h
+	${PHYSX_ROOT_DIR}/include/extensions/PxBatchQueryExt.h
 	${PHYSX_ROOT_DIR}/include/extensions/PxBroadPhaseExt.h
 	${PHYSX_ROOT_DIR}/include/extensions/PxCollectionExt.h
 	${PHYSX_ROOT_DIR}/include/extensions/PxConstraintExt.h
@@ -119,6 +126,7 @@ SET(PHYSX_EXTENSIONS_HEADERS
 #	${PHYSX_ROOT_DIR}/include/extensions/PxJointRepXSerializer.h
 	${PHYSX_ROOT_DIR}/include/extensions/PxMassProperties.h
 	${PHYSX_ROOT_DIR}/include/extensions/PxPrismaticJoint.h
+	${PHYSX_ROOT_DIR}/include/extensions/PxProfileTraceRecorder.h
 	${PHYSX_ROOT_DIR}/include/extensions/PxRaycastCCD.h
 	${PHYSX_ROOT_DIR}/include/extensions/PxRepXSerializer.h
 	${PHYSX_ROOT_DIR}/include/extensions/PxRepXSimpleType.h
@@ -125,6 +125,7 @@ SET(PHYSXFOUNDATION_SOURCE_HEADERS
 	${LL_SOURCE_DIR}/include/PsUserAllocated.h
 	${LL_SOURCE_DIR}/include/PsUtilities.h
 	${LL_SOURCE_DIR}/include/PsVecMath.h
+	${LL_SOURCE_DIR}/include/PsVecMathAVX.h
 	${LL_SOURCE_DIR}/include/PsVecMathAoSScalar.h
 	${LL_SOURCE_DIR}/include/PsVecMathAoSScalarInline.h
 	${LL_SOURCE_DIR}/include/PsVecMathSSE.h
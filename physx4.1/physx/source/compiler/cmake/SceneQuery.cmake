@@ -74,6 +74,10 @@ SET(SCENEQUERY_SOURCE
 	${SCENEQUERY_BASE_DIR}/src/SqPruningStructure.cpp
 	${SCENEQUERY_BASE_DIR}/src/SqSceneQueryManager.cpp
 	${SCENEQUERY_BASE_DIR}/src/SqTypedef.h
+	${SCENEQUERY_BASE_DIR}/src/SqWideAABBPruner.cpp
+	${SCENEQUERY_BASE_DIR}/src/SqWideAABBPruner.h
+	${SCENEQUERY_BASE_DIR}/src/SqWideAABBTree.cpp
+	${SCENEQUERY_BASE_DIR}/src/SqWideAABBTree.h
 )
 SOURCE_GROUP(src FILES ${SCENEQUERY_SOURCE})
 
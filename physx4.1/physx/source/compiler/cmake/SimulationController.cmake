@@ -106,6 +106,7 @@ SET(SIMULATIONCONTROLLER_SOURCE
 	${SIMULATIONCONTROLLER_BASE_DIR}/src/ScShapeSim.h
 	${SIMULATIONCONTROLLER_BASE_DIR}/src/ScSimStateData.h
 	${SIMULATIONCONTROLLER_BASE_DIR}/src/ScSimStats.cpp
+	${SIMULATIONCONTROLLER_BASE_DIR}/src/ScSimulationState.cpp
 	${SIMULATIONCONTROLLER_BASE_DIR}/src/ScSimStats.h
 	${SIMULATIONCONTROLLER_BASE_DIR}/src/ScSimulationController.cpp
 	${SIMULATIONCONTROLLER_BASE_DIR}/src/ScSimulationController.h
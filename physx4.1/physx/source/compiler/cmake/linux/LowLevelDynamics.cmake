@@ -49,5 +49,15 @@ SET(LOWLEVELDYNAMICS_COMPILE_DEFS
 	$<$<CONFIG:release>:${PHYSX_LINUX_RELEASE_COMPILE_DEFS};>
 )
 
+# Kernels compiled a second time with AVX2 + FMA, selected at runtime by the solver
+IF(NOT CMAKE_SYSTEM_PROCESSOR STREQUAL "aarch64")
+	SET(LOWLEVELDYNAMICS_AVX2_SOURCE
+		${PHYSX_SOURCE_DIR}/lowleveldynamics/src/DySolverConstraintsBlockAVX2.cpp
+		${PHYSX_SOURCE_DIR}/lowleveldynamics/src/DySolverConstraintsBlock8.cpp
+	)
+	# Optimized in every configuration, see DySolverAvx2.h
+	SET(LOWLEVELDYNAMICS_AVX2_FLAGS -mavx2 -mfma -O2)
+ENDIF()
+
 SET(LOWLEVELDYNAMICS_LIBTYPE OBJECT)
 
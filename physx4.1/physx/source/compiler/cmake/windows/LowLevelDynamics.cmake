@@ -54,6 +54,22 @@ SET(LOWLEVELDYNAMICS_COMPILE_DEFS
 	$<$<CONFIG:release>:${PHYSX_WINDOWS_RELEASE_COMPILE_DEFS};>
 )
 
+# Kernels compiled a second time with AVX2 + FMA, selected at runtime by the solver
+IF(CMAKE_SIZEOF_VOID_P EQUAL 8)
+	SET(LOWLEVELDYNAMICS_AVX2_SOURCE
+		${PHYSX_SOURCE_DIR}/lowleveldynamics/src/DySolverConstraintsBlockAVX2.cpp
+		${PHYSX_SOURCE_DIR}/lowleveldynamics/src/DySolverConstraintsBlock8.cpp
+	)
+	# Optimized with full inlining in every configuration that builds them, see DySolverAvx2.h. The /RTCu of the
+	# debug configuration can't be combined with /O2, so debug builds compile these files empty and run the SSE2 kernels.
+	SET(LOWLEVELDYNAMICS_AVX2_FLAGS
+		$<$<NOT:$<CONFIG:debug>>:/arch:AVX2>
+		$<$<NOT:$<CONFIG:debug>>:/O2>
+		$<$<NOT:$<CONFIG:debug>>:/Ob2>
+	)
+	SET(LOWLEVELDYNAMICS_AVX2_DEFS $<$<NOT:$<CONFIG:debug>>:PX_DY_AVX2_KERNELS=1>)
+ENDIF()
+
 IF(NV_USE_GAMEWORKS_OUTPUT_DIRS AND LOWLEVELDYNAMICS_LIBTYPE STREQUAL "STATIC")
 	SET(LLDYNAMICS_COMPILE_PDB_NAME_DEBUG "LowLevelDynamics_static${CMAKE_DEBUG_POSTFIX}")
 	SET(LLDYNAMICS_COMPILE_PDB_NAME_CHECKED "LowLevelDynamics_static${CMAKE_CHECKED_POSTFIX}")
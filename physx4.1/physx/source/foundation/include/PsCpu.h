@@ -40,6 +40,10 @@ class Cpu
 {
   public:
 	static uint8_t getCpuId();
+
+	// Returns true if the CPU implements AVX2 and FMA3 and the OS preserves the YMM registers,
+	// i.e. code compiled with -mavx2 -mfma (/arch:AVX2) can be executed safely.
+	static bool isAvx2FmaSupported();
 };
 }
 }
@@ -73,6 +73,26 @@
 #include <xmmintrin.h>
 #endif
 
+// Translation units compiled for AVX2 (see Cpu::isAvx2FmaSupported) fuse the multiply-add functions.
+// Everything else keeps the SSE2 baseline, so results of the two paths can differ in the last bit.
+#if COMPILE_VECTOR_INTRINSICS && PX_INTEL_FAMILY && (defined(__FMA__) || (PX_VC && defined(__AVX2__)))
+#include <immintrin.h>
+#define PX_FMA 1
+#else
+#define PX_FMA 0
+#endif
+
+// The aos functions of FMA translation units live in their own inline namespace. Their mangled names then differ
+// from the SSE2 copies, so the linker can never resolve an SSE2 caller to an out-of-line AVX2 instantiation.
+// The types stay in aos, shared by both builds.
+#if PX_FMA
+#define PX_AOS_ISA_NAMESPACE_BEGIN inline namespace fma {
+#define PX_AOS_ISA_NAMESPACE_END }
+#else
+#define PX_AOS_ISA_NAMESPACE_BEGIN
+#define PX_AOS_ISA_NAMESPACE_END
+#endif
+
 #if COMPILE_VECTOR_INTRINSICS
 #include "PsAoS.h"
 #else
@@ -85,6 +105,7 @@ namespace shdfnd
 {
 namespace aos
 {
+PX_AOS_ISA_NAMESPACE_BEGIN
 
 // Basic AoS types are
 // FloatV	- 16-byte aligned representation of float.
@@ -1329,6 +1350,7 @@ PX_FORCE_INLINE Vec3V V3LoadU_SafeReadW(const PxVec3& f)
 	return Vec3V_From_Vec4V(V4LoadU(&f.x));
 }
 
+PX_AOS_ISA_NAMESPACE_END
 } // namespace aos
 } // namespace shdfnd
 } // namespace physx
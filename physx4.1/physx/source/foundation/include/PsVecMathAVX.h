@@ -0,0 +1,269 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef PSFOUNDATION_PSVECMATHAVX_H
+#define PSFOUNDATION_PSVECMATHAVX_H
+
+// 8-wide float vectors for kernels that are compiled a second time with AVX2 + FMA code generation.
+// Only include this from translation units built with -mavx2 -mfma (/arch:AVX2), and only call into
+// such translation units after Cpu::isAvx2FmaSupported() returned true.
+
+#include "PsVecMath.h"
+
+#if !PX_FMA
+#error "PsVecMathAVX.h requires a translation unit compiled for AVX2 and FMA"
+#endif
+
+namespace physx
+{
+namespace shdfnd
+{
+namespace aos
+{
+PX_AOS_ISA_NAMESPACE_BEGIN
+
+typedef __m256 Vec8V;
+typedef __m256 BoolV8;
+
+//////////////////////////////////
+// Vec8V
+//////////////////////////////////
+
+PX_FORCE_INLINE Vec8V V8Zero()
+{
+	return _mm256_setzero_ps();
+}
+
+PX_FORCE_INLINE Vec8V V8One()
+{
+	return _mm256_set1_ps(1.0f);
+}
+
+PX_FORCE_INLINE Vec8V V8Load(const PxF32 f)
+{
+	return _mm256_set1_ps(f);
+}
+
+// Broadcast a FloatV to all 8 lanes.
+PX_FORCE_INLINE Vec8V V8Splat(const FloatV f)
+{
+	return _mm256_broadcastss_ps(f);
+}
+
+// 32-byte aligned load/store.
+PX_FORCE_INLINE Vec8V V8LoadA(const PxF32* const f)
+{
+	PX_ASSERT((size_t(f) & 31) == 0);
+	return _mm256_load_ps(f);
+}
+
+PX_FORCE_INLINE void V8StoreA(const Vec8V a, PxF32* f)
+{
+	PX_ASSERT((size_t(f) & 31) == 0);
+	_mm256_store_ps(f, a);
+}
+
+PX_FORCE_INLINE Vec8V V8LoadU(const PxF32* const f)
+{
+	return _mm256_loadu_ps(f);
+}
+
+PX_FORCE_INLINE void V8StoreU(const Vec8V a, PxF32* f)
+{
+	_mm256_storeu_ps(f, a);
+}
+
+// (lo.x, lo.y, lo.z, lo.w, hi.x, hi.y, hi.z, hi.w)
+PX_FORCE_INLINE Vec8V V8FromV4(const Vec4V lo, const Vec4V hi)
+{
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+PX_FORCE_INLINE Vec4V V8GetLow(const Vec8V a)
+{
+	return _mm256_castps256_ps128(a);
+}
+
+PX_FORCE_INLINE Vec4V V8GetHigh(const Vec8V a)
+{
+	return _mm256_extractf128_ps(a, 1);
+}
+
+PX_FORCE_INLINE Vec8V V8Add(const Vec8V a, const Vec8V b)
+{
+	return _mm256_add_ps(a, b);
+}
+
+PX_FORCE_INLINE Vec8V V8Sub(const Vec8V a, const Vec8V b)
+{
+	return _mm256_sub_ps(a, b);
+}
+
+PX_FORCE_INLINE Vec8V V8Mul(const Vec8V a, const Vec8V b)
+{
+	return _mm256_mul_ps(a, b);
+}
+
+PX_FORCE_INLINE Vec8V V8Neg(const Vec8V a)
+{
+	return _mm256_sub_ps(_mm256_setzero_ps(), a);
+}
+
+// a * b + c
+PX_FORCE_INLINE Vec8V V8MulAdd(const Vec8V a, const Vec8V b, const Vec8V c)
+{
+	return _mm256_fmadd_ps(a, b, c);
+}
+
+// c - a * b
+PX_FORCE_INLINE Vec8V V8NegMulSub(const Vec8V a, const Vec8V b, const Vec8V c)
+{
+	return _mm256_fnmadd_ps(a, b, c);
+}
+
+PX_FORCE_INLINE Vec8V V8Max(const Vec8V a, const Vec8V b)
+{
+	return _mm256_max_ps(a, b);
+}
+
+PX_FORCE_INLINE Vec8V V8Min(const Vec8V a, const Vec8V b)
+{
+	return _mm256_min_ps(a, b);
+}
+
+PX_FORCE_INLINE Vec8V V8Clamp(const Vec8V a, const Vec8V minV, const Vec8V maxV)
+{
+	return V8Max(V8Min(a, maxV), minV);
+}
+
+PX_FORCE_INLINE Vec8V V8Abs(const Vec8V a)
+{
+	return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a);
+}
+
+PX_FORCE_INLINE Vec8V V8Recip(const Vec8V a)
+{
+	return _mm256_div_ps(_mm256_set1_ps(1.0f), a);
+}
+
+// Estimate with 12 bits of precision refined by one Newton-Raphson step.
+PX_FORCE_INLINE Vec8V V8RecipFast(const Vec8V a)
+{
+	const Vec8V r = _mm256_rcp_ps(a);
+	return V8Mul(r, V8NegMulSub(a, r, _mm256_set1_ps(2.0f)));
+}
+
+PX_FORCE_INLINE Vec8V V8Sqrt(const Vec8V a)
+{
+	return _mm256_sqrt_ps(a);
+}
+
+PX_FORCE_INLINE Vec8V V8Rsqrt(const Vec8V a)
+{
+	return _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(a));
+}
+
+// Horizontal sum of all 8 lanes.
+PX_FORCE_INLINE FloatV V8SumElements(const Vec8V a)
+{
+	const __m128 s = _mm_add_ps(V8GetLow(a), V8GetHigh(a));
+	const __m128 t = _mm_add_ps(s, _mm_movehl_ps(s, s));
+	const __m128 u = _mm_add_ss(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1)));
+	return _mm_shuffle_ps(u, u, _MM_SHUFFLE(0, 0, 0, 0));
+}
+
+//////////////////////////////////
+// BoolV8
+//////////////////////////////////
+
+PX_FORCE_INLINE BoolV8 BV8False()
+{
+	return _mm256_setzero_ps();
+}
+
+// 32-byte aligned store of the lane masks (0 or 0xffffffff).
+PX_FORCE_INLINE void BV8StoreA(const BoolV8 a, PxU32* u)
+{
+	PX_ASSERT((size_t(u) & 31) == 0);
+	_mm256_store_ps(reinterpret_cast<PxF32*>(u), a);
+}
+
+PX_FORCE_INLINE BoolV8 V8IsGrtr(const Vec8V a, const Vec8V b)
+{
+	return _mm256_cmp_ps(a, b, _CMP_GT_OQ);
+}
+
+PX_FORCE_INLINE BoolV8 V8IsGrtrOrEq(const Vec8V a, const Vec8V b)
+{
+	return _mm256_cmp_ps(a, b, _CMP_GE_OQ);
+}
+
+PX_FORCE_INLINE BoolV8 V8IsEq(const Vec8V a, const Vec8V b)
+{
+	return _mm256_cmp_ps(a, b, _CMP_EQ_OQ);
+}
+
+// c ? a : b, per lane
+PX_FORCE_INLINE Vec8V V8Sel(const BoolV8 c, const Vec8V a, const Vec8V b)
+{
+	return _mm256_blendv_ps(b, a, c);
+}
+
+PX_FORCE_INLINE BoolV8 BV8And(const BoolV8 a, const BoolV8 b)
+{
+	return _mm256_and_ps(a, b);
+}
+
+PX_FORCE_INLINE BoolV8 BV8Or(const BoolV8 a, const BoolV8 b)
+{
+	return _mm256_or_ps(a, b);
+}
+
+// One bit per lane, lane 0 in bit 0.
+PX_FORCE_INLINE PxU32 BV8GetMask(const BoolV8 a)
+{
+	return PxU32(_mm256_movemask_ps(a));
+}
+
+PX_FORCE_INLINE bool BV8AnyTrue(const BoolV8 a)
+{
+	return _mm256_movemask_ps(a) != 0;
+}
+
+PX_FORCE_INLINE bool BV8AllTrue(const BoolV8 a)
+{
+	return _mm256_movemask_ps(a) == 0xff;
+}
+
+PX_AOS_ISA_NAMESPACE_END
+} // namespace aos
+} // namespace shdfnd
+} // namespace physx
+
+#endif // PSFOUNDATION_PSVECMATHAVX_H
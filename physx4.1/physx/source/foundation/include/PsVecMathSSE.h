@@ -36,6 +36,7 @@ namespace shdfnd
 {
 namespace aos
 {
+PX_AOS_ISA_NAMESPACE_BEGIN
 
 namespace
 {
@@ -59,6 +60,7 @@ PX_FORCE_INLINE void QuatGetMat33V(const QuatVArg q, Vec3V& column0, Vec3V& colu
     column2 = V4MulAdd(v, V4GetZ(q2), _mm_shuffle_ps(a2, a2, _MM_SHUFFLE(3, 0, 2, 1)));
 }
 
+PX_AOS_ISA_NAMESPACE_END
 } // namespace aos
 } // namespace shdfnd
 } // namespace physx
@@ -38,6 +38,7 @@ namespace shdfnd
 {
 namespace aos
 {
+PX_AOS_ISA_NAMESPACE_BEGIN
 /*!
     Extend an edge along its length by a factor
     */
@@ -50,6 +51,7 @@ PX_FORCE_INLINE void makeFatEdge(Vec3V& p0, Vec3V& p1, const FloatVArg fatCoeff)
 	p0 = V3Sel(con, V3Sub(p0, fatDelta), p0);
 	p1 = V3Sel(con, V3Add(p1, fatDelta), p1);
 }
+PX_AOS_ISA_NAMESPACE_END
 }
 }
 }
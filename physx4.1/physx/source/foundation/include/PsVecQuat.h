@@ -38,6 +38,7 @@ namespace shdfnd
 {
 namespace aos
 {
+PX_AOS_ISA_NAMESPACE_BEGIN
 
 #ifndef PX_PIDIV2
 #define PX_PIDIV2 1.570796327f
@@ -459,6 +460,7 @@ PX_FORCE_INLINE QuatV Mat33GetQuatV(const Mat33V& a)
 	}
 }
 
+PX_AOS_ISA_NAMESPACE_END
 } // namespace aos
 } // namespace shdfnd
 } // namespace physx
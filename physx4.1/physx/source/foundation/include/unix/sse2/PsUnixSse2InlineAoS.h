@@ -46,6 +46,7 @@ namespace shdfnd
 {
 namespace aos
 {
+PX_AOS_ISA_NAMESPACE_BEGIN
 
 #define PX_FPCLASS_SNAN 0x0001 /* signaling NaN */
 #define PX_FPCLASS_QNAN 0x0002 /* quiet NaN */
@@ -677,7 +678,11 @@ PX_FORCE_INLINE FloatV FScaleAdd(const FloatV a, const FloatV b, const FloatV c)
 	ASSERT_ISVALIDFLOATV(a);
 	ASSERT_ISVALIDFLOATV(b);
 	ASSERT_ISVALIDFLOATV(c);
+#if PX_FMA
+	return _mm_fmadd_ps(a, b, c);
+#else
 	return FAdd(FMul(a, b), c);
+#endif
 }
 
 PX_FORCE_INLINE FloatV FNegScaleSub(const FloatV a, const FloatV b, const FloatV c)
@@ -685,7 +690,11 @@ PX_FORCE_INLINE FloatV FNegScaleSub(const FloatV a, const FloatV b, const FloatV
 	ASSERT_ISVALIDFLOATV(a);
 	ASSERT_ISVALIDFLOATV(b);
 	ASSERT_ISVALIDFLOATV(c);
+#if PX_FMA
+	return _mm_fnmadd_ps(a, b, c);
+#else
 	return FSub(c, FMul(a, b));
+#endif
 }
 
 PX_FORCE_INLINE FloatV FAbs(const FloatV a)
@@ -1157,7 +1166,11 @@ PX_FORCE_INLINE Vec3V V3ScaleAdd(const Vec3V a, const FloatV b, const Vec3V c)
 	ASSERT_ISVALIDVEC3V(a);
 	ASSERT_ISVALIDFLOATV(b);
 	ASSERT_ISVALIDVEC3V(c);
+#if PX_FMA
+	return _mm_fmadd_ps(a, b, c);
+#else
 	return V3Add(V3Scale(a, b), c);
+#endif
 }
 
 PX_FORCE_INLINE Vec3V V3NegScaleSub(const Vec3V a, const FloatV b, const Vec3V c)
@@ -1165,7 +1178,11 @@ PX_FORCE_INLINE Vec3V V3NegScaleSub(const Vec3V a, const FloatV b, const Vec3V c
 	ASSERT_ISVALIDVEC3V(a);
 	ASSERT_ISVALIDFLOATV(b);
 	ASSERT_ISVALIDVEC3V(c);
+#if PX_FMA
+	return _mm_fnmadd_ps(a, b, c);
+#else
 	return V3Sub(c, V3Scale(a, b));
+#endif
 }
 
 PX_FORCE_INLINE Vec3V V3MulAdd(const Vec3V a, const Vec3V b, const Vec3V c)
@@ -1173,7 +1190,11 @@ PX_FORCE_INLINE Vec3V V3MulAdd(const Vec3V a, const Vec3V b, const Vec3V c)
 	ASSERT_ISVALIDVEC3V(a);
 	ASSERT_ISVALIDVEC3V(b);
 	ASSERT_ISVALIDVEC3V(c);
+#if PX_FMA
+	return _mm_fmadd_ps(a, b, c);
+#else
 	return V3Add(V3Mul(a, b), c);
+#endif
 }
 
 PX_FORCE_INLINE Vec3V V3NegMulSub(const Vec3V a, const Vec3V b, const Vec3V c)
@@ -1181,7 +1202,11 @@ PX_FORCE_INLINE Vec3V V3NegMulSub(const Vec3V a, const Vec3V b, const Vec3V c)
 	ASSERT_ISVALIDVEC3V(a);
 	ASSERT_ISVALIDVEC3V(b);
 	ASSERT_ISVALIDVEC3V(c);
+#if PX_FMA
+	return _mm_fnmadd_ps(a, b, c);
+#else
 	return V3Sub(c, V3Mul(a, b));
+#endif
 }
 
 PX_FORCE_INLINE Vec3V V3Abs(const Vec3V a)
@@ -1913,23 +1938,39 @@ PX_FORCE_INLINE Vec4V V4Sqrt(const Vec4V a)
 PX_FORCE_INLINE Vec4V V4ScaleAdd(const Vec4V a, const FloatV b, const Vec4V c)
 {
 	ASSERT_ISVALIDFLOATV(b);
+#if PX_FMA
+	return _mm_fmadd_ps(a, b, c);
+#else
 	return V4Add(V4Scale(a, b), c);
+#endif
 }
 
 PX_FORCE_INLINE Vec4V V4NegScaleSub(const Vec4V a, const FloatV b, const Vec4V c)
 {
 	ASSERT_ISVALIDFLOATV(b);
+#if PX_FMA
+	return _mm_fnmadd_ps(a, b, c);
+#else
 	return V4Sub(c, V4Scale(a, b));
+#endif
 }
 
 PX_FORCE_INLINE Vec4V V4MulAdd(const Vec4V a, const Vec4V b, const Vec4V c)
 {
+#if PX_FMA
+	return _mm_fmadd_ps(a, b, c);
+#else
 	return V4Add(V4Mul(a, b), c);
+#endif
 }
 
 PX_FORCE_INLINE Vec4V V4NegMulSub(const Vec4V a, const Vec4V b, const Vec4V c)
 {
+#if PX_FMA
+	return _mm_fnmadd_ps(a, b, c);
+#else
 	return V4Sub(c, V4Mul(a, b));
+#endif
 }
 
 PX_FORCE_INLINE Vec4V V4Abs(const Vec4V a)
@@ -3232,6 +3273,7 @@ PX_FORCE_INLINE VecU32V V4ConvertToU32VSaturate(const Vec4V in, PxU32 power)
 	return result;
 }
 
+PX_AOS_ISA_NAMESPACE_END
 } // namespace aos
 } // namespace shdfnd
 } // namespace physx
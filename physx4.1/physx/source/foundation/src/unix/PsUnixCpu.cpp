@@ -43,6 +43,13 @@
 #define cpuid(op, reg) reg[0] = reg[1] = reg[2] = reg[3] = 0;
 #endif
 
+#if(PX_X86 || PX_X64) && !defined(__EMSCRIPTEN__)
+#include <cpuid.h>
+#define PS_CPU_HAS_CPUID 1
+#else
+#define PS_CPU_HAS_CPUID 0
+#endif
+
 namespace physx
 {
 namespace shdfnd
@@ -54,5 +61,31 @@ uint8_t Cpu::getCpuId()
 	cpuid(1, cpuInfo);
 	return static_cast<uint8_t>(cpuInfo[1] >> 24); // APIC Physical ID
 }
+
+bool Cpu::isAvx2FmaSupported()
+{
+#if PS_CPU_HAS_CPUID
+	unsigned int eax, ebx, ecx, edx;
+	if(__get_cpuid_max(0, NULL) < 7)
+		return false;
+
+	__cpuid_count(1, 0, eax, ebx, ecx, edx);
+	const unsigned int fma = 1 << 12, osxsave = 1 << 27, avx = 1 << 28;
+	if((ecx & (fma | osxsave | avx)) != (fma | osxsave | avx))
+		return false;
+
+	// XCR0 bits 1 and 2: the OS saves SSE and AVX state on context switches
+	unsigned int xcr0Lo, xcr0Hi;
+	__asm__ __volatile__("xgetbv" : "=a"(xcr0Lo), "=d"(xcr0Hi) : "c"(0));
+	PX_UNUSED(xcr0Hi);
+	if((xcr0Lo & 6) != 6)
+		return false;
+
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+	return (ebx & (1 << 5)) != 0; // AVX2
+#else
+	return false;
+#endif
+}
 }
 }
@@ -51,6 +51,11 @@ uint8_t Cpu::getCpuId()
 	cpuid(cpuInfo);
 	return static_cast<uint8_t>(cpuInfo[1] >> 24); // APIC Physical ID
 }
+
+bool Cpu::isAvx2FmaSupported()
+{
+	return false;
+}
 #else
 uint8_t Cpu::getCpuId()
 {
@@ -59,6 +64,26 @@ uint8_t Cpu::getCpuId()
 	__cpuid(CPUInfo, InfoType);
 	return static_cast<uint8_t>(CPUInfo[1] >> 24); // APIC Physical ID
 }
+
+bool Cpu::isAvx2FmaSupported()
+{
+	int CPUInfo[4];
+	__cpuid(CPUInfo, 0);
+	if(CPUInfo[0] < 7)
+		return false;
+
+	__cpuid(CPUInfo, 1);
+	const int fma = 1 << 12, osxsave = 1 << 27, avx = 1 << 28;
+	if((CPUInfo[2] & (fma | osxsave | avx)) != (fma | osxsave | avx))
+		return false;
+
+	// XCR0 bits 1 and 2: the OS saves SSE and AVX state on context switches
+	if((_xgetbv(0) & 6) != 6)
+		return false;
+
+	__cpuidex(CPUInfo, 7, 0);
+	return (CPUInfo[1] & (1 << 5)) != 0; // AVX2
+}
 #endif
 }
 }
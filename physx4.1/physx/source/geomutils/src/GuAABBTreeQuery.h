@@ -33,6 +33,7 @@
 
 #include "GuBVHTestsSIMD.h"
 #include "PsInlineArray.h"
+#include "PsBitUtils.h"
 
 namespace physx
 {
@@ -233,6 +234,354 @@ namespace physx
 				return true;
 			}
 		};
+
+		//////////////////////////////////////////////////////////////////////////
+
+		// PT: raycasts a packet of up to GU_RAY_PACKET_MAX_SIZE rays at once. Each ray uses its own max distance. A node is
+		// visited once for all the rays that touch it, and each ray sees the same boxes as in AABBTreeRaycast. An object is
+		// passed once to the packet callback's invokePacket() for all the rays that touch it. The returned mask contains the
+		// input rays whose callback didn't stop the query.
+		template <typename Tree, typename Node, typename Payload, typename QueryCallback>
+		class AABBTreeRaycastPacket
+		{
+			struct StackEntry
+			{
+				const Node*	mNode;
+				PxU32		mRayMask;
+			};
+
+		public:
+			PxU32 operator()(
+				const Payload* objects, const PxBounds3* boxes, const Tree& tree,
+				PxU32 nbRays, const PxVec3* origins, const PxVec3* unitDirs, PxReal* maxDists, PxU32 activeRays,
+				QueryCallback& pcb)
+			{
+				PX_ASSERT(nbRays<=GU_RAY_PACKET_MAX_SIZE);
+
+				// PT: same as in AABBTreeRaycast, we pass center*2 and extents*2 to the ray-box code
+				PxVec3 origins2[GU_RAY_PACKET_MAX_SIZE];
+				PxVec3 unitDirs2[GU_RAY_PACKET_MAX_SIZE];
+				PxVec3 sumDirs(0.0f);
+				for(PxU32 i=0; i<nbRays; i++)
+				{
+					origins2[i] = origins[i]*2.0f;
+					unitDirs2[i] = unitDirs[i]*2.0f;
+					sumDirs += unitDirs[i];
+				}
+				RayPacketAABBTest test(nbRays, origins2, unitDirs2, maxDists);
+				const Vec3V packetDir = V3LoadU(sumDirs);
+
+				Ps::InlineArray<StackEntry, RAW_TRAVERSAL_STACK_SIZE> stack;
+				stack.forceSize_Unsafe(RAW_TRAVERSAL_STACK_SIZE);
+				const Node* const nodeBase = tree.getNodes();
+				stack[0].mNode = nodeBase;
+				stack[0].mRayMask = activeRays;
+				PxU32 stackIndex = 1;
+
+				while(stackIndex-- && activeRays)
+				{
+					const Node* node = stack[stackIndex].mNode;
+					Vec3V center, extents;
+					node->getAABBCenterExtentsV2(&center, &extents);
+					PxU32 rayMask = test.check(center, extents, stack[stackIndex].mRayMask & activeRays);
+					if(!rayMask)
+						continue;
+
+					while(!node->isLeaf())
+					{
+						const Node* children = node->getPos(nodeBase);
+
+						Vec3V c0, e0;
+						children[0].getAABBCenterExtentsV2(&c0, &e0);
+						const PxU32 mask0 = test.check(c0, e0, rayMask);
+
+						Vec3V c1, e1;
+						children[1].getAABBCenterExtentsV2(&c1, &e1);
+						const PxU32 mask1 = test.check(c1, e1, rayMask);
+
+						if(mask0 && mask1)	// if both intersect, push the one with the further center along the packet's direction
+						{
+							// & 1 because FAllGrtr behavior differs across platforms
+							const PxU32 bit = FAllGrtr(V3Dot(V3Sub(c1, c0), packetDir), FZero()) & 1;
+							stack[stackIndex].mNode = children + bit;
+							stack[stackIndex].mRayMask = bit ? mask1 : mask0;
+							stackIndex++;
+							node = children + (1 - bit);
+							rayMask = bit ? mask0 : mask1;
+							if(stackIndex == stack.capacity())
+								stack.resizeUninitialized(stack.capacity() * 2);
+						}
+						else if(mask0)
+						{
+							node = children;
+							rayMask = mask0;
+						}
+						else if(mask1)
+						{
+							node = children + 1;
+							rayMask = mask1;
+						}
+						else
+							goto skip_leaf_code;
+					}
+
+					{
+						PxU32 nbPrims = node->getNbPrimitives();
+						const bool doBoxTest = nbPrims > 1;
+						const PxU32* prims = node->getPrimitives(tree.getIndices());
+						while(nbPrims--)
+						{
+							const PxU32 poolIndex = *prims++;
+
+							PxU32 primRayMask = rayMask & activeRays;
+							if(doBoxTest)
+							{
+								Vec4V center_, extents_;
+								getBoundsTimesTwo(center_, extents_, boxes, poolIndex);
+								primRayMask = test.check(Vec3V_From_Vec4V(center_), Vec3V_From_Vec4V(extents_), primRayMask);
+							}
+
+							if(!primRayMask)
+								continue;
+
+							// PT: the callback only shrinks the distances of the rays that keep going
+							PxReal md[GU_RAY_PACKET_MAX_SIZE];
+							for(PxU32 mask=primRayMask; mask; mask &= mask - 1)
+							{
+								const PxU32 i = Ps::lowestSetBit(mask);
+								md[i] = maxDists[i];
+							}
+
+							const PxU32 againRays = pcb.invokePacket(primRayMask, md, objects[poolIndex]);
+							activeRays &= ~(primRayMask & ~againRays);
+
+							for(PxU32 mask=primRayMask & againRays; mask; mask &= mask - 1)
+							{
+								const PxU32 i = Ps::lowestSetBit(mask);
+								if(md[i] < maxDists[i])
+								{
+									maxDists[i] = md[i];
+									test.setDistance(i, md[i]);
+								}
+							}
+						}
+					}
+				skip_leaf_code:;
+				}
+				return activeRays;
+			}
+		};
+
+		//////////////////////////////////////////////////////////////////////////
+
+		// PT: best-first traversal for closest-object queries. Nodes are visited by increasing distance to the query point
+		// (using a binary heap as a priority queue), and the traversal ends as soon as the closest remaining node is farther
+		// than the search distance. The callback is called for each object whose box is within the search distance, and can
+		// shrink it when it finds closer objects (e.g. to the distance of the k-th closest object found so far).
+		template <typename Tree, typename Node, typename Payload, typename QueryCallback>
+		class AABBTreeClosest
+		{
+			struct HeapEntry
+			{
+				PxReal		mSqDist;	// squared distance from the query point to the node's box
+				const Node*	mNode;
+			};
+
+			typedef Ps::InlineArray<HeapEntry, RAW_TRAVERSAL_STACK_SIZE> Heap;
+
+			static PX_FORCE_INLINE PxReal pointNodeSquareDistance(const Vec3V point, const Node* node)
+			{
+				Vec3V center, extents;
+				node->getAABBCenterExtentsV(&center, &extents);
+				const Vec3V d = V3Max(V3Sub(V3Abs(V3Sub(point, center)), extents), V3Zero());
+				PxReal sqDist;
+				FStore(V3Dot(d, d), &sqDist);
+				return sqDist;
+			}
+
+			static PX_FORCE_INLINE PxReal pointBoxSquareDistance(const PxVec3& point, const PxBounds3& box)
+			{
+				const PxVec3 d = (box.minimum - point).maximum(point - box.maximum).maximum(PxVec3(0.0f));
+				return d.magnitudeSquared();
+			}
+
+			static void push(Heap& heap, const HeapEntry& entry)
+			{
+				PxU32 i = heap.size();
+				heap.pushBack(entry);
+				while(i)
+				{
+					const PxU32 parent = (i-1)>>1;
+					if(heap[parent].mSqDist <= entry.mSqDist)
+						break;
+					heap[i] = heap[parent];
+					i = parent;
+				}
+				heap[i] = entry;
+			}
+
+			static HeapEntry pop(Heap& heap)
+			{
+				const HeapEntry top = heap[0];
+				const HeapEntry last = heap.popBack();
+				const PxU32 size = heap.size();
+				if(size)
+				{
+					PxU32 i = 0;
+					for(;;)
+					{
+						PxU32 child = i*2+1;
+						if(child>=size)
+							break;
+						if(child+1<size && heap[child+1].mSqDist < heap[child].mSqDist)
+							child++;
+						if(last.mSqDist <= heap[child].mSqDist)
+							break;
+						heap[i] = heap[child];
+						i = child;
+					}
+					heap[i] = last;
+				}
+				return top;
+			}
+
+		public:
+			bool operator()(const Payload* objects, const PxBounds3* boxes, const Tree& tree, const PxVec3& point, PxReal& inOutDistance, QueryCallback& pcb)
+			{
+				const Vec3V pointV = V3LoadU(point);
+				const Node* const nodeBase = tree.getNodes();
+				if(!nodeBase)
+					return true;
+
+				Heap heap;
+				HeapEntry root;
+				root.mSqDist = pointNodeSquareDistance(pointV, nodeBase);
+				root.mNode = nodeBase;
+				push(heap, root);
+
+				while(heap.size())
+				{
+					const HeapEntry entry = pop(heap);
+					// PT: the heap gives nodes by increasing distance, so all the remaining nodes are out of range as well
+					if(entry.mSqDist > inOutDistance*inOutDistance)
+						break;
+
+					const Node* node = entry.mNode;
+					if(node->isLeaf())
+					{
+						PxU32 nbPrims = node->getNbPrimitives();
+						const PxU32* prims = node->getPrimitives(tree.getIndices());
+						while(nbPrims--)
+						{
+							const PxU32 primIndex = *prims++;
+							if(pointBoxSquareDistance(point, boxes[primIndex]) > inOutDistance*inOutDistance)
+								continue;
+
+							PxReal md = inOutDistance; // pass md to callback, shrunk by the callback when it finds closer objects
+							if(!pcb.invoke(md, objects[primIndex]))
+								return false;
+
+							if(md < inOutDistance)
+								inOutDistance = md;
+						}
+						continue;
+					}
+
+					const Node* children = node->getPos(nodeBase);
+					for(PxU32 i=0; i<2; i++)
+					{
+						HeapEntry childEntry;
+						childEntry.mSqDist = pointNodeSquareDistance(pointV, children + i);
+						childEntry.mNode = children + i;
+						if(childEntry.mSqDist <= inOutDistance*inOutDistance)
+							push(heap, childEntry);
+					}
+				}
+				return true;
+			}
+		};
+
+		//////////////////////////////////////////////////////////////////////////
+
+		// PT: culling against a convex set of planes. Each stack entry carries the planes its parent still crosses, so only
+		// these are tested against the node. Once a node is fully inside all the planes its mask becomes zero and the whole
+		// subtree is reported without any further box test. The callback receives each visible object along with a flag telling
+		// whether its box is fully inside the plane set or crosses at least one plane.
+		template <typename Tree, typename Node, typename Payload, typename QueryCallback>
+		class AABBTreeCull
+		{
+			struct StackEntry
+			{
+				const Node*	mNode;
+				PxU32		mPlaneMask;
+			};
+
+		public:
+			bool operator()(const Payload* objects, const PxBounds3* boxes, const Tree& tree, const PlanesAABBTest& test, PxU32 planeMask, QueryCallback& pcb)
+			{
+				const Node* const nodeBase = tree.getNodes();
+				if(!nodeBase)
+					return true;
+
+				Ps::InlineArray<StackEntry, RAW_TRAVERSAL_STACK_SIZE> stack;
+				stack.forceSize_Unsafe(RAW_TRAVERSAL_STACK_SIZE);
+				stack[0].mNode = nodeBase;
+				stack[0].mPlaneMask = planeMask;
+				PxU32 stackIndex = 1;
+
+				while(stackIndex--)
+				{
+					const Node* node = stack[stackIndex].mNode;
+					PxU32 mask = stack[stackIndex].mPlaneMask;
+					if(mask)
+					{
+						Vec3V center, extents;
+						node->getAABBCenterExtentsV(&center, &extents);
+						if(!test.classify(center, extents, mask))
+							continue;
+					}
+
+					if(node->isLeaf())
+					{
+						PxU32 nbPrims = node->getNbPrimitives();
+						const PxU32* prims = node->getPrimitives(tree.getIndices());
+						while(nbPrims--)
+						{
+							const PxU32 poolIndex = *prims++;
+
+							PxU32 primMask = mask;
+							if(primMask)
+							{
+								Vec4V center2, extents2;
+								getBoundsTimesTwo(center2, extents2, boxes, poolIndex);
+
+								const FloatV halfV = FLoad(0.5f);
+								const Vec4V extents_ = V4Scale(extents2, halfV);
+								const Vec4V center_ = V4Scale(center2, halfV);
+
+								if(!test.classify(Vec3V_From_Vec4V(center_), Vec3V_From_Vec4V(extents_), primMask))
+									continue;
+							}
+
+							if(!pcb.invoke(objects[poolIndex], primMask==0))
+								return false;
+						}
+						continue;
+					}
+
+					const Node* children = node->getPos(nodeBase);
+					stack[stackIndex].mNode = children + 1;
+					stack[stackIndex].mPlaneMask = mask;
+					stackIndex++;
+					stack[stackIndex].mNode = children;
+					stack[stackIndex].mPlaneMask = mask;
+					stackIndex++;
+					if(stackIndex + 1 >= stack.capacity())
+						stack.resizeUninitialized(stack.capacity() * 2);
+				}
+				return true;
+			}
+		};
 	}
 }
 
@@ -33,6 +33,7 @@
 
 #include "foundation/PxTransform.h"
 #include "foundation/PxBounds3.h"
+#include "foundation/PxPlane.h"
 #include "geometry/PxBoxGeometry.h"
 #include "geometry/PxSphereGeometry.h"
 #include "geometry/PxCapsuleGeometry.h"
@@ -43,6 +44,7 @@ namespace physx
 {
 namespace Gu
 {
+	using namespace shdfnd::aos;
 
 struct RayAABBTest
 {
@@ -101,6 +103,214 @@ protected:
 	RayAABBTest& operator=(const RayAABBTest&);
 };
 
+#define GU_RAY_PACKET_MAX_SIZE	16
+
+// PT: SoA version of RayAABBTest (without inflation) for packets of up to 16 rays. Each box is tested against 4 rays at a
+// time. The operations are the same as in RayAABBTest, so a ray in a packet passes exactly the same boxes as when tested alone.
+struct RayPacketAABBTest
+{
+	RayPacketAABBTest(PxU32 nbRays, const PxVec3* origins, const PxVec3* unitDirs, const PxReal* maxDists) : mNbGroups((nbRays+3)>>2)
+	{
+		PX_ASSERT(nbRays && nbRays<=GU_RAY_PACKET_MAX_SIZE);
+		for(PxU32 i=0; i<mNbGroups*4; i++)
+		{
+			// PT: unused lanes are zeroed and never reported, since they are not part of the ray masks
+			const PxVec3 origin = i<nbRays ? origins[i] : PxVec3(0.0f);
+			const PxVec3 unitDir = i<nbRays ? unitDirs[i] : PxVec3(0.0f);
+			const PxReal maxDist = i<nbRays ? maxDists[i] : 0.0f;
+
+			mOriginX[i] = origin.x;		mOriginY[i] = origin.y;		mOriginZ[i] = origin.z;
+			mDirX[i] = unitDir.x;		mDirY[i] = unitDir.y;		mDirZ[i] = unitDir.z;
+			mAbsDirX[i] = PxAbs(unitDir.x);	mAbsDirY[i] = PxAbs(unitDir.y);	mAbsDirZ[i] = PxAbs(unitDir.z);
+
+			const PxVec3 ext = maxDist >= PX_MAX_F32 ? PxVec3(	unitDir.x == 0 ? origin.x : PxSign(unitDir.x)*PX_MAX_F32,
+																unitDir.y == 0 ? origin.y : PxSign(unitDir.y)*PX_MAX_F32,
+																unitDir.z == 0 ? origin.z : PxSign(unitDir.z)*PX_MAX_F32)
+											   : origin + unitDir * maxDist;
+			setRayExtent(i, ext);
+		}
+	}
+
+	PX_FORCE_INLINE void setDistance(PxU32 i, PxReal distance)
+	{
+		// PT: same as RayAABBTest::setDistance()
+		setRayExtent(i, PxVec3(mDirX[i]*distance + mOriginX[i], mDirY[i]*distance + mOriginY[i], mDirZ[i]*distance + mOriginZ[i]));
+	}
+
+	// PT: returns the subset of rayMask whose rays overlap the box
+	PX_FORCE_INLINE PxU32 check(const Vec3V center, const Vec3V extents, PxU32 rayMask) const
+	{
+		const Vec4V center4 = Vec4V_From_Vec3V(center);
+		const Vec4V extents4 = Vec4V_From_Vec3V(extents);
+		const Vec4V cx = V4SplatElement<0>(center4);
+		const Vec4V cy = V4SplatElement<1>(center4);
+		const Vec4V cz = V4SplatElement<2>(center4);
+		const Vec4V ex = V4SplatElement<0>(extents4);
+		const Vec4V ey = V4SplatElement<1>(extents4);
+		const Vec4V ez = V4SplatElement<2>(extents4);
+
+		// coordinate axes
+		const Vec4V nodeMaxX = V4Add(cx, ex);
+		const Vec4V nodeMaxY = V4Add(cy, ey);
+		const Vec4V nodeMaxZ = V4Add(cz, ez);
+		const Vec4V nodeMinX = V4Sub(cx, ex);
+		const Vec4V nodeMinY = V4Sub(cy, ey);
+		const Vec4V nodeMinZ = V4Sub(cz, ez);
+
+		PxU32 result = 0;
+		for(PxU32 g=0; g<mNbGroups; g++)
+		{
+			const PxU32 offset4 = g*4;
+			if(!((rayMask>>offset4)&15))
+				continue;
+
+			const BoolV maskA = BAnd(BAnd(	V4IsGrtrOrEq(nodeMaxX, V4LoadA(mRayMinX + offset4)),
+											V4IsGrtrOrEq(nodeMaxY, V4LoadA(mRayMinY + offset4))),
+											V4IsGrtrOrEq(nodeMaxZ, V4LoadA(mRayMinZ + offset4)));
+			const BoolV maskB = BAnd(BAnd(	V4IsGrtrOrEq(V4LoadA(mRayMaxX + offset4), nodeMinX),
+											V4IsGrtrOrEq(V4LoadA(mRayMaxY + offset4), nodeMinY)),
+											V4IsGrtrOrEq(V4LoadA(mRayMaxZ + offset4), nodeMinZ));
+
+			// cross axes
+			const Vec4V dirX = V4LoadA(mDirX + offset4);
+			const Vec4V dirY = V4LoadA(mDirY + offset4);
+			const Vec4V dirZ = V4LoadA(mDirZ + offset4);
+			const Vec4V absDirX = V4LoadA(mAbsDirX + offset4);
+			const Vec4V absDirY = V4LoadA(mAbsDirY + offset4);
+			const Vec4V absDirZ = V4LoadA(mAbsDirZ + offset4);
+			const Vec4V offsetX = V4Sub(V4LoadA(mOriginX + offset4), cx);
+			const Vec4V offsetY = V4Sub(V4LoadA(mOriginY + offset4), cy);
+			const Vec4V offsetZ = V4Sub(V4LoadA(mOriginZ + offset4), cz);
+
+			const Vec4V fx = V4NegMulSub(dirY, offsetX, V4Mul(dirX, offsetY));
+			const Vec4V fy = V4NegMulSub(dirZ, offsetY, V4Mul(dirY, offsetZ));
+			const Vec4V fz = V4NegMulSub(dirX, offsetZ, V4Mul(dirZ, offsetX));
+			const Vec4V gx = V4MulAdd(ex, absDirY, V4Mul(ey, absDirX));
+			const Vec4V gy = V4MulAdd(ey, absDirZ, V4Mul(ez, absDirY));
+			const Vec4V gz = V4MulAdd(ez, absDirX, V4Mul(ex, absDirZ));
+			const BoolV maskC = BAnd(BAnd(V4IsGrtrOrEq(gx, V4Abs(fx)), V4IsGrtrOrEq(gy, V4Abs(fy))), V4IsGrtrOrEq(gz, V4Abs(fz)));
+
+			result |= BGetBitMask(BAnd(BAnd(maskA, maskB), maskC))<<offset4;
+		}
+		return result & rayMask;
+	}
+
+	PX_ALIGN(16, PxReal)	mOriginX[GU_RAY_PACKET_MAX_SIZE];
+	PX_ALIGN(16, PxReal)	mOriginY[GU_RAY_PACKET_MAX_SIZE];
+	PX_ALIGN(16, PxReal)	mOriginZ[GU_RAY_PACKET_MAX_SIZE];
+	PX_ALIGN(16, PxReal)	mDirX[GU_RAY_PACKET_MAX_SIZE];
+	PX_ALIGN(16, PxReal)	mDirY[GU_RAY_PACKET_MAX_SIZE];
+	PX_ALIGN(16, PxReal)	mDirZ[GU_RAY_PACKET_MAX_SIZE];
+	PX_ALIGN(16, PxReal)	mAbsDirX[GU_RAY_PACKET_MAX_SIZE];
+	PX_ALIGN(16, PxReal)	mAbsDirY[GU_RAY_PACKET_MAX_SIZE];
+	PX_ALIGN(16, PxReal)	mAbsDirZ[GU_RAY_PACKET_MAX_SIZE];
+	PX_ALIGN(16, PxReal)	mRayMinX[GU_RAY_PACKET_MAX_SIZE];
+	PX_ALIGN(16, PxReal)	mRayMinY[GU_RAY_PACKET_MAX_SIZE];
+	PX_ALIGN(16, PxReal)	mRayMinZ[GU_RAY_PACKET_MAX_SIZE];
+	PX_ALIGN(16, PxReal)	mRayMaxX[GU_RAY_PACKET_MAX_SIZE];
+	PX_ALIGN(16, PxReal)	mRayMaxY[GU_RAY_PACKET_MAX_SIZE];
+	PX_ALIGN(16, PxReal)	mRayMaxZ[GU_RAY_PACKET_MAX_SIZE];
+	const PxU32				mNbGroups;
+
+private:
+	PX_FORCE_INLINE void setRayExtent(PxU32 i, const PxVec3& ext)
+	{
+		mRayMinX[i] = PxMin(mOriginX[i], ext.x);	mRayMaxX[i] = PxMax(mOriginX[i], ext.x);
+		mRayMinY[i] = PxMin(mOriginY[i], ext.y);	mRayMaxY[i] = PxMax(mOriginY[i], ext.y);
+		mRayMinZ[i] = PxMin(mOriginZ[i], ext.z);	mRayMaxZ[i] = PxMax(mOriginZ[i], ext.z);
+	}
+
+	RayPacketAABBTest& operator=(const RayPacketAABBTest&);
+};
+
+#define GU_MAX_CULLING_PLANES	32
+
+// PT: SoA plane set for culling queries. A point is inside a plane when plane.distance(point) <= 0, i.e. the normals
+// point outwards, as for PxPlaneGeometry. Each box is tested against 4 planes at a time. The plane masks passed around
+// during traversal only contain the planes the parent box still crosses: a box fully inside a plane stays inside it for
+// all its descendants, so that plane is dropped, and a zero mask means the whole subtree is inside the plane set.
+struct PlanesAABBTest
+{
+	PlanesAABBTest(PxU32 nbPlanes, const PxPlane* planes) : mNbGroups((nbPlanes+3)>>2), mAllPlanesMask(computeAllPlanesMask(nbPlanes))
+	{
+		PX_ASSERT(nbPlanes && nbPlanes<=GU_MAX_CULLING_PLANES);
+		for(PxU32 i=0; i<mNbGroups*4; i++)
+			setPlane(i, i<nbPlanes ? planes[i] : PxPlane(0.0f, 0.0f, 0.0f, 0.0f));
+	}
+
+	// PT: same plane set expressed in the local space of a compound with the given world pose
+	PlanesAABBTest(const PlanesAABBTest& worldTest, const PxTransform& pose) : mNbGroups(worldTest.mNbGroups), mAllPlanesMask(worldTest.mAllPlanesMask)
+	{
+		for(PxU32 i=0; i<mNbGroups*4; i++)
+		{
+			const PxVec3 n(worldTest.mNx[i], worldTest.mNy[i], worldTest.mNz[i]);
+			setPlane(i, PxPlane(pose.q.rotateInv(n), worldTest.mD[i] + n.dot(pose.p)));
+		}
+	}
+
+	PX_FORCE_INLINE PxU32 getAllPlanesMask()	const	{ return mAllPlanesMask;	}
+
+	// PT: returns false if the box is fully outside one of the planes in planeMask. Otherwise planeMask is replaced with
+	// the subset of planes the box crosses, and 0 means the box is fully inside.
+	PX_FORCE_INLINE bool classify(const Vec3V center, const Vec3V extents, PxU32& planeMask) const
+	{
+		PX_ASSERT(planeMask);
+		const Vec4V center4 = Vec4V_From_Vec3V(center);
+		const Vec4V extents4 = Vec4V_From_Vec3V(extents);
+		const Vec4V cx = V4SplatElement<0>(center4);
+		const Vec4V cy = V4SplatElement<1>(center4);
+		const Vec4V cz = V4SplatElement<2>(center4);
+		const Vec4V ex = V4SplatElement<0>(extents4);
+		const Vec4V ey = V4SplatElement<1>(extents4);
+		const Vec4V ez = V4SplatElement<2>(extents4);
+		const Vec4V zero = V4Zero();
+
+		PxU32 crossing = 0;
+		for(PxU32 j=0; j<mNbGroups; j++)
+		{
+			const PxU32 offset4 = j*4;
+			const PxU32 groupMask = (planeMask>>offset4) & 15;
+			if(!groupMask)
+				continue;
+
+			// PT: signed distance from the box center, and projected radius of the box, for 4 planes
+			const Vec4V dist = V4MulAdd(V4LoadA(mNz + offset4), cz, V4MulAdd(V4LoadA(mNy + offset4), cy, V4MulAdd(V4LoadA(mNx + offset4), cx, V4LoadA(mD + offset4))));
+			const Vec4V rad = V4MulAdd(V4LoadA(mAbsNz + offset4), ez, V4MulAdd(V4LoadA(mAbsNy + offset4), ey, V4Mul(V4LoadA(mAbsNx + offset4), ex)));
+
+			if(BGetBitMask(V4IsGrtr(V4Sub(dist, rad), zero)) & groupMask)
+				return false;
+
+			crossing |= (BGetBitMask(V4IsGrtr(V4Add(dist, rad), zero)) & groupMask)<<offset4;
+		}
+		planeMask = crossing;
+		return true;
+	}
+
+	PX_ALIGN(16, PxReal)	mNx[GU_MAX_CULLING_PLANES];
+	PX_ALIGN(16, PxReal)	mNy[GU_MAX_CULLING_PLANES];
+	PX_ALIGN(16, PxReal)	mNz[GU_MAX_CULLING_PLANES];
+	PX_ALIGN(16, PxReal)	mD[GU_MAX_CULLING_PLANES];
+	PX_ALIGN(16, PxReal)	mAbsNx[GU_MAX_CULLING_PLANES];
+	PX_ALIGN(16, PxReal)	mAbsNy[GU_MAX_CULLING_PLANES];
+	PX_ALIGN(16, PxReal)	mAbsNz[GU_MAX_CULLING_PLANES];
+	const PxU32				mNbGroups;
+	const PxU32				mAllPlanesMask;
+
+private:
+	static PX_FORCE_INLINE PxU32 computeAllPlanesMask(PxU32 nbPlanes)
+	{
+		return nbPlanes>=32 ? 0xffffffff : (1u<<nbPlanes)-1;
+	}
+
+	PX_FORCE_INLINE void setPlane(PxU32 i, const PxPlane& plane)
+	{
+		mNx[i] = plane.n.x;		mNy[i] = plane.n.y;		mNz[i] = plane.n.z;		mD[i] = plane.d;
+		mAbsNx[i] = PxAbs(plane.n.x);	mAbsNy[i] = PxAbs(plane.n.y);	mAbsNz[i] = PxAbs(plane.n.z);
+	}
+
+	PlanesAABBTest& operator=(const PlanesAABBTest&);
+};
+
 // probably not worth having a SIMD version of this unless the traversal passes Vec3Vs
 struct AABBAABBTest
 {
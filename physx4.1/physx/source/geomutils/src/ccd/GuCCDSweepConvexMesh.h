@@ -165,6 +165,68 @@ namespace Gu
 		return tfirst; 
 	}
 
+	/**
+	\brief Sweeps 4 pairs of AABBs against each other at once.
+
+	Inputs are in SoA form: each parameter points to 3 vectors holding the x, y and z components of the 4 pairs. The results are
+	the same as calling sweepAABBAABB() on each pair, i.e. the TOI when the boxes hit, else PX_MAX_REAL.
+	*/
+	PX_FORCE_INLINE Ps::aos::Vec4V sweepAABBAABB4(const Ps::aos::Vec4V* centerA, const Ps::aos::Vec4V* extentsA, const Ps::aos::Vec4V* centerB,
+		const Ps::aos::Vec4V* extentsB, const Ps::aos::Vec4V* trA, const Ps::aos::Vec4V* trB)
+	{
+		using namespace Ps::aos;
+
+		const Vec4V zero = V4Zero();
+		const Vec4V one = V4One();
+		const Vec4V eps = V4Load(1e-6f);
+		const Vec4V minusEps = V4Load(-1e-6f);
+
+		BoolV initialHit = BTTTT();
+		BoolV miss = BFFFF();
+		Vec4V tfirst = zero;
+		Vec4V tlast = one;
+
+		for(PxU32 a = 0; a < 3; ++a)
+		{
+			const Vec4V cAcB = V4Sub(centerA[a], centerB[a]);
+			const Vec4V sumExtents = V4Add(extentsA[a], extentsB[a]);
+			initialHit = BAnd(initialHit, V4IsGrtrOrEq(sumExtents, V4Abs(cAcB)));
+
+			const Vec4V relTr = V4Sub(trB[a], trA[a]);
+
+			const Vec4V aMax = V4Add(centerA[a], extentsA[a]);
+			const Vec4V aMin = V4Sub(centerA[a], extentsA[a]);
+			const Vec4V bMax = V4Add(centerB[a], extentsB[a]);
+			const Vec4V bMin = V4Sub(centerB[a], extentsB[a]);
+
+			const BoolV neg = V4IsGrtr(minusEps, relTr);
+			const BoolV pos = V4IsGrtr(relTr, eps);
+
+			const BoolV bBelowA = V4IsGrtr(aMin, bMax);	// bMax < aMin
+			const BoolV bAboveA = V4IsGrtr(bMin, aMax);	// bMin > aMax
+			const BoolV bOverA = V4IsGrtr(bMax, aMin);	// bMax > aMin
+			const BoolV aOverB = V4IsGrtr(aMax, bMin);	// aMax > bMin
+
+			// PT: moving apart along an axis where the boxes are already separated, or not moving along an axis where they don't overlap
+			const BoolV axisMiss = BOr(BOr(BAnd(neg, bBelowA), BAnd(pos, bAboveA)), BAnd(BNot(BOr(neg, pos)), BOr(bBelowA, bAboveA)));
+			miss = BOr(miss, axisMiss);
+
+			// PT: the divisor is replaced in lanes that don't use the quotient, to avoid divisions by zero
+			const Vec4V divisor = V4Sel(BOr(neg, pos), relTr, one);
+			const Vec4V aMaxMinusBMin = V4Div(V4Sub(aMax, bMin), divisor);
+			const Vec4V aMinMinusBMax = V4Div(V4Sub(aMin, bMax), divisor);
+
+			tfirst = V4Max(tfirst, V4Sel(BAnd(neg, bAboveA), aMaxMinusBMin, zero));
+			tfirst = V4Max(tfirst, V4Sel(BAnd(pos, bBelowA), aMinMinusBMax, zero));
+			tlast = V4Min(tlast, V4Sel(BAnd(neg, bOverA), aMinMinusBMax, one));
+			tlast = V4Min(tlast, V4Sel(BAnd(pos, aOverB), aMaxMinusBMin, one));
+		}
+
+		miss = BOr(miss, V4IsGrtr(tfirst, tlast));
+		const Vec4V toi = V4Sel(miss, V4Load(PX_MAX_REAL), tfirst);
+		return V4Sel(initialHit, zero, toi);
+	}
+
 	PX_PHYSX_COMMON_API PxReal SweepShapeShape(GU_SWEEP_METHOD_ARGS);
 
 	PX_PHYSX_COMMON_API PxReal SweepEstimateAnyShapeHeightfield(GU_SWEEP_ESTIMATE_ARGS);
@@ -32,6 +32,7 @@
 
 	// PT: "BV4" ported from "Opcode 2.0". Available compile-time options are:
 	#define GU_BV4_STACK_SIZE	256				// Default size of local stacks for non-recursive traversals.
+	#define GU_BV4_RAY_PACKET_MAX_SIZE	16		// Max number of rays traversed together by packet raycasts.
 	#define GU_BV4_PRECOMPUTED_NODE_SORT		// Use node sorting or not. This should probably always be enabled.
 //	#define GU_BV4_QUANTIZED_TREE				// Use AABB quantization/compression or not.
 	#define GU_BV4_USE_SLABS					// Use swizzled data format or not. Swizzled = faster raycasts, but slower overlaps & larger trees.
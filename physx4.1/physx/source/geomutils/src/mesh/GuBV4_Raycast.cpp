@@ -35,6 +35,7 @@ using namespace Gu;
 
 #include "PxQueryReport.h"
 #include "GuInternal.h"
+#include "PsBitUtils.h"
 
 #include "GuIntersectionRayTriangle.h"
 
@@ -622,4 +623,203 @@ PxU32 BV4_RaycastAll(const PxVec3& origin, const PxVec3& dir, const BV4Tree& tre
 	return Params.mNbHits;
 }
 
+
+// Packet version
+
+namespace
+{
+// PT: per-ray data of the slab test, i.e. what SLABS_INIT computes for a single ray
+struct RayPacketSlabs
+{
+	Vec4V	mInvDX, mInvDY, mInvDZ;
+	Vec4V	mPinvDX, mPinvDY, mPinvDZ;
+};
+
+struct RayPacketStackEntry
+{
+	PxU32	mChildData;
+	PxU32	mRayMask;
+};
+}
+
+// PT: children are pushed in the order given by the packet's direction, with their own ray masks
+#undef PNS_BLOCK3
+#define PNS_BLOCK3(a, b, c, d)	{																				\
+	if(code2 & (1<<a))	{ stack[nb].mChildData = tn->getChildData(a); stack[nb++].mRayMask = childMasks[a];	}	\
+	if(code2 & (1<<b))	{ stack[nb].mChildData = tn->getChildData(b); stack[nb++].mRayMask = childMasks[b];	}	\
+	if(code2 & (1<<c))	{ stack[nb].mChildData = tn->getChildData(c); stack[nb++].mRayMask = childMasks[c];	}	\
+	if(code2 & (1<<d))	{ stack[nb].mChildData = tn->getChildData(d); stack[nb++].mRayMask = childMasks[d];	}	}
+
+// PT: Kajiya traversal for a packet of rays. A node is fetched and dequantized once for all the rays that reached it, then
+// each ray runs the same slab test and leaf test as in BV4_ProcessStreamKajiyaOrderedQ. Nodes are visited in the order
+// given by the packet's average direction instead of each ray's own direction, which doesn't change the closest hit
+// distances but can change which triangle is reported among triangles hit at exactly the same distance.
+static void BV4_ProcessStreamKajiyaPacketQ(const BVDataPackedQ* PX_RESTRICT node, PxU32 initData, RayParams* PX_RESTRICT rayParams, PxU32 activeRays)
+{
+	const BVDataPackedQ* root = node;
+
+	RayPacketSlabs slabs[GU_BV4_RAY_PACKET_MAX_SIZE];
+	PxVec3 packetDir(0.0f);
+	PxU32 rays = activeRays;
+	while(rays)
+	{
+		const PxU32 i = Ps::lowestSetBit(rays);
+		rays &= rays - 1;
+
+		const RayParams* PX_RESTRICT params = rayParams + i;
+		SLABS_INIT
+		PX_UNUSED(maxT4);
+		slabs[i].mInvDX = rayInvDsplatX;
+		slabs[i].mInvDY = rayInvDsplatY;
+		slabs[i].mInvDZ = rayInvDsplatZ;
+		slabs[i].mPinvDX = rayPinvDsplatX;
+		slabs[i].mPinvDY = rayPinvDsplatY;
+		slabs[i].mPinvDZ = rayPinvDsplatZ;
+		packetDir += params->mLocalDir_Padded;
+	}
+
+	const PxU32 X = PX_IR(packetDir.x)>>31;
+	const PxU32 Y = PX_IR(packetDir.y)>>31;
+	const PxU32 Z = PX_IR(packetDir.z)>>31;
+	const PxU32 bitIndex = 3+(Z|(Y<<1)|(X<<2));
+	const PxU32 dirMask = 1u<<bitIndex;
+
+	// PT: the dequantization coeffs only depend on the tree
+	const RayParams* PX_RESTRICT params = rayParams + Ps::lowestSetBit(activeRays);
+	const Vec4V minCoeffV = V4LoadA_Safe(&params->mCenterOrMinCoeff_PaddedAligned.x);
+	const Vec4V maxCoeffV = V4LoadA_Safe(&params->mExtentsOrMaxCoeff_PaddedAligned.x);
+	const Vec4V minCoeffxV = V4SplatElement<0>(minCoeffV);
+	const Vec4V minCoeffyV = V4SplatElement<1>(minCoeffV);
+	const Vec4V minCoeffzV = V4SplatElement<2>(minCoeffV);
+	const Vec4V maxCoeffxV = V4SplatElement<0>(maxCoeffV);
+	const Vec4V maxCoeffyV = V4SplatElement<1>(maxCoeffV);
+	const Vec4V maxCoeffzV = V4SplatElement<2>(maxCoeffV);
+
+	PxU32 nb=1;
+	RayPacketStackEntry stack[GU_BV4_STACK_SIZE];
+	stack[0].mChildData = initData;
+	stack[0].mRayMask = activeRays;
+
+	do
+	{
+		nb--;
+		const PxU32 childData = stack[nb].mChildData;
+		PxU32 rayMask = stack[nb].mRayMask;
+		node = root + getChildOffset(childData);
+
+		const BVDataSwizzledQ* tn = reinterpret_cast<const BVDataSwizzledQ*>(node);
+
+		Vec4V minx4a;
+		Vec4V maxx4a;
+		OPC_DEQ4(maxx4a, minx4a, mX, minCoeffxV, maxCoeffxV)
+
+		Vec4V miny4a;
+		Vec4V maxy4a;
+		OPC_DEQ4(maxy4a, miny4a, mY, minCoeffyV, maxCoeffyV)
+
+		Vec4V minz4a;
+		Vec4V maxz4a;
+		OPC_DEQ4(maxz4a, minz4a, mZ, minCoeffzV, maxCoeffzV)
+
+		// PT: childMasks[x] = rays touching child x
+		PxU32 childMasks[4] = { 0, 0, 0, 0 };
+		while(rayMask)
+		{
+			const PxU32 i = Ps::lowestSetBit(rayMask);
+			rayMask &= rayMask - 1;
+
+			const Vec4V maxT4 = V4Load(rayParams[i].mStabbedFace.mDistance);
+			const Vec4V rayInvDsplatX = slabs[i].mInvDX;
+			const Vec4V rayInvDsplatY = slabs[i].mInvDY;
+			const Vec4V rayInvDsplatZ = slabs[i].mInvDZ;
+			const Vec4V rayPinvDsplatX = slabs[i].mPinvDX;
+			const Vec4V rayPinvDsplatY = slabs[i].mPinvDY;
+			const Vec4V rayPinvDsplatZ = slabs[i].mPinvDZ;
+
+			SLABS_TEST
+
+			SLABS_TEST2
+
+			const PxU32 rayBit = 1u<<i;
+			if(!(code&1))	childMasks[0] |= rayBit;
+			if(!(code&2))	childMasks[1] |= rayBit;
+			if(!(code&4))	childMasks[2] |= rayBit;
+			if(!(code&8))	childMasks[3] |= rayBit;
+		}
+
+		const PxU32 nodeType = getChildType(childData);
+		if(nodeType<=1)
+			childMasks[3] = 0;
+		if(!nodeType)
+			childMasks[2] = 0;
+
+		// PT: same leaf order as the single-ray traversal
+		PxU32 code2 = 0;
+		for(PxU32 x=4; x--;)
+		{
+			PxU32 leafRays = childMasks[x];
+			if(!leafRays)
+				continue;
+
+			if(!tn->isLeaf(x))
+			{
+				code2 |= 1<<x;
+				continue;
+			}
+
+			const PxU32 primIndex = tn->getPrimitive(x);
+			while(leafRays)
+			{
+				const PxU32 i = Ps::lowestSetBit(leafRays);
+				leafRays &= leafRays - 1;
+				LeafFunction_RaycastClosest::doLeafTest(rayParams + i, primIndex);
+			}
+		}
+
+		SLABS_PNS
+
+	}while(nb);
+}
+
+#undef PNS_BLOCK3
+
+// PT: closest-hit raycasts for a packet of rays, equivalent to calling BV4_RaycastSingle() for each ray without the
+// "any hit" flag. Returns a bitmask of the rays that hit the mesh, whose results are written to hits[rayIndex].
+PxU32 BV4_RaycastPacket(PxU32 nbRays, const PxVec3* origins, const PxVec3* dirs, const float* maxDists, const BV4Tree& tree, const PxMat44* PX_RESTRICT worldm_Aligned, PxRaycastHit* PX_RESTRICT hits, float geomEpsilon, PxU32 flags, PxHitFlags hitFlags)
+{
+	PX_ASSERT(nbRays && nbRays<=GU_BV4_RAY_PACKET_MAX_SIZE);
+	PX_ASSERT(!(flags & QUERY_MODIFIER_ANY_HIT));
+
+	const SourceMesh* PX_RESTRICT mesh = tree.mMeshInterface;
+
+	RayParams Params[GU_BV4_RAY_PACKET_MAX_SIZE];
+	for(PxU32 i=0; i<nbRays; i++)
+		setupRayParams(&Params[i], origins[i], dirs[i], &tree, worldm_Aligned, mesh, maxDists[i], geomEpsilon, flags);
+
+#ifdef GU_BV4_COMPILE_NON_QUANTIZED_TREE
+	if(tree.mNodes && tree.mQuantized)
+#else
+	if(tree.mNodes)
+#endif
+		BV4_ProcessStreamKajiyaPacketQ(reinterpret_cast<const BVDataPackedQ*>(tree.mNodes), tree.mInitData, Params, (1u<<nbRays)-1);
+	else
+	{
+		for(PxU32 i=0; i<nbRays; i++)
+		{
+			if(tree.mNodes)
+				processStreamRayOrdered<0, LeafFunction_RaycastClosest>(tree, &Params[i]);
+			else
+				doBruteForceTests<LeafFunction_RaycastAny, LeafFunction_RaycastClosest>(mesh->getNbTriangles(), &Params[i]);
+		}
+	}
+
+	PxU32 hitMask = 0;
+	for(PxU32 i=0; i<nbRays; i++)
+	{
+		if(computeImpactData(hits + i, &Params[i], worldm_Aligned, hitFlags))
+			hitMask |= 1<<i;
+	}
+	return hitMask;
+}
+
 #endif
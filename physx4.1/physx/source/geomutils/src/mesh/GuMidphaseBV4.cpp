@@ -62,6 +62,7 @@ using namespace Cm;
 Ps::IntBool	BV4_RaycastSingle		(const PxVec3& origin, const PxVec3& dir, const BV4Tree& tree, const PxMat44* PX_RESTRICT worldm_Aligned, PxRaycastHit* PX_RESTRICT hit, float maxDist, float geomEpsilon, PxU32 flags, PxHitFlags hitFlags);
 PxU32		BV4_RaycastAll			(const PxVec3& origin, const PxVec3& dir, const BV4Tree& tree, const PxMat44* PX_RESTRICT worldm_Aligned, PxRaycastHit* PX_RESTRICT hits, PxU32 maxNbHits, float maxDist, float geomEpsilon, PxU32 flags, PxHitFlags hitFlags);
 void		BV4_RaycastCB			(const PxVec3& origin, const PxVec3& dir, const BV4Tree& tree, const PxMat44* PX_RESTRICT worldm_Aligned, float maxDist, float geomEpsilon, PxU32 flags, MeshRayCallback callback, void* userData);
+PxU32		BV4_RaycastPacket		(PxU32 nbRays, const PxVec3* origins, const PxVec3* dirs, const float* maxDists, const BV4Tree& tree, const PxMat44* PX_RESTRICT worldm_Aligned, PxRaycastHit* PX_RESTRICT hits, float geomEpsilon, PxU32 flags, PxHitFlags hitFlags);
 
 Ps::IntBool	BV4_OverlapSphereAny	(const Sphere& sphere, const BV4Tree& tree, const PxMat44* PX_RESTRICT worldm_Aligned);
 PxU32		BV4_OverlapSphereAll	(const Sphere& sphere, const BV4Tree& tree, const PxMat44* PX_RESTRICT worldm_Aligned, PxU32* results, PxU32 size, bool& overflow);
@@ -318,6 +319,57 @@ static PX_FORCE_INLINE PxVec3 processLocalNormal(const Cm::Matrix34* PX_RESTRICT
 	return normal;
 }
 
+// PT: completes a closest hit returned by raycastVsMesh() for a mesh with identity scale, i.e. already in world space
+static PX_FORCE_INLINE void finalizeRaycastHitIdtScale(PxRaycastHit& hit, const PxVec3& rayDir, bool isDoubleSided, PxHitFlags hitFlags)
+{
+	PxHitFlags dstFlags = PxHitFlag::ePOSITION|PxHitFlag::eUV|PxHitFlag::eFACE_INDEX;
+
+	// PT: TODO: pass flags to BV4 code (TA34704)
+	if(hitFlags & PxHitFlag::eNORMAL)
+	{
+		dstFlags |= PxHitFlag::eNORMAL;
+		if(isDoubleSided)
+		{
+			PxVec3 normal = hit.normal;
+			// PT: figure out correct normal orientation (DE7458)
+			// - if the mesh is single-sided the normal should be the regular triangle normal N, regardless of eMESH_BOTH_SIDES.
+			// - if the mesh is double-sided the correct normal can be either N or -N. We take the one opposed to ray direction.
+			if(normal.dot(rayDir) > 0.0f)
+				normal = -normal;
+			hit.normal = normal;
+		}
+	}
+	else
+	{
+		hit.normal = PxVec3(0.0f);
+	}
+	hit.flags = dstFlags;
+}
+
+// PT: completes a closest hit returned by raycastVsMesh() in vertex space, for a scaled mesh
+static PX_FORCE_INLINE void finalizeRaycastHitScaled(PxRaycastHit& hit, const PxMeshScale& scale, const PxTransform& pose, const Cm::Matrix34* world2vertexSkew, PxReal distCoeff, const PxVec3& rayDir, bool isDoubleSided, PxHitFlags hitFlags)
+{
+	hit.distance	*= distCoeff;
+	hit.position	= pose.transform(scale.transform(hit.position));
+	PxHitFlags dstFlags = PxHitFlag::ePOSITION|PxHitFlag::eUV|PxHitFlag::eFACE_INDEX;
+
+	if(scale.hasNegativeDeterminant())
+		Ps::swap<PxReal>(hit.u, hit.v); // have to swap the UVs though since they were computed in mesh local space
+
+	// PT: TODO: pass flags to BV4 code (TA34704)
+	// Compute additional information if needed
+	if(hitFlags & PxHitFlag::eNORMAL)
+	{
+		dstFlags |= PxHitFlag::eNORMAL;
+		hit.normal = processLocalNormal(world2vertexSkew, &pose, hit.normal, rayDir, isDoubleSided);
+	}
+	else
+	{
+		hit.normal = PxVec3(0.0f);
+	}
+	hit.flags = dstFlags;
+}
+
 static HitCode gRayCallback(void* userData, const PxVec3& lp0, const PxVec3& lp1, const PxVec3& lp2, PxU32 triangleIndex, float dist, float u, float v)
 {
 	BV4RaycastCBParams* params = reinterpret_cast<BV4RaycastCBParams*>(userData);
@@ -385,30 +437,7 @@ PxU32 physx::Gu::raycast_triangleMesh_BV4(	const TriangleMesh* mesh, const PxTri
 	{
 		bool b = raycastVsMesh(*hits, tree, &pose.p.x, &pose.q.x, rayOrigin, rayDir, maxDist, meshData->getGeomEpsilon(), bothSides, hitFlags);
 		if(b)
-		{
-			PxHitFlags dstFlags = PxHitFlag::ePOSITION|PxHitFlag::eUV|PxHitFlag::eFACE_INDEX;
-
-			// PT: TODO: pass flags to BV4 code (TA34704)
-			if(hitFlags & PxHitFlag::eNORMAL)
-			{
-				dstFlags |= PxHitFlag::eNORMAL;
-				if(isDoubleSided)
-				{
-					PxVec3 normal = hits->normal;
-					// PT: figure out correct normal orientation (DE7458)
-					// - if the mesh is single-sided the normal should be the regular triangle normal N, regardless of eMESH_BOTH_SIDES.
-					// - if the mesh is double-sided the correct normal can be either N or -N. We take the one opposed to ray direction.
-					if(normal.dot(rayDir) > 0.0f)
-						normal = -normal;
-					hits->normal = normal;
-				}
-			}
-			else
-			{
-				hits->normal = PxVec3(0.0f);
-			}
-			hits->flags = dstFlags;
-		}
+			finalizeRaycastHitIdtScale(*hits, rayDir, isDoubleSided, hitFlags);
 		return PxU32(b);
 	}
 
@@ -449,27 +478,7 @@ PxU32 physx::Gu::raycast_triangleMesh_BV4(	const TriangleMesh* mesh, const PxTri
 	{
 		bool b = raycastVsMesh(*hits, tree, NULL, NULL, orig, dir, maxDist, meshData->getGeomEpsilon(), bothSides, hitFlags);
 		if(b)
-		{
-			hits->distance	*= distCoeff;
-			hits->position	= pose.transform(meshGeom.scale.transform(hits->position));
-			PxHitFlags dstFlags = PxHitFlag::ePOSITION|PxHitFlag::eUV|PxHitFlag::eFACE_INDEX;
-
-			if(meshGeom.scale.hasNegativeDeterminant())
-				Ps::swap<PxReal>(hits->u, hits->v); // have to swap the UVs though since they were computed in mesh local space
-
-			// PT: TODO: pass flags to BV4 code (TA34704)
-			// Compute additional information if needed
-			if(hitFlags & PxHitFlag::eNORMAL)
-			{
-				dstFlags |= PxHitFlag::eNORMAL;
-				hits->normal = processLocalNormal(world2vertexSkewP, &pose, hits->normal, rayDir, isDoubleSided);
-			}
-			else
-			{
-				hits->normal = PxVec3(0.0f);
-			}
-			hits->flags = dstFlags;
-		}
+			finalizeRaycastHitScaled(*hits, meshGeom.scale, pose, world2vertexSkewP, distCoeff, rayDir, isDoubleSided, hitFlags);
 		return PxU32(b);
 	}
 
@@ -482,6 +491,67 @@ PxU32 physx::Gu::raycast_triangleMesh_BV4(	const TriangleMesh* mesh, const PxTri
 	return callback.mHitNum;
 }
 
+PX_COMPILE_TIME_ASSERT(GU_MIDPHASE_RAY_PACKET_MAX_SIZE<=GU_BV4_RAY_PACKET_MAX_SIZE);
+
+PxU32 physx::Gu::raycastPacket_triangleMesh_BV4(const TriangleMesh* mesh, const PxTriangleMeshGeometry& meshGeom, const PxTransform& pose,
+												PxU32 nbRays, const PxVec3* rayOrigins, const PxVec3* rayDirs, const PxReal* maxDists,
+												PxHitFlags hitFlags, PxRaycastHit* PX_RESTRICT hits)
+{
+	PX_ASSERT(mesh->getConcreteType()==PxConcreteType::eTRIANGLE_MESH_BVH34);
+	PX_ASSERT(nbRays && nbRays<=GU_MIDPHASE_RAY_PACKET_MAX_SIZE);
+	PX_ASSERT(!(hitFlags & PxHitFlag::eMESH_ANY));
+	const BV4TriangleMesh* meshData = static_cast<const BV4TriangleMesh*>(mesh);
+
+	const bool idtScale = meshGeom.scale.isIdentity();
+
+	const bool isDoubleSided = meshGeom.meshFlags.isSet(PxMeshGeometryFlag::eDOUBLE_SIDED);
+	const bool bothSides = isDoubleSided || (hitFlags & PxHitFlag::eMESH_BOTH_SIDES);
+	const PxU32 flags = setupFlags(false, bothSides, false);
+
+	const BV4Tree& tree = meshData->getBV4Tree();
+
+	// PT: same as raycast_triangleMesh_BV4() with a single hit, for each ray of the packet
+	if(idtScale)
+	{
+		BV4_ALIGN16(PxMat44 World);
+		const PxMat44* TM = setupWorldMatrix(World, &pose.p.x, &pose.q.x);
+
+		const PxU32 hitMask = BV4_RaycastPacket(nbRays, rayOrigins, rayDirs, maxDists, tree, TM, hits, meshData->getGeomEpsilon(), flags, hitFlags);
+		for(PxU32 mask=hitMask; mask; mask &= mask - 1)
+		{
+			const PxU32 i = Ps::lowestSetBit(mask);
+			finalizeRaycastHitIdtScale(hits[i], rayDirs[i], isDoubleSided, hitFlags);
+		}
+		return hitMask;
+	}
+
+	//scaling: transform the rays to vertex space
+	const Cm::Matrix34 world2vertexSkew = meshGeom.scale.getInverse() * pose.getInverse();
+	PxVec3 origs[GU_MIDPHASE_RAY_PACKET_MAX_SIZE];
+	PxVec3 dirs[GU_MIDPHASE_RAY_PACKET_MAX_SIZE];
+	PxReal localMaxDists[GU_MIDPHASE_RAY_PACKET_MAX_SIZE];
+	PxReal distCoeffs[GU_MIDPHASE_RAY_PACKET_MAX_SIZE];
+	for(PxU32 i=0; i<nbRays; i++)
+	{
+		origs[i] = world2vertexSkew.transform(rayOrigins[i]);
+		dirs[i] = world2vertexSkew.rotate(rayDirs[i]);
+		const PxReal distCoeff = dirs[i].normalize();
+		PxReal maxDist = maxDists[i];
+		maxDist *= distCoeff;
+		maxDist += 1e-3f;
+		localMaxDists[i] = maxDist;
+		distCoeffs[i] = 1.0f/distCoeff;
+	}
+
+	const PxU32 hitMask = BV4_RaycastPacket(nbRays, origs, dirs, localMaxDists, tree, NULL, hits, meshData->getGeomEpsilon(), flags, hitFlags);
+	for(PxU32 mask=hitMask; mask; mask &= mask - 1)
+	{
+		const PxU32 i = Ps::lowestSetBit(mask);
+		finalizeRaycastHitScaled(hits[i], meshGeom.scale, pose, &world2vertexSkew, distCoeffs[i], rayDirs[i], isDoubleSided, hitFlags);
+	}
+	return hitMask;
+}
+
 namespace
 {
 struct IntersectShapeVsMeshCallback
@@ -39,6 +39,8 @@
 // midphase-related entry points, dispatching calls to the proper implementations depending on the triangle mesh's type. The rest of it
 // is simply classes & structs shared by all implementations.
 
+#define GU_MIDPHASE_RAY_PACKET_MAX_SIZE	16	// max number of rays in a Midphase::raycastTriangleMeshPacket() call
+
 namespace physx
 {
 	class PxMeshScale;
@@ -134,6 +136,9 @@ namespace Gu
 	PX_PHYSX_COMMON_API PxU32 raycast_triangleMesh_BV4(	const TriangleMesh* mesh, const PxTriangleMeshGeometry& meshGeom, const PxTransform& pose,
 									const PxVec3& rayOrigin, const PxVec3& rayDir, PxReal maxDist,
 									PxHitFlags hitFlags, PxU32 maxHits, PxRaycastHit* PX_RESTRICT hits);
+	PX_PHYSX_COMMON_API PxU32 raycastPacket_triangleMesh_BV4(const TriangleMesh* mesh, const PxTriangleMeshGeometry& meshGeom, const PxTransform& pose,
+									PxU32 nbRays, const PxVec3* rayOrigins, const PxVec3* rayDirs, const PxReal* maxDists,
+									PxHitFlags hitFlags, PxRaycastHit* PX_RESTRICT hits);
 	PX_PHYSX_COMMON_API bool intersectSphereVsMesh_BV4	(const Sphere& sphere,		const TriangleMesh& triMesh, const PxTransform& meshTransform, const PxMeshScale& meshScale, LimitedResults* results);
 	PX_PHYSX_COMMON_API bool intersectBoxVsMesh_BV4		(const Box& box,			const TriangleMesh& triMesh, const PxTransform& meshTransform, const PxMeshScale& meshScale, LimitedResults* results);
 	PX_PHYSX_COMMON_API bool intersectCapsuleVsMesh_BV4	(const Capsule& capsule,	const TriangleMesh& triMesh, const PxTransform& meshTransform, const PxMeshScale& meshScale, LimitedResults* results);
@@ -317,6 +322,38 @@ namespace Midphase
 		return gMidphaseRaycastTable[index](mesh, meshGeom, meshTransform, rayOrigin, rayDir, maxDist, hitFlags, maxHits, hits);
 	}
 
+	// Raycasts a packet of rays against a triangle mesh, looking for the closest hit of each ray. This gives the same results as
+	// raycastTriangleMesh() with maxHits=1 for each ray, except for the triangle reported among triangles hit at exactly the same
+	// distance. BV4 meshes traverse their tree once for the whole packet, other meshes are raycast one ray at a time.
+	// \param[in]	mesh			triangle mesh to raycast against
+	// \param[in]	meshGeom		geometry object associated with the mesh
+	// \param[in]	meshTransform	pose/transform of geometry object
+	// \param[in]	nbRays			number of rays, at most GU_MIDPHASE_RAY_PACKET_MAX_SIZE
+	// \param[in]	rayOrigins		rays' origins
+	// \param[in]	rayDirs			rays' unit dirs
+	// \param[in]	maxDists		rays' lengths/max distances
+	// \param[in]	hitFlags		query behavior flags, without PxHitFlag::eMESH_ANY
+	// \param[out]	hits			result buffer with one hit per ray
+	// \return		bitmask of the rays that hit the mesh. Only their entries in 'hits' are written.
+	PX_FORCE_INLINE PxU32 raycastTriangleMeshPacket(const TriangleMesh* mesh, const PxTriangleMeshGeometry& meshGeom, const PxTransform& meshTransform,
+													PxU32 nbRays, const PxVec3* rayOrigins, const PxVec3* rayDirs, const PxReal* maxDists,
+													PxHitFlags hitFlags, PxRaycastHit* PX_RESTRICT hits)
+	{
+		PX_ASSERT(nbRays<=GU_MIDPHASE_RAY_PACKET_MAX_SIZE);
+		PX_ASSERT(!(hitFlags & PxHitFlag::eMESH_ANY));
+	#if PX_INTEL_FAMILY && !defined(PX_SIMD_DISABLED)
+		if(mesh->getConcreteType()==PxConcreteType::eTRIANGLE_MESH_BVH34)
+			return raycastPacket_triangleMesh_BV4(mesh, meshGeom, meshTransform, nbRays, rayOrigins, rayDirs, maxDists, hitFlags, hits);
+	#endif
+		PxU32 hitMask = 0;
+		for(PxU32 i=0; i<nbRays; i++)
+		{
+			if(raycastTriangleMesh(mesh, meshGeom, meshTransform, rayOrigins[i], rayDirs[i], maxDists[i], hitFlags, 1, hits + i))
+				hitMask |= 1<<i;
+		}
+		return hitMask;
+	}
+
 	// \param[in]	sphere			sphere
 	// \param[in]	mesh			triangle mesh
 	// \param[in]	meshTransform	pose/transform of triangle mesh
@@ -43,6 +43,9 @@
 #include "../../lowleveldynamics/include/DyFeatherstoneArticulation.h"
 
 #include "../../lowlevel/common/include/utils/PxcScratchAllocator.h"
+#include "BpBroadPhase.h"
+#include "PsSort.h"
+#include "PsBitUtils.h"
 
 using namespace physx;
 using namespace Dy;
@@ -2129,3 +2132,271 @@ void immediate::PxIntegrateSolverBodiesTGS(PxTGSSolverBodyVel* solverBody, PxTGS
 		poses[i].q = (txInertia[i].deltaBody2World.q * poses[i].q).getNormalized();
 	}
 }
+
+namespace physx
+{
+namespace immediate
+{
+	// PT: thin wrapper around the scene-level broadphase implementations. It replaces the AABB manager: it owns the
+	// bounds/groups/contact distance arrays indexed by handles, and it builds the sorted created/updated/removed lists.
+	class PxImmediateBroadPhase : public Ps::UserAllocated
+	{
+		PX_NOCOPY(PxImmediateBroadPhase)
+		public:
+		enum StateFlag
+		{
+			eIN_BP		= (1<<0),
+			eCREATED	= (1<<1),
+			eUPDATED	= (1<<2),
+			eREMOVED	= (1<<3)
+		};
+
+		PxImmediateBroadPhase(Bp::BroadPhase* broadPhase, const PxImmediateBroadPhaseDesc& desc) : mBroadPhase(broadPhase), mCapacity(0), mMaxNbHandles(0)
+		{
+			for(PxU32 j=0;j<Bp::FilterType::COUNT;j++)
+				for(PxU32 i=0;i<Bp::FilterType::COUNT;i++)
+					mLUT[j][i] = false;
+			mLUT[Bp::FilterType::STATIC][Bp::FilterType::DYNAMIC] = mLUT[Bp::FilterType::DYNAMIC][Bp::FilterType::STATIC] = true;
+			mLUT[Bp::FilterType::STATIC][Bp::FilterType::KINEMATIC] = mLUT[Bp::FilterType::KINEMATIC][Bp::FilterType::STATIC] = !desc.discardStaticKinematic;
+			mLUT[Bp::FilterType::DYNAMIC][Bp::FilterType::KINEMATIC] = mLUT[Bp::FilterType::KINEMATIC][Bp::FilterType::DYNAMIC] = true;
+			mLUT[Bp::FilterType::DYNAMIC][Bp::FilterType::DYNAMIC] = true;
+			mLUT[Bp::FilterType::KINEMATIC][Bp::FilterType::KINEMATIC] = !desc.discardKinematicKinematic;
+
+			reserve(PxMax(desc.maxNbStaticObjects + desc.maxNbDynamicObjects, 1u));
+		}
+
+		~PxImmediateBroadPhase()
+		{
+			releaseResults();
+			mBroadPhase->destroy();
+		}
+
+		void	reserve(PxU32 nbHandles)
+		{
+			// PT: the broadphases can read one box past the last handle with SIMD loads, so we always keep a spare entry.
+			const PxU32 capacity = Ps::nextPowerOfTwo(nbHandles + 1);
+			if(capacity<=mCapacity)
+				return;
+
+			mBounds.resize(capacity, PxBounds3(PxVec3(0.0f), PxVec3(0.0f)));
+			mContactDistances.resize(capacity, 0.0f);
+			mGroups.resize(capacity, Bp::FilterGroup::eINVALID);
+			mStates.resize(capacity, 0);
+			mCapacity = capacity;
+		}
+
+		PxU32	addBounds(const PxBounds3& bounds, PxImmediateBroadPhaseObjectType::Enum type, PxU32 group, PxReal contactDistance)
+		{
+			PxU32 handle;
+			if(mFreeHandles.size())
+			{
+				handle = mFreeHandles.popBack();
+			}
+			else
+			{
+				handle = mMaxNbHandles++;
+				reserve(mMaxNbHandles);
+			}
+
+			mBounds[handle] = bounds;
+			mContactDistances[handle] = contactDistance;
+			mGroups[handle] = type==PxImmediateBroadPhaseObjectType::eSTATIC ? Bp::getFilterGroup_Statics() : Bp::getFilterGroup_Dynamics(group, type==PxImmediateBroadPhaseObjectType::eKINEMATIC);
+			mStates[handle] = eCREATED;
+			mCreated.pushBack(handle);
+			return handle;
+		}
+
+		void	updateBounds(PxU32 handle, const PxBounds3& bounds)
+		{
+			if(!isValidHandle(handle))
+			{
+				Ps::getFoundation().error(PxErrorCode::eINVALID_PARAMETER, __FILE__, __LINE__, "PxImmediateBroadPhaseUpdateBounds: invalid handle.");
+				return;
+			}
+
+			mBounds[handle] = bounds;
+			if(mStates[handle]==eIN_BP)
+			{
+				mStates[handle] |= eUPDATED;
+				mUpdated.pushBack(handle);
+			}
+		}
+
+		void	removeBounds(PxU32 handle)
+		{
+			if(!isValidHandle(handle))
+			{
+				Ps::getFoundation().error(PxErrorCode::eINVALID_PARAMETER, __FILE__, __LINE__, "PxImmediateBroadPhaseRemoveBounds: invalid handle.");
+				return;
+			}
+
+			// PT: handles still in the created list are discarded during the next update, the others are sent to the broadphase.
+			if(mStates[handle] & eIN_BP)
+				mRemoved.pushBack(handle);
+			mStates[handle] |= eREMOVED;
+		}
+
+		PxU32	addRegion(const PxBroadPhaseRegion& region)
+		{
+			return mBroadPhase->addRegion(region, true, mBounds.begin(), mContactDistances.begin());
+		}
+
+		void	update()
+		{
+			releaseResults();
+
+			PxU32 nbCreated = 0;
+			for(PxU32 i=0;i<mCreated.size();i++)
+			{
+				const PxU32 handle = mCreated[i];
+				if(mStates[handle] & eREMOVED)
+					releaseHandle(handle);
+				else
+					mCreated[nbCreated++] = handle;
+			}
+			mCreated.forceSize_Unsafe(nbCreated);
+
+			PxU32 nbUpdated = 0;
+			for(PxU32 i=0;i<mUpdated.size();i++)
+			{
+				const PxU32 handle = mUpdated[i];
+				if(!(mStates[handle] & eREMOVED))
+					mUpdated[nbUpdated++] = handle;
+			}
+			mUpdated.forceSize_Unsafe(nbUpdated);
+
+			// PT: the broadphases expect the handles in ascending order
+			if(mCreated.size())
+				Ps::sort(mCreated.begin(), mCreated.size());
+			if(mUpdated.size())
+				Ps::sort(mUpdated.begin(), mUpdated.size());
+			if(mRemoved.size())
+				Ps::sort(mRemoved.begin(), mRemoved.size());
+
+			const Bp::BroadPhaseUpdateData updateData(	mCreated.begin(), mCreated.size(),
+														mUpdated.begin(), mUpdated.size(),
+														mRemoved.begin(), mRemoved.size(),
+														mBounds.begin(), mGroups.begin(), &mLUT[0][0],
+														mContactDistances.begin(), mCapacity, true);
+			mBroadPhase->singleThreadedUpdate(&mScratchAllocator, updateData);
+
+			for(PxU32 i=0;i<mCreated.size();i++)
+				mStates[mCreated[i]] = eIN_BP;
+			for(PxU32 i=0;i<mUpdated.size();i++)
+				mStates[mUpdated[i]] = eIN_BP;
+			for(PxU32 i=0;i<mRemoved.size();i++)
+				releaseHandle(mRemoved[i]);
+
+			mCreated.clear();
+			mUpdated.clear();
+			mRemoved.clear();
+		}
+
+		PX_FORCE_INLINE	PxU32	getCreatedPairs(const PxImmediateBroadPhasePair*& pairs)
+		{
+			pairs = reinterpret_cast<const PxImmediateBroadPhasePair*>(mBroadPhase->getCreatedPairs());
+			return mBroadPhase->getNbCreatedPairs();
+		}
+
+		PX_FORCE_INLINE	PxU32	getDeletedPairs(const PxImmediateBroadPhasePair*& pairs)
+		{
+			pairs = reinterpret_cast<const PxImmediateBroadPhasePair*>(mBroadPhase->getDeletedPairs());
+			return mBroadPhase->getNbDeletedPairs();
+		}
+
+		private:
+		// PT: same sequence as the scene, SAP only purges the deleted pairs from its pair manager in deletePairs()
+		PX_FORCE_INLINE	void	releaseResults()
+		{
+			mBroadPhase->deletePairs();
+			mBroadPhase->freeBuffers();
+		}
+
+		PX_FORCE_INLINE	bool	isValidHandle(PxU32 handle)	const
+		{
+			return handle<mMaxNbHandles && mStates[handle] && !(mStates[handle] & eREMOVED);
+		}
+
+		PX_FORCE_INLINE	void	releaseHandle(PxU32 handle)
+		{
+			mStates[handle] = 0;
+			mGroups[handle] = Bp::FilterGroup::eINVALID;
+			mFreeHandles.pushBack(handle);
+		}
+
+		Bp::BroadPhase*					mBroadPhase;
+		PxcScratchAllocator				mScratchAllocator;	// PT: no scratch block, the broadphases fall back to the heap
+		Ps::Array<PxBounds3>			mBounds;
+		Ps::Array<PxReal>				mContactDistances;
+		Ps::Array<Bp::FilterGroup::Enum>	mGroups;
+		Ps::Array<PxU8>					mStates;
+		Ps::Array<PxU32>				mCreated;
+		Ps::Array<PxU32>				mUpdated;
+		Ps::Array<PxU32>				mRemoved;
+		Ps::Array<PxU32>				mFreeHandles;
+		bool							mLUT[Bp::FilterType::COUNT][Bp::FilterType::COUNT];
+		PxU32							mCapacity;
+		PxU32							mMaxNbHandles;
+	};
+}
+}
+
+PX_COMPILE_TIME_ASSERT(sizeof(PxImmediateBroadPhasePair)==sizeof(Bp::BroadPhasePair));
+PX_COMPILE_TIME_ASSERT(PX_OFFSET_OF(PxImmediateBroadPhasePair, id0)==PX_OFFSET_OF(Bp::BroadPhasePair, mVolA));
+PX_COMPILE_TIME_ASSERT(PX_OFFSET_OF(PxImmediateBroadPhasePair, id1)==PX_OFFSET_OF(Bp::BroadPhasePair, mVolB));
+
+PxImmediateBroadPhase* immediate::PxCreateImmediateBroadPhase(const PxImmediateBroadPhaseDesc& desc)
+{
+	if(desc.type==PxBroadPhaseType::eGPU)
+	{
+		Ps::getFoundation().error(PxErrorCode::eINVALID_PARAMETER, __FILE__, __LINE__, "PxCreateImmediateBroadPhase: GPU broadphase is not supported.");
+		return NULL;
+	}
+
+	Bp::BroadPhase* bp = Bp::BroadPhase::create(desc.type, desc.maxNbRegions, desc.maxNbOverlaps, desc.maxNbStaticObjects, desc.maxNbDynamicObjects, desc.contextID);
+	if(!bp)
+		return NULL;
+
+	return PX_NEW(PxImmediateBroadPhase)(bp, desc);
+}
+
+void immediate::PxReleaseImmediateBroadPhase(PxImmediateBroadPhase* broadPhase)
+{
+	PX_DELETE(broadPhase);
+}
+
+PxU32 immediate::PxImmediateBroadPhaseAddRegion(PxImmediateBroadPhase* broadPhase, const PxBroadPhaseRegion& region)
+{
+	return broadPhase->addRegion(region);
+}
+
+PxU32 immediate::PxImmediateBroadPhaseAddBounds(PxImmediateBroadPhase* broadPhase, const PxBounds3& bounds, PxImmediateBroadPhaseObjectType::Enum type, PxU32 group, PxReal contactDistance)
+{
+	PX_ASSERT(group<0x3ffffffe);
+	return broadPhase->addBounds(bounds, type, group, contactDistance);
+}
+
+void immediate::PxImmediateBroadPhaseUpdateBounds(PxImmediateBroadPhase* broadPhase, PxU32 handle, const PxBounds3& bounds)
+{
+	broadPhase->updateBounds(handle, bounds);
+}
+
+void immediate::PxImmediateBroadPhaseRemoveBounds(PxImmediateBroadPhase* broadPhase, PxU32 handle)
+{
+	broadPhase->removeBounds(handle);
+}
+
+void immediate::PxImmediateBroadPhaseUpdate(PxImmediateBroadPhase* broadPhase)
+{
+	broadPhase->update();
+}
+
+PxU32 immediate::PxImmediateBroadPhaseGetCreatedPairs(PxImmediateBroadPhase* broadPhase, const PxImmediateBroadPhasePair*& pairs)
+{
+	return broadPhase->getCreatedPairs(pairs);
+}
+
+PxU32 immediate::PxImmediateBroadPhaseGetDeletedPairs(PxImmediateBroadPhase* broadPhase, const PxImmediateBroadPhasePair*& pairs)
+{
+	return broadPhase->getDeletedPairs(pairs);
+}
@@ -107,6 +107,10 @@ struct PxvSimStats
 	PxU32	mNbLostTouches;
 
 	PxU32	mNbPartitions;
+	PxReal	mPartitionTime;		// PT: in milliseconds, summed over islands
+
+	PxU32	mNbCCDPasses;		// PT: CCD passes that swept fast-moving pairs
+	PxU32	mNbCCDHits;			// PT: CCD pairs advanced to their TOI, summed over passes
 };
 
 }
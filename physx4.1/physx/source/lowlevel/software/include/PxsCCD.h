@@ -329,6 +329,19 @@ struct PxsCCDBlockArray
 	}
 };
 
+/**
+\brief The inputs of a generic AABB-vs-AABB sweep estimate, gathered so that several estimates can be swept at once
+*/
+struct PxsCCDAABBSweep
+{
+	PxVec3					mCenterA;				// Center of shape A's AABB at the start of the sweep
+	PxVec3					mExtentsA;				// Inflated extents of shape A's AABB
+	PxVec3					mCenterB;				// Center of shape B's AABB at the start of the sweep
+	PxVec3					mExtentsB;				// Inflated extents of shape B's AABB
+	PxVec3					mTrA;					// Translation of shape A over the sweep
+	PxVec3					mTrB;					// Translation of shape B over the sweep
+};
+
 /**
 \brief A structure to represent a potential CCD interaction between a pair of shapes
 */
@@ -386,6 +399,13 @@ struct PxsCCDPair
 	*/
 	PxReal	sweepEstimateToi(PxReal ccdThreshold);
 	/**
+	\brief Performs the pair-specific part of the sweep estimation for this pair
+	\param[in] ccdThreshold The CCD threshold
+	\param[out] sweep The AABB sweep to perform if the pair requires the generic prim-prim estimate
+	\return True if mMinToi already holds the estimate. False if the caller must run the AABB sweep and store its result in mMinToi.
+	*/
+	bool	sweepEstimateToiPrepare(PxReal ccdThreshold, PxsCCDAABBSweep& sweep);
+	/**
 	\brief Advances this pair to the TOI
 	\param[in] dt The time-step
 	\param[in] clipTrajectoryToToi Indicates whether we clip the body's trajectory to the end pose. Only done in the final pass
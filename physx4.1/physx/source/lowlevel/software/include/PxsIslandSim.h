@@ -52,6 +52,7 @@ namespace Sc
 	class ArticulationSim;
 }
 
+class PxCpuDispatcher;
 class PxsContactManager;
 class PxsRigidBody;
 
@@ -357,14 +358,14 @@ struct TraversalState
 
 struct QueueElement
 {
-	TraversalState* mState;
+	PxU32 mStateIndex;	//Index of the traversal state in the list of visited nodes
 	PxU32 mHopCount;
 
 	QueueElement()
 	{
 	}
 
-	QueueElement(TraversalState* state, PxU32 hopCount) : mState(state), mHopCount(hopCount)
+	QueueElement(PxU32 stateIndex, PxU32 hopCount) : mStateIndex(stateIndex), mHopCount(hopCount)
 	{
 	}
 };
@@ -383,6 +384,28 @@ private:
 	NodeComparator& operator = (const NodeComparator&);
 };
 
+//An island split off an existing island by the removal of edges. Islands found in parallel get their ids afterwards, in the order of their
+//root nodes, which is the order in which serial processing would have created them.
+struct IslandSplit
+{
+	Island mIsland;
+	PxU32 mStaticTouchCount;
+	bool mAwake;
+};
+
+//Transient data used for traversals. Dirty nodes of different islands can be processed in parallel, each chunk of islands with its own
+//traversal data.
+struct TraversalScratch
+{
+	Cm::PriorityQueue<QueueElement, NodeComparator> 
+		mPriorityQueue;										//! Priority queue used for graph traversal
+	Ps::Array<TraversalState> mVisitedNodes;				//! The list of nodes visited in the current traversal
+	Ps::Array<EdgeIndex> mIslandSplitEdges[Edge::eEDGE_TYPE_COUNT];
+	Ps::Array<IslandSplit> mIslandSplits;					//! Islands split off during the traversals, waiting for their ids
+};
+
+
+class DirtyIslandsJob;
 
 class IslandSim
 {
@@ -433,13 +456,12 @@ class IslandSim
 	Ps::Array<IslandId> mTempIslandIds;
 
 	
-	//Temporary, transient data used for traversals. TODO - move to PxsSimpleIslandManager. Or if we keep it here, we can 
-	//process multiple island simulations in parallel
-	Cm::PriorityQueue<QueueElement, NodeComparator> 
-		mPriorityQueue;										//! Priority queue used for graph traversal
-	Ps::Array<TraversalState> mVisitedNodes;				//! The list of nodes visited in the current traversal
-	Cm::BitMap mVisitedState;								//! Indicates whether a node has been visited
-	Ps::Array<EdgeIndex> mIslandSplitEdges[Edge::eEDGE_TYPE_COUNT];
+	//Temporary, transient data used for traversals. TODO - move to PxsSimpleIslandManager.
+	TraversalScratch mTraversalScratch;						//! Traversal data of serial processing
+	Ps::Array<TraversalScratch*> mParallelTraversalScratch;	//! Traversal data of the chunks of islands processed in parallel
+	Ps::Array<PxU8> mVisitedState;							//! Indicates whether a node has been visited. A byte per node so that islands can be processed in parallel.
+	Ps::Array<PxU64> mDirtyIslandNodes;						//! Dirty nodes keyed and sorted by island, for parallel processing
+	Ps::Array<PxU32> mDirtyIslandStarts;					//! Start of the dirty nodes of each island in mDirtyIslandNodes
 
 	Ps::Array<EdgeIndex> mDeactivatingEdges[Edge::eEDGE_TYPE_COUNT];
 
@@ -454,7 +476,7 @@ class IslandSim
 public:
 
 	IslandSim(Ps::Array<PartitionEdge*>* firstPartitionEdges, Cm::BlockArray<NodeIndex>& edgeNodeIndices, Ps::Array<PartitionEdge*>* destroyedPartitionEdges, PxU64 contextID);
-	~IslandSim() {}
+	~IslandSim();
 
 	void resize(const PxU32 nbNodes, const PxU32 nbContactManagers, const PxU32 nbConstraints);
 
@@ -470,6 +492,15 @@ public:
 	void deactivateNode(NodeIndex index);
 	void putNodeToSleep(NodeIndex index);
 
+	// Same as activateNode() for a node that is already active or activating. Only the node is touched, so this can run for different nodes in parallel.
+	PX_FORCE_INLINE void reactivateNode(NodeIndex index)
+	{
+		Node& node = mNodes[index.index()];
+		PX_ASSERT(node.isActiveOrActivating());
+		node.clearIsReadyForSleeping();
+		node.clearDeactivating();
+	}
+
 	void removeConnection(EdgeIndex edgeIndex);
 
 	PX_FORCE_INLINE PxU32 getNbNodes() const { return mNodes.size(); }
@@ -587,7 +618,14 @@ private:
 	void wakeIslands();
 	void wakeIslands2();
 	void processNewEdges();
-	void processLostEdges(Ps::Array<NodeIndex>& destroyedNodes, bool allowDeactivation, bool permitKinematicDeactivation, PxU32 dirtyNodeLimit);
+	void processLostEdges(Ps::Array<NodeIndex>& destroyedNodes, bool allowDeactivation, bool permitKinematicDeactivation, PxU32 dirtyNodeLimit,
+		PxCpuDispatcher* dispatcher);
+
+	//Looks for the island root from a dirty node and splits the island if the root cannot be found. Can run in parallel for nodes of different islands.
+	void processDirtyNode(NodeIndex dirtyNodeIndex, TraversalScratch& scratch);
+	void processDirtyIslands(PxU32 startIsland, PxU32 endIsland, TraversalScratch& scratch);
+	void processDirtyNodesParallel(PxCpuDispatcher& dispatcher);
+	void createSplitIslands(TraversalScratch*const* scratches, PxU32 nbScratches);
 
 	void removeConnectionInternal(EdgeIndex edgeIndex);
 
@@ -607,7 +645,9 @@ private:
 	IslandSim& operator = (const IslandSim&);
 	IslandSim(const IslandSim&);
 
-	void unwindRoute(PxU32 traversalIndex, NodeIndex lastNode, PxU32 hopCount, IslandId id);
+	friend class DirtyIslandsJob;
+
+	void unwindRoute(PxU32 traversalIndex, NodeIndex lastNode, PxU32 hopCount, IslandId id, TraversalScratch& scratch);
 
 	void activateIsland(IslandId island);
 
@@ -615,9 +655,9 @@ private:
 
 	bool canFindRoot(NodeIndex startNode, NodeIndex targetNode, Ps::Array<NodeIndex>* visitedNodes);
 
-	bool tryFastPath(NodeIndex startNode, NodeIndex targetNode, IslandId islandId);
+	bool tryFastPath(NodeIndex startNode, NodeIndex targetNode, IslandId islandId, TraversalScratch& scratch);
 
-	bool findRoute(NodeIndex startNode, NodeIndex targetNode, IslandId islandId);
+	bool findRoute(NodeIndex startNode, NodeIndex targetNode, IslandId islandId, TraversalScratch& scratch);
 
 	bool isPathTo(NodeIndex startNode, NodeIndex targetNode);
 
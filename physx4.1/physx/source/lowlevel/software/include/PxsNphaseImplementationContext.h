@@ -117,6 +117,15 @@ public:
 	void						processContactManagerSecondPass(PxReal dt, PxBaseTask* continuation);
 	void						fetchUpdateContactManager() {}
 
+	// Returns the narrow phase cache of a registered contact manager, from either the active or the new pairs
+	PX_FORCE_INLINE	Gu::Cache&	getContactManagerCache(PxU32 npIndex)
+	{
+		PX_ASSERT(npIndex != 0xFFffFFff);
+		if(npIndex & PxsContactManagerBase::NEW_CONTACT_MANAGER_MASK)
+			return mNewNarrowPhasePairs.mCaches[PxsContactManagerBase::computeIndexFromId(npIndex & (~PxsContactManagerBase::NEW_CONTACT_MANAGER_MASK))];
+		return mNarrowPhasePairs.mCaches[PxsContactManagerBase::computeIndexFromId(npIndex)];
+	}
+
 	
 
 	void						startNarrowPhaseTasks() {}
@@ -139,12 +139,24 @@ public:
 	void deactivateNode(NodeIndex index);
 	void putNodeToSleep(NodeIndex index);
 
+	// Same as activateNode() for a node that is active or activating in both island sims, see IslandSim::reactivateNode(). Returns false and
+	// does nothing otherwise.
+	PX_FORCE_INLINE bool reactivateNode(NodeIndex index)
+	{
+		if(!index.isValid() || !mIslandManager.getNode(index).isActiveOrActivating() || !mSpeculativeIslandManager.getNode(index).isActiveOrActivating())
+			return false;
+		mIslandManager.reactivateNode(index);
+		mSpeculativeIslandManager.reactivateNode(index);
+		return true;
+	}
+
 	void removeConnection(EdgeIndex edgeIndex);
 	
 	void firstPassIslandGen();
 	void additionalSpeculativeActivation();
 	void secondPassIslandGen();
 	void thirdPassIslandGen(PxBaseTask* continuation);
+	void thirdPassIslandGenImmediate();	// runs the third pass on the calling thread, outside of a simulation step
 
 	void clearDestroyedEdges();
 
@@ -492,7 +492,7 @@ void PxsCCDPair::updateShapes()
 	}
 }
 
-PxReal PxsCCDPair::sweepEstimateToi(PxReal ccdThreshold)
+bool PxsCCDPair::sweepEstimateToiPrepare(PxReal ccdThreshold, PxsCCDAABBSweep& sweep)
 {
 	//Update shape transforms if necessary
 	updateShapes();
@@ -544,7 +544,7 @@ PxReal PxsCCDPair::sweepEstimateToi(PxReal ccdThreshold)
 	{
 		mToiType = eEstimate;
 		mMinToi = PX_MAX_REAL;
-		return PX_MAX_REAL;
+		return true;
 	}
 
 	//Otherwise, the objects *are* moving fast-enough so perform estimation pass
@@ -554,7 +554,7 @@ PxReal PxsCCDPair::sweepEstimateToi(PxReal ccdThreshold)
 		PxF32 toi = Gu::SweepEstimateAnyShapeMesh(*ccdShape0, *ccdShape1, tm0, tm1, lastTm0, lastTm1, restDistance, sumFastMovingThresh);
 									
 		mMinToi	= toi;
-		return toi;
+		return true;
 	}
 	else if (g1 == PxGeometryType::eHEIGHTFIELD)
 	{
@@ -562,21 +562,27 @@ PxReal PxsCCDPair::sweepEstimateToi(PxReal ccdThreshold)
 		PxF32 toi = Gu::SweepEstimateAnyShapeHeightfield(*ccdShape0, *ccdShape1, tm0, tm1, lastTm0, lastTm1, restDistance, sumFastMovingThresh);
 									
 		mMinToi	= toi;
-		return toi;
+		return true;
 	}
 
-	//Generic estimation code for prim-prim sweeps
-	PxVec3 centreA, extentsA;
-	PxVec3 centreB, extentsB;
-	centreA = ccdShape0->mCenter;
-	extentsA = ccdShape0->mExtents + PxVec3(restDistance);
+	//Generic estimation code for prim-prim sweeps. The sweep itself is left to the caller so that it can be batched.
+	sweep.mCenterA = ccdShape0->mCenter;
+	sweep.mExtentsA = (ccdShape0->mExtents + PxVec3(restDistance)) * 1.1f;
 
-	centreB = ccdShape1->mCenter;
-	extentsB = ccdShape1->mExtents;
+	sweep.mCenterB = ccdShape1->mCenter;
+	sweep.mExtentsB = ccdShape1->mExtents * 1.1f;
 
-	PxF32 toi = Gu::sweepAABBAABB(centreA, extentsA * 1.1f, centreB, extentsB * 1.1f, trA, trB);
-	mMinToi			= toi;
-	return toi;
+	sweep.mTrA = trA;
+	sweep.mTrB = trB;
+	return false;
+}
+
+PxReal PxsCCDPair::sweepEstimateToi(PxReal ccdThreshold)
+{
+	PxsCCDAABBSweep sweep;
+	if(!sweepEstimateToiPrepare(ccdThreshold, sweep))
+		mMinToi = Gu::sweepAABBAABB(sweep.mCenterA, sweep.mExtentsA, sweep.mCenterB, sweep.mExtentsB, sweep.mTrA, sweep.mTrB);
+	return mMinToi;
 }
 
 bool PxsCCDPair::sweepAdvanceToToi(PxReal dt, bool clipTrajectoryToToi)
@@ -866,6 +872,90 @@ struct ToiPtrCompare
 	}
 };
 
+// --------------------------------------------------------------
+/**
+\brief Gathers the generic AABB sweep estimates of up to 4 pairs and runs them at once with Gu::sweepAABBAABB4
+*/
+class PxsCCDAABBSweepBatch
+{
+public:
+	PxsCCDAABBSweepBatch() : mNbPairs(0)	{}
+
+	PX_FORCE_INLINE void add(PxsCCDPair* pair, const PxsCCDAABBSweep& sweep)
+	{
+		const PxU32 lane = mNbPairs;
+		writeLane(mCenterA, sweep.mCenterA, lane);
+		writeLane(mExtentsA, sweep.mExtentsA, lane);
+		writeLane(mCenterB, sweep.mCenterB, lane);
+		writeLane(mExtentsB, sweep.mExtentsB, lane);
+		writeLane(mTrA, sweep.mTrA, lane);
+		writeLane(mTrB, sweep.mTrB, lane);
+		mPairs[lane] = pair;
+
+		if(++mNbPairs == 4)
+			flush();
+	}
+
+	void flush()
+	{
+		using namespace Ps::aos;
+
+		const PxU32 nbPairs = mNbPairs;
+		if(!nbPairs)
+			return;
+
+		// PT: unused lanes replicate the first one, so that they only ever contain valid inputs
+		for(PxU32 lane = nbPairs; lane < 4; lane++)
+		{
+			for(PxU32 a = 0; a < 3; a++)
+			{
+				mCenterA[a][lane] = mCenterA[a][0];
+				mExtentsA[a][lane] = mExtentsA[a][0];
+				mCenterB[a][lane] = mCenterB[a][0];
+				mExtentsB[a][lane] = mExtentsB[a][0];
+				mTrA[a][lane] = mTrA[a][0];
+				mTrB[a][lane] = mTrB[a][0];
+			}
+		}
+
+		Vec4V centerA[3], extentsA[3], centerB[3], extentsB[3], trA[3], trB[3];
+		for(PxU32 a = 0; a < 3; a++)
+		{
+			centerA[a] = V4LoadA(mCenterA[a]);
+			extentsA[a] = V4LoadA(mExtentsA[a]);
+			centerB[a] = V4LoadA(mCenterB[a]);
+			extentsB[a] = V4LoadA(mExtentsB[a]);
+			trA[a] = V4LoadA(mTrA[a]);
+			trB[a] = V4LoadA(mTrB[a]);
+		}
+
+		PX_ALIGN(16, PxReal tois[4]);
+		V4StoreA(Gu::sweepAABBAABB4(centerA, extentsA, centerB, extentsB, trA, trB), tois);
+
+		for(PxU32 lane = 0; lane < nbPairs; lane++)
+			mPairs[lane]->mMinToi = tois[lane];
+
+		mNbPairs = 0;
+	}
+
+private:
+	static PX_FORCE_INLINE void writeLane(PxReal (&dst)[3][4], const PxVec3& v, PxU32 lane)
+	{
+		dst[0][lane] = v.x;
+		dst[1][lane] = v.y;
+		dst[2][lane] = v.z;
+	}
+
+	PX_ALIGN(16, PxReal mCenterA[3][4]);
+	PX_ALIGN(16, PxReal mExtentsA[3][4]);
+	PX_ALIGN(16, PxReal mCenterB[3][4]);
+	PX_ALIGN(16, PxReal mExtentsB[3][4]);
+	PX_ALIGN(16, PxReal mTrA[3][4]);
+	PX_ALIGN(16, PxReal mTrB[3][4]);
+	PxsCCDPair*		mPairs[4];
+	PxU32			mNbPairs;
+};
+
 // --------------------------------------------------------------
 /**
 \brief Class to perform a set of sweep estimate tasks
@@ -884,12 +974,17 @@ public:
 
 	virtual void runInternal()
 	{
+		// PT: mesh & heightfield estimates are computed immediately, the generic AABB sweeps are batched 4 at a time
+		PxsCCDAABBSweepBatch batch;
 		for (PxU32 j = 0; j < mNumPairs; j++)
 		{
 			PxsCCDPair& pair = *mPairs[j];
-			pair.sweepEstimateToi(mCCDThreshold);
+			PxsCCDAABBSweep sweep;
+			if(!pair.sweepEstimateToiPrepare(mCCDThreshold, sweep))
+				batch.add(&pair, sweep);
 			pair.mEstimatePass = 0;
 		}
+		batch.flush();
 	}
 
 	virtual const char *getName() const
@@ -903,6 +998,10 @@ private:
 
 #define ENABLE_RESWEEP 1
 
+// PT: granularity of the sweep & advance tasks
+#define PXS_CCD_BATCHES_PER_THREAD	4
+#define PXS_CCD_MIN_PAIRS_PER_BATCH	8
+
 // --------------------------------------------------------------
 /**
 \brief Class to advance a set of islands
@@ -1584,6 +1683,10 @@ void PxsCCDContext::updateCCD(PxReal dt, PxBaseTask* continuation, IG::IslandSim
 		}
 	}
 
+#if PX_ENABLE_SIM_STATS
+	mContext->mSimStats.mNbCCDPasses++;
+#endif
+
 	//Create the pair pointer buffer. This is a flattened array of pointers to pairs. It is used to sort the pairs
 	//into islands and is also used to prioritize the pairs into their TOIs
 	{
@@ -1735,7 +1838,8 @@ void PxsCCDContext::updateCCD(PxReal dt, PxBaseTask* continuation, IG::IslandSim
 	// sweep all CCD pairs
 	const PxU32 nPairs = mCCDPtrPairs.size();
 	const PxU32 numThreads = PxMax(1u, mContext->mTaskManager->getCpuDispatcher()->getWorkerCount()); PX_ASSERT(numThreads > 0);
-	mCCDPairsPerBatch = PxMax<PxU32>((nPairs)/numThreads, 1);
+	// PT: several batches per thread, so that a few expensive pairs or islands don't leave the other threads idle
+	mCCDPairsPerBatch = PxMax<PxU32>((nPairs)/(numThreads*PXS_CCD_BATCHES_PER_THREAD), PXS_CCD_MIN_PAIRS_PER_BATCH);
 
 	for (PxU32 batchBegin = 0; batchBegin < nPairs; batchBegin += mCCDPairsPerBatch)
 	{
@@ -1955,6 +2059,10 @@ void PxsCCDContext::postCCDDepenetrate(PxBaseTask* /*continuation*/)
 
 	mCCDOverlaps.clear_NoDelete();
 
+#if PX_ENABLE_SIM_STATS
+	mContext->mSimStats.mNbCCDHits += PxU32(mSweepTotalHits);
+#endif
+
 	updateCCDEnd();
 
 	mContext->putNpThreadContext(mCCDThreadContext);
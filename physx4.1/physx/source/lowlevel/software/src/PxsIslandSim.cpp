@@ -28,6 +28,7 @@
 // Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
 
 #include "PxsIslandSim.h"
+#include "CmChunkedJob.h"
 #include "PsSort.h"
 #include "PsUtilities.h"
 #include "common/PxProfileZone.h"
@@ -54,7 +55,6 @@ namespace IG
 		mActivatingNodes(PX_DEBUG_EXP("IslandSim::mActivatingNodes")),
 		mDestroyedEdges(PX_DEBUG_EXP("IslandSim::mDestroyedEdges")),
 		mTempIslandIds(PX_DEBUG_EXP("IslandSim::mTempIslandIds")),
-		mVisitedNodes(PX_DEBUG_EXP("IslandSim::mVisitedNodes")),
 		mFirstPartitionEdges(firstPartitionEdges),
 		mEdgeNodeIndices(edgeNodeIndices),
 		mDestroyedPartitionEdges(destroyedPartitionEdges),
@@ -64,6 +64,12 @@ namespace IG
 		mActiveEdgeCount[0] = mActiveEdgeCount[1] = 0;
 	}
 
+	IslandSim::~IslandSim()
+	{
+		for(PxU32 a = 0; a < mParallelTraversalScratch.size(); ++a)
+			PX_DELETE(mParallelTraversalScratch[a]);
+	}
+
 #if PX_ENABLE_ASSERTS
 template <typename Thing>
 static bool contains(Ps::Array<Thing>& arr, const Thing& thing)
@@ -621,7 +627,7 @@ bool IslandSim::canFindRoot(NodeIndex startNode, NodeIndex targetNode, Ps::Array
 
 
 
-void IslandSim::unwindRoute(PxU32 traversalIndex, NodeIndex lastNode, PxU32 hopCount, IslandId id)
+void IslandSim::unwindRoute(PxU32 traversalIndex, NodeIndex lastNode, PxU32 hopCount, IslandId id, TraversalScratch& scratch)
 {
 	//We have found either a witness *or* the root node with this traversal. In the event of finding the root node, hopCount will be 0. In the event of finding
 	//a witness, hopCount will be the hopCount that witness reported as being the distance to the root.
@@ -630,7 +636,7 @@ void IslandSim::unwindRoute(PxU32 traversalIndex, NodeIndex lastNode, PxU32 hopC
 	PxU32 hc = hopCount+1; //Add on 1 for the hop to the witness/root node.
 	do
 	{
-		TraversalState& state = mVisitedNodes[currIndex];
+		TraversalState& state = scratch.mVisitedNodes[currIndex];
 		mHopCounts[state.mNodeIndex.index()] = hc++;
 		mIslandIds[state.mNodeIndex.index()] = id;
 		mFastRoute[state.mNodeIndex.index()] = lastNode;
@@ -1170,14 +1176,15 @@ bool IslandSim::isPathTo(NodeIndex startNode, NodeIndex targetNode)
 	return false;
 }
 
-bool IslandSim::tryFastPath(NodeIndex startNode, NodeIndex targetNode, IslandId islandId)
+bool IslandSim::tryFastPath(NodeIndex startNode, NodeIndex targetNode, IslandId islandId, TraversalScratch& scratch)
 {
 	PX_UNUSED(startNode);
 	PX_UNUSED(targetNode);
 
 	NodeIndex currentNode = startNode;
 
-	PxU32 currentVisitedNodes = mVisitedNodes.size();
+	Ps::Array<TraversalState>& visitedNodes = scratch.mVisitedNodes;
+	PxU32 currentVisitedNodes = visitedNodes.size();
 
 	PxU32 depth = 0;
 	
@@ -1186,7 +1193,7 @@ bool IslandSim::tryFastPath(NodeIndex startNode, NodeIndex targetNode, IslandId
 	{
 		//Get the fast path from this node...
 		
-		if(mVisitedState.test(currentNode.index()))
+		if(mVisitedState[currentNode.index()])
 		{
 			found = mIslandIds[currentNode.index()] != IG_INVALID_ISLAND; //Already visited and not tagged with invalid island == a witness!
 			break;
@@ -1197,38 +1204,38 @@ bool IslandSim::tryFastPath(NodeIndex startNode, NodeIndex targetNode, IslandId
 			break;
 		}
 
-		mVisitedNodes.pushBack(TraversalState(currentNode, mVisitedNodes.size(), mVisitedNodes.size()-1, depth++));
+		visitedNodes.pushBack(TraversalState(currentNode, visitedNodes.size(), visitedNodes.size()-1, depth++));
 
 		PX_ASSERT(mFastRoute[currentNode.index()].index() == IG_INVALID_NODE || isPathTo(currentNode, mFastRoute[currentNode.index()]));
 
 		mIslandIds[currentNode.index()] = IG_INVALID_ISLAND;
-		mVisitedState.set(currentNode.index());
+		mVisitedState[currentNode.index()] = 1;
 
 		currentNode = mFastRoute[currentNode.index()];
 	}
 	while(currentNode.index() != IG_INVALID_NODE);
 
-	for(PxU32 a = currentVisitedNodes; a < mVisitedNodes.size(); ++a)
+	for(PxU32 a = currentVisitedNodes; a < visitedNodes.size(); ++a)
 	{
-		TraversalState& state = mVisitedNodes[a];
+		TraversalState& state = visitedNodes[a];
 		mIslandIds[state.mNodeIndex.index()] = islandId;
 	}
 
 	if(!found)
 	{
-		for(PxU32 a = currentVisitedNodes; a < mVisitedNodes.size(); ++a)
+		for(PxU32 a = currentVisitedNodes; a < visitedNodes.size(); ++a)
 		{
-			TraversalState& state = mVisitedNodes[a];
-			mVisitedState.reset(state.mNodeIndex.index());
+			TraversalState& state = visitedNodes[a];
+			mVisitedState[state.mNodeIndex.index()] = 0;
 		}
 
-		mVisitedNodes.forceSize_Unsafe(currentVisitedNodes);
+		visitedNodes.forceSize_Unsafe(currentVisitedNodes);
 	}
 	return found;
 
 }
 
-bool IslandSim::findRoute(NodeIndex startNode, NodeIndex targetNode, IslandId islandId)
+bool IslandSim::findRoute(NodeIndex startNode, NodeIndex targetNode, IslandId islandId, TraversalScratch& scratch)
 {
 
 	//Firstly, traverse the fast path and tag up witnesses. TryFastPath can fail. In that case, no witnesses are left but this node is permitted to report
@@ -1236,7 +1243,7 @@ bool IslandSim::findRoute(NodeIndex startNode, NodeIndex targetNode, IslandId is
 	//and tagging up the visited nodes
 	if(mFastRoute[startNode.index()].index() != IG_INVALID_NODE)
 	{
-		if(tryFastPath(startNode, targetNode, islandId))
+		if(tryFastPath(startNode, targetNode, islandId, scratch))
 			return true;
 
 		//Try fast path can either be successful or not. If it was successful, then we had a valid fast path cached and all nodes on that fast path were tagged
@@ -1253,17 +1260,22 @@ bool IslandSim::findRoute(NodeIndex startNode, NodeIndex targetNode, IslandId is
 		//These are per-node counts that indicate the expected number of hops from this node to the root node. These are lazily evaluated and updated
 		//as new edges are formed or when traversals occur to re-establish islands. As a result, they may be inaccurate but they still serve the purpose
 		//of guiding our search to minimize the chances of us doing an exhaustive search to find the root node.
+		Ps::Array<TraversalState>& visitedNodes = scratch.mVisitedNodes;
+		Cm::PriorityQueue<QueueElement, NodeComparator>& priorityQueue = scratch.mPriorityQueue;
+
 		mIslandIds[startNode.index()] = IG_INVALID_ISLAND;
-		TraversalState* startTraversal = &mVisitedNodes.pushBack(TraversalState(startNode, mVisitedNodes.size(), IG_INVALID_NODE, 0));
-		mVisitedState.set(startNode.index());
-		QueueElement element(startTraversal, mHopCounts[startNode.index()]);
-		mPriorityQueue.push(element);
+		const PxU32 startIndex = visitedNodes.size();
+		visitedNodes.pushBack(TraversalState(startNode, startIndex, IG_INVALID_NODE, 0));
+		mVisitedState[startNode.index()] = 1;
+		QueueElement element(startIndex, mHopCounts[startNode.index()]);
+		priorityQueue.push(element);
 
 		do
 		{
-			QueueElement currentQE = mPriorityQueue.pop();
+			QueueElement currentQE = priorityQueue.pop();
 
-			TraversalState& currentState = *currentQE.mState;
+			//Copy, the list of visited nodes can grow below
+			const TraversalState currentState = visitedNodes[currentQE.mStateIndex];
 
 			Node& currentNode = mNodes[currentState.mNodeIndex.index()];
 
@@ -1280,11 +1292,11 @@ bool IslandSim::findRoute(NodeIndex startNode, NodeIndex targetNode, IslandId is
 					{
 						if(nextIndex.index() == targetNode.index())
 						{
-							unwindRoute(currentState.mCurrentIndex, nextIndex, 0, islandId);
+							unwindRoute(currentState.mCurrentIndex, nextIndex, 0, islandId, scratch);
 							return true;
 						}
 
-						if(mVisitedState.test(nextIndex.index()))
+						if(mVisitedState[nextIndex.index()])
 						{
 							//We already visited this node. This means that it's either in the priority queue already or we 
 							//visited in on a previous pass. If it was visited on a previous pass, then it already knows what island it's in. 
@@ -1298,17 +1310,18 @@ bool IslandSim::findRoute(NodeIndex startNode, NodeIndex targetNode, IslandId is
 								//because that would caused me to have been visited already because totally separate islands trigger a full traversal on 
 								//the orphaned side.
 								PX_ASSERT(visitedIslandId == islandId);
-								unwindRoute(currentState.mCurrentIndex, nextIndex, mHopCounts[nextIndex.index()], islandId);
+								unwindRoute(currentState.mCurrentIndex, nextIndex, mHopCounts[nextIndex.index()], islandId, scratch);
 								return true;
 							}
 						}
 						else
 						{
 							//This node has not been visited yet, so we need to push it into the stack and continue traversing
-							TraversalState* state = &mVisitedNodes.pushBack(TraversalState(nextIndex, mVisitedNodes.size(), currentState.mCurrentIndex, currentState.mDepth+1));
-							QueueElement qe(state, mHopCounts[nextIndex.index()]);
-							mPriorityQueue.push(qe);
-							mVisitedState.set(nextIndex.index());
+							const PxU32 stateIndex = visitedNodes.size();
+							visitedNodes.pushBack(TraversalState(nextIndex, stateIndex, currentState.mCurrentIndex, currentState.mDepth+1));
+							QueueElement qe(stateIndex, mHopCounts[nextIndex.index()]);
+							priorityQueue.push(qe);
+							mVisitedState[nextIndex.index()] = 1;
 							PX_ASSERT(mIslandIds[nextIndex.index()] == islandId);
 							mIslandIds[nextIndex.index()] = IG_INVALID_ISLAND; //Flag as invalid island until we know whether we can find root or an island id.
 						}
@@ -1318,7 +1331,7 @@ bool IslandSim::findRoute(NodeIndex startNode, NodeIndex targetNode, IslandId is
 				edge = instance.mNextEdge;
 			}
 		}
-		while(mPriorityQueue.size());
+		while(priorityQueue.size());
 
 		return false;
 	}
@@ -1327,23 +1340,397 @@ bool IslandSim::findRoute(NodeIndex startNode, NodeIndex targetNode, IslandId is
 #define IG_LIMIT_DIRTY_NODES 0
 
 
+void IslandSim::processDirtyNode(NodeIndex dirtyNodeIndex, TraversalScratch& scratch)
+{
+	//Process dirty nodes. Figure out if we can make our way from the dirty node to the root.
+
+	Ps::Array<TraversalState>& visitedNodes = scratch.mVisitedNodes;
+
+	scratch.mPriorityQueue.clear(); //Clear the queue used for traversal
+	visitedNodes.forceSize_Unsafe(0); //Clear the list of nodes in this island
+	Node& dirtyNode = mNodes[dirtyNodeIndex.index()];
+
+	//Check whether this node has already been touched. If it has been touched this frame, then its island state is reliable 
+	//and we can just unclear the dirty flag on the body. If we were already visited, then the state should have already been confirmed in a 
+	//previous pass.
+	if (!dirtyNode.isKinematic() && !dirtyNode.isDeleted() && !mVisitedState[dirtyNodeIndex.index()])
+	{
+		//We haven't visited this node in our island repair passes yet, so we still need to process until we've hit a visited node or found
+		//our root node. Note that, as soon as we hit a visited node that has already been processed in a previous pass, we know that we can rely
+		//on its island information although the hop counts may not be optimal. It also indicates that this island was not broken immediately because
+		//otherwise, the entire new sub-island would already have been visited and this node would have already had its new island state assigned.
+
+		//Indicate that I've been visited
+
+		IslandId islandId = mIslandIds[dirtyNodeIndex.index()];
+		Island& findIsland = mIslands[islandId];
+
+		NodeIndex searchNode = findIsland.mRootNode;//The node that we're searching for!
+
+		if (searchNode.index() != dirtyNodeIndex.index()) //If we are the root node, we don't need to do anything!
+		{
+			if (findRoute(dirtyNodeIndex, searchNode, islandId, scratch))
+			{
+				//We found the root node so let's let every visited node know that we found its root
+				//and we can also update our hop counts because we recorded how many hops it took to reach this
+				//node
+
+				//We already filled in the path to the root/witness with accurate hop counts. Now we just need to fill in the estimates
+				//for the remaining nodes and re-define their islandIds. We approximate their path to the root by just routing them through
+				//the route we already found.
+
+				//This loop works because mVisitedNodes are recorded in the order they were visited and we already filled in the critical path
+				//so the remainder of the paths will just fork from that path.
+
+				//Verify state (that we can see the root from this node)...
+
+#if IG_SANITY_CHECKS
+				PX_ASSERT(canFindRoot(dirtyNode, searchNode, NULL)); //Verify that we found the connection
+#endif
+
+				for (PxU32 b = 0; b < visitedNodes.size(); ++b)
+				{
+					TraversalState& state = visitedNodes[b];
+					if (mIslandIds[state.mNodeIndex.index()] == IG_INVALID_ISLAND)
+					{
+						mHopCounts[state.mNodeIndex.index()] = mHopCounts[visitedNodes[state.mPrevIndex].mNodeIndex.index()] + 1;
+						mFastRoute[state.mNodeIndex.index()] = visitedNodes[state.mPrevIndex].mNodeIndex;
+						mIslandIds[state.mNodeIndex.index()] = islandId;
+					}
+				}
+			}
+			else
+			{
+				//If I traversed and could not find the root node, then I have established a new island. In this island, I am the root node
+				//and I will point all my nodes towards me. Furthermore, I have established how many steps it took to reach all nodes in my island
+
+				//OK. We need to separate the islands. We have a list of nodes that are part of the new island (mVisitedNodes) and we know that the 
+				//first node in that list is the root node.
+
+
+				//OK, we need to remove all these actors from their current island, then add them to the new island...
+
+				Island& oldIsland = mIslands[islandId];
+				//We can just unpick these nodes from the island because they do not contain the root node (if they did, then we wouldn't be
+				//removing this node from the island at all). The only challenge is if we need to remove the last node. In that case
+				//we need to re-establish the new last node in the island but perhaps the simplest way to do that would be to traverse
+				//the island to establish the last node again
+
+#if IG_SANITY_CHECKS
+				PX_ASSERT(!canFindRoot(dirtyNode, searchNode, NULL));
+#endif
+
+				PxU32 totalStaticTouchCount = 0;
+				scratch.mIslandSplitEdges[0].forceSize_Unsafe(0);
+				scratch.mIslandSplitEdges[1].forceSize_Unsafe(0);
+				PxU32 size[2] = { 0,0 };
+
+				//NodeIndex lastIndex = oldIsland.mLastNode;
+
+				//size[node.mType] = 1;
+
+				for (PxU32 a = 0; a < visitedNodes.size(); ++a)
+				{
+					NodeIndex index = visitedNodes[a].mNodeIndex;
+					Node& node = mNodes[index.index()];
+
+					if (node.mNextNode.index() != IG_INVALID_NODE)
+						mNodes[node.mNextNode.index()].mPrevNode = node.mPrevNode;
+					else
+						oldIsland.mLastNode = node.mPrevNode;
+					if (node.mPrevNode.index() != IG_INVALID_NODE)
+						mNodes[node.mPrevNode.index()].mNextNode = node.mNextNode;
+
+					size[node.mType]++;
+
+					node.mNextNode.setIndices(IG_INVALID_NODE);
+					node.mPrevNode.setIndices(IG_INVALID_NODE);
+
+					PX_ASSERT(mNodes[oldIsland.mLastNode.index()].mNextNode.index() == IG_INVALID_NODE);
+
+					totalStaticTouchCount += node.mStaticTouchCount;
+
+					EdgeInstanceIndex idx = node.mFirstEdgeIndex;
+
+					while (idx != IG_INVALID_EDGE)
+					{
+						EdgeInstance& instance = mEdgeInstances[idx];
+						const EdgeIndex edgeIndex = idx / 2;
+						Edge& edge = mEdges[edgeIndex];
+
+						//Only split the island if we're processing the first node or if the first node is infinte-mass
+						if (!(idx & 1) || (mEdgeNodeIndices[idx & (~1)].index() == IG_INVALID_NODE || mNodes[mEdgeNodeIndices[idx & (~1)].index()].isKinematic()))
+						{
+							//We will remove this edge from the island...
+							scratch.mIslandSplitEdges[edge.mEdgeType].pushBack(edgeIndex);
+
+							removeEdgeFromIsland(oldIsland, edgeIndex);
+
+						}
+						idx = instance.mNextEdge;
+					}
+
+				}
+
+				//oldIsland.mStaticTouchCount -= totalStaticTouchCount;
+				mIslandStaticTouchCount[islandId] -= totalStaticTouchCount;
+
+				oldIsland.mSize[0] -= size[0];
+				oldIsland.mSize[1] -= size[1];
+
+				//Now add all these nodes to the new island
+
+				//(1) Create the new island. Its handle is allocated later, in createSplitIslands, so that dirty nodes of different
+				//islands can be processed in parallel. Until then, the moved nodes keep a valid placeholder island id, which is
+				//all the traversals of subsequent dirty nodes need to know.
+				IslandSplit& split = scratch.mIslandSplits.insert();
+				Island& newIsland = split.mIsland;
+				split.mAwake = mIslandAwake.test(islandId); //Separated island, so it should be awake if the original island was
+
+				newIsland.mRootNode = dirtyNodeIndex;
+				mHopCounts[dirtyNodeIndex.index()] = 0;
+				mIslandIds[dirtyNodeIndex.index()] = islandId;
+				//newIsland.mTotalSize = visitedNodes.size();
+
+				mNodes[dirtyNodeIndex.index()].mPrevNode.setIndices(IG_INVALID_NODE); //First node so doesn't have a preceding node
+				mFastRoute[dirtyNodeIndex.index()].setIndices(IG_INVALID_NODE);
+
+				size[0] = 0; size[1] = 0;
+
+				size[dirtyNode.mType] = 1;
+
+				for (PxU32 a = 1; a < visitedNodes.size(); ++a)
+				{
+					NodeIndex index = visitedNodes[a].mNodeIndex;
+					Node& thisNode = mNodes[index.index()];
+					NodeIndex prevNodeIndex = visitedNodes[a - 1].mNodeIndex;
+					thisNode.mPrevNode = prevNodeIndex;
+					mNodes[prevNodeIndex.index()].mNextNode = index;
+					size[thisNode.mType]++;
+					mIslandIds[index.index()] = islandId;
+					mHopCounts[index.index()] = visitedNodes[a].mDepth; //How many hops to root
+					mFastRoute[index.index()] = visitedNodes[visitedNodes[a].mPrevIndex].mNodeIndex;
+				}
+
+				//Last node in the island
+				NodeIndex lastIndex = visitedNodes[visitedNodes.size() - 1].mNodeIndex;
+				mNodes[lastIndex.index()].mNextNode.setIndices(IG_INVALID_NODE);
+				newIsland.mLastNode = lastIndex;
+				split.mStaticTouchCount = totalStaticTouchCount;
+				newIsland.mSize[0] = size[0];
+				newIsland.mSize[1] = size[1];
+
+				PX_ASSERT(mNodes[newIsland.mLastNode.index()].mNextNode.index() == IG_INVALID_NODE);
+
+				for (PxU32 j = 0; j < 2; ++j)
+				{
+					Ps::Array<EdgeIndex>& splitEdges = scratch.mIslandSplitEdges[j];
+					const PxU32 splitEdgeSize = splitEdges.size();
+					if (splitEdgeSize)
+					{
+						splitEdges.pushBack(IG_INVALID_EDGE); //Push in a dummy invalid edge to complete the connectivity
+						mEdges[splitEdges[0]].mNextIslandEdge = splitEdges[1];
+						for (PxU32 a = 1; a < splitEdgeSize; ++a)
+						{
+							EdgeIndex edgeIndex = splitEdges[a];
+							Edge& edge = mEdges[edgeIndex];
+							edge.mNextIslandEdge = splitEdges[a + 1];
+							edge.mPrevIslandEdge = splitEdges[a - 1];
+						}
+
+						newIsland.mFirstEdge[j] = splitEdges[0];
+						newIsland.mLastEdge[j] = splitEdges[splitEdgeSize - 1];
+						newIsland.mEdgeCount[j] = splitEdgeSize;
+					}
+				}
+			}
+		}
+	}
+}
+
+void IslandSim::processDirtyIslands(PxU32 startIsland, PxU32 endIsland, TraversalScratch& scratch)
+{
+	for(PxU32 a = mDirtyIslandStarts[startIsland]; a < mDirtyIslandStarts[endIsland]; ++a)
+		processDirtyNode(NodeIndex(PxU32(mDirtyIslandNodes[a])), scratch);
+}
+
+class DirtyIslandsJob : public Cm::ChunkedJob
+{
+public:
+	DirtyIslandsJob(IslandSim& islandSim, PxU32 nbIslands, PxU32 chunkSize) :
+		Cm::ChunkedJob(nbIslands, chunkSize), mIslandSim(islandSim)
+	{
+	}
+
+	virtual void process(PxU32 start, PxU32 end)
+	{
+		//Each chunk has its own traversal data, so that the order of the islands split off within a chunk is deterministic
+		mIslandSim.processDirtyIslands(start, end, *mIslandSim.mParallelTraversalScratch[start / getChunkSize()]);
+	}
+private:
+	PX_NOCOPY(DirtyIslandsJob)
+
+	IslandSim& mIslandSim;
+};
+
+#define IG_PARALLEL_DIRTY_NODES_THRESHOLD	64
+#define IG_MAX_DIRTY_ISLAND_CHUNKS			64
+
+void IslandSim::processDirtyNodesParallel(PxCpuDispatcher& dispatcher)
+{
+	//Sort the dirty nodes by island. Within an island they stay in ascending order, which is the order of the serial loop.
+	mDirtyIslandNodes.forceSize_Unsafe(0);
+	{
+		Cm::BitMap::Iterator iter(mDirtyMap);
+		PxU32 dirtyIdx;
+		while ((dirtyIdx = iter.getNext()) != Cm::BitMap::Iterator::DONE)
+		{
+			Node& node = mNodes[dirtyIdx];
+			if (!node.isKinematic() && !node.isDeleted())
+				mDirtyIslandNodes.pushBack((PxU64(mIslandIds[dirtyIdx]) << 32) | dirtyIdx);
+			node.clearDirty();
+		}
+	}
+
+	const PxU32 nbDirtyNodes = mDirtyIslandNodes.size();
+	if (nbDirtyNodes == 0)
+		return;
+
+	Ps::sort(mDirtyIslandNodes.begin(), nbDirtyNodes);
+
+	mDirtyIslandStarts.forceSize_Unsafe(0);
+	mDirtyIslandStarts.pushBack(0);
+	for (PxU32 a = 1; a < nbDirtyNodes; ++a)
+	{
+		if ((mDirtyIslandNodes[a] >> 32) != (mDirtyIslandNodes[a - 1] >> 32))
+			mDirtyIslandStarts.pushBack(a);
+	}
+	const PxU32 nbDirtyIslands = mDirtyIslandStarts.size();
+	mDirtyIslandStarts.pushBack(nbDirtyNodes);
+
+	if (nbDirtyIslands < 2 || nbDirtyNodes < IG_PARALLEL_DIRTY_NODES_THRESHOLD)
+	{
+		processDirtyIslands(0, nbDirtyIslands, mTraversalScratch);
+		TraversalScratch* scratch = &mTraversalScratch;
+		createSplitIslands(&scratch, 1);
+		return;
+	}
+
+	PX_PROFILE_ZONE("Basic.processDirtyIslandsParallel", getContextId());
+
+	//A few chunks per thread to balance the load, the cost of an island being proportional to the size of its traversals
+	const PxU32 maxNbChunks = PxMin((dispatcher.getWorkerCount() + 1) * 4, PxU32(IG_MAX_DIRTY_ISLAND_CHUNKS));
+	const PxU32 chunkSize = (nbDirtyIslands + maxNbChunks - 1) / maxNbChunks;
+	const PxU32 nbChunks = (nbDirtyIslands + chunkSize - 1) / chunkSize;
+
+	while (mParallelTraversalScratch.size() < nbChunks)
+	{
+		TraversalScratch* scratch = PX_NEW(TraversalScratch);
+		scratch->mPriorityQueue.reserve(1024);
+		mParallelTraversalScratch.pushBack(scratch);
+	}
+
+	DirtyIslandsJob* job = PX_NEW(DirtyIslandsJob)(*this, nbDirtyIslands, chunkSize);
+	job->run(&dispatcher, 0);
+	job->releaseRef();
+
+	createSplitIslands(mParallelTraversalScratch.begin(), nbChunks);
+}
+
+namespace
+{
+	struct IslandSplitRootLess
+	{
+		bool operator()(const IslandSplit& split0, const IslandSplit& split1) const
+		{
+			return split0.mIsland.mRootNode.index() < split1.mIsland.mRootNode.index();
+		}
+	};
+}
+
+void IslandSim::createSplitIslands(TraversalScratch*const* scratches, PxU32 nbScratches)
+{
+	//Gather the split islands in the serial traversal data, then allocate their ids in the order of their root nodes. This
+	//is the order in which the serial loop over the dirty nodes would have created them, so ids do not depend on threading.
+	Ps::Array<IslandSplit>& splits = mTraversalScratch.mIslandSplits;
+	for (PxU32 i = 0; i < nbScratches; ++i)
+	{
+		Ps::Array<IslandSplit>& scratchSplits = scratches[i]->mIslandSplits;
+		if (&scratchSplits != &splits)
+		{
+			for (PxU32 a = 0; a < scratchSplits.size(); ++a)
+				splits.pushBack(scratchSplits[a]);
+			scratchSplits.forceSize_Unsafe(0);
+		}
+	}
+
+	const PxU32 nbSplits = splits.size();
+	if (nbSplits == 0)
+		return;
+
+	if (nbSplits > 1)
+		Ps::sort(splits.begin(), nbSplits, IslandSplitRootLess());
+
+	for (PxU32 a = 0; a < nbSplits; ++a)
+	{
+		const IslandSplit& split = splits[a];
+
+		IslandId newIslandHandle = mIslandHandles.getHandle();
+		mIslands.resize(PxMax(newIslandHandle + 1, mIslands.size()));
+		mIslandStaticTouchCount.resize(PxMax(newIslandHandle + 1, mIslandStaticTouchCount.size()));
+		Island& newIsland = mIslands[newIslandHandle];
+
+		if (split.mAwake)
+		{
+			newIsland.mActiveIndex = mActiveIslands.size();
+			mActiveIslands.pushBack(newIslandHandle);
+			mIslandAwake.growAndSet(newIslandHandle); //Separated island, so it should be awake
+		}
+		else
+		{
+			mIslandAwake.growAndReset(newIslandHandle);
+		}
+
+		newIsland.mRootNode = split.mIsland.mRootNode;
+		newIsland.mLastNode = split.mIsland.mLastNode;
+		newIsland.mSize[0] = split.mIsland.mSize[0];
+		newIsland.mSize[1] = split.mIsland.mSize[1];
+		for (PxU32 j = 0; j < 2; ++j)
+		{
+			if (split.mIsland.mEdgeCount[j])
+			{
+				newIsland.mFirstEdge[j] = split.mIsland.mFirstEdge[j];
+				newIsland.mLastEdge[j] = split.mIsland.mLastEdge[j];
+				newIsland.mEdgeCount[j] = split.mIsland.mEdgeCount[j];
+			}
+		}
+		mIslandStaticTouchCount[newIslandHandle] = split.mStaticTouchCount;
+
+		//Replace the placeholder island id of the nodes
+		for (NodeIndex index = newIsland.mRootNode; index.index() != IG_INVALID_NODE; index = mNodes[index.index()].mNextNode)
+			mIslandIds[index.index()] = newIslandHandle;
+	}
+
+	splits.forceSize_Unsafe(0);
+}
+
 void IslandSim::processLostEdges(Ps::Array<NodeIndex>& destroyedNodes, bool allowDeactivation, bool permitKinematicDeactivation,
-	PxU32 dirtyNodeLimit)
+	PxU32 dirtyNodeLimit, PxCpuDispatcher* dispatcher)
 {
 	PX_UNUSED(dirtyNodeLimit);
 	PX_PROFILE_ZONE("Basic.processLostEdges", getContextId());
 	//At this point, all nodes and edges are activated. 
 
-	//Bit map for visited
-	mVisitedState.resizeAndClear(mNodes.size());
+	//Visited state, a byte per node
+	mVisitedState.resize(mNodes.size());
+	if(mVisitedState.size())
+		PxMemZero(mVisitedState.begin(), sizeof(PxU8)*mVisitedState.size());
 
 	//Reserve space on priority queue for at least 1024 nodes. It will resize if more memory is required during traversal.
-	mPriorityQueue.reserve(1024);
+	mTraversalScratch.mPriorityQueue.reserve(1024);
 
-	mIslandSplitEdges[0].reserve(1024);
-	mIslandSplitEdges[1].reserve(1024);
-
-	mVisitedNodes.reserve(mNodes.size()); //Make sure we have enough space for all nodes!
+	mTraversalScratch.mIslandSplitEdges[0].reserve(1024);
+	mTraversalScratch.mIslandSplitEdges[1].reserve(1024);
 
 	const PxU32 nbDestroyedEdges = mDestroyedEdges.size();
 	PX_UNUSED(nbDestroyedEdges);
@@ -1415,270 +1802,60 @@ void IslandSim::processLostEdges(Ps::Array<NodeIndex>& destroyedNodes, bool allo
 		PX_PROFILE_ZONE("Basic.findPathsAndBreakIslands", getContextId());
 
 
-		//KS - process only this many dirty nodes, deferring future dirty nodes to subsequent frames. 
-		//This means that it may take several frames for broken edges to trigger islands to completely break but this is better
-		//than triggering large performance spikes.
+#if !IG_LIMIT_DIRTY_NODES
+		//Islands are independent, so their dirty nodes can be processed in parallel
+		if(dispatcher && dispatcher->getWorkerCount())
+		{
+			processDirtyNodesParallel(*dispatcher);
+			mDirtyMap.clear();
+		}
+		else
+#endif
+		{
+			//KS - process only this many dirty nodes, deferring future dirty nodes to subsequent frames. 
+			//This means that it may take several frames for broken edges to trigger islands to completely break but this is better
+			//than triggering large performance spikes.
 #if IG_LIMIT_DIRTY_NODES
-		Cm::BitMap::CircularIterator iter(mDirtyMap, mLastMapIndex);
-		const PxU32 MaxCount = dirtyNodeLimit;// +10000000;
-		PxU32 lastMapIndex = mLastMapIndex;
-		PxU32 count = 0;
+			Cm::BitMap::CircularIterator iter(mDirtyMap, mLastMapIndex);
+			const PxU32 MaxCount = dirtyNodeLimit;// +10000000;
+			PxU32 lastMapIndex = mLastMapIndex;
+			PxU32 count = 0;
 #else
-		Cm::BitMap::Iterator iter(mDirtyMap);
+			Cm::BitMap::Iterator iter(mDirtyMap);
 #endif
 
-
-		PxU32 dirtyIdx;
+			PxU32 dirtyIdx;
 
 #if IG_LIMIT_DIRTY_NODES
-		while ((dirtyIdx = iter.getNext()) != Cm::BitMap::CircularIterator::DONE
-			&& (count++ < MaxCount)
+			while ((dirtyIdx = iter.getNext()) != Cm::BitMap::CircularIterator::DONE
+				&& (count++ < MaxCount)
 #else
-		while ((dirtyIdx = iter.getNext()) != Cm::BitMap::Iterator::DONE
-#endif
-			)
-		{
-#if IG_LIMIT_DIRTY_NODES
-			lastMapIndex = dirtyIdx + 1;
+			while ((dirtyIdx = iter.getNext()) != Cm::BitMap::Iterator::DONE
 #endif
-			//Process dirty nodes. Figure out if we can make our way from the dirty node to the root.
-
-			mPriorityQueue.clear(); //Clear the queue used for traversal
-			mVisitedNodes.forceSize_Unsafe(0); //Clear the list of nodes in this island
-			NodeIndex dirtyNodeIndex(dirtyIdx);
-			Node& dirtyNode = mNodes[dirtyNodeIndex.index()];
-
-			//Check whether this node has already been touched. If it has been touched this frame, then its island state is reliable 
-			//and we can just unclear the dirty flag on the body. If we were already visited, then the state should have already been confirmed in a 
-			//previous pass.
-			if (!dirtyNode.isKinematic() && !dirtyNode.isDeleted() && !mVisitedState.test(dirtyNodeIndex.index()))
+				)
 			{
-				//We haven't visited this node in our island repair passes yet, so we still need to process until we've hit a visited node or found
-				//our root node. Note that, as soon as we hit a visited node that has already been processed in a previous pass, we know that we can rely
-				//on its island information although the hop counts may not be optimal. It also indicates that this island was not broken immediately because
-				//otherwise, the entire new sub-island would already have been visited and this node would have already had its new island state assigned.
-
-				//Indicate that I've been visited
-
-				IslandId islandId = mIslandIds[dirtyNodeIndex.index()];
-				Island& findIsland = mIslands[islandId];
-
-				NodeIndex searchNode = findIsland.mRootNode;//The node that we're searching for!
-
-				if (searchNode.index() != dirtyNodeIndex.index()) //If we are the root node, we don't need to do anything!
-				{
-					if (findRoute(dirtyNodeIndex, searchNode, islandId))
-					{
-						//We found the root node so let's let every visited node know that we found its root
-						//and we can also update our hop counts because we recorded how many hops it took to reach this
-						//node
-
-						//We already filled in the path to the root/witness with accurate hop counts. Now we just need to fill in the estimates
-						//for the remaining nodes and re-define their islandIds. We approximate their path to the root by just routing them through
-						//the route we already found.
-
-						//This loop works because mVisitedNodes are recorded in the order they were visited and we already filled in the critical path
-						//so the remainder of the paths will just fork from that path.
-
-						//Verify state (that we can see the root from this node)...
-
-#if IG_SANITY_CHECKS
-						PX_ASSERT(canFindRoot(dirtyNode, searchNode, NULL)); //Verify that we found the connection
-#endif
-
-						for (PxU32 b = 0; b < mVisitedNodes.size(); ++b)
-						{
-							TraversalState& state = mVisitedNodes[b];
-							if (mIslandIds[state.mNodeIndex.index()] == IG_INVALID_ISLAND)
-							{
-								mHopCounts[state.mNodeIndex.index()] = mHopCounts[mVisitedNodes[state.mPrevIndex].mNodeIndex.index()] + 1;
-								mFastRoute[state.mNodeIndex.index()] = mVisitedNodes[state.mPrevIndex].mNodeIndex;
-								mIslandIds[state.mNodeIndex.index()] = islandId;
-							}
-						}
-					}
-					else
-					{
-						//If I traversed and could not find the root node, then I have established a new island. In this island, I am the root node
-						//and I will point all my nodes towards me. Furthermore, I have established how many steps it took to reach all nodes in my island
-
-						//OK. We need to separate the islands. We have a list of nodes that are part of the new island (mVisitedNodes) and we know that the 
-						//first node in that list is the root node.
-
-
-						//OK, we need to remove all these actors from their current island, then add them to the new island...
-
-						Island& oldIsland = mIslands[islandId];
-						//We can just unpick these nodes from the island because they do not contain the root node (if they did, then we wouldn't be
-						//removing this node from the island at all). The only challenge is if we need to remove the last node. In that case
-						//we need to re-establish the new last node in the island but perhaps the simplest way to do that would be to traverse
-						//the island to establish the last node again
-
-#if IG_SANITY_CHECKS
-						PX_ASSERT(!canFindRoot(dirtyNode, searchNode, NULL));
+#if IG_LIMIT_DIRTY_NODES
+				lastMapIndex = dirtyIdx + 1;
 #endif
+				processDirtyNode(NodeIndex(dirtyIdx), mTraversalScratch);
 
-						PxU32 totalStaticTouchCount = 0;
-						mIslandSplitEdges[0].forceSize_Unsafe(0);
-						mIslandSplitEdges[1].forceSize_Unsafe(0);
-						PxU32 size[2] = { 0,0 };
-
-						//NodeIndex lastIndex = oldIsland.mLastNode;
-
-						//size[node.mType] = 1;
-
-						for (PxU32 a = 0; a < mVisitedNodes.size(); ++a)
-						{
-							NodeIndex index = mVisitedNodes[a].mNodeIndex;
-							Node& node = mNodes[index.index()];
-
-							if (node.mNextNode.index() != IG_INVALID_NODE)
-								mNodes[node.mNextNode.index()].mPrevNode = node.mPrevNode;
-							else
-								oldIsland.mLastNode = node.mPrevNode;
-							if (node.mPrevNode.index() != IG_INVALID_NODE)
-								mNodes[node.mPrevNode.index()].mNextNode = node.mNextNode;
-
-							size[node.mType]++;
-
-							node.mNextNode.setIndices(IG_INVALID_NODE);
-							node.mPrevNode.setIndices(IG_INVALID_NODE);
-
-							PX_ASSERT(mNodes[oldIsland.mLastNode.index()].mNextNode.index() == IG_INVALID_NODE);
-
-							totalStaticTouchCount += node.mStaticTouchCount;
-
-							EdgeInstanceIndex idx = node.mFirstEdgeIndex;
-
-							while (idx != IG_INVALID_EDGE)
-							{
-								EdgeInstance& instance = mEdgeInstances[idx];
-								const EdgeIndex edgeIndex = idx / 2;
-								Edge& edge = mEdges[edgeIndex];
-
-								//Only split the island if we're processing the first node or if the first node is infinte-mass
-								if (!(idx & 1) || (mEdgeNodeIndices[idx & (~1)].index() == IG_INVALID_NODE || mNodes[mEdgeNodeIndices[idx & (~1)].index()].isKinematic()))
-								{
-									//We will remove this edge from the island...
-									mIslandSplitEdges[edge.mEdgeType].pushBack(edgeIndex);
-
-									removeEdgeFromIsland(oldIsland, edgeIndex);
-
-								}
-								idx = instance.mNextEdge;
-							}
-
-						}
-
-						//oldIsland.mStaticTouchCount -= totalStaticTouchCount;
-						mIslandStaticTouchCount[islandId] -= totalStaticTouchCount;
-
-						oldIsland.mSize[0] -= size[0];
-						oldIsland.mSize[1] -= size[1];
-
-						//Now add all these nodes to the new island
-
-						//(1) Create the new island...
-						IslandId newIslandHandle = mIslandHandles.getHandle();
-						/*if(newIslandHandle == mIslands.capacity())
-						{
-						mIslands.reserve(2*mIslands.capacity() + 1);
-						}*/
-						mIslands.resize(PxMax(newIslandHandle + 1, mIslands.size()));
-						mIslandStaticTouchCount.resize(PxMax(newIslandHandle + 1, mIslandStaticTouchCount.size()));
-						Island& newIsland = mIslands[newIslandHandle];
-
-						if (mIslandAwake.test(islandId))
-						{
-							newIsland.mActiveIndex = mActiveIslands.size();
-							mActiveIslands.pushBack(newIslandHandle);
-							mIslandAwake.growAndSet(newIslandHandle); //Separated island, so it should be awake
-						}
-						else
-						{
-							mIslandAwake.growAndReset(newIslandHandle);
-						}
-
-						newIsland.mRootNode = dirtyNodeIndex;
-						mHopCounts[dirtyNodeIndex.index()] = 0;
-						mIslandIds[dirtyNodeIndex.index()] = newIslandHandle;
-						//newIsland.mTotalSize = mVisitedNodes.size();
-
-						mNodes[dirtyNodeIndex.index()].mPrevNode.setIndices(IG_INVALID_NODE); //First node so doesn't have a preceding node
-						mFastRoute[dirtyNodeIndex.index()].setIndices(IG_INVALID_NODE);
-
-						size[0] = 0; size[1] = 0;
-
-						size[dirtyNode.mType] = 1;
-
-						for (PxU32 a = 1; a < mVisitedNodes.size(); ++a)
-						{
-							NodeIndex index = mVisitedNodes[a].mNodeIndex;
-							Node& thisNode = mNodes[index.index()];
-							NodeIndex prevNodeIndex = mVisitedNodes[a - 1].mNodeIndex;
-							thisNode.mPrevNode = prevNodeIndex;
-							mNodes[prevNodeIndex.index()].mNextNode = index;
-							size[thisNode.mType]++;
-							mIslandIds[index.index()] = newIslandHandle;
-							mHopCounts[index.index()] = mVisitedNodes[a].mDepth; //How many hops to root
-							mFastRoute[index.index()] = mVisitedNodes[mVisitedNodes[a].mPrevIndex].mNodeIndex;
-						}
-
-						newIsland.mSize[0] = size[0];
-						newIsland.mSize[1] = size[1];
-						//Last node in the island
-						NodeIndex lastIndex = mVisitedNodes[mVisitedNodes.size() - 1].mNodeIndex;
-						mNodes[lastIndex.index()].mNextNode.setIndices(IG_INVALID_NODE);
-						newIsland.mLastNode = lastIndex;
-						//newIsland.mStaticTouchCount = totalStaticTouchCount;
-						mIslandStaticTouchCount[newIslandHandle] = totalStaticTouchCount;
-						newIsland.mSize[0] = size[0];
-						newIsland.mSize[1] = size[1];
-
-						PX_ASSERT(mNodes[newIsland.mLastNode.index()].mNextNode.index() == IG_INVALID_NODE);
-
-						for (PxU32 j = 0; j < 2; ++j)
-						{
-							Ps::Array<EdgeIndex>& splitEdges = mIslandSplitEdges[j];
-							const PxU32 splitEdgeSize = splitEdges.size();
-							if (splitEdgeSize)
-							{
-								splitEdges.pushBack(IG_INVALID_EDGE); //Push in a dummy invalid edge to complete the connectivity
-								mEdges[splitEdges[0]].mNextIslandEdge = splitEdges[1];
-								for (PxU32 a = 1; a < splitEdgeSize; ++a)
-								{
-									EdgeIndex edgeIndex = splitEdges[a];
-									Edge& edge = mEdges[edgeIndex];
-									edge.mNextIslandEdge = splitEdges[a + 1];
-									edge.mPrevIslandEdge = splitEdges[a - 1];
-								}
-
-								newIsland.mFirstEdge[j] = splitEdges[0];
-								newIsland.mLastEdge[j] = splitEdges[splitEdgeSize - 1];
-								newIsland.mEdgeCount[j] = splitEdgeSize;
-							}
-						}
-
-			}
-		}
-
-	}
-
-			dirtyNode.clearDirty();
+				mNodes[dirtyIdx].clearDirty();
 #if IG_LIMIT_DIRTY_NODES
-			mDirtyMap.reset(dirtyIdx);
+				mDirtyMap.reset(dirtyIdx);
 #endif
-}
-
+			}
 
+			TraversalScratch* scratch = &mTraversalScratch;
+			createSplitIslands(&scratch, 1);
 
 #if IG_LIMIT_DIRTY_NODES
-		mLastMapIndex = lastMapIndex;
-		if (count < MaxCount)
-			mLastMapIndex = 0;
+			mLastMapIndex = lastMapIndex;
+			if (count < MaxCount)
+				mLastMapIndex = 0;
 #else
-		mDirtyMap.clear();
+			mDirtyMap.clear();
 #endif
+		}
 
 		//mDirtyNodes.forceSize_Unsafe(0);
 	}
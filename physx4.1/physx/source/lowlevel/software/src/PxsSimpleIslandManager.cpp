@@ -204,7 +204,7 @@ void SimpleIslandManager::firstPassIslandGen()
 	mSpeculativeIslandManager.wakeIslands();
 	mSpeculativeIslandManager.processNewEdges();
 	mSpeculativeIslandManager.removeDestroyedEdges();
-	mSpeculativeIslandManager.processLostEdges(mDestroyedNodes, false, false, mMaxDirtyNodesPerFrame);
+	mSpeculativeIslandManager.processLostEdges(mDestroyedNodes, false, false, mMaxDirtyNodesPerFrame, NULL);
 }
 
 void SimpleIslandManager::additionalSpeculativeActivation()
@@ -220,7 +220,7 @@ void SimpleIslandManager::secondPassIslandGen()
 	mIslandManager.processNewEdges();
 
 	mIslandManager.removeDestroyedEdges();
-	mIslandManager.processLostEdges(mDestroyedNodes, false, false, mMaxDirtyNodesPerFrame);
+	mIslandManager.processLostEdges(mDestroyedNodes, false, false, mMaxDirtyNodesPerFrame, NULL);
 
 	for(PxU32 a = 0; a < mDestroyedNodes.size(); ++a)
 	{
@@ -255,7 +255,8 @@ void ThirdPassTask::runInternal()
 {
 	PX_PROFILE_ZONE("Basic.thirdPassIslandGen", mIslandSim.getContextId());
 	mIslandSim.removeDestroyedEdges();
-	mIslandSim.processLostEdges(mIslandManager.mDestroyedNodes, true, true, mIslandManager.mMaxDirtyNodesPerFrame);
+	mIslandSim.processLostEdges(mIslandManager.mDestroyedNodes, true, true, mIslandManager.mMaxDirtyNodesPerFrame,
+		getTaskManager() ? getTaskManager()->getCpuDispatcher() : NULL);
 }
 
 void PostThirdPassTask::runInternal()
@@ -300,6 +301,19 @@ void SimpleIslandManager::thirdPassIslandGen(PxBaseTask* continuation)
 	
 }
 
+void SimpleIslandManager::thirdPassIslandGenImmediate()
+{
+	mIslandManager.clearDeactivations();
+
+	mSpeculativeIslandManager.removeDestroyedEdges();
+	mSpeculativeIslandManager.processLostEdges(mDestroyedNodes, true, true, mMaxDirtyNodesPerFrame, NULL);
+
+	mIslandManager.removeDestroyedEdges();
+	mIslandManager.processLostEdges(mDestroyedNodes, true, true, mMaxDirtyNodesPerFrame, NULL);
+
+	mPostThirdPassTask.runInternal();
+}
+
 bool SimpleIslandManager::checkInternalConsistency()
 {
 	return mIslandManager.checkInternalConsistency() && mSpeculativeIslandManager.checkInternalConsistency();
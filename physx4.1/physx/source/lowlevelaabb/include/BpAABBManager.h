@@ -399,6 +399,10 @@
 				return mDestroyedOverlaps[type].begin();
 			}
 
+			// Used to edit the overlaps of the last update, see Sc::Scene::reconcileRestoredOverlaps()
+			Ps::Array<AABBOverlap>&		getCreatedOverlapArray(ElementType::Enum type)		{ PX_ASSERT(type < ElementType::eCOUNT); return mCreatedOverlaps[type];		}
+			Ps::Array<AABBOverlap>&		getDestroyedOverlapArray(ElementType::Enum type)	{ PX_ASSERT(type < ElementType::eCOUNT); return mDestroyedOverlaps[type];	}
+
 			void						freeBuffers();
 
 			void**						getOutOfBoundsObjects(PxU32& nbOutOfBoundsObjects)
@@ -444,8 +448,6 @@
 			void putBpCacheData(BpCacheData*);
 			void resetBpCacheData();
 
-			Ps::Mutex					mMapLock;
-
 		private:
 			void reserveShapeSpace(PxU32 nbShapes);
 
@@ -1998,10 +1998,28 @@ public:
 	PairData mCreatedPairs[2];
 	PairData mDestroyedPairs[2];
 
-	ProcessAggPairsBase(PxU64 contextID) : Cm::Task(contextID)
+	// PT: persistent pairs removed by the task. They are erased from mMap in task order once all tasks are done,
+	// so that the map (and thus the order in which its pairs are processed next frame) doesn't depend on the
+	// order in which tasks completed.
+	AggPairMap* mMap;
+	Bp::AggPair mRemovedPairs[MaxPairs];
+	PxU32 mNbRemovedPairs;
+
+	ProcessAggPairsBase(PxU64 contextID) : Cm::Task(contextID), mMap(NULL), mNbRemovedPairs(0)
 	{
 	}
 
+	void eraseRemovedPairs()
+	{
+		for (PxU32 i = 0; i < mNbRemovedPairs; ++i)
+		{
+			bool status = mMap->erase(mRemovedPairs[i]);
+			PX_ASSERT(status);
+			PX_UNUSED(status);
+		}
+		mNbRemovedPairs = 0;
+	}
+
 	void setCache(BpCacheData& data)
 	{
 		for (PxU32 i = 0; i < 2; ++i)
@@ -2031,13 +2049,12 @@ public:
 	Bp::AggPair mAggPairs[MaxPairs];
 	PxU32 mNbPairs;
 	AABBManager* mManager;
-	AggPairMap* mMap;
-	Ps::Mutex* mMutex;
 	const char* mName;
 
-	ProcessAggPairsParallelTask(PxU64 contextID, Ps::Mutex* mutex, AABBManager* manager, AggPairMap* map, const char* name) : ProcessAggPairsBase(contextID),
-		mNbPairs(0), mManager(manager), mMap(map), mMutex(mutex), mName(name)
+	ProcessAggPairsParallelTask(PxU64 contextID, AABBManager* manager, AggPairMap* map, const char* name) : ProcessAggPairsBase(contextID),
+		mNbPairs(0), mManager(manager), mName(name)
 	{
+		mMap = map;
 	}
 
 
@@ -2048,12 +2065,11 @@ public:
 		setCache(*data);
 
 
-		Ps::InlineArray<AggPair, MaxPairs> removedEntries;
 		for (PxU32 i = 0; i < mNbPairs; ++i)
 		{
 			if (mPersistentPairs[i]->update(*mManager, data))
 			{
-				removedEntries.pushBack(mAggPairs[i]);
+				mRemovedPairs[mNbRemovedPairs++] = mAggPairs[i];
 				PX_DELETE(mPersistentPairs[i]);
 			}
 		}
@@ -2061,20 +2077,6 @@ public:
 		updateCounters();
 
 		mManager->putBpCacheData(data);
-
-
-		if (removedEntries.size())
-		{
-			Ps::Mutex::ScopedLock lock(*mMutex);
-			for (PxU32 i = 0; i < removedEntries.size(); i++)
-			{
-				bool status = mMap->erase(removedEntries[i]);
-				PX_ASSERT(status);
-				PX_UNUSED(status);
-			}
-		}
-
-
 	}
 
 	virtual const char* getName() const { return mName; }
@@ -2153,9 +2155,7 @@ static void processAggregatePairsParallel(AggPairMap& map, AABBManager& manager,
 
 	// PT: TODO: replace with decent hash map - or remove the hashmap entirely and use a linear array
 
-	manager.mMapLock.lock();
-
-	ProcessAggPairsParallelTask* task = PX_PLACEMENT_NEW(flushPool.allocate(sizeof(ProcessAggPairsParallelTask)), ProcessAggPairsParallelTask)(0, &manager.mMapLock, &manager, &map, taskName);
+	ProcessAggPairsParallelTask* task = PX_PLACEMENT_NEW(flushPool.allocate(sizeof(ProcessAggPairsParallelTask)), ProcessAggPairsParallelTask)(0, &manager, &map, taskName);
 
 	PxU32 startIdx = pairTasks.size();
 
@@ -2167,12 +2167,10 @@ static void processAggregatePairsParallel(AggPairMap& map, AABBManager& manager,
 		{
 			pairTasks.pushBack(task);
 			task->setContinuation(continuation);
-			task = PX_PLACEMENT_NEW(flushPool.allocate(sizeof(ProcessAggPairsParallelTask)), ProcessAggPairsParallelTask)(0, &manager.mMapLock, &manager, &map, taskName);
+			task = PX_PLACEMENT_NEW(flushPool.allocate(sizeof(ProcessAggPairsParallelTask)), ProcessAggPairsParallelTask)(0, &manager, &map, taskName);
 		}
 	}
 
-	manager.mMapLock.unlock();
-
 	for (PxU32 i = startIdx; i < pairTasks.size(); ++i)
 	{
 		pairTasks[i]->removeReference();
@@ -2322,6 +2320,7 @@ void AABBManager::postBpStage3(PxBaseTask*)
 			for (PxU32 a = 0; a < mAggPairTasks.size(); ++a)
 			{
 				ProcessAggPairsBase* task = mAggPairTasks[a];
+				task->eraseRemovedPairs();
 				for (PxU32 t = 0; t < 2; t++)
 				{
 					for (PxU32 i = 0, startIdx = task->mCreatedPairs[t].mStartIdx; i < task->mCreatedPairs[t].mCount; ++i)
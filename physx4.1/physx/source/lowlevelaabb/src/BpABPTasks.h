@@ -0,0 +1,98 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef BP_ABP_TASKS_H
+#define BP_ABP_TASKS_H
+
+#include "PsUserAllocated.h"
+#include "CmTask.h"
+
+namespace physx
+{
+	namespace Bp
+	{
+		class BroadPhaseABP;
+	}
+
+	class ABPTask : public Cm::Task, public shdfnd::UserAllocated
+	{
+		public:
+												ABPTask(PxU64 contextId) : Cm::Task(contextId), mABP(NULL)	{}
+
+		PX_FORCE_INLINE	void					set(Bp::BroadPhaseABP* abp)
+												{
+													mABP = abp;
+												}
+		protected:
+						Bp::BroadPhaseABP*		mABP;
+		private:
+		ABPTask& operator=(const ABPTask&);
+	};
+
+	// PT: this is the main 'update' task doing the actual box pruning work. Several of these run in parallel,
+	// each of them grabbing ranges of pruning work until there is none left.
+	class ABPUpdateWorkTask : public ABPTask
+	{
+	public:
+								ABPUpdateWorkTask(PxU64 contextId) : ABPTask(contextId)	{}
+								~ABPUpdateWorkTask()									{}
+		// PxBaseTask
+		virtual const char*		getName() const { return "BpABP.updateWork"; }
+		//~PxBaseTask
+
+		// Cm::Task
+		virtual void			runInternal();
+		//~Cm::Task
+
+	private:
+		ABPUpdateWorkTask& operator=(const ABPUpdateWorkTask&);
+	};
+
+	// PT: this task runs after all ABPUpdateWorkTasks. It merges the per-range pair buffers into the pair manager,
+	// in range order, and computes the created/deleted pairs. This is single-threaded.
+	class ABPPostUpdateWorkTask : public ABPTask
+	{
+	public:
+								ABPPostUpdateWorkTask(PxU64 contextId) : ABPTask(contextId)	{}
+								~ABPPostUpdateWorkTask()									{}
+		// PxBaseTask
+		virtual const char*		getName() const { return "BpABP.postUpdateWork"; }
+		//~PxBaseTask
+
+		// Cm::Task
+		virtual void			runInternal();
+		//~Cm::Task
+
+	private:
+		ABPPostUpdateWorkTask& operator=(const ABPPostUpdateWorkTask&);
+	};
+
+} //namespace physx
+
+#endif // BP_ABP_TASKS_H
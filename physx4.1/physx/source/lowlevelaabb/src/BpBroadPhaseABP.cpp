@@ -28,10 +28,12 @@
 // Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
 
 #include "foundation/PxProfiler.h"
+#include "common/PxProfileZone.h"
 #include "BpBroadPhaseABP.h"
 #include "BpBroadPhaseShared.h"
 #include "CmRadixSortBuffered.h"
 #include "PsFoundation.h"
+#include "PsAtomic.h"
 #include "PsVecMath.h"
 #include "PxcScratchAllocator.h"
 
@@ -51,6 +53,7 @@ using namespace Cm;
 #endif
 
 #define ABP_BATCHING		128
+#define ABP_MT_RANGE_SIZE	512		// PT: number of 'index0' boxes per work range in the multithreaded update
 #define USE_ABP_BUCKETS		5000	// PT: don't use buckets below that number...
 #ifdef USE_ABP_BUCKETS
 	#define NB_BUCKETS	5
@@ -354,20 +357,37 @@ namespace internalABP{
 			void*					frameAlloc(PxU32 size);
 			void					frameFree(void* address);
 
+			// PT: in deferred mode, frame allocations are kept alive until releaseDeferred() is called. This is used
+			// by the multithreaded update, where the box-pruning work referencing these buffers runs after the
+			// functions that allocated them have returned.
+			void					beginDeferred()	{ mDeferred = true;	}
+			void					releaseDeferred();
+
 			PxcScratchAllocator*	mScratchAllocator;
+			Ps::Array<void*>		mDeferredAllocs;
+			bool					mDeferred;
 	};
 
 ABP_MM::ABP_MM() :
-	mScratchAllocator	(NULL)
+	mScratchAllocator	(NULL),
+	mDeferred			(false)
 {
 }
 
 ABP_MM::~ABP_MM()
 {
+	releaseDeferred();
 }
 
 void* ABP_MM::frameAlloc(PxU32 size)
 {
+	if(mDeferred)
+	{
+		// PT: the scratch allocator is a stack, so we cannot use it for allocations outliving the current scope.
+		void* address = PX_ALLOC_TEMP(size, PX_DEBUG_EXP("frameAlloc"));
+		mDeferredAllocs.pushBack(address);
+		return address;
+	}
 	if(mScratchAllocator)
 		return mScratchAllocator->alloc(size, true);
 	return PX_ALLOC_TEMP(size, PX_DEBUG_EXP("frameAlloc"));
@@ -375,12 +395,23 @@ void* ABP_MM::frameAlloc(PxU32 size)
 
 void ABP_MM::frameFree(void* address)
 {
+	if(mDeferred)
+		return;
 	if(mScratchAllocator)
 		mScratchAllocator->free(address);
 	else
 		PX_FREE(address);
 }
 
+void ABP_MM::releaseDeferred()
+{
+	const PxU32 nb = mDeferredAllocs.size();
+	for(PxU32 i=0;i<nb;i++)
+		PX_FREE(mDeferredAllocs[i]);
+	mDeferredAllocs.clear();
+	mDeferred = false;
+}
+
 template<class T>
 static T* resizeBoxesT(PxU32 oldNbBoxes, PxU32 newNbBoxes, T* boxes)
 {
@@ -916,6 +947,97 @@ static ABP_Index* resizeMapping(PxU32 oldNbBoxes, PxU32 newNbBoxes, ABP_Index* m
 
 	///////////////////////////////////////////////////////////////////////////
 
+	// PT: multithreaded update. The box-pruning leaves are first recorded (ABP_LeafRecorder), in the same order as the
+	// single-threaded code runs them. They are then cut into fixed-size ranges of 'index0' boxes (ABP_WorkRange). Each
+	// range writes its pairs to its own ABP_PairBuffer, and the buffers are merged into the pair manager in range order.
+	// The pair manager thus sees the exact same sequence of pairs as in the single-threaded version, regardless of the
+	// number of threads or of the order in which the ranges have been processed.
+
+	enum ABP_LeafType
+	{
+		ABP_LEAF_BIPARTITE_0,	// boxPruningKernel<0>
+		ABP_LEAF_BIPARTITE_1,	// boxPruningKernel<1>
+		ABP_LEAF_COMPLETE		// completeBoxPruningKernel
+	};
+
+	struct ABP_Leaf
+	{
+		ABP_LeafType			mType;
+		PxU32					mNb0;
+		PxU32					mNb1;
+		const SIMD_AABB_X4*		mBoxes0_X;
+		const SIMD_AABB_X4*		mBoxes1_X;
+		const SIMD_AABB_YZ4*	mBoxes0_YZ;
+		const SIMD_AABB_YZ4*	mBoxes1_YZ;
+		const ABP_Index*		mRemap0;
+		const ABP_Index*		mRemap1;
+		const ABPEntry*			mObjects;
+	};
+
+	struct ABP_WorkRange
+	{
+		PxU32	mLeaf;
+		PxU32	mStart;			// First 'index0' box processed by the range
+		PxU32	mEnd;			// Last 'index0' box processed by the range, excluded
+		PxU32	mRunningIndex;	// Running index of the box-pruning loop when it reaches mStart in the single-threaded version
+	};
+
+	class ABP_LeafRecorder
+	{
+		public:
+		PX_FORCE_INLINE					ABP_LeafRecorder(Ps::Array<ABP_Leaf>& leaves) : mLeaves(leaves)	{}
+
+						Ps::Array<ABP_Leaf>&	mLeaves;
+		private:
+		ABP_LeafRecorder& operator=(const ABP_LeafRecorder&);
+	};
+
+	// PT: same interface as ABP_PairManager as far as the box-pruning kernels are concerned. Pairs are filtered
+	// and remapped here, but only stored in a flat array. The hash-map insertion happens later during the merge.
+	class ABP_PairBuffer
+	{
+		public:
+										ABP_PairBuffer() :
+											mGroups		(NULL),
+											mInToOut0	(NULL),
+											mInToOut1	(NULL),
+											mObjects	(NULL)
+#ifdef BP_FILTERING_USES_TYPE_IN_GROUP
+											,mLUT		(NULL)
+#endif
+										{
+										}
+
+		PX_FORCE_INLINE	void			addPair(PxU32 index0, PxU32 index1)
+										{
+											const PxU32 id0 = mInToOut0[index0];
+											const PxU32 id1 = mInToOut1[index1];
+											PX_ASSERT(id0!=id1);
+											PX_ASSERT(id0!=INVALID_ID);
+											PX_ASSERT(id1!=INVALID_ID);
+											PX_ASSERT(mGroups);
+#ifdef BP_FILTERING_USES_TYPE_IN_GROUP
+											if(!groupFiltering(mGroups[id0], mGroups[id1], mLUT))
+#else
+											if(!groupFiltering(mGroups[id0], mGroups[id1]))
+#endif
+												return;
+											mPairs.pushBack(id0);
+											mPairs.pushBack(id1);
+										}
+
+						Ps::Array<PxU32>				mPairs;
+						const Bp::FilterGroup::Enum*	mGroups;
+						const ABP_Index*				mInToOut0;
+						const ABP_Index*				mInToOut1;
+						const ABPEntry*					mObjects;
+#ifdef BP_FILTERING_USES_TYPE_IN_GROUP
+						const bool*						mLUT;
+#endif
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+
 	struct ABP_SharedData
 	{
 		PX_FORCE_INLINE				ABP_SharedData() :
@@ -1332,7 +1454,7 @@ static PX_FORCE_INLINE PosXType2 getNextCandidateNonSorted(PxU32 offsetNonSorted
 }
 
 PX_COMPILE_TIME_ASSERT(sizeof(BpHandle)==sizeof(float));
-void BoxManager::prepareData(RadixSortBuffered& /*rs*/, ABP_Object* PX_RESTRICT objects, PxU32 objectsCapacity, ABP_MM& memoryManager)
+void BoxManager::prepareData(RadixSortBuffered& sharedRS, ABP_Object* PX_RESTRICT objects, PxU32 objectsCapacity, ABP_MM& memoryManager)
 {
 	PX_UNUSED(objectsCapacity);
 
@@ -1657,6 +1779,7 @@ void BoxManager::prepareData(RadixSortBuffered& /*rs*/, ABP_Object* PX_RESTRICT
 		PxU32* ranks0 = reinterpret_cast<PxU32*>(memoryManager.frameAlloc(sizeof(PxU32)*nbUpdated));
 		PxU32* ranks1 = reinterpret_cast<PxU32*>(memoryManager.frameAlloc(sizeof(PxU32)*nbUpdated));
 		StackRadixSort(rs, ranks0, ranks1);
+		rs.SetDispatcher(sharedRS.GetDispatcher());
 		const PxU32* sorted = rs.Sort(keys, nbUpdated).GetRanks();
 
 		// PT:
@@ -1781,6 +1904,17 @@ void BoxManager::finalize()
 
 						void					Region_prepareOverlaps();
 						void					Region_findOverlaps(ABP_PairManager& pairManager);
+		template<class PairManagerT>
+						void					Region_findAllOverlaps(PairManagerT& pairManager);
+
+						// PT: multithreaded version of findOverlaps(), see ABP_LeafRecorder
+						PxU32					prepareParallelOverlaps(const Bp::FilterGroup::Enum* PX_RESTRICT groups
+#ifdef BP_FILTERING_USES_TYPE_IN_GROUP
+	, const bool* PX_RESTRICT lut
+#endif
+							);
+						void					processParallelRanges();
+						void					mergeParallelPairs();
 
 						ABP_MM					mMM;
 						BoxManager				mSBM;
@@ -1790,6 +1924,11 @@ void BoxManager::finalize()
 						ABP_SharedData			mShared;
 						ABP_PairManager			mPairManager;
 
+						Ps::Array<ABP_Leaf>			mLeaves;
+						Ps::Array<ABP_WorkRange>	mRanges;
+						Ps::Array<ABP_PairBuffer>	mPairBuffers;	// One per range, kept around between frames to avoid reallocations
+						volatile PxI32				mNextRange;
+
 //				const	PxBounds3*				mTransientBounds;
 //				const	PxReal*					mTransientContactDistance;
 //				const	Bp::FilterGroup::Enum*	mTransientGroups;
@@ -1898,26 +2037,26 @@ static PX_FORCE_INLINE int intersect2D(const SIMD_AABB_YZ4& a, const SIMD_AABB_Y
 }
 #endif
 
-static PX_FORCE_INLINE void outputPair(ABP_PairManager& pairManager, PxU32 index0, PxU32 index1)
+template<class PairManagerT>
+static PX_FORCE_INLINE void outputPair(PairManagerT& pairManager, PxU32 index0, PxU32 index1)
 {
 	pairManager.addPair(index0, index1);
 }
 
-template<int codepath>
-static void boxPruningKernel(	PxU32 nb0, PxU32 nb1,
+// PT: the kernels process the [index0, endIndex0[ range of boxes0. The running index must be the one the loop would
+// have reached when processing the whole set of boxes, see computeRunningIndex().
+template<int codepath, class PairManagerT>
+static void boxPruningKernel(	PxU32 index0, PxU32 endIndex0, PxU32 runningIndex1, PxU32 nb1,
 								const SIMD_AABB_X4* PX_RESTRICT boxes0_X, const SIMD_AABB_X4* PX_RESTRICT boxes1_X,
 								const SIMD_AABB_YZ4* PX_RESTRICT boxes0_YZ, const SIMD_AABB_YZ4* PX_RESTRICT boxes1_YZ,
 								const ABP_Index* PX_RESTRICT inToOut0, const ABP_Index* PX_RESTRICT inToOut1,
-								ABP_PairManager* PX_RESTRICT pairManager, const ABPEntry* PX_RESTRICT objects)
+								PairManagerT* PX_RESTRICT pairManager, const ABPEntry* PX_RESTRICT objects)
 {
 	pairManager->mInToOut0 = inToOut0;
 	pairManager->mInToOut1 = inToOut1;
 	pairManager->mObjects = objects;
 
-	PxU32 index0 = 0;
-	PxU32 runningIndex1 = 0;
-
-	while(runningIndex1<nb1 && index0<nb0)
+	while(runningIndex1<nb1 && index0<endIndex0)
 	{
 		const SIMD_AABB_X4& box0_X = boxes0_X[index0];
 		const PosXType2 maxLimit = box0_X.mMaxX;
@@ -2072,17 +2211,64 @@ static /*PX_FORCE_INLINE*/ void doBipartiteBoxPruning_Leaf(
 {
 	PX_ASSERT(boxes0_X[nb0].isSentinel());
 	PX_ASSERT(boxes1_X[nb1].isSentinel());
-	boxPruningKernel<0>(nb0, nb1, boxes0_X, boxes1_X, boxes0_YZ, boxes1_YZ, remap0, remap1, pairManager, objects);
-	boxPruningKernel<1>(nb1, nb0, boxes1_X, boxes0_X, boxes1_YZ, boxes0_YZ, remap1, remap0, pairManager, objects);
+	boxPruningKernel<0>(0, nb0, 0, nb1, boxes0_X, boxes1_X, boxes0_YZ, boxes1_YZ, remap0, remap1, pairManager, objects);
+	boxPruningKernel<1>(0, nb1, 0, nb0, boxes1_X, boxes0_X, boxes1_YZ, boxes0_YZ, remap1, remap0, pairManager, objects);
 }
 
-static PX_FORCE_INLINE void doBipartiteBoxPruning_Leaf(ABP_PairManager* PX_RESTRICT pairManager, const ABPEntry* PX_RESTRICT objects,
+// PT: multithreaded version: records the two kernel calls instead of running them.
+static void doBipartiteBoxPruning_Leaf(
+		ABP_LeafRecorder* PX_RESTRICT recorder,
+		const ABPEntry* PX_RESTRICT objects,
+		PxU32 nb0,
+		PxU32 nb1,
+		const SIMD_AABB_X4* PX_RESTRICT boxes0_X,
+		const SIMD_AABB_X4* PX_RESTRICT boxes1_X,
+		const SIMD_AABB_YZ4* PX_RESTRICT boxes0_YZ,
+		const SIMD_AABB_YZ4* PX_RESTRICT boxes1_YZ,
+		const ABP_Index* PX_RESTRICT remap0,
+		const ABP_Index* PX_RESTRICT remap1
+		)
+{
+	PX_ASSERT(boxes0_X[nb0].isSentinel());
+	PX_ASSERT(boxes1_X[nb1].isSentinel());
+	if(!nb0 || !nb1)
+		return;
+
+	ABP_Leaf& leaf0 = recorder->mLeaves.insert();
+	leaf0.mType			= ABP_LEAF_BIPARTITE_0;
+	leaf0.mNb0			= nb0;
+	leaf0.mNb1			= nb1;
+	leaf0.mBoxes0_X		= boxes0_X;
+	leaf0.mBoxes1_X		= boxes1_X;
+	leaf0.mBoxes0_YZ	= boxes0_YZ;
+	leaf0.mBoxes1_YZ	= boxes1_YZ;
+	leaf0.mRemap0		= remap0;
+	leaf0.mRemap1		= remap1;
+	leaf0.mObjects		= objects;
+
+	ABP_Leaf& leaf1 = recorder->mLeaves.insert();
+	leaf1.mType			= ABP_LEAF_BIPARTITE_1;
+	leaf1.mNb0			= nb1;
+	leaf1.mNb1			= nb0;
+	leaf1.mBoxes0_X		= boxes1_X;
+	leaf1.mBoxes1_X		= boxes0_X;
+	leaf1.mBoxes0_YZ	= boxes1_YZ;
+	leaf1.mBoxes1_YZ	= boxes0_YZ;
+	leaf1.mRemap0		= remap1;
+	leaf1.mRemap1		= remap0;
+	leaf1.mObjects		= objects;
+}
+
+template<class PairManagerT>
+static PX_FORCE_INLINE void doBipartiteBoxPruning_Leaf(PairManagerT* PX_RESTRICT pairManager, const ABPEntry* PX_RESTRICT objects,
 		PxU32 nb0, PxU32 nb1, const SplitBoxes& boxes0, const SplitBoxes& boxes1, const ABP_Index* PX_RESTRICT remap0, const ABP_Index* PX_RESTRICT remap1)
 {
 	doBipartiteBoxPruning_Leaf(pairManager, objects, nb0, nb1, boxes0.getBoxes_X(), boxes1.getBoxes_X(), boxes0.getBoxes_YZ(), boxes1.getBoxes_YZ(), remap0, remap1);
 }
 
-static void doCompleteBoxPruning_Leaf(	ABP_PairManager* PX_RESTRICT pairManager, PxU32 nb,
+template<class PairManagerT>
+static void completeBoxPruningKernel(	PxU32 index0, PxU32 endIndex0, PxU32 runningIndex,
+										PairManagerT* PX_RESTRICT pairManager, PxU32 nb,
 										const SIMD_AABB_X4* PX_RESTRICT boxes_X,
 										const SIMD_AABB_YZ4* PX_RESTRICT boxes_YZ,
 										const ABP_Index* PX_RESTRICT remap,
@@ -2092,9 +2278,7 @@ static void doCompleteBoxPruning_Leaf(	ABP_PairManager* PX_RESTRICT pairManager,
 	pairManager->mInToOut1 = remap;
 	pairManager->mObjects = objects;
 
-	PxU32 index0 = 0;
-	PxU32 runningIndex = 0;
-	while(runningIndex<nb && index0<nb)
+	while(runningIndex<nb && index0<endIndex0)
 	{
 		const SIMD_AABB_X4& box0_X = boxes_X[index0];
 		const PosXType2 maxLimit = box0_X.mMaxX;
@@ -2230,6 +2414,38 @@ StartLoop:
 	}
 }
 
+static PX_FORCE_INLINE void doCompleteBoxPruning_Leaf(	ABP_PairManager* PX_RESTRICT pairManager, PxU32 nb,
+														const SIMD_AABB_X4* PX_RESTRICT boxes_X,
+														const SIMD_AABB_YZ4* PX_RESTRICT boxes_YZ,
+														const ABP_Index* PX_RESTRICT remap,
+														const ABPEntry* PX_RESTRICT objects)
+{
+	completeBoxPruningKernel(0, nb, 0, pairManager, nb, boxes_X, boxes_YZ, remap, objects);
+}
+
+// PT: multithreaded version: records the kernel call instead of running it.
+static void doCompleteBoxPruning_Leaf(	ABP_LeafRecorder* PX_RESTRICT recorder, PxU32 nb,
+										const SIMD_AABB_X4* PX_RESTRICT boxes_X,
+										const SIMD_AABB_YZ4* PX_RESTRICT boxes_YZ,
+										const ABP_Index* PX_RESTRICT remap,
+										const ABPEntry* PX_RESTRICT objects)
+{
+	if(!nb)
+		return;
+
+	ABP_Leaf& leaf = recorder->mLeaves.insert();
+	leaf.mType		= ABP_LEAF_COMPLETE;
+	leaf.mNb0		= nb;
+	leaf.mNb1		= nb;
+	leaf.mBoxes0_X	= boxes_X;
+	leaf.mBoxes1_X	= boxes_X;
+	leaf.mBoxes0_YZ	= boxes_YZ;
+	leaf.mBoxes1_YZ	= boxes_YZ;
+	leaf.mRemap0	= remap;
+	leaf.mRemap1	= remap;
+	leaf.mObjects	= objects;
+}
+
 #ifdef USE_ABP_BUCKETS
 static const PxU8 gCodes[] = {	4, 4, 4, 255, 4, 3, 2, 255,
 								4, 1, 0, 255, 255, 255, 255, 255 };
@@ -2255,9 +2471,10 @@ static PX_FORCE_INLINE PxU8 classifyBoxNew(const SIMD_AABB_YZ4& boxYZ, const flo
 
 //#include <stdio.h>
 #ifdef RECURSE_LIMIT
+template<class PairManagerT>
 static void CompleteBoxPruning_Recursive(
 	ABP_MM& memoryManager,
-	ABP_PairManager* PX_RESTRICT pairManager,
+	PairManagerT* PX_RESTRICT pairManager,
 	PxU32 nb,
 	const SIMD_AABB_X4* PX_RESTRICT listX,
 	const SIMD_AABB_YZ4* PX_RESTRICT listYZ,
@@ -2395,10 +2612,11 @@ static void CompleteBoxPruning_Recursive(
 #endif
 
 #ifndef USE_ALTERNATIVE_VERSION
+template<class PairManagerT>
 static void CompleteBoxPruning_Version16(
 	ABP_MM& memoryManager,
 	const PxBounds3& updatedBounds,
-	ABP_PairManager* PX_RESTRICT pairManager,
+	PairManagerT* PX_RESTRICT pairManager,
 	PxU32 nb,
 	const SIMD_AABB_X4* PX_RESTRICT listX,
 	const SIMD_AABB_YZ4* PX_RESTRICT listYZ,
@@ -2523,10 +2741,11 @@ static void CompleteBoxPruning_Version16(
 
 #ifdef USE_ALTERNATIVE_VERSION
 // PT: experimental version that adds all cross-bucket objects to all regular buckets
+template<class PairManagerT>
 static void CompleteBoxPruning_Version16(
-	ABP_MM& /*memoryManager*/,
+	ABP_MM& memoryManager,
 	const PxBounds3& updatedBounds,
-	ABP_PairManager* PX_RESTRICT pairManager,
+	PairManagerT* PX_RESTRICT pairManager,
 	PxU32 nb,
 	const SIMD_AABB_X4* PX_RESTRICT listX,
 	const SIMD_AABB_YZ4* PX_RESTRICT listYZ,
@@ -2545,7 +2764,7 @@ static void CompleteBoxPruning_Version16(
 	for(PxU32 i=0;i<NB_BUCKETS;i++)
 		Counters[i] = 0;
 
-	PxU8* Indices = (PxU8*)PX_ALLOC(sizeof(PxU8)*nb, PX_DEBUG_EXP("temp"));
+	PxU8* Indices = (PxU8*)memoryManager.frameAlloc(sizeof(PxU8)*nb);
 	for(PxU32 i=0;i<nb;i++)
 	{
 		const PxU8 index = classifyBoxNew(listYZ[i], limitY, limitZ);
@@ -2562,10 +2781,10 @@ static void CompleteBoxPruning_Version16(
 	}
 
 	// PT: TODO: revisit allocs
-	SIMD_AABB_X4* BoxListXBuffer = (SIMD_AABB_X4*)PX_ALLOC(sizeof(SIMD_AABB_X4)*(total+NB_SENTINELS*NB_BUCKETS), PX_DEBUG_EXP("temp"));
-	SIMD_AABB_YZ4* BoxListYZBuffer = (SIMD_AABB_YZ4*)PX_ALLOC(sizeof(SIMD_AABB_YZ4)*total, PX_DEBUG_EXP("temp"));
+	SIMD_AABB_X4* BoxListXBuffer = (SIMD_AABB_X4*)memoryManager.frameAlloc(sizeof(SIMD_AABB_X4)*(total+NB_SENTINELS*NB_BUCKETS));
+	SIMD_AABB_YZ4* BoxListYZBuffer = (SIMD_AABB_YZ4*)memoryManager.frameAlloc(sizeof(SIMD_AABB_YZ4)*total);
 
-	PxU32* Remap = (PxU32*)PX_ALLOC(sizeof(PxU32)*total, PX_DEBUG_EXP("temp"));
+	PxU32* Remap = (PxU32*)memoryManager.frameAlloc(sizeof(PxU32)*total);
 
 	SIMD_AABB_X4* CurrentBoxListXBuffer = BoxListXBuffer;
 	SIMD_AABB_YZ4* CurrentBoxListYZBuffer = BoxListYZBuffer;
@@ -2622,7 +2841,7 @@ static void CompleteBoxPruning_Version16(
 			TargetBoxListYZ[IndexInTarget] = listYZ[SortedIndex];
 		}
 	}
-	PX_FREE(Indices);
+	memoryManager.frameFree(Indices);
 
 	for(PxU32 i=0;i<4;i++)
 	{
@@ -2645,7 +2864,7 @@ static void CompleteBoxPruning_Version16(
 									objects);
 #ifdef RECURSE_LIMIT
 			else
-				CompleteBoxPruning_Recursive(	pairManager,
+				CompleteBoxPruning_Recursive(	memoryManager, pairManager,
 									Counters2[i],
 									BoxListX[i], BoxListYZ[i],
 									RemapBase[i],
@@ -2654,13 +2873,14 @@ static void CompleteBoxPruning_Version16(
 		}
 	}
 
-	PX_FREE(Remap);
-	PX_FREE(BoxListYZBuffer);
-	PX_FREE(BoxListXBuffer);
+	memoryManager.frameFree(Remap);
+	memoryManager.frameFree(BoxListYZBuffer);
+	memoryManager.frameFree(BoxListXBuffer);
 }
 #endif
 
-static void doCompleteBoxPruning_(ABP_MM& memoryManager, ABP_PairManager* PX_RESTRICT pairManager, const ABPEntry* PX_RESTRICT objects, const DynamicManager& mDBM)
+template<class PairManagerT>
+static void doCompleteBoxPruning_(ABP_MM& memoryManager, PairManagerT* PX_RESTRICT pairManager, const ABPEntry* PX_RESTRICT objects, const DynamicManager& mDBM)
 {
 	const PxU32 nbUpdated = mDBM.getNbUpdatedBoxes();
 	if(!nbUpdated)
@@ -2723,7 +2943,8 @@ void ABP::Region_prepareOverlaps()
 }
 
 // Finds static-vs-dynamic and dynamic-vs-dynamic overlaps
-static void findAllOverlaps(ABP_MM& memoryManager, ABP_PairManager& pairManager, const ABP_SharedData& mShared, const StaticManager& mSBM, const DynamicManager& mDBM, bool doComplete, bool doBipartite)
+template<class PairManagerT>
+static void findAllOverlaps(ABP_MM& memoryManager, PairManagerT& pairManager, const ABP_SharedData& mShared, const StaticManager& mSBM, const DynamicManager& mDBM, bool doComplete, bool doBipartite)
 {
 	const PxU32 nbUpdatedBoxes = mDBM.getNbUpdatedBoxes();
 
@@ -2768,11 +2989,9 @@ static void findAllOverlaps(ABP_MM& memoryManager, ABP_PairManager& pairManager,
 	}
 }
 
-void ABP::Region_findOverlaps(ABP_PairManager& pairManager)
+template<class PairManagerT>
+void ABP::Region_findAllOverlaps(PairManagerT& pairManager)
 {
-	if(!gPrepareOverlapsFlag)
-		Region_prepareOverlaps();
-
 	bool doKineKine = true;
 	bool doStaticKine = true;
 	#ifdef BP_FILTERING_USES_TYPE_IN_GROUP
@@ -2822,6 +3041,14 @@ void ABP::Region_findOverlaps(ABP_PairManager& pairManager)
 								mDBM.getRemap_Sleeping(), mKBM.getRemap_Updated()
 							);
 	}
+}
+
+void ABP::Region_findOverlaps(ABP_PairManager& pairManager)
+{
+	if(!gPrepareOverlapsFlag)
+		Region_prepareOverlaps();
+
+	Region_findAllOverlaps(pairManager);
 
 	mSBM.finalize();
 	mDBM.finalize();
@@ -2833,7 +3060,8 @@ void ABP::Region_findOverlaps(ABP_PairManager& pairManager)
 ABP::ABP() :
 	mSBM						(FilterType::STATIC),
 	mDBM						(FilterType::DYNAMIC),
-	mKBM						(FilterType::KINEMATIC)
+	mKBM						(FilterType::KINEMATIC),
+	mNextRange					(0)
 //	mTransientBounds			(NULL),
 //	mTransientContactDistance	(NULL)
 //	mTransientGroups			(NULL)
@@ -3040,6 +3268,159 @@ void ABP::findOverlaps(const Bp::FilterGroup::Enum* PX_RESTRICT groups
 	Region_findOverlaps(mPairManager);
 }
 
+// PT: replicates the running-index updates of the box-pruning kernels for boxes [index0, endIndex0[, without the
+// overlap tests. This gives us the starting point of the next range, as if all previous boxes had been processed.
+static PxU32 computeRunningIndex(const ABP_Leaf& leaf, PxU32 index0, PxU32 endIndex0, PxU32 runningIndex)
+{
+	const SIMD_AABB_X4* PX_RESTRICT boxes0_X = leaf.mBoxes0_X;
+	const SIMD_AABB_X4* PX_RESTRICT boxes1_X = leaf.mBoxes1_X;
+	const PxU32 nb1 = leaf.mNb1;
+
+	if(leaf.mType==ABP_LEAF_BIPARTITE_0)
+	{
+		while(runningIndex<nb1 && index0<endIndex0)
+		{
+			const PosXType2 minLimit = boxes0_X[index0++].mMinX;
+			while(boxes1_X[runningIndex].mMinX<minLimit)
+				runningIndex++;
+		}
+	}
+	else if(leaf.mType==ABP_LEAF_BIPARTITE_1)
+	{
+		while(runningIndex<nb1 && index0<endIndex0)
+		{
+			const PosXType2 minLimit = boxes0_X[index0++].mMinX;
+			while(boxes1_X[runningIndex].mMinX<=minLimit)
+				runningIndex++;
+		}
+	}
+	else
+	{
+		while(runningIndex<nb1 && index0<endIndex0)
+		{
+			const PosXType2 minLimit = boxes0_X[index0++].mMinX;
+			while(boxes1_X[runningIndex++].mMinX<minLimit);
+		}
+	}
+	return runningIndex;
+}
+
+PxU32 ABP::prepareParallelOverlaps(const Bp::FilterGroup::Enum* PX_RESTRICT groups
+#ifdef BP_FILTERING_USES_TYPE_IN_GROUP
+	, const bool* PX_RESTRICT lut
+#endif
+	)
+{
+	mPairManager.mGroups = groups;
+#ifdef BP_FILTERING_USES_TYPE_IN_GROUP
+	mPairManager.mLUT = lut;
+#endif
+
+	if(!gPrepareOverlapsFlag)
+		Region_prepareOverlaps();
+
+	// PT: the bucket buffers allocated by CompleteBoxPruning_Version16 must survive until the ranges have been processed
+	mMM.beginDeferred();
+
+	mLeaves.clear();
+	mRanges.clear();
+	{
+		ABP_LeafRecorder recorder(mLeaves);
+		Region_findAllOverlaps(recorder);
+	}
+
+	const PxU32 nbLeaves = mLeaves.size();
+	for(PxU32 i=0;i<nbLeaves;i++)
+	{
+		const ABP_Leaf& leaf = mLeaves[i];
+		PxU32 runningIndex = 0;
+		for(PxU32 start=0; start<leaf.mNb0; start+=ABP_MT_RANGE_SIZE)
+		{
+			// PT: the kernel stops as soon as the running index reaches the end of the second set
+			if(runningIndex>=leaf.mNb1)
+				break;
+
+			const PxU32 end = PxMin(start + ABP_MT_RANGE_SIZE, leaf.mNb0);
+
+			ABP_WorkRange& range = mRanges.insert();
+			range.mLeaf			= i;
+			range.mStart		= start;
+			range.mEnd			= end;
+			range.mRunningIndex	= runningIndex;
+
+			runningIndex = computeRunningIndex(leaf, start, end, runningIndex);
+		}
+	}
+
+	const PxU32 nbRanges = mRanges.size();
+	if(mPairBuffers.size()<nbRanges)
+		mPairBuffers.resize(nbRanges);
+
+	for(PxU32 i=0;i<nbRanges;i++)
+	{
+		ABP_PairBuffer& pairBuffer = mPairBuffers[i];
+		PX_ASSERT(!pairBuffer.mPairs.size());
+		pairBuffer.mGroups = groups;
+#ifdef BP_FILTERING_USES_TYPE_IN_GROUP
+		pairBuffer.mLUT = lut;
+#endif
+	}
+
+	mNextRange = 0;
+	return nbRanges;
+}
+
+// PT: called from each ABPUpdateWorkTask. Ranges are grabbed dynamically for load balancing: this does not
+// impact the results since each range has its own output buffer.
+void ABP::processParallelRanges()
+{
+	const PxU32 nbRanges = mRanges.size();
+	while(1)
+	{
+		const PxU32 rangeIndex = PxU32(Ps::atomicIncrement(&mNextRange) - 1);
+		if(rangeIndex>=nbRanges)
+			break;
+
+		const ABP_WorkRange& range = mRanges[rangeIndex];
+		const ABP_Leaf& leaf = mLeaves[range.mLeaf];
+		ABP_PairBuffer* pairBuffer = &mPairBuffers[rangeIndex];
+
+		if(leaf.mType==ABP_LEAF_BIPARTITE_0)
+			boxPruningKernel<0>(range.mStart, range.mEnd, range.mRunningIndex, leaf.mNb1,
+								leaf.mBoxes0_X, leaf.mBoxes1_X, leaf.mBoxes0_YZ, leaf.mBoxes1_YZ,
+								leaf.mRemap0, leaf.mRemap1, pairBuffer, leaf.mObjects);
+		else if(leaf.mType==ABP_LEAF_BIPARTITE_1)
+			boxPruningKernel<1>(range.mStart, range.mEnd, range.mRunningIndex, leaf.mNb1,
+								leaf.mBoxes0_X, leaf.mBoxes1_X, leaf.mBoxes0_YZ, leaf.mBoxes1_YZ,
+								leaf.mRemap0, leaf.mRemap1, pairBuffer, leaf.mObjects);
+		else
+			completeBoxPruningKernel(range.mStart, range.mEnd, range.mRunningIndex, pairBuffer, leaf.mNb0,
+								leaf.mBoxes0_X, leaf.mBoxes0_YZ, leaf.mRemap0, leaf.mObjects);
+	}
+}
+
+// PT: single-threaded. Merging in range order gives the pair manager the same sequence of pairs as the
+// single-threaded version, so the created/deleted pairs end up in the same order as well.
+void ABP::mergeParallelPairs()
+{
+	const PxU32 nbRanges = mRanges.size();
+	for(PxU32 i=0;i<nbRanges;i++)
+	{
+		Ps::Array<PxU32>& pairs = mPairBuffers[i].mPairs;
+		const PxU32 nb = pairs.size();
+		const PxU32* PX_RESTRICT ids = pairs.begin();
+		for(PxU32 j=0;j<nb;j+=2)
+			mPairManager.addPairInternal(ids[j], ids[j+1]);
+		pairs.clear();
+	}
+
+	mSBM.finalize();
+	mDBM.finalize();
+	mKBM.finalize();
+
+	mMM.releaseDeferred();
+}
+
 PxU32 ABP::finalize(BroadPhaseABP* mbp)
 {
 	mPairManager.computeCreatedDeletedPairs(mbp, mShared.mUpdatedObjects, mShared.mRemovedObjects);
@@ -3060,6 +3441,11 @@ void ABP::reset()
 	mPairManager.purge();
 	mShared.mUpdatedObjects.empty();
 	mShared.mRemovedObjects.empty();
+
+	mLeaves.reset();
+	mRanges.reset();
+	mPairBuffers.reset();
+	mMM.releaseDeferred();
 }
 
 // PT: TODO: is is really ok to use "transient" data in this function?
@@ -3093,8 +3479,10 @@ using namespace internalABP;
 BroadPhaseABP::BroadPhaseABP(	PxU32 maxNbBroadPhaseOverlaps,
 								PxU32 maxNbStaticShapes,
 								PxU32 maxNbDynamicShapes,
-								PxU64 /*contextID*/) :
-	mGroups		(NULL)
+								PxU64 contextID) :
+	mPostUpdateWorkTask	(contextID),
+	mContextID			(contextID),
+	mGroups				(NULL)
 #ifdef BP_FILTERING_USES_TYPE_IN_GROUP
 	,mLUT		(NULL)
 #endif
@@ -3110,15 +3498,20 @@ BroadPhaseABP::BroadPhaseABP(	PxU32 maxNbBroadPhaseOverlaps,
 
 BroadPhaseABP::~BroadPhaseABP()
 {
+	const PxU32 nbTasks = mUpdateWorkTasks.size();
+	for(PxU32 i=0;i<nbTasks;i++)
+		PX_DELETE(mUpdateWorkTasks[i]);
+
 	DELETESINGLE(mABP);
 }
 
-void BroadPhaseABP::update(const PxU32 /*numCpuTasks*/, PxcScratchAllocator* scratchAllocator, const BroadPhaseUpdateData& updateData, physx::PxBaseTask* /*continuation*/, physx::PxBaseTask* narrowPhaseUnblockTask)
+void BroadPhaseABP::update(const PxU32 numCpuTasks, PxcScratchAllocator* scratchAllocator, const BroadPhaseUpdateData& updateData, physx::PxBaseTask* continuation, physx::PxBaseTask* narrowPhaseUnblockTask)
 {
 #if PX_CHECKED
 	PX_CHECK_AND_RETURN(scratchAllocator, "BroadPhaseABP::update - scratchAllocator must be non-NULL \n");
 #endif
 	mABP->mMM.mScratchAllocator = scratchAllocator;
+	mABP->mRS.SetDispatcher(continuation && continuation->getTaskManager() ? continuation->getTaskManager()->getCpuDispatcher() : NULL);
 
 	// PT: TODO: move this out of update function
 	if(narrowPhaseUnblockTask)
@@ -3126,13 +3519,84 @@ void BroadPhaseABP::update(const PxU32 /*numCpuTasks*/, PxcScratchAllocator* scr
 
 	setUpdateData(updateData);
 
-	update();
+	if(!parallelUpdate(numCpuTasks, continuation))
+	{
+		update();
+		postUpdate();
+	}
+}
+
+bool BroadPhaseABP::parallelUpdate(PxU32 numCpuTasks, physx::PxBaseTask* continuation)
+{
+	if(numCpuTasks<2 || !continuation)
+		return false;
+
+	// PT: don't bother recording the work for small scenes, the serial version is faster there
+	if(mABP->mDBM.getNbUpdatedBoxes() + mABP->mKBM.getNbUpdatedBoxes() + mABP->mSBM.getNbUpdatedBoxes() < ABP_MT_RANGE_SIZE)
+		return false;
+
+	const PxU32 nbRanges = mABP->prepareParallelOverlaps(mGroups
+#ifdef BP_FILTERING_USES_TYPE_IN_GROUP
+		, mLUT
+#endif
+		);
+
+	// PT: the work has been recorded already so we cannot go back to the serial version. Just run it in this thread.
+	if(nbRanges<2)
+	{
+		parallelUpdateWork();
+		parallelPostUpdate();
+		return true;
+	}
+
+	const PxU32 nbTasks = PxMin(numCpuTasks, nbRanges);
+	while(mUpdateWorkTasks.size()<nbTasks)
+		mUpdateWorkTasks.pushBack(PX_NEW(ABPUpdateWorkTask)(mContextID));
+
+	mPostUpdateWorkTask.set(this);
+	mPostUpdateWorkTask.setContinuation(continuation);
+
+	for(PxU32 i=0;i<nbTasks;i++)
+	{
+		mUpdateWorkTasks[i]->set(this);
+		mUpdateWorkTasks[i]->setContinuation(&mPostUpdateWorkTask);
+	}
+
+	mPostUpdateWorkTask.removeReference();
+
+	for(PxU32 i=0;i<nbTasks;i++)
+		mUpdateWorkTasks[i]->removeReference();
+
+	return true;
+}
+
+void BroadPhaseABP::parallelUpdateWork()
+{
+	PX_PROFILE_ZONE("BroadPhase.ABPUpdateWork", mContextID);
+	mABP->processParallelRanges();
+}
+
+void BroadPhaseABP::parallelPostUpdate()
+{
+	PX_PROFILE_ZONE("BroadPhase.ABPPostUpdate", mContextID);
+	mABP->mergeParallelPairs();
 	postUpdate();
 }
 
+void ABPUpdateWorkTask::runInternal()
+{
+	mABP->parallelUpdateWork();
+}
+
+void ABPPostUpdateWorkTask::runInternal()
+{
+	mABP->parallelPostUpdate();
+}
+
 void BroadPhaseABP::singleThreadedUpdate(PxcScratchAllocator* scratchAllocator, const BroadPhaseUpdateData& updateData)
 {
 	mABP->mMM.mScratchAllocator = scratchAllocator;
+	mABP->mRS.SetDispatcher(NULL);
 	setUpdateData(updateData);
 	update();
 	postUpdate();
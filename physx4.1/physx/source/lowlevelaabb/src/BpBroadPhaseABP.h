@@ -35,6 +35,7 @@
 #include "PxPhysXConfig.h"
 #include "BpBroadPhaseUpdate.h"
 #include "PsUserAllocated.h"
+#include "BpABPTasks.h"
 
 namespace internalABP{
 	class ABP;
@@ -75,6 +76,10 @@ namespace Bp
 
 		internalABP::ABP*					mABP;		// PT: TODO: aggregate
 
+				Ps::Array<ABPUpdateWorkTask*>	mUpdateWorkTasks;
+				ABPPostUpdateWorkTask		mPostUpdateWorkTask;
+				PxU64						mContextID;
+
 				Ps::Array<BroadPhasePair>	mCreated;
 				Ps::Array<BroadPhasePair>	mDeleted;
 
@@ -90,6 +95,12 @@ namespace Bp
 				void						update();
 				void						postUpdate();
 
+				// PT: multithreaded version of update()/postUpdate(). Returns false when there is not enough work for the
+				// task split to pay off, in which case nothing has been done and the caller should run the serial version.
+				bool						parallelUpdate(PxU32 numCpuTasks, physx::PxBaseTask* continuation);
+				void						parallelUpdateWork();
+				void						parallelPostUpdate();
+
 				PxU32						getCurrentNbPairs()	const;
 				void						setScratchAllocator(PxcScratchAllocator* scratchAllocator);
 	};
@@ -441,7 +441,7 @@ static PX_FORCE_INLINE void clearBit(BitArray& bitmap, MBP_ObjectIndex objectInd
 		void				removeObject(MBP_Index handle);
 		MBP_Handle			retrieveBounds(MBP_AABB& bounds, MBP_Index handle)	const;
 		void				setBounds(MBP_Index handle, const MBP_AABB& bounds);
-		void				prepareOverlaps();
+		void				prepareOverlaps(PxCpuDispatcher* dispatcher);
 		void				findOverlaps(MBP_PairManager& pairManager);
 
 //		private:
@@ -470,7 +470,7 @@ static PX_FORCE_INLINE void clearBit(BitArray& bitmap, MBP_ObjectIndex objectInd
 
 		void				optimizeMemory();
 		void				resizeObjects();
-		void				staticSort();
+		void				staticSort(PxCpuDispatcher* dispatcher);
 		void				preparePruning(MBPOS_TmpBuffers& buffers);
 		void				prepareBIPPruning(const MBPOS_TmpBuffers& buffers);
 	};
@@ -509,7 +509,7 @@ struct RegionData : public Ps::UserAllocated
 						bool					updateObject(MBP_Handle handle, const MBP_AABB& box);
 						bool					updateObjectAfterRegionRemoval(MBP_Handle handle, Region* removedRegion);
 						bool					updateObjectAfterNewRegionAdded(MBP_Handle handle, const MBP_AABB& box, Region* addedRegion, PxU32 regionIndex);
-						void					prepareOverlaps();
+						void					prepareOverlaps(PxCpuDispatcher* dispatcher);
 						void					findOverlaps(const Bp::FilterGroup::Enum* PX_RESTRICT groups
 #ifdef BP_FILTERING_USES_TYPE_IN_GROUP
 	, const bool* PX_RESTRICT lut
@@ -721,7 +721,7 @@ Region::~Region()
 #define STACK_BUFFER_SIZE_STATIC_SORT	8192
 	#define DEFAULT_NUM_DYNAMIC_BOXES 1024
 
-void Region::staticSort()
+void Region::staticSort(PxCpuDispatcher* dispatcher)
 {
 	// For now this version is only compatible with:
 	// MBP_USE_WORDS
@@ -786,6 +786,8 @@ void Region::staticSort()
 	}
 	else
 	{
+		// PT: large static sets are sorted in parallel when a dispatcher is available
+		RS.SetDispatcher(dispatcher);
 		sorted = RS.Sort(minPosList_ToSort, nbToSort, RADIX_UNSIGNED).GetRanks();
 	}
 
@@ -1649,14 +1651,14 @@ static void doBipartiteBoxPruning(MBP_PairManager* PX_RESTRICT pairManager, cons
 //	((MBP_AABB* PX_RESTRICT)staticBoxes)[nb1+1] = Saved1;
 }
 
-void Region::prepareOverlaps()
+void Region::prepareOverlaps(PxCpuDispatcher* dispatcher)
 {
 	if(!mNbUpdatedBoxes && !mNeedsSorting)
 		return;
 
 	if(mNeedsSorting)
 	{
-		staticSort();
+		staticSort(dispatcher);
 
 		// PT: when a static object is added/removed/updated we need to compute the overlaps again
 		// even if no dynamic box has been updated. The line below forces all dynamic boxes to be
@@ -2812,14 +2814,14 @@ bool MBP_PairManager::computeCreatedDeletedPairs(const MBP_Object* objects, Broa
 	return true;
 }
 
-void MBP::prepareOverlaps()
+void MBP::prepareOverlaps(PxCpuDispatcher* dispatcher)
 {
 	const PxU32 nb = mNbRegions;
 	const RegionData* PX_RESTRICT regions = mRegions.begin();
 	for(PxU32 i=0;i<nb;i++)
 	{
 		if(regions[i].mBP)
-			regions[i].mBP->prepareOverlaps();
+			regions[i].mBP->prepareOverlaps(dispatcher);
 	}
 }
 
@@ -2959,6 +2961,7 @@ BroadPhaseMBP::BroadPhaseMBP(	PxU32 maxNbRegions,
 #ifdef BP_FILTERING_USES_TYPE_IN_GROUP
 	,mLUT					(NULL)
 #endif
+	,mDispatcher			(NULL)
 {
 	mMBP = PX_NEW(MBP)();
 
@@ -3068,6 +3071,7 @@ void BroadPhaseMBP::update(const PxU32 numCpuTasks, PxcScratchAllocator* scratch
 	if(narrowPhaseUnblockTask)
 		narrowPhaseUnblockTask->removeReference();
 
+	mDispatcher = continuation && continuation->getTaskManager() ? continuation->getTaskManager()->getCpuDispatcher() : NULL;
 	setUpdateData(updateData);
 
 	if(1)
@@ -3091,6 +3095,7 @@ void BroadPhaseMBP::update(const PxU32 numCpuTasks, PxcScratchAllocator* scratch
 void BroadPhaseMBP::singleThreadedUpdate(PxcScratchAllocator* /*scratchAllocator*/, const BroadPhaseUpdateData& updateData)
 {
 	// PT: TODO: the scratchAllocator isn't actually needed, is it?
+	mDispatcher = NULL;
 	setUpdateData(updateData);
 	update();
 	postUpdate();
@@ -3266,7 +3271,7 @@ void BroadPhaseMBP::setUpdateData(const BroadPhaseUpdateData& updateData)
 	PX_ASSERT(!mCreated.size());
 	PX_ASSERT(!mDeleted.size());
 
-	mMBP->prepareOverlaps();
+	mMBP->prepareOverlaps(mDispatcher);
 }
 
 void BroadPhaseMBP::update()
@@ -98,6 +98,7 @@ namespace Bp
 #ifdef BP_FILTERING_USES_TYPE_IN_GROUP
 				const bool*					mLUT;
 #endif
+				PxCpuDispatcher*			mDispatcher;	// Used to sort large sets of static boxes in parallel, NULL in single-threaded updates
 				void						setUpdateData(const BroadPhaseUpdateData& updateData);
 				void						addObjects(const BroadPhaseUpdateData& updateData);
 				void						removeObjects(const BroadPhaseUpdateData& updateData);
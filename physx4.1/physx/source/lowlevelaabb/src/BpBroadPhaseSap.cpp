@@ -54,6 +54,7 @@ BroadPhaseSap::BroadPhaseSap(
 	const PxU32 maxNbDynamicShapes,
 	PxU64 contextID) :
 	mScratchAllocator		(NULL),
+	mDispatcher				(NULL),
 	mSapUpdateWorkTask		(contextID),
 	mSapPostUpdateWorkTask	(contextID),
 	mContextID				(contextID)
@@ -465,6 +466,7 @@ void BroadPhaseSap::update(const PxU32 numCpuTasks, PxcScratchAllocator* scratch
 	if(setUpdateData(updateData))
 	{
 		mScratchAllocator = scratchAllocator;
+		mDispatcher = continuation && continuation->getTaskManager() ? continuation->getTaskManager()->getCpuDispatcher() : NULL;
 
 		resizeBuffers();
 
@@ -491,6 +493,7 @@ void BroadPhaseSap::singleThreadedUpdate(PxcScratchAllocator* scratchAllocator,
 	if(setUpdateData(updateData))
 	{
 		mScratchAllocator = scratchAllocator;
+		mDispatcher = NULL;
 		resizeBuffers();
 		update();
 		postUpdate();
@@ -926,6 +929,7 @@ void BroadPhaseSap::batchCreate()
 
 		// PT: TODO: use the scratch allocator
 		Cm::RadixSortBuffered RS;
+		RS.SetDispatcher(mDispatcher);
 
 		for(PxU32 Axis=0;Axis<3;Axis++)
 		{
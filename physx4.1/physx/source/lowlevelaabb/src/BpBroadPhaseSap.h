@@ -137,6 +137,7 @@ private:
 			void						resizeBuffers();
 
 			PxcScratchAllocator*		mScratchAllocator;
+			PxCpuDispatcher*			mDispatcher;	// Used to sort large batches of new boxes in parallel, NULL in single-threaded updates
 
 			SapUpdateWorkTask			mSapUpdateWorkTask;
 			SapPostUpdateWorkTask		mSapPostUpdateWorkTask;
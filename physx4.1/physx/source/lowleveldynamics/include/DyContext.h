@@ -156,6 +156,19 @@ public:
 	*/
 	PX_FORCE_INLINE void				setSolverArticBatchSize(PxU32 f) { mSolverArticBatchSize = f; }
 
+	/**
+	\brief Returns true if the constraints of large islands are assigned to partitions over the worker threads
+	*/
+	PX_FORCE_INLINE bool				getParallelPartitioning()			const	{ return mParallelPartitioning;	}
+	/**
+	\brief Enables the parallel partitioning of the constraints of large islands. See PxSceneFlag::eENABLE_PARALLEL_PARTITIONING.
+	*/
+	PX_FORCE_INLINE void				setParallelPartitioning(bool b)			{ mParallelPartitioning = b;	}
+	/**
+	\brief Returns true if the solver orders bodies and constraints canonically. See PxSceneFlag::eENABLE_ENHANCED_DETERMINISM.
+	*/
+	PX_FORCE_INLINE bool				getEnhancedDeterminism()			const	{ return mUseEnhancedDeterminism;	}
+
 
 
 	/**
@@ -281,6 +294,7 @@ protected:
 		mUseAdaptiveForce			(useAdaptiveForce),
 		mBounceThreshold(-2.0f),
 		mSolverBatchSize(32),
+		mParallelPartitioning(false),
 		mConstraintWriteBackPool(Ps::VirtualAllocator(allocatorCallback)),
 		mSimStats(simStats)
 		 {
@@ -364,6 +378,11 @@ protected:
 	*/
 	PxU32						mSolverArticBatchSize;
 
+	/**
+	\brief True to assign the constraints of large islands to partitions over the worker threads
+	*/
+	bool						mParallelPartitioning;
+
 	/**
 	\brief The current friction model being used
 	*/
@@ -410,6 +429,11 @@ Context* createTGSDynamicsContext(PxcNpMemBlockPool* memBlockPool,
 	const bool enableStabilization, const bool useEnhancedDeterminism, const bool useAdaptiveForce, const PxReal lengthScale
 );
 
+/**
+\brief Returns the size in bytes of a friction patch, as cached by contact managers from one frame to the next.
+*/
+PxU32 getFrictionPatchSize();
+
 
 }
 
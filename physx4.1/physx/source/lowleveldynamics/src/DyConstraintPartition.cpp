@@ -27,6 +27,7 @@
 
 #include "DyConstraintPartition.h"
 #include "DyArticulationUtils.h"
+#include "CmChunkedJob.h"
 
 #define INTERLEAVE_SELF_CONSTRAINTS 1
 
@@ -58,6 +59,13 @@ PX_FORCE_INLINE PxU32 getArticulationIndex(const uintptr_t eaArticulation, const
 
 #define MAX_NUM_PARTITIONS 32
 
+//Keys recorded by the classification for the parallel write of the constraints. A dynamic constraint records its partition. A static
+//constraint records its rank among the static constraints of its body, its partition is only known once all dynamic constraints are
+//classified.
+#define STATIC_CONSTRAINT_KEY		(1u << 31)
+#define STATIC_CONSTRAINT_KEY_B		(1u << 30)
+#define INVALID_CONSTRAINT_KEY		0xffffffff
+
 
 class RigidBodyClassification
 {
@@ -132,12 +140,33 @@ public:
 		}
 	}
 
+	//Must be called before recordStaticConstraint. Mirrors getStaticContactWriteIndex.
+	PX_FORCE_INLINE PxU32 getStaticConstraintKey(const PxSolverConstraintDesc& desc, bool activeA, bool activeB) const
+	{
+		if (activeA)
+			return STATIC_CONSTRAINT_KEY | desc.bodyA->maxSolverFrictionProgress;
+		else if (activeB)
+			return STATIC_CONSTRAINT_KEY | STATIC_CONSTRAINT_KEY_B | desc.bodyB->maxSolverFrictionProgress;
+
+		return INVALID_CONSTRAINT_KEY;
+	}
+
 	PX_FORCE_INLINE void clearState()
 	{
 		for(PxU32 a = 0; a < mBodySize; a+= mBodyStride)
 			reinterpret_cast<PxSolverBody*>(mBodies+a)->solverProgress = 0;
 	}
 
+	//Sets maxSolverNormalProgress from the partitions used by the dynamic constraints of each body, for the parallel classification
+	PX_FORCE_INLINE void storeMaxPartitions()
+	{
+		for(PxU32 a = 0; a < mBodySize; a+= mBodyStride)
+		{
+			PxSolverBody& body = *reinterpret_cast<PxSolverBody*>(mBodies+a);
+			body.maxSolverNormalProgress = PxU16(body.solverProgress ? Ps::highestSetBit(body.solverProgress) + 1 : 0);
+		}
+	}
+
 	PX_FORCE_INLINE void reserveSpaceForStaticConstraints(Ps::Array<PxU32>& numConstraintsPerPartition)
 	{
 		for(PxU32 a = 0; a < mBodySize; a += mBodyStride)
@@ -292,6 +321,13 @@ public:
 		}
 	}
 
+	//The parallel write is not used with articulations, which can store static constraints themselves
+	PX_FORCE_INLINE PxU32 getStaticConstraintKey(const PxSolverConstraintDesc&, bool, bool) const
+	{
+		PX_ASSERT(0);
+		return INVALID_CONSTRAINT_KEY;
+	}
+
 	PX_FORCE_INLINE void recordStaticConstraint(const PxSolverConstraintDesc& desc, bool& activeA, bool& activeB)
 	{
 		if (activeA)
@@ -406,64 +442,12 @@ public:
 
 };
 
+//Classifies the constraints that did not fit in the first 32 partitions, 32 partitions at a time
 template <typename Classification>
-void classifyConstraintDesc(const PxSolverConstraintDesc* PX_RESTRICT descs, const PxU32 numConstraints, Classification& classification, 
-							Ps::Array<PxU32>& numConstraintsPerPartition, PxSolverConstraintDesc* PX_RESTRICT eaTempConstraintDescriptors)
+void classifyUnpartitionedConstraints(PxU32 numUnpartitionedConstraints, Classification& classification, Ps::Array<PxU32>& numConstraintsPerPartition,
+									  PxSolverConstraintDesc* PX_RESTRICT eaTempConstraintDescriptors, PxU32* PX_RESTRICT constraintKeys,
+									  PxU32* PX_RESTRICT unpartitionedIndices)
 {
-	const PxSolverConstraintDesc* _desc = descs;
-	const PxU32 numConstraintsMin1 = numConstraints - 1;
-
-	PxU32 numUnpartitionedConstraints = 0;
-
-	numConstraintsPerPartition.forceSize_Unsafe(32);
-
-	PxMemZero(numConstraintsPerPartition.begin(), sizeof(PxU32) * 32);
-
-	for(PxU32 i = 0; i < numConstraints; ++i, _desc++)
-	{
-		const PxU32 prefetchOffset = PxMin(numConstraintsMin1 - i, 4u);
-		Ps::prefetchLine(_desc[prefetchOffset].constraint);
-		Ps::prefetchLine(_desc[prefetchOffset].bodyA);
-		Ps::prefetchLine(_desc[prefetchOffset].bodyB);
-		Ps::prefetchLine(_desc + 8);
-
-		uintptr_t indexA, indexB;
-		bool activeA, activeB;
-
-		PxU32 partitionsA, partitionsB;
-		const bool notContainsStatic = classification.classifyConstraint(*_desc, indexA, indexB, activeA, activeB,
-			partitionsA, partitionsB);
-		
-		if(notContainsStatic)
-		{			
-			PxU32 availablePartition;
-			{
-				const PxU32 combinedMask = (~partitionsA & ~partitionsB);
-				availablePartition = combinedMask == 0 ? MAX_NUM_PARTITIONS : Ps::lowestSetBit(combinedMask);
-				if(availablePartition == MAX_NUM_PARTITIONS)
-				{
-					eaTempConstraintDescriptors[numUnpartitionedConstraints++] = *_desc;
-					continue;
-				}
-
-				const PxU32 partitionBit = (1u << availablePartition);
-				if (activeA)
-					partitionsA |= partitionBit;
-				if(activeB)
-					partitionsB |= partitionBit;
-			}
-
-			numConstraintsPerPartition[availablePartition]++;
-			availablePartition++;
-
-			classification.storeProgress(*_desc, partitionsA, partitionsB, PxU16(availablePartition));
-		}
-		else
-		{
-			classification.recordStaticConstraint(*_desc, activeA, activeB);
-		}
-	}
-
 	PxU32 partitionStartIndex = 0;
 
 	while(numUnpartitionedConstraints > 0)
@@ -493,6 +477,8 @@ void classifyConstraintDesc(const PxSolverConstraintDesc* PX_RESTRICT descs, con
 				if(availablePartition == MAX_NUM_PARTITIONS)
 				{
 					//Need to shuffle around unpartitioned constraints...
+					if(unpartitionedIndices)
+						unpartitionedIndices[newNumUnpartitionedConstraints] = unpartitionedIndices[i];
 					eaTempConstraintDescriptors[newNumUnpartitionedConstraints++] = desc;
 					continue;
 				}
@@ -508,6 +494,8 @@ void classifyConstraintDesc(const PxSolverConstraintDesc* PX_RESTRICT descs, con
 			/*desc.bodyA->solverProgress = partitionsA;
 			desc.bodyB->solverProgress = partitionsB;*/
 			availablePartition += partitionStartIndex;
+			if(constraintKeys)
+				constraintKeys[unpartitionedIndices[i]] = availablePartition;
 			numConstraintsPerPartition[availablePartition]++;
 			availablePartition++;
 
@@ -519,6 +507,79 @@ void classifyConstraintDesc(const PxSolverConstraintDesc* PX_RESTRICT descs, con
 
 		numUnpartitionedConstraints = newNumUnpartitionedConstraints;
 	}
+}
+
+//If constraintKeys is not NULL, records the partition of each constraint for writeConstraintDescParallel. unpartitionedIndices then
+//tracks the original indices of the constraints that do not fit in the current set of 32 partitions.
+template <typename Classification>
+void classifyConstraintDesc(const PxSolverConstraintDesc* PX_RESTRICT descs, const PxU32 numConstraints, Classification& classification, 
+							Ps::Array<PxU32>& numConstraintsPerPartition, PxSolverConstraintDesc* PX_RESTRICT eaTempConstraintDescriptors,
+							PxU32* PX_RESTRICT constraintKeys, PxU32* PX_RESTRICT unpartitionedIndices)
+{
+	const PxSolverConstraintDesc* _desc = descs;
+	const PxU32 numConstraintsMin1 = numConstraints - 1;
+
+	PxU32 numUnpartitionedConstraints = 0;
+
+	numConstraintsPerPartition.forceSize_Unsafe(32);
+
+	PxMemZero(numConstraintsPerPartition.begin(), sizeof(PxU32) * 32);
+
+	for(PxU32 i = 0; i < numConstraints; ++i, _desc++)
+	{
+		const PxU32 prefetchOffset = PxMin(numConstraintsMin1 - i, 4u);
+		Ps::prefetchLine(_desc[prefetchOffset].constraint);
+		Ps::prefetchLine(_desc[prefetchOffset].bodyA);
+		Ps::prefetchLine(_desc[prefetchOffset].bodyB);
+		Ps::prefetchLine(_desc + 8);
+
+		uintptr_t indexA, indexB;
+		bool activeA, activeB;
+
+		PxU32 partitionsA, partitionsB;
+		const bool notContainsStatic = classification.classifyConstraint(*_desc, indexA, indexB, activeA, activeB,
+			partitionsA, partitionsB);
+		
+		if(notContainsStatic)
+		{			
+			PxU32 availablePartition;
+			{
+				const PxU32 combinedMask = (~partitionsA & ~partitionsB);
+				availablePartition = combinedMask == 0 ? MAX_NUM_PARTITIONS : Ps::lowestSetBit(combinedMask);
+				if(availablePartition == MAX_NUM_PARTITIONS)
+				{
+					if(unpartitionedIndices)
+						unpartitionedIndices[numUnpartitionedConstraints] = i;
+					eaTempConstraintDescriptors[numUnpartitionedConstraints++] = *_desc;
+					continue;
+				}
+
+				const PxU32 partitionBit = (1u << availablePartition);
+				if (activeA)
+					partitionsA |= partitionBit;
+				if(activeB)
+					partitionsB |= partitionBit;
+			}
+
+			if(constraintKeys)
+				constraintKeys[i] = availablePartition;
+
+			numConstraintsPerPartition[availablePartition]++;
+			availablePartition++;
+
+			classification.storeProgress(*_desc, partitionsA, partitionsB, PxU16(availablePartition));
+		}
+		else
+		{
+			if(constraintKeys)
+				constraintKeys[i] = classification.getStaticConstraintKey(*_desc, activeA, activeB);
+
+			classification.recordStaticConstraint(*_desc, activeA, activeB);
+		}
+	}
+
+	classifyUnpartitionedConstraints(numUnpartitionedConstraints, classification, numConstraintsPerPartition, eaTempConstraintDescriptors,
+		constraintKeys, unpartitionedIndices);
 
 	classification.reserveSpaceForStaticConstraints(numConstraintsPerPartition);
 
@@ -640,6 +701,370 @@ PxU32 writeConstraintDesc(const PxSolverConstraintDesc* PX_RESTRICT descs, const
 	return numStaticConstraints;
 }
 
+#define PARALLEL_WRITE_THRESHOLD	8192	//Minimum number of constraints for the parallel write
+#define PARALLEL_WRITE_MIN_CHUNK	2048
+#define PARALLEL_WRITE_MAX_CHUNKS	64
+
+//Writes the constraints in the same order as writeConstraintDesc, from the keys recorded by classifyConstraintDesc. This is a stable
+//counting sort on the partitions: each chunk counts its constraints per partition, then scatters them after the ones of the previous
+//chunks. Within a partition, constraints placed by the first pass over all constraints (including the static ones) come before those
+//placed by the passes over the unpartitioned constraints, as in writeConstraintDesc.
+class PartitionWriteJob : public Cm::ChunkedJob
+{
+public:
+	PartitionWriteJob(bool scatter, const PxSolverConstraintDesc* descs, PxU32 numConstraints, PxU32 chunkSize, PxU32* keys, PxU32* chunkCounts,
+		PxU32 numPartitions, PxSolverConstraintDesc* orderedDescs) :
+		Cm::ChunkedJob(numConstraints, chunkSize),
+		mScatter(scatter), mDescs(descs), mKeys(keys), mChunkCounts(chunkCounts), mNumPartitions(numPartitions), mOrderedDescs(orderedDescs)
+	{
+	}
+
+	virtual void process(PxU32 start, PxU32 end)
+	{
+		//Two counters per partition and chunk, for the first pass and the later passes
+		PxU32* PX_RESTRICT counts = mChunkCounts + (start / getChunkSize()) * mNumPartitions * 2;
+		PxU32* PX_RESTRICT keys = mKeys;
+
+		if(!mScatter)
+		{
+			PxMemZero(counts, sizeof(PxU32) * mNumPartitions * 2);
+
+			for(PxU32 i = start; i < end; ++i)
+			{
+				const PxU32 key = keys[i];
+				if(key == INVALID_CONSTRAINT_KEY)
+					continue;
+
+				PxU32 slot;
+				if(key & STATIC_CONSTRAINT_KEY)
+				{
+					const PxSolverBody* body = (key & STATIC_CONSTRAINT_KEY_B) ? mDescs[i].bodyB : mDescs[i].bodyA;
+					slot = (body->maxSolverNormalProgress + (key & (STATIC_CONSTRAINT_KEY_B - 1))) * 2;
+				}
+				else
+				{
+					slot = key * 2 + (key >= MAX_NUM_PARTITIONS ? 1 : 0);
+				}
+				PX_ASSERT(slot < mNumPartitions * 2);
+				keys[i] = slot;
+				counts[slot]++;
+			}
+		}
+		else
+		{
+			for(PxU32 i = start; i < end; ++i)
+			{
+				const PxU32 slot = keys[i];
+				if(slot != INVALID_CONSTRAINT_KEY)
+					mOrderedDescs[counts[slot]++] = mDescs[i];
+			}
+		}
+	}
+
+private:
+	PX_NOCOPY(PartitionWriteJob)
+
+	const bool						mScatter;
+	const PxSolverConstraintDesc*	mDescs;
+	PxU32*							mKeys;
+	PxU32*							mChunkCounts;
+	const PxU32						mNumPartitions;
+	PxSolverConstraintDesc*			mOrderedDescs;
+};
+
+void writeConstraintDescParallel(PxCpuDispatcher* dispatcher, const PxSolverConstraintDesc* PX_RESTRICT descs, const PxU32 numConstraints,
+	Ps::Array<PxU32>& accumulatedConstraintsPerPartition, PxU32* keys, Ps::Array<PxU32>& chunkCounts, PxSolverConstraintDesc* PX_RESTRICT eaOrderedConstraintDesc)
+{
+	const PxU32 numPartitions = accumulatedConstraintsPerPartition.size();
+	const PxU32 chunkSize = PxMax(PxU32(PARALLEL_WRITE_MIN_CHUNK), (numConstraints + PARALLEL_WRITE_MAX_CHUNKS - 1) / PARALLEL_WRITE_MAX_CHUNKS);
+	const PxU32 numChunks = (numConstraints + chunkSize - 1) / chunkSize;
+
+	chunkCounts.resizeUninitialized(numChunks * numPartitions * 2);
+	PxU32* counts = chunkCounts.begin();
+
+	{
+		PartitionWriteJob* job = PX_NEW(PartitionWriteJob)(false, descs, numConstraints, chunkSize, keys, counts, numPartitions, NULL);
+		job->run(dispatcher, 0);
+		job->releaseRef();
+	}
+
+	//Turn the counters into write offsets
+	for(PxU32 p = 0; p < numPartitions; ++p)
+	{
+		PxU32 offset = accumulatedConstraintsPerPartition[p];
+		for(PxU32 pass = 0; pass < 2; ++pass)
+		{
+			for(PxU32 c = 0; c < numChunks; ++c)
+			{
+				PxU32& count = counts[(c * numPartitions + p) * 2 + pass];
+				const PxU32 nb = count;
+				count = offset;
+				offset += nb;
+			}
+		}
+		//Like writeConstraintDesc, leave each entry at the end of its partition
+		accumulatedConstraintsPerPartition[p] = offset;
+	}
+
+	{
+		PartitionWriteJob* job = PX_NEW(PartitionWriteJob)(true, descs, numConstraints, chunkSize, keys, counts, numPartitions, eaOrderedConstraintDesc);
+		job->run(dispatcher, 0);
+		job->releaseRef();
+	}
+}
+
+#define PARALLEL_CLASSIFY_MIN_RANGE		1024	//Minimum number of bodies per range
+#define PARALLEL_CLASSIFY_MAX_RANGES	32		//Maximum number of ranges of bodies, which are classified concurrently
+#define PARALLEL_CLASSIFY_MAX_ROUNDS	4		//Rounds of parallel classification, before the remaining constraints are classified serially
+
+//Keys of the constraints during the parallel classification
+#define UNCLASSIFIED_CONSTRAINT_KEY		0xffffff80	//Not classified yet
+#define DEFERRED_CONSTRAINT_KEY			0xffffff81	//Dynamic constraint that does not fit in the first 32 partitions
+
+//Classifies a constraint like the first pass of classifyConstraintDesc, with a key for writeConstraintDescParallel
+PX_FORCE_INLINE void classifyConstraintKey(const PxSolverConstraintDesc& desc, RigidBodyClassification& classification, PxU32& key,
+	PxU32* PX_RESTRICT numConstraintsPerPartition)
+{
+	uintptr_t indexA, indexB;
+	bool activeA, activeB;
+	PxU32 partitionsA, partitionsB;
+	if(classification.classifyConstraint(desc, indexA, indexB, activeA, activeB, partitionsA, partitionsB))
+	{
+		const PxU32 combinedMask = (~partitionsA & ~partitionsB);
+		if(combinedMask == 0)
+		{
+			key = DEFERRED_CONSTRAINT_KEY;
+			return;
+		}
+
+		const PxU32 availablePartition = Ps::lowestSetBit(combinedMask);
+		const PxU32 partitionBit = (1u << availablePartition);
+		classification.storeProgress(desc, partitionsA | partitionBit, partitionsB | partitionBit);
+		numConstraintsPerPartition[availablePartition]++;
+		key = availablePartition;
+	}
+	else
+	{
+		key = classification.getStaticConstraintKey(desc, activeA, activeB);
+		classification.recordStaticConstraint(desc, activeA, activeB);
+	}
+}
+
+//Sorts the constraints that are still unclassified by range of bodies. A constraint whose bodies are in the same range goes to the
+//bucket of that range, the others go to a last bucket, for the next round. Like PartitionWriteJob, this is a stable counting sort over
+//chunks of constraints, so each bucket keeps the constraint order.
+class RangeSortJob : public Cm::ChunkedJob
+{
+public:
+	RangeSortJob(bool scatter, const PxSolverConstraintDesc* descs, const PxU32* indices, PxU32 numIndices, PxU32 chunkSize,
+		const RigidBodyClassification& classification, PxU32 rangeSize, PxU32 rangeOffset, PxU32 numBuckets, PxU32* chunkCounts,
+		PxU32* sortedIndices) :
+		Cm::ChunkedJob(numIndices, chunkSize),
+		mScatter(scatter), mDescs(descs), mIndices(indices), mClassification(classification), mRangeSize(rangeSize), mRangeOffset(rangeOffset),
+		mNumBuckets(numBuckets), mChunkCounts(chunkCounts), mSortedIndices(sortedIndices)
+	{
+	}
+
+	virtual void process(PxU32 start, PxU32 end)
+	{
+		PxU32* PX_RESTRICT counts = mChunkCounts + (start / getChunkSize()) * mNumBuckets;
+
+		if(!mScatter)
+		{
+			PxMemZero(counts, sizeof(PxU32) * mNumBuckets);
+			for(PxU32 i = start; i < end; ++i)
+				counts[getBucket(mIndices[i])]++;
+		}
+		else
+		{
+			for(PxU32 i = start; i < end; ++i)
+			{
+				const PxU32 index = mIndices[i];
+				mSortedIndices[counts[getBucket(index)]++] = index;
+			}
+		}
+	}
+
+private:
+	PX_NOCOPY(RangeSortJob)
+
+	PX_FORCE_INLINE PxU32 getBucket(PxU32 index) const
+	{
+		uintptr_t indexA, indexB;
+		bool activeA, activeB;
+		PxU32 partitionsA, partitionsB;
+		mClassification.classifyConstraint(mDescs[index], indexA, indexB, activeA, activeB, partitionsA, partitionsB);
+		const PxU32 rangeA = activeA ? PxU32((indexA + mRangeOffset) / mRangeSize) : 0;
+		const PxU32 rangeB = activeB ? PxU32((indexB + mRangeOffset) / mRangeSize) : 0;
+		if(activeA && activeB && rangeA != rangeB)
+			return mNumBuckets - 1;
+		return activeA ? rangeA : rangeB;
+	}
+
+	const bool						mScatter;
+	const PxSolverConstraintDesc*	mDescs;
+	const PxU32*					mIndices;
+	RigidBodyClassification			mClassification;
+	const PxU32						mRangeSize;
+	const PxU32						mRangeOffset;
+	const PxU32						mNumBuckets;
+	PxU32*							mChunkCounts;
+	PxU32*							mSortedIndices;
+};
+
+//Classifies the buckets of RangeSortJob, one range of bodies per task. Each bucket is classified in order, like the serial
+//classification. No other task touches the bodies of the range, so the tasks run concurrently.
+class RangeClassificationJob : public Cm::ChunkedJob
+{
+public:
+	RangeClassificationJob(const PxSolverConstraintDesc* descs, const PxU32* sortedIndices, const PxU32* bucketStarts, PxU32 numRanges,
+		const RigidBodyClassification& classification, PxU32* keys, PxI32* numConstraintsPerPartition) :
+		Cm::ChunkedJob(numRanges, 1),
+		mDescs(descs), mSortedIndices(sortedIndices), mBucketStarts(bucketStarts), mClassification(classification), mKeys(keys),
+		mNumConstraintsPerPartition(numConstraintsPerPartition)
+	{
+	}
+
+	virtual void process(PxU32 start, PxU32 end)
+	{
+		for(PxU32 range = start; range < end; ++range)
+		{
+			PxU32 numConstraintsPerPartition[MAX_NUM_PARTITIONS];
+			PxMemZero(numConstraintsPerPartition, sizeof(numConstraintsPerPartition));
+
+			for(PxU32 i = mBucketStarts[range]; i < mBucketStarts[range + 1]; ++i)
+			{
+				const PxU32 index = mSortedIndices[i];
+				classifyConstraintKey(mDescs[index], mClassification, mKeys[index], numConstraintsPerPartition);
+			}
+
+			for(PxU32 a = 0; a < MAX_NUM_PARTITIONS; ++a)
+			{
+				if(numConstraintsPerPartition[a])
+					Ps::atomicAdd(mNumConstraintsPerPartition + a, PxI32(numConstraintsPerPartition[a]));
+			}
+		}
+	}
+
+private:
+	PX_NOCOPY(RangeClassificationJob)
+
+	const PxSolverConstraintDesc*	mDescs;
+	const PxU32*					mSortedIndices;
+	const PxU32*					mBucketStarts;
+	RigidBodyClassification			mClassification;
+	PxU32*							mKeys;
+	PxI32*							mNumConstraintsPerPartition;
+};
+
+//Parallel version of classifyConstraintDesc, for rigid bodies only. The bodies are split in ranges, and the constraints within a range
+//are classified concurrently with the other ranges. The constraints between two ranges are left for the next round, which shifts the
+//ranges by a fraction of their size, and finally for a serial pass. The constraints are classified in another order than in the serial
+//classification, so the partitions differ. They only depend on the bodies and constraints, not on the number of threads.
+void classifyConstraintDescParallel(PxCpuDispatcher* dispatcher, const PxSolverConstraintDesc* PX_RESTRICT descs, const PxU32 numConstraints,
+	RigidBodyClassification& classification, PxU32 numBodies, Ps::Array<PxU32>& numConstraintsPerPartition, PxSolverConstraintDesc* PX_RESTRICT eaTempConstraintDescriptors,
+	PxU32* PX_RESTRICT constraintKeys, PxU32* PX_RESTRICT unpartitionedIndices, Ps::Array<PxU32>& scratch)
+{
+	const PxU32 chunkSize = PxMax(PxU32(PARALLEL_WRITE_MIN_CHUNK), (numConstraints + PARALLEL_WRITE_MAX_CHUNKS - 1) / PARALLEL_WRITE_MAX_CHUNKS);
+	const PxU32 rangeSize = PxMax(PxU32(PARALLEL_CLASSIFY_MIN_RANGE), (numBodies + PARALLEL_CLASSIFY_MAX_RANGES - 1) / PARALLEL_CLASSIFY_MAX_RANGES);
+	//One more range for the shifted rounds, and a bucket for the constraints between ranges
+	const PxU32 maxNumBuckets = (numBodies + rangeSize - 1) / rangeSize + 2;
+	const PxU32 maxNumChunks = (numConstraints + chunkSize - 1) / chunkSize;
+
+	//Two lists of constraint indices, the unclassified constraints and the sorted ones, then the per-chunk counters and the bucket starts
+	scratch.resizeUninitialized(numConstraints + maxNumChunks * maxNumBuckets + maxNumBuckets);
+	PxU32* indices = unpartitionedIndices;
+	PxU32* sortedIndices = scratch.begin();
+	PxU32* chunkCounts = sortedIndices + numConstraints;
+	PxU32* bucketStarts = chunkCounts + maxNumChunks * maxNumBuckets;
+
+	PxI32 counters[MAX_NUM_PARTITIONS];
+	PxMemZero(counters, sizeof(counters));
+
+	PxU32 numIndices = numConstraints;
+	for(PxU32 i = 0; i < numConstraints; ++i)
+	{
+		constraintKeys[i] = UNCLASSIFIED_CONSTRAINT_KEY;
+		indices[i] = i;
+	}
+
+	//The range boundaries of the first round are in the middle of the ranges of the second one, and so on
+	const PxU32 rangeOffsets[PARALLEL_CLASSIFY_MAX_ROUNDS] = { 0, rangeSize / 2, rangeSize / 4, (rangeSize * 3) / 4 };
+	for(PxU32 round = 0; round < PARALLEL_CLASSIFY_MAX_ROUNDS && numIndices; ++round)
+	{
+		const PxU32 numRanges = (numBodies + rangeOffsets[round] + rangeSize - 1) / rangeSize;
+		const PxU32 numBuckets = numRanges + 1;
+		const PxU32 numChunks = (numIndices + chunkSize - 1) / chunkSize;
+
+		{
+			RangeSortJob* job = PX_NEW(RangeSortJob)(false, descs, indices, numIndices, chunkSize, classification, rangeSize, rangeOffsets[round],
+				numBuckets, chunkCounts, sortedIndices);
+			job->run(dispatcher, 0);
+			job->releaseRef();
+		}
+
+		//Turn the counters into write offsets
+		PxU32 offset = 0;
+		for(PxU32 b = 0; b < numBuckets; ++b)
+		{
+			bucketStarts[b] = offset;
+			for(PxU32 c = 0; c < numChunks; ++c)
+			{
+				PxU32& count = chunkCounts[c * numBuckets + b];
+				const PxU32 nb = count;
+				count = offset;
+				offset += nb;
+			}
+		}
+
+		{
+			RangeSortJob* job = PX_NEW(RangeSortJob)(true, descs, indices, numIndices, chunkSize, classification, rangeSize, rangeOffsets[round],
+				numBuckets, chunkCounts, sortedIndices);
+			job->run(dispatcher, 0);
+			job->releaseRef();
+		}
+
+		{
+			RangeClassificationJob* job = PX_NEW(RangeClassificationJob)(descs, sortedIndices, bucketStarts, numRanges, classification,
+				constraintKeys, counters);
+			job->run(dispatcher, 0);
+			job->releaseRef();
+		}
+
+		//The constraints between ranges are the last bucket
+		const PxU32 numRemaining = numIndices - bucketStarts[numRanges];
+		PxMemCopy(indices, sortedIndices + bucketStarts[numRanges], sizeof(PxU32) * numRemaining);
+		numIndices = numRemaining;
+	}
+
+	numConstraintsPerPartition.forceSize_Unsafe(MAX_NUM_PARTITIONS);
+	for(PxU32 a = 0; a < MAX_NUM_PARTITIONS; ++a)
+		numConstraintsPerPartition[a] = PxU32(counters[a]);
+
+	//Classify the remaining constraints serially
+	for(PxU32 i = 0; i < numIndices; ++i)
+		classifyConstraintKey(descs[indices[i]], classification, constraintKeys[indices[i]], numConstraintsPerPartition.begin());
+
+	//Gather the constraints that do not fit in the first 32 partitions, in order
+	PxU32 numUnpartitionedConstraints = 0;
+	for(PxU32 i = 0; i < numConstraints; ++i)
+	{
+		if(constraintKeys[i] == DEFERRED_CONSTRAINT_KEY)
+		{
+			unpartitionedIndices[numUnpartitionedConstraints] = i;
+			eaTempConstraintDescriptors[numUnpartitionedConstraints++] = descs[i];
+		}
+	}
+
+	//The bodies' partition masks give the highest partition of their dynamic constraints
+	classification.storeMaxPartitions();
+
+	classifyUnpartitionedConstraints(numUnpartitionedConstraints, classification, numConstraintsPerPartition, eaTempConstraintDescriptors,
+		constraintKeys, unpartitionedIndices);
+
+	classification.reserveSpaceForStaticConstraints(numConstraintsPerPartition);
+}
+
 }
 
 #define PX_NORMALIZE_PARTITIONS 1
@@ -804,9 +1229,29 @@ PxU32 partitionContactConstraints(ConstraintPartitionArgs& args)
 
 	if(numArticulations == 0)
 	{
+		//For large islands, record the partitions during the classification so that the constraints can be written in parallel.
+		//The serial classification defines the default partitions. The parallel classification is opt-in, since it gives other
+		//partitions. It does not depend on the number of worker threads, so it is used even without workers.
+		const bool parallelClassification = args.mParallelClassification && numConstraintDescriptors >= PARALLEL_WRITE_THRESHOLD;
+		const bool parallelWrite = parallelClassification ||
+			(args.mDispatcher && args.mDispatcher->getWorkerCount() && numConstraintDescriptors >= PARALLEL_WRITE_THRESHOLD);
+		PxU32* constraintKeys = NULL;
+		PxU32* unpartitionedIndices = NULL;
+		if(parallelWrite)
+		{
+			args.mConstraintPartitions->resizeUninitialized(numConstraintDescriptors);
+			args.mPartitionScratch->resizeUninitialized(numConstraintDescriptors);
+			constraintKeys = args.mConstraintPartitions->begin();
+			unpartitionedIndices = args.mPartitionScratch->begin();
+		}
+
 		RigidBodyClassification classification(args.mBodies, numBodies, stride);
-		classifyConstraintDesc(eaConstraintDescriptors, numConstraintDescriptors, classification, constraintsPerPartition,
-			eaTempConstraintDescriptors);
+		if(parallelClassification)
+			classifyConstraintDescParallel(args.mDispatcher, eaConstraintDescriptors, numConstraintDescriptors, classification, numBodies,
+				constraintsPerPartition, eaTempConstraintDescriptors, constraintKeys, unpartitionedIndices, *args.mClassificationScratch);
+		else
+			classifyConstraintDesc(eaConstraintDescriptors, numConstraintDescriptors, classification, constraintsPerPartition,
+				eaTempConstraintDescriptors, constraintKeys, unpartitionedIndices);
 		
 		PxU32 accumulation = 0;
 		for(PxU32 a = 0; a < constraintsPerPartition.size(); ++a)
@@ -816,19 +1261,27 @@ PxU32 partitionContactConstraints(ConstraintPartitionArgs& args)
 			accumulation += count;
 		}
 
-		for(PxU32 a = 0, offset = 0; a < numBodies; ++a, offset += stride)
+		if(parallelWrite)
 		{
-			PxSolverBody& body = *reinterpret_cast<PxSolverBody*>(args.mBodies + offset);
-			Ps::prefetchLine(&args.mBodies[a], 256);
-			body.solverProgress = 0;
-			//Keep the dynamic constraint count but bump the static constraint count back to 0.
-			//This allows us to place the static constraints in the appropriate place when we see them
-			//because we know the maximum index for the dynamic constraints...
-			body.maxSolverFrictionProgress = 0;
+			writeConstraintDescParallel(args.mDispatcher, eaConstraintDescriptors, numConstraintDescriptors, constraintsPerPartition,
+				constraintKeys, *args.mPartitionScratch, eaOrderedConstraintDescriptors);
 		}
+		else
+		{
+			for(PxU32 a = 0, offset = 0; a < numBodies; ++a, offset += stride)
+			{
+				PxSolverBody& body = *reinterpret_cast<PxSolverBody*>(args.mBodies + offset);
+				Ps::prefetchLine(&args.mBodies[a], 256);
+				body.solverProgress = 0;
+				//Keep the dynamic constraint count but bump the static constraint count back to 0.
+				//This allows us to place the static constraints in the appropriate place when we see them
+				//because we know the maximum index for the dynamic constraints...
+				body.maxSolverFrictionProgress = 0;
+			}
 
-		writeConstraintDesc(eaConstraintDescriptors, numConstraintDescriptors, classification, constraintsPerPartition, 
-			eaTempConstraintDescriptors, eaOrderedConstraintDescriptors);
+			writeConstraintDesc(eaConstraintDescriptors, numConstraintDescriptors, classification, constraintsPerPartition, 
+				eaTempConstraintDescriptors, eaOrderedConstraintDescriptors);
+		}
 
 		numOrderedConstraints = numConstraintDescriptors;
 
@@ -854,7 +1307,7 @@ PxU32 partitionContactConstraints(ConstraintPartitionArgs& args)
 		ExtendedRigidBodyClassification classification(args.mBodies, numBodies, stride, eaArticulations, numArticulations);
 
 		classifyConstraintDesc(eaConstraintDescriptors, numConstraintDescriptors, classification, 
-			constraintsPerPartition, eaTempConstraintDescriptors);
+			constraintsPerPartition, eaTempConstraintDescriptors, NULL, NULL);
 
 		PxU32 accumulation = 0;
 		for(PxU32 a = 0; a < constraintsPerPartition.size(); ++a)
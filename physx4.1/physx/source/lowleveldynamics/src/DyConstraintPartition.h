@@ -38,6 +38,8 @@
 namespace physx
 {
 
+class PxCpuDispatcher;
+
 namespace Dy
 {
 struct ConstraintPartitionArgs
@@ -60,6 +62,16 @@ struct ConstraintPartitionArgs
 	Ps::Array<PxU32>*						mConstraintsPerPartition;
 	Ps::Array<PxU32>*						mBitField;
 
+	//Optional, writes the ordered constraints of large islands over the worker threads. Not used with articulations.
+	PxCpuDispatcher*						mDispatcher;
+	Ps::Array<PxU32>*						mConstraintPartitions;	//Scratch, partition of each constraint
+	Ps::Array<PxU32>*						mPartitionScratch;		//Scratch, unpartitioned constraints then per-chunk counters
+
+	//Optional, also assigns the constraints of large islands to partitions over the worker threads. This gives other partitions than
+	//the serial classification. Uses the scratch arrays of the parallel write. Not used with articulations.
+	bool									mParallelClassification;
+	Ps::Array<PxU32>*						mClassificationScratch;	//Scratch, sorted constraints and per-chunk counters
+
 	bool									enhancedDeterminism;
 };
 
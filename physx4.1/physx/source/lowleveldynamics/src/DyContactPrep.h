@@ -130,6 +130,17 @@ SolverConstraintPrepState::Enum createFinalizeSolverContacts4(	Dy::CorrelationBu
 																PxReal solverOffsetSlop,
 																PxConstraintAllocator& constraintAllocator);
 
+//Builds an 8-wide patch friction contact block (see DySolverContact8.h). Only valid if isContactBlock8Supported() returns true.
+SolverConstraintPrepState::Enum createFinalizeSolverContacts8(	PxsContactManagerOutput** outputs,
+																 ThreadContext& threadContext,
+																 PxSolverContactDesc* blockDescs,
+																 const PxReal invDtF32,
+																 PxReal bounceThresholdF32,
+																 PxReal frictionOffsetThreshold,
+																 PxReal correlationDistance,
+																 PxReal solverOffsetSlop,
+																 PxConstraintAllocator& constraintAllocator);
+
 
 
 bool createFinalizeSolverContactsCoulomb1D(PxSolverContactDesc& contactDesc,
@@ -0,0 +1,522 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#include "foundation/PxPreprocessor.h"
+#include "PsVecMath.h"
+#include "PsUtilities.h"
+#include "PsFoundation.h"
+#include "foundation/PxMemory.h"
+#include "DySolverContact4.h"
+#include "DySolverContact8.h"
+#include "DySolverConstraintTypes.h"
+#include "DyThreadContext.h"
+#include "DyFrictionPatch.h"
+#include "DyContactPrep.h"
+
+using namespace physx;
+using namespace Ps::aos;
+
+namespace physx
+{
+namespace Dy
+{
+
+namespace
+{
+
+// Hands out the per-thread scratch memory for the constraint block and the friction patches of a 4-wide half. Nothing is taken
+// from the real allocator until both halves have been prepped and merged, so a half that can't be batched wastes no frame memory.
+class Block8HalfAllocator : public PxConstraintAllocator
+{
+	PX_NOCOPY(Block8HalfAllocator)
+public:
+	Block8HalfAllocator(PxU8* scratch, PxU8* frictionScratch, PxU32& frictionScratchUsed, PxConstraintAllocator& allocator) :
+		mScratch(scratch), mFrictionScratch(frictionScratch), mFrictionScratchUsed(frictionScratchUsed), mAllocator(allocator)
+	{
+	}
+
+	virtual PxU8* reserveConstraintData(const PxU32 byteSize)
+	{
+		//reserveBlockStreams4 rejects anything larger than a block, so one scratch block per half is enough
+		PX_ASSERT(byteSize <= DY_BLOCK8_SCRATCH_HALF_SIZE);
+		PX_UNUSED(byteSize);
+		return mScratch;
+	}
+
+	virtual PxU8* reserveFrictionData(const PxU32 byteSize)
+	{
+		//byteSize is a multiple of 16, see computeBlockStreamFrictionByteSizes
+		PX_ASSERT(0 == (byteSize & 0x0f));
+		if(mFrictionScratchUsed + byteSize > DY_BLOCK8_FRICTION_SCRATCH_SIZE)
+			return mAllocator.reserveFrictionData(byteSize);
+		PxU8* ptr = mFrictionScratch + mFrictionScratchUsed;
+		mFrictionScratchUsed += byteSize;
+		return ptr;
+	}
+
+private:
+	PxU8* mScratch;
+	PxU8* mFrictionScratch;
+	PxU32& mFrictionScratchUsed;
+	PxConstraintAllocator& mAllocator;
+};
+
+//The correlation buffer of a 4-wide half holds at most MAX_FRICTION_PATCHES patches, plus up to 16 bytes of padding per pair
+PX_COMPILE_TIME_ASSERT(2 * (CorrelationBuffer::MAX_FRICTION_PATCHES * sizeof(FrictionPatch) + 4 * 16) <= DY_BLOCK8_FRICTION_SCRATCH_SIZE);
+
+// Maps the friction patches of the 8 lanes from the per-thread scratch to their final location.
+struct FrictionRelocation8
+{
+	const PxU8* scratchBegin;
+	const PxU8* scratchEnd;
+	const PxU8* scratchPtr[8];
+	PxU8* finalPtr[8];
+
+	PX_FORCE_INLINE PxU8* relocate(const PxU32 lane, PxU8* ptr) const
+	{
+		if(ptr < scratchBegin || ptr >= scratchEnd)
+			return ptr;
+		return finalPtr[lane] + (ptr - scratchPtr[lane]);
+	}
+};
+
+// One patch of a 4-wide contact block, see the stream layout walked by solveContact4_Block.
+struct ContactPatch4
+{
+	const SolverContactHeader4* header;
+	const Vec4V* appliedForces;
+	const PxU8* contacts;
+	const Vec4V* maxImpulses;
+	const SolverFrictionSharedData4* frictionShared;
+	const Vec4V* frictionAppliedForces;
+	const PxU8* frictions;
+};
+
+class ContactBlock4Reader
+{
+public:
+	ContactBlock4Reader(const PxSolverConstraintDesc& desc) :
+		mCurrPtr(desc.constraint), mLast(desc.constraint + getConstraintLength(desc))
+	{
+		mIsDynamic = *desc.constraint == DY_SC_TYPE_BLOCK_RB_CONTACT;
+		mContactSize = mIsDynamic ? sizeof(SolverContactBatchPointDynamic4) : sizeof(SolverContactBatchPointBase4);
+		mFrictionSize = mIsDynamic ? sizeof(SolverContactFrictionDynamic4) : sizeof(SolverContactFrictionBase4);
+	}
+
+	PX_FORCE_INLINE bool hasPatch() const { return mCurrPtr < mLast; }
+
+	PX_FORCE_INLINE bool isDynamic() const { return mIsDynamic; }
+
+	const ContactPatch4& nextPatch()
+	{
+		PX_ASSERT(hasPatch());
+		const SolverContactHeader4* hdr = reinterpret_cast<const SolverContactHeader4*>(mCurrPtr);
+		PX_ASSERT(hdr->type == DY_SC_TYPE_BLOCK_RB_CONTACT || hdr->type == DY_SC_TYPE_BLOCK_STATIC_RB_CONTACT);
+
+		const PxU8* ptr = reinterpret_cast<const PxU8*>(hdr + 1);
+
+		const PxU32 numNormalConstr = hdr->numNormalConstr;
+		const PxU32 numFrictionConstr = hdr->numFrictionConstr;
+
+		mPatch.header = hdr;
+		mPatch.appliedForces = reinterpret_cast<const Vec4V*>(ptr);
+		ptr += sizeof(Vec4V) * numNormalConstr;
+
+		mPatch.contacts = ptr;
+		ptr += mContactSize * numNormalConstr;
+
+		mPatch.maxImpulses = NULL;
+		if(hdr->flag & SolverContactHeader4::eHAS_MAX_IMPULSE)
+		{
+			mPatch.maxImpulses = reinterpret_cast<const Vec4V*>(ptr);
+			ptr += sizeof(Vec4V) * numNormalConstr;
+		}
+
+		mPatch.frictionShared = NULL;
+		if(numFrictionConstr)
+		{
+			mPatch.frictionShared = reinterpret_cast<const SolverFrictionSharedData4*>(ptr);
+			ptr += sizeof(SolverFrictionSharedData4);
+		}
+
+		mPatch.frictionAppliedForces = reinterpret_cast<const Vec4V*>(ptr);
+		ptr += sizeof(Vec4V) * numFrictionConstr;
+
+		mPatch.frictions = ptr;
+		ptr += mFrictionSize * numFrictionConstr;
+
+		mCurrPtr = ptr;
+		return mPatch;
+	}
+
+	PX_FORCE_INLINE const SolverContactBatchPointBase4& getContact(const ContactPatch4& patch, const PxU32 i) const
+	{
+		return *reinterpret_cast<const SolverContactBatchPointBase4*>(patch.contacts + i * mContactSize);
+	}
+
+	PX_FORCE_INLINE const SolverContactFrictionBase4& getFriction(const ContactPatch4& patch, const PxU32 i) const
+	{
+		return *reinterpret_cast<const SolverContactFrictionBase4*>(patch.frictions + i * mFrictionSize);
+	}
+
+private:
+	const PxU8* mCurrPtr;
+	const PxU8* mLast;
+	PxU32 mContactSize;
+	PxU32 mFrictionSize;
+	bool mIsDynamic;
+	ContactPatch4 mPatch;
+};
+
+PX_FORCE_INLINE void storeHalf(PxF32* PX_RESTRICT row, const PxU32 half, const Vec4V v)
+{
+	V4StoreU(v, row + 4 * half);
+}
+
+static PxU32 computeBlock8ByteSize(const PxSolverConstraintDesc& desc0, const PxSolverConstraintDesc& desc1, const bool isDynamic)
+{
+	const PxU32 contactSize = isDynamic ? sizeof(SolverContactBatchPointDynamic8) : sizeof(SolverContactBatchPointBase8);
+	const PxU32 frictionSize = isDynamic ? sizeof(SolverContactFrictionDynamic8) : sizeof(SolverContactFrictionBase8);
+
+	ContactBlock4Reader readers[2] = { ContactBlock4Reader(desc0), ContactBlock4Reader(desc1) };
+
+	PxU32 size = 0;
+	while(readers[0].hasPatch() || readers[1].hasPatch())
+	{
+		PxU32 numNormalConstr = 0, numFrictionConstr = 0;
+		bool hasMaxImpulse = false;
+		for(PxU32 h = 0; h < 2; ++h)
+		{
+			if(readers[h].hasPatch())
+			{
+				const SolverContactHeader4* hdr = readers[h].nextPatch().header;
+				numNormalConstr = PxMax(numNormalConstr, PxU32(hdr->numNormalConstr));
+				numFrictionConstr = PxMax(numFrictionConstr, PxU32(hdr->numFrictionConstr));
+				hasMaxImpulse = hasMaxImpulse || (hdr->flag & SolverContactHeader4::eHAS_MAX_IMPULSE);
+			}
+		}
+
+		size += sizeof(SolverContactHeader8);
+		size += numNormalConstr * (sizeof(PxF32) * 8 + contactSize);
+		if(hasMaxImpulse)
+			size += numNormalConstr * sizeof(PxF32) * 8;
+		if(numFrictionConstr)
+			size += sizeof(SolverFrictionSharedData8) + numFrictionConstr * (sizeof(PxF32) * 8 + frictionSize);
+	}
+	return size;
+}
+
+// Interleaves the two 4-wide blocks built for desc0/desc1 into one 8-wide block. Patches, rows and lanes that only exist in one
+// half are padded with zeros so that they apply no impulse. A static half is widened to the dynamic layout with zero body B terms.
+static void mergeContactBlocks4(const PxSolverConstraintDesc& desc0, const PxSolverConstraintDesc& desc1, const bool isDynamic,
+	const FrictionRelocation8& frictionRelocation, PxU8* PX_RESTRICT block)
+{
+	const PxU32 contactSize = isDynamic ? sizeof(SolverContactBatchPointDynamic8) : sizeof(SolverContactBatchPointBase8);
+	const PxU32 frictionSize = isDynamic ? sizeof(SolverContactFrictionDynamic8) : sizeof(SolverContactFrictionBase8);
+	const Vec4V vMax = V4Splat(FMax());
+	const Vec4V vZero = V4Zero();
+
+	ContactBlock4Reader readers[2] = { ContactBlock4Reader(desc0), ContactBlock4Reader(desc1) };
+
+	PxU8* PX_RESTRICT currPtr = block;
+
+	while(readers[0].hasPatch() || readers[1].hasPatch())
+	{
+		const ContactPatch4* patches[2] = { NULL, NULL };
+		PxU32 numNormalConstr = 0, numFrictionConstr = 0;
+		bool hasMaxImpulse = false;
+		for(PxU32 h = 0; h < 2; ++h)
+		{
+			if(readers[h].hasPatch())
+			{
+				patches[h] = &readers[h].nextPatch();
+				const SolverContactHeader4* hdr = patches[h]->header;
+				numNormalConstr = PxMax(numNormalConstr, PxU32(hdr->numNormalConstr));
+				numFrictionConstr = PxMax(numFrictionConstr, PxU32(hdr->numFrictionConstr));
+				hasMaxImpulse = hasMaxImpulse || (hdr->flag & SolverContactHeader4::eHAS_MAX_IMPULSE);
+			}
+		}
+
+		SolverContactHeader8* PX_RESTRICT header = reinterpret_cast<SolverContactHeader8*>(currPtr);
+		currPtr += sizeof(SolverContactHeader8);
+
+		PxF32* PX_RESTRICT appliedForces = reinterpret_cast<PxF32*>(currPtr);
+		currPtr += numNormalConstr * sizeof(PxF32) * 8;
+
+		PxU8* PX_RESTRICT contacts = currPtr;
+		currPtr += numNormalConstr * contactSize;
+
+		PxF32* PX_RESTRICT maxImpulses = NULL;
+		if(hasMaxImpulse)
+		{
+			maxImpulses = reinterpret_cast<PxF32*>(currPtr);
+			currPtr += numNormalConstr * sizeof(PxF32) * 8;
+		}
+
+		SolverFrictionSharedData8* PX_RESTRICT fd = NULL;
+		if(numFrictionConstr)
+		{
+			fd = reinterpret_cast<SolverFrictionSharedData8*>(currPtr);
+			currPtr += sizeof(SolverFrictionSharedData8);
+		}
+
+		PxF32* PX_RESTRICT frictionAppliedForces = reinterpret_cast<PxF32*>(currPtr);
+		currPtr += numFrictionConstr * sizeof(PxF32) * 8;
+
+		PxU8* PX_RESTRICT frictions = currPtr;
+		currPtr += numFrictionConstr * frictionSize;
+
+		header->type = Ps::to8(isDynamic ? DY_SC_TYPE_BLOCK8_RB_CONTACT : DY_SC_TYPE_BLOCK8_STATIC_RB_CONTACT);
+		header->numNormalConstr = Ps::to8(numNormalConstr);
+		header->numFrictionConstr = Ps::to8(numFrictionConstr);
+		header->flag = PxU8(hasMaxImpulse ? SolverContactHeader8::eHAS_MAX_IMPULSE : 0);
+
+		for(PxU32 h = 0; h < 2; ++h)
+		{
+			const ContactPatch4* patch = patches[h];
+
+			if(maxImpulses)
+			{
+				//Rows that don't exist in this half (or a half without max impulses) must not clamp anything
+				for(PxU32 i = 0; i < numNormalConstr; ++i)
+				{
+					const bool hasRow = patch && patch->maxImpulses && i < patch->header->numNormalConstr;
+					storeHalf(maxImpulses + 8 * i, h, hasRow ? patch->maxImpulses[i] : vMax);
+				}
+			}
+
+			if(!patch)
+				continue;
+
+			const SolverContactHeader4& hdr = *patch->header;
+			const bool halfIsDynamic = readers[h].isDynamic();
+
+			for(PxU32 a = 0; a < 4; ++a)
+			{
+				header->flags[4 * h + a] = hdr.flags[a];
+				header->numNormalConstrs[4 * h + a] = (&hdr.numNormalConstr0)[a];
+				header->numFrictionConstrs[4 * h + a] = (&hdr.numFrictionConstr0)[a];
+				header->shapeInteraction[4 * h + a] = hdr.shapeInteraction[a];
+			}
+
+			storeHalf(header->restitution, h, hdr.restitution);
+			storeHalf(header->staticFriction, h, hdr.staticFriction);
+			storeHalf(header->dynamicFriction, h, hdr.dynamicFriction);
+			storeHalf(header->invMass0D0, h, hdr.invMass0D0);
+			storeHalf(header->invMass1D1, h, halfIsDynamic ? hdr.invMass1D1 : vZero);
+			storeHalf(header->angDom0, h, hdr.angDom0);
+			storeHalf(header->angDom1, h, halfIsDynamic ? hdr.angDom1 : vZero);
+			storeHalf(header->normalX, h, hdr.normalX);
+			storeHalf(header->normalY, h, hdr.normalY);
+			storeHalf(header->normalZ, h, hdr.normalZ);
+
+			for(PxU32 i = 0; i < hdr.numNormalConstr; ++i)
+			{
+				storeHalf(appliedForces + 8 * i, h, patch->appliedForces[i]);
+
+				const SolverContactBatchPointBase4& src = readers[h].getContact(*patch, i);
+				SolverContactBatchPointBase8& dst = *reinterpret_cast<SolverContactBatchPointBase8*>(contacts + i * contactSize);
+				storeHalf(dst.raXnX, h, src.raXnX);
+				storeHalf(dst.raXnY, h, src.raXnY);
+				storeHalf(dst.raXnZ, h, src.raXnZ);
+				storeHalf(dst.velMultiplier, h, src.velMultiplier);
+				storeHalf(dst.scaledBias, h, src.scaledBias);
+				storeHalf(dst.biasedErr, h, src.biasedErr);
+				if(halfIsDynamic)
+				{
+					const SolverContactBatchPointDynamic4& dynSrc = static_cast<const SolverContactBatchPointDynamic4&>(src);
+					SolverContactBatchPointDynamic8& dynDst = static_cast<SolverContactBatchPointDynamic8&>(dst);
+					storeHalf(dynDst.rbXnX, h, dynSrc.rbXnX);
+					storeHalf(dynDst.rbXnY, h, dynSrc.rbXnY);
+					storeHalf(dynDst.rbXnZ, h, dynSrc.rbXnZ);
+				}
+			}
+
+			if(hdr.numFrictionConstr)
+			{
+				const SolverFrictionSharedData4& srcFd = *patch->frictionShared;
+				for(PxU32 a = 0; a < 4; ++a)
+					fd->frictionBrokenWritebackByte[4 * h + a] = frictionRelocation.relocate(4 * h + a, srcFd.frictionBrokenWritebackByte[a]);
+				for(PxU32 k = 0; k < 2; ++k)
+				{
+					storeHalf(fd->normalX[k], h, srcFd.normalX[k]);
+					storeHalf(fd->normalY[k], h, srcFd.normalY[k]);
+					storeHalf(fd->normalZ[k], h, srcFd.normalZ[k]);
+				}
+			}
+
+			for(PxU32 i = 0; i < hdr.numFrictionConstr; ++i)
+			{
+				storeHalf(frictionAppliedForces + 8 * i, h, patch->frictionAppliedForces[i]);
+
+				const SolverContactFrictionBase4& src = readers[h].getFriction(*patch, i);
+				SolverContactFrictionBase8& dst = *reinterpret_cast<SolverContactFrictionBase8*>(frictions + i * frictionSize);
+				storeHalf(dst.raXnX, h, src.raXnX);
+				storeHalf(dst.raXnY, h, src.raXnY);
+				storeHalf(dst.raXnZ, h, src.raXnZ);
+				storeHalf(dst.scaledBias, h, src.scaledBias);
+				storeHalf(dst.velMultiplier, h, src.velMultiplier);
+				storeHalf(dst.targetVelocity, h, src.targetVelocity);
+				if(halfIsDynamic)
+				{
+					const SolverContactFrictionDynamic4& dynSrc = static_cast<const SolverContactFrictionDynamic4&>(src);
+					SolverContactFrictionDynamic8& dynDst = static_cast<SolverContactFrictionDynamic8&>(dst);
+					storeHalf(dynDst.rbXnX, h, dynSrc.rbXnX);
+					storeHalf(dynDst.rbXnY, h, dynSrc.rbXnY);
+					storeHalf(dynDst.rbXnZ, h, dynSrc.rbXnZ);
+				}
+			}
+		}
+	}
+}
+
+}
+
+//The 8-wide block is built by running the 4-wide prep on each half into scratch memory and interleaving the results. This keeps
+//the (large) 4-wide prep code as the single source of truth for the constraint maths. If either half can't be batched, all 8 descs
+//are restored so that the caller can fall back on 8 separate constraint prep calls. The friction patches are built in scratch memory
+//too and only copied to the real allocator once the merged block has been reserved.
+SolverConstraintPrepState::Enum createFinalizeSolverContacts8(
+	PxsContactManagerOutput** cmOutputs,
+	ThreadContext& threadContext,
+	PxSolverContactDesc* blockDescs,
+	const PxReal invDtF32,
+	PxReal bounceThresholdF32,
+	PxReal	frictionOffsetThreshold,
+	PxReal correlationDistance,
+	PxReal solverOffsetSlop,
+	PxConstraintAllocator& constraintAllocator)
+{
+	PxSolverContactDesc savedBlockDescs[8];
+	PxSolverConstraintDesc savedDescs[8];
+	for(PxU32 a = 0; a < 8; ++a)
+	{
+		savedBlockDescs[a] = blockDescs[a];
+		savedDescs[a] = *blockDescs[a].desc;
+	}
+
+	PxU8* scratch = threadContext.getBlock8Scratch();
+	PxU8* frictionScratch = scratch + 2 * DY_BLOCK8_SCRATCH_HALF_SIZE;
+	PxU32 frictionScratchUsed = 0;
+
+	SolverConstraintPrepState::Enum state = SolverConstraintPrepState::eSUCCESS;
+	for(PxU32 h = 0; h < 2 && state == SolverConstraintPrepState::eSUCCESS; ++h)
+	{
+		Block8HalfAllocator halfAllocator(scratch + h * DY_BLOCK8_SCRATCH_HALF_SIZE, frictionScratch, frictionScratchUsed, constraintAllocator);
+		state = createFinalizeSolverContacts4(cmOutputs + 4 * h, threadContext, blockDescs + 4 * h, invDtF32, bounceThresholdF32,
+			frictionOffsetThreshold, correlationDistance, solverOffsetSlop, halfAllocator);
+	}
+
+	PxU8* block = NULL;
+	PxU32 blockByteSize = 0;
+	bool isDynamic = false;
+	if(state == SolverConstraintPrepState::eSUCCESS)
+	{
+		const PxSolverConstraintDesc& desc0 = *blockDescs[0].desc;
+		const PxSolverConstraintDesc& desc1 = *blockDescs[4].desc;
+		isDynamic = *desc0.constraint == DY_SC_TYPE_BLOCK_RB_CONTACT || *desc1.constraint == DY_SC_TYPE_BLOCK_RB_CONTACT;
+
+		blockByteSize = computeBlock8ByteSize(desc0, desc1, isDynamic);
+
+		//16 bytes for the trailing 0 and 16 to realign the block to 32 bytes
+		if((blockByteSize + 32u) > 16384)
+		{
+			state = SolverConstraintPrepState::eUNBATCHABLE;
+		}
+		else
+		{
+			block = constraintAllocator.reserveConstraintData(blockByteSize + 32u);
+			if(0 == block || (reinterpret_cast<PxU8*>(-1)) == block)
+			{
+				PX_WARN_ONCE(
+					"Reached limit set by PxSceneDesc::maxNbContactDataBlocks - ran out of buffer space for constraint prep. "
+					"Either accept dropped contacts or increase buffer size allocated for narrow phase by increasing PxSceneDesc::maxNbContactDataBlocks.");
+				state = SolverConstraintPrepState::eOUT_OF_MEMORY;
+			}
+		}
+	}
+
+	FrictionRelocation8 frictionRelocation;
+	frictionRelocation.scratchBegin = frictionScratch;
+	frictionRelocation.scratchEnd = frictionScratch + frictionScratchUsed;
+	for(PxU32 a = 0; a < 8 && state == SolverConstraintPrepState::eSUCCESS; ++a)
+	{
+		PxU8* frictionPtr = blockDescs[a].frictionPtr;
+		frictionRelocation.scratchPtr[a] = frictionPtr;
+		frictionRelocation.finalPtr[a] = frictionPtr;
+		if(frictionPtr < frictionRelocation.scratchBegin || frictionPtr >= frictionRelocation.scratchEnd)
+			continue;
+
+		//Same size and checks as reserveFrictionBlockStreams. A pair never has more than MAX_FRICTION_PATCHES so the 16K limit can't be hit.
+		const PxU32 frictionByteSize = (blockDescs[a].frictionCount * sizeof(FrictionPatch) + 0x0f) & ~0x0f;
+		PxU8* finalPtr = constraintAllocator.reserveFrictionData(frictionByteSize);
+		if(0 == finalPtr || (reinterpret_cast<PxU8*>(-1)) == finalPtr)
+		{
+			PX_WARN_ONCE(
+				"Reached limit set by PxSceneDesc::maxNbContactDataBlocks - ran out of buffer space for constraint prep. "
+				"Either accept dropped contacts or increase buffer size allocated for narrow phase by increasing PxSceneDesc::maxNbContactDataBlocks.");
+			state = SolverConstraintPrepState::eOUT_OF_MEMORY;
+			break;
+		}
+		PxMemCopy(finalPtr, frictionPtr, frictionByteSize);
+		frictionRelocation.finalPtr[a] = finalPtr;
+	}
+
+	if(state != SolverConstraintPrepState::eSUCCESS)
+	{
+		for(PxU32 a = 0; a < 8; ++a)
+		{
+			blockDescs[a] = savedBlockDescs[a];
+			*blockDescs[a].desc = savedDescs[a];
+		}
+		return state;
+	}
+
+	block = reinterpret_cast<PxU8*>((size_t(block) + 31) & ~size_t(31));
+	PxMemZero(block, blockByteSize);
+
+	mergeContactBlocks4(*blockDescs[0].desc, *blockDescs[4].desc, isDynamic, frictionRelocation, block);
+
+	*(reinterpret_cast<PxU32*>(block + blockByteSize)) = 0;
+
+	for(PxU32 a = 0; a < 8; ++a)
+	{
+		blockDescs[a].frictionPtr = frictionRelocation.finalPtr[a];
+
+		PxSolverConstraintDesc& desc = *blockDescs[a].desc;
+		desc.constraint = block;
+		desc.constraintLengthOver16 = Ps::to16(blockByteSize / 16);
+	}
+
+	return SolverConstraintPrepState::eSUCCESS;
+}
+
+}
+
+}
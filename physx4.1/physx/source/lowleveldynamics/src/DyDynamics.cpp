@@ -113,6 +113,11 @@ Context* createDynamicsContext(	PxcNpMemBlockPool* memBlockPool,
 									contextID, enableStabilization, useEnhancedDeterminism, useAdaptiveForce, maxBiasCoefficient, frictionEveryIteration);
 }
 
+PxU32 getFrictionPatchSize()
+{
+	return sizeof(FrictionPatch);
+}
+
 // PT: TODO: consider removing this function. We already have "createDynamicsContext".
 DynamicsContext* DynamicsContext::create(	PxcNpMemBlockPool* memBlockPool,
 											PxcScratchAllocator& scratchAllocator,
@@ -239,6 +244,8 @@ void DynamicsContext::addThreadStats(const ThreadContext::ThreadSimStats& stats)
 	mSimStats.mNbActiveDynamicBodies += stats.numActiveDynamicBodies;
 	mSimStats.mNbActiveKinematicBodies += stats.numActiveKinematicBodies;
 	mSimStats.mNbAxisSolverConstraints += stats.numAxisSolverConstraints;
+	mSimStats.mNbPartitions = PxMax(mSimStats.mNbPartitions, stats.numPartitions);
+	mSimStats.mPartitionTime += stats.partitionTime;
 }
 #endif
 
@@ -1496,12 +1503,25 @@ public:
 				args.mNumDifferentBodyConstraints = args.mNumSelfConstraints = args.mNumStaticConstraints = 0;
 				args.mConstraintsPerPartition = &mThreadContext.mConstraintsPerPartition;
 				args.mBitField = &mThreadContext.mPartitionNormalizationBitmap;
+				args.mDispatcher = getTaskManager()->getCpuDispatcher();
+				args.mConstraintPartitions = &mThreadContext.mConstraintPartitions;
+				args.mPartitionScratch = &mThreadContext.mPartitionScratch;
+				args.mParallelClassification = mContext.getParallelPartitioning();
+				args.mClassificationScratch = &mThreadContext.mPartitionClassification;
 				args.enhancedDeterminism = mEnhancedDeterminism;
 				
+#if PX_ENABLE_SIM_STATS
+				Ps::Time timer;
+#endif
 				mThreadContext.mMaxPartitions = partitionContactConstraints(args);
 				mThreadContext.mNumDifferentBodyConstraints = args.mNumDifferentBodyConstraints;
 				mThreadContext.mNumSelfConstraints = args.mNumSelfConstraints;
 				mThreadContext.mNumStaticConstraints = args.mNumStaticConstraints;
+#if PX_ENABLE_SIM_STATS
+				ThreadContext::ThreadSimStats& simStats = mThreadContext.getSimStats();
+				simStats.numPartitions = PxMax(simStats.numPartitions, mThreadContext.mMaxPartitions);
+				simStats.partitionTime += PxReal(timer.getElapsedSeconds() * 1000.0);
+#endif
 			}
 			else
 			{
@@ -2713,9 +2733,9 @@ static PxU32 createFinalizeContacts_Parallel(PxSolverBodyData* solverBodyData, T
 
 		if(contactDescPtr[header.startIndex].constraintLengthOver16 == DY_SC_TYPE_RB_CONTACT)
 		{
-			PxSolverContactDesc blockDescs[4];
-			PxsContactManagerOutput* cmOutputs[4];
-			PxsContactManager* cms[4];
+			PxSolverContactDesc blockDescs[8];
+			PxsContactManagerOutput* cmOutputs[8];
+			PxsContactManager* cms[8];
 			for (PxU32 i = 0; i < header.stride; ++i)
 			{
 				PxSolverConstraintDesc& desc = contactDescPtr[header.startIndex + i];
@@ -2781,7 +2801,19 @@ static PxU32 createFinalizeContacts_Parallel(PxSolverBodyData* solverBodyData, T
 
 #if DY_BATCH_CONSTRAINTS
 			SolverConstraintPrepState::Enum state = SolverConstraintPrepState::eUNBATCHABLE;
-			if(header.stride == 4)
+			if(header.stride == 8)
+			{
+				//Only built for patch friction when the AVX2 solver kernels are available, see PxsSolverCreateFinalizeConstraintsTask
+				state = createFinalizeSolverContacts8(cmOutputs, *threadContext,
+					 blockDescs,
+					 invDt,
+					 bounceThreshold,
+					 frictionOffsetThreshold,
+					 correlationDist,
+					 solverOffsetSlop,
+					 blockAllocator);
+			}
+			else if(header.stride == 4)
 			{
 				//KS - todo - plumb in axisConstraintCount into this method to keep track of the number of axes
 				state = createFinalizeMethods4[frictionType](cmOutputs, *threadContext,
@@ -3020,10 +3052,14 @@ void PxsSolverCreateFinalizeConstraintsTask::runInternal()
 
 	const PxU32 maxBatchSize = mEnhancedDeterminism ? 1u : 4u;
 
+	//Contacts using patch friction can be batched 8-wide if the AVX2 solver kernels are available. Joints and the
+	//coulomb friction models stay 4-wide.
+	const PxU32 maxContactBatchSize = (maxBatchSize == 4u && mContext.getFrictionType() == PxFrictionType::ePATCH && isContactBlock8Supported()) ? 8u : maxBatchSize;
+
 	PxU32 headersPerPartition = 0;
 	for(PxU32 a = 0; a < descCount;)
 	{
-		PxU32 loopMax = PxMin(maxJ - a, maxBatchSize);
+		PxU32 loopMax = PxMin(maxJ - a, maxContactBatchSize);
 		PxU16 j = 0;
 		if(loopMax > 0)
 		{
@@ -3034,8 +3070,13 @@ void PxsSolverCreateFinalizeConstraintsTask::runInternal()
 			if(!isArticulationConstraint(desc) && (desc.constraintLengthOver16 == DY_SC_TYPE_RB_CONTACT || 
 				desc.constraintLengthOver16 == DY_SC_TYPE_RB_1D) && currentPartition < maxBatchPartition)
 			{
+				if(desc.constraintLengthOver16 != DY_SC_TYPE_RB_CONTACT)
+					loopMax = PxMin(loopMax, maxBatchSize);
 				for(; j < loopMax && desc.constraintLengthOver16 == mThreadContext.orderedContactConstraints[a+j].constraintLengthOver16 && 
 					!isArticulationConstraint(mThreadContext.orderedContactConstraints[a+j]); ++j);
+				//Only full blocks are batched, so 5-7 contacts make a block of 4 and leave the rest for the next header
+				if(j > 4 && j < 8)
+					j = 4;
 			}
 			header.startIndex = a;
 			header.stride = j;
@@ -0,0 +1,55 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef DY_SOLVER_AVX2_H
+#define DY_SOLVER_AVX2_H
+
+// Include this first in translation units compiled with AVX2 + FMA code generation.
+//
+// Any out-of-line copy of a shared inline function that such a translation unit emits contains AVX2
+// instructions, and the linker is free to pick that copy for SSE2 callers as well. The aos functions avoid
+// this through their own inline namespace (see PX_AOS_ISA_NAMESPACE_BEGIN). For everything else, Linux
+// builds get PX_FORCE_INLINE back as a real force-inline, and the platform LowLevelDynamics.cmake compiles
+// these files with -O2 (or /O2 /Ob2) in every configuration that builds them, so that the remaining trivial
+// inline members are inlined as well. buildtools/check_avx2_isolation.py verifies the result.
+
+#include "foundation/PxPreprocessor.h"
+
+#if PX_LINUX && PX_GCC_FAMILY
+#undef PX_FORCE_INLINE
+#define PX_FORCE_INLINE inline __attribute__((always_inline))
+#endif
+
+#include "PsVecMath.h"
+
+#if !PX_FMA
+#error "DySolverAvx2.h must only be included by translation units compiled with AVX2 and FMA enabled"
+#endif
+
+#endif
@@ -54,6 +54,8 @@ enum SolverConstraintType
 	DY_SC_TYPE_EXT_FRICTION,
 	DY_SC_TYPE_BLOCK_FRICTION,
 	DY_SC_TYPE_BLOCK_STATIC_FRICTION,
+	DY_SC_TYPE_BLOCK8_RB_CONTACT,		// 8-wide contact block, only created when the AVX2 solver kernels are available
+	DY_SC_TYPE_BLOCK8_STATIC_RB_CONTACT,
 	DY_SC_CONSTRAINT_TYPE_COUNT //Count of the number of different constraint types in the solver
 };
 
@@ -51,6 +51,12 @@ namespace physx
 namespace Dy
 {
 
+// DySolverConstraintsBlockAVX2.cpp compiles this file a second time with AVX2 + FMA enabled.
+#if DY_SOLVER_BLOCK_AVX2
+namespace Avx2
+{
+#endif
+
 static void solveContact4_Block(const PxSolverConstraintDesc* PX_RESTRICT desc, SolverContext& cache)
 {
 	PxSolverBody& b00 = *desc[0].bodyA;
@@ -1221,6 +1227,10 @@ void writeBack1D4Block(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU
 	writeBack1D4(desc, cache, bd0, bd1);
 }
 
+#if DY_SOLVER_BLOCK_AVX2
+} // namespace Avx2
+#endif
+
 }
 
 }
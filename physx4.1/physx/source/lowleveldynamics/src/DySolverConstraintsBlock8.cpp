@@ -0,0 +1,613 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+// 8-wide contact block solver. Built with AVX2 + FMA code generation only, and only reachable through the solver tables
+// once SolverCoreRegisterBlockFns has confirmed that the CPU supports it.
+
+#include "foundation/PxSimpleTypes.h"
+
+// PX_DY_AVX2_KERNELS is not defined for the configurations that don't build the AVX2 kernels, see windows/LowLevelDynamics.cmake
+#if PX_DY_AVX2_KERNELS
+
+#include "DySolverAvx2.h"
+#include "PsVecMathAVX.h"
+#include "CmPhysXCommon.h"
+#include "DySolverBody.h"
+#include "DySolverContact.h"
+#include "DySolverConstraintDesc.h"
+#include "DyThresholdTable.h"
+#include "DySolverContext.h"
+#include "PsUtilities.h"
+#include "PsAtomic.h"
+#include "DySolverContact8.h"
+
+namespace physx
+{
+
+namespace Dy
+{
+
+namespace Avx2
+{
+
+using namespace Ps::aos;
+
+namespace
+{
+
+//Transposed velocities of 8 solver bodies. The w components hold the solver progress counters and are passed through untouched.
+struct SolverBodyState8
+{
+	Vec8V linX, linY, linZ;
+	Vec8V angX, angY, angZ;
+	Vec4V linW[2], angW[2];
+};
+
+PX_FORCE_INLINE void loadSolverBodies8(PxSolverBody* const* PX_RESTRICT bodies, SolverBodyState8& s)
+{
+	Vec4V linT[2][3], angT[2][3];
+	for(PxU32 h = 0; h < 2; ++h)
+	{
+		PxSolverBody* const* PX_RESTRICT b = bodies + 4 * h;
+
+		Vec4V linVel0 = V4LoadA(&b[0]->linearVelocity.x);
+		Vec4V linVel1 = V4LoadA(&b[1]->linearVelocity.x);
+		Vec4V linVel2 = V4LoadA(&b[2]->linearVelocity.x);
+		Vec4V linVel3 = V4LoadA(&b[3]->linearVelocity.x);
+		Vec4V angState0 = V4LoadA(&b[0]->angularState.x);
+		Vec4V angState1 = V4LoadA(&b[1]->angularState.x);
+		Vec4V angState2 = V4LoadA(&b[2]->angularState.x);
+		Vec4V angState3 = V4LoadA(&b[3]->angularState.x);
+
+		PX_TRANSPOSE_44(linVel0, linVel1, linVel2, linVel3, linT[h][0], linT[h][1], linT[h][2], s.linW[h]);
+		PX_TRANSPOSE_44(angState0, angState1, angState2, angState3, angT[h][0], angT[h][1], angT[h][2], s.angW[h]);
+	}
+
+	s.linX = V8FromV4(linT[0][0], linT[1][0]);
+	s.linY = V8FromV4(linT[0][1], linT[1][1]);
+	s.linZ = V8FromV4(linT[0][2], linT[1][2]);
+	s.angX = V8FromV4(angT[0][0], angT[1][0]);
+	s.angY = V8FromV4(angT[0][1], angT[1][1]);
+	s.angZ = V8FromV4(angT[0][2], angT[1][2]);
+}
+
+PX_FORCE_INLINE void unpackSolverBodies8(const SolverBodyState8& s, Vec4V* PX_RESTRICT linVel, Vec4V* PX_RESTRICT angState)
+{
+	Vec4V linX[2] = { V8GetLow(s.linX), V8GetHigh(s.linX) };
+	Vec4V linY[2] = { V8GetLow(s.linY), V8GetHigh(s.linY) };
+	Vec4V linZ[2] = { V8GetLow(s.linZ), V8GetHigh(s.linZ) };
+	Vec4V angX[2] = { V8GetLow(s.angX), V8GetHigh(s.angX) };
+	Vec4V angY[2] = { V8GetLow(s.angY), V8GetHigh(s.angY) };
+	Vec4V angZ[2] = { V8GetLow(s.angZ), V8GetHigh(s.angZ) };
+
+	for(PxU32 h = 0; h < 2; ++h)
+	{
+		Vec4V linW = s.linW[h];
+		Vec4V angW = s.angW[h];
+		PX_TRANSPOSE_44(linX[h], linY[h], linZ[h], linW, linVel[4 * h], linVel[4 * h + 1], linVel[4 * h + 2], linVel[4 * h + 3]);
+		PX_TRANSPOSE_44(angX[h], angY[h], angZ[h], angW, angState[4 * h], angState[4 * h + 1], angState[4 * h + 2], angState[4 * h + 3]);
+	}
+}
+
+template<bool TIsDynamic> struct ContactBlock8Layout
+{
+	typedef SolverContactBatchPointBase8 Point;
+	typedef SolverContactFrictionBase8 Friction;
+};
+
+template<> struct ContactBlock8Layout<true>
+{
+	typedef SolverContactBatchPointDynamic8 Point;
+	typedef SolverContactFrictionDynamic8 Friction;
+};
+
+}
+
+template<bool TIsDynamic>
+static void solveContact8_Block(const PxSolverConstraintDesc* PX_RESTRICT desc, SolverContext& cache)
+{
+	typedef typename ContactBlock8Layout<TIsDynamic>::Point ContactPoint8;
+	typedef typename ContactBlock8Layout<TIsDynamic>::Friction ContactFriction8;
+
+	PxSolverBody* bodiesA[8];
+	PxSolverBody* bodiesB[8];
+	for(PxU32 a = 0; a < 8; ++a)
+	{
+		bodiesA[a] = desc[a].bodyA;
+		bodiesB[a] = desc[a].bodyB;
+	}
+
+	SolverBodyState8 b0, b1;
+	loadSolverBodies8(bodiesA, b0);
+	if(TIsDynamic)
+		loadSolverBodies8(bodiesB, b1);
+
+	const Vec8V vZero = V8Zero();
+	const Vec8V vMax = V8Splat(FMax());
+
+	const PxU8* PX_RESTRICT last = desc[0].constraint + getConstraintLength(desc[0]);
+
+	PxU8* PX_RESTRICT currPtr = desc[0].constraint;
+
+	const PxU8* PX_RESTRICT prefetchAddress = currPtr + sizeof(SolverContactHeader8) + sizeof(ContactPoint8);
+
+	const SolverContactHeader8* PX_RESTRICT hdr = reinterpret_cast<SolverContactHeader8*>(currPtr);
+
+	const Vec8V invMassA = V8LoadA(hdr->invMass0D0);
+	const Vec8V invMassB = TIsDynamic ? V8LoadA(hdr->invMass1D1) : vZero;
+
+	const Vec8V sumInvMass = V8Add(invMassA, invMassB);
+
+	while(currPtr < last)
+	{
+		hdr = reinterpret_cast<const SolverContactHeader8*>(currPtr);
+
+		PX_ASSERT(hdr->type == (TIsDynamic ? DY_SC_TYPE_BLOCK8_RB_CONTACT : DY_SC_TYPE_BLOCK8_STATIC_RB_CONTACT));
+
+		currPtr = reinterpret_cast<PxU8*>(const_cast<SolverContactHeader8*>(hdr) + 1);
+
+		const PxU32 numNormalConstr = hdr->numNormalConstr;
+		const PxU32	numFrictionConstr = hdr->numFrictionConstr;
+
+		const bool hasMaxImpulse = (hdr->flag & SolverContactHeader8::eHAS_MAX_IMPULSE) != 0;
+
+		PxF32* PX_RESTRICT appliedForces = reinterpret_cast<PxF32*>(currPtr);
+		currPtr += sizeof(PxF32) * 8 * numNormalConstr;
+
+		const ContactPoint8* PX_RESTRICT contacts = reinterpret_cast<ContactPoint8*>(currPtr);
+		currPtr += sizeof(ContactPoint8) * numNormalConstr;
+
+		const PxF32* PX_RESTRICT maxImpulses = reinterpret_cast<PxF32*>(currPtr);
+		if(hasMaxImpulse)
+			currPtr += sizeof(PxF32) * 8 * numNormalConstr;
+
+		SolverFrictionSharedData8* PX_RESTRICT fd = reinterpret_cast<SolverFrictionSharedData8*>(currPtr);
+		if(numFrictionConstr)
+			currPtr += sizeof(SolverFrictionSharedData8);
+
+		PxF32* PX_RESTRICT frictionAppliedForces = reinterpret_cast<PxF32*>(currPtr);
+		currPtr += sizeof(PxF32) * 8 * numFrictionConstr;
+
+		const ContactFriction8* PX_RESTRICT frictions = reinterpret_cast<ContactFriction8*>(currPtr);
+		currPtr += sizeof(ContactFriction8) * numFrictionConstr;
+
+		Vec8V accumulatedNormalImpulse = vZero;
+
+		const Vec8V angD0 = V8LoadA(hdr->angDom0);
+		const Vec8V angD1 = TIsDynamic ? V8LoadA(hdr->angDom1) : vZero;
+
+		const Vec8V _normalT0 = V8LoadA(hdr->normalX);
+		const Vec8V _normalT1 = V8LoadA(hdr->normalY);
+		const Vec8V _normalT2 = V8LoadA(hdr->normalZ);
+
+		Vec8V relVel1 = V8Mul(b0.linX, _normalT0);
+		relVel1 = V8MulAdd(b0.linY, _normalT1, relVel1);
+		relVel1 = V8MulAdd(b0.linZ, _normalT2, relVel1);
+		if(TIsDynamic)
+		{
+			Vec8V contactNormalVel3 = V8Mul(b1.linX, _normalT0);
+			contactNormalVel3 = V8MulAdd(b1.linY, _normalT1, contactNormalVel3);
+			contactNormalVel3 = V8MulAdd(b1.linZ, _normalT2, contactNormalVel3);
+			relVel1 = V8Sub(relVel1, contactNormalVel3);
+		}
+
+		Vec8V accumDeltaF = vZero;
+
+		for(PxU32 i=0;i<numNormalConstr;i++)
+		{
+			const ContactPoint8& c = contacts[i];
+
+			PxU32 offset = 0;
+			Ps::prefetchLine(prefetchAddress, offset += 64);
+			Ps::prefetchLine(prefetchAddress, offset += 64);
+			Ps::prefetchLine(prefetchAddress, offset += 64);
+			Ps::prefetchLine(prefetchAddress, offset += 64);
+			Ps::prefetchLine(prefetchAddress, offset += 64);
+			prefetchAddress += offset;
+
+			const Vec8V appliedForce = V8LoadA(appliedForces + 8 * i);
+			const Vec8V maxImpulse = hasMaxImpulse ? V8LoadA(maxImpulses + 8 * i) : vMax;
+
+			Vec8V normalVel = V8MulAdd(V8LoadA(c.raXnX), b0.angX, relVel1);
+			normalVel = V8MulAdd(V8LoadA(c.raXnY), b0.angY, normalVel);
+			normalVel = V8MulAdd(V8LoadA(c.raXnZ), b0.angZ, normalVel);
+			if(TIsDynamic)
+			{
+				const SolverContactBatchPointDynamic8& dc = reinterpret_cast<const SolverContactBatchPointDynamic8&>(c);
+				normalVel = V8NegMulSub(V8LoadA(dc.rbXnX), b1.angX, normalVel);
+				normalVel = V8NegMulSub(V8LoadA(dc.rbXnY), b1.angY, normalVel);
+				normalVel = V8NegMulSub(V8LoadA(dc.rbXnZ), b1.angZ, normalVel);
+			}
+
+			Vec8V deltaF = V8NegMulSub(normalVel, V8LoadA(c.velMultiplier), V8LoadA(c.biasedErr));
+
+			deltaF = V8Max(deltaF, V8Neg(appliedForce));
+			const Vec8V newAppliedForce = V8Min(V8Add(appliedForce, deltaF), maxImpulse);
+			deltaF = V8Sub(newAppliedForce, appliedForce);
+
+			accumDeltaF = V8Add(accumDeltaF, deltaF);
+
+			relVel1 = V8MulAdd(sumInvMass, deltaF, relVel1);
+
+			const Vec8V angDetaF0 = V8Mul(deltaF, angD0);
+			b0.angX = V8MulAdd(V8LoadA(c.raXnX), angDetaF0, b0.angX);
+			b0.angY = V8MulAdd(V8LoadA(c.raXnY), angDetaF0, b0.angY);
+			b0.angZ = V8MulAdd(V8LoadA(c.raXnZ), angDetaF0, b0.angZ);
+			if(TIsDynamic)
+			{
+				const SolverContactBatchPointDynamic8& dc = reinterpret_cast<const SolverContactBatchPointDynamic8&>(c);
+				const Vec8V angDetaF1 = V8Mul(deltaF, angD1);
+				b1.angX = V8NegMulSub(V8LoadA(dc.rbXnX), angDetaF1, b1.angX);
+				b1.angY = V8NegMulSub(V8LoadA(dc.rbXnY), angDetaF1, b1.angY);
+				b1.angZ = V8NegMulSub(V8LoadA(dc.rbXnZ), angDetaF1, b1.angZ);
+			}
+
+			V8StoreA(newAppliedForce, appliedForces + 8 * i);
+
+			accumulatedNormalImpulse = V8Add(accumulatedNormalImpulse, newAppliedForce);
+		}
+
+		const Vec8V accumDeltaF_IM0 = V8Mul(accumDeltaF, invMassA);
+		b0.linX = V8MulAdd(_normalT0, accumDeltaF_IM0, b0.linX);
+		b0.linY = V8MulAdd(_normalT1, accumDeltaF_IM0, b0.linY);
+		b0.linZ = V8MulAdd(_normalT2, accumDeltaF_IM0, b0.linZ);
+		if(TIsDynamic)
+		{
+			const Vec8V accumDeltaF_IM1 = V8Mul(accumDeltaF, invMassB);
+			b1.linX = V8NegMulSub(_normalT0, accumDeltaF_IM1, b1.linX);
+			b1.linY = V8NegMulSub(_normalT1, accumDeltaF_IM1, b1.linY);
+			b1.linZ = V8NegMulSub(_normalT2, accumDeltaF_IM1, b1.linZ);
+		}
+
+		if(cache.doFriction && numFrictionConstr)
+		{
+			const Vec8V maxFrictionImpulse = V8Mul(V8LoadA(hdr->staticFriction), accumulatedNormalImpulse);
+			const Vec8V maxDynFrictionImpulse = V8Mul(V8LoadA(hdr->dynamicFriction), accumulatedNormalImpulse);
+			const Vec8V negMaxDynFrictionImpulse = V8Neg(maxDynFrictionImpulse);
+			BoolV8 broken = BV8False();
+
+			if(cache.writeBackIteration)
+			{
+				for(PxU32 a = 0; a < 8; ++a)
+					Ps::prefetchLine(fd->frictionBrokenWritebackByte[a]);
+			}
+
+			for(PxU32 i=0;i<numFrictionConstr;i++)
+			{
+				const ContactFriction8& f = frictions[i];
+
+				PxU32 offset = 0;
+				Ps::prefetchLine(prefetchAddress, offset += 64);
+				Ps::prefetchLine(prefetchAddress, offset += 64);
+				Ps::prefetchLine(prefetchAddress, offset += 64);
+				Ps::prefetchLine(prefetchAddress, offset += 64);
+				Ps::prefetchLine(prefetchAddress, offset += 64);
+				prefetchAddress += offset;
+
+				const Vec8V appliedForce = V8LoadA(frictionAppliedForces + 8 * i);
+
+				const Vec8V normalT0 = V8LoadA(fd->normalX[i&1]);
+				const Vec8V normalT1 = V8LoadA(fd->normalY[i&1]);
+				const Vec8V normalT2 = V8LoadA(fd->normalZ[i&1]);
+
+				Vec8V normalVel = V8Mul(b0.linX, normalT0);
+				normalVel = V8MulAdd(b0.linY, normalT1, normalVel);
+				normalVel = V8MulAdd(b0.linZ, normalT2, normalVel);
+				normalVel = V8MulAdd(V8LoadA(f.raXnX), b0.angX, normalVel);
+				normalVel = V8MulAdd(V8LoadA(f.raXnY), b0.angY, normalVel);
+				normalVel = V8MulAdd(V8LoadA(f.raXnZ), b0.angZ, normalVel);
+				if(TIsDynamic)
+				{
+					const SolverContactFrictionDynamic8& df = reinterpret_cast<const SolverContactFrictionDynamic8&>(f);
+					normalVel = V8NegMulSub(b1.linX, normalT0, normalVel);
+					normalVel = V8NegMulSub(b1.linY, normalT1, normalVel);
+					normalVel = V8NegMulSub(b1.linZ, normalT2, normalVel);
+					normalVel = V8NegMulSub(V8LoadA(df.rbXnX), b1.angX, normalVel);
+					normalVel = V8NegMulSub(V8LoadA(df.rbXnY), b1.angY, normalVel);
+					normalVel = V8NegMulSub(V8LoadA(df.rbXnZ), b1.angZ, normalVel);
+				}
+
+				// appliedForce -bias * velMultiplier - a hoisted part of the total impulse computation
+				const Vec8V tmp1 = V8Sub(appliedForce, V8LoadA(f.scaledBias));
+
+				const Vec8V totalImpulse = V8NegMulSub(normalVel, V8LoadA(f.velMultiplier), tmp1);
+
+				broken = BV8Or(broken, V8IsGrtr(V8Abs(totalImpulse), maxFrictionImpulse));
+
+				const Vec8V newAppliedForce = V8Sel(broken, V8Min(maxDynFrictionImpulse, V8Max(negMaxDynFrictionImpulse, totalImpulse)), totalImpulse);
+
+				const Vec8V deltaF = V8Sub(newAppliedForce, appliedForce);
+
+				V8StoreA(newAppliedForce, frictionAppliedForces + 8 * i);
+
+				const Vec8V deltaFIM0 = V8Mul(deltaF, invMassA);
+				const Vec8V angDetaF0 = V8Mul(deltaF, angD0);
+
+				b0.linX = V8MulAdd(normalT0, deltaFIM0, b0.linX);
+				b0.linY = V8MulAdd(normalT1, deltaFIM0, b0.linY);
+				b0.linZ = V8MulAdd(normalT2, deltaFIM0, b0.linZ);
+				b0.angX = V8MulAdd(V8LoadA(f.raXnX), angDetaF0, b0.angX);
+				b0.angY = V8MulAdd(V8LoadA(f.raXnY), angDetaF0, b0.angY);
+				b0.angZ = V8MulAdd(V8LoadA(f.raXnZ), angDetaF0, b0.angZ);
+
+				if(TIsDynamic)
+				{
+					const SolverContactFrictionDynamic8& df = reinterpret_cast<const SolverContactFrictionDynamic8&>(f);
+					const Vec8V deltaFIM1 = V8Mul(deltaF, invMassB);
+					const Vec8V angDetaF1 = V8Mul(deltaF, angD1);
+
+					b1.linX = V8NegMulSub(normalT0, deltaFIM1, b1.linX);
+					b1.linY = V8NegMulSub(normalT1, deltaFIM1, b1.linY);
+					b1.linZ = V8NegMulSub(normalT2, deltaFIM1, b1.linZ);
+					b1.angX = V8NegMulSub(V8LoadA(df.rbXnX), angDetaF1, b1.angX);
+					b1.angY = V8NegMulSub(V8LoadA(df.rbXnY), angDetaF1, b1.angY);
+					b1.angZ = V8NegMulSub(V8LoadA(df.rbXnZ), angDetaF1, b1.angZ);
+				}
+			}
+			BV8StoreA(broken, fd->broken);
+		}
+	}
+
+	Vec4V linVel[8], angState[8];
+
+	unpackSolverBodies8(b0, linVel, angState);
+	for(PxU32 a = 0; a < 8; ++a)
+	{
+		V4StoreA(linVel[a], &bodiesA[a]->linearVelocity.x);
+		V4StoreA(angState[a], &bodiesA[a]->angularState.x);
+		PX_ASSERT(bodiesA[a]->linearVelocity.isFinite());
+		PX_ASSERT(bodiesA[a]->angularState.isFinite());
+	}
+
+	if(TIsDynamic)
+	{
+		unpackSolverBodies8(b1, linVel, angState);
+		for(PxU32 a = 0; a < 8; ++a)
+		{
+			if(desc[a].bodyBDataIndex != 0)
+			{
+				V4StoreA(linVel[a], &bodiesB[a]->linearVelocity.x);
+				V4StoreA(angState[a], &bodiesB[a]->angularState.x);
+				PX_ASSERT(bodiesB[a]->linearVelocity.isFinite());
+				PX_ASSERT(bodiesB[a]->angularState.isFinite());
+			}
+		}
+	}
+}
+
+static void concludeContact8_Block(const PxSolverConstraintDesc* PX_RESTRICT desc, SolverContext& /*cache*/, PxU32 contactSize, PxU32 frictionSize)
+{
+	const PxU8* PX_RESTRICT last = desc[0].constraint + getConstraintLength(desc[0]);
+
+	PxU8* PX_RESTRICT currPtr = desc[0].constraint;
+
+	while(currPtr < last)
+	{
+		const SolverContactHeader8* PX_RESTRICT hdr = reinterpret_cast<SolverContactHeader8*>(currPtr);
+
+		currPtr = const_cast<PxU8*>(reinterpret_cast<const PxU8*>(hdr + 1));
+
+		const PxU32 numNormalConstr = hdr->numNormalConstr;
+		const PxU32	numFrictionConstr = hdr->numFrictionConstr;
+
+		currPtr += sizeof(PxF32) * 8 * numNormalConstr;
+
+		PxU8* PX_RESTRICT contacts = currPtr;
+		currPtr += numNormalConstr * contactSize;
+
+		if(hdr->flag & SolverContactHeader8::eHAS_MAX_IMPULSE)
+			currPtr += sizeof(PxF32) * 8 * numNormalConstr;
+
+		if(numFrictionConstr)
+			currPtr += sizeof(SolverFrictionSharedData8);
+
+		currPtr += sizeof(PxF32) * 8 * numFrictionConstr;
+
+		PxU8* PX_RESTRICT frictions = currPtr;
+		currPtr += numFrictionConstr * frictionSize;
+
+		for(PxU32 i=0;i<numNormalConstr;i++)
+		{
+			SolverContactBatchPointBase8& c = *reinterpret_cast<SolverContactBatchPointBase8*>(contacts + i * contactSize);
+			V8StoreA(V8Sub(V8LoadA(c.biasedErr), V8LoadA(c.scaledBias)), c.biasedErr);
+		}
+
+		for(PxU32 i=0;i<numFrictionConstr;i++)
+		{
+			SolverContactFrictionBase8& f = *reinterpret_cast<SolverContactFrictionBase8*>(frictions + i * frictionSize);
+			V8StoreA(V8LoadA(f.targetVelocity), f.scaledBias);
+		}
+	}
+}
+
+static void writeBackContact8_Block(const PxSolverConstraintDesc* PX_RESTRICT desc, SolverContext& cache,
+							 const PxSolverBodyData** PX_RESTRICT bd0, const PxSolverBodyData** PX_RESTRICT bd1)
+{
+	const PxU8* PX_RESTRICT last = desc[0].constraint + getConstraintLength(desc[0]);
+
+	PxU8* PX_RESTRICT currPtr = desc[0].constraint;
+
+	PxReal* PX_RESTRICT vForceWriteback[8];
+	for(PxU32 a = 0; a < 8; ++a)
+		vForceWriteback[a] = reinterpret_cast<PxReal*>(desc[a].writeBack);
+
+	const PxU8 type = *desc[0].constraint;
+	const PxU32 contactSize = type == DY_SC_TYPE_BLOCK8_RB_CONTACT ? sizeof(SolverContactBatchPointDynamic8) : sizeof(SolverContactBatchPointBase8);
+	const PxU32 frictionSize = type == DY_SC_TYPE_BLOCK8_RB_CONTACT ? sizeof(SolverContactFrictionDynamic8) : sizeof(SolverContactFrictionBase8);
+
+	Vec8V normalForce = V8Zero();
+
+	bool writeBackThresholds[8] = {false, false, false, false, false, false, false, false};
+
+	while(currPtr < last)
+	{
+		const SolverContactHeader8* PX_RESTRICT hdr = reinterpret_cast<SolverContactHeader8*>(currPtr);
+
+		currPtr = const_cast<PxU8*>(reinterpret_cast<const PxU8*>(hdr + 1));
+
+		const PxU32 numNormalConstr = hdr->numNormalConstr;
+		const PxU32	numFrictionConstr = hdr->numFrictionConstr;
+
+		const PxF32* PX_RESTRICT appliedForces = reinterpret_cast<PxF32*>(currPtr);
+		currPtr += sizeof(PxF32) * 8 * numNormalConstr;
+
+		currPtr += numNormalConstr * contactSize;
+
+		if(hdr->flag & SolverContactHeader8::eHAS_MAX_IMPULSE)
+			currPtr += sizeof(PxF32) * 8 * numNormalConstr;
+
+		const SolverFrictionSharedData8* PX_RESTRICT fd = reinterpret_cast<SolverFrictionSharedData8*>(currPtr);
+		if(numFrictionConstr)
+			currPtr += sizeof(SolverFrictionSharedData8);
+
+		currPtr += sizeof(PxF32) * 8 * numFrictionConstr;
+
+		currPtr += numFrictionConstr * frictionSize;
+
+		for(PxU32 a = 0; a < 8; ++a)
+			writeBackThresholds[a] = (hdr->flags[a] & SolverContactHeader::eHAS_FORCE_THRESHOLDS) != 0;
+
+		for(PxU32 i=0;i<numNormalConstr;i++)
+		{
+			const PxF32* PX_RESTRICT row = appliedForces + 8 * i;
+			normalForce = V8Add(normalForce, V8LoadA(row));
+
+			for(PxU32 a = 0; a < 8; ++a)
+			{
+				if(vForceWriteback[a] && i < hdr->numNormalConstrs[a])
+					*vForceWriteback[a]++ = row[a];
+			}
+		}
+
+		if(numFrictionConstr)
+		{
+			for(PxU32 a = 0; a < 8; ++a)
+			{
+				if(hdr->numFrictionConstrs[a] && fd->broken[a])
+					*fd->frictionBrokenWritebackByte[a] = 1;	// PT: bad L2 miss here
+			}
+		}
+	}
+
+	PX_ALIGN(32, PxReal nf[8]);
+	V8StoreA(normalForce, nf);
+
+	Sc::ShapeInteraction* const* shapeInteractions = reinterpret_cast<SolverContactHeader8*>(desc[0].constraint)->shapeInteraction;
+
+	for(PxU32 a = 0; a < 8; ++a)
+	{
+		if(writeBackThresholds[a] && desc[a].linkIndexA == PxSolverConstraintDesc::NO_LINK && desc[a].linkIndexB == PxSolverConstraintDesc::NO_LINK &&
+			nf[a] !=0.f && (bd0[a]->reportThreshold < PX_MAX_REAL  || bd1[a]->reportThreshold < PX_MAX_REAL))
+		{
+			ThresholdStreamElement elt;
+			elt.normalForce = nf[a];
+			elt.threshold = PxMin<float>(bd0[a]->reportThreshold, bd1[a]->reportThreshold);
+			elt.nodeIndexA = IG::NodeIndex(bd0[a]->nodeIndex);
+			elt.nodeIndexB = IG::NodeIndex(bd1[a]->nodeIndex);
+			elt.shapeInteraction = shapeInteractions[a];
+			Ps::order(elt.nodeIndexA, elt.nodeIndexB);
+			PX_ASSERT(elt.nodeIndexA < elt.nodeIndexB);
+			PX_ASSERT(cache.mThresholdStreamIndex<cache.mThresholdStreamLength);
+			cache.mThresholdStream[cache.mThresholdStreamIndex++] = elt;
+		}
+	}
+}
+
+static PX_FORCE_INLINE void flushThresholdStream(SolverContext& cache)
+{
+	//Write back to global buffer
+	PxI32 threshIndex = physx::shdfnd::atomicAdd(cache.mSharedOutThresholdPairs, PxI32(cache.mThresholdStreamIndex)) - PxI32(cache.mThresholdStreamIndex);
+	for(PxU32 a = 0; a < cache.mThresholdStreamIndex; ++a)
+	{
+		cache.mSharedThresholdStream[a + threshIndex] = cache.mThresholdStream[a];
+	}
+	cache.mThresholdStreamIndex = 0;
+}
+
+static void writeBackContact8(const PxSolverConstraintDesc* PX_RESTRICT desc, SolverContext& cache)
+{
+	const PxSolverBodyData* bd0[8];
+	const PxSolverBodyData* bd1[8];
+	for(PxU32 a = 0; a < 8; ++a)
+	{
+		bd0[a] = &cache.solverBodyArray[desc[a].bodyADataIndex];
+		bd1[a] = &cache.solverBodyArray[desc[a].bodyBDataIndex];
+	}
+
+	//The 4-wide write-back leaves room for 4 elements, a block of 8 can push up to 8.
+	if(cache.mThresholdStreamIndex > (cache.mThresholdStreamLength - 8))
+		flushThresholdStream(cache);
+
+	writeBackContact8_Block(desc, cache, bd0, bd1);
+
+	if(cache.mThresholdStreamIndex > (cache.mThresholdStreamLength - 4))
+		flushThresholdStream(cache);
+}
+
+void solveContactPreBlock8(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 /*constraintCount*/, SolverContext& cache)
+{
+	solveContact8_Block<true>(desc, cache);
+}
+
+void solveContactPreBlock8_Static(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 /*constraintCount*/, SolverContext& cache)
+{
+	solveContact8_Block<false>(desc, cache);
+}
+
+void solveContactPreBlock8_Conclude(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 /*constraintCount*/, SolverContext& cache)
+{
+	solveContact8_Block<true>(desc, cache);
+	concludeContact8_Block(desc, cache, sizeof(SolverContactBatchPointDynamic8), sizeof(SolverContactFrictionDynamic8));
+}
+
+void solveContactPreBlock8_ConcludeStatic(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 /*constraintCount*/, SolverContext& cache)
+{
+	solveContact8_Block<false>(desc, cache);
+	concludeContact8_Block(desc, cache, sizeof(SolverContactBatchPointBase8), sizeof(SolverContactFrictionBase8));
+}
+
+void solveContactPreBlock8_WriteBack(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 /*constraintCount*/, SolverContext& cache)
+{
+	solveContact8_Block<true>(desc, cache);
+	writeBackContact8(desc, cache);
+}
+
+void solveContactPreBlock8_WriteBackStatic(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 /*constraintCount*/, SolverContext& cache)
+{
+	solveContact8_Block<false>(desc, cache);
+	writeBackContact8(desc, cache);
+}
+
+} // namespace Avx2
+
+}
+
+}
+
+#endif
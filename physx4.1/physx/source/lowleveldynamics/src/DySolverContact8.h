@@ -0,0 +1,170 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+
+#ifndef DY_SOLVERCONTACT8_H
+#define DY_SOLVERCONTACT8_H
+
+#include "foundation/PxSimpleTypes.h"
+#include "PxvConfig.h"
+#include "DySolverContact.h"
+
+namespace physx
+{
+
+namespace Sc
+{
+	class ShapeInteraction;
+}
+
+namespace Dy
+{
+
+/**
+\brief 8-wide variant of the batched SOA contact data in DySolverContact4.h.
+
+The layout mirrors the 4-wide stream (header, applied forces, contacts, max impulses, friction shared data, friction applied forces,
+frictions) but every per-lane value is a row of 8 floats. All structures are multiples of 32 bytes and the constraint block
+is 32-byte aligned, so every row can be loaded with an aligned 256-bit load. These blocks are only created when the AVX2
+solver kernels are available, see isContactBlock8Supported().
+*/
+struct SolverContactHeader8
+{
+	enum
+	{
+		eHAS_MAX_IMPULSE = 1 << 0,
+		eHAS_TARGET_VELOCITY = 1 << 1
+	};
+
+	PxU8	type;					//Note: mType should be first as the solver expects a type in the first byte.
+	PxU8	numNormalConstr;
+	PxU8	numFrictionConstr;
+	PxU8	flag;
+
+	PxU8	flags[8];
+
+	//KS - used for write-back only
+	PxU8	numNormalConstrs[8];
+	PxU8	numFrictionConstrs[8];
+	PxU8	pad[4];
+
+	PxF32	restitution[8];
+	PxF32	staticFriction[8];
+	PxF32	dynamicFriction[8];
+	PxF32	invMass0D0[8];
+	PxF32	invMass1D1[8];
+	PxF32	angDom0[8];
+	PxF32	angDom1[8];
+	PxF32	normalX[8];
+	PxF32	normalY[8];
+	PxF32	normalZ[8];
+
+	Sc::ShapeInteraction* shapeInteraction[8];		//384 or 416
+};
+
+#if !PX_P64_FAMILY
+PX_COMPILE_TIME_ASSERT(sizeof(SolverContactHeader8) == 384);
+#else
+PX_COMPILE_TIME_ASSERT(sizeof(SolverContactHeader8) == 416);
+#endif
+
+/**
+\brief This represents a batch of 8 contacts with static rolled into a single structure
+*/
+struct SolverContactBatchPointBase8
+{
+	PxF32 raXnX[8];
+	PxF32 raXnY[8];
+	PxF32 raXnZ[8];
+	PxF32 velMultiplier[8];
+	PxF32 scaledBias[8];
+	PxF32 biasedErr[8];
+};
+PX_COMPILE_TIME_ASSERT(sizeof(SolverContactBatchPointBase8) == 192);
+
+/**
+\brief Contains the additional data required to represent 8 contacts between 2 dynamic bodies
+@see SolverContactBatchPointBase8
+*/
+struct SolverContactBatchPointDynamic8 : public SolverContactBatchPointBase8
+{
+	PxF32 rbXnX[8];
+	PxF32 rbXnY[8];
+	PxF32 rbXnZ[8];
+};
+PX_COMPILE_TIME_ASSERT(sizeof(SolverContactBatchPointDynamic8) == 288);
+
+/**
+\brief This represents the shared information of a batch of 8 friction constraints
+*/
+struct SolverFrictionSharedData8
+{
+	PxU32 broken[8];
+	PxU8* frictionBrokenWritebackByte[8];
+	PxF32 normalX[2][8];
+	PxF32 normalY[2][8];
+	PxF32 normalZ[2][8];
+};
+#if !PX_P64_FAMILY
+PX_COMPILE_TIME_ASSERT(sizeof(SolverFrictionSharedData8) == 256);
+#else
+PX_COMPILE_TIME_ASSERT(sizeof(SolverFrictionSharedData8) == 288);
+#endif
+
+/**
+\brief This represents a batch of 8 friction constraints with static rolled into a single structure
+*/
+struct SolverContactFrictionBase8
+{
+	PxF32 raXnX[8];
+	PxF32 raXnY[8];
+	PxF32 raXnZ[8];
+	PxF32 scaledBias[8];
+	PxF32 velMultiplier[8];
+	PxF32 targetVelocity[8];
+};
+PX_COMPILE_TIME_ASSERT(sizeof(SolverContactFrictionBase8) == 192);
+
+/**
+\brief Contains the additional data required to represent 8 friction constraints between 2 dynamic bodies
+@see SolverContactFrictionBase8
+*/
+struct SolverContactFrictionDynamic8 : public SolverContactFrictionBase8
+{
+	PxF32 rbXnX[8];
+	PxF32 rbXnY[8];
+	PxF32 rbXnZ[8];
+};
+PX_COMPILE_TIME_ASSERT(sizeof(SolverContactFrictionDynamic8) == 288);
+
+}
+
+}
+
+#endif //DY_SOLVERCONTACT8_H
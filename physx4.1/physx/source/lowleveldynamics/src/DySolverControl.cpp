@@ -43,6 +43,7 @@
 #include "PsIntrinsics.h"
 #include "DyArticulationPImpl.h"
 #include "PsThread.h"
+#include "PsCpu.h"
 #include "DySolverConstraintDesc.h"
 #include "DySolverContext.h"
 
@@ -90,6 +91,30 @@ void ext1DBlockWriteBack			(const PxSolverConstraintDesc* PX_RESTRICT desc, cons
 void contactPreBlock_WriteBack		(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 constraintCount, SolverContext& cache);
 void writeBack1D4Block				(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 constraintCount, SolverContext& cache);
 
+#if PX_DY_AVX2_KERNELS
+// Same kernels compiled with AVX2 + FMA, see DySolverConstraintsBlockAVX2.cpp
+namespace Avx2
+{
+void solveContactPreBlock					(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 constraintCount, SolverContext& cache);
+void solveContactPreBlock_Static			(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 constraintCount, SolverContext& cache);
+void solve1D4_Block							(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 constraintCount, SolverContext& cache);
+void solveContactPreBlock_Conclude			(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 constraintCount, SolverContext& cache);
+void solveContactPreBlock_ConcludeStatic	(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 constraintCount, SolverContext& cache);
+void solve1D4Block_Conclude					(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 constraintCount, SolverContext& cache);
+void solveContactPreBlock_WriteBack			(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 constraintCount, SolverContext& cache);
+void solveContactPreBlock_WriteBackStatic	(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 constraintCount, SolverContext& cache);
+void solve1D4Block_WriteBack				(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 constraintCount, SolverContext& cache);
+
+// 8-wide contact blocks, see DySolverConstraintsBlock8.cpp
+void solveContactPreBlock8					(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 constraintCount, SolverContext& cache);
+void solveContactPreBlock8_Static			(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 constraintCount, SolverContext& cache);
+void solveContactPreBlock8_Conclude			(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 constraintCount, SolverContext& cache);
+void solveContactPreBlock8_ConcludeStatic	(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 constraintCount, SolverContext& cache);
+void solveContactPreBlock8_WriteBack		(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 constraintCount, SolverContext& cache);
+void solveContactPreBlock8_WriteBackStatic	(const PxSolverConstraintDesc* PX_RESTRICT desc, const PxU32 constraintCount, SolverContext& cache);
+}
+#endif
+
 // could move this to PxPreprocessor.h but 
 // no implementation available for MSVC
 #if PX_GCC_FAMILY
@@ -100,7 +125,7 @@ void writeBack1D4Block				(const PxSolverConstraintDesc* PX_RESTRICT desc, const
  
 #define DYNAMIC_ARTICULATION_REGISTRATION(x) 0
 
-static SolveBlockMethod gVTableSolveBlock[] PX_UNUSED_ATTRIBUTE = 
+static SolveBlockMethod gVTableSolveBlock[DY_SC_CONSTRAINT_TYPE_COUNT] PX_UNUSED_ATTRIBUTE = 
 {
 	0,
 	solveContactBlock,														// DY_SC_TYPE_RB_CONTACT
@@ -114,7 +139,7 @@ static SolveBlockMethod gVTableSolveBlock[] PX_UNUSED_ATTRIBUTE =
 	solve1D4_Block,															// DY_SC_TYPE_BLOCK_1D,
 };
 
-static SolveWriteBackBlockMethod gVTableSolveWriteBackBlock[] PX_UNUSED_ATTRIBUTE = 
+static SolveWriteBackBlockMethod gVTableSolveWriteBackBlock[DY_SC_CONSTRAINT_TYPE_COUNT] PX_UNUSED_ATTRIBUTE = 
 {
 	0,
 	solveContactBlockWriteBack,												// DY_SC_TYPE_RB_CONTACT
@@ -128,7 +153,7 @@ static SolveWriteBackBlockMethod gVTableSolveWriteBackBlock[] PX_UNUSED_ATTRIBUT
 	solve1D4Block_WriteBack,												// DY_SC_TYPE_BLOCK_1D,
 };
 
-static SolveBlockMethod gVTableSolveConcludeBlock[] PX_UNUSED_ATTRIBUTE = 
+static SolveBlockMethod gVTableSolveConcludeBlock[DY_SC_CONSTRAINT_TYPE_COUNT] PX_UNUSED_ATTRIBUTE = 
 {
 	0,
 	solveContactConcludeBlock,												// DY_SC_TYPE_RB_CONTACT
@@ -153,6 +178,67 @@ void SolverCoreRegisterArticulationFns()
 	gVTableSolveConcludeBlock[DY_SC_TYPE_EXT_1D] = solveExt1DConcludeBlock;
 }
 
+// 0 - not registered, 1 - registration in progress, 2 - registered
+static volatile PxI32 gBlockFnsRegistered = 0;
+
+// Swap the 4-wide block kernels for their AVX2 + FMA builds if the CPU can run them. The tables are shared by
+// every scene, so this runs once for the process: the first solver core created patches them, and later
+// creations neither rewrite them under scenes that are solving nor return before the tables are complete.
+static void SolverCoreRegisterBlockFns()
+{
+	if(gBlockFnsRegistered == 2)
+		return;
+
+	if(Ps::atomicCompareExchange(&gBlockFnsRegistered, 1, 0) != 0)
+	{
+		while(gBlockFnsRegistered != 2)
+			Ps::Thread::yield();
+		return;
+	}
+
+#if PX_DY_AVX2_KERNELS
+	if(Ps::Cpu::isAvx2FmaSupported())
+	{
+		gVTableSolveBlock[DY_SC_TYPE_BLOCK_RB_CONTACT] = Avx2::solveContactPreBlock;
+		gVTableSolveBlock[DY_SC_TYPE_BLOCK_STATIC_RB_CONTACT] = Avx2::solveContactPreBlock_Static;
+		gVTableSolveBlock[DY_SC_TYPE_BLOCK_1D] = Avx2::solve1D4_Block;
+
+		gVTableSolveWriteBackBlock[DY_SC_TYPE_BLOCK_RB_CONTACT] = Avx2::solveContactPreBlock_WriteBack;
+		gVTableSolveWriteBackBlock[DY_SC_TYPE_BLOCK_STATIC_RB_CONTACT] = Avx2::solveContactPreBlock_WriteBackStatic;
+		gVTableSolveWriteBackBlock[DY_SC_TYPE_BLOCK_1D] = Avx2::solve1D4Block_WriteBack;
+
+		gVTableSolveConcludeBlock[DY_SC_TYPE_BLOCK_RB_CONTACT] = Avx2::solveContactPreBlock_Conclude;
+		gVTableSolveConcludeBlock[DY_SC_TYPE_BLOCK_STATIC_RB_CONTACT] = Avx2::solveContactPreBlock_ConcludeStatic;
+		gVTableSolveConcludeBlock[DY_SC_TYPE_BLOCK_1D] = Avx2::solve1D4Block_Conclude;
+
+		gVTableSolveBlock[DY_SC_TYPE_BLOCK8_RB_CONTACT] = Avx2::solveContactPreBlock8;
+		gVTableSolveBlock[DY_SC_TYPE_BLOCK8_STATIC_RB_CONTACT] = Avx2::solveContactPreBlock8_Static;
+		gVTableSolveWriteBackBlock[DY_SC_TYPE_BLOCK8_RB_CONTACT] = Avx2::solveContactPreBlock8_WriteBack;
+		gVTableSolveWriteBackBlock[DY_SC_TYPE_BLOCK8_STATIC_RB_CONTACT] = Avx2::solveContactPreBlock8_WriteBackStatic;
+		gVTableSolveConcludeBlock[DY_SC_TYPE_BLOCK8_RB_CONTACT] = Avx2::solveContactPreBlock8_Conclude;
+		gVTableSolveConcludeBlock[DY_SC_TYPE_BLOCK8_STATIC_RB_CONTACT] = Avx2::solveContactPreBlock8_ConcludeStatic;
+	}
+#endif
+
+	Ps::atomicExchange(&gBlockFnsRegistered, 2);
+}
+
+static bool gContactBlock8Enabled = true;
+
+void setContactBlock8Enabled(bool enabled)
+{
+	gContactBlock8Enabled = enabled;
+}
+
+bool isContactBlock8Supported()
+{
+#if PX_DY_AVX2_KERNELS
+	return gContactBlock8Enabled && Ps::Cpu::isAvx2FmaSupported();
+#else
+	return false;
+#endif
+}
+
 SolveBlockMethod* getSolveBlockTable()
 {
 	return gVTableSolveBlock;
@@ -179,6 +265,8 @@ SolverCoreGeneral* SolverCoreGeneral::create(bool fricEveryIteration)
 		scg->frictionEveryIteration = fricEveryIteration;
 	}
 
+	SolverCoreRegisterBlockFns();
+
 	return scg;
 }
 
@@ -154,6 +154,14 @@ SolveBlockMethod* getSolverConcludeBlockTable();
 
 SolveWriteBackBlockMethod* getSolveWritebackBlockTable();
 
+// True if the solver tables can run 8-wide contact blocks (DY_SC_TYPE_BLOCK8_*), i.e. the AVX2 kernels were built and the CPU supports them,
+// and they haven't been disabled with setContactBlock8Enabled.
+bool isContactBlock8Supported();
+
+// Enables or disables the 8-wide contact blocks, e.g. to compare them against the 4-wide blocks. Enabled by default. Only read when the
+// constraint batches are built, so don't call this while a scene is simulating.
+void setContactBlock8Enabled(bool enabled);
+
 }
 
 }
@@ -312,7 +312,17 @@ DynamicsTGSContext::~DynamicsTGSContext()
 
 }
 
-
+#if PX_ENABLE_SIM_STATS
+void DynamicsTGSContext::addThreadStats(const ThreadContext::ThreadSimStats& stats)
+{
+	mSimStats.mNbActiveConstraints += stats.numActiveConstraints;
+	mSimStats.mNbActiveDynamicBodies += stats.numActiveDynamicBodies;
+	mSimStats.mNbActiveKinematicBodies += stats.numActiveKinematicBodies;
+	mSimStats.mNbAxisSolverConstraints += stats.numAxisSolverConstraints;
+	mSimStats.mNbPartitions = PxMax(mSimStats.mNbPartitions, stats.numPartitions);
+	mSimStats.mPartitionTime += stats.partitionTime;
+}
+#endif
 
 void DynamicsTGSContext::setDescFromIndices(PxSolverConstraintDesc& desc,
 	const PxsIndexedInteraction& constraint, const PxU32 solverBodyOffset, PxTGSSolverBodyVel* solverBodies)
@@ -831,6 +841,17 @@ void DynamicsTGSContext::updatePostKinematic(IG::SimpleIslandManager& simpleIsla
 	mergeTask->removeReference();
 }
 
+struct EnhancedSortPredicate
+{
+	bool operator()(const PxsIndexedContactManager& left, const PxsIndexedContactManager& right) const
+	{
+		PxcNpWorkUnit& unit0 = left.contactManager->getWorkUnit();
+		PxcNpWorkUnit& unit1 = right.contactManager->getWorkUnit();
+		return (unit0.mTransformCache0 < unit1.mTransformCache0) ||
+			((unit0.mTransformCache0 == unit1.mTransformCache0) && (unit0.mTransformCache1 < unit1.mTransformCache1));
+	}
+};
+
 void DynamicsTGSContext::prepareBodiesAndConstraints(const SolverIslandObjectsStep& objects,
 	IG::SimpleIslandManager& islandManager,
 	IslandContextStep& islandContext)
@@ -889,18 +910,31 @@ void DynamicsTGSContext::prepareBodiesAndConstraints(const SolverIslandObjectsSt
 			}
 			else
 			{
-				PxsRigidBody* rigid = node.getRigidBody();
 				PX_ASSERT(bodyIndex < (islandContext.mCounts.bodies + mKinematicCount + 1));
-				rigidBodyPtr[bodyIndex] = rigid;
-				bodyArrayPtr[bodyIndex] = &rigid->getCore();
-				nodeIndexArray[bodyIndex] = currentIndex.index();
-				bodyRemapTable[islandSim.getActiveNodeIndex(currentIndex)] = bodyIndex++;
+				nodeIndexArray[bodyIndex++] = currentIndex.index();
 			}
 
 			currentIndex = node.mNextNode;
 		}
 	}
 
+	//Bodies can come in a slightly jumbled order from islandGen. It's deterministic if the scene is 
+	//identical but can vary if there are additional bodies in the scene in a different island.
+	if (mUseEnhancedDeterminism)
+	{
+		Ps::sort(nodeIndexArray, bodyIndex);
+	}
+
+	for (PxU32 a = 0; a < bodyIndex; ++a)
+	{
+		IG::NodeIndex currentIndex(nodeIndexArray[a]);
+		const IG::Node& node = islandSim.getNode(currentIndex);
+		PxsRigidBody* rigid = node.getRigidBody();
+		rigidBodyPtr[a] = rigid;
+		bodyArrayPtr[a] = &rigid->getCore();
+		bodyRemapTable[islandSim.getActiveNodeIndex(currentIndex)] = a;
+	}
+
 
 	PxsIndexedContactManager* indexedManagers = objects.contactManagers;
 
@@ -987,6 +1021,11 @@ void DynamicsTGSContext::prepareBodiesAndConstraints(const SolverIslandObjectsSt
 		}
 	}
 
+	if (mUseEnhancedDeterminism)
+	{
+		Ps::sort(indexedManagers, currentContactIndex, EnhancedSortPredicate());
+	}
+
 	islandContext.mCounts.contactManagers = currentContactIndex;
 }
 
@@ -2268,12 +2307,25 @@ public:
 		args.mNumDifferentBodyConstraints = args.mNumSelfConstraints = args.mNumStaticConstraints = 0;
 		args.mConstraintsPerPartition = &mThreadContext.mConstraintsPerPartition;
 		args.mBitField = &mThreadContext.mPartitionNormalizationBitmap;
-		args.enhancedDeterminism = false;
+		args.mDispatcher = getTaskManager()->getCpuDispatcher();
+		args.mConstraintPartitions = &mThreadContext.mConstraintPartitions;
+		args.mPartitionScratch = &mThreadContext.mPartitionScratch;
+		args.mParallelClassification = mContext.getParallelPartitioning();
+		args.mClassificationScratch = &mThreadContext.mPartitionClassification;
+		args.enhancedDeterminism = mContext.getEnhancedDeterminism();
 
+#if PX_ENABLE_SIM_STATS
+		Ps::Time timer;
+#endif
 		mThreadContext.mMaxPartitions = partitionContactConstraints(args);
 		mThreadContext.mNumDifferentBodyConstraints = args.mNumDifferentBodyConstraints;
 		mThreadContext.mNumSelfConstraints = args.mNumSelfConstraints;
 		mThreadContext.mNumStaticConstraints = args.mNumStaticConstraints;
+#if PX_ENABLE_SIM_STATS
+		ThreadContext::ThreadSimStats& simStats = mThreadContext.getSimStats();
+		simStats.numPartitions = PxMax(simStats.numPartitions, mThreadContext.mMaxPartitions);
+		simStats.partitionTime += PxReal(timer.getElapsedSeconds() * 1000.0);
+#endif
 
 
 		{
@@ -2634,7 +2686,15 @@ void DynamicsTGSContext::iterativeSolveIsland(const SolverIslandObjectsStep& obj
 
 		}
 
-		integrateBodies(objects, counts.bodies, mSolverBodyVelPool.begin() + bodyOffset, mSolverBodyTxInertiaPool.begin() + bodyOffset, mSolverBodyDataPool2.begin() + bodyOffset, mDt);
+		//With enhanced determinism, batches without constraints are integrated in sub-steps like the others, so that
+		//the poses of their bodies do not depend on how the islands are batched.
+		if (mUseEnhancedDeterminism)
+		{
+			for (PxU32 a = 0; a < posIters; ++a)
+				integrateBodies(objects, counts.bodies, mSolverBodyVelPool.begin() + bodyOffset, mSolverBodyTxInertiaPool.begin() + bodyOffset, mSolverBodyDataPool2.begin() + bodyOffset, stepDt);
+		}
+		else
+			integrateBodies(objects, counts.bodies, mSolverBodyVelPool.begin() + bodyOffset, mSolverBodyTxInertiaPool.begin() + bodyOffset, mSolverBodyDataPool2.begin() + bodyOffset, mDt);
 		return;
 	}
 
@@ -3253,6 +3313,18 @@ void DynamicsTGSContext::updateBodyCore(PxBaseTask* continuation)
 
 void DynamicsTGSContext::mergeResults()
 {
+#if PX_ENABLE_SIM_STATS
+	PxcThreadCoherentCacheIterator<ThreadContext, PxcNpMemBlockPool> threadContextIt(mThreadContextPool);
+	ThreadContext* threadContext = threadContextIt.getNext();
+
+	while(threadContext != NULL)
+	{
+		ThreadContext::ThreadSimStats& threadStats = threadContext->getSimStats();
+		addThreadStats(threadStats);
+		threadStats.clear();
+		threadContext = threadContextIt.getNext();
+	}
+#endif
 }
 
 
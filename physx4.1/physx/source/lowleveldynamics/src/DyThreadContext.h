@@ -46,6 +46,12 @@
 #include "DySolverConstraintDesc.h"
 #include "DyCorrelationBuffer.h"
 #include "PsAllocator.h"
+#include "PsAlignedMalloc.h"
+
+//Size of the scratch constraint block for each 4-wide half of an 8-wide contact block.
+#define DY_BLOCK8_SCRATCH_HALF_SIZE 16384
+//Size of the scratch friction patch buffer shared by both halves of an 8-wide contact block.
+#define DY_BLOCK8_FRICTION_SCRATCH_SIZE 8192
 
 namespace physx
 {
@@ -79,6 +85,8 @@ public:
 			numActiveDynamicBodies = 0;
 			numActiveKinematicBodies = 0;
 			numAxisSolverConstraints = 0;
+			numPartitions = 0;
+			partitionTime = 0.0f;
 
 		}
 
@@ -86,6 +94,8 @@ public:
 		PxU32 numActiveDynamicBodies;
 		PxU32 numActiveKinematicBodies;
 		PxU32 numAxisSolverConstraints;
+		PxU32 numPartitions;		//Largest number of partitions of the islands partitioned with this context
+		PxReal partitionTime;		//Time spent partitioning constraints, in milliseconds
 
 	};
 #endif
@@ -105,6 +115,15 @@ public:
 	}
 #endif
 
+	//Scratch memory for the two 4-wide halves of an 8-wide contact block, followed by their friction patches, see
+	//createFinalizeSolverContacts8. Allocated on first use.
+	PX_FORCE_INLINE PxU8* getBlock8Scratch()
+	{
+		if(mBlock8Scratch.empty())
+			mBlock8Scratch.resizeUninitialized(2 * DY_BLOCK8_SCRATCH_HALF_SIZE + DY_BLOCK8_FRICTION_SCRATCH_SIZE);
+		return mBlock8Scratch.begin();
+	}
+
 	Gu::ContactBuffer mContactBuffer;
 
 		// temporary buffer for correlation
@@ -130,6 +149,9 @@ public:
 	Ps::Array<PxU32>					mConstraintsPerPartition;
 	Ps::Array<PxU32>					mFrictionConstraintsPerPartition;
 	Ps::Array<PxU32>					mPartitionNormalizationBitmap;
+	Ps::Array<PxU32>					mConstraintPartitions;		//Scratch for the parallel write of partitioned constraints
+	Ps::Array<PxU32>					mPartitionScratch;
+	Ps::Array<PxU32>					mPartitionClassification;	//Scratch for the parallel classification of constraints
 	PxsBodyCore**						mBodyCoreArray;
 	PxsRigidBody**						mRigidBodyArray;
 	ArticulationV**						mArticulationArray;
@@ -193,6 +215,8 @@ private:
 
 	Ps::Array<ArticulationSolverDesc>	mArticulations;
 
+	Ps::Array<PxU8, Ps::AlignedAllocator<16> >	mBlock8Scratch;
+
 #if PX_ENABLE_SIM_STATS
 	ThreadSimStats				mThreadSimStats;
 #endif
@@ -52,6 +52,8 @@
 #include "extensions/PxJoint.h"
 
 #include "PxsIslandSim.h"
+#include "CmChunkedJob.h"
+#include "PsIntrinsics.h"
 #include "common/PxProfileZone.h"
 
 using namespace physx;
@@ -1397,6 +1399,344 @@ PxActor** NpScene::getActiveActors(PxU32& nbActorsOut)
 	return mScene.getActiveActors(nbActorsOut);
 }
 
+namespace
+{
+	const PxU32 ACTOR_BATCH_CHUNK_SIZE			= 1024;	// actors per chunk of work
+	const PxU32 ACTOR_BATCH_PARALLEL_THRESHOLD	= 4*ACTOR_BATCH_CHUNK_SIZE;
+
+	// Bulk read or write of actor data, processed in chunks over the worker threads of the scene's dispatcher
+	class ActorBatchJob : public Cm::ChunkedJob
+	{
+	public:
+		ActorBatchJob(PxU32 nbActors) : Cm::ChunkedJob(nbActors, ACTOR_BATCH_CHUNK_SIZE)	{}
+
+		void	run(PxCpuDispatcher* dispatcher)	{ Cm::ChunkedJob::run(dispatcher, ACTOR_BATCH_PARALLEL_THRESHOLD);	}
+	};
+
+	// PT: actors are scattered in memory and the data we need spans most of the object, so whole actors are fetched
+	// a few iterations ahead.
+	PX_FORCE_INLINE void prefetchActor(const void* const* actors, PxU32 i, PxU32 end)
+	{
+		if(i+8<end)
+			Ps::prefetch(actors[i+8], sizeof(NpRigidDynamic));
+	}
+
+	class ActiveActorStatesJob : public ActorBatchJob
+	{
+	public:
+		ActiveActorStatesJob(PxActor*const* actors, PxU32 nbActors, PxTransform* globalPoses, PxVec3* linearVelocities, PxVec3* angularVelocities, void** userData) :
+			ActorBatchJob		(nbActors),
+			mActors				(actors),
+			mGlobalPoses		(globalPoses),
+			mLinearVelocities	(linearVelocities),
+			mAngularVelocities	(angularVelocities),
+			mUserData			(userData)
+		{
+		}
+
+		virtual	void	process(PxU32 start, PxU32 end)
+		{
+			PxActor*const* PX_RESTRICT actors = mActors;
+			for(PxU32 i=start;i<end;i++)
+			{
+				prefetchActor(reinterpret_cast<const void*const*>(actors), i, end);
+
+				PxActor* actor = actors[i];
+				const Scb::Body& body = actor->getConcreteType()==PxConcreteType::eRIGID_DYNAMIC ?	static_cast<const NpRigidDynamic*>(actor)->getScbBodyFast()
+																								:	static_cast<const NpArticulationLink*>(actor)->getScbBodyFast();
+				if(mGlobalPoses)
+					mGlobalPoses[i] = body.getBody2World() * body.getBody2Actor().getInverse();
+				if(mLinearVelocities)
+					mLinearVelocities[i] = body.getLinearVelocity();
+				if(mAngularVelocities)
+					mAngularVelocities[i] = body.getAngularVelocity();
+				if(mUserData)
+					mUserData[i] = actor->userData;
+			}
+		}
+	private:
+		PxActor*const*	mActors;
+		PxTransform*	mGlobalPoses;
+		PxVec3*			mLinearVelocities;
+		PxVec3*			mAngularVelocities;
+		void**			mUserData;
+	};
+
+	// Work left by the parallel part of bulk writes, for the parts that touch data shared between bodies
+	enum ActorBatchFollowUp
+	{
+		eFOLLOW_UP_SET_TARGET		= (1<<0),	// set the kinematic target with the regular code path
+		eFOLLOW_UP_NOTIFY_POSE		= (1<<1),	// notify the simulation and the pruning structure of a pose change
+		eFOLLOW_UP_UPDATE_SQ		= (1<<2),	// update scene query shapes
+		eFOLLOW_UP_WAKE_UP			= (1<<3),	// wake up with the regular code path
+		eFOLLOW_UP_FORCE_WAKE_UP	= (1<<4)	// a velocity was not zero, see NpRigidDynamic::wakeUpInternalNoKinematicTest()
+	};
+
+	class KinematicTargetsJob : public ActorBatchJob
+	{
+	public:
+		KinematicTargetsJob(PxRigidDynamic*const* actors, const PxTransform* targets, PxU32 nbActors, PxReal wakeCounter, PxU8* followUps) :
+			ActorBatchJob	(nbActors),
+			mActors			(actors),
+			mTargets		(targets),
+			mFollowUps		(followUps),
+			mWakeCounter	(wakeCounter)
+		{
+		}
+
+		virtual	void	process(PxU32 start, PxU32 end)
+		{
+			for(PxU32 i=start;i<end;i++)
+			{
+				prefetchActor(reinterpret_cast<const void*const*>(mActors), i, end);
+
+				Scb::Body& body = static_cast<NpRigidDynamic*>(mActors[i])->getScbBodyFast();
+
+				// The target is actor related. Transform to body related target
+				const PxTransform bodyTarget = mTargets[i].getNormalized() * body.getBody2Actor();
+
+				PxU8 followUp = 0;
+				if(!body.setKinematicTargetIfAwake(bodyTarget, mWakeCounter))
+					followUp |= eFOLLOW_UP_SET_TARGET;
+				if(body.getFlags() & PxRigidBodyFlag::eUSE_KINEMATIC_TARGET_FOR_SCENE_QUERIES)
+					followUp |= eFOLLOW_UP_UPDATE_SQ;
+				mFollowUps[i] = followUp;
+			}
+		}
+	private:
+		PxRigidDynamic*const*	mActors;
+		const PxTransform*		mTargets;
+		PxU8*					mFollowUps;
+		const PxReal			mWakeCounter;
+	};
+
+	class RigidDynamicStatesJob : public ActorBatchJob
+	{
+	public:
+		RigidDynamicStatesJob(PxRigidDynamic*const* actors, const PxTransform* globalPoses, const PxVec3* linearVelocities, const PxVec3* angularVelocities, PxU32 nbActors,
+			bool autowake, PxReal wakeCounterResetValue, PxU8* followUps) :
+			ActorBatchJob			(nbActors),
+			mActors					(actors),
+			mGlobalPoses			(globalPoses),
+			mLinearVelocities		(linearVelocities),
+			mAngularVelocities		(angularVelocities),
+			mFollowUps				(followUps),
+			mWakeCounterResetValue	(wakeCounterResetValue),
+			mAutowake				(autowake)
+		{
+		}
+
+		virtual	void	process(PxU32 start, PxU32 end)
+		{
+			for(PxU32 i=start;i<end;i++)
+			{
+				prefetchActor(reinterpret_cast<const void*const*>(mActors), i, end);
+
+				Scb::Body& body = static_cast<NpRigidDynamic*>(mActors[i])->getScbBodyFast();
+
+				PxU8 followUp = 0;
+				if(mGlobalPoses)
+				{
+					body.setBody2WorldNoNotify(mGlobalPoses[i].getNormalized() * body.getBody2Actor());
+					followUp |= eFOLLOW_UP_NOTIFY_POSE;
+				}
+
+				bool forceWakeUp = false;
+				if(mLinearVelocities)
+				{
+					body.setLinearVelocity(mLinearVelocities[i]);
+					forceWakeUp = !mLinearVelocities[i].isZero();
+				}
+				if(mAngularVelocities)
+				{
+					body.setAngularVelocity(mAngularVelocities[i]);
+					forceWakeUp = forceWakeUp || !mAngularVelocities[i].isZero();
+				}
+
+				// PT: same wake up logic as the individual setters, see NpRigidDynamic::wakeUpInternalNoKinematicTest()
+				if(!(body.getFlags() & PxRigidBodyFlag::eKINEMATIC) && !(body.getActorFlags() & PxActorFlag::eDISABLE_SIMULATION))
+				{
+					PxReal wakeCounter = body.getWakeCounter();
+					bool needsWakingUp = body.isSleeping() && (mAutowake || forceWakeUp);
+					if(mAutowake && (wakeCounter < mWakeCounterResetValue))
+					{
+						wakeCounter = mWakeCounterResetValue;
+						needsWakingUp = true;
+					}
+
+					// A pose change must be notified before waking the body up with the regular code path
+					if(needsWakingUp && !body.wakeUpInternalIfAwake(wakeCounter))
+						followUp |= forceWakeUp ? eFOLLOW_UP_WAKE_UP|eFOLLOW_UP_FORCE_WAKE_UP : eFOLLOW_UP_WAKE_UP;
+				}
+				mFollowUps[i] = followUp;
+			}
+		}
+	private:
+		PxRigidDynamic*const*	mActors;
+		const PxTransform*		mGlobalPoses;
+		const PxVec3*			mLinearVelocities;
+		const PxVec3*			mAngularVelocities;
+		PxU8*					mFollowUps;
+		const PxReal			mWakeCounterResetValue;
+		const bool				mAutowake;
+	};
+}
+
+PxU32 NpScene::getActiveActorStates(PxTransform* globalPoses, PxVec3* linearVelocities, PxVec3* angularVelocities, void** userData, PxU32 bufferSize, PxU32 startIndex)
+{
+	PX_PROFILE_ZONE("API.getActiveActorStates", getContextId());
+	NP_READ_CHECK(this);
+
+	if(getSimulationStage() != Sc::SimulationStage::eCOMPLETE)
+	{
+		Ps::getFoundation().error(PxErrorCode::eDEBUG_WARNING, __FILE__, __LINE__, "PxScene::getActiveActorStates() not allowed while simulation is running. Call will be ignored.");
+		return 0;
+	}
+
+	PxU32 nbActiveActors;
+	PxActor** activeActors = mScene.getActiveActors(nbActiveActors);
+	if(startIndex>=nbActiveActors)
+		return 0;
+
+	const PxU32 nbActors = PxMin(bufferSize, nbActiveActors - startIndex);
+
+	ActiveActorStatesJob* job = PX_NEW(ActiveActorStatesJob)(activeActors + startIndex, nbActors, globalPoses, linearVelocities, angularVelocities, userData);
+	job->run(getCpuDispatcher());
+	job->releaseRef();
+
+	return nbActors;
+}
+
+bool NpScene::canWriteActorBatchInParallel() const
+{
+	// PT: the parallel part of bulk writes goes straight to the simulation controller objects, without buffering or PVD updates
+	if(mScene.isPhysicsBuffering() || mScene.getScScene().isUsingGpuRigidBodies())
+		return false;
+#if PX_SUPPORT_PVD
+	if(mScene.getScenePvdClient().isConnected())
+		return false;
+#endif
+	return true;
+}
+
+void NpScene::setKinematicTargets(PxRigidDynamic*const* actors, const PxTransform* targets, PxU32 nbActors)
+{
+	PX_PROFILE_ZONE("API.setKinematicTargets", getContextId());
+	NP_WRITE_CHECK(this);
+	PX_CHECK_AND_RETURN(!nbActors || (actors && targets), "PxScene::setKinematicTargets: actors and targets must not be NULL.");
+
+#if PX_CHECKED
+	for(PxU32 i=0;i<nbActors;i++)
+	{
+		const NpRigidDynamic* actor = static_cast<const NpRigidDynamic*>(actors[i]);
+		PX_CHECK_AND_RETURN(actor && NpActor::getOwnerScene(*actor)==this, "PxScene::setKinematicTargets: actors must be in this scene!");
+		PX_CHECK_AND_RETURN(targets[i].isSane(), "PxScene::setKinematicTargets: target is not valid.");
+		PX_CHECK_AND_RETURN((actor->getScbBodyFast().getFlags() & PxRigidBodyFlag::eKINEMATIC), "PxScene::setKinematicTargets: Body must be kinematic!");
+		PX_CHECK_AND_RETURN(!(actor->getScbBodyFast().getActorFlags() & PxActorFlag::eDISABLE_SIMULATION), "PxScene::setKinematicTargets: Not allowed if PxActorFlag::eDISABLE_SIMULATION is set!");
+		checkPositionSanity(*actor, targets[i], "PxScene::setKinematicTargets");
+	}
+#endif
+
+	Ps::Array<PxU8> followUps;
+	followUps.resizeUninitialized(nbActors);
+	if(canWriteActorBatchInParallel())
+	{
+		KinematicTargetsJob* job = PX_NEW(KinematicTargetsJob)(actors, targets, nbActors, getWakeCounterResetValueInteral(), followUps.begin());
+		job->run(getCpuDispatcher());
+		job->releaseRef();
+	}
+	else
+		PxMemSet(followUps.begin(), eFOLLOW_UP_SET_TARGET|eFOLLOW_UP_UPDATE_SQ, nbActors);
+
+	for(PxU32 i=0;i<nbActors;i++)
+	{
+		const PxU8 followUp = followUps[i];
+		if(!followUp)
+			continue;
+
+		NpRigidDynamic* actor = static_cast<NpRigidDynamic*>(actors[i]);
+		Scb::Body& body = actor->getScbBodyFast();
+		if(followUp & eFOLLOW_UP_SET_TARGET)
+			body.setKinematicTarget(targets[i].getNormalized() * body.getBody2Actor());
+		if((followUp & eFOLLOW_UP_UPDATE_SQ) && (body.getFlags() & PxRigidBodyFlag::eUSE_KINEMATIC_TARGET_FOR_SCENE_QUERIES))
+			updateDynamicSceneQueryShapes(actor->getShapeManager(), mSQManager, *actor);
+	}
+}
+
+void NpScene::setRigidDynamicStates(PxRigidDynamic*const* actors, const PxTransform* globalPoses, const PxVec3* linearVelocities, const PxVec3* angularVelocities, PxU32 nbActors, bool autowake)
+{
+	PX_PROFILE_ZONE("API.setRigidDynamicStates", getContextId());
+	NP_WRITE_CHECK(this);
+	PX_CHECK_AND_RETURN(!nbActors || actors, "PxScene::setRigidDynamicStates: actors must not be NULL.");
+
+#if PX_CHECKED
+	for(PxU32 i=0;i<nbActors;i++)
+	{
+		const NpRigidDynamic* actor = static_cast<const NpRigidDynamic*>(actors[i]);
+		PX_CHECK_AND_RETURN(actor && NpActor::getOwnerScene(*actor)==this, "PxScene::setRigidDynamicStates: actors must be in this scene!");
+		if(globalPoses)
+		{
+			PX_CHECK_AND_RETURN(globalPoses[i].isSane(), "PxScene::setRigidDynamicStates: pose is not valid.");
+			checkPositionSanity(*actor, globalPoses[i], "PxScene::setRigidDynamicStates");
+		}
+		if(linearVelocities || angularVelocities)
+		{
+			PX_CHECK_AND_RETURN(!linearVelocities || linearVelocities[i].isFinite(), "PxScene::setRigidDynamicStates: linear velocity is not valid.");
+			PX_CHECK_AND_RETURN(!angularVelocities || angularVelocities[i].isFinite(), "PxScene::setRigidDynamicStates: angular velocity is not valid.");
+			PX_CHECK_AND_RETURN(!(actor->getScbBodyFast().getFlags() & PxRigidBodyFlag::eKINEMATIC), "PxScene::setRigidDynamicStates: velocities can only be set on non-kinematic bodies!");
+			PX_CHECK_AND_RETURN(!(actor->getScbBodyFast().getActorFlags() & PxActorFlag::eDISABLE_SIMULATION), "PxScene::setRigidDynamicStates: velocities cannot be set if PxActorFlag::eDISABLE_SIMULATION is set!");
+		}
+	}
+#endif
+
+	if(!canWriteActorBatchInParallel())
+	{
+		// PT: same as the individual setters
+		for(PxU32 i=0;i<nbActors;i++)
+		{
+			PxRigidDynamic* actor = actors[i];
+			if(globalPoses)
+				actor->setGlobalPose(globalPoses[i], autowake);
+			if(linearVelocities)
+				actor->setLinearVelocity(linearVelocities[i], autowake);
+			if(angularVelocities)
+				actor->setAngularVelocity(angularVelocities[i], autowake);
+		}
+		return;
+	}
+
+	Ps::Array<PxU8> followUps;
+	followUps.resizeUninitialized(nbActors);
+
+	RigidDynamicStatesJob* job = PX_NEW(RigidDynamicStatesJob)(actors, globalPoses, linearVelocities, angularVelocities, nbActors, autowake, getWakeCounterResetValueInteral(), followUps.begin());
+	job->run(getCpuDispatcher());
+	job->releaseRef();
+
+	for(PxU32 i=0;i<nbActors;i++)
+	{
+		const PxU8 followUp = followUps[i];
+		if(!followUp)
+			continue;
+
+		NpRigidDynamic* actor = static_cast<NpRigidDynamic*>(actors[i]);
+		Scb::Body& body = actor->getScbBodyFast();
+		if(followUp & eFOLLOW_UP_NOTIFY_POSE)
+		{
+			body.notifyBody2WorldChange();
+			updateDynamicSceneQueryShapes(actor->getShapeManager(), mSQManager, *actor);
+
+			// invalidate the pruning structure if the actor bounds changed
+			if(actor->getShapeManager().getPruningStructure())
+			{
+				Ps::getFoundation().error(PxErrorCode::eINVALID_OPERATION, __FILE__, __LINE__, "PxScene::setRigidDynamicStates: Actor is part of a pruning structure, pruning structure is now invalid!");
+				actor->getShapeManager().getPruningStructure()->invalidate(actor);
+			}
+		}
+		if(followUp & eFOLLOW_UP_WAKE_UP)
+			actor->wakeUpInternalNoKinematicTest(body, (followUp & eFOLLOW_UP_FORCE_WAKE_UP)!=0, autowake);
+	}
+}
+
 PxActor** NpScene::getFrozenActors(PxU32& nbActorsOut)
 {
 	NP_READ_CHECK(this);
@@ -1557,6 +1897,332 @@ void NpScene::getSimulationStatistics(PxSimulationStatistics& s) const
 	}
 }
 
+// 64-bit FNV-1a, hashing 32-bit words rather than bytes
+static PX_FORCE_INLINE PxU64 hashWords(PxU64 hash, const void* data, PxU32 nbWords)
+{
+	const PxU32* words = reinterpret_cast<const PxU32*>(data);
+	for(PxU32 i=0;i<nbWords;i++)
+		hash = (hash ^ words[i]) * PxU64(0x100000001b3);
+	return hash;
+}
+
+static PX_FORCE_INLINE PxU64 hashRigidBodyState(PxU64 hash, const PxRigidBody& body)
+{
+	const PxTransform pose = body.getGlobalPose();
+	const PxVec3 linVel = body.getLinearVelocity();
+	const PxVec3 angVel = body.getAngularVelocity();
+	hash = hashWords(hash, &pose, sizeof(PxTransform)/sizeof(PxU32));
+	hash = hashWords(hash, &linVel, sizeof(PxVec3)/sizeof(PxU32));
+	hash = hashWords(hash, &angVel, sizeof(PxVec3)/sizeof(PxU32));
+	return hash;
+}
+
+PxU64 NpScene::getSimulationStateChecksum() const
+{
+	NP_READ_CHECK(this);
+
+	if(getSimulationStage() != Sc::SimulationStage::eCOMPLETE)
+	{
+		Ps::getFoundation().error(PxErrorCode::eDEBUG_WARNING, __FILE__, __LINE__, "PxScene::getSimulationStateChecksum() not allowed while simulation is running. Call will be ignored.");
+		return 0;
+	}
+
+	PxU64 hash = PxU64(0xcbf29ce484222325);
+
+	const PxU32 nbRigidActors = mRigidActors.size();
+	for(PxU32 i=0;i<nbRigidActors;i++)
+	{
+		const PxRigidActor* actor = mRigidActors[i];
+		if(actor->getConcreteType() == PxConcreteType::eRIGID_DYNAMIC)
+			hash = hashRigidBodyState(hash, *static_cast<const PxRigidDynamic*>(actor));
+	}
+
+	PxArticulationBase* const* articulations = mArticulations.getEntries();
+	const PxU32 nbArticulations = mArticulations.size();
+	for(PxU32 i=0;i<nbArticulations;i++)
+	{
+		const PxArticulationBase& articulation = *articulations[i];
+		PxArticulationLink* links[64];
+		const PxU32 nbLinks = articulation.getNbLinks();
+		for(PxU32 start=0;start<nbLinks;start+=64)
+		{
+			const PxU32 nb = articulation.getLinks(links, 64, start);
+			for(PxU32 j=0;j<nb;j++)
+				hash = hashRigidBodyState(hash, *links[j]);
+		}
+	}
+	return hash;
+}
+
+// Simulation state snapshots: a header, the state of every rigid dynamic actor in mRigidActors order, then the contact
+// state of the Sc scene. A delta snapshot replaces the body array with a bitmap of changed bodies and their states.
+namespace
+{
+	const PxU32 SIMULATION_STATE_MAGIC		= PxU32('P') | (PxU32('X') << 8) | (PxU32('S') << 16) | (PxU32('S') << 24);
+	const PxU32 SIMULATION_STATE_VERSION	= 2;
+
+	struct SimulationStateHeader
+	{
+		PxU32	mMagic;
+		PxU32	mVersion;
+		PxU32	mSize;
+		PxU32	mIsDelta;
+		PxU64	mActorsHash;		// identifies the set and order of rigid dynamic actors
+		PxU64	mBodyDataHash;		// identifies a full state to save deltas against
+		PxU32	mNbBodies;
+		PxU32	mBodyDataSize;
+		PxU32	mContactDataSize;
+		PxU32	mPad;
+	};
+	PX_COMPILE_TIME_ASSERT((sizeof(SimulationStateHeader) & 15) == 0);
+
+	// PT: no padding bytes, so that states can be compared bitwise
+	struct BodyState
+	{
+		PxTransform					mBody2World;
+		PxVec3						mLinearVelocity;
+		PxVec3						mAngularVelocity;
+		PxReal						mWakeCounter;
+		PxU32						mIsSleeping;
+		Sc::SleepFilterState		mSleepFilter;
+	};
+
+	PX_COMPILE_TIME_ASSERT((sizeof(BodyState) & 3) == 0);
+
+	PX_FORCE_INLINE bool isSameBodyState(const BodyState& a, const BodyState& b)
+	{
+		const PxU32* wordsA = reinterpret_cast<const PxU32*>(&a);
+		const PxU32* wordsB = reinterpret_cast<const PxU32*>(&b);
+		for(PxU32 i=0;i<sizeof(BodyState)/sizeof(PxU32);i++)
+		{
+			if(wordsA[i] != wordsB[i])
+				return false;
+		}
+		return true;
+	}
+
+	PX_FORCE_INLINE PxU32 getBodyDataSize(PxU32 nbBodies, bool isDelta)
+	{
+		const PxU32 bitmapSize = isDelta ? ((nbBodies + 31) >> 5) * sizeof(PxU32) : 0;
+		return (bitmapSize + nbBodies * sizeof(BodyState) + 15) & ~15;
+	}
+}
+
+void NpScene::getDynamicActorsForState(Ps::Array<NpRigidDynamic*>& bodies, PxU64& actorsHash) const
+{
+	actorsHash = PxU64(0xcbf29ce484222325);
+
+	const PxU32 nbRigidActors = mRigidActors.size();
+	for(PxU32 i=0;i<nbRigidActors;i++)
+	{
+		PxRigidActor* actor = mRigidActors[i];
+		if(actor->getConcreteType() == PxConcreteType::eRIGID_DYNAMIC)
+		{
+			bodies.pushBack(static_cast<NpRigidDynamic*>(actor));
+			actorsHash = hashWords(actorsHash, &actor, sizeof(PxRigidActor*)/sizeof(PxU32));
+		}
+	}
+}
+
+// Contact data of a full state, which delta states are saved against
+static const PxU8* getBaseContactData(const void* baseState)
+{
+	if(!baseState)
+		return NULL;
+	const SimulationStateHeader* header = reinterpret_cast<const SimulationStateHeader*>(baseState);
+	return reinterpret_cast<const PxU8*>(baseState) + sizeof(SimulationStateHeader) + header->mBodyDataSize;
+}
+
+static bool isValidBaseState(const void* baseState, PxU32 nbBodies, PxU64 actorsHash)
+{
+	const SimulationStateHeader* header = reinterpret_cast<const SimulationStateHeader*>(baseState);
+	return header->mMagic == SIMULATION_STATE_MAGIC && header->mVersion == SIMULATION_STATE_VERSION && !header->mIsDelta
+		&& header->mNbBodies == nbBodies && header->mActorsHash == actorsHash;
+}
+
+PxU32 NpScene::getSimulationStateSize(const void* baseState) const
+{
+	NP_READ_CHECK(this);
+
+	PxU32 nbBodies = 0;
+	for(PxU32 i=0;i<mRigidActors.size();i++)
+		nbBodies += mRigidActors[i]->getConcreteType() == PxConcreteType::eRIGID_DYNAMIC ? 1 : 0;
+
+	return sizeof(SimulationStateHeader) + getBodyDataSize(nbBodies, baseState!=NULL) + mScene.getScScene().getContactStateSize(getBaseContactData(baseState));
+}
+
+PxU32 NpScene::saveSimulationState(void* buffer, PxU32 bufferSize, const void* baseState) const
+{
+	PX_PROFILE_ZONE("API.saveSimulationState", getContextId());
+	NP_READ_CHECK(this);
+	PX_CHECK_AND_RETURN_VAL(buffer && !(size_t(buffer) & 15), "PxScene::saveSimulationState: buffer must be 16-byte aligned.", 0);
+	PX_CHECK_AND_RETURN_VAL(!baseState || !(size_t(baseState) & 15), "PxScene::saveSimulationState: baseState must be 16-byte aligned.", 0);
+
+	if(getSimulationStage() != Sc::SimulationStage::eCOMPLETE)
+	{
+		Ps::getFoundation().error(PxErrorCode::eDEBUG_WARNING, __FILE__, __LINE__, "PxScene::saveSimulationState() not allowed while simulation is running. Call will be ignored.");
+		return 0;
+	}
+
+	Ps::Array<NpRigidDynamic*> bodies;
+	PxU64 actorsHash;
+	getDynamicActorsForState(bodies, actorsHash);
+	const PxU32 nbBodies = bodies.size();
+
+	if(baseState && !isValidBaseState(baseState, nbBodies, actorsHash))
+	{
+		Ps::getFoundation().error(PxErrorCode::eINVALID_PARAMETER, __FILE__, __LINE__, "PxScene::saveSimulationState: baseState is not a full simulation state of this scene.");
+		return 0;
+	}
+
+	const Sc::Scene& scScene = mScene.getScScene();
+	const PxU32 bodyDataSize = getBodyDataSize(nbBodies, baseState!=NULL);
+	const PxU8* baseContactData = getBaseContactData(baseState);
+	const PxU32 contactDataSize = scScene.getContactStateSize(baseContactData);
+	if(bufferSize < sizeof(SimulationStateHeader) + bodyDataSize + contactDataSize)
+	{
+		Ps::getFoundation().error(PxErrorCode::eINVALID_PARAMETER, __FILE__, __LINE__, "PxScene::saveSimulationState: buffer is too small, see PxScene::getSimulationStateSize().");
+		return 0;
+	}
+
+	PxU8* bodyData = reinterpret_cast<PxU8*>(buffer) + sizeof(SimulationStateHeader);
+	PxU32* bitmap = NULL;
+	BodyState* states = reinterpret_cast<BodyState*>(bodyData);
+	const BodyState* baseStates = NULL;
+	if(baseState)
+	{
+		bitmap = reinterpret_cast<PxU32*>(bodyData);
+		PxMemZero(bitmap, ((nbBodies + 31) >> 5) * sizeof(PxU32));
+		states = reinterpret_cast<BodyState*>(bitmap + ((nbBodies + 31) >> 5));
+		baseStates = reinterpret_cast<const BodyState*>(reinterpret_cast<const PxU8*>(baseState) + sizeof(SimulationStateHeader));
+	}
+
+	PxU32 nbStates = 0;
+	for(PxU32 i=0;i<nbBodies;i++)
+	{
+		const Scb::Body& body = bodies[i]->getScbBodyFast();
+		BodyState& state = states[nbStates];
+		state.mBody2World		= body.getBody2World();
+		state.mLinearVelocity	= body.getLinearVelocity();
+		state.mAngularVelocity	= body.getAngularVelocity();
+		state.mWakeCounter		= body.getWakeCounter();
+		state.mIsSleeping		= body.isSleeping() ? 1u : 0u;
+		body.getScBody().getSleepFilterState(state.mSleepFilter);
+
+		if(!baseStates)
+			nbStates++;
+		else if(!isSameBodyState(state, baseStates[i]))
+		{
+			bitmap[i>>5] |= 1u << (i & 31);
+			nbStates++;
+		}
+	}
+
+	const PxU32 usedBodyDataSize = (PxU32(reinterpret_cast<PxU8*>(states + nbStates) - bodyData) + 15) & ~15;
+	PxU8* contactData = bodyData + usedBodyDataSize;
+	const PxU32 savedContactDataSize = scScene.saveContactState(contactData, baseContactData);
+	PX_ASSERT(savedContactDataSize <= contactDataSize);
+
+	SimulationStateHeader* header = reinterpret_cast<SimulationStateHeader*>(buffer);
+	header->mMagic				= SIMULATION_STATE_MAGIC;
+	header->mVersion			= SIMULATION_STATE_VERSION;
+	header->mSize				= sizeof(SimulationStateHeader) + usedBodyDataSize + savedContactDataSize;
+	header->mIsDelta			= baseState ? 1u : 0u;
+	header->mActorsHash			= actorsHash;
+	header->mBodyDataHash		= baseState ? reinterpret_cast<const SimulationStateHeader*>(baseState)->mBodyDataHash : hashWords(PxU64(0xcbf29ce484222325), bodyData, usedBodyDataSize/sizeof(PxU32));
+	header->mNbBodies			= nbBodies;
+	header->mBodyDataSize		= usedBodyDataSize;
+	header->mContactDataSize	= savedContactDataSize;
+	header->mPad				= 0;
+	return header->mSize;
+}
+
+bool NpScene::restoreSimulationState(const void* state, const void* baseState)
+{
+	PX_PROFILE_ZONE("API.restoreSimulationState", getContextId());
+	NP_WRITE_CHECK(this);
+	PX_CHECK_AND_RETURN_VAL(state && !(size_t(state) & 15), "PxScene::restoreSimulationState: state must be 16-byte aligned.", false);
+	PX_CHECK_AND_RETURN_VAL(!baseState || !(size_t(baseState) & 15), "PxScene::restoreSimulationState: baseState must be 16-byte aligned.", false);
+
+	if(getSimulationStage() != Sc::SimulationStage::eCOMPLETE)
+	{
+		Ps::getFoundation().error(PxErrorCode::eDEBUG_WARNING, __FILE__, __LINE__, "PxScene::restoreSimulationState() not allowed while simulation is running. Call will be ignored.");
+		return false;
+	}
+
+	Ps::Array<NpRigidDynamic*> bodies;
+	PxU64 actorsHash;
+	getDynamicActorsForState(bodies, actorsHash);
+	const PxU32 nbBodies = bodies.size();
+
+	const SimulationStateHeader* header = reinterpret_cast<const SimulationStateHeader*>(state);
+	if(header->mMagic != SIMULATION_STATE_MAGIC || header->mVersion != SIMULATION_STATE_VERSION || header->mNbBodies != nbBodies || header->mActorsHash != actorsHash)
+	{
+		Ps::getFoundation().error(PxErrorCode::eINVALID_PARAMETER, __FILE__, __LINE__, "PxScene::restoreSimulationState: state does not match the rigid dynamic actors of the scene.");
+		return false;
+	}
+	if(header->mIsDelta && (!baseState || !isValidBaseState(baseState, nbBodies, actorsHash) || reinterpret_cast<const SimulationStateHeader*>(baseState)->mBodyDataHash != header->mBodyDataHash))
+	{
+		Ps::getFoundation().error(PxErrorCode::eINVALID_PARAMETER, __FILE__, __LINE__, "PxScene::restoreSimulationState: state is a delta and baseState is not the simulation state it was saved against.");
+		return false;
+	}
+
+	const PxU8* bodyData = reinterpret_cast<const PxU8*>(state) + sizeof(SimulationStateHeader);
+	const PxU8* contactData = bodyData + header->mBodyDataSize;
+	const PxU8* baseContactData = header->mIsDelta ? getBaseContactData(baseState) : NULL;
+	if(!mScene.getScScene().isValidContactState(contactData, baseContactData))
+	{
+		Ps::getFoundation().error(PxErrorCode::eINVALID_PARAMETER, __FILE__, __LINE__, "PxScene::restoreSimulationState: state does not match the shapes of the scene, shapes have been removed since it was saved.");
+		return false;
+	}
+
+	const PxU32* bitmap = NULL;
+	const BodyState* states = reinterpret_cast<const BodyState*>(bodyData);
+	const BodyState* baseStates = NULL;
+	if(header->mIsDelta)
+	{
+		bitmap = reinterpret_cast<const PxU32*>(bodyData);
+		states = reinterpret_cast<const BodyState*>(bitmap + ((nbBodies + 31) >> 5));
+		baseStates = reinterpret_cast<const BodyState*>(reinterpret_cast<const PxU8*>(baseState) + sizeof(SimulationStateHeader));
+	}
+
+	Sq::SceneQueryManager& sqManager = getSceneQueryManagerFast();
+	for(PxU32 i=0;i<nbBodies;i++)
+	{
+		const BodyState* bodyState;
+		if(!bitmap)
+			bodyState = states + i;
+		else if(bitmap[i>>5] & (1u << (i & 31)))
+			bodyState = states++;
+		else
+			bodyState = baseStates + i;
+
+		NpRigidDynamic& actor = *bodies[i];
+		Scb::Body& body = actor.getScbBodyFast();
+		body.setBody2World(bodyState->mBody2World, false);
+
+		if(!(body.getFlags() & PxRigidBodyFlag::eKINEMATIC) && !(body.getActorFlags() & PxActorFlag::eDISABLE_SIMULATION))
+		{
+			if(!bodyState->mIsSleeping)
+				body.wakeUpInternal(bodyState->mWakeCounter);
+			else if(!body.isSleeping())
+				body.putToSleepInternal();
+		}
+
+		// PT: after the wake up, which resets the sleep filters
+		body.setLinearVelocity(bodyState->mLinearVelocity);
+		body.setAngularVelocity(bodyState->mAngularVelocity);
+		body.getScBody().setSleepFilterState(bodyState->mSleepFilter);
+
+		updateDynamicSceneQueryShapes(actor.getShapeManager(), sqManager, actor);
+		if(actor.getShapeManager().getPruningStructure())
+			actor.getShapeManager().getPruningStructure()->invalidate(&actor);
+	}
+
+	mScene.getScScene().restoreContactState(contactData, baseContactData);
+	return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 //Multiclient 
@@ -1603,6 +2269,18 @@ PxSimulationEventCallback* NpScene::getSimulationEventCallback() const
 	return mScene.getSimulationEventCallback();
 }
 
+void NpScene::setContactReportRecords(PxContactReportRecords* records)
+{
+	NP_WRITE_CHECK(this);
+	mScene.setContactReportRecords(records);
+}
+
+PxContactReportRecords* NpScene::getContactReportRecords() const
+{
+	NP_READ_CHECK(this);
+	return mScene.getContactReportRecords();
+}
+
 void NpScene::setContactModifyCallback(PxContactModifyCallback* callback)
 {
 	NP_WRITE_CHECK(this);
@@ -1937,6 +2615,10 @@ void NpScene::simulateOrCollide(PxReal elapsedTime, physx::PxBaseTask* completio
 			mSceneCompletion.removeReference();
 			mSceneExecution.removeReference();
 		}
+
+		// PT: with a time budget, the dynamic trees are rebuilt during the simulation. The build is joined in fetchResults().
+		if(getSceneQueryUpdateModeFast() != PxSceneQueryUpdateMode::eBUILD_DISABLED_COMMIT_DISABLED)
+			mSQManager.startTimedBuild(mTaskManager->getCpuDispatcher());
 	}
 }
 
@@ -2078,6 +2760,28 @@ public:
 private:
 };
 
+namespace
+{
+	// Syncs the scene query bounds of the dynamic shapes. This is a single chunk of work since the pruner updates are not thread
+	// safe, the point is to run it next to the other fetchResults work.
+	class SqBoundsSyncJob : public Cm::ChunkedJob
+	{
+	public:
+		SqBoundsSyncJob(Sc::Scene& scene, Sc::SqBoundsSync& sync) : Cm::ChunkedJob(1, 1), mScene(scene), mSync(sync)	{}
+
+		virtual	void	process(PxU32, PxU32)
+		{
+			SqRefFinder sqRefFinder;
+			mScene.syncSceneQueryBounds(mSync, sqRefFinder);
+		}
+	private:
+		PX_NOCOPY(SqBoundsSyncJob)
+
+		Sc::Scene&			mScene;
+		Sc::SqBoundsSync&	mSync;
+	};
+}
+
 // The order of the following operations is important!
 // 1. Process object deletions which were carried out while the simulation was running (since these effect contact and trigger reports)
 // 2. Write contact reports to global stream (taking pending deletions into account), clear some simulation buffers (deleted objects etc.), ...
@@ -2109,8 +2813,27 @@ void NpScene::fetchResultsPostContactCallbacks()
 	mScene.postCallbacksPreSync();
 	mScene.syncEntireScene();	// double buffering
 
-	SqRefFinder sqRefFinder;
-	mScene.getScScene().syncSceneQueryBounds(mSQManager.getDynamicBoundsSync(), sqRefFinder);
+	// The scene query bounds and the lists of active actors are independent. The bounds are synced by a helper task while the
+	// lists are built, which is done before the post-sync callbacks for that reason.
+	const bool buildActiveActors = mScene.getFlags() & PxSceneFlag::eENABLE_ACTIVE_ACTORS;
+
+	SqBoundsSyncJob* sqBoundsSyncJob = PX_NEW(SqBoundsSyncJob)(mScene.getScScene(), mSQManager.getDynamicBoundsSync());
+	if(buildActiveActors)
+		sqBoundsSyncJob->start(getCpuDispatcher());
+
+	// build the list of active actors
+	if(buildActiveActors)
+	{
+		PX_PROFILE_ZONE("Sim.buildActiveActors", getContextId());
+
+		if(mBuildFrozenActors)
+			mScene.buildActiveAndFrozenActors();
+		else
+			mScene.buildActiveActors();
+	}
+
+	sqBoundsSyncJob->wait();
+	sqBoundsSyncJob->releaseRef();
 
 	mSQManager.updateCompoundActors(mScene.getScScene().getActiveCompoundBodiesArray(), mScene.getScScene().getNumActiveCompoundBodies());
 	mSQManager.afterSync(getSceneQueryUpdateModeFast());
@@ -2131,18 +2854,6 @@ void NpScene::fetchResultsPostContactCallbacks()
 
 	mScene.postReportsCleanup();
 
-	// build the list of active actors
-	{
-		PX_PROFILE_ZONE("Sim.buildActiveActors", getContextId());
-
-		const bool buildActiveActors = mScene.getFlags() & PxSceneFlag::eENABLE_ACTIVE_ACTORS;
-		
-		if (buildActiveActors && mBuildFrozenActors)
-			mScene.buildActiveAndFrozenActors();
-		else if (buildActiveActors)
-			mScene.buildActiveActors();
-	}
-
 	mRenderBuffer.append(mScene.getScScene().getRenderBuffer());
 
 	PX_ASSERT(getSimulationStage() != Sc::SimulationStage::eCOMPLETE);
@@ -2436,6 +3147,18 @@ PxU32 NpScene::getDynamicTreeRebuildRateHint() const
 	return mSQManager.getDynamicTreeRebuildRateHint();
 }
 
+void NpScene::setDynamicTreeRebuildTimeBudget(PxU32 budget)
+{
+	NP_WRITE_CHECK(this);
+	mSQManager.setDynamicTreeRebuildTimeBudget(budget);
+}
+
+PxU32 NpScene::getDynamicTreeRebuildTimeBudget() const
+{
+	NP_READ_CHECK(this);
+	return mSQManager.getDynamicTreeRebuildTimeBudget();
+}
+
 void NpScene::forceDynamicTreeRebuild(bool rebuildStaticStructure, bool rebuildDynamicStructure)
 {
 	PX_PROFILE_ZONE("API.forceDynamicTreeRebuild", getContextId());
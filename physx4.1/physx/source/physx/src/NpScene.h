@@ -145,9 +145,16 @@ class NpScene : public NpSceneQueries, public Ps::UserAllocated
 	virtual			PxU32							getNbActors(PxActorTypeFlags types) const;
 	virtual			PxU32							getActors(PxActorTypeFlags types, PxActor** buffer, PxU32 bufferSize, PxU32 startIndex=0) const;
 	virtual			PxActor**						getActiveActors(PxU32& nbActorsOut);
+	virtual			PxU32							getActiveActorStates(PxTransform* globalPoses, PxVec3* linearVelocities, PxVec3* angularVelocities, void** userData, PxU32 bufferSize, PxU32 startIndex=0);
+	virtual			void							setKinematicTargets(PxRigidDynamic*const* actors, const PxTransform* targets, PxU32 nbActors);
+	virtual			void							setRigidDynamicStates(PxRigidDynamic*const* actors, const PxTransform* globalPoses, const PxVec3* linearVelocities, const PxVec3* angularVelocities, PxU32 nbActors, bool autowake=true);
 
 	// Run
 	virtual			void							getSimulationStatistics(PxSimulationStatistics& s) const;
+	virtual			PxU64							getSimulationStateChecksum() const;
+	virtual			PxU32							getSimulationStateSize(const void* baseState) const;
+	virtual			PxU32							saveSimulationState(void* buffer, PxU32 bufferSize, const void* baseState) const;
+	virtual			bool							restoreSimulationState(const void* state, const void* baseState);
 
 	// Multiclient 
 	virtual			PxClientID						createClient();
@@ -159,6 +166,8 @@ class NpScene : public NpSceneQueries, public Ps::UserAllocated
 	// Callbacks
 	virtual			void							setSimulationEventCallback(PxSimulationEventCallback* callback);
 	virtual			PxSimulationEventCallback*		getSimulationEventCallback()	const;
+	virtual			void							setContactReportRecords(PxContactReportRecords* records);
+	virtual			PxContactReportRecords*			getContactReportRecords()	const;
 	virtual			void							setContactModifyCallback(PxContactModifyCallback* callback);
 	virtual			PxContactModifyCallback*		getContactModifyCallback()	const;
 	virtual			void							setCCDContactModifyCallback(PxCCDContactModifyCallback* callback);
@@ -205,6 +214,8 @@ class NpScene : public NpSceneQueries, public Ps::UserAllocated
 					void							releaseBatchQuery(PxBatchQuery* bq);
 	virtual			void							setDynamicTreeRebuildRateHint(PxU32 dynamicTreeRebuildRateHint);
 	virtual			PxU32							getDynamicTreeRebuildRateHint() const;
+	virtual			void							setDynamicTreeRebuildTimeBudget(PxU32 budget);
+	virtual			PxU32							getDynamicTreeRebuildTimeBudget() const;
 	virtual			void							forceDynamicTreeRebuild(bool rebuildStaticStructure, bool rebuildDynamicStructure);
 	virtual			void							sceneQueriesUpdate(physx::PxBaseTask* completionTask, bool controlSimulation);
 	virtual			bool							checkQueries(bool block);
@@ -363,6 +374,9 @@ private:
 					void							fetchResultsPreContactCallbacks();
 					void							fetchResultsPostContactCallbacks();
 
+					void							getDynamicActorsForState(Ps::Array<NpRigidDynamic*>& bodies, PxU64& actorsHash) const;
+					bool							canWriteActorBatchInParallel() const;
+
 					void							updateScbStateAndSetupSq(const PxRigidActor& rigidActor, Scb::Actor& actor, NpShapeManager& shapeManager, bool actorDynamic, const PxBounds3* bounds, bool hasPrunerStructure);
 	PX_FORCE_INLINE	void							updateScbStateAndSetupSq(const PxRigidActor& rigidActor, Scb::Body& body, NpShapeManager& shapeManager, bool actorDynamic, const PxBounds3* bounds, bool hasPrunerStructure);
 
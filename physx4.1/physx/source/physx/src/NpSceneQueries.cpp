@@ -36,6 +36,11 @@
 #include "GuIntersectionRayBox.h"
 #include "GuBounds.h"
 #include "GuIntersectionRay.h"
+#include "GuDistancePointTriangle.h"
+#include "GuBVHTestsSIMD.h"
+#include "GuMidphaseInterface.h"
+#include "geometry/PxMeshQuery.h"
+#include "geometry/PxTriangle.h"
 
 // Synchronous scene queries
 
@@ -92,6 +97,69 @@ bool NpSceneQueries::raycast(
 	return multiQuery<PxRaycastHit>(input, hits, hitFlags, cache, filterData, filterCall, NULL);
 }
 
+//////////////////////////////////////////////////////////////////////////
+// PT: rays are only traversed together when their directions are within a cone. Otherwise the packet goes down the union of
+// the rays' paths, which is slower than raycasting the rays one by one. Invalid rays also go through the regular path, which
+// reports the errors.
+static bool canRaycastPacket(PxU32 nbRays, const PxVec3* origins, const PxVec3* unitDirs, const PxReal* distances)
+{
+	const PxReal minCosAngle = 0.9f;
+
+	PxVec3 sumDirs(0.0f);
+	for(PxU32 i=0; i<nbRays; i++)
+	{
+		if(!origins[i].isFinite() || !unitDirs[i].isFinite() || !unitDirs[i].isNormalized() || !(distances[i] > 0.0f))
+			return false;
+		sumDirs += unitDirs[i];
+	}
+
+	const PxReal sumLength = sumDirs.magnitude();
+	for(PxU32 i=0; i<nbRays; i++)
+	{
+		if(unitDirs[i].dot(sumDirs) < minCosAngle * sumLength)
+			return false;
+	}
+	return sumLength > 0.0f;
+}
+
+PxU32 NpSceneQueries::raycastPacket(
+	PxU32 nbRays, const PxVec3* origins, const PxVec3* unitDirs, const PxReal* distances,
+	PxRaycastBuffer* hitBuffers, PxHitFlags hitFlags, const PxQueryFilterData& filterData, PxQueryFilterCallback* filterCall) const
+{
+	PX_PROFILE_ZONE("SceneQuery.raycastPacket", getContextId());
+	NP_READ_CHECK(this);
+	PX_SIMD_GUARD;
+	PX_CHECK_AND_RETURN_VAL(!nbRays || (origins && unitDirs && distances && hitBuffers), "PxScene::raycastPacket(): NULL ray or hit buffer array.", 0);
+
+#if PX_SUPPORT_PVD
+	// PT: PVD records the queries one by one
+	const Vd::ScbScenePvdClient& pvdClient = getScene().getScenePvdClient();
+	const bool recordQueries = pvdClient.checkPvdDebugFlag() && (pvdClient.getScenePvdFlagsFast() & PxPvdSceneFlag::eTRANSMIT_SCENEQUERIES);
+#else
+	const bool recordQueries = false;
+#endif
+
+	PxU32 nbRaysWithHits = 0;
+	for(PxU32 offset=0; offset<nbRays; offset+=SQ_MAX_RAY_PACKET_SIZE)
+	{
+		const PxU32 nbPacketRays = PxMin(nbRays - offset, SQ_MAX_RAY_PACKET_SIZE);
+		if(nbPacketRays>1 && !recordQueries && canRaycastPacket(nbPacketRays, origins + offset, unitDirs + offset, distances + offset))
+		{
+			nbRaysWithHits += multiQueryRaycastPacket(nbPacketRays, origins + offset, unitDirs + offset, distances + offset, hitBuffers + offset, hitFlags, filterData, filterCall);
+		}
+		else
+		{
+			for(PxU32 i=offset; i<offset+nbPacketRays; i++)
+			{
+				MultiQueryInput input(origins[i], unitDirs[i], distances[i]);
+				if(multiQuery<PxRaycastHit>(input, hitBuffers[i], hitFlags, NULL, filterData, filterCall, NULL))
+					nbRaysWithHits++;
+			}
+		}
+	}
+	return nbRaysWithHits;
+}
+
 //////////////////////////////////////////////////////////////////////////
 bool NpSceneQueries::overlap(
 	const PxGeometry& geometry, const PxTransform& pose, PxOverlapCallback& hits,
@@ -381,32 +449,44 @@ struct MultiQueryCallback : public PrunerCallback
 	
 	virtual PxAgain invoke(PxReal& aDist, const PrunerPayload& aPayload)
 	{
-		const PxU32 tempCount = 1;
-		HitType tempBuf[tempCount];
-
 		// PT: TODO: do we need actorShape.actor/actorShape.shape immediately?
 		local::ActorShape actorShape;
 		local::populate(aPayload, actorShape);
 
-		const PxQueryFlags filterFlags = mFilterData.flags;
+		PxQueryHitType::Enum shapeHitType;
+		PxHitFlags filteredHitFlags;
+		if(!preFilter(actorShape, shapeHitType, filteredHitFlags))
+			return true; // skip this shape from reporting if prefilter said to do so
+
+		return processShape(aDist, actorShape, shapeHitType, filteredHitFlags);
+	}
 
+	// PT: runs the pre-filters for a shape. Returns false if the shape must be skipped.
+	PX_FORCE_INLINE bool preFilter(const local::ActorShape& actorShape, PxQueryHitType::Enum& shapeHitType, PxHitFlags& filteredHitFlags)
+	{
 		// for no filter callback, default to eTOUCH for MULTIPLE, eBLOCK otherwise
 		// also always treat as eBLOCK if currently tested shape is cached
 		// Using eRESERVED flag as a special condition to default to eTOUCH hits while only looking for a single blocking hit
 		// from a nested query (see other comments containing #LABEL1)
-		PxQueryHitType::Enum shapeHitType =
+		shapeHitType =
 			((mHitCall.maxNbTouches || (mFilterData.flags & PxQueryFlag::eRESERVED)) && !mIsCached)
 				? PxQueryHitType::eTOUCH
 				: PxQueryHitType::eBLOCK;
 
 		// apply pre-filter
-		PxHitFlags filteredHitFlags = mHitFlags;
+		filteredHitFlags = mHitFlags;
 		if(!mIsCached) // don't run filters on single item cache
-			if(!applyAllPreFiltersSQ(&actorShape, shapeHitType/*in&out*/, filterFlags, mFilterData, mFilterCall,
+			if(!applyAllPreFiltersSQ(&actorShape, shapeHitType/*in&out*/, mFilterData.flags, mFilterData, mFilterCall,
 					mBfd, filteredHitFlags/*, mHitCall.maxNbTouches*/))
-				return true; // skip this shape from reporting if prefilter said to do so
-		if(shapeHitType == PxQueryHitType::eNONE)
-			return true;
+				return false;
+		return shapeHitType != PxQueryHitType::eNONE;
+	}
+
+	// PT: computes the hits against a shape that passed the pre-filters, then reports them
+	PxAgain processShape(PxReal& aDist, const local::ActorShape& actorShape, PxQueryHitType::Enum shapeHitType, PxHitFlags filteredHitFlags)
+	{
+		const PxU32 tempCount = 1;
+		HitType tempBuf[tempCount];
 
 		PX_ASSERT(actorShape.actor && actorShape.shape);
 		const Scb::Shape* shape = actorShape.scbShape;
@@ -443,6 +523,14 @@ struct MultiQueryCallback : public PrunerCallback
 			filteredHitFlags | mMeshAnyHitFlags,
 			maxSubHits1, subHits1, mShrunkDistance, mQueryShapeBoundsValid ? &mQueryShapeBounds : NULL);
 
+		return processHits(aDist, actorShape, shapeHitType, filteredHitFlags, subHits1, nbSubHits);
+	}
+
+	// PT: reports the hits found against a shape that passed the pre-filters, running the post-filters
+	PxAgain processHits(PxReal& aDist, const local::ActorShape& actorShape, PxQueryHitType::Enum shapeHitType, PxHitFlags filteredHitFlags, HitType* subHits1, PxU32 nbSubHits)
+	{
+		const PxQueryFlags filterFlags = mFilterData.flags;
+
 		// ------------------------- iterate over geometry subhits -----------------------------------
 		for (PxU32 iSubHit = 0; iSubHit < nbSubHits; iSubHit++)
 		{
@@ -651,6 +739,11 @@ struct IssueCallbacksOnReturn
 	}
 
 	~IssueCallbacksOnReturn()
+	{
+		issueCallbacks(hits, again);
+	}
+
+	static void issueCallbacks(PxHitCallback<HitType>& hits, PxAgain again)
 	{
 		if(again)
 			// only issue processTouches if query wasn't stopped
@@ -828,6 +921,502 @@ bool NpSceneQueries::multiQuery(
 	}
 }
 
+//========================================================================================================================
+// PT: packet callback of multiQueryRaycastPacket(). The rays of a packet touching the same triangle mesh are raycast against
+// it together, i.e. its midphase is traversed once for all of them. Other shapes are processed one ray at a time.
+struct MultiQueryRaycastPacketCallback : public PrunerPacketCallback
+{
+	MultiQueryCallback<PxRaycastHit>*	mCallbacks;	// one per ray
+
+	MultiQueryRaycastPacketCallback(MultiQueryCallback<PxRaycastHit>* callbacks) : mCallbacks(callbacks)	{}
+
+	virtual PrunerCallback& getRayCallback(PxU32 rayIndex)
+	{
+		return mCallbacks[rayIndex];
+	}
+
+	virtual PxU32 invokePacket(PxU32 rayMask, PxReal* distances, const PrunerPayload& payload)
+	{
+		local::ActorShape actorShape;
+		local::populate(payload, actorShape);
+
+		PxU32 againRays = rayMask;
+		if(Ps::bitCount(rayMask)<2 || actorShape.scbShape->getGeometry().getType() != PxGeometryType::eTRIANGLEMESH)
+		{
+			for(PxU32 mask=rayMask; mask; mask &= mask - 1)
+			{
+				const PxU32 i = Ps::lowestSetBit(mask);
+				if(!mCallbacks[i].invoke(distances[i], payload))
+					againRays &= ~(1<<i);
+			}
+			return againRays;
+		}
+
+		// PT: the packet midphase only looks for the closest hit of each ray, with the same hit flags for all rays. Rays that
+		// need more than that after the pre-filters are processed one by one.
+		PxQueryHitType::Enum shapeHitTypes[SQ_MAX_RAY_PACKET_SIZE];
+		PxHitFlags packetHitFlags;
+		PxU32 packetRays = 0;
+		for(PxU32 mask=rayMask; mask; mask &= mask - 1)
+		{
+			const PxU32 i = Ps::lowestSetBit(mask);
+			MultiQueryCallback<PxRaycastHit>& pcb = mCallbacks[i];
+
+			PxHitFlags filteredHitFlags;
+			if(!pcb.preFilter(actorShape, shapeHitTypes[i], filteredHitFlags))
+				continue;
+
+			const PxHitFlags meshHitFlags = filteredHitFlags | pcb.mMeshAnyHitFlags;
+			if(!(meshHitFlags & (PxHitFlag::eMESH_MULTIPLE|PxHitFlag::eMESH_ANY)) && (!packetRays || filteredHitFlags == packetHitFlags))
+			{
+				packetHitFlags = filteredHitFlags;
+				packetRays |= 1<<i;
+			}
+			else if(!pcb.processShape(distances[i], actorShape, shapeHitTypes[i], filteredHitFlags))
+				againRays &= ~(1<<i);
+		}
+		if(!packetRays)
+			return againRays;
+
+		PX_ALIGN(16, PxTransform) globalPose;
+		NpActor::getGlobalPose(globalPose, *actorShape.scbShape, *actorShape.scbActor);
+		const PxTriangleMeshGeometry& meshGeom = static_cast<const PxTriangleMeshGeometry&>(actorShape.scbShape->getGeometry());
+
+		PxVec3 origins[SQ_MAX_RAY_PACKET_SIZE];
+		PxVec3 unitDirs[SQ_MAX_RAY_PACKET_SIZE];
+		PxReal maxDists[SQ_MAX_RAY_PACKET_SIZE];
+		PxU32 rayIndices[SQ_MAX_RAY_PACKET_SIZE];
+		PxU32 nbRays = 0;
+		for(PxU32 mask=packetRays; mask; mask &= mask - 1)
+		{
+			const PxU32 i = Ps::lowestSetBit(mask);
+			origins[nbRays] = mCallbacks[i].mInput.getOrigin();
+			unitDirs[nbRays] = mCallbacks[i].mInput.getDir();
+			maxDists[nbRays] = mCallbacks[i].mShrunkDistance;
+			rayIndices[nbRays++] = i;
+		}
+
+		PxRaycastHit hits[SQ_MAX_RAY_PACKET_SIZE];
+		const PxU32 hitMask = Midphase::raycastTriangleMeshPacket(static_cast<const TriangleMesh*>(meshGeom.triangleMesh), meshGeom, globalPose,
+			nbRays, origins, unitDirs, maxDists, packetHitFlags, hits);
+
+		for(PxU32 k=0; k<nbRays; k++)
+		{
+			const PxU32 i = rayIndices[k];
+			if(!mCallbacks[i].processHits(distances[i], actorShape, shapeHitTypes[i], packetHitFlags, hits + k, (hitMask>>k) & 1))
+				againRays &= ~(1<<i);
+		}
+		return againRays;
+	}
+
+private:
+	MultiQueryRaycastPacketCallback& operator=(const MultiQueryRaycastPacketCallback&);
+};
+
+PX_COMPILE_TIME_ASSERT(SQ_MAX_RAY_PACKET_SIZE<=GU_MIDPHASE_RAY_PACKET_MAX_SIZE);
+
+//========================================================================================================================
+// PT: same as multiQuery<PxRaycastHit>() without cache, for a coherent packet of rays going through the pruners together
+PxU32 NpSceneQueries::multiQueryRaycastPacket(
+	PxU32 nbRays, const PxVec3* origins, const PxVec3* unitDirs, const PxReal* distances,
+	PxRaycastBuffer* hitBuffers, PxHitFlags hitFlags, const PxQueryFilterData& filterData, PxQueryFilterCallback* filterCall) const
+{
+	PX_ASSERT(nbRays && nbRays<=SQ_MAX_RAY_PACKET_SIZE);
+
+	const bool anyHit = (filterData.flags & PxQueryFlag::eANY_HIT) == PxQueryFlag::eANY_HIT;
+
+	const_cast<NpSceneQueries*>(this)->mSQManager.flushUpdates();
+
+	// PT: the per-ray query objects have no default constructor, so they are constructed in place
+	PX_ALIGN(16, PxU8) inputBuffer[sizeof(MultiQueryInput)*SQ_MAX_RAY_PACKET_SIZE];
+	PX_ALIGN(16, PxU8) callbackBuffer[sizeof(MultiQueryCallback<PxRaycastHit>)*SQ_MAX_RAY_PACKET_SIZE];
+	MultiQueryInput* inputs = reinterpret_cast<MultiQueryInput*>(inputBuffer);
+	MultiQueryCallback<PxRaycastHit>* pcbs = reinterpret_cast<MultiQueryCallback<PxRaycastHit>*>(callbackBuffer);
+	PxReal shrunkDistances[SQ_MAX_RAY_PACKET_SIZE];
+
+	for(PxU32 i=0; i<nbRays; i++)
+	{
+		hitBuffers[i].hasBlock = false;
+		hitBuffers[i].nbTouches = 0;
+		PX_PLACEMENT_NEW(inputs + i, MultiQueryInput)(origins[i], unitDirs[i], distances[i]);
+		PX_PLACEMENT_NEW(pcbs + i, MultiQueryCallback<PxRaycastHit>)(*this, inputs[i], anyHit, hitBuffers[i], hitFlags, filterData, filterCall, distances[i], NULL);
+	}
+	MultiQueryRaycastPacketCallback packetCallback(pcbs);
+
+	const Pruner* staticPruner = mSQManager.get(PruningIndex::eSTATIC).pruner();
+	const Pruner* dynamicPruner = mSQManager.get(PruningIndex::eDYNAMIC).pruner();
+	const CompoundPruner* compoundPruner = mSQManager.getCompoundPruner().pruner();
+
+	const PxU32 doStatics = filterData.flags & PxQueryFlag::eSTATIC;
+	const PxU32 doDynamics = filterData.flags & PxQueryFlag::eDYNAMIC;
+
+	PxU32 activeRays = (1<<nbRays) - 1;
+	if(doStatics)
+	{
+		for(PxU32 i=0; i<nbRays; i++)
+			shrunkDistances[i] = pcbs[i].mShrunkDistance;
+		activeRays = staticPruner->raycastPacket(nbRays, origins, unitDirs, shrunkDistances, packetCallback, activeRays);
+	}
+
+	// PT: as in multiQuery(), the touch callbacks are still issued for rays stopped by the static pruner
+	const PxU32 stoppedByStatics = ~activeRays;
+
+	if(doDynamics && activeRays)
+	{
+		for(PxU32 i=0; i<nbRays; i++)
+			shrunkDistances[i] = pcbs[i].mShrunkDistance;
+		activeRays = dynamicPruner->raycastPacket(nbRays, origins, unitDirs, shrunkDistances, packetCallback, activeRays);
+	}
+
+	for(PxU32 i=0; i<nbRays; i++)
+	{
+		if((activeRays & (1<<i)) && !compoundPruner->raycast(origins[i], unitDirs[i], pcbs[i].mShrunkDistance, pcbs[i], filterData.flags))
+			activeRays &= ~(1<<i);
+	}
+
+	const PxU32 againRays = activeRays | stoppedByStatics;
+	PxU32 nbRaysWithHits = 0;
+	for(PxU32 i=0; i<nbRays; i++)
+	{
+		if(hitBuffers[i].hasAnyHits())
+			nbRaysWithHits++;
+		IssueCallbacksOnReturn<PxRaycastHit>::issueCallbacks(hitBuffers[i], (againRays & (1<<i)) != 0);
+		pcbs[i].~MultiQueryCallback<PxRaycastHit>();
+		inputs[i].~MultiQueryInput();
+	}
+	return nbRaysWithHits;
+}
+
+//========================================================================================================================
+// PT: closest shapes query. The pruners visit the shapes by increasing distance of their bounds, and the callback computes
+// exact distances. It keeps the hits sorted by distance, and once the hit buffer is full the search distance shrinks to the
+// distance of the farthest kept hit, which culls the rest of the pruners' trees.
+
+static PX_FORCE_INLINE PxU32 findOverlapTriangles(const PxGeometry& geom, const PxTransform& geomPose, const PxTriangleMeshGeometry& meshGeom, const PxTransform& meshPose, PxU32* results, PxU32 maxResults, PxU32 startIndex, bool& overflow)
+{
+	return PxMeshQuery::findOverlapTriangleMesh(geom, geomPose, meshGeom, meshPose, results, maxResults, startIndex, overflow);
+}
+
+static PX_FORCE_INLINE PxU32 findOverlapTriangles(const PxGeometry& geom, const PxTransform& geomPose, const PxHeightFieldGeometry& hfGeom, const PxTransform& hfPose, PxU32* results, PxU32 maxResults, PxU32 startIndex, bool& overflow)
+{
+	return PxMeshQuery::findOverlapHeightField(geom, geomPose, hfGeom, hfPose, results, maxResults, startIndex, overflow);
+}
+
+// PT: finds the closest triangle among the ones touching the search sphere. When there are too many of them for the results
+// buffer, the query restarts with a sphere shrunk to the closest triangle found so far if that's significantly smaller.
+template<typename MeshGeometry>
+static bool computeClosestPointMesh(const PxVec3& point, PxReal maxDistance, const MeshGeometry& meshGeom, const PxTransform& pose, PxClosestHit& hit)
+{
+	const PxU32 maxNbTris = 256;
+	PxU32 triIndices[maxNbTris];
+
+	const PxTransform spherePose(point);
+	PxReal radius = maxDistance;
+	PxReal bestSqDist = maxDistance*maxDistance;
+	bool found = false;
+	PxU32 startIndex = 0;
+	for(;;)
+	{
+		// PT: the overlap code needs a valid sphere, the results are checked against the exact search distance anyway
+		const PxSphereGeometry sphere(PxMax(radius, 1e-6f));
+		bool overflow = false;
+		const PxU32 nbTris = findOverlapTriangles(sphere, spherePose, meshGeom, pose, triIndices, maxNbTris, startIndex, overflow);
+		for(PxU32 i=0; i<nbTris; i++)
+		{
+			PxTriangle tri;
+			PxMeshQuery::getTriangle(meshGeom, pose, triIndices[i], tri);
+
+			float s, t;
+			const PxVec3 cp = closestPtPointTriangle(point, tri.verts[0], tri.verts[1], tri.verts[2], s, t);
+			const PxReal sqDist = (cp - point).magnitudeSquared();
+			if(sqDist <= bestSqDist)
+			{
+				bestSqDist = sqDist;
+				hit.position = cp;
+				hit.faceIndex = triIndices[i];
+				found = true;
+			}
+		}
+		if(!overflow)
+			break;
+
+		const PxReal bestDist = PxSqrt(bestSqDist);
+		if(bestDist < radius*0.5f)
+		{
+			radius = bestDist;
+			startIndex = 0;
+		}
+		else
+			startIndex += nbTris;
+	}
+
+	if(found)
+		hit.distance = PxSqrt(bestSqDist);
+	return found;
+}
+
+// PT: computes the closest point and exact distance, returns false if the shape is farther than maxDistance
+static bool computeClosestPoint(const PxVec3& point, PxReal maxDistance, const PxGeometry& geom, const PxTransform& pose, PxClosestHit& hit)
+{
+	hit.flags = PxHitFlag::ePOSITION;
+	switch(geom.getType())
+	{
+		case PxGeometryType::eSPHERE:
+		case PxGeometryType::eCAPSULE:
+		case PxGeometryType::eBOX:
+		case PxGeometryType::eCONVEXMESH:
+		{
+			// PT: analytic for sphere/capsule/box, GJK for convexes. Returns 0 without a closest point when the point is inside.
+			PxVec3 closestPoint;
+			const PxReal sqDist = PxGeometryQuery::pointDistance(point, geom, pose, &closestPoint);
+			if(sqDist > maxDistance*maxDistance)
+				return false;
+			hit.position = sqDist!=0.0f ? closestPoint : point;
+			hit.distance = PxSqrt(sqDist);
+		}
+		break;
+		case PxGeometryType::ePLANE:
+		{
+			// PT: planes are the negative half-space of their local x axis
+			const PxVec3 normal = pose.q.getBasisVector0();
+			const PxReal dist = PxMax(normal.dot(point - pose.p), 0.0f);
+			if(dist > maxDistance)
+				return false;
+			hit.position = point - normal * dist;
+			hit.distance = dist;
+		}
+		break;
+		case PxGeometryType::eTRIANGLEMESH:
+		{
+			if(!computeClosestPointMesh(point, maxDistance, static_cast<const PxTriangleMeshGeometry&>(geom), pose, hit))
+				return false;
+			hit.flags |= PxHitFlag::eFACE_INDEX;
+		}
+		break;
+		case PxGeometryType::eHEIGHTFIELD:
+		{
+			if(!computeClosestPointMesh(point, maxDistance, static_cast<const PxHeightFieldGeometry&>(geom), pose, hit))
+				return false;
+			hit.flags |= PxHitFlag::eFACE_INDEX;
+		}
+		break;
+		case PxGeometryType::eGEOMETRY_COUNT:
+		case PxGeometryType::eINVALID:
+			return false;
+	}
+
+	if(hit.distance > 0.0f)
+	{
+		hit.normal = (point - hit.position) / hit.distance;
+		hit.flags |= PxHitFlag::eNORMAL;
+	}
+	return true;
+}
+
+struct ClosestShapesCallback : public PrunerCallback
+{
+	const PxVec3				mPoint;
+	PxClosestHit*				mHits;
+	const PxU32					mMaxNbHits;
+	PxU32						mNbHits;
+	PxReal						mShrunkDistance;
+	const PxQueryFilterData&	mFilterData;
+	PxQueryFilterCallback*		mFilterCall;
+
+	ClosestShapesCallback(const PxVec3& point, PxReal maxDistance, PxClosestHit* hits, PxU32 maxNbHits, const PxQueryFilterData& filterData, PxQueryFilterCallback* filterCall) :
+		mPoint			(point),
+		mHits			(hits),
+		mMaxNbHits		(maxNbHits),
+		mNbHits			(0),
+		mShrunkDistance	(maxDistance),
+		mFilterData		(filterData),
+		mFilterCall		(filterCall)
+	{
+	}
+
+	virtual PxAgain invoke(PxReal& aDist, const PrunerPayload& aPayload)
+	{
+		local::ActorShape actorShape;
+		local::populate(aPayload, actorShape);
+
+		PxQueryHitType::Enum hitType = PxQueryHitType::eTOUCH;
+		PxHitFlags hitFlags = PxHitFlag::ePOSITION|PxHitFlag::eNORMAL|PxHitFlag::eFACE_INDEX;
+		if(!applyAllPreFiltersSQ(&actorShape, hitType, mFilterData.flags, mFilterData, mFilterCall, NULL, hitFlags) || hitType == PxQueryHitType::eNONE)
+			return true;
+
+		PX_ALIGN(16, PxTransform) globalPose;
+		NpActor::getGlobalPose(globalPose, *actorShape.scbShape, *actorShape.scbActor);
+
+		PxClosestHit hit;
+		if(!computeClosestPoint(mPoint, mShrunkDistance, actorShape.scbShape->getGeometry(), globalPose, hit))
+			return true;
+
+		// PT: once the buffer is full, a new hit has to be strictly closer than the farthest one, which it replaces
+		if(mNbHits == mMaxNbHits && hit.distance >= mShrunkDistance)
+			return true;
+
+		hit.actor = actorShape.actor;
+		hit.shape = actorShape.shape;
+
+		if(mFilterCall && (mFilterData.flags & PxQueryFlag::ePOSTFILTER) && mFilterCall->postFilter(mFilterData.data, hit) == PxQueryHitType::eNONE)
+			return true;
+
+		PxU32 i = mNbHits < mMaxNbHits ? mNbHits++ : mNbHits - 1;
+		while(i && mHits[i-1].distance > hit.distance)
+		{
+			mHits[i] = mHits[i-1];
+			i--;
+		}
+		mHits[i] = hit;
+
+		if(mNbHits == mMaxNbHits)
+		{
+			mShrunkDistance = mHits[mNbHits-1].distance;
+			aDist = mShrunkDistance;
+		}
+		return true;
+	}
+
+private:
+	ClosestShapesCallback& operator=(const ClosestShapesCallback&);
+};
+
+PxU32 NpSceneQueries::closestShapes(
+	const PxVec3& point, PxReal maxDistance, PxClosestHit* hits, PxU32 maxNbHits,
+	const PxQueryFilterData& filterData, PxQueryFilterCallback* filterCall) const
+{
+	PX_PROFILE_ZONE("SceneQuery.closestShapes", getContextId());
+	NP_READ_CHECK(this);
+	PX_SIMD_GUARD;
+	PX_CHECK_AND_RETURN_VAL(point.isFinite(), "PxScene::closestShapes(): point is not valid.", 0);
+	PX_CHECK_AND_RETURN_VAL(PxIsFinite(maxDistance) && maxDistance >= 0.0f, "PxScene::closestShapes(): maxDistance has to be in the [0, inf) range.", 0);
+	PX_CHECK_AND_RETURN_VAL(!maxNbHits || hits, "PxScene::closestShapes(): NULL hit buffer.", 0);
+
+	if(!maxNbHits)
+		return 0;
+
+	const_cast<NpSceneQueries*>(this)->mSQManager.flushUpdates();
+
+	ClosestShapesCallback pcb(point, maxDistance, hits, maxNbHits, filterData, filterCall);
+
+	const Pruner* staticPruner = mSQManager.get(PruningIndex::eSTATIC).pruner();
+	const Pruner* dynamicPruner = mSQManager.get(PruningIndex::eDYNAMIC).pruner();
+	const CompoundPruner* compoundPruner = mSQManager.getCompoundPruner().pruner();
+
+	if(filterData.flags & PxQueryFlag::eSTATIC)
+		staticPruner->closest(point, pcb.mShrunkDistance, pcb);
+
+	if(filterData.flags & PxQueryFlag::eDYNAMIC)
+		dynamicPruner->closest(point, pcb.mShrunkDistance, pcb);
+
+	// PT: compounds only support the regular queries, so we look for the shapes within the shrunk search distance
+	const ShapeData sd(PxSphereGeometry(pcb.mShrunkDistance), PxTransform(point), 0.0f);
+	compoundPruner->overlap(sd, pcb, filterData.flags);
+
+	return pcb.mNbHits;
+}
+
+struct CullShapesCallback : public PrunerCullCallback
+{
+	PxCullCallback&				mHitCall;
+	const PxQueryFilterData&	mFilterData;
+	PxQueryFilterCallback*		mFilterCall;
+	bool						mStopped;	// PT: processTouches returned false, the touches it received must not be reported again
+
+	CullShapesCallback(PxCullCallback& hitCall, const PxQueryFilterData& filterData, PxQueryFilterCallback* filterCall) :
+		mHitCall	(hitCall),
+		mFilterData	(filterData),
+		mFilterCall	(filterCall),
+		mStopped	(false)
+	{
+	}
+
+	virtual PxAgain invoke(const PrunerPayload& aPayload, bool inside)
+	{
+		local::ActorShape actorShape;
+		local::populate(aPayload, actorShape);
+
+		PxQueryHitType::Enum hitType = PxQueryHitType::eTOUCH;
+		PxHitFlags hitFlags = PxHitFlags(0);
+		if(!applyAllPreFiltersSQ(&actorShape, hitType, mFilterData.flags, mFilterData, mFilterCall, NULL, hitFlags) || hitType == PxQueryHitType::eNONE)
+			return true;
+
+		PxCullHit hit;
+		hit.actor = actorShape.actor;
+		hit.shape = actorShape.shape;
+		hit.inside = inside;
+
+		if(mFilterCall && (mFilterData.flags & PxQueryFlag::ePOSTFILTER) && mFilterCall->postFilter(mFilterData.data, hit) == PxQueryHitType::eNONE)
+			return true;
+
+		// PT: without a touch buffer, or with eANY_HIT, the first hit is reported as the blocking hit and stops the query
+		if(!mHitCall.maxNbTouches || (mFilterData.flags & PxQueryFlag::eANY_HIT))
+		{
+			mHitCall.block = hit;
+			mHitCall.hasBlock = true;
+			return false;
+		}
+
+		if(mHitCall.nbTouches == mHitCall.maxNbTouches)
+		{
+			if(!mHitCall.processTouches(mHitCall.touches, mHitCall.nbTouches))
+			{
+				mStopped = true;
+				return false;
+			}
+			mHitCall.nbTouches = 0;
+		}
+		mHitCall.touches[mHitCall.nbTouches++] = hit;
+		return true;
+	}
+
+private:
+	CullShapesCallback& operator=(const CullShapesCallback&);
+};
+
+bool NpSceneQueries::cullShapes(
+	PxU32 nbPlanes, const PxPlane* planes, PxCullCallback& hits,
+	const PxQueryFilterData& filterData, PxQueryFilterCallback* filterCall) const
+{
+	PX_PROFILE_ZONE("SceneQuery.cullShapes", getContextId());
+	NP_READ_CHECK(this);
+	PX_SIMD_GUARD;
+	PX_CHECK_AND_RETURN_VAL(nbPlanes && nbPlanes<=GU_MAX_CULLING_PLANES, "PxScene::cullShapes(): the number of planes has to be between 1 and 32.", false);
+	PX_CHECK_AND_RETURN_VAL(planes, "PxScene::cullShapes(): NULL planes.", false);
+	PX_CHECK_AND_RETURN_VAL(!hits.maxNbTouches || hits.touches, "PxScene::cullShapes(): NULL touch buffer.", false);
+
+	const_cast<NpSceneQueries*>(this)->mSQManager.flushUpdates();
+
+	hits.hasBlock = false;
+	hits.nbTouches = 0;
+
+	const Gu::PlanesAABBTest test(nbPlanes, planes);
+	CullShapesCallback pcb(hits, filterData, filterCall);
+
+	const Pruner* staticPruner = mSQManager.get(PruningIndex::eSTATIC).pruner();
+	const Pruner* dynamicPruner = mSQManager.get(PruningIndex::eDYNAMIC).pruner();
+	const CompoundPruner* compoundPruner = mSQManager.getCompoundPruner().pruner();
+
+	PxAgain again = true;
+	if(filterData.flags & PxQueryFlag::eSTATIC)
+		again = staticPruner->cull(test, pcb);
+
+	if(again && (filterData.flags & PxQueryFlag::eDYNAMIC))
+		again = dynamicPruner->cull(test, pcb);
+
+	if(again)
+		compoundPruner->cull(test, pcb, filterData.flags);
+
+	const bool result = hits.hasAnyHits();
+
+	// PT: same as IssueCallbacksOnReturn, the remaining touches are reported unless the user stopped the query
+	if(!pcb.mStopped && hits.nbTouches && hits.processTouches(hits.touches, hits.nbTouches))
+		hits.nbTouches = 0;
+	hits.finalizeQuery();
+
+	return result;
+}
+
 void NpSceneQueries::sceneQueriesStaticPrunerUpdate(PxBaseTask* )
 {
 	PX_PROFILE_ZONE("SceneQuery.sceneQueriesStaticPrunerUpdate", getContextId());
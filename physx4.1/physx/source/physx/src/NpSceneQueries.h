@@ -152,6 +152,11 @@ public:
 														const PxQueryFilterData& filterData, PxQueryFilterCallback* filterCall,
 														BatchQueryFilterData* bqFd) const;
 
+					PxU32							multiQueryRaycastPacket(
+														PxU32 nbRays, const PxVec3* origins, const PxVec3* unitDirs, const PxReal* distances,
+														PxRaycastBuffer* hitBuffers, PxHitFlags hitFlags,
+														const PxQueryFilterData& filterData, PxQueryFilterCallback* filterCall) const;
+
 	// Synchronous scene queries
 	virtual			bool							raycast(
 														const PxVec3& origin, const PxVec3& unitDir, const PxReal distance,	// Ray data
@@ -159,6 +164,11 @@ public:
 														const PxQueryFilterData& filterData, PxQueryFilterCallback* filterCall,
 														const PxQueryCache* cache) const;
 
+	virtual			PxU32							raycastPacket(
+														PxU32 nbRays, const PxVec3* origins, const PxVec3* unitDirs, const PxReal* distances,	// Ray data
+														PxRaycastBuffer* hitBuffers, PxHitFlags hitFlags,
+														const PxQueryFilterData& filterData, PxQueryFilterCallback* filterCall) const;
+
 	virtual			bool							sweep(
 														const PxGeometry& geometry, const PxTransform& pose,	// GeomObject data
 														const PxVec3& unitDir, const PxReal distance,	// Ray data
@@ -171,6 +181,15 @@ public:
 														PxOverlapCallback& hitCall, 
 														const PxQueryFilterData& filterData, PxQueryFilterCallback* filterCall) const;
 
+	virtual			PxU32							closestShapes(
+														const PxVec3& point, PxReal maxDistance,
+														PxClosestHit* hits, PxU32 maxNbHits,
+														const PxQueryFilterData& filterData, PxQueryFilterCallback* filterCall) const;
+
+	virtual			bool							cullShapes(
+														PxU32 nbPlanes, const PxPlane* planes, PxCullCallback& hitCall,
+														const PxQueryFilterData& filterData, PxQueryFilterCallback* filterCall) const;
+
 	PX_FORCE_INLINE	PxU64							getContextId()				const	{ return PxU64(reinterpret_cast<size_t>(this)); }
 	PX_FORCE_INLINE	Scb::Scene&						getScene()							{ return mScene; }
 	PX_FORCE_INLINE	const Scb::Scene&				getScene()					const	{ return mScene; }
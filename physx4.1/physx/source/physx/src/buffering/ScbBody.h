@@ -253,6 +253,13 @@ public:
 	PX_INLINE		bool				getKinematicTarget(PxTransform& p) const;
 	PX_INLINE		void				setKinematicTarget(const PxTransform& p);
 
+	// Bulk updates, see PxScene::setKinematicTargets() and PxScene::setRigidDynamicStates(). Only for bodies of a scene that is
+	// not buffering, and without PVD updates. See the Sc::BodyCore counterparts.
+	PX_FORCE_INLINE	bool				setKinematicTargetIfAwake(const PxTransform& p, PxReal wakeCounter);
+	PX_FORCE_INLINE	bool				wakeUpInternalIfAwake(PxReal wakeCounter);
+	PX_FORCE_INLINE	void				setBody2WorldNoNotify(const PxTransform& p);
+	PX_FORCE_INLINE	void				notifyBody2WorldChange()	{ mBodyCore.notifyBody2WorldChange();	}
+
 	PX_FORCE_INLINE	void				onOriginShift(const PxVec3& shift);
 
 	//---------------------------------------------------------------------------------
@@ -690,6 +697,33 @@ PX_INLINE void Body::setKinematicTarget(const PxTransform& p)
 #endif
 }
 
+PX_FORCE_INLINE bool Body::setKinematicTargetIfAwake(const PxTransform& p, PxReal wakeCounter)
+{
+	PX_ASSERT(!isBuffering());
+	if(!mBodyCore.setKinematicTargetIfAwake(p, wakeCounter))
+		return false;
+
+	setBufferedParamsForAwake(wakeCounter);
+	return true;
+}
+
+PX_FORCE_INLINE bool Body::wakeUpInternalIfAwake(PxReal wakeCounter)
+{
+	PX_ASSERT(!isBuffering());
+	if(!mBodyCore.wakeUpIfAwake(wakeCounter))
+		return false;
+
+	setBufferedParamsForAwake(wakeCounter);
+	return true;
+}
+
+PX_FORCE_INLINE void Body::setBody2WorldNoNotify(const PxTransform& p)
+{
+	PX_ASSERT(!isBuffering());
+	mBufferedBody2World = p;
+	mBodyCore.setBody2WorldNoNotify(p);
+}
+
 PX_FORCE_INLINE	void Body::onOriginShift(const PxVec3& shift)
 {
 	mBufferedBody2World.p -= shift;
@@ -39,7 +39,9 @@
 #include "ScbAggregate.h"
 
 #include "PsFoundation.h"
+#include "PsIntrinsics.h"
 #include "PxArticulation.h"
+#include "CmChunkedJob.h"
 #include "common/PxProfileZone.h"
 
 namespace physx
@@ -895,6 +897,40 @@ void Scb::Scene::processSimUpdates(S*const * scObjects, PxU32 nbObjects)
 	}
 }
 
+namespace
+{
+	const PxU32 SYNC_BODIES_CHUNK_SIZE			= 1024;	// bodies per chunk of work
+	const PxU32 SYNC_BODIES_PARALLEL_THRESHOLD	= 4*SYNC_BODIES_CHUNK_SIZE;
+
+	// Copies the simulation results of active bodies to their buffered state. Bodies updated by the user are skipped, they get
+	// synced with their buffered changes later on. The others have no buffered data, so they can be processed in parallel.
+	class SyncActiveBodiesJob : public Cm::ChunkedJob
+	{
+	public:
+		SyncActiveBodiesJob(Sc::BodyCore*const* activeBodies, PxU32 nbActiveBodies) :
+			Cm::ChunkedJob	(nbActiveBodies, SYNC_BODIES_CHUNK_SIZE),
+			mActiveBodies	(activeBodies)
+		{
+		}
+
+		virtual	void	process(PxU32 start, PxU32 end)
+		{
+			Sc::BodyCore*const* PX_RESTRICT activeBodies = mActiveBodies;
+			for(PxU32 i=start;i<end;i++)
+			{
+				if(i+4<end)
+					Ps::prefetch(&Scb::Body::fromSc(*activeBodies[i+4]), sizeof(Scb::Body));
+
+				Scb::Body& bufferedBody = Scb::Body::fromSc(*activeBodies[i]);
+				if (!(bufferedBody.getControlFlags() & Scb::ControlFlag::eIS_UPDATED))  // Else the data will be synced further below
+					bufferedBody.syncState();
+			}
+		}
+	private:
+		Sc::BodyCore*const*	mActiveBodies;
+	};
+}
+
 #define ENABLE_PVD_ORIGINSHIFT_EVENT
 void Scb::Scene::shiftOrigin(const PxVec3& shift)
 { 
@@ -964,15 +1000,9 @@ void Scb::Scene::syncEntireScene()
 	// 1) Sync simulation changed data
 	{
 		PX_PROFILE_ZONE("SyncActiveBodies", getContextId());
-		Sc::BodyCore*const* activeBodies = mScene.getActiveBodiesArray();
-		PxU32 nbActiveBodies = mScene.getNumActiveBodies();
-		while(nbActiveBodies--)
-		{
-			Sc::BodyCore* bodyCore = *activeBodies++;
-			Scb::Body& bufferedBody = Scb::Body::fromSc(*bodyCore);
-			if (!(bufferedBody.getControlFlags() & ControlFlag::eIS_UPDATED))  // Else the data will be synced further below
-				bufferedBody.syncState();
-		}
+		SyncActiveBodiesJob* job = PX_NEW(SyncActiveBodiesJob)(mScene.getActiveBodiesArray(), mScene.getNumActiveBodies());
+		job->run(mScene.getTaskManager().getCpuDispatcher(), SYNC_BODIES_PARALLEL_THRESHOLD);
+		job->releaseRef();
 	}
 
 	// 2) Sync data of rigid dynamics which were put to sleep by the simulation
@@ -216,6 +216,8 @@ namespace Scb
 
 		PX_INLINE PxSimulationEventCallback*	getSimulationEventCallback() const;
 		PX_INLINE void						setSimulationEventCallback(PxSimulationEventCallback* callback);
+		PX_INLINE PxContactReportRecords*	getContactReportRecords() const;
+		PX_INLINE void						setContactReportRecords(PxContactReportRecords* records);
 		PX_INLINE PxContactModifyCallback*	getContactModifyCallback() const;
 		PX_INLINE void						setContactModifyCallback(PxContactModifyCallback* callback);
 		PX_INLINE PxCCDContactModifyCallback*	getCCDContactModifyCallback() const;
@@ -503,6 +505,19 @@ PX_INLINE void Scb::Scene::setSimulationEventCallback(PxSimulationEventCallback*
 		Ps::getFoundation().error(PxErrorCode::eDEBUG_WARNING, __FILE__, __LINE__, "PxScene::setSimulationEventCallback() not allowed while simulation is running. Call will be ignored.");
 }
 
+PX_INLINE PxContactReportRecords* Scb::Scene::getContactReportRecords() const
+{
+	return mScene.getContactReportRecords();
+}
+
+PX_INLINE void Scb::Scene::setContactReportRecords(PxContactReportRecords* records)
+{
+	if(!isPhysicsBuffering())
+		mScene.setContactReportRecords(records);
+	else
+		Ps::getFoundation().error(PxErrorCode::eDEBUG_WARNING, __FILE__, __LINE__, "PxScene::setContactReportRecords() not allowed while simulation is running. Call will be ignored.");
+}
+
 PX_INLINE PxContactModifyCallback* Scb::Scene::getContactModifyCallback() const
 {
 	return mScene.getContactModifyCallback();
@@ -0,0 +1,354 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#include "geometry/PxGeometryHelpers.h"
+#include "extensions/PxBatchQueryExt.h"
+#include "PxScene.h"
+
+#include "PsArray.h"
+#include "PsFoundation.h"
+#include "CmChunkedJob.h"
+
+using namespace physx;
+
+namespace
+{
+	const PxU32 BATCH_QUERY_CHUNK_SIZE			= 32;	// queries per chunk of work
+	const PxU32 BATCH_QUERY_PARALLEL_THRESHOLD	= 4*BATCH_QUERY_CHUNK_SIZE;
+
+	// PT: the ray itself is stored in separate arrays, so that runs of raycasts can be passed as-is to PxScene::raycastPacket()
+	struct RaycastQuery
+	{
+		PxQueryFilterData	mFilterData;
+		PxQueryCache		mCache;
+		PxHitFlags			mHitFlags;
+		bool				mHasCache;
+	};
+
+	struct SweepQuery
+	{
+		PxGeometryHolder	mGeometry;
+		PxTransform			mPose;
+		PxVec3				mDir;
+		PxReal				mDistance;
+		PxReal				mInflation;
+		PxQueryFilterData	mFilterData;
+		PxQueryCache		mCache;
+		PxHitFlags			mHitFlags;
+		bool				mHasCache;
+	};
+
+	struct OverlapQuery
+	{
+		PxGeometryHolder	mGeometry;
+		PxTransform			mPose;
+		PxQueryFilterData	mFilterData;
+	};
+
+	PX_FORCE_INLINE bool canShareRaycastPacket(const RaycastQuery& q0, const RaycastQuery& q1)
+	{
+		return !q1.mHasCache && q0.mHitFlags==q1.mHitFlags && q0.mFilterData.flags==q1.mFilterData.flags
+			&& q0.mFilterData.data.word0==q1.mFilterData.data.word0 && q0.mFilterData.data.word1==q1.mFilterData.data.word1
+			&& q0.mFilterData.data.word2==q1.mFilterData.data.word2 && q0.mFilterData.data.word3==q1.mFilterData.data.word3;
+	}
+
+	// Reserves a range of maxNbTouches hits in a touch buffer. Returns false if the buffer is full.
+	template<class HitType>
+	bool reserveTouches(Ps::Array<HitType>& touches, PxU32& nbUsedTouches, PxU32 maxNbTouches, HitType*& reserved)
+	{
+		if(maxNbTouches > touches.size() - nbUsedTouches)
+			return false;
+
+		reserved = maxNbTouches ? touches.begin() + nbUsedTouches : NULL;
+		nbUsedTouches += maxNbTouches;
+		return true;
+	}
+
+	class BatchQueryExt : public PxBatchQueryExt, public Ps::UserAllocated
+	{
+		PX_NOCOPY(BatchQueryExt)
+	public:
+									BatchQueryExt(PxScene& scene, PxQueryFilterCallback* filterCall,
+										PxU32 maxNbRaycasts, PxU32 maxNbRaycastTouches,
+										PxU32 maxNbSweeps, PxU32 maxNbSweepTouches,
+										PxU32 maxNbOverlaps, PxU32 maxNbOverlapTouches);
+		virtual						~BatchQueryExt()	{}
+
+		virtual	PxRaycastBuffer*	raycast(const PxVec3& origin, const PxVec3& unitDir, PxReal distance, PxU32 maxNbTouches,
+										PxHitFlags hitFlags, const PxQueryFilterData& filterData, const PxQueryCache* cache);
+		virtual	PxSweepBuffer*		sweep(const PxGeometry& geometry, const PxTransform& pose, const PxVec3& unitDir, PxReal distance,
+										PxU32 maxNbTouches, PxHitFlags hitFlags, const PxQueryFilterData& filterData, const PxQueryCache* cache,
+										PxReal inflation);
+		virtual	PxOverlapBuffer*	overlap(const PxGeometry& geometry, const PxTransform& pose, PxU32 maxNbTouches,
+										const PxQueryFilterData& filterData);
+		virtual	void				execute(PxCpuDispatcher* dispatcher);
+		virtual	void				reset();
+		virtual	void				release();
+
+				// Runs queries [start, end), raycasts first, then sweeps, then overlaps
+				void				runQueries(PxU32 start, PxU32 end);
+
+				PxScene&					mScene;
+				PxQueryFilterCallback*		mFilterCall;
+
+				// PT: the buffer arrays are reserved once and never grow, so that the buffers returned to users stay valid
+				Ps::Array<RaycastQuery>		mRaycasts;
+				Ps::Array<PxVec3>			mRayOrigins;
+				Ps::Array<PxVec3>			mRayDirs;
+				Ps::Array<PxReal>			mRayDistances;
+				Ps::Array<PxRaycastBuffer>	mRaycastBuffers;
+				Ps::Array<PxRaycastHit>		mRaycastTouches;
+				PxU32						mNbRaycastTouches;	// used part of mRaycastTouches
+
+				Ps::Array<SweepQuery>		mSweeps;
+				Ps::Array<PxSweepBuffer>	mSweepBuffers;
+				Ps::Array<PxSweepHit>		mSweepTouches;
+				PxU32						mNbSweepTouches;	// used part of mSweepTouches
+
+				Ps::Array<OverlapQuery>		mOverlaps;
+				Ps::Array<PxOverlapBuffer>	mOverlapBuffers;
+				Ps::Array<PxOverlapHit>		mOverlapTouches;
+				PxU32						mNbOverlapTouches;	// used part of mOverlapTouches
+	};
+
+	// Runs the recorded queries over the worker threads. Each query writes to its own buffer and touch range.
+	class BatchQueryJob : public Cm::ChunkedJob
+	{
+	public:
+		BatchQueryJob(BatchQueryExt& batch, PxU32 nbQueries) :
+			Cm::ChunkedJob	(nbQueries, BATCH_QUERY_CHUNK_SIZE),
+			mBatch			(batch)
+		{
+		}
+
+		virtual	void	process(PxU32 start, PxU32 end)
+		{
+			mBatch.runQueries(start, end);
+		}
+	private:
+		BatchQueryExt&	mBatch;
+	};
+}
+
+BatchQueryExt::BatchQueryExt(PxScene& scene, PxQueryFilterCallback* filterCall,
+	PxU32 maxNbRaycasts, PxU32 maxNbRaycastTouches,
+	PxU32 maxNbSweeps, PxU32 maxNbSweepTouches,
+	PxU32 maxNbOverlaps, PxU32 maxNbOverlapTouches) :
+	mScene				(scene),
+	mFilterCall			(filterCall),
+	mNbRaycastTouches	(0),
+	mNbSweepTouches		(0),
+	mNbOverlapTouches	(0)
+{
+	mRaycasts.reserve(maxNbRaycasts);
+	mRayOrigins.reserve(maxNbRaycasts);
+	mRayDirs.reserve(maxNbRaycasts);
+	mRayDistances.reserve(maxNbRaycasts);
+	mRaycastBuffers.reserve(maxNbRaycasts);
+	mRaycastTouches.resize(maxNbRaycastTouches);
+
+	mSweeps.reserve(maxNbSweeps);
+	mSweepBuffers.reserve(maxNbSweeps);
+	mSweepTouches.resize(maxNbSweepTouches);
+
+	mOverlaps.reserve(maxNbOverlaps);
+	mOverlapBuffers.reserve(maxNbOverlaps);
+	mOverlapTouches.resize(maxNbOverlapTouches);
+}
+
+PxRaycastBuffer* BatchQueryExt::raycast(const PxVec3& origin, const PxVec3& unitDir, PxReal distance, PxU32 maxNbTouches,
+	PxHitFlags hitFlags, const PxQueryFilterData& filterData, const PxQueryCache* cache)
+{
+	PxRaycastHit* touches;
+	if(mRaycasts.size()==mRaycasts.capacity() || !reserveTouches(mRaycastTouches, mNbRaycastTouches, maxNbTouches, touches))
+	{
+		Ps::getFoundation().error(PxErrorCode::eINVALID_OPERATION, __FILE__, __LINE__, "PxBatchQueryExt::raycast(): batch is full, query ignored.");
+		return NULL;
+	}
+
+	RaycastQuery& query = mRaycasts.insert();
+	query.mFilterData = filterData;
+	query.mHitFlags = hitFlags;
+	query.mHasCache = cache!=NULL;
+	if(cache)
+		query.mCache = *cache;
+
+	mRayOrigins.pushBack(origin);
+	mRayDirs.pushBack(unitDir);
+	mRayDistances.pushBack(distance);
+	mRaycastBuffers.pushBack(PxRaycastBuffer(touches, maxNbTouches));
+	return &mRaycastBuffers.back();
+}
+
+PxSweepBuffer* BatchQueryExt::sweep(const PxGeometry& geometry, const PxTransform& pose, const PxVec3& unitDir, PxReal distance,
+	PxU32 maxNbTouches, PxHitFlags hitFlags, const PxQueryFilterData& filterData, const PxQueryCache* cache, PxReal inflation)
+{
+	PxSweepHit* touches;
+	if(mSweeps.size()==mSweeps.capacity() || !reserveTouches(mSweepTouches, mNbSweepTouches, maxNbTouches, touches))
+	{
+		Ps::getFoundation().error(PxErrorCode::eINVALID_OPERATION, __FILE__, __LINE__, "PxBatchQueryExt::sweep(): batch is full, query ignored.");
+		return NULL;
+	}
+
+	SweepQuery& query = mSweeps.insert();
+	query.mGeometry.storeAny(geometry);
+	query.mPose = pose;
+	query.mDir = unitDir;
+	query.mDistance = distance;
+	query.mInflation = inflation;
+	query.mFilterData = filterData;
+	query.mHitFlags = hitFlags;
+	query.mHasCache = cache!=NULL;
+	if(cache)
+		query.mCache = *cache;
+
+	mSweepBuffers.pushBack(PxSweepBuffer(touches, maxNbTouches));
+	return &mSweepBuffers.back();
+}
+
+PxOverlapBuffer* BatchQueryExt::overlap(const PxGeometry& geometry, const PxTransform& pose, PxU32 maxNbTouches, const PxQueryFilterData& filterData)
+{
+	PxOverlapHit* touches;
+	if(mOverlaps.size()==mOverlaps.capacity() || !reserveTouches(mOverlapTouches, mNbOverlapTouches, maxNbTouches, touches))
+	{
+		Ps::getFoundation().error(PxErrorCode::eINVALID_OPERATION, __FILE__, __LINE__, "PxBatchQueryExt::overlap(): batch is full, query ignored.");
+		return NULL;
+	}
+
+	OverlapQuery& query = mOverlaps.insert();
+	query.mGeometry.storeAny(geometry);
+	query.mPose = pose;
+	query.mFilterData = filterData;
+
+	mOverlapBuffers.pushBack(PxOverlapBuffer(touches, maxNbTouches));
+	return &mOverlapBuffers.back();
+}
+
+void BatchQueryExt::runQueries(PxU32 start, PxU32 end)
+{
+	const PxU32 nbRaycasts = mRaycasts.size();
+	const PxU32 nbSweeps = mSweeps.size();
+
+	PxU32 i = start;
+
+	// PT: runs of raycasts that only differ by their rays are cast as packets. Incoherent runs are cast one ray at a time by
+	// raycastPacket() itself.
+	const PxU32 raycastEnd = PxMin(end, nbRaycasts);
+	while(i<raycastEnd)
+	{
+		const RaycastQuery& query = mRaycasts[i];
+		PxU32 nbRays = 1;
+		if(!query.mHasCache)
+		{
+			while(i+nbRays<raycastEnd && canShareRaycastPacket(query, mRaycasts[i+nbRays]))
+				nbRays++;
+		}
+
+		PxRaycastBuffer* buffers = mRaycastBuffers.begin() + i;
+		if(nbRays>1)
+			mScene.raycastPacket(nbRays, mRayOrigins.begin() + i, mRayDirs.begin() + i, mRayDistances.begin() + i, buffers, query.mHitFlags, query.mFilterData, mFilterCall);
+		else
+			mScene.raycast(mRayOrigins[i], mRayDirs[i], mRayDistances[i], *buffers, query.mHitFlags, query.mFilterData, mFilterCall, query.mHasCache ? &query.mCache : NULL);
+		i += nbRays;
+	}
+
+	const PxU32 sweepEnd = PxMin(end, nbRaycasts + nbSweeps);
+	for(;i<sweepEnd;i++)
+	{
+		const PxU32 index = i - nbRaycasts;
+		const SweepQuery& query = mSweeps[index];
+		PxSweepBuffer& buffer = mSweepBuffers[index];
+		mScene.sweep(query.mGeometry.any(), query.mPose, query.mDir, query.mDistance, buffer, query.mHitFlags, query.mFilterData, mFilterCall,
+			query.mHasCache ? &query.mCache : NULL, query.mInflation);
+	}
+
+	for(;i<end;i++)
+	{
+		const PxU32 index = i - nbRaycasts - nbSweeps;
+		const OverlapQuery& query = mOverlaps[index];
+		PxOverlapBuffer& buffer = mOverlapBuffers[index];
+		mScene.overlap(query.mGeometry.any(), query.mPose, buffer, query.mFilterData, mFilterCall);
+	}
+}
+
+void BatchQueryExt::execute(PxCpuDispatcher* dispatcher)
+{
+	const PxU32 nbQueries = mRaycasts.size() + mSweeps.size() + mOverlaps.size();
+	if(!nbQueries)
+		return;
+
+	// PT: worker threads don't hold the scene's read lock, so queries run on the calling thread when the scene requires it
+	if(mScene.getFlags() & PxSceneFlag::eREQUIRE_RW_LOCK)
+	{
+		dispatcher = NULL;
+	}
+	else
+	{
+		if(!dispatcher)
+			dispatcher = mScene.getCpuDispatcher();
+
+		// PT: flush pending scene-query updates once here, rather than having the first queries of each thread contend for it
+		mScene.flushQueryUpdates();
+	}
+
+	BatchQueryJob* job = PX_NEW(BatchQueryJob)(*this, nbQueries);
+	job->run(dispatcher, BATCH_QUERY_PARALLEL_THRESHOLD);
+	job->releaseRef();
+}
+
+void BatchQueryExt::reset()
+{
+	mRaycasts.clear();
+	mRayOrigins.clear();
+	mRayDirs.clear();
+	mRayDistances.clear();
+	mRaycastBuffers.clear();
+	mNbRaycastTouches = 0;
+
+	mSweeps.clear();
+	mSweepBuffers.clear();
+	mNbSweepTouches = 0;
+
+	mOverlaps.clear();
+	mOverlapBuffers.clear();
+	mNbOverlapTouches = 0;
+}
+
+void BatchQueryExt::release()
+{
+	PX_DELETE(this);
+}
+
+PxBatchQueryExt* physx::PxCreateBatchQueryExt(PxScene& scene, PxQueryFilterCallback* filterCall,
+	PxU32 maxNbRaycasts, PxU32 maxNbRaycastTouches,
+	PxU32 maxNbSweeps, PxU32 maxNbSweepTouches,
+	PxU32 maxNbOverlaps, PxU32 maxNbOverlapTouches)
+{
+	return PX_NEW(BatchQueryExt)(scene, filterCall, maxNbRaycasts, maxNbRaycastTouches, maxNbSweeps, maxNbSweepTouches, maxNbOverlaps, maxNbOverlapTouches);
+}
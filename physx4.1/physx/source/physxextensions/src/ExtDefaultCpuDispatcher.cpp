@@ -29,13 +29,17 @@
 
 #include "ExtDefaultCpuDispatcher.h"
 #include "ExtCpuWorkerThread.h"
+#include "ExtWorkStealingCpuDispatcher.h"
 #include "ExtTaskQueueHelper.h"
 #include "PsString.h"
 
 using namespace physx;
 
-PxDefaultCpuDispatcher* physx::PxDefaultCpuDispatcherCreate(PxU32 numThreads, PxU32* affinityMasks)
+PxDefaultCpuDispatcher* physx::PxDefaultCpuDispatcherCreate(PxU32 numThreads, PxU32* affinityMasks, PxDefaultCpuDispatcherMode::Enum mode)
 {
+	if(mode == PxDefaultCpuDispatcherMode::eWORK_STEALING)
+		return PX_NEW(Ext::WorkStealingCpuDispatcher)(numThreads, affinityMasks);
+
 	return PX_NEW(Ext::DefaultCpuDispatcher)(numThreads, affinityMasks);
 }
 
@@ -0,0 +1,334 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#include "foundation/PxIO.h"
+#include "foundation/PxMath.h"
+#include "ExtProfileTraceRecorder.h"
+
+#include "PsAtomic.h"
+#include "PsArray.h"
+#include "PsBitUtils.h"
+#include "PsString.h"
+#include "PsThread.h"
+#include "PsTime.h"
+
+#include <stdarg.h>
+
+using namespace physx;
+
+PxProfileTraceRecorder* physx::PxProfileTraceRecorderCreate(PxU32 maxNbEventsPerThread, PxU32 maxNbFrames)
+{
+	return PX_NEW(Ext::ProfileTraceRecorder)(maxNbEventsPerThread, maxNbFrames);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+Ext::TraceThreadBuffer::TraceThreadBuffer(PxU32 capacity, PxU32 threadIndex) :
+	mCapacity	(capacity),
+	mWritePos	(0),
+	mThreadIndex(threadIndex),
+	mNext		(NULL)
+{
+	mEvents = reinterpret_cast<TraceEvent*>(PX_ALLOC(sizeof(TraceEvent)*capacity, "TraceEvent"));
+}
+
+Ext::TraceThreadBuffer::~TraceThreadBuffer()
+{
+	PX_FREE(mEvents);
+}
+
+PX_FORCE_INLINE void Ext::TraceThreadBuffer::record(const char* name, PxU64 contextId, PxU32 flags, PxU64 time)
+{
+	const PxU32 pos = PxU32(mWritePos);
+	TraceEvent& event = mEvents[pos & (mCapacity-1)];
+	event.mName			= name;
+	event.mTime			= time;
+	event.mContextId	= contextId;
+	event.mFlags		= flags;
+
+	// Publish the event. The exchange orders the event writes before the new position is visible to readers.
+	Ps::atomicExchange(&mWritePos, PxI32(pos+1));
+}
+
+PxU32 Ext::TraceThreadBuffer::snapshot(TraceEvent* events) const
+{
+	const PxU32 end = PxU32(Ps::atomicAdd(const_cast<volatile PxI32*>(&mWritePos), 0));
+	const PxU32 nbEvents = PxMin(end, mCapacity);
+	const PxU32 start = end - nbEvents;
+	for(PxU32 i=0;i<nbEvents;i++)
+		events[i] = mEvents[(start + i) & (mCapacity-1)];
+
+	// The owner thread kept recording during the copy. Events older than the capacity window at the current
+	// position may have been overwritten while they were copied, discard them. record() writes the slot of
+	// position newEnd before it publishes newEnd+1, so with a full buffer the copy at index newEnd-end may be
+	// torn as well.
+	const PxU32 newEnd = PxU32(Ps::atomicAdd(const_cast<volatile PxI32*>(&mWritePos), 0));
+	const PxU32 nbOverwritten = PxMin(newEnd - end + (end >= mCapacity ? 1u : 0u), nbEvents);
+	if(nbOverwritten)
+	{
+		for(PxU32 i=nbOverwritten;i<nbEvents;i++)
+			events[i - nbOverwritten] = events[i];
+	}
+	return nbEvents - nbOverwritten;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+Ext::ProfileTraceRecorder::ProfileTraceRecorder(PxU32 maxNbEventsPerThread, PxU32 maxNbFrames) :
+	mThreadBuffers	(NULL),
+	mNbThreads		(0),
+	mNbFrames		(0)
+{
+	maxNbEventsPerThread = PxMax(maxNbEventsPerThread, 2u);
+	mEventsPerThread = Ps::isPowerOfTwo(maxNbEventsPerThread) ? maxNbEventsPerThread : Ps::nextPowerOfTwo(maxNbEventsPerThread);
+
+	mMaxNbFrames = PxMax(maxNbFrames, 1u);
+	mFrameTimes = reinterpret_cast<PxU64*>(PX_ALLOC(sizeof(PxU64)*mMaxNbFrames, "ProfileTraceRecorder frames"));
+
+	mTlsIndex = Ps::TlsAlloc();
+}
+
+Ext::ProfileTraceRecorder::~ProfileTraceRecorder()
+{
+	TraceThreadBuffer* buffer = getThreadBuffers();
+	while(buffer)
+	{
+		TraceThreadBuffer* next = buffer->mNext;
+		PX_DELETE(buffer);
+		buffer = next;
+	}
+
+	Ps::TlsFree(mTlsIndex);
+	PX_FREE(mFrameTimes);
+}
+
+void Ext::ProfileTraceRecorder::release()
+{
+	PX_DELETE(this);
+}
+
+Ext::TraceThreadBuffer* Ext::ProfileTraceRecorder::getThreadBuffer()
+{
+	TraceThreadBuffer* buffer = reinterpret_cast<TraceThreadBuffer*>(Ps::TlsGet(mTlsIndex));
+	if(buffer)
+		return buffer;
+
+	// First event recorded by this thread: create its buffer and push it to the list.
+	buffer = PX_NEW(TraceThreadBuffer)(mEventsPerThread, PxU32(Ps::atomicIncrement(&mNbThreads) - 1));
+	TraceThreadBuffer* head;
+	do
+	{
+		head = getThreadBuffers();
+		buffer->mNext = head;
+	}
+	while(Ps::atomicCompareExchangePointer(&mThreadBuffers, buffer, head) != head);
+
+	Ps::TlsSet(mTlsIndex, buffer);
+	return buffer;
+}
+
+void* Ext::ProfileTraceRecorder::zoneStart(const char* eventName, bool detached, uint64_t contextId)
+{
+	getThreadBuffer()->record(eventName, contextId, detached ? PxU32(TraceEvent::eDETACHED) : 0u, Ps::Time::getCurrentCounterValue());
+	return NULL;
+}
+
+void Ext::ProfileTraceRecorder::zoneEnd(void*, const char* eventName, bool detached, uint64_t contextId)
+{
+	const PxU64 time = Ps::Time::getCurrentCounterValue();
+	getThreadBuffer()->record(eventName, contextId, detached ? PxU32(TraceEvent::eEND|TraceEvent::eDETACHED) : PxU32(TraceEvent::eEND), time);
+}
+
+void Ext::ProfileTraceRecorder::markFrame()
+{
+	const PxU32 frame = PxU32(mNbFrames);
+	mFrameTimes[frame % mMaxNbFrames] = Ps::Time::getCurrentCounterValue();
+	Ps::atomicExchange(&mNbFrames, PxI32(frame+1));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	class ChromeTraceWriter
+	{
+	public:
+		ChromeTraceWriter(PxOutputStream& stream, PxU64 baseTime) :
+			mStream		(stream),
+			mBaseTime	(baseTime),
+			mNbEvents	(0),
+			mFailed		(false)
+		{
+			const Ps::CounterFrequencyToTensOfNanos& freq = Ps::Time::getBootCounterFrequency();
+			mTicksToMicroSeconds = double(freq.mNumerator) / (double(freq.mDenominator) * 100.0);
+		}
+
+		bool	failed()	const	{ return mFailed;	}
+
+		void	print(const char* format, ...)
+		{
+			char buffer[512];
+			va_list args;
+			va_start(args, format);
+			const PxI32 length = Ps::vsnprintf(buffer, sizeof(buffer), format, args);
+			va_end(args);
+			const PxU32 size = PxMin(PxU32(PxMax(length, 0)), PxU32(sizeof(buffer) - 1));
+			if(mStream.write(buffer, size) != size)
+				mFailed = true;
+		}
+
+		// Starts a new trace event object and writes the fields common to all events.
+		void	beginEvent(const char* name, const char* phase, PxU32 threadIndex)
+		{
+			char escaped[256];
+			PxU32 length = 0;
+			for(const char* c = name; *c && length<sizeof(escaped)-2; c++)
+			{
+				if(*c=='"' || *c=='\\')
+					escaped[length++] = '\\';
+				escaped[length++] = *c;
+			}
+			escaped[length] = 0;
+
+			print("%s\n{\"name\":\"%s\",\"ph\":\"%s\",\"pid\":0,\"tid\":%u", mNbEvents ? "," : "", escaped, phase, threadIndex);
+			mNbEvents++;
+		}
+
+		void	printTime(PxU64 time)
+		{
+			const double us = time > mBaseTime ? double(time - mBaseTime) * mTicksToMicroSeconds : 0.0;
+			print(",\"ts\":%.3f", us);
+		}
+
+	private:
+		PX_NOCOPY(ChromeTraceWriter)
+
+		PxOutputStream&	mStream;
+		const PxU64		mBaseTime;
+		double			mTicksToMicroSeconds;
+		PxU32			mNbEvents;
+		bool			mFailed;
+	};
+}
+
+bool Ext::ProfileTraceRecorder::writeChromeTrace(PxOutputStream& stream, PxU32 nbFrames)
+{
+	// Range of frame markers to write. Only the last mMaxNbFrames markers are kept.
+	const PxU32 nbMarkedFrames = PxU32(Ps::atomicAdd(&mNbFrames, 0));
+	const PxU32 nbKeptFrames = PxMin(nbMarkedFrames, mMaxNbFrames);
+	const PxU32 nbWrittenFrames = nbFrames ? PxMin(nbFrames, nbKeptFrames) : nbKeptFrames;
+	const PxU32 firstFrame = nbMarkedFrames - nbWrittenFrames;
+	const PxU64 startTime = (nbFrames && nbWrittenFrames) ? mFrameTimes[firstFrame % mMaxNbFrames] : 0;
+
+	// Snapshot all thread buffers first, so that the time base can be taken from the oldest written event.
+	const PxU32 nbThreads = PxU32(Ps::atomicAdd(&mNbThreads, 0));
+	Ps::Array<TraceEvent> events;
+	Ps::Array<PxU32> threadRanges;
+	Ps::Array<PxU32> threadIndices;
+	PxU64 baseTime = startTime;
+	{
+		TraceThreadBuffer* buffer = getThreadBuffers();
+		Ps::Array<TraceEvent> threadEvents;
+		threadEvents.resizeUninitialized(mEventsPerThread);
+		while(buffer)
+		{
+			const PxU32 nbEvents = buffer->snapshot(threadEvents.begin());
+			threadRanges.pushBack(events.size());
+			threadIndices.pushBack(buffer->mThreadIndex);
+			for(PxU32 i=0;i<nbEvents;i++)
+			{
+				if(threadEvents[i].mTime >= startTime)
+				{
+					if(!baseTime || threadEvents[i].mTime < baseTime)
+						baseTime = threadEvents[i].mTime;
+					events.pushBack(threadEvents[i]);
+				}
+			}
+			buffer = buffer->mNext;
+		}
+		threadRanges.pushBack(events.size());
+	}
+
+	ChromeTraceWriter writer(stream, baseTime);
+	writer.print("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+	for(PxU32 i=0;i<nbThreads && i<threadIndices.size();i++)
+	{
+		writer.beginEvent("thread_name", "M", threadIndices[i]);
+		writer.print(",\"args\":{\"name\":\"PhysX thread %u\"}}", threadIndices[i]);
+	}
+
+	for(PxU32 i=firstFrame;i<nbMarkedFrames;i++)
+	{
+		char name[32];
+		Ps::snprintf(name, sizeof(name), "frame %u", i);
+		writer.beginEvent(name, "i", 0);
+		writer.printTime(mFrameTimes[i % mMaxNbFrames]);
+		writer.print(",\"s\":\"g\"}");
+	}
+
+	for(PxU32 t=0;t<threadIndices.size();t++)
+	{
+		// Zones may have started before the written range. Skip their end events, the viewers would
+		// otherwise pair them with unrelated zones.
+		PxU32 depth = 0;
+		for(PxU32 i=threadRanges[t];i<threadRanges[t+1];i++)
+		{
+			const TraceEvent& event = events[i];
+			const bool end = (event.mFlags & TraceEvent::eEND) != 0;
+			if(event.mFlags & TraceEvent::eDETACHED)
+			{
+				// Cross-thread zones are written as async events, matched by name and context id.
+				writer.beginEvent(event.mName, end ? "e" : "b", threadIndices[t]);
+				writer.printTime(event.mTime);
+				writer.print(",\"cat\":\"PhysX\",\"id\":\"0x%llx\"}", static_cast<unsigned long long>(event.mContextId));
+				continue;
+			}
+
+			if(end)
+			{
+				if(!depth)
+					continue;
+				depth--;
+			}
+			else
+				depth++;
+
+			writer.beginEvent(event.mName, end ? "E" : "B", threadIndices[t]);
+			writer.printTime(event.mTime);
+			if(end)
+				writer.print("}");
+			else
+				writer.print(",\"cat\":\"PhysX\",\"args\":{\"contextId\":\"0x%llx\"}}", static_cast<unsigned long long>(event.mContextId));
+		}
+	}
+
+	writer.print("\n]}\n");
+	return !writer.failed();
+}
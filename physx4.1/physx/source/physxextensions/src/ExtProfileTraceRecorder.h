@@ -0,0 +1,117 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef PX_PHYSICS_EXTENSIONS_PROFILE_TRACE_RECORDER_H_INTERNAL
+#define PX_PHYSICS_EXTENSIONS_PROFILE_TRACE_RECORDER_H_INTERNAL
+
+#include "extensions/PxProfileTraceRecorder.h"
+
+#include "CmPhysXCommon.h"
+#include "PsUserAllocated.h"
+
+namespace physx
+{
+
+namespace Ext
+{
+	struct TraceEvent
+	{
+		enum Flags
+		{
+			eEND		= (1<<0),	// zone end, zone start otherwise
+			eDETACHED	= (1<<1)	// cross-thread zone
+		};
+
+		const char*	mName;
+		PxU64		mTime;
+		PxU64		mContextId;
+		PxU32		mFlags;
+	};
+
+	// Ring buffer written by a single thread. Only the owner thread writes mEvents and mWritePos; readers
+	// take a snapshot and discard the events that may have been overwritten while they copied them.
+	class TraceThreadBuffer : public Ps::UserAllocated
+	{
+	public:
+										TraceThreadBuffer(PxU32 capacity, PxU32 threadIndex);
+										~TraceThreadBuffer();
+
+		PX_FORCE_INLINE	void			record(const char* name, PxU64 contextId, PxU32 flags, PxU64 time);
+		// Copies the events still held by the buffer and returns their number.
+						PxU32			snapshot(TraceEvent* events)	const;
+
+						TraceEvent*		mEvents;
+						PxU32			mCapacity;
+						volatile PxI32	mWritePos;		// total number of events recorded, wraps around
+						PxU32			mThreadIndex;
+						TraceThreadBuffer*	mNext;
+	private:
+		PX_NOCOPY(TraceThreadBuffer)
+	};
+
+	class ProfileTraceRecorder : public PxProfileTraceRecorder, public Ps::UserAllocated
+	{
+	public:
+										ProfileTraceRecorder(PxU32 maxNbEventsPerThread, PxU32 maxNbFrames);
+										~ProfileTraceRecorder();
+
+		//---------------------------------------------------------------------------------
+		// PxProfilerCallback implementation
+		//---------------------------------------------------------------------------------
+		virtual			void*			zoneStart(const char* eventName, bool detached, uint64_t contextId);
+		virtual			void			zoneEnd(void* profilerData, const char* eventName, bool detached, uint64_t contextId);
+
+		//---------------------------------------------------------------------------------
+		// PxProfileTraceRecorder implementation
+		//---------------------------------------------------------------------------------
+		virtual			void			markFrame();
+		virtual			PxU32			getNbFrames()	const	{ return PxU32(mNbFrames);	}
+		virtual			bool			writeChromeTrace(PxOutputStream& stream, PxU32 nbFrames);
+		virtual			void			release();
+
+	private:
+						TraceThreadBuffer*	getThreadBuffer();
+
+						PxU32			mTlsIndex;
+						PxU32			mEventsPerThread;
+		PX_FORCE_INLINE	TraceThreadBuffer*	getThreadBuffers()	const	{ return reinterpret_cast<TraceThreadBuffer*>(const_cast<void*>(mThreadBuffers));	}
+
+						volatile void*	mThreadBuffers;	// lock-free list of all per-thread buffers
+						volatile PxI32	mNbThreads;
+
+						PxU64*			mFrameTimes;	// ring buffer of frame marker times
+						PxU32			mMaxNbFrames;
+						volatile PxI32	mNbFrames;
+	};
+
+} // namespace Ext
+
+}
+
+#endif
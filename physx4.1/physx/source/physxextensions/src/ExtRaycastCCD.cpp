@@ -38,6 +38,8 @@
 #include "PxRigidDynamic.h"
 
 #include "PsArray.h"
+#include "CmChunkedJob.h"
+#include "CmRadixSortBuffered.h"
 
 using namespace physx;
 
@@ -54,6 +56,8 @@ class RaycastCCDManagerInternal
 
 		void	doRaycastCCD(bool doDynamicDynamicCCD);
 
+		void	doRaycastCCDBatched(bool doDynamicDynamicCCD, PxCpuDispatcher* dispatcher);
+
 		struct CCDObject
 		{
 			PX_FORCE_INLINE	CCDObject(PxRigidDynamic* actor, PxShape* shape, const PxVec3& witness) : mActor(actor), mShape(shape), mWitness(witness)	{}
@@ -62,9 +66,27 @@ class RaycastCCDManagerInternal
 			PxVec3			mWitness;
 		};
 
+		// A ray gathered by doRaycastCCDBatched(), with the object's new pose computed before the ray is cast
+		struct CCDRay
+		{
+			PxTransform		mNewPose;
+			PxVec3			mNewShapeCenter;
+			PxVec3			mDir;
+			PxReal			mLength;
+			PxReal			mInternalRadius;
+			PxU32			mObjectIndex;
+		};
+
 	private:
-		PxScene*						mScene;
-		physx::shdfnd::Array<CCDObject>	mObjects;
+		PxScene*							mScene;
+		physx::shdfnd::Array<CCDObject>		mObjects;
+
+		// PT: buffers for doRaycastCCDBatched(), kept from one call to the next
+		physx::shdfnd::Array<CCDRay>		mRays;
+		physx::shdfnd::Array<PxU32>			mRayKeys;	// PT: Morton codes of ray origins
+		Cm::RadixSortBuffered				mRaySort;	// PT: ranks are the order in which rays are cast
+		physx::shdfnd::Array<PxRaycastHit>	mHits;
+		physx::shdfnd::Array<PxU8>			mHasHit;
 };
 }
 
@@ -209,15 +231,39 @@ static PxRigidDynamic* canDoCCD(PxRigidActor& actor, PxShape* /*shape*/)
 	return dyna;
 }
 
+// PT: moves the object back along its ray after a hit. Returns true if the CCD witness should be updated.
+static bool applyCCDHit(const RaycastCCDManagerInternal::CCDObject& object, PxRigidDynamic* dyna, const PxVec3& dir, PxReal internalRadius, const PxRaycastHit& hit, PxTransform& newPose, PxVec3& newShapeCenter)
+{
+	const PxVec3 offset = newPose.p - newShapeCenter;
+	const PxVec3& origin = object.mWitness;
+
+	const PxReal radiusLimit = internalRadius * 0.75f;
+	if(hit.distance>radiusLimit)
+	{
+		newShapeCenter = origin + dir * (hit.distance - radiusLimit);
+	}
+	else
+	{
+		if(hit.actor->getConcreteType()==PxConcreteType::eRIGID_DYNAMIC)
+			return true;
+
+		newShapeCenter = origin;
+	}
+
+	newPose.p = offset + newShapeCenter;
+	const PxTransform shapeLocalPose = object.mShape->getLocalPose();
+	const PxTransform inverseShapeLocalPose = shapeLocalPose.getInverse();
+	const PxTransform newGlobalPose = newPose * inverseShapeLocalPose;
+	dyna->setGlobalPose(newGlobalPose);
+	return false;
+}
+
 static bool doRaycastCCD(PxScene* scene, const RaycastCCDManagerInternal::CCDObject& object, PxTransform& newPose, PxVec3& newShapeCenter, bool dyna_dyna)
 {
 	PxRigidDynamic* dyna = canDoCCD(*object.mActor, object.mShape);
 	if(!dyna)
 		return true;
 
-	bool updateCCDWitness = true;
-
-	const PxVec3 offset = newPose.p - newShapeCenter;
 	const PxVec3& origin = object.mWitness;
 	const PxVec3& dest = newShapeCenter;
 
@@ -231,30 +277,63 @@ static bool doRaycastCCD(PxScene* scene, const RaycastCCDManagerInternal::CCDObj
 
 		PxRaycastHit hit;
 		if(internalRadius!=0.0f && CCDRaycast(scene, object.mActor, object.mShape, origin, dir, length, hit, dyna_dyna))
+			return applyCCDHit(object, dyna, dir, internalRadius, hit, newPose, newShapeCenter);
+	}
+	return true;
+}
+
+namespace
+{
+	const PxU32 RAYCAST_CCD_CHUNK_SIZE			= 64;	// rays per chunk of work
+	const PxU32 RAYCAST_CCD_PARALLEL_THRESHOLD	= 4*RAYCAST_CCD_CHUNK_SIZE;
+
+	// PT: quantizes a coordinate in [0, 1023] and spreads its bits so that they can be interleaved with two others
+	PX_FORCE_INLINE PxU32 expandBits10(PxReal f)
+	{
+		PxU32 v = PxMin(PxU32(f), 1023u);
+		v = (v * 0x00010001u) & 0xFF0000FFu;
+		v = (v * 0x00000101u) & 0x0F00F00Fu;
+		v = (v * 0x00000011u) & 0xC30C30C3u;
+		v = (v * 0x00000005u) & 0x49249249u;
+		return v;
+	}
+
+	// Casts the gathered rays over the worker threads. Rays are processed in sorted order, hits are written per ray.
+	class RaycastCCDJob : public Cm::ChunkedJob
+	{
+	public:
+		RaycastCCDJob(PxScene* scene, const RaycastCCDManagerInternal::CCDObject* objects, const RaycastCCDManagerInternal::CCDRay* rays, const PxU32* rayOrder, PxU32 nbRays,
+			PxRaycastHit* hits, PxU8* hasHit, bool dyna_dyna) :
+			Cm::ChunkedJob	(nbRays, RAYCAST_CCD_CHUNK_SIZE),
+			mScene			(scene),
+			mObjects		(objects),
+			mRays			(rays),
+			mRayOrder		(rayOrder),
+			mHits			(hits),
+			mHasHit			(hasHit),
+			mDynaDyna		(dyna_dyna)
 		{
-			updateCCDWitness = false;
+		}
 
-			const PxReal radiusLimit = internalRadius * 0.75f;
-			if(hit.distance>radiusLimit)
+		virtual	void	process(PxU32 start, PxU32 end)
+		{
+			for(PxU32 i=start;i<end;i++)
 			{
-				newShapeCenter = origin + dir * (hit.distance - radiusLimit);
+				const PxU32 rayIndex = mRayOrder[i];
+				const RaycastCCDManagerInternal::CCDRay& ray = mRays[rayIndex];
+				const RaycastCCDManagerInternal::CCDObject& object = mObjects[ray.mObjectIndex];
+				mHasHit[rayIndex] = PxU8(CCDRaycast(mScene, object.mActor, object.mShape, object.mWitness, ray.mDir, ray.mLength, mHits[rayIndex], mDynaDyna));
 			}
-			else
-			{
-				if(hit.actor->getConcreteType()==PxConcreteType::eRIGID_DYNAMIC)
-					return true;
-
-				newShapeCenter = origin;
-			}
-
-			newPose.p = offset + newShapeCenter;
-			const PxTransform shapeLocalPose = object.mShape->getLocalPose();
-			const PxTransform inverseShapeLocalPose = shapeLocalPose.getInverse();
-			const PxTransform newGlobalPose = newPose * inverseShapeLocalPose;
-			dyna->setGlobalPose(newGlobalPose);
 		}
-	}
-	return updateCCDWitness;
+	private:
+		PxScene*										mScene;
+		const RaycastCCDManagerInternal::CCDObject*		mObjects;
+		const RaycastCCDManagerInternal::CCDRay*		mRays;
+		const PxU32*									mRayOrder;
+		PxRaycastHit*									mHits;
+		PxU8*											mHasHit;
+		const bool										mDynaDyna;
+	};
 }
 
 bool RaycastCCDManagerInternal::registerRaycastCCDObject(PxRigidDynamic* actor, PxShape* shape)
@@ -284,6 +363,106 @@ void RaycastCCDManagerInternal::doRaycastCCD(bool doDynamicDynamicCCD)
 	}
 }
 
+void RaycastCCDManagerInternal::doRaycastCCDBatched(bool doDynamicDynamicCCD, PxCpuDispatcher* dispatcher)
+{
+	// PT: gather the rays of all awake objects. Objects that don't need a ray get their witness updated right away.
+	mRays.forceSize_Unsafe(0);
+
+	PxBounds3 originBounds = PxBounds3::empty();
+	const PxU32 nbObjects = mObjects.size();
+	for(PxU32 i=0;i<nbObjects;i++)
+	{
+		CCDObject& object = mObjects[i];
+
+		if(object.mActor->isSleeping())
+			continue;
+
+		const PxTransform newPose = PxShapeExt::getGlobalPose(*object.mShape, *object.mActor);
+		const PxVec3 newShapeCenter = getShapeCenter(object.mShape, newPose);
+
+		if(canDoCCD(*object.mActor, object.mShape))
+		{
+			PxVec3 dir = newShapeCenter - object.mWitness;
+			const PxReal length = dir.magnitude();
+			if(length!=0.0f)
+			{
+				dir /= length;
+
+				const PxReal internalRadius = computeInternalRadius(object.mActor, object.mShape, dir);
+				if(internalRadius!=0.0f)
+				{
+					CCDRay& ray = mRays.insert();
+					ray.mNewPose = newPose;
+					ray.mNewShapeCenter = newShapeCenter;
+					ray.mDir = dir;
+					ray.mLength = length;
+					ray.mInternalRadius = internalRadius;
+					ray.mObjectIndex = i;
+					originBounds.include(object.mWitness);
+					continue;
+				}
+			}
+		}
+		object.mWitness = newShapeCenter;
+	}
+
+	const PxU32 nbRays = mRays.size();
+	if(!nbRays)
+		return;
+
+	// PT: sort the rays along a Morton curve of their origins, so that consecutive rays, and thus the rays of a chunk, start in the same
+	// parts of the scene and walk the same tree nodes.
+	mRayKeys.resizeUninitialized(nbRays);
+	{
+		const PxVec3 extents = originBounds.maximum - originBounds.minimum;
+		const PxVec3 scale(	extents.x>0.0f ? 1023.0f/extents.x : 0.0f,
+							extents.y>0.0f ? 1023.0f/extents.y : 0.0f,
+							extents.z>0.0f ? 1023.0f/extents.z : 0.0f);
+		for(PxU32 i=0;i<nbRays;i++)
+		{
+			const PxVec3 p = (mObjects[mRays[i].mObjectIndex].mWitness - originBounds.minimum).multiply(scale);
+			const PxU32 morton = (expandBits10(p.x)<<2) | (expandBits10(p.y)<<1) | expandBits10(p.z);
+			mRayKeys[i] = morton;
+		}
+	}
+	const PxU32* rayOrder = mRaySort.Sort(mRayKeys.begin(), nbRays, Cm::RADIX_UNSIGNED).GetRanks();
+
+	mHits.resize(nbRays);
+	mHasHit.resizeUninitialized(nbRays);
+
+	// PT: worker threads don't hold the scene's read lock, so rays are cast on the calling thread when the scene requires it
+	if(mScene->getFlags() & PxSceneFlag::eREQUIRE_RW_LOCK)
+	{
+		dispatcher = NULL;
+	}
+	else
+	{
+		if(!dispatcher)
+			dispatcher = mScene->getCpuDispatcher();
+
+		// PT: flush pending scene-query updates once here, rather than having the first rays of each thread contend for it
+		mScene->flushQueryUpdates();
+	}
+
+	RaycastCCDJob* job = PX_NEW(RaycastCCDJob)(mScene, mObjects.begin(), mRays.begin(), rayOrder, nbRays, mHits.begin(), mHasHit.begin(), doDynamicDynamicCCD);
+	job->run(dispatcher, RAYCAST_CCD_PARALLEL_THRESHOLD);
+	job->releaseRef();
+
+	// PT: move the objects in registration order, as doRaycastCCD() does
+	for(PxU32 i=0;i<nbRays;i++)
+	{
+		CCDRay& ray = mRays[i];
+		CCDObject& object = mObjects[ray.mObjectIndex];
+
+		bool updateCCDWitness = true;
+		if(mHasHit[i])
+			updateCCDWitness = applyCCDHit(object, object.mActor, ray.mDir, ray.mInternalRadius, mHits[i], ray.mNewPose, ray.mNewShapeCenter);
+
+		if(updateCCDWitness)
+			object.mWitness = ray.mNewShapeCenter;
+	}
+}
+
 RaycastCCDManager::RaycastCCDManager(PxScene* scene)
 {
 	mImpl = new RaycastCCDManagerInternal(scene);
@@ -303,3 +482,8 @@ void RaycastCCDManager::doRaycastCCD(bool doDynamicDynamicCCD)
 {
 	mImpl->doRaycastCCD(doDynamicDynamicCCD);
 }
+
+void RaycastCCDManager::doRaycastCCDBatched(bool doDynamicDynamicCCD, PxCpuDispatcher* dispatcher)
+{
+	mImpl->doRaycastCCDBatched(doDynamicDynamicCCD, dispatcher);
+}
@@ -0,0 +1,285 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#include "ExtWorkStealingCpuDispatcher.h"
+#include "ExtDefaultCpuDispatcher.h"
+#include "ExtTaskQueueHelper.h"
+#include "PsAtomic.h"
+#include "PsString.h"
+
+using namespace physx;
+
+Ext::WorkStealingWorkerThread::WorkStealingWorkerThread()
+:	mOwner(NULL),
+	mParked(0),
+	mWorkerIndex(0),
+	mRandomState(0)
+{
+}
+
+Ext::WorkStealingWorkerThread::~WorkStealingWorkerThread()
+{
+}
+
+void Ext::WorkStealingWorkerThread::initialize(WorkStealingCpuDispatcher* ownerDispatcher, PxU32 workerIndex)
+{
+	mOwner = ownerDispatcher;
+	mWorkerIndex = workerIndex;
+	mRandomState = 0x9e3779b9u * (workerIndex + 1);
+}
+
+PxU32 Ext::WorkStealingWorkerThread::nextRandom()
+{
+	// xorshift32, only used to spread victim selection
+	PxU32 x = mRandomState;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	mRandomState = x;
+	return x;
+}
+
+bool Ext::WorkStealingWorkerThread::tryWakeUp()
+{
+	if(mParked && Ps::atomicCompareExchange(&mParked, 0, 1) == 1)
+	{
+		mWakeUp.set();
+		return true;
+	}
+	return false;
+}
+
+PxBaseTask* Ext::WorkStealingWorkerThread::findWork()
+{
+	PxBaseTask* task = mQueue.pop();
+
+	if(!task)
+		task = mOwner->getSharedJob();
+
+	if(!task)
+		task = mOwner->stealJob(mWorkerIndex, nextRandom());
+
+	return task;
+}
+
+void Ext::WorkStealingWorkerThread::execute()
+{
+	Ps::TlsSet(mOwner->mTlsIndex, this);
+
+	PxU32 nbSpins = 0;
+	while(!quitIsSignalled())
+	{
+		PxBaseTask* task = findWork();
+
+		if(!task)
+		{
+			if(++nbSpins < EXT_WORK_STEALING_SPIN_COUNT)
+			{
+				if((nbSpins & 15) == 0)
+					Ps::Thread::yield();
+				continue;
+			}
+			nbSpins = 0;
+
+			// Park. The flag and counter are published before looking for work one last time, so a
+			// submitter either sees this worker as parked and wakes it, or its task is found below.
+			mWakeUp.reset();
+			Ps::atomicExchange(&mParked, 1);
+			Ps::atomicIncrement(&mOwner->mNumParked);
+
+			task = findWork();
+			if(!task)
+			{
+				if(!mOwner->mShuttingDown)
+					mWakeUp.wait();
+				continue;
+			}
+
+			// Found work after all. If a submitter already claimed the wake-up it also took care of the counter.
+			if(Ps::atomicCompareExchange(&mParked, 0, 1) == 1)
+				Ps::atomicDecrement(&mOwner->mNumParked);
+		}
+
+		nbSpins = 0;
+		mOwner->runTask(*task);
+		task->release();
+	}
+
+	quit();
+}
+
+Ext::WorkStealingCpuDispatcher::WorkStealingCpuDispatcher(PxU32 numThreads, PxU32* affinityMasks)
+	: mQueueEntryPool(EXT_TASK_QUEUE_ENTRY_POOL_SIZE, "QueueEntryPool"), mNumThreads(numThreads), mNumParked(0), mNextWakeUp(0), mShuttingDown(0)
+#if PX_PROFILE
+	,mRunProfiled(true)
+#else
+	,mRunProfiled(false)
+#endif
+{
+	PxU32* defaultAffinityMasks = NULL;
+
+	if(!affinityMasks)
+	{
+		defaultAffinityMasks = reinterpret_cast<PxU32*>(PX_ALLOC(numThreads * sizeof(PxU32), "ThreadAffinityMasks"));
+		DefaultCpuDispatcher::getAffinityMasks(defaultAffinityMasks, numThreads);
+		affinityMasks = defaultAffinityMasks;
+	}
+
+	mTlsIndex = Ps::TlsAlloc();
+
+	// initialize threads first, then start
+
+	mWorkerThreads = reinterpret_cast<WorkStealingWorkerThread*>(PX_ALLOC(numThreads * sizeof(WorkStealingWorkerThread), "WorkStealingWorkerThread"));
+	const PxU32 nameLength = 32;
+	mThreadNames = reinterpret_cast<PxU8*>(PX_ALLOC(nameLength * numThreads, "CpuWorkerThreadName"));
+
+	if (mWorkerThreads)
+	{
+		for(PxU32 i = 0; i < numThreads; ++i)
+		{
+			PX_PLACEMENT_NEW(mWorkerThreads+i, WorkStealingWorkerThread)();
+			mWorkerThreads[i].initialize(this, i);
+		}
+
+		for(PxU32 i = 0; i < numThreads; ++i)
+		{
+			if (mThreadNames)
+			{
+				char* threadName = reinterpret_cast<char*>(mThreadNames + (i*nameLength));
+				Ps::snprintf(threadName, nameLength, "PxWorker%02d", i);
+				mWorkerThreads[i].setName(threadName);
+			}
+
+			mWorkerThreads[i].setAffinityMask(affinityMasks[i]);
+			mWorkerThreads[i].start(Ps::Thread::getDefaultStackSize());
+		}
+	}
+	else
+	{
+		mNumThreads = 0;
+	}
+
+	if (defaultAffinityMasks)
+		PX_FREE(defaultAffinityMasks);
+}
+
+Ext::WorkStealingCpuDispatcher::~WorkStealingCpuDispatcher()
+{
+	Ps::atomicExchange(&mShuttingDown, 1);
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+		mWorkerThreads[i].signalQuit();
+
+	Ps::memoryBarrier();
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+		mWorkerThreads[i].wakeUp();
+
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+		mWorkerThreads[i].waitForQuit();
+
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+		mWorkerThreads[i].~WorkStealingWorkerThread();
+
+	PX_FREE(mWorkerThreads);
+
+	if (mThreadNames)
+		PX_FREE(mThreadNames);
+
+	Ps::TlsFree(mTlsIndex);
+}
+
+void Ext::WorkStealingCpuDispatcher::submitTask(PxBaseTask& task)
+{
+	if(!mNumThreads)
+	{
+		// no worker threads, run directly
+		runTask(task);
+		task.release();
+		return;
+	}
+
+	// The TLS slot is private to this dispatcher, so a non-NULL value is always one of our workers.
+	WorkStealingWorkerThread* worker = reinterpret_cast<WorkStealingWorkerThread*>(Ps::TlsGet(mTlsIndex));
+	if(worker && worker->pushLocal(task))
+	{
+		// the submitting worker will get to it, only wake someone up to steal from it
+		wakeOneWorker(PxU32(worker - mWorkerThreads) + 1);
+		return;
+	}
+
+	SharedQueueEntry* entry = mQueueEntryPool.getEntry(&task);
+	if (entry)
+	{
+		mJobList.push(*entry);
+		wakeOneWorker(PxU32(Ps::atomicIncrement(&mNextWakeUp)));
+	}
+}
+
+void Ext::WorkStealingCpuDispatcher::release()
+{
+	PX_DELETE(this);
+}
+
+PxBaseTask* Ext::WorkStealingCpuDispatcher::getSharedJob()
+{
+	return TaskQueueHelper::fetchTask(mJobList, mQueueEntryPool);
+}
+
+PxBaseTask* Ext::WorkStealingCpuDispatcher::stealJob(PxU32 thiefIndex, PxU32 startIndex)
+{
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+	{
+		const PxU32 victim = (startIndex + i) % mNumThreads;
+		if(victim == thiefIndex)
+			continue;
+
+		PxBaseTask* task = mWorkerThreads[victim].steal();
+		if(task)
+			return task;
+	}
+
+	return NULL;
+}
+
+void Ext::WorkStealingCpuDispatcher::wakeOneWorker(PxU32 startIndex)
+{
+	// make the submitted task visible before reading the parked state
+	Ps::memoryBarrier();
+
+	if(mNumParked <= 0)
+		return;
+
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+	{
+		if(mWorkerThreads[(startIndex + i) % mNumThreads].tryWakeUp())
+		{
+			Ps::atomicDecrement(&mNumParked);
+			return;
+		}
+	}
+}
@@ -0,0 +1,156 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef PX_PHYSICS_EXTENSIONS_NP_WORK_STEALING_CPU_DISPATCHER_H
+#define PX_PHYSICS_EXTENSIONS_NP_WORK_STEALING_CPU_DISPATCHER_H
+
+#include "common/PxProfileZone.h"
+#include "task/PxTask.h"
+#include "extensions/PxDefaultCpuDispatcher.h"
+
+#include "CmPhysXCommon.h"
+#include "PsUserAllocated.h"
+#include "PsSync.h"
+#include "PsSList.h"
+#include "PsThread.h"
+#include "ExtSharedQueueEntryPool.h"
+#include "ExtWorkStealingQueue.h"
+
+namespace physx
+{
+
+// Number of unsuccessful attempts to find work before a worker parks on its sync.
+#define EXT_WORK_STEALING_SPIN_COUNT 256
+
+namespace Ext
+{
+	class WorkStealingCpuDispatcher;
+
+#if PX_VC
+#pragma warning(push)
+#pragma warning(disable:4324)	// Padding was added at the end of a structure because of a __declspec(align) value.
+#endif							// Because of the SList member I assume
+
+	class WorkStealingWorkerThread : public Ps::Thread
+	{
+	public:
+										WorkStealingWorkerThread();
+										~WorkStealingWorkerThread();
+
+						void			initialize(WorkStealingCpuDispatcher* ownerDispatcher, PxU32 workerIndex);
+						void			execute();
+
+		PX_FORCE_INLINE	bool			pushLocal(PxBaseTask& task)	{ return mQueue.push(task);	}
+		PX_FORCE_INLINE	PxBaseTask*		steal()						{ return mQueue.steal();	}
+
+		// Returns true if the worker was parked and has been woken up by this call.
+						bool			tryWakeUp();
+						void			wakeUp()					{ mWakeUp.set();			}
+
+	private:
+						PxBaseTask*		findWork();
+						PxU32			nextRandom();
+
+						WorkStealingQueue			mQueue;
+						WorkStealingCpuDispatcher*	mOwner;
+						Ps::Sync					mWakeUp;
+						volatile PxI32				mParked;
+						PxU32						mWorkerIndex;
+						PxU32						mRandomState;
+	};
+
+	// Dispatcher with one Chase-Lev deque per worker. Tasks submitted from a worker thread go to that worker's deque,
+	// tasks submitted from other threads go to a shared injection queue. Idle workers steal from random victims and
+	// park on their own sync after spinning, so a submission wakes at most one worker.
+	class WorkStealingCpuDispatcher : public PxDefaultCpuDispatcher, public Ps::UserAllocated
+	{
+		friend class WorkStealingWorkerThread;
+
+	private:
+												WorkStealingCpuDispatcher() : mQueueEntryPool(0) {}
+												~WorkStealingCpuDispatcher();
+	public:
+												WorkStealingCpuDispatcher(PxU32 numThreads, PxU32* affinityMasks);
+
+		//---------------------------------------------------------------------------------
+		// PxCpuDispatcher implementation
+		//---------------------------------------------------------------------------------
+		virtual			void					submitTask(PxBaseTask& task);
+		virtual			PxU32					getWorkerCount()	const	{ return mNumThreads;	}
+
+		//---------------------------------------------------------------------------------
+		// PxDefaultCpuDispatcher implementation
+		//---------------------------------------------------------------------------------
+		virtual			void					release();
+
+		virtual			void					setRunProfiled(bool runProfiled) { mRunProfiled = runProfiled; }
+
+		virtual			bool					getRunProfiled() const { return mRunProfiled; }
+
+		//---------------------------------------------------------------------------------
+		// WorkStealingCpuDispatcher
+		//---------------------------------------------------------------------------------
+		PX_FORCE_INLINE	void					runTask(PxBaseTask& task)
+												{
+#if PX_SUPPORT_PXTASK_PROFILING
+													if(mRunProfiled)
+													{
+														PX_PROFILE_ZONE(task.getName(), task.getContextId());
+														task.run();
+													}
+													else
+#endif
+														task.run();
+												}
+
+	protected:
+						PxBaseTask*				getSharedJob();
+						PxBaseTask*				stealJob(PxU32 thiefIndex, PxU32 startIndex);
+						void					wakeOneWorker(PxU32 startIndex);
+
+						WorkStealingWorkerThread*	mWorkerThreads;
+						SharedQueueEntryPool<>		mQueueEntryPool;
+						Ps::SList					mJobList;
+						PxU8*						mThreadNames;
+						PxU32						mNumThreads;
+						PxU32						mTlsIndex;
+						volatile PxI32				mNumParked;
+						volatile PxI32				mNextWakeUp;
+						volatile PxI32				mShuttingDown;
+						bool						mRunProfiled;
+	};
+
+#if PX_VC
+#pragma warning(pop)
+#endif
+
+} // namespace Ext
+}
+
+#endif
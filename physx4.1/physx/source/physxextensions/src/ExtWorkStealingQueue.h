@@ -0,0 +1,140 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef PX_PHYSICS_EXTENSIONS_NP_WORK_STEALING_QUEUE_H
+#define PX_PHYSICS_EXTENSIONS_NP_WORK_STEALING_QUEUE_H
+
+#include "task/PxTask.h"
+#include "CmPhysXCommon.h"
+#include "PsAtomic.h"
+#include "PsIntrinsics.h"
+#include "PsUserAllocated.h"
+
+namespace physx
+{
+
+#define EXT_WORK_STEALING_QUEUE_SIZE 4096
+
+namespace Ext
+{
+	// Chase-Lev work-stealing deque with a fixed power-of-two capacity.
+	// The owning worker pushes and pops at the bottom (LIFO), other workers steal from the top (FIFO).
+	// push() fails when the ring is full, in which case the caller falls back to the shared queue.
+	class WorkStealingQueue : public Ps::UserAllocated
+	{
+	public:
+		WorkStealingQueue() : mTop(0), mBottom(0)
+		{
+			for(PxU32 i=0; i<EXT_WORK_STEALING_QUEUE_SIZE; i++)
+				mTasks[i] = NULL;
+		}
+
+		// Indices grow monotonically and are allowed to wrap, so they are only ever compared through their difference.
+		static PX_FORCE_INLINE PxI32 distance(PxI32 from, PxI32 to)
+		{
+			return PxI32(PxU32(to) - PxU32(from));
+		}
+
+		// Owner thread only.
+		PX_FORCE_INLINE bool push(PxBaseTask& task)
+		{
+			const PxI32 b = mBottom;
+			const PxI32 t = mTop;
+			if(distance(t, b) >= EXT_WORK_STEALING_QUEUE_SIZE)
+				return false;
+
+			mTasks[PxU32(b) & (EXT_WORK_STEALING_QUEUE_SIZE-1)] = &task;
+			// publish the task before the new bottom becomes visible to thieves
+			Ps::memoryBarrier();
+			mBottom = PxI32(PxU32(b) + 1);
+			return true;
+		}
+
+		// Owner thread only.
+		PX_FORCE_INLINE PxBaseTask* pop()
+		{
+			const PxI32 b = PxI32(PxU32(mBottom) - 1);
+			mBottom = b;
+			Ps::memoryBarrier();
+			const PxI32 t = mTop;
+
+			if(distance(t, b) < 0)
+			{
+				// empty
+				mBottom = PxI32(PxU32(b) + 1);
+				return NULL;
+			}
+
+			PxBaseTask* task = mTasks[PxU32(b) & (EXT_WORK_STEALING_QUEUE_SIZE-1)];
+			if(t == b)
+			{
+				// last entry, race against thieves for it
+				if(Ps::atomicCompareExchange(&mTop, PxI32(PxU32(t) + 1), t) != t)
+					task = NULL;
+				mBottom = PxI32(PxU32(b) + 1);
+			}
+			return task;
+		}
+
+		// Any thread.
+		PX_FORCE_INLINE PxBaseTask* steal()
+		{
+			const PxI32 t = mTop;
+			Ps::memoryBarrier();
+			const PxI32 b = mBottom;
+
+			if(distance(t, b) <= 0)
+				return NULL;
+
+			PxBaseTask* task = mTasks[PxU32(t) & (EXT_WORK_STEALING_QUEUE_SIZE-1)];
+			if(Ps::atomicCompareExchange(&mTop, PxI32(PxU32(t) + 1), t) != t)
+				return NULL;	// lost the race against the owner or another thief
+
+			return task;
+		}
+
+		PX_FORCE_INLINE bool isEmpty() const
+		{
+			return distance(mTop, mBottom) <= 0;
+		}
+
+	private:
+		// top and bottom are written by different threads, keep them on separate cache lines
+		volatile PxI32				mTop;
+		PxU8						mPad0[60];
+		volatile PxI32				mBottom;
+		PxU8						mPad1[60];
+		PxBaseTask* volatile		mTasks[EXT_WORK_STEALING_QUEUE_SIZE];
+	};
+
+} // namespace Ext
+
+}
+
+#endif
@@ -2170,6 +2170,7 @@ template<> struct PxEnumTraits< physx::PxHeightFieldFlag::Enum > { PxEnumTraits(
 		{ "eENABLE_GPU_DYNAMICS", static_cast<PxU32>( physx::PxSceneFlag::eENABLE_GPU_DYNAMICS ) },
 		{ "eENABLE_ENHANCED_DETERMINISM", static_cast<PxU32>( physx::PxSceneFlag::eENABLE_ENHANCED_DETERMINISM ) },
 		{ "eENABLE_FRICTION_EVERY_ITERATION", static_cast<PxU32>( physx::PxSceneFlag::eENABLE_FRICTION_EVERY_ITERATION ) },
+		{ "eENABLE_PARALLEL_PARTITIONING", static_cast<PxU32>( physx::PxSceneFlag::eENABLE_PARALLEL_PARTITIONING ) },
 		{ "eMUTABLE_FLAGS", static_cast<PxU32>( physx::PxSceneFlag::eMUTABLE_FLAGS ) },
 		{ NULL, 0 }
 	};
@@ -2233,6 +2234,7 @@ template<> struct PxEnumTraits< physx::PxVisualizationParameter::Enum > { PxEnum
 		{ "eNONE", static_cast<PxU32>( physx::PxPruningStructureType::eNONE ) },
 		{ "eDYNAMIC_AABB_TREE", static_cast<PxU32>( physx::PxPruningStructureType::eDYNAMIC_AABB_TREE ) },
 		{ "eSTATIC_AABB_TREE", static_cast<PxU32>( physx::PxPruningStructureType::eSTATIC_AABB_TREE ) },
+		{ "eWIDE_AABB_TREE", static_cast<PxU32>( physx::PxPruningStructureType::eWIDE_AABB_TREE ) },
 		{ "eLAST", static_cast<PxU32>( physx::PxPruningStructureType::eLAST ) },
 		{ NULL, 0 }
 	};
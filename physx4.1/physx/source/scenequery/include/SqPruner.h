@@ -46,6 +46,7 @@ namespace physx
 	{
 		class ShapeData;
 		class BVHStructure;
+		struct PlanesAABBTest;
 	}
 }
 
@@ -64,6 +65,7 @@ typedef PxU32 PrunerCompoundId;
 
 static const PrunerHandle INVALID_PRUNERHANDLE = 0xFFffFFff;
 static const PxReal SQ_PRUNER_INFLATION = 1.01f; // pruner test shape inflation (not narrow phase shape)
+static const PxU32 SQ_MAX_RAY_PACKET_SIZE = 16; // max number of rays in a raycastPacket() call
 
 struct PrunerPayload
 {
@@ -81,6 +83,25 @@ struct PrunerCallback
     virtual ~PrunerCallback() {}
 };
 
+// Callback of a raycastPacket() call. It gives access to each ray's callback, and lets the rays that touch the same object
+// be processed together.
+struct PrunerPacketCallback
+{
+	// the callback of a single ray, for pruners that raycast the rays one at a time
+	virtual PrunerCallback& getRayCallback(PxU32 rayIndex) = 0;
+
+	// same as calling getRayCallback(i).invoke(distances[i], payload) for each ray i of rayMask. Returns the rays of rayMask whose
+	// callback didn't stop the query.
+	virtual PxU32 invokePacket(PxU32 rayMask, PxReal* distances, const PrunerPayload& payload) = 0;
+	virtual ~PrunerPacketCallback() {}
+};
+
+struct PrunerCullCallback
+{
+	virtual PxAgain invoke(const PrunerPayload& payload, bool inside) = 0;
+	virtual ~PrunerCullCallback() {}
+};
+
 class Pruner : public Ps::UserAllocated
 {
 public:
@@ -164,6 +185,63 @@ public:
 	virtual	PxAgain						overlap(const Gu::ShapeData& queryVolume, PrunerCallback&) const = 0;
 	virtual	PxAgain						sweep(const Gu::ShapeData& queryVolume, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback&) const = 0;
 
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/**
+	 *	Raycasts a packet of rays. Each ray has its own distance and callback, and gives the same results as raycast().
+	 *	The default implementation raycasts the rays one by one, pruners can override it to traverse coherent rays together
+	 *	and pass each touched object once to PrunerPacketCallback::invokePacket() for all the rays that touch it.
+	 *
+	 *	\param		nbRays			[in]		the number of rays, at most SQ_MAX_RAY_PACKET_SIZE
+	 *	\param		origins			[in]		ray origins
+	 *	\param		unitDirs		[in]		normalized ray directions
+	 *	\param		inOutDistances	[in/out]	ray distances, shrunk by the callbacks as for raycast()
+	 *	\param		pcb				[in]		the packet's callback
+	 *	\param		activeRays		[in]		bitmask of rays to raycast
+	 *
+	 *	\return	the subset of activeRays whose callback didn't stop the query
+	 */
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	virtual	PxU32						raycastPacket(PxU32 nbRays, const PxVec3* origins, const PxVec3* unitDirs, PxReal* inOutDistances, PrunerPacketCallback& pcb, PxU32 activeRays) const
+										{
+											PX_ASSERT(nbRays<=SQ_MAX_RAY_PACKET_SIZE);
+											for(PxU32 i=0; i<nbRays; i++)
+											{
+												if((activeRays & (1<<i)) && !raycast(origins[i], unitDirs[i], inOutDistances[i], pcb.getRayCallback(i)))
+													activeRays &= ~(1<<i);
+											}
+											return activeRays;
+										}
+
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/**
+	 *	Finds the objects closest to a point. The callback is called for objects whose bounds are within inOutDistance of
+	 *	the point, and can shrink the search distance as for raycast(), i.e. to the distance of the farthest object it keeps.
+	 *	Tree-based pruners visit objects by increasing distance of their bounds, so a shrinking distance culls the rest of
+	 *	the tree early. Other pruners can just report all the objects overlapping the initial search sphere.
+	 *
+	 *	\param		point			[in]		the query point
+	 *	\param		inOutDistance	[in/out]	the search distance, shrunk by the callback
+	 *	\param		pcb				[in]		the callback
+	 *
+	 *	\return	false if the callback stopped the query
+	 */
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	virtual	PxAgain						closest(const PxVec3& point, PxReal& inOutDistance, PrunerCallback& pcb) const = 0;
+
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/**
+	 *	Culls the objects against a convex set of planes. The callback is called for objects whose bounds are not fully
+	 *	outside one of the planes, and tells whether the bounds are fully inside all the planes or cross at least one of them.
+	 *	Subtrees fully inside the plane set are reported without testing their objects.
+	 *
+	 *	\param		test			[in]		the plane set
+	 *	\param		pcb				[in]		the callback
+	 *
+	 *	\return	false if the callback stopped the query
+	 */
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	virtual	PxAgain						cull(const Gu::PlanesAABBTest& test, PrunerCullCallback& pcb) const = 0;
+
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/**
 	 *	Retrieve the object data associated with the handle
@@ -345,6 +423,7 @@ public:
 	virtual	PxAgain						raycast(const PxVec3& origin, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback&, PxQueryFlags flags) const = 0;
 	virtual	PxAgain						overlap(const Gu::ShapeData& queryVolume, PrunerCallback&, PxQueryFlags flags) const = 0;
 	virtual	PxAgain						sweep(const Gu::ShapeData& queryVolume, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback&, PxQueryFlags flags) const = 0;
+	virtual	PxAgain						cull(const Gu::PlanesAABBTest& test, PrunerCullCallback&, PxQueryFlags flags) const = 0;
 
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/**
@@ -57,6 +57,11 @@ namespace Gu
 	class BVHStructure;
 }
 
+namespace Cm
+{
+	class ChunkedJob;
+}
+
 namespace Sq
 {
 	typedef size_t	PrunerData;
@@ -156,6 +161,7 @@ namespace Sq
 	public:
 		PX_FORCE_INLINE	Scb::Scene&						getScene()						const	{ return mScene;			}
 		PX_FORCE_INLINE	PxU32							getDynamicTreeRebuildRateHint()	const	{ return mRebuildRateHint;	}
+		PX_FORCE_INLINE	PxU32							getDynamicTreeRebuildTimeBudget()	const	{ return mRebuildTimeBudget;	}
 
 		PX_FORCE_INLINE	const PrunerExt&				get(PruningIndex::Enum index)	const	{ return mPrunerExt[index];	}
 		PX_FORCE_INLINE	PrunerExt&						get(PruningIndex::Enum index)			{ return mPrunerExt[index];	}
@@ -165,11 +171,18 @@ namespace Sq
 						void							preallocate(PxU32 staticShapes, PxU32 dynamicShapes);
 						void							markForUpdate(PrunerCompoundId compoundId, PrunerData s);
 						void							setDynamicTreeRebuildRateHint(PxU32 dynTreeRebuildRateHint);
+						void							setDynamicTreeRebuildTimeBudget(PxU32 budget);
 						
 						void							flushUpdates();
 						void							forceDynamicTreeRebuild(bool rebuildStaticStructure, bool rebuildDynamicStructure);
 						void							sceneQueryBuildStep(PruningIndex::Enum index);
 
+		// Timed rebuild of the dynamic trees, see PxScene::setDynamicTreeRebuildTimeBudget(). The build started by startTimedBuild()
+		// runs on worker threads, only on the trees being built, and must be joined with waitTimedBuild() before the trees are
+		// stepped, committed or released.
+						void							startTimedBuild(PxCpuDispatcher* dispatcher);
+						void							waitTimedBuild();
+
 						void							updateCompoundActors(Sc::BodyCore*const* bodies, PxU32 numBodies);
 						void							updateCompoundActor(PrunerCompoundId compoundId, const PxTransform& compoundTransform, bool dynamic);						
 						void							removeCompoundActor(PrunerCompoundId compoundId, bool dynamic);
@@ -188,6 +201,8 @@ namespace Sq
 						CompoundPrunerExt				mCompoundPrunerExt;										
 
 						PxU32							mRebuildRateHint;
+						PxU32							mRebuildTimeBudget;	// in microseconds, 0 if the rebuild is paced by mRebuildRateHint
+						Cm::ChunkedJob*					mTimedBuildJob;		// timed build in progress, NULL if none
 
 						Scb::Scene&						mScene;
 
@@ -34,6 +34,7 @@
 #include "PsUserAllocated.h"
 #include "PsBitUtils.h"
 #include "PsFoundation.h"
+#include "PsTime.h"
 #include "SqAABBPruner.h"
 #include "SqAABBTree.h"
 #include "SqPrunerMergeData.h"
@@ -71,9 +72,11 @@ AABBPruner::AABBPruner(bool incrementalRebuild, PxU64 contextID) :
 	mProgress			(BUILD_NOT_STARTED),
 	mRebuildRateHint	(100),
 	mAdaptiveRebuildTerm(0),
+	mRebuildTimeBudget	(0),
 	mIncrementalRebuild	(incrementalRebuild),
 	mUncommittedChanges	(false),
 	mNeedsNewTree		(false),
+	mNewTreeBuilt		(false),
 	mNewTreeFixups		(PX_DEBUG_EXP("AABBPruner::mNewTreeFixups")),
 	mContextID			(contextID)
 {
@@ -355,6 +358,57 @@ PxAgain AABBPruner::raycast(const PxVec3& origin, const PxVec3& unitDir, PxReal&
 	return again;
 }
 
+PxAgain AABBPruner::closest(const PxVec3& point, PxReal& inOutDistance, PrunerCallback& pcb) const
+{
+	PX_ASSERT(!mUncommittedChanges);
+
+	PxAgain again = true;
+
+	if(mAABBTree)
+		again = AABBTreeClosest<AABBTree, AABBTreeRuntimeNode, PrunerPayload, PrunerCallback>()(mPool.getObjects(), mPool.getCurrentWorldBoxes(), *mAABBTree, point, inOutDistance, pcb);
+
+	if(again && mIncrementalRebuild && mBucketPruner.getNbObjects())
+		again = mBucketPruner.closest(point, inOutDistance, pcb);
+
+	return again;
+}
+
+PxAgain AABBPruner::cull(const Gu::PlanesAABBTest& test, PrunerCullCallback& pcb) const
+{
+	PX_ASSERT(!mUncommittedChanges);
+
+	PxAgain again = true;
+
+	if(mAABBTree)
+		again = AABBTreeCull<AABBTree, AABBTreeRuntimeNode, PrunerPayload, PrunerCullCallback>()(mPool.getObjects(), mPool.getCurrentWorldBoxes(), *mAABBTree, test, test.getAllPlanesMask(), pcb);
+
+	if(again && mIncrementalRebuild && mBucketPruner.getNbObjects())
+		again = mBucketPruner.cull(test, pcb);
+
+	return again;
+}
+
+PX_COMPILE_TIME_ASSERT(SQ_MAX_RAY_PACKET_SIZE==GU_RAY_PACKET_MAX_SIZE);
+
+PxU32 AABBPruner::raycastPacket(PxU32 nbRays, const PxVec3* origins, const PxVec3* unitDirs, PxReal* inOutDistances, PrunerPacketCallback& pcb, PxU32 activeRays) const
+{
+	PX_ASSERT(!mUncommittedChanges);
+
+	if(mAABBTree)
+		activeRays = AABBTreeRaycastPacket<AABBTree, AABBTreeRuntimeNode, PrunerPayload, PrunerPacketCallback>()(mPool.getObjects(), mPool.getCurrentWorldBoxes(), *mAABBTree, nbRays, origins, unitDirs, inOutDistances, activeRays, pcb);
+
+	// PT: the objects added since the last build are not in the tree, they're few so rays are tested one by one
+	if(activeRays && mIncrementalRebuild && mBucketPruner.getNbObjects())
+	{
+		for(PxU32 i=0; i<nbRays; i++)
+		{
+			if((activeRays & (1<<i)) && !mBucketPruner.raycast(origins[i], unitDirs[i], inOutDistances[i], pcb.getRayCallback(i)))
+				activeRays &= ~(1<<i);
+		}
+	}
+	return activeRays;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  *	Other methods of Pruner Interface
@@ -605,16 +659,27 @@ bool AABBPruner::buildStep(bool synchronousCall)
 		else if(mProgress==BUILD_IN_PROGRESS)
 		{
 			mNbCalls++;
-			const PxU32 Limit = 1 + (mTotalWorkUnits / mRebuildRateHint);
-			// looks like progressiveRebuild returns 0 when finished
-			if (!mNewTree->progressiveBuild(mBuilder, mBuildStats, 1, Limit))
+			if(mNewTreeBuilt)
 			{
-				// Done
+				// PT: built by timedBuildStep()
 				mProgress = BUILD_NEW_MAPPING;
 #if PX_DEBUG
 				mNewTree->validate();
 #endif
 			}
+			else if(!mRebuildTimeBudget || !synchronousCall)
+			{
+				const PxU32 Limit = 1 + (mTotalWorkUnits / mRebuildRateHint);
+				// looks like progressiveRebuild returns 0 when finished
+				if (!mNewTree->progressiveBuild(mBuilder, mBuildStats, 1, Limit))
+				{
+					// Done
+					mProgress = BUILD_NEW_MAPPING;
+#if PX_DEBUG
+					mNewTree->validate();
+#endif
+				}
+			}
 		}
 		else if(mProgress==BUILD_NEW_MAPPING)
 		{
@@ -674,6 +739,29 @@ bool AABBPruner::buildStep(bool synchronousCall)
 	return false;
 }
 
+// PT: number of work units (primitives processed by the build) between two time checks in timedBuildStep()
+#define TIMED_BUILD_SLICE	1024
+
+void AABBPruner::timedBuildStep()
+{
+	PX_PROFILE_ZONE("SceneQuery.prunerTimedBuildStep", mContextID);
+
+	PX_ASSERT(needsTimedBuildStep());
+
+	const Ps::CounterFrequencyToTensOfNanos& freq = Ps::Time::getBootCounterFrequency();
+	const PxU64 budget = (PxU64(mRebuildTimeBudget) * 100 * freq.mDenominator) / freq.mNumerator;	// in counter ticks
+	const PxU64 startTime = Ps::Time::getCurrentCounterValue();
+	do
+	{
+		if(!mNewTree->progressiveBuild(mBuilder, mBuildStats, 1, TIMED_BUILD_SLICE))	// returns 0 when finished
+		{
+			mNewTreeBuilt = true;
+			return;
+		}
+	}
+	while(Ps::Time::getCurrentCounterValue() - startTime < budget);
+}
+
 bool AABBPruner::prepareBuild()
 {
 	PX_PROFILE_ZONE("SceneQuery.prepareBuild", mContextID);
@@ -712,6 +800,7 @@ bool AABBPruner::prepareBuild()
 			mBuilder.mLimit			= NB_OBJECTS_PER_NODE;
 
 			mBuildStats.reset();
+			mNewTreeBuilt = false;
 
 			// start recording modifications to the tree made during rebuild to reapply (fix the new tree) eventually
 			PX_ASSERT(mNewTreeFixups.size()==0);
@@ -61,6 +61,10 @@ namespace Sq
 	// This is the core build function, actually building the tree. This should be mostly allocation-free, except here and there when
 	// building non-complete trees, and during the last call when the tree is finally built.
 	//
+	// With a rebuild time budget, this stage runs in timedBuildStep() instead, on a worker thread during the simulation. It only
+	// touches the new tree and the cached boxes, so it can run concurrently with queries and object updates. buildStep() moves to
+	// the next state once the tree is complete.
+	//
 	// BUILD_NEW_MAPPING (1 frame, AABBPruner):
 	//
 	// After the new AABBTree is built, we recreate an AABBTreeUpdateMap for the new tree, and use it to invalidate nodes whose objects
@@ -136,6 +140,9 @@ namespace Sq
 		virtual			PxAgain					raycast(const PxVec3& origin, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback&)	const;
 		virtual			PxAgain					overlap(const Gu::ShapeData& queryVolume, PrunerCallback&)	const;
 		virtual			PxAgain					sweep(const Gu::ShapeData& queryVolume, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback&)	const;
+		virtual			PxU32					raycastPacket(PxU32 nbRays, const PxVec3* origins, const PxVec3* unitDirs, PxReal* inOutDistances, PrunerPacketCallback&, PxU32 activeRays)	const;
+		virtual			PxAgain					closest(const PxVec3& point, PxReal& inOutDistance, PrunerCallback&)	const;
+		virtual			PxAgain					cull(const Gu::PlanesAABBTest& test, PrunerCullCallback&)	const;
 		virtual			const PrunerPayload&	getPayload(PrunerHandle handle)						const	{ return mPool.getPayload(handle);			}
 		virtual			const PrunerPayload&	getPayload(PrunerHandle handle, PxBounds3*& bounds)	const	{ return mPool.getPayload(handle, bounds);	}
 		virtual			void					preallocate(PxU32 entries)									{ mPool.preallocate(entries);				}
@@ -151,6 +158,11 @@ namespace Sq
 		virtual			bool					prepareBuild();	// returns true if new tree is needed
 		//~IncrementalPruner
 
+		// Time-budgeted rebuild, see BUILD_IN_PROGRESS notes above
+						void					setRebuildTimeBudget(PxU32 budget)	{ mRebuildTimeBudget = budget;	}	// in microseconds, 0 to use the rebuild rate hint
+		PX_FORCE_INLINE	bool					needsTimedBuildStep()	const		{ return mRebuildTimeBudget && mProgress==BUILD_IN_PROGRESS && !mNewTreeBuilt;	}
+						void					timedBuildStep();	// builds the new tree until the budget is used up
+
 		// direct access for test code
 
 		PX_FORCE_INLINE	PxU32					getNbAddedObjects()	const		{ return mBucketPruner.getNbObjects();					}
@@ -203,6 +215,9 @@ namespace Sq
 		// Term to correct the work unit estimate if the rebuild rate is not matched
 						PxI32					mAdaptiveRebuildTerm;
 
+		// Time budget of timedBuildStep() in microseconds, 0 if the rebuild is paced by mRebuildRateHint
+						PxU32					mRebuildTimeBudget;
+
 						PruningPool				mPool; // Pool of AABBs
 
 		// maps pruning pool indices to aabb tree indices
@@ -234,6 +249,9 @@ namespace Sq
 		// this is set to true if a new tree has to be created again after the current rebuild is done
 						bool					mNeedsNewTree;
 
+		// Set by timedBuildStep() when the new tree is complete, buildStep() then moves to BUILD_NEW_MAPPING
+						bool					mNewTreeBuilt;
+
 		// This struct is used to record modifications made to the pruner state
 		// while a tree is building in the background
 		// this is so we can apply the modifications to the tree at the time of completion
@@ -39,6 +39,8 @@
 #include "PsBitUtils.h"
 #include "PsIntrinsics.h"
 #include "GuBounds.h"
+#include "GuBVHTestsSIMD.h"
+#include "geometry/PxSphereGeometry.h"
 
 using namespace physx::shdfnd::aos;
 
@@ -2093,6 +2095,220 @@ PxAgain	BucketPrunerCore::overlap(const ShapeData& queryVolume, PrunerCallback&
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static PX_FORCE_INLINE bool classifyBucketBox(const BucketBox& box, const PlanesAABBTest& test, PxU32& planeMask)
+{
+	if(!planeMask)
+		return true;
+	return test.classify(V3LoadU(box.mCenter), V3LoadU(box.mExtents), planeMask);
+}
+
+// PT: reports the objects of a bucket. If the bucket box is inside all the planes, its objects are reported without
+// being tested.
+static PX_FORCE_INLINE bool cullBucket(	PxU32 nb, const BucketBox* PX_RESTRICT boxes, const PrunerPayload* PX_RESTRICT objects,
+										const PlanesAABBTest& test, PxU32 planeMask, PrunerCullCallback& pcb)
+{
+	while(nb--)
+	{
+		const BucketBox& currentBox = *boxes++;
+		const PrunerPayload& currentObject = *objects++;
+
+		PxU32 mask = planeMask;
+		if(!classifyBucketBox(currentBox, test, mask))
+			continue;
+
+		if(!pcb.invoke(currentObject, mask==0))
+			return false;
+	}
+	return true;
+}
+
+PxAgain BucketPrunerCore::cull(const PlanesAABBTest& test, PrunerCullCallback& pcb) const
+{
+	PX_ASSERT(!mDirty);
+
+	const PxU32 allPlanesMask = test.getAllPlanesMask();
+
+	for(PxU32 i=0;i<mNbFree;i++)
+	{
+		const PxBounds3& bounds = mFreeBounds[i];
+		PxU32 mask = allPlanesMask;
+		if(!test.classify(V3LoadU(bounds.getCenter()), V3LoadU(bounds.getExtents()), mask))
+			continue;
+
+		if(!pcb.invoke(mFreeObjects[i], mask==0))
+			return false;
+	}
+
+	const PxU32 nb = mSortedNb;
+	if(!nb)
+		return true;
+
+#ifdef BRUTE_FORCE_LIMIT
+	if(nb<=BRUTE_FORCE_LIMIT)
+		return cullBucket(nb, mSortedWorldBoxes, mSortedObjects, test, allPlanesMask, pcb);
+#endif
+
+	PxU32 globalMask = allPlanesMask;
+	if(!classifyBucketBox(mGlobalBox, test, globalMask))
+		return true;
+
+	// PT: each level only tests the planes its parent box crosses
+	for(PxU32 i=0;i<5;i++)
+	{
+		PxU32 mask1 = globalMask;
+		if(!mLevel1.mCounters[i] || !classifyBucketBox(mLevel1.mBucketBox[i], test, mask1))
+			continue;
+
+		for(PxU32 j=0;j<5;j++)
+		{
+			PxU32 mask2 = mask1;
+			if(!mLevel2[i].mCounters[j] || !classifyBucketBox(mLevel2[i].mBucketBox[j], test, mask2))
+				continue;
+
+			for(PxU32 k=0;k<5;k++)
+			{
+				const PxU32 nbInBucket = mLevel3[i][j].mCounters[k];
+				PxU32 mask3 = mask2;
+				if(!nbInBucket || !classifyBucketBox(mLevel3[i][j].mBucketBox[k], test, mask3))
+					continue;
+
+				const PxU32 offset = mLevel1.mOffsets[i] + mLevel2[i].mOffsets[j] + mLevel3[i][j].mOffsets[k];
+				if(!cullBucket(nbInBucket, mSortedWorldBoxes + offset, mSortedObjects + offset, test, mask3, pcb))
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static PX_FORCE_INLINE PxReal pointBucketBoxSquareDistance(const PxVec3& point, const BucketBox& box)
+{
+	const PxVec3 d = (point - box.mCenter).abs() - box.mExtents;
+	return d.maximum(PxVec3(0.0f)).magnitudeSquared();
+}
+
+static PX_FORCE_INLINE PxReal pointBoxSquareDistance(const PxVec3& point, const PxBounds3& box)
+{
+	return (box.minimum - point).maximum(point - box.maximum).maximum(PxVec3(0.0f)).magnitudeSquared();
+}
+
+// PT: reports the objects of a bucket within the search distance. The distance can shrink in the callback.
+static PX_FORCE_INLINE bool closestBucket(	PxU32 nb, const BucketBox* PX_RESTRICT boxes, const PrunerPayload* PX_RESTRICT objects,
+											const PxVec3& point, PxReal& inOutDistance, PrunerCallback& pcb)
+{
+	while(nb--)
+	{
+		const BucketBox& currentBox = *boxes++;
+		const PrunerPayload& currentObject = *objects++;
+
+		if(pointBucketBoxSquareDistance(point, currentBox) > inOutDistance*inOutDistance)
+			continue;
+
+		PxReal md = inOutDistance;
+		if(!pcb.invoke(md, currentObject))
+			return false;
+
+		if(md < inOutDistance)
+			inOutDistance = md;
+	}
+	return true;
+}
+
+// PT: sorts the non-empty buckets of a node by distance to the query point, and returns how many of them are within
+// the search distance
+static PX_FORCE_INLINE PxU32 sortBuckets(const BucketPrunerNode& node, const PxVec3& point, PxReal maxDistance, PxU32* PX_RESTRICT order, PxReal* PX_RESTRICT sqDists)
+{
+	PxU32 nb = 0;
+	for(PxU32 i=0;i<5;i++)
+	{
+		if(!node.mCounters[i])
+			continue;
+
+		const PxReal sqDist = pointBucketBoxSquareDistance(point, node.mBucketBox[i]);
+		if(sqDist > maxDistance*maxDistance)
+			continue;
+
+		PxU32 j = nb++;
+		while(j && sqDists[j-1] > sqDist)
+		{
+			sqDists[j] = sqDists[j-1];
+			order[j] = order[j-1];
+			j--;
+		}
+		sqDists[j] = sqDist;
+		order[j] = i;
+	}
+	return nb;
+}
+
+// PT: buckets are visited by increasing distance at each level, and skipped once the search distance, shrunk by the
+// callback, no longer reaches them
+PxAgain BucketPrunerCore::closest(const PxVec3& point, PxReal& inOutDistance, PrunerCallback& pcb) const
+{
+	PX_ASSERT(!mDirty);
+
+	for(PxU32 i=0;i<mNbFree;i++)
+	{
+		if(pointBoxSquareDistance(point, mFreeBounds[i]) > inOutDistance*inOutDistance)
+			continue;
+
+		PxReal md = inOutDistance;
+		if(!pcb.invoke(md, mFreeObjects[i]))
+			return false;
+
+		if(md < inOutDistance)
+			inOutDistance = md;
+	}
+
+	const PxU32 nb = mSortedNb;
+	if(!nb)
+		return true;
+
+#ifdef BRUTE_FORCE_LIMIT
+	if(nb<=BRUTE_FORCE_LIMIT)
+		return closestBucket(nb, mSortedWorldBoxes, mSortedObjects, point, inOutDistance, pcb);
+#endif
+
+	if(pointBucketBoxSquareDistance(point, mGlobalBox) > inOutDistance*inOutDistance)
+		return true;
+
+	PxU32 order1[5], order2[5], order3[5];
+	PxReal sqDists1[5], sqDists2[5], sqDists3[5];
+
+	const PxU32 nb1 = sortBuckets(mLevel1, point, inOutDistance, order1, sqDists1);
+	for(PxU32 a=0;a<nb1;a++)
+	{
+		if(sqDists1[a] > inOutDistance*inOutDistance)
+			break;
+		const PxU32 i = order1[a];
+
+		const PxU32 nb2 = sortBuckets(mLevel2[i], point, inOutDistance, order2, sqDists2);
+		for(PxU32 b=0;b<nb2;b++)
+		{
+			if(sqDists2[b] > inOutDistance*inOutDistance)
+				break;
+			const PxU32 j = order2[b];
+
+			const PxU32 nb3 = sortBuckets(mLevel3[i][j], point, inOutDistance, order3, sqDists3);
+			for(PxU32 c=0;c<nb3;c++)
+			{
+				if(sqDists3[c] > inOutDistance*inOutDistance)
+					break;
+				const PxU32 k = order3[c];
+
+				const PxU32 offset = mLevel1.mOffsets[i] + mLevel2[i].mOffsets[j] + mLevel3[i][j].mOffsets[k];
+				if(!closestBucket(mLevel3[i][j].mCounters[k], mSortedWorldBoxes + offset, mSortedObjects + offset, point, inOutDistance, pcb))
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 void BucketPrunerCore::shiftOrigin(const PxVec3& shift)
 {
 	for(PxU32 i=0;i<mNbFree;i++)
@@ -2273,6 +2489,22 @@ PxAgain BucketPruner::raycast(const PxVec3& origin, const PxVec3& unitDir, PxRea
 	return mCore.raycast(origin, unitDir, inOutDistance, pcb);
 }
 
+PxAgain BucketPruner::cull(const PlanesAABBTest& test, PrunerCullCallback& pcb) const
+{
+	PX_ASSERT(!mCore.mDirty);
+	if(mCore.mDirty)
+		return true; // it may crash otherwise
+	return mCore.cull(test, pcb);
+}
+
+PxAgain BucketPruner::closest(const PxVec3& point, PxReal& inOutDistance, PrunerCallback& pcb) const
+{
+	PX_ASSERT(!mCore.mDirty);
+	if(mCore.mDirty)
+		return true; // it may crash otherwise
+	return mCore.closest(point, inOutDistance, pcb);
+}
+
 void BucketPruner::visualize(Cm::RenderOutput& out, PxU32 color) const
 {
 	mCore.visualize(out, color);
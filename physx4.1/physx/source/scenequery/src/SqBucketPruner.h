@@ -195,6 +195,8 @@ namespace Sq
 						PxAgain				raycast(const PxVec3& origin, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback&) const;
 						PxAgain				overlap(const Gu::ShapeData& queryVolume, PrunerCallback&) const;
 						PxAgain				sweep(const Gu::ShapeData& queryVolume, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback&) const;
+						PxAgain				cull(const Gu::PlanesAABBTest& test, PrunerCullCallback&) const;
+						PxAgain				closest(const PxVec3& point, PxReal& inOutDistance, PrunerCallback&) const;
 
 						void				shiftOrigin(const PxVec3& shift);
 
@@ -258,6 +260,8 @@ namespace Sq
 		virtual	PxAgain					raycast(const PxVec3& origin, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback&) const;
 		virtual	PxAgain					overlap(const Gu::ShapeData& queryVolume, PrunerCallback&) const;
 		virtual	PxAgain					sweep(const Gu::ShapeData& queryVolume, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback&) const;
+		virtual	PxAgain					closest(const PxVec3& point, PxReal& inOutDistance, PrunerCallback&) const;
+		virtual	PxAgain					cull(const Gu::PlanesAABBTest& test, PrunerCullCallback&) const;
 		virtual	const PrunerPayload&	getPayload(PrunerHandle handle)						const	{ return mPool.getPayload(handle);			}
 		virtual	const PrunerPayload&	getPayload(PrunerHandle handle, PxBounds3*& bounds)	const	{ return mPool.getPayload(handle, bounds);	}
 		virtual	void					preallocate(PxU32 entries)									{ mPool.preallocate(entries);				}
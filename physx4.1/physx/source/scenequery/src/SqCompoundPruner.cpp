@@ -485,6 +485,49 @@ PxAgain BVHCompoundPruner::sweep(const Gu::ShapeData& queryVolume, const PxVec3&
 	return again;
 }
 
+//////////////////////////////////////////////////////////////////////////
+// cull main tree callback
+struct MainTreeCullCompoundPrunerCallback
+{
+	MainTreeCullCompoundPrunerCallback(const Gu::PlanesAABBTest& test, PrunerCullCallback& prunerCallback, PxQueryFlags flags)
+		: mTest(test), mPrunerCallback(prunerCallback), mQueryFlags(flags)
+	{
+	}
+
+	virtual ~MainTreeCullCompoundPrunerCallback() {}
+
+	virtual PxAgain invoke(const CompoundTree& compoundTree, bool inside)
+	{
+		if(!(compoundTree.mFlags & PxU32(mQueryFlags)) || !compoundTree.mTree->getNodes())
+			return true;
+
+		// all the objects are inside if the compound bounds are, otherwise cull the compound tree with the planes in actor local space
+		const Gu::PlanesAABBTest localTest(mTest, compoundTree.mGlobalPose);
+		return AABBTreeCull<IncrementalAABBTree, IncrementalAABBTreeNode, PrunerPayload, PrunerCullCallback>()
+			(compoundTree.mPruningPool->getObjects(), compoundTree.mPruningPool->getCurrentWorldBoxes(), *compoundTree.mTree, localTest, inside ? 0 : localTest.getAllPlanesMask(), mPrunerCallback);
+	}
+
+	PX_NOCOPY(MainTreeCullCompoundPrunerCallback)
+
+private:
+	const Gu::PlanesAABBTest&	mTest;
+	PrunerCullCallback&			mPrunerCallback;
+	PxQueryFlags				mQueryFlags;
+};
+
+PxAgain BVHCompoundPruner::cull(const Gu::PlanesAABBTest& test, PrunerCullCallback& prunerCallback, PxQueryFlags flags) const
+{
+	PxAgain again = true;
+
+	if(mMainTree.getNodes())
+	{
+		MainTreeCullCompoundPrunerCallback pcb(test, prunerCallback, flags);
+		again = AABBTreeCull<IncrementalAABBTree, IncrementalAABBTreeNode, CompoundTree, MainTreeCullCompoundPrunerCallback>()
+			(mCompoundTreePool.getCompoundTrees(), mCompoundTreePool.getCurrentCompoundBounds(), mMainTree, test, test.getAllPlanesMask(), pcb);
+	}
+	return again;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
 const PrunerPayload& BVHCompoundPruner::getPayload(PrunerHandle handle, PrunerCompoundId compoundId) const
@@ -71,6 +71,7 @@ namespace Sq
 		virtual	PxAgain						raycast(const PxVec3& origin, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback&, PxQueryFlags flags) const;
 		virtual	PxAgain						overlap(const Gu::ShapeData& queryVolume, PrunerCallback&, PxQueryFlags flags) const;
 		virtual	PxAgain						sweep(const Gu::ShapeData& queryVolume, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback&, PxQueryFlags flags) const;
+		virtual	PxAgain						cull(const Gu::PlanesAABBTest& test, PrunerCullCallback&, PxQueryFlags flags) const;
 		virtual const PrunerPayload&		getPayload(PrunerHandle handle, PrunerCompoundId compoundId) const;
 		virtual const PrunerPayload&		getPayload(PrunerHandle handle, PrunerCompoundId compoundId, PxBounds3*& bounds) const;
 		virtual void						shiftOrigin(const PxVec3& shift);
@@ -793,6 +793,94 @@ PxAgain ExtendedBucketPruner::sweep(const Gu::ShapeData& queryVolume, const PxVe
 }
 
 
+//////////////////////////////////////////////////////////////////////////
+// cull main tree callback
+struct MainTreeCullPrunerCallback : public PrunerCullCallback
+{
+	MainTreeCullPrunerCallback(const Gu::PlanesAABBTest& test, PrunerCullCallback& prunerCallback, const PruningPool* pool)
+		: mTest(test), mPrunerCallback(prunerCallback), mPruningPool(pool)
+	{
+	}
+
+	virtual PxAgain invoke(const PrunerPayload& payload, bool inside)
+	{
+		// payload data match merged tree data MergedTree, we can cast it
+		const AABBTree* aabbTree = reinterpret_cast<const AABBTree*> (payload.data[0]);
+		// cull the merged tree, all its objects are inside if its bounds are
+		return AABBTreeCull<AABBTree, AABBTreeRuntimeNode, PrunerPayload, PrunerCullCallback>()(mPruningPool->getObjects(), mPruningPool->getCurrentWorldBoxes(), *aabbTree, mTest, inside ? 0 : mTest.getAllPlanesMask(), mPrunerCallback);
+	}
+
+	PX_NOCOPY(MainTreeCullPrunerCallback)
+
+private:
+	const Gu::PlanesAABBTest&	mTest;
+	PrunerCullCallback&			mPrunerCallback;
+	const PruningPool*			mPruningPool;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// cull implementation
+PxAgain ExtendedBucketPruner::cull(const Gu::PlanesAABBTest& test, PrunerCullCallback& prunerCallback) const
+{
+	PxAgain again = true;
+
+	// core bucket pruner cull
+	if (mPrunerCore.getNbObjects())
+		again = mPrunerCore.cull(test, prunerCallback);
+
+	if(again && mExtendedBucketPrunerMap.size())
+	{
+		MainTreeCullPrunerCallback pcb(test, prunerCallback, mPruningPool);
+		again = AABBTreeCull<AABBTree, AABBTreeRuntimeNode, PrunerPayload, PrunerCullCallback>()(reinterpret_cast<const PrunerPayload*>(mMergedTrees), mBounds, *mMainTree, test, test.getAllPlanesMask(), pcb);
+	}
+	return again;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// closest main tree callback
+struct MainTreeClosestPrunerCallback : public PrunerCallback
+{
+	MainTreeClosestPrunerCallback(const PxVec3& point, PrunerCallback& prunerCallback, const PruningPool* pool)
+		: mPoint(point), mPrunerCallback(prunerCallback), mPruningPool(pool)
+	{
+	}
+
+	virtual PxAgain invoke(PxReal& distance, const PrunerPayload& payload)
+	{
+		// payload data match merged tree data MergedTree, we can cast it
+		const AABBTree* aabbTree = reinterpret_cast<const AABBTree*> (payload.data[0]);
+		// search the merged tree, shrinking the distance passed by the main tree
+		return AABBTreeClosest<AABBTree, AABBTreeRuntimeNode, PrunerPayload, PrunerCallback>()(mPruningPool->getObjects(), mPruningPool->getCurrentWorldBoxes(), *aabbTree, mPoint, distance, mPrunerCallback);
+	}
+
+	PX_NOCOPY(MainTreeClosestPrunerCallback)
+
+private:
+	const PxVec3&		mPoint;
+	PrunerCallback&		mPrunerCallback;
+	const PruningPool*	mPruningPool;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// closest implementation
+PxAgain ExtendedBucketPruner::closest(const PxVec3& point, PxReal& inOutDistance, PrunerCallback& prunerCallback) const
+{
+	PxAgain again = true;
+
+	// core bucket pruner closest
+	if (mPrunerCore.getNbObjects())
+		again = mPrunerCore.closest(point, inOutDistance, prunerCallback);
+
+	if(again && mExtendedBucketPrunerMap.size())
+	{
+		MainTreeClosestPrunerCallback pcb(point, prunerCallback, mPruningPool);
+		again = AABBTreeClosest<AABBTree, AABBTreeRuntimeNode, PrunerPayload, PrunerCallback>()(reinterpret_cast<const PrunerPayload*>(mMergedTrees), mBounds, *mMainTree, point, inOutDistance, pcb);
+	}
+	return again;
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 #include "CmRenderOutput.h"
 
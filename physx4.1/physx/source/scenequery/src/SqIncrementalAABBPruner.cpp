@@ -317,6 +317,26 @@ PxAgain IncrementalAABBPruner::raycast(const PxVec3& origin, const PxVec3& unitD
 	return again;
 }
 
+PxAgain IncrementalAABBPruner::closest(const PxVec3& point, PxReal& inOutDistance, PrunerCallback& pcb) const
+{
+	PxAgain again = true;
+
+	if(mAABBTree && mAABBTree->getNodes())
+		again = AABBTreeClosest<IncrementalAABBTree, IncrementalAABBTreeNode, PrunerPayload, PrunerCallback>()(mPool.getObjects(), mPool.getCurrentWorldBoxes(), *mAABBTree, point, inOutDistance, pcb);
+
+	return again;
+}
+
+PxAgain IncrementalAABBPruner::cull(const Gu::PlanesAABBTest& test, PrunerCullCallback& pcb) const
+{
+	PxAgain again = true;
+
+	if(mAABBTree && mAABBTree->getNodes())
+		again = AABBTreeCull<IncrementalAABBTree, IncrementalAABBTreeNode, PrunerPayload, PrunerCullCallback>()(mPool.getObjects(), mPool.getCurrentWorldBoxes(), *mAABBTree, test, test.getAllPlanesMask(), pcb);
+
+	return again;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  *	Other methods of Pruner Interface
@@ -367,6 +367,36 @@ PxAgain IncrementalAABBPrunerCore::raycast(const PxVec3& origin, const PxVec3& u
 	return again;
 }
 
+PxAgain IncrementalAABBPrunerCore::cull(const Gu::PlanesAABBTest& test, PrunerCullCallback& pcb) const
+{
+	PxAgain again = true;
+
+	for(PxU32 i = 0; i < NUM_TREES; i++)
+	{
+		const CoreTree& tree = mAABBTree[i];
+		if(tree.tree && tree.tree->getNodes() && again)
+		{
+			again = AABBTreeCull<IncrementalAABBTree, IncrementalAABBTreeNode, PrunerPayload, PrunerCullCallback>()(mPool->getObjects(), mPool->getCurrentWorldBoxes(), *tree.tree, test, test.getAllPlanesMask(), pcb);
+		}
+	}
+	return again;
+}
+
+PxAgain IncrementalAABBPrunerCore::closest(const PxVec3& point, PxReal& inOutDistance, PrunerCallback& pcb) const
+{
+	PxAgain again = true;
+
+	for(PxU32 i = 0; i < NUM_TREES; i++)
+	{
+		const CoreTree& tree = mAABBTree[i];
+		if(tree.tree && tree.tree->getNodes() && again)
+		{
+			again = AABBTreeClosest<IncrementalAABBTree, IncrementalAABBTreeNode, PrunerPayload, PrunerCallback>()(mPool->getObjects(), mPool->getCurrentWorldBoxes(), *tree.tree, point, inOutDistance, pcb);
+		}
+	}
+	return again;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void IncrementalAABBPrunerCore::shiftOrigin(const PxVec3& shift)
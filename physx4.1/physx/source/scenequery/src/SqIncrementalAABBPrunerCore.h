@@ -79,6 +79,8 @@ namespace Sq
 		PxAgain				raycast(const PxVec3& origin, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback&) const;
 		PxAgain				overlap(const Gu::ShapeData& queryVolume, PrunerCallback&) const;
 		PxAgain				sweep(const Gu::ShapeData& queryVolume, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback&) const;
+		PxAgain				cull(const Gu::PlanesAABBTest& test, PrunerCullCallback&) const;
+		PxAgain				closest(const PxVec3& point, PxReal& inOutDistance, PrunerCallback&) const;
 
 		void				shiftOrigin(const PxVec3& shift);
 
@@ -31,6 +31,7 @@
 #include "SqAABBPruner.h"
 #include "SqIncrementalAABBPruner.h"
 #include "SqBucketPruner.h"
+#include "SqWideAABBPruner.h"
 #include "SqPrunerMergeData.h"
 #include "SqBounds.h"
 #include "NpBatchQuery.h"
@@ -47,6 +48,7 @@
 #include "GuBounds.h"
 #include "NpShape.h"
 #include "common/PxProfileZone.h"
+#include "CmChunkedJob.h"
 
 using namespace physx;
 using namespace Sq;
@@ -83,6 +85,7 @@ void PrunerExt::init(PxPruningStructureType::Enum type, PxU64 contextID, PxU32 )
 		case PxPruningStructureType::eNONE:					{ pruner = PX_NEW(BucketPruner);					break;	}
 		case PxPruningStructureType::eDYNAMIC_AABB_TREE:	{ pruner = PX_NEW(AABBPruner)(true, contextID);		break;	}
 		case PxPruningStructureType::eSTATIC_AABB_TREE:		{ pruner = PX_NEW(AABBPruner)(false, contextID);	break;	}
+		case PxPruningStructureType::eWIDE_AABB_TREE:		{ pruner = PX_NEW(WideAABBPruner)(contextID);		break;	}
 		case PxPruningStructureType::eLAST:					break;
 	}
 	mPruner = pruner;
@@ -253,7 +256,9 @@ void CompoundPrunerExt::removeFromDirtyList(PrunerCompoundId compoundId, PrunerH
 SceneQueryManager::SceneQueryManager(	Scb::Scene& scene, PxPruningStructureType::Enum staticStructure, 
 										PxPruningStructureType::Enum dynamicStructure, PxU32 dynamicTreeRebuildRateHint,
 										const PxSceneLimits& limits) :
-	mScene			(scene)	
+	mRebuildTimeBudget	(0),
+	mTimedBuildJob		(NULL),
+	mScene				(scene)
 {
 	mPrunerExt[PruningIndex::eSTATIC].init(staticStructure, scene.getContextId(), limits.maxNbStaticShapes ? limits.maxNbStaticShapes : 1024);
 	mPrunerExt[PruningIndex::eDYNAMIC].init(dynamicStructure, scene.getContextId(), limits.maxNbDynamicShapes ? limits.maxNbDynamicShapes : 1024);
@@ -273,6 +278,7 @@ SceneQueryManager::SceneQueryManager(	Scb::Scene& scene, PxPruningStructureType:
 
 SceneQueryManager::~SceneQueryManager()
 {
+	waitTimedBuild();
 }
 
 void SceneQueryManager::flushMemory()
@@ -359,6 +365,9 @@ const PrunerPayload& SceneQueryManager::getPayload(PrunerCompoundId compoundId,
 
 void SceneQueryManager::removePrunerShape(PrunerCompoundId compoundId, PrunerData data)
 {
+	// PT: removing the last object of a pruner releases its trees
+	waitTimedBuild();
+
 	mPrunerNeedsUpdating = true;
 	const PxU32 index = getPrunerIndex(data);
 	const PrunerHandle handle = getPrunerHandle(data);
@@ -390,10 +399,83 @@ void SceneQueryManager::setDynamicTreeRebuildRateHint(PxU32 rebuildRateHint)
 	}
 }
 
+void SceneQueryManager::setDynamicTreeRebuildTimeBudget(PxU32 budget)
+{
+	waitTimedBuild();
+
+	mRebuildTimeBudget = budget;
+
+	for(PxU32 i=0;i<PruningIndex::eCOUNT;i++)
+	{
+		if(mPrunerExt[i].pruner() && mPrunerExt[i].type() == PxPruningStructureType::eDYNAMIC_AABB_TREE)
+			static_cast<AABBPruner*>(mPrunerExt[i].pruner())->setRebuildTimeBudget(budget);
+	}
+}
+
+namespace
+{
+	// Runs the timed build step of the dynamic trees being rebuilt, one tree per chunk
+	class TimedBuildJob : public Cm::ChunkedJob
+	{
+	public:
+		TimedBuildJob(AABBPruner* const* pruners, PxU32 nbPruners) : Cm::ChunkedJob(nbPruners, 1)
+		{
+			for(PxU32 i=0;i<nbPruners;i++)
+				mPruners[i] = pruners[i];
+		}
+
+		virtual	void	process(PxU32 start, PxU32 end)
+		{
+			for(PxU32 i=start;i<end;i++)
+				mPruners[i]->timedBuildStep();
+		}
+	private:
+		AABBPruner*	mPruners[PruningIndex::eCOUNT];
+	};
+}
+
+void SceneQueryManager::startTimedBuild(PxCpuDispatcher* dispatcher)
+{
+	if(!mRebuildTimeBudget || mTimedBuildJob)
+		return;
+
+	AABBPruner* pruners[PruningIndex::eCOUNT];
+	PxU32 nbPruners = 0;
+	for(PxU32 i=0;i<PruningIndex::eCOUNT;i++)
+	{
+		if(mPrunerExt[i].pruner() && mPrunerExt[i].type() == PxPruningStructureType::eDYNAMIC_AABB_TREE)
+		{
+			AABBPruner* pruner = static_cast<AABBPruner*>(mPrunerExt[i].pruner());
+			if(pruner->needsTimedBuildStep())
+				pruners[nbPruners++] = pruner;
+		}
+	}
+	if(!nbPruners)
+		return;
+
+	// PT: without worker threads the build runs in waitTimedBuild(), still within the budget
+	mTimedBuildJob = PX_NEW(TimedBuildJob)(pruners, nbPruners);
+	mTimedBuildJob->start(dispatcher);
+}
+
+void SceneQueryManager::waitTimedBuild()
+{
+	if(!mTimedBuildJob)
+		return;
+
+	PX_PROFILE_ZONE("SceneQuery.waitTimedBuild", mScene.getContextId());
+
+	mTimedBuildJob->wait();
+	mTimedBuildJob->releaseRef();
+	mTimedBuildJob = NULL;
+}
+
 void SceneQueryManager::afterSync(PxSceneQueryUpdateMode::Enum updateMode)
 {
 	PX_PROFILE_ZONE("Sim.sceneQueryBuildStep", mScene.getContextId());
 
+	waitTimedBuild();
+
 	if(updateMode == PxSceneQueryUpdateMode::eBUILD_DISABLED_COMMIT_DISABLED)
 	{
 		mPrunerNeedsUpdating = true;
@@ -461,6 +543,8 @@ void SceneQueryManager::forceDynamicTreeRebuild(bool rebuildStaticStructure, boo
 
 	const bool rebuild[PruningIndex::eCOUNT] = { rebuildStaticStructure, rebuildDynamicStructure };
 
+	waitTimedBuild();
+
 	Ps::Mutex::ScopedLock lock(mSceneQueryLock);
 	for(PxU32 i=0; i<PruningIndex::eCOUNT; i++)
 	{
@@ -488,6 +572,8 @@ void SceneQueryManager::sceneQueryBuildStep(PruningIndex::Enum index)
 
 bool SceneQueryManager::prepareSceneQueriesUpdate(PruningIndex::Enum index)
 {
+	waitTimedBuild();
+
 	bool retVal = false;
 	if (mPrunerExt[index].pruner() && mPrunerExt[index].type() == PxPruningStructureType::eDYNAMIC_AABB_TREE)
 	{
@@ -498,6 +584,8 @@ bool SceneQueryManager::prepareSceneQueriesUpdate(PruningIndex::Enum index)
 
 void SceneQueryManager::shiftOrigin(const PxVec3& shift)
 {
+	waitTimedBuild();
+
 	for(PxU32 i=0; i<PruningIndex::eCOUNT; i++)
 		mPrunerExt[i].pruner()->shiftOrigin(shift);
 
@@ -0,0 +1,1038 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+
+#include "common/PxProfileZone.h"
+#include "PsBitUtils.h"
+#include "PsFoundation.h"
+#include "SqWideAABBPruner.h"
+#include "GuSphere.h"
+#include "GuCapsule.h"
+#include "GuAABBTreeQuery.h"
+#include "GuBounds.h"
+#include "CmRenderOutput.h"
+
+using namespace physx;
+using namespace Gu;
+using namespace Sq;
+
+WideAABBPruner::WideAABBPruner(PxU64 contextID) :
+	mContextID			(contextID),
+	mUncommittedChanges	(false),
+	mNeedsRebuild		(false),
+	mNeedsRefit			(false)
+{
+}
+
+WideAABBPruner::~WideAABBPruner()
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Add, Remove, Update methods
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool WideAABBPruner::addObjects(PrunerHandle* results, const PxBounds3* bounds, const PrunerPayload* payload, PxU32 count, bool)
+{
+	PX_PROFILE_ZONE("SceneQuery.prunerAddObjects", mContextID);
+
+	if(!count)
+		return true;
+
+	// PT: pruning structures are not merged, the tree is rebuilt with the new objects instead
+	mUncommittedChanges = true;
+	mNeedsRebuild = true;
+
+	const PxU32 valid = mPool.addObjects(results, bounds, payload, count);
+	return valid==count;
+}
+
+void WideAABBPruner::removeObjects(const PrunerHandle* handles, PxU32 count)
+{
+	PX_PROFILE_ZONE("SceneQuery.prunerRemoveObjects", mContextID);
+
+	if(!count)
+		return;
+
+	mUncommittedChanges = true;
+	mNeedsRebuild = true;
+
+	for(PxU32 i=0; i<count; i++)
+		mPool.removeObject(handles[i]);
+}
+
+void WideAABBPruner::updateObjectsAfterManualBoundsUpdates(const PrunerHandle*, PxU32 count)
+{
+	if(!count)
+		return;
+
+	mUncommittedChanges = true;
+	mNeedsRefit = true;
+}
+
+void WideAABBPruner::updateObjectsAndInflateBounds(const PrunerHandle* handles, const PxU32* indices, const PxBounds3* newBounds, PxU32 count)
+{
+	PX_PROFILE_ZONE("SceneQuery.prunerUpdateObjects", mContextID);
+
+	if(!count)
+		return;
+
+	mUncommittedChanges = true;
+	mNeedsRefit = true;
+
+	mPool.updateObjectsAndInflateBounds(handles, indices, newBounds, count);
+}
+
+void WideAABBPruner::commit()
+{
+	PX_PROFILE_ZONE("SceneQuery.prunerCommit", mContextID);
+
+	if(!mUncommittedChanges)
+		return;
+
+	mUncommittedChanges = false;
+
+	const PxU32 nbObjects = mPool.getNbActiveObjects();
+	if(mNeedsRebuild)
+	{
+		PX_PROFILE_ZONE("SceneQuery.prunerBuildWideAABBTree", mContextID);
+
+		if(nbObjects)
+			mTree.build(mPool.getCurrentWorldBoxes(), nbObjects);
+		else
+			mTree.release();
+	}
+	else if(mNeedsRefit)
+	{
+		PX_PROFILE_ZONE("SceneQuery.prunerRefitWideAABBTree", mContextID);
+
+		mTree.refit(mPool.getCurrentWorldBoxes());
+	}
+
+	mNeedsRebuild = false;
+	mNeedsRefit = false;
+}
+
+void WideAABBPruner::merge(const void*)
+{
+	// PT: nothing to do, the objects from the pruning structure have already been added to the pool and the
+	// tree will be rebuilt in the next commit.
+}
+
+void WideAABBPruner::shiftOrigin(const PxVec3& shift)
+{
+	mPool.shiftOrigin(shift);
+
+	// PT: refit instead of shifting the nodes' offsets, to make sure the quantized bounds remain conservative
+	if(mTree.getNbNodes())
+		mTree.refit(mPool.getCurrentWorldBoxes());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Query Implementation
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// PT: masks out the unused children of a node
+static const PxU32 gValidChildrenMask[SQ_WIDE_TREE_NB_CHILDREN+1] = { 0, 1, 3, 7, 15 };
+
+namespace
+{
+	// PT: box-vs-4-boxes test. Used as-is for AABB overlaps, and as a pre-test for the other shapes.
+	struct WideAABBTest
+	{
+		WideAABBTest(const PxBounds3& bounds) :
+			mMinX(V4Load(bounds.minimum.x)), mMinY(V4Load(bounds.minimum.y)), mMinZ(V4Load(bounds.minimum.z)),
+			mMaxX(V4Load(bounds.maximum.x)), mMaxY(V4Load(bounds.maximum.y)), mMaxZ(V4Load(bounds.maximum.z))
+		{
+		}
+
+		PX_FORCE_INLINE	PxU32	operator()(const Vec4V* PX_RESTRICT bounds)	const
+		{
+			const BoolV x = BAnd(V4IsGrtrOrEq(mMaxX, bounds[0]), V4IsGrtrOrEq(bounds[3], mMinX));
+			const BoolV y = BAnd(V4IsGrtrOrEq(mMaxY, bounds[1]), V4IsGrtrOrEq(bounds[4], mMinY));
+			const BoolV z = BAnd(V4IsGrtrOrEq(mMaxZ, bounds[2]), V4IsGrtrOrEq(bounds[5], mMinZ));
+			return BGetBitMask(BAnd(BAnd(x, y), z));
+		}
+
+		const Vec4V	mMinX, mMinY, mMinZ;
+		const Vec4V	mMaxX, mMaxY, mMaxZ;
+		PX_NOCOPY(WideAABBTest)
+	};
+
+	// PT: sphere-vs-4-boxes test
+	struct WideSphereTest
+	{
+		WideSphereTest(const PxVec3& center, PxReal radius) :
+			mCenterX(V4Load(center.x)), mCenterY(V4Load(center.y)), mCenterZ(V4Load(center.z)),
+			mRadius2(V4Load(radius*radius))
+		{
+		}
+
+		PX_FORCE_INLINE	PxU32	operator()(const Vec4V* PX_RESTRICT bounds)	const
+		{
+			const Vec4V zero = V4Zero();
+			const Vec4V dx = V4Max(V4Max(V4Sub(bounds[0], mCenterX), V4Sub(mCenterX, bounds[3])), zero);
+			const Vec4V dy = V4Max(V4Max(V4Sub(bounds[1], mCenterY), V4Sub(mCenterY, bounds[4])), zero);
+			const Vec4V dz = V4Max(V4Max(V4Sub(bounds[2], mCenterZ), V4Sub(mCenterZ, bounds[5])), zero);
+			const Vec4V d2 = V4MulAdd(dz, dz, V4MulAdd(dy, dy, V4Mul(dx, dx)));
+			return BGetBitMask(V4IsGrtrOrEq(mRadius2, d2));
+		}
+
+		const Vec4V	mCenterX, mCenterY, mCenterZ;
+		const Vec4V	mRadius2;
+		PX_NOCOPY(WideSphereTest)
+	};
+
+	// PT: for shapes without a dedicated SIMD test (OBBs, capsules, convexes), the children are first tested against the
+	// query's AABB. The regular test is then only called on the children passing this pre-test.
+	template<class Test>
+	struct WideRefinedTest
+	{
+		WideRefinedTest(const PxBounds3& bounds, const Test& test) : mAABBTest(fatten(bounds)), mTest(test)
+		{
+		}
+
+		// PT: the regular tests are slightly conservative (e.g. OBB tests add an epsilon to the rotation matrix), so the
+		// pre-test must be as well. Otherwise we could cull objects that the binary tree traversal would report.
+		static PX_FORCE_INLINE PxBounds3 fatten(const PxBounds3& bounds)
+		{
+			const PxVec3 extents = bounds.getExtents();
+			PxBounds3 fattened = bounds;
+			fattened.fattenFast((extents.x + extents.y + extents.z) * 1e-5f);
+			return fattened;
+		}
+
+		PX_FORCE_INLINE	PxU32	operator()(const Vec4V* PX_RESTRICT bounds)	const
+		{
+			PxU32 mask = mAABBTest(bounds);
+			if(!mask)
+				return 0;
+
+			const FloatV half = FHalf();
+			PX_ALIGN(16, PxVec4) center[3];
+			PX_ALIGN(16, PxVec4) extents[3];
+			for(PxU32 i=0; i<3; i++)
+			{
+				V4StoreA(V4Scale(V4Add(bounds[i+3], bounds[i]), half), &center[i].x);
+				V4StoreA(V4Scale(V4Sub(bounds[i+3], bounds[i]), half), &extents[i].x);
+			}
+
+			PxU32 result = 0;
+			while(mask)
+			{
+				const PxU32 j = Ps::lowestSetBit(mask);
+				mask &= mask - 1;
+				const Vec3V c = V3LoadU(PxVec3(center[0][j], center[1][j], center[2][j]));
+				const Vec3V e = V3LoadU(PxVec3(extents[0][j], extents[1][j], extents[2][j]));
+				if(mTest(c, e))
+					result |= 1<<j;
+			}
+			return result;
+		}
+
+		const WideAABBTest	mAABBTest;
+		const Test&			mTest;
+		PX_NOCOPY(WideRefinedTest)
+	};
+
+	struct WideStackEntry
+	{
+		PxU32	mData;		// child data, i.e. leaf or node index
+		PxReal	mDistance;	// entry distance along the ray, for ray & sweep queries
+	};
+}
+
+// PT: same exact test as in the binary tree traversal, so that both trees report the same objects
+template<class LeafTest>
+static PX_FORCE_INLINE bool overlapLeaf(PxU32 data, const WideAABBTree& tree, const PrunerPayload* objects, const PxBounds3* boxes, const LeafTest& test, PrunerCallback& pcb)
+{
+	const FloatV halfV = FHalf();
+	PxU32 nbPrims = getWideNbPrimitives(data);
+	const PxU32* prims = getWidePrimitives(data, tree.getIndices());
+	while(nbPrims--)
+	{
+		const PxU32 poolIndex = *prims++;
+
+		Vec4V center2, extents2;
+		getBoundsTimesTwo(center2, extents2, boxes, poolIndex);
+		if(!test(Vec3V_From_Vec4V(V4Scale(center2, halfV)), Vec3V_From_Vec4V(V4Scale(extents2, halfV))))
+			continue;
+
+		PxReal unusedDistance;
+		if(!pcb.invoke(unusedDistance, objects[poolIndex]))
+			return false;
+	}
+	return true;
+}
+
+template<class NodeTest, class LeafTest>
+static PxAgain overlapWideTree(const WideAABBTree& tree, const PrunerPayload* objects, const PxBounds3* boxes, const NodeTest& nodeTest, const LeafTest& leafTest, PrunerCallback& pcb)
+{
+	const WideAABBTreeNode* PX_RESTRICT nodes = tree.getNodes();
+	const VecShiftV shift16 = VecI32V_PrepareShift(I4Load(16));
+
+	Ps::InlineArray<PxU32, RAW_TRAVERSAL_STACK_SIZE> stack;
+	stack.forceSize_Unsafe(RAW_TRAVERSAL_STACK_SIZE);
+	stack[0] = 0;	// PT: root node
+	PxU32 stackIndex = 1;
+
+	while(stackIndex--)
+	{
+		const PxU32 data = stack[stackIndex];
+		if(isWideLeaf(data))
+		{
+			if(!overlapLeaf(data, tree, objects, boxes, leafTest, pcb))
+				return false;
+			continue;
+		}
+
+		const WideAABBTreeNode& node = nodes[getWideNodeIndex(data)];
+
+		Vec4V bounds[6];
+		node.getChildrenBounds(bounds, shift16);
+
+		PxU32 mask = nodeTest(bounds) & gValidChildrenMask[node.getNbChildren()];
+
+		if(stackIndex + SQ_WIDE_TREE_NB_CHILDREN > stack.capacity())
+			stack.resizeUninitialized(stack.capacity() * 2);
+
+		while(mask)
+		{
+			const PxU32 j = Ps::lowestSetBit(mask);
+			mask &= mask - 1;
+			stack[stackIndex++] = node.getChildData(j);
+		}
+	}
+	return true;
+}
+
+namespace
+{
+	struct WideCullStackEntry
+	{
+		PxU32	mData;		// child data, i.e. leaf or node index
+		PxU32	mPlaneMask;	// planes crossed by the parent, 0 if the parent is fully inside the plane set
+	};
+}
+
+// PT: classifies the 4 children of a node against the planes in planeMask, one plane at a time. Returns the mask of
+// visible children, and the planes each of them still crosses.
+static PX_FORCE_INLINE PxU32 cullChildren(const Vec4V* PX_RESTRICT bounds, const PlanesAABBTest& test, PxU32 planeMask, PxU32* PX_RESTRICT childMasks)
+{
+	for(PxU32 j=0; j<SQ_WIDE_TREE_NB_CHILDREN; j++)
+		childMasks[j] = 0;
+
+	const FloatV half = FHalf();
+	const Vec4V cx = V4Scale(V4Add(bounds[3], bounds[0]), half);
+	const Vec4V cy = V4Scale(V4Add(bounds[4], bounds[1]), half);
+	const Vec4V cz = V4Scale(V4Add(bounds[5], bounds[2]), half);
+	const Vec4V ex = V4Scale(V4Sub(bounds[3], bounds[0]), half);
+	const Vec4V ey = V4Scale(V4Sub(bounds[4], bounds[1]), half);
+	const Vec4V ez = V4Scale(V4Sub(bounds[5], bounds[2]), half);
+	const Vec4V zero = V4Zero();
+
+	PxU32 outside = 0;
+	while(planeMask)
+	{
+		const PxU32 i = Ps::lowestSetBit(planeMask);
+		planeMask &= planeMask - 1;
+
+		const Vec4V dist = V4MulAdd(V4Load(test.mNz[i]), cz, V4MulAdd(V4Load(test.mNy[i]), cy, V4MulAdd(V4Load(test.mNx[i]), cx, V4Load(test.mD[i]))));
+		const Vec4V rad = V4MulAdd(V4Load(test.mAbsNz[i]), ez, V4MulAdd(V4Load(test.mAbsNy[i]), ey, V4Mul(V4Load(test.mAbsNx[i]), ex)));
+
+		outside |= BGetBitMask(V4IsGrtr(V4Sub(dist, rad), zero));
+		PxU32 crossing = BGetBitMask(V4IsGrtr(V4Add(dist, rad), zero));
+		while(crossing)
+		{
+			const PxU32 j = Ps::lowestSetBit(crossing);
+			crossing &= crossing - 1;
+			childMasks[j] |= 1<<i;
+		}
+	}
+	return ~outside & 15;
+}
+
+static PxAgain cullWideTree(const WideAABBTree& tree, const PrunerPayload* objects, const PxBounds3* boxes, const PlanesAABBTest& test, PrunerCullCallback& pcb)
+{
+	const WideAABBTreeNode* PX_RESTRICT nodes = tree.getNodes();
+	const VecShiftV shift16 = VecI32V_PrepareShift(I4Load(16));
+	const FloatV halfV = FHalf();
+
+	Ps::InlineArray<WideCullStackEntry, RAW_TRAVERSAL_STACK_SIZE> stack;
+	stack.forceSize_Unsafe(RAW_TRAVERSAL_STACK_SIZE);
+	stack[0].mData = 0;	// PT: root node
+	stack[0].mPlaneMask = test.getAllPlanesMask();
+	PxU32 stackIndex = 1;
+
+	while(stackIndex--)
+	{
+		const PxU32 data = stack[stackIndex].mData;
+		const PxU32 planeMask = stack[stackIndex].mPlaneMask;
+		if(isWideLeaf(data))
+		{
+			PxU32 nbPrims = getWideNbPrimitives(data);
+			const PxU32* prims = getWidePrimitives(data, tree.getIndices());
+			while(nbPrims--)
+			{
+				const PxU32 poolIndex = *prims++;
+
+				PxU32 primMask = planeMask;
+				if(primMask)
+				{
+					Vec4V center2, extents2;
+					getBoundsTimesTwo(center2, extents2, boxes, poolIndex);
+					if(!test.classify(Vec3V_From_Vec4V(V4Scale(center2, halfV)), Vec3V_From_Vec4V(V4Scale(extents2, halfV)), primMask))
+						continue;
+				}
+
+				if(!pcb.invoke(objects[poolIndex], primMask==0))
+					return false;
+			}
+			continue;
+		}
+
+		const WideAABBTreeNode& node = nodes[getWideNodeIndex(data)];
+		PxU32 mask = gValidChildrenMask[node.getNbChildren()];
+
+		// PT: children of a node fully inside the plane set are pushed without being tested
+		PxU32 childMasks[SQ_WIDE_TREE_NB_CHILDREN] = { 0, 0, 0, 0 };
+		if(planeMask)
+		{
+			Vec4V bounds[6];
+			node.getChildrenBounds(bounds, shift16);
+			mask &= cullChildren(bounds, test, planeMask, childMasks);
+		}
+
+		if(stackIndex + SQ_WIDE_TREE_NB_CHILDREN > stack.capacity())
+			stack.resizeUninitialized(stack.capacity() * 2);
+
+		while(mask)
+		{
+			const PxU32 j = Ps::lowestSetBit(mask);
+			mask &= mask - 1;
+			stack[stackIndex].mData = node.getChildData(j);
+			stack[stackIndex].mPlaneMask = childMasks[j];
+			stackIndex++;
+		}
+	}
+	return true;
+}
+
+template<bool tInflate>	// use inflate=true for sweeps, inflate=false for raycasts
+static PxAgain raycastWideTree(const WideAABBTree& tree, const PrunerPayload* objects, const PxBounds3* boxes,
+	const PxVec3& origin, const PxVec3& unitDir, PxReal& maxDist, const PxVec3& inflation, PrunerCallback& pcb)
+{
+	// PT: leaves use the same exact test as the binary tree traversal, with center*2 and extents*2
+	Gu::RayAABBTest test(origin*2.0f, unitDir*2.0f, maxDist, inflation*2.0f);
+
+	// PT: slab test setup. The direction is clamped away from zero to avoid NaNs, as in the BV4 slab code.
+	PxVec3 invDir;
+	for(PxU32 i=0; i<3; i++)
+	{
+		const PxReal eps = 1e-9f;
+		const PxReal d = unitDir[i];
+		invDir[i] = 1.0f / (PxAbs(d) > eps ? d : (d < 0.0f ? -eps : eps));
+	}
+	const Vec4V originV = V4LoadXYZW(origin.x, origin.y, origin.z, 0.0f);
+	const Vec4V invDirV = V4LoadXYZW(invDir.x, invDir.y, invDir.z, 0.0f);
+	const Vec4V inflationV = V4LoadXYZW(inflation.x, inflation.y, inflation.z, 0.0f);
+	const Vec4V zero = V4Zero();
+	const FloatV slabEpsilon = FLoad(1e-6f);
+	Vec4V maxT = V4Load(maxDist);
+
+	const WideAABBTreeNode* PX_RESTRICT nodes = tree.getNodes();
+	const VecShiftV shift16 = VecI32V_PrepareShift(I4Load(16));
+	const VecU32V keyMask = U4Load(~3u);
+	const VecU32V allOnes = U4Load(0xffffffff);
+	const VecU32V childIndices = U4LoadXYZW(0, 1, 2, 3);
+	const BoolV validChildren[SQ_WIDE_TREE_NB_CHILDREN+1] = { BFFFF(), BTFFF(), BTTFF(), BTTTF(), BTTTT() };
+
+	Ps::InlineArray<WideStackEntry, RAW_TRAVERSAL_STACK_SIZE> stack;
+	stack.forceSize_Unsafe(RAW_TRAVERSAL_STACK_SIZE);
+	stack[0].mData = 0;	// PT: root node
+	stack[0].mDistance = 0.0f;
+	PxU32 stackIndex = 1;
+
+	while(stackIndex--)
+	{
+		const WideStackEntry entry = stack[stackIndex];
+
+		// PT: skip entries further than the closest hit found after they were pushed
+		if(entry.mDistance > maxDist)
+			continue;
+
+		if(isWideLeaf(entry.mData))
+		{
+			PxReal md = maxDist;
+			const PxReal oldMaxDist = maxDist; // we copy since maxDist can be updated in the callback and md<maxDist test below can fail
+
+			PxU32 nbPrims = getWideNbPrimitives(entry.mData);
+			const PxU32* prims = getWidePrimitives(entry.mData, tree.getIndices());
+			while(nbPrims--)
+			{
+				const PxU32 poolIndex = *prims++;
+
+				Vec4V center2, extents2;
+				getBoundsTimesTwo(center2, extents2, boxes, poolIndex);
+				if(!test.check<tInflate>(Vec3V_From_Vec4V(center2), Vec3V_From_Vec4V(extents2)))
+					continue;
+
+				if(!pcb.invoke(md, objects[poolIndex]))
+					return false;
+
+				if(md < oldMaxDist)
+				{
+					maxDist = md;
+					test.setDistance(md);
+				}
+			}
+			maxT = V4Load(maxDist);
+			continue;
+		}
+
+		const WideAABBTreeNode& node = nodes[getWideNodeIndex(entry.mData)];
+
+		// PT: the slab test runs on the dequantized bounds, i.e. on exactly the conservative boxes the build produced.
+		// Folding the dequantization into the ray parameters would round differently and could reject grazing rays.
+		Vec4V bounds[6];
+		node.getChildrenBounds(bounds, shift16);
+		if(tInflate)
+		{
+			bounds[0] = V4Sub(bounds[0], V4SplatElement<0>(inflationV));
+			bounds[1] = V4Sub(bounds[1], V4SplatElement<1>(inflationV));
+			bounds[2] = V4Sub(bounds[2], V4SplatElement<2>(inflationV));
+			bounds[3] = V4Add(bounds[3], V4SplatElement<0>(inflationV));
+			bounds[4] = V4Add(bounds[4], V4SplatElement<1>(inflationV));
+			bounds[5] = V4Add(bounds[5], V4SplatElement<2>(inflationV));
+		}
+
+		// PT: 4 slab tests at once
+		const Vec4V ox = V4SplatElement<0>(originV);
+		const Vec4V oy = V4SplatElement<1>(originV);
+		const Vec4V oz = V4SplatElement<2>(originV);
+		const Vec4V idx = V4SplatElement<0>(invDirV);
+		const Vec4V idy = V4SplatElement<1>(invDirV);
+		const Vec4V idz = V4SplatElement<2>(invDirV);
+		const Vec4V tx0 = V4Mul(V4Sub(bounds[0], ox), idx);
+		const Vec4V ty0 = V4Mul(V4Sub(bounds[1], oy), idy);
+		const Vec4V tz0 = V4Mul(V4Sub(bounds[2], oz), idz);
+		const Vec4V tx1 = V4Mul(V4Sub(bounds[3], ox), idx);
+		const Vec4V ty1 = V4Mul(V4Sub(bounds[4], oy), idy);
+		const Vec4V tz1 = V4Mul(V4Sub(bounds[5], oz), idz);
+		const Vec4V tMin = V4Max(V4Max(V4Min(tx0, tx1), V4Min(ty0, ty1)), V4Max(V4Min(tz0, tz1), zero));
+		const Vec4V tMax = V4Min(V4Min(V4Max(tx0, tx1), V4Max(ty0, ty1)), V4Min(V4Max(tz0, tz1), maxT));
+
+		// PT: widen the interval by a few ulps, to absorb the rounding of the slab distances themselves. Nodes are only
+		// culled here, the leaves still run the exact test.
+		const Vec4V tNear = V4Max(V4NegScaleSub(V4Abs(tMin), slabEpsilon, tMin), zero);
+		const Vec4V tFar = V4ScaleAdd(V4Abs(tMax), slabEpsilon, tMax);
+		const BoolV hits = BAnd(V4IsGrtrOrEq(tFar, tNear), validChildren[node.getNbChildren()]);
+		const PxU32 nbHits = Ps::bitCount(BGetBitMask(hits));
+		if(!nbHits)
+			continue;
+
+		// PT: tNear is positive so its bits sort like integers. The child index goes in the 2 lowest bits, and missed
+		// children get the largest key so that they end up last. The keys are then sorted with a small sorting network.
+		PX_ALIGN(16, PxU32) keys[4];
+		{
+			const VecU32V bits = V4U32or(V4U32and(VecU32V_ReinterpretFrom_Vec4V(tNear), keyMask), childIndices);
+			U4StoreA(V4U32Sel(hits, bits, allOnes), keys);
+		}
+#define SQ_WIDE_SORT2(i, j)	{ const PxU32 k0 = keys[i]; const PxU32 k1 = keys[j]; keys[i] = PxMin(k0, k1); keys[j] = PxMax(k0, k1); }
+		SQ_WIDE_SORT2(0, 1)
+		SQ_WIDE_SORT2(2, 3)
+		SQ_WIDE_SORT2(0, 2)
+		SQ_WIDE_SORT2(1, 3)
+		SQ_WIDE_SORT2(1, 2)
+#undef SQ_WIDE_SORT2
+
+		if(stackIndex + SQ_WIDE_TREE_NB_CHILDREN > stack.capacity())
+			stack.resizeUninitialized(stack.capacity() * 2);
+
+		// PT: push by decreasing entry distance, so that the closest child ends up on top of the stack. The distances stored
+		// here are the keys with the index bits cleared, i.e. slightly smaller than the actual entry distances.
+		for(PxU32 k=nbHits; k--;)
+		{
+			const PxU32 key = keys[k];
+			const PxU32 distanceBits = key & ~3u;
+			stack[stackIndex].mData = node.getChildData(key & 3);
+			stack[stackIndex].mDistance = reinterpret_cast<const PxReal&>(distanceBits);
+			stackIndex++;
+		}
+	}
+	return true;
+}
+
+namespace
+{
+	struct WidePacketStackEntry
+	{
+		PxU32	mData;		// child data, i.e. leaf or node index
+		PxU32	mRayMask;	// rays of the packet touching the child
+	};
+}
+
+// PT: packet version of raycastWideTree<false>. A node is fetched and dequantized once for all the rays that reached it,
+// then each ray runs the same slab test as in raycastWideTree, and leaves run the same exact test. Children are pushed by
+// decreasing entry distance of the closest ray touching them, so objects can be visited in another order than with a
+// single ray. The returned mask contains the input rays whose callback didn't stop the query.
+static PxU32 raycastPacketWideTree(const WideAABBTree& tree, const PrunerPayload* objects, const PxBounds3* boxes,
+	PxU32 nbRays, const PxVec3* origins, const PxVec3* unitDirs, PxReal* maxDists, PxU32 activeRays, PrunerPacketCallback& pcb)
+{
+	PX_ASSERT(nbRays<=SQ_MAX_RAY_PACKET_SIZE);
+
+	// PT: leaves use the same exact test as the binary tree traversal, with center*2 and extents*2
+	PxVec3 origins2[SQ_MAX_RAY_PACKET_SIZE];
+	PxVec3 unitDirs2[SQ_MAX_RAY_PACKET_SIZE];
+	Vec4V originsV[SQ_MAX_RAY_PACKET_SIZE];
+	Vec4V invDirsV[SQ_MAX_RAY_PACKET_SIZE];
+	for(PxU32 i=0; i<nbRays; i++)
+	{
+		origins2[i] = origins[i]*2.0f;
+		unitDirs2[i] = unitDirs[i]*2.0f;
+
+		// PT: same slab test setup as in raycastWideTree
+		PxVec3 invDir;
+		for(PxU32 j=0; j<3; j++)
+		{
+			const PxReal eps = 1e-9f;
+			const PxReal d = unitDirs[i][j];
+			invDir[j] = 1.0f / (PxAbs(d) > eps ? d : (d < 0.0f ? -eps : eps));
+		}
+		originsV[i] = V4LoadXYZW(origins[i].x, origins[i].y, origins[i].z, 0.0f);
+		invDirsV[i] = V4LoadXYZW(invDir.x, invDir.y, invDir.z, 0.0f);
+	}
+	RayPacketAABBTest test(nbRays, origins2, unitDirs2, maxDists);
+
+	const Vec4V zero = V4Zero();
+	const Vec4V noHit = V4Load(PX_MAX_F32);
+	const FloatV slabEpsilon = FLoad(1e-6f);
+
+	const WideAABBTreeNode* PX_RESTRICT nodes = tree.getNodes();
+	const VecShiftV shift16 = VecI32V_PrepareShift(I4Load(16));
+
+	Ps::InlineArray<WidePacketStackEntry, RAW_TRAVERSAL_STACK_SIZE> stack;
+	stack.forceSize_Unsafe(RAW_TRAVERSAL_STACK_SIZE);
+	stack[0].mData = 0;	// PT: root node
+	stack[0].mRayMask = activeRays;
+	PxU32 stackIndex = 1;
+
+	while(stackIndex-- && activeRays)
+	{
+		const WidePacketStackEntry entry = stack[stackIndex];
+		const PxU32 rayMask = entry.mRayMask & activeRays;
+		if(!rayMask)
+			continue;
+
+		if(isWideLeaf(entry.mData))
+		{
+			PxU32 nbPrims = getWideNbPrimitives(entry.mData);
+			const PxU32* prims = getWidePrimitives(entry.mData, tree.getIndices());
+			while(nbPrims--)
+			{
+				const PxU32 poolIndex = *prims++;
+
+				Vec4V center2, extents2;
+				getBoundsTimesTwo(center2, extents2, boxes, poolIndex);
+				const PxU32 primRayMask = test.check(Vec3V_From_Vec4V(center2), Vec3V_From_Vec4V(extents2), rayMask & activeRays);
+				if(!primRayMask)
+					continue;
+
+				// PT: the callback only shrinks the distances of the rays that keep going
+				PxReal md[SQ_MAX_RAY_PACKET_SIZE];
+				for(PxU32 mask=primRayMask; mask; mask &= mask - 1)
+				{
+					const PxU32 i = Ps::lowestSetBit(mask);
+					md[i] = maxDists[i];
+				}
+
+				const PxU32 againRays = pcb.invokePacket(primRayMask, md, objects[poolIndex]);
+				activeRays &= ~(primRayMask & ~againRays);
+
+				for(PxU32 mask=primRayMask & againRays; mask; mask &= mask - 1)
+				{
+					const PxU32 i = Ps::lowestSetBit(mask);
+					if(md[i] < maxDists[i])
+					{
+						maxDists[i] = md[i];
+						test.setDistance(i, md[i]);
+					}
+				}
+			}
+			continue;
+		}
+
+		const WideAABBTreeNode& node = nodes[getWideNodeIndex(entry.mData)];
+		const PxU32 validMask = gValidChildrenMask[node.getNbChildren()];
+
+		Vec4V bounds[6];
+		node.getChildrenBounds(bounds, shift16);
+
+		// PT: 4 slab tests at once for each ray. childMasks[j] = rays touching child j, childNear = closest entry distance.
+		PxU32 childMasks[SQ_WIDE_TREE_NB_CHILDREN] = { 0, 0, 0, 0 };
+		Vec4V childNear = noHit;
+		for(PxU32 mask=rayMask; mask; mask &= mask - 1)
+		{
+			const PxU32 i = Ps::lowestSetBit(mask);
+
+			const Vec4V ox = V4SplatElement<0>(originsV[i]);
+			const Vec4V oy = V4SplatElement<1>(originsV[i]);
+			const Vec4V oz = V4SplatElement<2>(originsV[i]);
+			const Vec4V idx = V4SplatElement<0>(invDirsV[i]);
+			const Vec4V idy = V4SplatElement<1>(invDirsV[i]);
+			const Vec4V idz = V4SplatElement<2>(invDirsV[i]);
+			const Vec4V tx0 = V4Mul(V4Sub(bounds[0], ox), idx);
+			const Vec4V ty0 = V4Mul(V4Sub(bounds[1], oy), idy);
+			const Vec4V tz0 = V4Mul(V4Sub(bounds[2], oz), idz);
+			const Vec4V tx1 = V4Mul(V4Sub(bounds[3], ox), idx);
+			const Vec4V ty1 = V4Mul(V4Sub(bounds[4], oy), idy);
+			const Vec4V tz1 = V4Mul(V4Sub(bounds[5], oz), idz);
+			const Vec4V tMin = V4Max(V4Max(V4Min(tx0, tx1), V4Min(ty0, ty1)), V4Max(V4Min(tz0, tz1), zero));
+			const Vec4V tMax = V4Min(V4Min(V4Max(tx0, tx1), V4Max(ty0, ty1)), V4Min(V4Max(tz0, tz1), V4Load(maxDists[i])));
+
+			const Vec4V tNear = V4Max(V4NegScaleSub(V4Abs(tMin), slabEpsilon, tMin), zero);
+			const Vec4V tFar = V4ScaleAdd(V4Abs(tMax), slabEpsilon, tMax);
+			const BoolV hits = V4IsGrtrOrEq(tFar, tNear);
+			PxU32 hitMask = BGetBitMask(hits) & validMask;
+			if(!hitMask)
+				continue;
+
+			childNear = V4Min(childNear, V4Sel(hits, tNear, noHit));
+			const PxU32 rayBit = 1u<<i;
+			while(hitMask)
+			{
+				const PxU32 j = Ps::lowestSetBit(hitMask);
+				hitMask &= hitMask - 1;
+				childMasks[j] |= rayBit;
+			}
+		}
+
+		// PT: same sorting as in raycastWideTree, on the closest entry distances
+		PX_ALIGN(16, PxU32) nears[4];
+		V4StoreA(childNear, reinterpret_cast<PxReal*>(nears));
+		PxU32 keys[4];
+		PxU32 nbHits = 0;
+		for(PxU32 j=0; j<SQ_WIDE_TREE_NB_CHILDREN; j++)
+		{
+			keys[j] = childMasks[j] ? (nears[j] & ~3u) | j : 0xffffffff;
+			nbHits += childMasks[j] ? 1 : 0;
+		}
+		if(!nbHits)
+			continue;
+
+#define SQ_WIDE_SORT2(i, j)	{ const PxU32 k0 = keys[i]; const PxU32 k1 = keys[j]; keys[i] = PxMin(k0, k1); keys[j] = PxMax(k0, k1); }
+		SQ_WIDE_SORT2(0, 1)
+		SQ_WIDE_SORT2(2, 3)
+		SQ_WIDE_SORT2(0, 2)
+		SQ_WIDE_SORT2(1, 3)
+		SQ_WIDE_SORT2(1, 2)
+#undef SQ_WIDE_SORT2
+
+		if(stackIndex + SQ_WIDE_TREE_NB_CHILDREN > stack.capacity())
+			stack.resizeUninitialized(stack.capacity() * 2);
+
+		for(PxU32 k=nbHits; k--;)
+		{
+			const PxU32 j = keys[k] & 3;
+			stack[stackIndex].mData = node.getChildData(j);
+			stack[stackIndex].mRayMask = childMasks[j];
+			stackIndex++;
+		}
+	}
+	return activeRays;
+}
+
+namespace
+{
+	struct WideHeapEntry
+	{
+		PxReal	mSqDist;	// squared distance from the query point to the child's box
+		PxU32	mData;		// child data, i.e. leaf or node index
+	};
+
+	typedef Ps::InlineArray<WideHeapEntry, RAW_TRAVERSAL_STACK_SIZE> WideHeap;
+}
+
+static void pushWideHeap(WideHeap& heap, const WideHeapEntry& entry)
+{
+	PxU32 i = heap.size();
+	heap.pushBack(entry);
+	while(i)
+	{
+		const PxU32 parent = (i-1)>>1;
+		if(heap[parent].mSqDist <= entry.mSqDist)
+			break;
+		heap[i] = heap[parent];
+		i = parent;
+	}
+	heap[i] = entry;
+}
+
+static WideHeapEntry popWideHeap(WideHeap& heap)
+{
+	const WideHeapEntry top = heap[0];
+	const WideHeapEntry last = heap.popBack();
+	const PxU32 size = heap.size();
+	if(size)
+	{
+		PxU32 i = 0;
+		for(;;)
+		{
+			PxU32 child = i*2+1;
+			if(child>=size)
+				break;
+			if(child+1<size && heap[child+1].mSqDist < heap[child].mSqDist)
+				child++;
+			if(last.mSqDist <= heap[child].mSqDist)
+				break;
+			heap[i] = heap[child];
+			i = child;
+		}
+		heap[i] = last;
+	}
+	return top;
+}
+
+// PT: best-first traversal, same as AABBTreeClosest for the binary trees. The point-box distances of the 4 children
+// of a node are computed at once, and the children within the search distance go to a heap sorted by distance.
+static PxAgain closestWideTree(const WideAABBTree& tree, const PrunerPayload* objects, const PxBounds3* boxes, const PxVec3& point, PxReal& inOutDistance, PrunerCallback& pcb)
+{
+	const WideAABBTreeNode* PX_RESTRICT nodes = tree.getNodes();
+	const VecShiftV shift16 = VecI32V_PrepareShift(I4Load(16));
+	const Vec4V px = V4Load(point.x);
+	const Vec4V py = V4Load(point.y);
+	const Vec4V pz = V4Load(point.z);
+	const Vec4V zero = V4Zero();
+
+	WideHeap heap;
+	WideHeapEntry root;
+	root.mSqDist = 0.0f;
+	root.mData = 0;	// PT: root node
+	pushWideHeap(heap, root);
+
+	while(heap.size())
+	{
+		const WideHeapEntry entry = popWideHeap(heap);
+		// PT: the heap gives children by increasing distance, so all the remaining ones are out of range as well
+		if(entry.mSqDist > inOutDistance*inOutDistance)
+			break;
+
+		if(isWideLeaf(entry.mData))
+		{
+			PxU32 nbPrims = getWideNbPrimitives(entry.mData);
+			const PxU32* prims = getWidePrimitives(entry.mData, tree.getIndices());
+			while(nbPrims--)
+			{
+				const PxU32 poolIndex = *prims++;
+				const PxBounds3& box = boxes[poolIndex];
+				const PxVec3 d = (box.minimum - point).maximum(point - box.maximum).maximum(PxVec3(0.0f));
+				if(d.magnitudeSquared() > inOutDistance*inOutDistance)
+					continue;
+
+				PxReal md = inOutDistance; // pass md to callback, shrunk by the callback when it finds closer objects
+				if(!pcb.invoke(md, objects[poolIndex]))
+					return false;
+
+				if(md < inOutDistance)
+					inOutDistance = md;
+			}
+			continue;
+		}
+
+		const WideAABBTreeNode& node = nodes[getWideNodeIndex(entry.mData)];
+
+		Vec4V bounds[6];
+		node.getChildrenBounds(bounds, shift16);
+
+		const Vec4V dx = V4Max(V4Max(V4Sub(bounds[0], px), V4Sub(px, bounds[3])), zero);
+		const Vec4V dy = V4Max(V4Max(V4Sub(bounds[1], py), V4Sub(py, bounds[4])), zero);
+		const Vec4V dz = V4Max(V4Max(V4Sub(bounds[2], pz), V4Sub(pz, bounds[5])), zero);
+		const Vec4V d2 = V4MulAdd(dz, dz, V4MulAdd(dy, dy, V4Mul(dx, dx)));
+
+		PxU32 mask = BGetBitMask(V4IsGrtrOrEq(V4Load(inOutDistance*inOutDistance), d2)) & gValidChildrenMask[node.getNbChildren()];
+		if(!mask)
+			continue;
+
+		PX_ALIGN(16, PxReal) sqDists[4];
+		V4StoreA(d2, sqDists);
+		while(mask)
+		{
+			const PxU32 j = Ps::lowestSetBit(mask);
+			mask &= mask - 1;
+
+			WideHeapEntry childEntry;
+			childEntry.mSqDist = sqDists[j];
+			childEntry.mData = node.getChildData(j);
+			pushWideHeap(heap, childEntry);
+		}
+	}
+	return true;
+}
+
+PxAgain WideAABBPruner::overlap(const ShapeData& queryVolume, PrunerCallback& pcb) const
+{
+	PX_ASSERT(!mUncommittedChanges);
+
+	if(!mTree.getNbNodes())
+		return true;
+
+	const PrunerPayload* objects = mPool.getObjects();
+	const PxBounds3* boxes = mPool.getCurrentWorldBoxes();
+
+	switch(queryVolume.getType())
+	{
+	case PxGeometryType::eBOX:
+		{
+			if(queryVolume.isOBB())
+			{
+				const Gu::OBBAABBTest test(queryVolume.getPrunerWorldPos(), queryVolume.getPrunerWorldRot33(), queryVolume.getPrunerBoxGeomExtentsInflated());
+				const WideRefinedTest<Gu::OBBAABBTest> nodeTest(queryVolume.getPrunerInflatedWorldAABB(), test);
+				return overlapWideTree(mTree, objects, boxes, nodeTest, test, pcb);
+			}
+			else
+			{
+				const Gu::AABBAABBTest test(queryVolume.getPrunerInflatedWorldAABB());
+				const WideAABBTest nodeTest(queryVolume.getPrunerInflatedWorldAABB());
+				return overlapWideTree(mTree, objects, boxes, nodeTest, test, pcb);
+			}
+		}
+	case PxGeometryType::eCAPSULE:
+		{
+			const Gu::Capsule& capsule = queryVolume.getGuCapsule();
+			const Gu::CapsuleAABBTest test(	capsule.p1, queryVolume.getPrunerWorldRot33().column0,
+											queryVolume.getCapsuleHalfHeight()*2.0f, PxVec3(capsule.radius*SQ_PRUNER_INFLATION));
+			const WideRefinedTest<Gu::CapsuleAABBTest> nodeTest(queryVolume.getPrunerInflatedWorldAABB(), test);
+			return overlapWideTree(mTree, objects, boxes, nodeTest, test, pcb);
+		}
+	case PxGeometryType::eSPHERE:
+		{
+			const Gu::Sphere& sphere = queryVolume.getGuSphere();
+			const Gu::SphereAABBTest test(sphere.center, sphere.radius);
+			const WideSphereTest nodeTest(sphere.center, sphere.radius);
+			return overlapWideTree(mTree, objects, boxes, nodeTest, test, pcb);
+		}
+	case PxGeometryType::eCONVEXMESH:
+		{
+			const Gu::OBBAABBTest test(queryVolume.getPrunerWorldPos(), queryVolume.getPrunerWorldRot33(), queryVolume.getPrunerBoxGeomExtentsInflated());
+			const WideRefinedTest<Gu::OBBAABBTest> nodeTest(queryVolume.getPrunerInflatedWorldAABB(), test);
+			return overlapWideTree(mTree, objects, boxes, nodeTest, test, pcb);
+		}
+	case PxGeometryType::ePLANE:
+	case PxGeometryType::eTRIANGLEMESH:
+	case PxGeometryType::eHEIGHTFIELD:
+	case PxGeometryType::eGEOMETRY_COUNT:
+	case PxGeometryType::eINVALID:
+		PX_ALWAYS_ASSERT_MESSAGE("unsupported overlap query volume geometry type");
+	}
+	return true;
+}
+
+PxAgain WideAABBPruner::sweep(const ShapeData& queryVolume, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback& pcb) const
+{
+	PX_ASSERT(!mUncommittedChanges);
+
+	if(!mTree.getNbNodes())
+		return true;
+
+	const PxBounds3& aabb = queryVolume.getPrunerInflatedWorldAABB();
+	return raycastWideTree<true>(mTree, mPool.getObjects(), mPool.getCurrentWorldBoxes(), aabb.getCenter(), unitDir, inOutDistance, aabb.getExtents(), pcb);
+}
+
+PxAgain WideAABBPruner::raycast(const PxVec3& origin, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback& pcb) const
+{
+	PX_ASSERT(!mUncommittedChanges);
+
+	if(!mTree.getNbNodes())
+		return true;
+
+	return raycastWideTree<false>(mTree, mPool.getObjects(), mPool.getCurrentWorldBoxes(), origin, unitDir, inOutDistance, PxVec3(0.0f), pcb);
+}
+
+PxU32 WideAABBPruner::raycastPacket(PxU32 nbRays, const PxVec3* origins, const PxVec3* unitDirs, PxReal* inOutDistances, PrunerPacketCallback& pcb, PxU32 activeRays) const
+{
+	PX_ASSERT(!mUncommittedChanges);
+
+	if(!mTree.getNbNodes() || !activeRays)
+		return activeRays;
+
+	return raycastPacketWideTree(mTree, mPool.getObjects(), mPool.getCurrentWorldBoxes(), nbRays, origins, unitDirs, inOutDistances, activeRays, pcb);
+}
+
+PxAgain WideAABBPruner::closest(const PxVec3& point, PxReal& inOutDistance, PrunerCallback& pcb) const
+{
+	PX_ASSERT(!mUncommittedChanges);
+
+	if(!mTree.getNbNodes())
+		return true;
+
+	return closestWideTree(mTree, mPool.getObjects(), mPool.getCurrentWorldBoxes(), point, inOutDistance, pcb);
+}
+
+PxAgain WideAABBPruner::cull(const PlanesAABBTest& test, PrunerCullCallback& pcb) const
+{
+	PX_ASSERT(!mUncommittedChanges);
+
+	if(!mTree.getNbNodes())
+		return true;
+
+	return cullWideTree(mTree, mPool.getObjects(), mPool.getCurrentWorldBoxes(), test, pcb);
+}
+
+void WideAABBPruner::visualize(Cm::RenderOutput& out, PxU32 color) const
+{
+	const PxU32 nbNodes = mTree.getNbNodes();
+	if(!nbNodes)
+		return;
+
+	out << PxTransform(PxIdentity);
+	out << color;
+
+	const VecShiftV shift16 = VecI32V_PrepareShift(I4Load(16));
+	const WideAABBTreeNode* nodes = mTree.getNodes();
+	for(PxU32 i=0; i<nbNodes; i++)
+	{
+		Vec4V bounds[6];
+		nodes[i].getChildrenBounds(bounds, shift16);
+
+		PX_ALIGN(16, PxVec4) decoded[6];
+		for(PxU32 j=0; j<6; j++)
+			V4StoreA(bounds[j], &decoded[j].x);
+
+		const PxU32 nbChildren = nodes[i].getNbChildren();
+		for(PxU32 j=0; j<nbChildren; j++)
+		{
+			const PxBounds3 childBounds(PxVec3(decoded[0][j], decoded[1][j], decoded[2][j]), PxVec3(decoded[3][j], decoded[4][j], decoded[5][j]));
+			out << Cm::DebugBox(childBounds, true);
+		}
+	}
+}
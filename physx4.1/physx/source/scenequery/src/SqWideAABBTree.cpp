@@ -0,0 +1,276 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+
+#include "SqWideAABBTree.h"
+#include "SqAABBTree.h"
+#include "PsArray.h"
+#include "PsMathUtils.h"
+
+using namespace physx;
+using namespace Sq;
+using namespace Gu;
+
+// PT: currently limited to 15 max
+#define NB_OBJECTS_PER_NODE	4
+
+WideAABBTree::WideAABBTree() :
+	mNodes		(NULL),
+	mNbNodes	(0),
+	mIndices	(NULL)
+{
+}
+
+WideAABBTree::~WideAABBTree()
+{
+	release();
+}
+
+void WideAABBTree::release()
+{
+	PX_FREE_AND_RESET(mNodes);
+	PX_FREE_AND_RESET(mIndices);
+	mNbNodes = 0;
+}
+
+static PX_FORCE_INLINE PxReal getSurfaceArea(const PxBounds3& bounds)
+{
+	const PxVec3 d = bounds.maximum - bounds.minimum;
+	return d.x*d.y + d.y*d.z + d.z*d.x;
+}
+
+bool WideAABBTree::build(const PxBounds3* boxes, PxU32 nbPrimitives)
+{
+	release();
+
+	if(!nbPrimitives)
+		return false;
+
+	// PT: we first build a regular binary tree, then collapse it into a wide one
+	AABBTree binaryTree;
+	{
+		AABBTreeBuildParams params;
+		params.mNbPrimitives	= nbPrimitives;
+		params.mAABBArray		= boxes;
+		params.mLimit			= NB_OBJECTS_PER_NODE;
+		if(!binaryTree.build(params))
+			return false;
+	}
+
+	// PT: the primitive indices are the same for both trees, so we just take ownership of the binary tree's array
+	mIndices = binaryTree.getIndices();
+	binaryTree.setIndices(NULL);
+
+	const AABBTreeRuntimeNode* binaryNodes = binaryTree.getNodes();
+
+	// PT: each wide node is created from a binary node. The wide node's children are found by recursively opening the
+	// largest internal binary child, until we either have 4 children or only leaves. Nodes are processed in creation
+	// order, so that children are always stored after their parent.
+	Ps::Array<PxU32> sources;
+	Ps::Array<PxU32> childData;
+	sources.reserve(binaryTree.getNbNodes()/2 + 1);
+	childData.reserve((binaryTree.getNbNodes()/2 + 1)*SQ_WIDE_TREE_NB_CHILDREN);
+	sources.pushBack(0);
+
+	for(PxU32 i=0; i<sources.size(); i++)
+	{
+		const AABBTreeRuntimeNode& source = binaryNodes[sources[i]];
+
+		PxU32 children[SQ_WIDE_TREE_NB_CHILDREN];
+		PxU32 nbChildren;
+		if(source.isLeaf())
+		{
+			// PT: only happens for the root, when the whole tree fits in a single leaf
+			PX_ASSERT(!i);
+			children[0] = sources[i];
+			nbChildren = 1;
+		}
+		else
+		{
+			children[0] = source.getPosIndex();
+			children[1] = source.getNegIndex();
+			nbChildren = 2;
+			while(nbChildren<SQ_WIDE_TREE_NB_CHILDREN)
+			{
+				PxU32 best = 0xffffffff;
+				PxReal bestArea = -1.0f;
+				for(PxU32 j=0; j<nbChildren; j++)
+				{
+					const AABBTreeRuntimeNode& child = binaryNodes[children[j]];
+					if(child.isLeaf())
+						continue;
+					const PxReal area = getSurfaceArea(child.mBV);
+					if(area>bestArea)
+					{
+						bestArea = area;
+						best = j;
+					}
+				}
+				if(best==0xffffffff)
+					break;
+
+				const PxU32 posIndex = binaryNodes[children[best]].getPosIndex();
+				children[best] = posIndex;
+				children[nbChildren++] = posIndex + 1;
+			}
+		}
+
+		for(PxU32 j=0; j<SQ_WIDE_TREE_NB_CHILDREN; j++)
+		{
+			PxU32 data = 0;
+			if(j<nbChildren)
+			{
+				const AABBTreeRuntimeNode& child = binaryNodes[children[j]];
+				if(child.isLeaf())
+				{
+					// PT: same leaf encoding in both trees
+					data = child.mData;
+				}
+				else
+				{
+					data = sources.size()<<1;
+					sources.pushBack(children[j]);
+				}
+			}
+			childData.pushBack(data);
+		}
+	}
+
+	mNbNodes = sources.size();
+	mNodes = reinterpret_cast<WideAABBTreeNode*>(PX_ALLOC(sizeof(WideAABBTreeNode)*mNbNodes, "WideAABBTree nodes"));
+	for(PxU32 i=0; i<mNbNodes; i++)
+	{
+		WideAABBTreeNode& node = mNodes[i];
+		PxU32 nbChildren = 0;
+		for(PxU32 j=0; j<SQ_WIDE_TREE_NB_CHILDREN; j++)
+		{
+			node.mData[j] = childData[i*SQ_WIDE_TREE_NB_CHILDREN + j];
+			if(node.mData[j])
+				nbChildren++;
+		}
+		node.mNbChildren = nbChildren;
+		node.mPad = 0;
+	}
+
+	refit(boxes);
+	return true;
+}
+
+// PT: computes a dequantization scale such that the max quantized value covers the whole range. Doubling the scale
+// handles the degenerate cases where the extent is tiny compared to the offset, i.e. when it doesn't survive the FPU rounding.
+static PX_FORCE_INLINE PxReal computeScale(PxReal minV, PxReal maxV)
+{
+	if(maxV<=minV)
+		return 0.0f;
+
+	PxReal scale = (maxV - minV) * (1.0f/PxReal(SQ_WIDE_TREE_QUANTIZED_MAX-7));
+	while(PxReal(SQ_WIDE_TREE_QUANTIZED_MAX)*scale + minV < maxV)
+		scale *= 2.0f;
+	return scale;
+}
+
+// PT: conservative quantization, i.e. dequantized bounds always enclose the source bounds
+static PX_FORCE_INLINE PxU32 quantize(PxReal minV, PxReal maxV, PxReal offset, PxReal scale)
+{
+	if(scale==0.0f)
+		return 0;
+
+	const PxReal invScale = 1.0f/scale;
+	const PxReal qLimit = PxReal(SQ_WIDE_TREE_QUANTIZED_MAX);
+	PxI32 qMin = PxI32(PxClamp(Ps::floor((minV - offset)*invScale), 0.0f, qLimit));
+	PxI32 qMax = PxI32(PxClamp(Ps::ceil((maxV - offset)*invScale), 0.0f, qLimit));
+
+	// PT: fix FPU rounding errors. These must use the same operations as the runtime dequantization.
+	while(qMin && PxReal(qMin)*scale + offset > minV)
+		qMin--;
+	while(qMax<SQ_WIDE_TREE_QUANTIZED_MAX && PxReal(qMax)*scale + offset < maxV)
+		qMax++;
+
+	return PxU32(qMin) | (PxU32(qMax)<<16);
+}
+
+void WideAABBTree::refit(const PxBounds3* boxes)
+{
+	if(!mNbNodes)
+		return;
+
+	Ps::Array<PxBounds3> nodeBounds;
+	nodeBounds.resizeUninitialized(mNbNodes);
+
+	// PT: children are stored after their parent, so a reverse pass over the nodes is a bottom-up refit
+	PxU32 i = mNbNodes;
+	while(i--)
+	{
+		WideAABBTreeNode& node = mNodes[i];
+		const PxU32 nbChildren = node.getNbChildren();
+
+		PxBounds3 childBounds[SQ_WIDE_TREE_NB_CHILDREN];
+		PxBounds3 bounds = PxBounds3::empty();
+		for(PxU32 j=0; j<nbChildren; j++)
+		{
+			const PxU32 data = node.getChildData(j);
+			if(isWideLeaf(data))
+			{
+				PxU32 nbPrims = getWideNbPrimitives(data);
+				const PxU32* prims = getWidePrimitives(data, mIndices);
+				childBounds[j] = boxes[*prims++];
+				while(--nbPrims)
+					childBounds[j].include(boxes[*prims++]);
+			}
+			else
+			{
+				PX_ASSERT(getWideNodeIndex(data)>i);
+				childBounds[j] = nodeBounds[getWideNodeIndex(data)];
+			}
+			bounds.include(childBounds[j]);
+		}
+		nodeBounds[i] = bounds;
+
+		// PT: unused children get empty quantized bounds but are never tested anyway, since queries mask them out
+		const PxVec3 scale(	computeScale(bounds.minimum.x, bounds.maximum.x),
+							computeScale(bounds.minimum.y, bounds.maximum.y),
+							computeScale(bounds.minimum.z, bounds.maximum.z));
+		node.mOffset = bounds.minimum;
+		node.mScale = scale;
+		for(PxU32 j=0; j<SQ_WIDE_TREE_NB_CHILDREN; j++)
+		{
+			if(j<nbChildren)
+			{
+				const PxBounds3& b = childBounds[j];
+				node.mX[j] = quantize(b.minimum.x, b.maximum.x, bounds.minimum.x, scale.x);
+				node.mY[j] = quantize(b.minimum.y, b.maximum.y, bounds.minimum.y, scale.y);
+				node.mZ[j] = quantize(b.minimum.z, b.maximum.z, bounds.minimum.z, scale.z);
+			}
+			else
+			{
+				node.mX[j] = node.mY[j] = node.mZ[j] = 0;
+			}
+		}
+	}
+}
@@ -0,0 +1,143 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+
+#ifndef SQ_WIDE_AABBTREE_H
+#define SQ_WIDE_AABBTREE_H
+
+#include "foundation/PxBounds3.h"
+#include "PsUserAllocated.h"
+#include "PsVecMath.h"
+#include "SqTypedef.h"
+
+namespace physx
+{
+
+using namespace shdfnd::aos;
+
+namespace Sq
+{
+	// PT: max number of children per node. This matches the SIMD width, so that all children are tested at once.
+	#define SQ_WIDE_TREE_NB_CHILDREN	4
+
+	// PT: child bounds are quantized to 15 bits so that both min & max fit in a single 32-bit word
+	#define SQ_WIDE_TREE_QUANTIZED_MAX	32767
+
+	//! Node of the wide AABB tree.
+	//! Each node has up to 4 children. Children bounds are quantized relative to the node's own bounds and stored in SoA form,
+	//! similar to the swizzled BV4 nodes used by the mesh midphase. This lets us test a query against all the children with
+	//! a single SIMD test.
+	PX_ALIGN_PREFIX(16)
+	class WideAABBTreeNode
+	{
+		public:
+		PX_FORCE_INLINE	PxU32			getNbChildren()		const	{ return mNbChildren;	}
+		PX_FORCE_INLINE	PxU32			getChildData(PxU32 i)	const	{ return mData[i];		}
+
+		// PT: decodes the 4 children bounds in quantized space. Output is minX, minY, minZ, maxX, maxY, maxZ.
+		PX_FORCE_INLINE	void			getQuantizedBounds(Vec4V* PX_RESTRICT bounds, const VecShiftV& shift16)	const
+										{
+											decodeAxis(bounds[0], bounds[3], mX, shift16);
+											decodeAxis(bounds[1], bounds[4], mY, shift16);
+											decodeAxis(bounds[2], bounds[5], mZ, shift16);
+										}
+
+		// PT: decodes the 4 children bounds in world space. Mul & add are not fused on purpose, so that the results exactly match
+		// the conservative quantization done at build time.
+		PX_FORCE_INLINE	void			getChildrenBounds(Vec4V* PX_RESTRICT bounds, const VecShiftV& shift16)	const
+										{
+											getQuantizedBounds(bounds, shift16);
+											const Vec4V offset = V4LoadA(&mOffset.x);
+											const Vec4V scale = V4LoadA(&mScale.x);
+											const Vec4V offsetX = V4SplatElement<0>(offset);
+											const Vec4V offsetY = V4SplatElement<1>(offset);
+											const Vec4V offsetZ = V4SplatElement<2>(offset);
+											const Vec4V scaleX = V4SplatElement<0>(scale);
+											const Vec4V scaleY = V4SplatElement<1>(scale);
+											const Vec4V scaleZ = V4SplatElement<2>(scale);
+											bounds[0] = V4Add(V4Mul(bounds[0], scaleX), offsetX);
+											bounds[1] = V4Add(V4Mul(bounds[1], scaleY), offsetY);
+											bounds[2] = V4Add(V4Mul(bounds[2], scaleZ), offsetZ);
+											bounds[3] = V4Add(V4Mul(bounds[3], scaleX), offsetX);
+											bounds[4] = V4Add(V4Mul(bounds[4], scaleY), offsetY);
+											bounds[5] = V4Add(V4Mul(bounds[5], scaleZ), offsetZ);
+										}
+
+						PxVec3			mOffset;		//!< Dequantization offset (min of the node's bounds)
+						PxU32			mNbChildren;	//!< Number of valid children
+						PxVec3			mScale;			//!< Dequantization scale
+						PxU32			mPad;
+						PxU32			mX[4];			//!< Quantized children bounds, min in the low 16 bits, max in the high 16 bits
+						PxU32			mY[4];
+						PxU32			mZ[4];
+						PxU32			mData[4];		//!< Leaf child: 27 bits prim index|4 bits #prims|1 bit leaf. Internal child: 31 bits node index|0.
+
+		private:
+		static	PX_FORCE_INLINE	void	decodeAxis(Vec4V& minV, Vec4V& maxV, const PxU32* quantized, const VecShiftV& shift16)
+										{
+											const VecI32V packed = I4LoadA(reinterpret_cast<const PxI32*>(quantized));
+											minV = Vec4V_From_VecI32V(VecI32V_RightShift(VecI32V_LeftShift(packed, shift16), shift16));
+											maxV = Vec4V_From_VecI32V(VecI32V_RightShift(packed, shift16));
+										}
+	}
+	PX_ALIGN_SUFFIX(16);
+
+	PX_COMPILE_TIME_ASSERT(sizeof(WideAABBTreeNode)==96);
+
+	PX_FORCE_INLINE	PxU32			isWideLeaf(PxU32 data)								{ return data&1;			}
+	PX_FORCE_INLINE	PxU32			getWideNodeIndex(PxU32 data)						{ return data>>1;			}
+	PX_FORCE_INLINE	const PxU32*	getWidePrimitives(PxU32 data, const PxU32* base)	{ return base + (data>>5);	}
+	PX_FORCE_INLINE	PxU32			getWideNbPrimitives(PxU32 data)						{ return (data>>1)&15;		}
+
+	//! 4-wide AABB tree.
+	//! The tree is built by collapsing a regular binary AABB tree, and refit bottom-up from the pruning pool's bounds.
+	class WideAABBTree : public Ps::UserAllocated
+	{
+		public:
+													WideAABBTree();
+													~WideAABBTree();
+
+						bool						build(const PxBounds3* boxes, PxU32 nbPrimitives);
+						void						refit(const PxBounds3* boxes);
+						void						release();
+
+		PX_FORCE_INLINE	const WideAABBTreeNode*		getNodes()		const	{ return mNodes;	}
+		PX_FORCE_INLINE	PxU32						getNbNodes()	const	{ return mNbNodes;	}
+		PX_FORCE_INLINE	const PxU32*				getIndices()	const	{ return mIndices;	}
+		private:
+						WideAABBTreeNode*			mNodes;		//!< Linear pool of nodes. Children are always stored after their parent.
+						PxU32						mNbNodes;
+						PxU32*						mIndices;	//!< Indices in the pruning pool, referenced by leaf children
+	};
+
+} // namespace Sq
+
+}
+
+#endif // SQ_WIDE_AABBTREE_H
@@ -54,6 +54,15 @@ namespace Sc
 		PxU8			type;		
 	};
 
+	// Sleep and stabilization filters of a simulated body, see PxsRigidBody
+	struct SleepFilterState
+	{
+		PxVec3			linVelAcc;
+		PxReal			freezeCount;
+		PxVec3			angVelAcc;
+		PxReal			accelScale;
+	};
+
 	class BodyCore : public RigidCore
 	{
 	//= ATTENTION! =====================================================================================
@@ -156,6 +165,14 @@ namespace Sc
 						bool				getHasValidKinematicTarget() const;
 						void				setKinematicTarget(Ps::Pool<SimStateData>* simStateDataPool, const PxTransform& p, PxReal wakeCounter);
 						void				invalidateKinematicTarget();
+
+						// Bulk updates, see PxScene::setKinematicTargets() and PxScene::setRigidDynamicStates(). These only touch the body, so
+						// they can run for different bodies in parallel. The IfAwake versions return false and change nothing if the body is
+						// not simulated and awake, in which case the regular versions must be used instead.
+						bool				wakeUpIfAwake(PxReal wakeCounter);
+						bool				setKinematicTargetIfAwake(const PxTransform& p, PxReal wakeCounter);
+		PX_FORCE_INLINE	void				setBody2WorldNoNotify(const PxTransform& p)	{ mCore.body2World = p;	}	// must be followed by notifyBody2WorldChange()
+						void				notifyBody2WorldChange();
 						
 
 		PX_FORCE_INLINE	PxReal				getContactReportThreshold()	const	{ return mCore.contactReportThreshold;	}
@@ -186,6 +203,9 @@ namespace Sc
 
 						Ps::IntBool			isFrozen()							const;
 
+						void				getSleepFilterState(SleepFilterState& state)	const;
+						void				setSleepFilterState(const SleepFilterState& state);
+
 		PX_FORCE_INLINE const SimStateData*	getSimStateData(bool isKinematic)	const	{ return (mSimStateData && (checkSimStateKinematicStatus(isKinematic)) ? mSimStateData : NULL); }
 		PX_FORCE_INLINE SimStateData*		getSimStateData(bool isKinematic)			{ return (mSimStateData && (checkSimStateKinematicStatus(isKinematic)) ? mSimStateData : NULL); }
 
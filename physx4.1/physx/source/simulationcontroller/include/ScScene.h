@@ -38,6 +38,7 @@
 #include "PxSimulationEventCallback.h"
 #include "PsPool.h"
 #include "PsHashSet.h"
+#include "PsHashMap.h"
 #include "CmRenderOutput.h"
 #include "CmTask.h"
 #include "CmFlushPool.h"
@@ -301,6 +302,8 @@ namespace Sc
 		// Simulation events
 					void						setSimulationEventCallback(PxSimulationEventCallback* callback);
 					PxSimulationEventCallback*	getSimulationEventCallback() const;
+	PX_FORCE_INLINE	void						setContactReportRecords(PxContactReportRecords* records)	{ mContactReportRecords = records;	}
+	PX_FORCE_INLINE	PxContactReportRecords*		getContactReportRecords()					const	{ return mContactReportRecords;		}
 
 		// Contact modification
 					void						setContactModifyCallback(PxContactModifyCallback* callback);
@@ -352,6 +355,7 @@ namespace Sc
 					void						fireBrokenConstraintCallbacks();
 					void						fireTriggerCallbacks();
 					void						fireQueuedContactCallbacks(bool asPartOfFlush);
+					void						writeContactReportRecords(PxContactReportRecords& records, PxU32 removedShapeTestMask);
 					void						fireOnAdvanceCallback();
 
 					const Ps::Array<PxContactPairHeader>&
@@ -387,6 +391,20 @@ namespace Sc
 	PX_FORCE_INLINE	SimStats&					getStatsInternal() { return *mStats; }
 // PX_ENABLE_SIM_STATS
 
+	// Persistent contact state for simulation snapshots, see PxScene::saveSimulationState(). The buffers must be 16-byte aligned.
+	// A delta state skips the records that did not change since baseState, which is NULL for a full state.
+					PxU32						getContactStateSize(const PxU8* baseState) const;
+					PxU32						saveContactState(PxU8* buffer, const PxU8* baseState) const;
+					bool						isValidContactState(const PxU8* state, const PxU8* baseState) const;
+					void						restoreContactState(const PxU8* state, const PxU8* baseState);
+					void						applyPendingContactState();
+					void						reconcileRestoredOverlaps();
+					void						restoreTouchState(ShapeInteraction& si, PxI32 touch, bool useAdaptiveForce);
+					void						toggleRestoredOverlap(ShapeSim& shape0, ShapeSim& shape1, bool inScene);
+					void						removeRestoredOverlaps(ShapeSim& shape);
+					void						restoreIslands();
+					void						restoreLostTouchPairs(const PxU8* state);
+
 					void						buildActiveActors();
 					void						buildActiveAndFrozenActors();
 					PxActor**					getActiveActors(PxU32& nbActorsOut);
@@ -665,10 +683,13 @@ namespace Sc
 		PX_FORCE_INLINE void					putObjectsToSleep(PxU32 infoFlag);
 		PX_FORCE_INLINE void					putInteractionsToSleep();
 		PX_FORCE_INLINE void					wakeObjectsUp(PxU32 infoFlag);
+		PX_FORCE_INLINE void					wakeInteractions();
 
 					void						collectPostSolverVelocitiesBeforeCCD();
 
 					void						clearSleepWakeBodies(void);
+
+					void						buildActiveActorLists(bool buildFrozenActors);
 		PX_INLINE	void						cleanUpSleepBodies();
 		PX_INLINE	void						cleanUpWokenBodies();
 		PX_INLINE	void						cleanUpSleepOrWokenBodies(Ps::CoalescedHashSet<BodyCore*>& bodyList, PxU32 removeFlag, bool& validMarker);
@@ -808,8 +829,14 @@ namespace Sc
 																			// to users.
 
 						PxSimulationEventCallback*	mSimulationEventCallback;
+						PxContactReportRecords*		mContactReportRecords;	// if set, contact reports are written there instead of being sent to mSimulationEventCallback
 						PxBroadPhaseCallback*		mBroadPhaseCallback;
 
+					Ps::Array<PxU8>				mRestoredContactData;	// contact caches and friction patches written by restoreContactState(), read by the next narrow phase and solver
+					bool						mHasPendingContactState;	// restored contact state left for the contact managers created by the next step
+					typedef Ps::HashMap<Ps::Pair<ShapeSim*, ShapeSim*>, bool> RestoredOverlapMap;
+					RestoredOverlapMap			mRestoredOverlaps;		// pairs created (true) or released (false) by restoreContactState() until the broad phase reports them
+					PxU32						mShapeRemovalCount;		// invalidates the contact states saved before a shape removal
 					SimStats*					mStats;
 					PxU32						mInternalFlags;	//!< Combination of ::SceneFlag
 					PxSceneFlags				mPublicFlags;	//copy of PxSceneDesc::flags, of type PxSceneFlag
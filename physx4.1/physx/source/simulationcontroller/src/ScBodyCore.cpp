@@ -32,6 +32,7 @@
 #include "ScPhysics.h"
 #include "ScScene.h"
 #include "PxsSimulationController.h"
+#include "PxsSimpleIslandManager.h"
 #include "PsFoundation.h"
 
 using namespace physx;
@@ -607,6 +608,39 @@ Ps::IntBool Sc::BodyCore::isFrozen() const
 	return getSim()->isFrozen();
 }
 
+void Sc::BodyCore::getSleepFilterState(SleepFilterState& state) const
+{
+	const BodySim* sim = getSim();
+	if(sim)
+	{
+		const PxsRigidBody& llBody = sim->getLowLevelBody();
+		state.linVelAcc = llBody.sleepLinVelAcc;
+		state.freezeCount = llBody.freezeCount;
+		state.angVelAcc = llBody.sleepAngVelAcc;
+		state.accelScale = llBody.accelScale;
+	}
+	else
+	{
+		state.linVelAcc = PxVec3(0.0f);
+		state.freezeCount = 0.0f;
+		state.angVelAcc = PxVec3(0.0f);
+		state.accelScale = 1.0f;
+	}
+}
+
+void Sc::BodyCore::setSleepFilterState(const SleepFilterState& state)
+{
+	BodySim* sim = getSim();
+	if(sim)
+	{
+		PxsRigidBody& llBody = sim->getLowLevelBody();
+		llBody.sleepLinVelAcc = state.linVelAcc;
+		llBody.freezeCount = state.freezeCount;
+		llBody.sleepAngVelAcc = state.angVelAcc;
+		llBody.accelScale = state.accelScale;
+	}
+}
+
 void Sc::BodyCore::setSolverIterationCounts(PxU16 c)	
 { 
 	mCore.solverIterationCounts = c;	
@@ -676,6 +710,43 @@ void Sc::BodyCore::invalidateKinematicTarget()
 	mSimStateData->getKinematicData()->targetValid = 0; 
 }
 
+bool Sc::BodyCore::wakeUpIfAwake(PxReal wakeCounter)
+{
+	// PT: for a body that is active in the scene and in both island sims, wakeUp() only resets the wake counter and the sleep
+	// flags of the island node.
+	BodySim* sim = getSim();
+	if(!sim || !sim->isActive() || !sim->getScene().getSimpleIslandManager()->reactivateNode(sim->getNodeIndex()))
+		return false;
+
+	mCore.wakeCounter = wakeCounter;
+	return true;
+}
+
+bool Sc::BodyCore::setKinematicTargetIfAwake(const PxTransform& p, PxReal wakeCounter)
+{
+	PX_ASSERT(mCore.mFlags & PxRigidBodyFlag::eKINEMATIC);
+	PX_ASSERT(!mSimStateData || mSimStateData->isKine());
+
+	if(!mSimStateData || !wakeUpIfAwake(wakeCounter))
+		return false;
+
+	Kinematic* kine = mSimStateData->getKinematicData();
+	kine->targetPose = p;
+	kine->targetValid = 1;
+	getSim()->postSetKinematicTarget();
+	return true;
+}
+
+void Sc::BodyCore::notifyBody2WorldChange()
+{
+	BodySim* sim = getSim();
+	if(sim)
+	{
+		sim->postBody2WorldChange();
+		updateBodySim(sim);
+	}
+}
+
 void Sc::BodyCore::setKinematicLink(const bool value)
 {
 	BodySim* sim = getSim();
@@ -659,7 +659,8 @@ Sc::NPhaseCore::NPhaseCore(Scene& scene, const PxSceneDesc& sceneDesc) :
 	mInteractionMarkerPool			(PX_DEBUG_EXP("interactionMarkerPool"))
 	,mMergeProcessedTriggerInteractions (scene.getContextId(), this, "ScNPhaseCore.mergeProcessedTriggerInteractions")
 	,mTmpTriggerProcessingBlock		(NULL)
-	,mTriggerPairsToDeactivateCount	(0)
+	,mTmpTriggerTasks				(NULL)
+	,mTmpTriggerTaskCount			(0)
 {
 	mFilterPairManager = PX_NEW(FilterPairManager);
 }
@@ -1307,16 +1308,16 @@ private:
 	TriggerContactTask& operator = (const TriggerContactTask&);
 
 public:
-	TriggerContactTask(	Interaction* const* triggerPairs, PxU32 triggerPairCount, Ps::Mutex& lock,
-						TriggerInteraction** pairsToDeactivate, volatile PxI32& pairsToDeactivateCount,
-						Scene& scene)
+	// Results are kept in the task and merged in task order by NPhaseCore::mergeProcessedTriggerInteractions(), so
+	// that trigger reports and deactivations come out in the same order for any number of threads.
+	TriggerContactTask(	Interaction* const* triggerPairs, PxU32 triggerPairCount, TriggerInteraction** pairsToDeactivate, Scene& scene)
 		:
 		Cm::Task(scene.getContextId()),
 		mTriggerPairs(triggerPairs),
 		mTriggerPairCount(triggerPairCount),
-		mLock(lock),
 		mPairsToDeactivate(pairsToDeactivate),
-		mPairsToDeactivateCount(pairsToDeactivateCount),
+		mPairsToDeactivateCount(0),
+		mTriggerReportItemCount(0),
 		mScene(scene)
 	{
 	}
@@ -1327,12 +1328,12 @@ public:
 #if PX_ENABLE_SIM_STATS
 		PxMemZero(&triggerPairStats, sizeof(SimStats::TriggerPairCountsNonVolatile));
 #endif
-		PxTriggerPair triggerPair[sTriggerPairsPerTask];
-		TriggerPairExtraData triggerPairExtra[sTriggerPairsPerTask];
+		PxTriggerPair* triggerPair = mTriggerPair;
+		TriggerPairExtraData* triggerPairExtra = mTriggerPairExtra;
 		PxU32 triggerReportItemCount = 0;
 
-		TriggerInteraction* deactivatePairs[sTriggerPairsPerTask];
-		PxI32 deactivatePairCount = 0;
+		TriggerInteraction** deactivatePairs = mPairsToDeactivate;
+		PxU32 deactivatePairCount = 0;
 
 		for(PxU32 i=0; i < mTriggerPairCount; i++)
 		{
@@ -1368,26 +1369,8 @@ public:
 			}
 		}
 
-		if(triggerReportItemCount)
-		{
-			PxTriggerPair* triggerPairBuffer;
-			TriggerPairExtraData* triggerPairExtraBuffer;
-
-			{
-				Ps::Mutex::ScopedLock lock(mLock);
-
-				mScene.reserveTriggerReportBufferSpace(triggerReportItemCount, triggerPairBuffer, triggerPairExtraBuffer);
-
-				PxMemCopy(triggerPairBuffer, triggerPair, sizeof(PxTriggerPair) * triggerReportItemCount);
-				PxMemCopy(triggerPairExtraBuffer, triggerPairExtra, sizeof(TriggerPairExtraData) * triggerReportItemCount);
-			}
-		}
-
-		if(deactivatePairCount)
-		{
-			PxI32 newSize = Ps::atomicAdd(&mPairsToDeactivateCount, deactivatePairCount);
-			PxMemCopy(mPairsToDeactivate + newSize - deactivatePairCount, deactivatePairs, sizeof(TriggerInteraction*) * deactivatePairCount);
-		}
+		mTriggerReportItemCount = triggerReportItemCount;
+		mPairsToDeactivateCount = deactivatePairCount;
 
 #if PX_ENABLE_SIM_STATS
 		SimStats& simStats = mScene.getStatsInternal();
@@ -1407,15 +1390,34 @@ public:
 		return "ScNPhaseCore.triggerInteractionWork";
 	}
 
+	void writeBack(Scene& scene)
+	{
+		if(mTriggerReportItemCount)
+		{
+			PxTriggerPair* triggerPairBuffer;
+			TriggerPairExtraData* triggerPairExtraBuffer;
+			scene.reserveTriggerReportBufferSpace(mTriggerReportItemCount, triggerPairBuffer, triggerPairExtraBuffer);
+
+			PxMemCopy(triggerPairBuffer, mTriggerPair, sizeof(PxTriggerPair) * mTriggerReportItemCount);
+			PxMemCopy(triggerPairExtraBuffer, mTriggerPairExtra, sizeof(TriggerPairExtraData) * mTriggerReportItemCount);
+		}
+
+		// deactivate pairs that do not need trigger checks any longer (until woken up again)
+		for(PxU32 i=0; i < mPairsToDeactivateCount; i++)
+			scene.notifyInteractionDeactivated(mPairsToDeactivate[i]);
+	}
+
 public:
 	static const PxU32 sTriggerPairsPerTask = 64;
 
 private:
 	Interaction* const* mTriggerPairs;
 	const PxU32 mTriggerPairCount;
-	Ps::Mutex& mLock;
-	TriggerInteraction** mPairsToDeactivate;
-	volatile PxI32& mPairsToDeactivateCount;
+	TriggerInteraction** mPairsToDeactivate;	// sTriggerPairsPerTask entries in the shared processing block
+	PxU32 mPairsToDeactivateCount;
+	PxTriggerPair mTriggerPair[sTriggerPairsPerTask];
+	TriggerPairExtraData mTriggerPairExtra[sTriggerPairsPerTask];
+	PxU32 mTriggerReportItemCount;
 	Scene& mScene;
 };
 
@@ -1425,7 +1427,7 @@ private:
 void Sc::NPhaseCore::processTriggerInteractions(PxBaseTask* continuation)
 {
 	PX_ASSERT(!mTmpTriggerProcessingBlock);
-	PX_ASSERT(mTriggerPairsToDeactivateCount == 0);
+	PX_ASSERT(mTmpTriggerTaskCount == 0);
 
 	Scene& scene = mOwnerScene;
 
@@ -1454,6 +1456,7 @@ void Sc::NPhaseCore::processTriggerInteractions(PxBaseTask* continuation)
 
 			TriggerInteraction** triggerPairsToDeactivateWriteBack = reinterpret_cast<TriggerInteraction**>(triggerProcessingBlock);
 			TriggerContactTask* triggerContactTaskBuffer = reinterpret_cast<TriggerContactTask*>(reinterpret_cast<PxU8*>(triggerProcessingBlock) + pairPtrSize);
+			mTmpTriggerTasks = triggerContactTaskBuffer;
 
 			PxU32 remainder = pairCount;
 			while(remainder)
@@ -1462,8 +1465,8 @@ void Sc::NPhaseCore::processTriggerInteractions(PxBaseTask* continuation)
 				remainder -= nb;
 
 				TriggerContactTask* task = triggerContactTaskBuffer;
-				task = PX_PLACEMENT_NEW(task, TriggerContactTask(	triggerInteractions, nb, mTriggerWriteBackLock,
-																	triggerPairsToDeactivateWriteBack, mTriggerPairsToDeactivateCount, scene));
+				task = PX_PLACEMENT_NEW(task, TriggerContactTask(triggerInteractions, nb, triggerPairsToDeactivateWriteBack, scene));
+				mTmpTriggerTaskCount++;
 				if(scheduleTasks)
 				{
 					task->setContinuation(&mMergeProcessedTriggerInteractions);
@@ -1474,6 +1477,7 @@ void Sc::NPhaseCore::processTriggerInteractions(PxBaseTask* continuation)
 
 				triggerContactTaskBuffer++;
 				triggerInteractions += nb;
+				triggerPairsToDeactivateWriteBack += nb;
 			}
 
 			if(scheduleTasks)
@@ -1492,13 +1496,10 @@ void Sc::NPhaseCore::mergeProcessedTriggerInteractions(PxBaseTask*)
 {
 	if(mTmpTriggerProcessingBlock)
 	{
-		// deactivate pairs that do not need trigger checks any longer (until woken up again)
-		TriggerInteraction** triggerPairsToDeactivate = reinterpret_cast<TriggerInteraction**>(mTmpTriggerProcessingBlock);
-		for(PxI32 i=0; i < mTriggerPairsToDeactivateCount; i++)
-		{
-			mOwnerScene.notifyInteractionDeactivated(triggerPairsToDeactivate[i]);
-		}
-		mTriggerPairsToDeactivateCount = 0;
+		for(PxU32 i=0; i < mTmpTriggerTaskCount; i++)
+			mTmpTriggerTasks[i].writeBack(mOwnerScene);
+		mTmpTriggerTasks = NULL;
+		mTmpTriggerTaskCount = 0;
 
 		mOwnerScene.getLowLevelContext()->getScratchAllocator().free(mTmpTriggerProcessingBlock);
 		mTmpTriggerProcessingBlock = NULL;
@@ -63,6 +63,7 @@ namespace Sc
 	class ElementSimInteraction;
 	class ElementInteractionMarker;
 	class TriggerInteraction;
+	class TriggerContactTask;
 
 	class ShapeInteraction;
 	class ActorPair;
@@ -329,8 +330,8 @@ namespace Sc
 
 		Cm::DelegateTask<Sc::NPhaseCore, &Sc::NPhaseCore::mergeProcessedTriggerInteractions> mMergeProcessedTriggerInteractions;
 		void*											mTmpTriggerProcessingBlock;  // temporary memory block to process trigger pairs in parallel
-		Ps::Mutex										mTriggerWriteBackLock;
-		volatile PxI32									mTriggerPairsToDeactivateCount;
+		TriggerContactTask*								mTmpTriggerTasks;  // trigger tasks in mTmpTriggerProcessingBlock, merged in order
+		PxU32											mTmpTriggerTaskCount;
 		Ps::HashMap<BodyPairKey, ActorPair*>			mActorPairMap; 
 
 		Ps::HashMap<ElementSimKey, ElementSimInteraction*> mElementSimMap;
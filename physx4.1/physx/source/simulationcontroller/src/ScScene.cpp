@@ -61,6 +61,7 @@
 #include "ScSqBoundsManager.h"
 #include "ScElementSim.h"
 #include "CmPtrTable.h"
+#include "CmChunkedJob.h"
 
 #if defined(__APPLE__) && defined(__POWERPC__)
 #include <ppc_intrinsics.h>
@@ -576,6 +577,7 @@ Sc::Scene::Scene(const PxSceneDesc& desc, PxU64 contextID) :
 	mClientPosePreviewBodies		(PX_DEBUG_EXP("clientPosePreviewBodies")),
 	mClientPosePreviewBuffer		(PX_DEBUG_EXP("clientPosePreviewBuffer")),
 	mSimulationEventCallback		(NULL),
+	mContactReportRecords			(NULL),
 	mBroadPhaseCallback				(NULL),
 	mInternalFlags					(SceneInternalFlag::eSCENE_DEFAULT),
 	mPublicFlags					(desc.flags),
@@ -638,6 +640,8 @@ Sc::Scene::Scene(const PxSceneDesc& desc, PxU64 contextID) :
 {
 
 	mCCDPass = 0;
+	mHasPendingContactState = false;
+	mShapeRemovalCount = 0;
 	for (int i=0; i < InteractionType::eTRACKED_IN_SCENE_COUNT; ++i)
 		mActiveInteractionCount[i] = 0;
 
@@ -869,6 +873,7 @@ Sc::Scene::Scene(const PxSceneDesc& desc, PxU64 contextID) :
 	mDynamicsContext->setFrictionOffsetThreshold(desc.frictionOffsetThreshold);
 	mDynamicsContext->setCCDSeparationThreshold(desc.ccdMaxSeparation);
 	mDynamicsContext->setSolverOffsetSlop(desc.solverOffsetSlop);
+	mDynamicsContext->setParallelPartitioning(!!(desc.flags & PxSceneFlag::eENABLE_PARALLEL_PARTITIONING));
 
 	const PxTolerancesScale& scale = Physics::getInstance().getTolerancesScale();
 	mDynamicsContext->setCorrelationDistance(0.025f * scale.length);
@@ -1994,6 +1999,10 @@ void Sc::Scene::postBroadPhaseContinuation(PxBaseTask* continuation)
 {
 	mAABBManager->getChangedAABBMgActorHandleMap().clear();
 
+	// - Matches the broadphase results with the pairs of a restored simulation state
+	if(mRestoredOverlaps.size())
+		reconcileRestoredOverlaps();
+
 	// - Finishes broadphase update
 	// - Adds new interactions (and thereby contact managers if needed)
 	finishBroadPhase(continuation);
@@ -2620,6 +2629,35 @@ PX_FORCE_INLINE void Sc::Scene::wakeObjectsUp(PxU32 infoFlag)
 	}
 }
 
+PX_FORCE_INLINE void Sc::Scene::wakeInteractions()
+{
+	PX_PROFILE_ZONE("ScScene.wakeInteractions", getContextId());
+	const IG::IslandSim& speculativeSim = mSimpleIslandManager->getSpeculativeIslandSim();
+
+	//KS - only wake contact managers based on speculative state to trigger contact gen. Waking actors based on accurate state
+	//should activate and joints.
+	{
+		PxU32 nbActivatingEdges = speculativeSim.getNbActivatedEdges(IG::Edge::eCONTACT_MANAGER);
+		const IG::EdgeIndex* activatingEdges = speculativeSim.getActivatedEdges(IG::Edge::eCONTACT_MANAGER);
+
+		for(PxU32 i = 0; i < nbActivatingEdges; ++i)
+		{
+			Sc::Interaction* interaction = mSimpleIslandManager->getInteraction(activatingEdges[i]);
+
+			if(interaction && !interaction->readInteractionFlag(InteractionFlag::eIS_ACTIVE))
+			{
+				if(speculativeSim.getEdge(activatingEdges[i]).isActive())
+				{
+					const bool proceed = activateInteraction(interaction, NULL);
+
+					if(proceed && (interaction->getType() < InteractionType::eTRACKED_IN_SCENE_COUNT))
+						notifyInteractionActivated(interaction);
+				}
+			}
+		}
+	}
+}
+
 void Sc::Scene::postIslandGen(PxBaseTask* continuationTask)
 {
 	PX_PROFILE_ZONE("Sim.postIslandGen", getContextId());
@@ -2664,6 +2702,36 @@ void Sc::Scene::postThirdPassIslandGen(PxBaseTask* continuation)
 	mNPhaseCore->processPersistentContactEvents(outputs, continuation);
 }
 
+// Runs all passes of island gen outside of a simulation step, after restoreContactState() changed the edges of the
+// island graph and the application changed the sleep states of the bodies. Islands end up the way the simulation step
+// that produced the restored state left them: islands with awake bodies are awake, the others are asleep.
+void Sc::Scene::restoreIslands()
+{
+	PX_PROFILE_ZONE("Sc::Scene::restoreIslands", getContextId());
+
+	mSimpleIslandManager->firstPassIslandGen();
+	mSimpleIslandManager->additionalSpeculativeActivation();
+	wakeInteractions();
+
+	mSimpleIslandManager->secondPassIslandGen();
+	wakeObjectsUp(ActorSim::AS_PART_OF_ISLAND_GEN);
+
+	// PT: the bodies the application restored as awake are not ready for sleeping at this point, so only islands of
+	// sleeping bodies get deactivated here
+	mSimpleIslandManager->thirdPassIslandGenImmediate();
+	putObjectsToSleep(ActorSim::AS_PART_OF_ISLAND_GEN);
+	putInteractionsToSleep();
+
+	// Awake bodies whose wake counter dropped to zero are ready for sleeping, like at the end of the simulation step
+	const PxU32 nbBodies = getActiveDynamicBodiesCount();
+	BodyCore*const* bodies = getActiveDynamicBodies();
+	for(PxU32 i=0;i<nbBodies;i++)
+	{
+		if(bodies[i]->getWakeCounter() == 0.0f)
+			bodies[i]->getSim()->notifyReadyForSleeping();
+	}
+}
+
 void Sc::Scene::processLostContacts(PxBaseTask* continuation)
 {
 	PX_PROFILE_ZONE("Sc::Scene::processLostContacts", getContextId());
@@ -4426,13 +4494,15 @@ Threading: called in the context of the user thread, but only after the physics
 */
 void Sc::Scene::fireQueuedContactCallbacks(bool asPartOfFlush)
 {
-	if(mSimulationEventCallback)
-	{
-		// if buffered shape removals occured, then the criteria for testing the contact stream for events with removed shape pointers needs to be more strict.
-		PX_ASSERT(asPartOfFlush || (mRemovedShapeCountAtSimStart <= mShapeIDTracker->getDeletedIDCount()));
-		bool reducedTestForRemovedShapes = asPartOfFlush || (mRemovedShapeCountAtSimStart == mShapeIDTracker->getDeletedIDCount());
-		const PxU32 removedShapeTestMask = PxU32(reducedTestForRemovedShapes ? ContactStreamManagerFlag::eTEST_FOR_REMOVED_SHAPES : (ContactStreamManagerFlag::eTEST_FOR_REMOVED_SHAPES | ContactStreamManagerFlag::eHAS_PAIRS_THAT_LOST_TOUCH));
+	// if buffered shape removals occured, then the criteria for testing the contact stream for events with removed shape pointers needs to be more strict.
+	PX_ASSERT(asPartOfFlush || (mRemovedShapeCountAtSimStart <= mShapeIDTracker->getDeletedIDCount()));
+	bool reducedTestForRemovedShapes = asPartOfFlush || (mRemovedShapeCountAtSimStart == mShapeIDTracker->getDeletedIDCount());
+	const PxU32 removedShapeTestMask = PxU32(reducedTestForRemovedShapes ? ContactStreamManagerFlag::eTEST_FOR_REMOVED_SHAPES : (ContactStreamManagerFlag::eTEST_FOR_REMOVED_SHAPES | ContactStreamManagerFlag::eHAS_PAIRS_THAT_LOST_TOUCH));
 
+	if(mContactReportRecords)
+		writeContactReportRecords(*mContactReportRecords, removedShapeTestMask);
+	else if(mSimulationEventCallback)
+	{
 		ActorPairReport*const* actorPairs = mNPhaseCore->getContactReportActorPairs();
 		PxU32 nbActorPairs = mNPhaseCore->getNbContactReportActorPairs();
 		for(PxU32 i=0; i < nbActorPairs; i++)
@@ -4460,6 +4530,118 @@ void Sc::Scene::fireQueuedContactCallbacks(bool asPartOfFlush)
 	}
 }
 
+/*
+Threading: called in the context of the user thread, but only after the physics thread has finished its run
+*/
+void Sc::Scene::writeContactReportRecords(PxContactReportRecords& records, PxU32 removedShapeTestMask)
+{
+	PX_UNUSED(removedShapeTestMask);	// PT: records do not reference shapes, so removed shapes need no special treatment
+
+	const ObjectIDTracker& rigidIDTracker = getRigidIDTracker();
+	const PxU16 eventMask = PxU16(PxU32(records.eventMask));
+	const PxReal minImpulse = records.minImpulse;
+
+	PxU32 nbRecords = 0;
+	PxU32 nbDroppedRecords = 0;
+
+	ActorPairReport*const* actorPairs = mNPhaseCore->getContactReportActorPairs();
+	const PxU32 nbActorPairs = mNPhaseCore->getNbContactReportActorPairs();
+	for(PxU32 i=0; i < nbActorPairs; i++)
+	{
+		if (i < (nbActorPairs - 1))
+			Ps::prefetchLine(actorPairs[i+1]);
+
+		ActorPairReport* aPair = actorPairs[i];
+		ContactStreamManager& cs = aPair->getContactStreamManager();
+		if (cs.getFlags() & ContactStreamManagerFlag::eINVALID_STREAM)
+			continue;
+
+		if (i + 1 < nbActorPairs)
+			Ps::prefetch(&(actorPairs[i+1]->getContactStreamManager()));
+
+		// Gather the shape pairs of the actor pair into one record
+		const ContactShapePair* shapePairs = cs.getShapePairs(mNPhaseCore->getContactReportPairData(cs.bufferIndex));
+		const PxU32 nbShapePairs = cs.currentPairCount;
+
+		PxU16 events = 0;
+		PxReal impulseSum = 0.0f;
+		PxReal maxImpulse = -1.0f;
+		PxVec3 weightedPointSum(0.0f);
+		PxVec3 pointSum(0.0f);
+		PxU32 nbPoints = 0;
+		PxVec3 normal(0.0f);
+		for(PxU32 j=0; j<nbShapePairs; j++)
+		{
+			const PxContactPair& pair = reinterpret_cast<const PxContactPair&>(shapePairs[j]);
+			events |= PxU16(PxU32(pair.events));
+			if(!pair.contactCount)
+				continue;
+
+			const bool hasImpulses = pair.flags & PxContactPairFlag::eINTERNAL_HAS_IMPULSES;
+			PxContactStreamIterator iter(pair.contactPatches, pair.contactPoints, pair.getInternalFaceIndices(), pair.patchCount, pair.contactCount);
+			PxU32 contactIndex = 0;
+			while(iter.hasNextPatch())
+			{
+				iter.nextPatch();
+				while(iter.hasNextContact())
+				{
+					iter.nextContact();
+					const PxReal impulse = hasImpulses ? pair.contactImpulses[contactIndex] : 0.0f;
+					contactIndex++;
+
+					const PxVec3 point = iter.getContactPoint();
+					weightedPointSum += point * impulse;
+					pointSum += point;
+					nbPoints++;
+					impulseSum += impulse;
+					if(impulse > maxImpulse)
+					{
+						maxImpulse = impulse;
+						normal = iter.getContactNormal();
+					}
+				}
+			}
+		}
+
+		// estimates for next frame
+		cs.maxPairCount = cs.currentPairCount;
+		cs.setMaxExtraDataSize(cs.extraDataSize);
+
+		if(!(events & eventMask) || impulseSum < minImpulse)
+			continue;
+
+		if(nbRecords == records.maxNbRecords)
+		{
+			nbDroppedRecords++;
+			continue;
+		}
+
+		if(records.actors0)
+			records.actors0[nbRecords] = rigidIDTracker.isDeletedID(aPair->getActorAID()) ? NULL : aPair->getPxActorA();
+		if(records.actors1)
+			records.actors1[nbRecords] = rigidIDTracker.isDeletedID(aPair->getActorBID()) ? NULL : aPair->getPxActorB();
+		if(records.points)
+		{
+			// Impulse-weighted average, or plain average when no contact carries an impulse (speculative or first-touch
+			// contacts, pairs without impulse reports)
+			if(impulseSum > 0.0f)
+				records.points[nbRecords] = weightedPointSum / impulseSum;
+			else
+				records.points[nbRecords] = nbPoints ? pointSum / PxReal(nbPoints) : PxVec3(0.0f);
+		}
+		if(records.normals)
+			records.normals[nbRecords] = normal;
+		if(records.impulses)
+			records.impulses[nbRecords] = impulseSum;
+		if(records.events)
+			records.events[nbRecords] = events;
+		nbRecords++;
+	}
+
+	records.nbRecords = nbRecords;
+	records.nbDroppedRecords = nbDroppedRecords;
+}
+
 PX_FORCE_INLINE void markDeletedShapes(Sc::ObjectIDTracker& idTracker, Sc::TriggerPairExtraData& tped, PxTriggerPair& pair)
 {
 	PxTriggerPairFlags::InternalType flags = 0;
@@ -4972,6 +5154,11 @@ void Sc::Scene::removeShape_(ShapeSim& shape, bool wakeOnLostTouch)
 
 	mNbGeometries[shape.getCore().getGeometryType()]--;
 	shape.removeFromBroadPhase(wakeOnLostTouch);
+
+	mShapeRemovalCount++;
+	if(mRestoredOverlaps.size())
+		removeRestoredOverlaps(shape);
+
 	mShapeSimPool->destroy(&shape);
 }
 
@@ -5176,7 +5363,76 @@ PxU32 Sc::Scene::getDefaultContactReportStreamBufferSize() const
 	return mNPhaseCore->getDefaultContactReportStreamBufferSize();
 }
 
+namespace
+{
+	const PxU32 ACTIVE_ACTORS_CHUNK_SIZE			= 1024;	// bodies per chunk of work
+	const PxU32 ACTIVE_ACTORS_PARALLEL_THRESHOLD	= 4*ACTIVE_ACTORS_CHUNK_SIZE;
+
+	// Builds the active (and frozen) actor lists in two passes over chunks of bodies. The first pass counts the active actors of
+	// each chunk, the second one writes the actors at offsets computed in between. The lists are thus in body order whatever the
+	// number of threads, as with a serial build.
+	class ActiveActorsJob : public ChunkedJob
+	{
+	public:
+		ActiveActorsJob(Sc::BodyCore*const* bodies, PxU32 nbBodies, PxU32* nbActivePerChunk, PxActor** activeActors, PxActor** frozenActors) :
+			ChunkedJob			(nbBodies, ACTIVE_ACTORS_CHUNK_SIZE),
+			mBodies				(bodies),
+			mNbActivePerChunk	(nbActivePerChunk),
+			mActiveActors		(activeActors),
+			mFrozenActors		(frozenActors)
+		{
+		}
+
+		virtual	void	process(PxU32 start, PxU32 end)
+		{
+			Sc::BodyCore*const* PX_RESTRICT bodies = mBodies;
+			const PxU32 chunk = start/getChunkSize();
+
+			if(!mActiveActors)
+			{
+				PxU32 nbActive = 0;
+				for(PxU32 i=start;i<end;i++)
+				{
+					if(!bodies[i]->isFrozen())
+						nbActive++;
+				}
+				mNbActivePerChunk[chunk] = nbActive;
+				return;
+			}
+
+			// PT: mNbActivePerChunk holds the offsets now. Bodies before the chunk that are not active are frozen.
+			PxActor** PX_RESTRICT activeActors = mActiveActors + mNbActivePerChunk[chunk];
+			PxActor** PX_RESTRICT frozenActors = mFrozenActors ? mFrozenActors + start - mNbActivePerChunk[chunk] : NULL;
+			for(PxU32 i=start;i<end;i++)
+			{
+				PxRigidActor* ra = static_cast<PxRigidActor*>(bodies[i]->getPxActor());
+				PX_ASSERT(ra);
+
+				if(!bodies[i]->isFrozen())
+					*activeActors++ = ra;
+				else if(frozenActors)
+					*frozenActors++ = ra;
+			}
+		}
+	private:
+		Sc::BodyCore*const*	mBodies;
+		PxU32*				mNbActivePerChunk;
+		PxActor**			mActiveActors;
+		PxActor**			mFrozenActors;
+	};
+}
+
 void Sc::Scene::buildActiveActors()
+{
+	buildActiveActorLists(false);
+}
+
+void Sc::Scene::buildActiveAndFrozenActors()
+{
+	buildActiveActorLists(true);
+}
+
+void Sc::Scene::buildActiveActorLists(bool buildFrozenActors)
 {
 	PxU32 numActiveBodies = 0;
 	BodyCore*const* PX_RESTRICT activeBodies;
@@ -5192,47 +5448,48 @@ void Sc::Scene::buildActiveActors()
 	}
 
 	mActiveActors.clear();
+	if(buildFrozenActors)
+		mFrozenActors.clear();
 
-	for(PxU32 i=0; i<numActiveBodies; i++)
+	PxCpuDispatcher* dispatcher = getTaskManager().getCpuDispatcher();
+	if(numActiveBodies<ACTIVE_ACTORS_PARALLEL_THRESHOLD || !dispatcher || !dispatcher->getWorkerCount())
 	{
-		if(!activeBodies[i]->isFrozen())
+		for(PxU32 i=0; i<numActiveBodies; i++)
 		{
 			PxRigidActor* ra = static_cast<PxRigidActor*>(activeBodies[i]->getPxActor());
 			PX_ASSERT(ra);
-			mActiveActors.pushBack(ra);
+
+			if(!activeBodies[i]->isFrozen())
+				mActiveActors.pushBack(ra);
+			else if(buildFrozenActors)
+				mFrozenActors.pushBack(ra);
 		}
+		return;
 	}
-}
 
-// PT: TODO: unify buildActiveActors & buildActiveAndFrozenActors
-void Sc::Scene::buildActiveAndFrozenActors()
-{
-	PxU32 numActiveBodies = 0;
-	BodyCore*const* PX_RESTRICT activeBodies;
-	if(!(getPublicFlags() & PxSceneFlag::eEXCLUDE_KINEMATICS_FROM_ACTIVE_ACTORS))
-	{
-		numActiveBodies = getNumActiveBodies();
-		activeBodies = getActiveBodiesArray();
-	}
-	else
-	{
-		numActiveBodies = getActiveDynamicBodiesCount();
-		activeBodies = getActiveDynamicBodies();
-	}
+	const PxU32 nbChunks = (numActiveBodies + ACTIVE_ACTORS_CHUNK_SIZE - 1)/ACTIVE_ACTORS_CHUNK_SIZE;
+	Ps::Array<PxU32> nbActivePerChunk;
+	nbActivePerChunk.resizeUninitialized(nbChunks);
 
-	mActiveActors.clear();
-	mFrozenActors.clear();
+	ActiveActorsJob* countJob = PX_NEW(ActiveActorsJob)(activeBodies, numActiveBodies, nbActivePerChunk.begin(), NULL, NULL);
+	countJob->run(dispatcher, ACTIVE_ACTORS_PARALLEL_THRESHOLD);
+	countJob->releaseRef();
 
-	for(PxU32 i=0; i<numActiveBodies; i++)
+	PxU32 nbActive = 0;
+	for(PxU32 i=0;i<nbChunks;i++)
 	{
-		PxRigidActor* ra = static_cast<PxRigidActor*>(activeBodies[i]->getPxActor());
-		PX_ASSERT(ra);
-
-		if(!activeBodies[i]->isFrozen())
-			mActiveActors.pushBack(ra);
-		else
-			mFrozenActors.pushBack(ra);
+		const PxU32 nb = nbActivePerChunk[i];
+		nbActivePerChunk[i] = nbActive;
+		nbActive += nb;
 	}
+
+	mActiveActors.resizeUninitialized(nbActive);
+	if(buildFrozenActors)
+		mFrozenActors.resizeUninitialized(numActiveBodies - nbActive);
+
+	ActiveActorsJob* writeJob = PX_NEW(ActiveActorsJob)(activeBodies, numActiveBodies, nbActivePerChunk.begin(), mActiveActors.begin(), buildFrozenActors ? mFrozenActors.begin() : NULL);
+	writeJob->run(dispatcher, ACTIVE_ACTORS_PARALLEL_THRESHOLD);
+	writeJob->releaseRef();
 }
 
 PxActor** Sc::Scene::getActiveActors(PxU32& nbActorsOut)
@@ -6148,35 +6405,11 @@ void Sc::Scene::secondPassNarrowPhase(PxBaseTask* /*continuation*/)
 	{
 		PX_PROFILE_ZONE("Sim.postIslandGen", getContextId());
 		mSimpleIslandManager->additionalSpeculativeActivation();
-		// wake interactions
-		{
-			PX_PROFILE_ZONE("ScScene.wakeInteractions", getContextId());
-			const IG::IslandSim& speculativeSim = mSimpleIslandManager->getSpeculativeIslandSim();
-
-			//KS - only wake contact managers based on speculative state to trigger contact gen. Waking actors based on accurate state
-			//should activate and joints.
-			{
-				PxU32 nbActivatingEdges = speculativeSim.getNbActivatedEdges(IG::Edge::eCONTACT_MANAGER);
-				const IG::EdgeIndex* activatingEdges = speculativeSim.getActivatedEdges(IG::Edge::eCONTACT_MANAGER);
-
-				for(PxU32 i = 0; i < nbActivatingEdges; ++i)
-				{
-					Sc::Interaction* interaction = mSimpleIslandManager->getInteraction(activatingEdges[i]);
-
-					if(interaction && !interaction->readInteractionFlag(InteractionFlag::eIS_ACTIVE))
-					{
-						if(speculativeSim.getEdge(activatingEdges[i]).isActive())
-						{
-							const bool proceed = activateInteraction(interaction, NULL);
-
-							if(proceed && (interaction->getType() < InteractionType::eTRACKED_IN_SCENE_COUNT))
-								notifyInteractionActivated(interaction);
-						}
-					}
-				}
-			}
-		}
+		wakeInteractions();
 	}
+	if(mHasPendingContactState)
+		applyPendingContactState();
+
 	mLLContext->secondPassUpdateContactManager(mDt, &mPostNarrowPhase); // Starts update of contact managers
 }
 
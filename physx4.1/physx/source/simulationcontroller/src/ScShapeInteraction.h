@@ -139,6 +139,7 @@ namespace Sc
 						void					updateState(const PxU8 externalDirtyFlags);
 
 						const PxsContactManager*	getContactManager() const { return mManager; }
+						PxsContactManager*		getContactManager() { return mManager; }
 
 						void					clearIslandGenData();
 
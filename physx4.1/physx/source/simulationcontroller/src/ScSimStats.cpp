@@ -124,6 +124,9 @@ void Sc::SimStats::readOut(PxSimulationStatistics& s, const PxvSimStats& simStat
 	s.nbNewTouches = simStats.mNbNewTouches;
 	s.nbLostTouches = simStats.mNbLostTouches;
 	s.nbPartitions = simStats.mNbPartitions;
+	s.partitionTime = simStats.mPartitionTime;
+	s.nbCCDPasses = simStats.mNbCCDPasses;
+	s.nbCCDHits = simStats.mNbCCDHits;
 
 #else
 	PX_UNUSED(s);
@@ -0,0 +1,753 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#include "foundation/PxMemory.h"
+#include "ScScene.h"
+#include "ScShapeInteraction.h"
+#include "ScNPhaseCore.h"
+#include "PxsContext.h"
+#include "PxsContactManager.h"
+#include "PxsNphaseImplementationContext.h"
+#include "PxsSimpleIslandManager.h"
+#include "GuPersistentContactManifold.h"
+#include "DyContext.h"
+#include "BpAABBManager.h"
+#include "PsHashMap.h"
+#include "PsSort.h"
+
+using namespace physx;
+
+// Persistent contact state of a scene, as stored in a simulation state snapshot: a header, the pairs of bodies that lost
+// touch in the last step and are woken up by the next one, then one record per shape pair found by the broad phase. A record holds the touch state of the pair and, when the pair has a contact manager, the status
+// of its narrow phase output, its narrow phase cache (PCM manifold or cached contact data) and the friction patches the
+// solver kept from the last frame. Records are keyed by shape pair and sized to multiples of 16 bytes, so that cached data
+// can be used in place once the records are copied back to the scene. A delta state replaces the records that did not
+// change since its base state with one bit each.
+//
+// On restore, the scene gets back the pairs of the records: pairs found since the snapshot was taken are released and pairs
+// lost since then are created again, without reports or wake ups. The broad phase does not know about it, so the next step
+// reconciles the overlaps it reports with these pairs, see reconcileRestoredOverlaps(). Touch states are restored the way
+// narrow phase touch events set them, which also restores the edges of the island graph. Cached data goes to the contact
+// managers that exist at that point. The rest is kept pending until the next simulation step, for the contact managers that
+// step creates when it wakes the bodies of the pairs up.
+
+namespace
+{
+	struct ContactStateHeader
+	{
+		PxU32	mNbRecords;
+		PxU32	mNbBaseRecords;		// delta states: number of records of the base state, followed by one bit per base record
+		PxU32	mShapeRemovalCount;	// records point to shapes, which is only valid as long as no shape is removed
+		PxU32	mIsDelta;
+		PxU32	mNbLostTouchPairs;
+		PxU32	mPad[3];
+	};
+	PX_COMPILE_TIME_ASSERT((sizeof(ContactStateHeader) & 15) == 0);
+
+	// PT: a NULL body has been removed before the snapshot was taken
+	struct LostTouchPair
+	{
+		Sc::BodySim*	mBody0;
+		Sc::BodySim*	mBody1;
+		PxU32			mBodyID0;
+		PxU32			mBodyID1;
+	};
+
+	struct RecordFlag
+	{
+		enum Enum
+		{
+			eHAS_MANAGER	= (1<<0),	// the pair had a contact manager, the record has payloads
+			ePENDING		= (1<<1),	// set on restore until the cached data is applied
+			eFOUND			= (1<<2)	// set on restore when the pair exists in the scene
+		};
+	};
+
+	// PT: written to zeroed memory, so that records can be compared bitwise
+	struct ContactStateRecord
+	{
+		Sc::ShapeSim*	mShape0;
+		Sc::ShapeSim*	mShape1;
+		PxU32			mRecordSize;		// including header and payloads
+		PxU16			mCacheSize;
+		PxU16			mFrictionPatchCount;
+		PxU8			mPairData;
+		PxU8			mManifoldFlags;
+		PxI8			mTouch;				// 1: touch, -1: no touch, 0: unknown
+		PxU8			mStatusFlag;		// PxsContactManagerOutput::statusFlag
+		PxU8			mNbPatches;
+		PxU8			mUnitStatusFlags;	// PxcNpWorkUnit::statusFlags
+		PxU8			mFlags;				// RecordFlag
+		PxU8			mPad;
+	};
+
+	typedef Ps::Pair<Sc::ShapeSim*, Sc::ShapeSim*>	ShapePair;
+
+	const PxU32 RECORD_HEADER_SIZE = (sizeof(ContactStateRecord) + 15) & ~15;
+
+	PX_FORCE_INLINE PxU32 align16(PxU32 size)
+	{
+		return (size + 15) & ~15;
+	}
+
+	PX_FORCE_INLINE PxU32 getBitmapSize(PxU32 nbRecords)
+	{
+		return align16(((nbRecords + 31) >> 5) * sizeof(PxU32));
+	}
+
+	PX_FORCE_INLINE ContactStateRecord* getNextRecord(ContactStateRecord* record)
+	{
+		return reinterpret_cast<ContactStateRecord*>(reinterpret_cast<PxU8*>(record) + record->mRecordSize);
+	}
+
+	PX_FORCE_INLINE const ContactStateRecord* getNextRecord(const ContactStateRecord* record)
+	{
+		return reinterpret_cast<const ContactStateRecord*>(reinterpret_cast<const PxU8*>(record) + record->mRecordSize);
+	}
+
+	PX_FORCE_INLINE PxU32 getLostTouchPairsSize(PxU32 nbPairs)
+	{
+		return align16(nbPairs * sizeof(LostTouchPair));
+	}
+
+	PX_FORCE_INLINE const PxU32* getBitmap(const PxU8* state)
+	{
+		const ContactStateHeader* header = reinterpret_cast<const ContactStateHeader*>(state);
+		return reinterpret_cast<const PxU32*>(state + sizeof(ContactStateHeader) + getLostTouchPairsSize(header->mNbLostTouchPairs));
+	}
+
+	PX_FORCE_INLINE const ContactStateRecord* getFirstRecord(const PxU8* state)
+	{
+		const ContactStateHeader* header = reinterpret_cast<const ContactStateHeader*>(state);
+		const PxU32 bitmapSize = header->mIsDelta ? getBitmapSize(header->mNbBaseRecords) : 0;
+		return reinterpret_cast<const ContactStateRecord*>(reinterpret_cast<const PxU8*>(getBitmap(state)) + bitmapSize);
+	}
+
+	PX_FORCE_INLINE bool isSingleManifold(const Gu::Cache& cache)
+	{
+		return cache.isManifold() && !cache.isMultiManifold();
+	}
+
+	PX_FORCE_INLINE PxU32 getSingleManifoldSize(Gu::Cache& cache)
+	{
+		return cache.getManifold().mCapacity == GU_SPHERE_MANIFOLD_CACHE_SIZE ? sizeof(Gu::SpherePersistentContactManifold) : sizeof(Gu::LargePersistentContactManifold);
+	}
+
+	PX_FORCE_INLINE PxU32 getCacheSize(Gu::Cache& cache)
+	{
+		if(isSingleManifold(cache))
+			return getSingleManifoldSize(cache);
+		return cache.mCachedData ? cache.mCachedSize : 0;
+	}
+
+	PX_FORCE_INLINE const PxU8* getCacheData(Gu::Cache& cache)
+	{
+		return isSingleManifold(cache) ? reinterpret_cast<const PxU8*>(&cache.getManifold()) : cache.mCachedData;
+	}
+
+	// Contact managers have no narrow phase cache until they are registered with the narrow phase
+	PX_FORCE_INLINE PxsContactManager* getRegisteredManager(Sc::ShapeInteraction* si)
+	{
+		PxsContactManager* cm = si->getContactManager();
+		return (cm && cm->getWorkUnit().mNpIndex != 0xFFffFFff) ? cm : NULL;
+	}
+
+	PX_FORCE_INLINE PxsContactManagerOutput& getManagerOutput(PxsNphaseImplementationContext* npContext, PxsContactManagerOutputIterator& outputs, PxU32 npIndex)
+	{
+		if(npIndex & PxsContactManagerBase::NEW_CONTACT_MANAGER_MASK)
+			return npContext->getNewContactManagerOutput(npIndex);
+		return outputs.getContactManager(npIndex);
+	}
+
+	// PT: independent from the order of the shapes, which changes with the actor types of the pair
+	PX_FORCE_INLINE ShapePair getShapePair(Sc::ShapeSim* shape0, Sc::ShapeSim* shape1)
+	{
+		return shape0 < shape1 ? ShapePair(shape0, shape1) : ShapePair(shape1, shape0);
+	}
+
+	PX_FORCE_INLINE PxI8 getTouch(const Sc::ShapeInteraction* si)
+	{
+		return PxI8(si->readFlag(Sc::ShapeInteraction::HAS_TOUCH) ? 1 : (si->readFlag(Sc::ShapeInteraction::HAS_NO_TOUCH) ? -1 : 0));
+	}
+
+	typedef Ps::HashMap<ShapePair, ContactStateRecord*> RecordMap;
+
+	// PT: the overlaps are sorted by element IDs, as the order of the hash map depends on the addresses of the shapes
+	struct OverlapLess
+	{
+		PX_FORCE_INLINE bool operator()(const Bp::AABBOverlap& left, const Bp::AABBOverlap& right) const
+		{
+			const PxU32 left0 = reinterpret_cast<Sc::ShapeSim*>(left.mUserData0)->getElementID();
+			const PxU32 right0 = reinterpret_cast<Sc::ShapeSim*>(right.mUserData0)->getElementID();
+			return left0 < right0 || (left0 == right0 && reinterpret_cast<Sc::ShapeSim*>(left.mUserData1)->getElementID() < reinterpret_cast<Sc::ShapeSim*>(right.mUserData1)->getElementID());
+		}
+	};
+
+	PxU32 getRecordSize(Sc::ShapeInteraction* si, PxsNphaseImplementationContext* npContext, PxU32 frictionPatchSize)
+	{
+		PxsContactManager* cm = getRegisteredManager(si);
+		if(!cm)
+			return RECORD_HEADER_SIZE;
+
+		const PxcNpWorkUnit& unit = cm->getWorkUnit();
+		Gu::Cache& cache = npContext->getContactManagerCache(unit.mNpIndex);
+		return RECORD_HEADER_SIZE + align16(getCacheSize(cache)) + align16(unit.frictionPatchCount * frictionPatchSize);
+	}
+
+	PxU32 writeRecord(PxU8* dst, Sc::ShapeInteraction* si, PxsNphaseImplementationContext* npContext, PxsContactManagerOutputIterator& outputs, PxU32 frictionPatchSize)
+	{
+		const PxU32 recordSize = getRecordSize(si, npContext, frictionPatchSize);
+		PxMemZero(dst, recordSize);
+
+		ContactStateRecord& record = *reinterpret_cast<ContactStateRecord*>(dst);
+		record.mShape0		= &si->getShape0();
+		record.mShape1		= &si->getShape1();
+		record.mRecordSize	= recordSize;
+		record.mTouch		= getTouch(si);
+
+		PxsContactManager* cm = getRegisteredManager(si);
+		if(cm)
+		{
+			const PxcNpWorkUnit& unit = cm->getWorkUnit();
+			Gu::Cache& cache = npContext->getContactManagerCache(unit.mNpIndex);
+			const PxsContactManagerOutput& output = getManagerOutput(npContext, outputs, unit.mNpIndex);
+			const PxU32 cacheSize = getCacheSize(cache);
+			const PxU32 frictionSize = unit.frictionPatchCount * frictionPatchSize;
+
+			record.mCacheSize			= Ps::to16(cacheSize);
+			record.mFrictionPatchCount	= unit.frictionPatchCount;
+			record.mPairData			= cache.mPairData;
+			record.mManifoldFlags		= cache.mManifoldFlags;
+			record.mStatusFlag			= output.statusFlag;
+			record.mNbPatches			= output.nbPatches;
+			record.mUnitStatusFlags		= unit.statusFlags;
+			record.mFlags				= RecordFlag::eHAS_MANAGER;
+
+			PxU8* payload = dst + RECORD_HEADER_SIZE;
+			if(cacheSize)
+				PxMemCopy(payload, getCacheData(cache), cacheSize);
+			if(frictionSize)
+				PxMemCopy(payload + align16(cacheSize), unit.frictionDataPtr, frictionSize);
+		}
+		return recordSize;
+	}
+
+	// A record can only be restored into a cache of the same format, for a pair with the shapes in the same order:
+	// the cached data is flipped otherwise.
+	PX_FORCE_INLINE bool isCompatible(const ContactStateRecord& record, Sc::ShapeInteraction* si, Gu::Cache& cache)
+	{
+		if(!(record.mFlags & RecordFlag::ePENDING) || record.mShape0 != &si->getShape0() || record.mManifoldFlags != cache.mManifoldFlags)
+			return false;
+		if(isSingleManifold(cache))
+			return record.mCacheSize == getSingleManifoldSize(cache);
+		return true;
+	}
+
+	void applyRecord(ContactStateRecord& record, Gu::Cache& cache, PxcNpWorkUnit& unit, PxsContactManagerOutput& output)
+	{
+		PxU8* payload = reinterpret_cast<PxU8*>(&record) + RECORD_HEADER_SIZE;
+		if(isSingleManifold(cache))
+		{
+			// The manifold points to its own contact buffer, which must survive the copy
+			Gu::PersistentContactManifold& manifold = cache.getManifold();
+			Gu::PersistentContact* contactPoints = manifold.mContactPoints;
+			PxMemCopy(&manifold, payload, record.mCacheSize);
+			manifold.mContactPoints = contactPoints;
+		}
+		else
+		{
+			cache.mCachedData = record.mCacheSize ? payload : NULL;
+			cache.mCachedSize = record.mCacheSize;
+		}
+		cache.mPairData = record.mPairData;
+
+		if(record.mFrictionPatchCount)
+			unit.frictionDataPtr = payload + align16(record.mCacheSize);
+		unit.frictionPatchCount = Ps::to8(record.mFrictionPatchCount);
+		unit.statusFlags = record.mUnitStatusFlags;
+
+		// PT: dirty, so that the pair runs the narrow phase again even if its bodies do not move
+		output.statusFlag = PxU8(record.mStatusFlag | PxsContactManagerStatusFlag::eDIRTY_MANAGER);
+		output.nbPatches = record.mNbPatches;
+
+		record.mFlags &= ~RecordFlag::ePENDING;
+	}
+
+	void resetCache(Gu::Cache& cache, PxcNpWorkUnit& unit)
+	{
+		if(isSingleManifold(cache))
+			cache.getManifold().clearManifold();
+		else
+		{
+			cache.mCachedData = NULL;
+			cache.mCachedSize = 0;
+		}
+		cache.mPairData = 0;
+		unit.frictionPatchCount = 0;
+	}
+
+	void buildRecordMap(RecordMap& recordMap, PxU8* buffer, PxU32 size)
+	{
+		for(ContactStateRecord* r = reinterpret_cast<ContactStateRecord*>(buffer); reinterpret_cast<PxU8*>(r) < buffer + size; r = getNextRecord(r))
+			recordMap.insert(getShapePair(r->mShape0, r->mShape1), r);
+	}
+
+	// Copies the records of a state, and of its base state for a delta, to a single buffer
+	void copyRecords(Ps::Array<PxU8>& records, const PxU8* state, const PxU8* baseState)
+	{
+		const ContactStateHeader* header = reinterpret_cast<const ContactStateHeader*>(state);
+		const ContactStateRecord* stateRecords = getFirstRecord(state);
+		const PxU32* bitmap = getBitmap(state);
+
+		PxU32 size = 0;
+		const ContactStateRecord* r = stateRecords;
+		for(PxU32 i=0;i<header->mNbRecords;i++, r = getNextRecord(r))
+			size += r->mRecordSize;
+		const PxU32 stateRecordsSize = size;
+
+		const ContactStateRecord* baseRecords = header->mIsDelta ? getFirstRecord(baseState) : NULL;
+		r = baseRecords;
+		for(PxU32 i=0;baseRecords && i<header->mNbBaseRecords;i++, r = getNextRecord(r))
+		{
+			if(bitmap[i>>5] & (1u << (i & 31)))
+				size += r->mRecordSize;
+		}
+
+		records.forceSize_Unsafe(0);
+		records.resizeUninitialized(size);
+		PxU8* dst = records.begin();
+		PxMemCopy(dst, stateRecords, stateRecordsSize);
+		dst += stateRecordsSize;
+
+		r = baseRecords;
+		for(PxU32 i=0;baseRecords && i<header->mNbBaseRecords;i++, r = getNextRecord(r))
+		{
+			if(bitmap[i>>5] & (1u << (i & 31)))
+			{
+				PxMemCopy(dst, r, r->mRecordSize);
+				dst += r->mRecordSize;
+			}
+		}
+	}
+}
+
+PxU32 Sc::Scene::getContactStateSize(const PxU8* baseState) const
+{
+	PxU32 size = sizeof(ContactStateHeader) + getLostTouchPairsSize(mLostTouchPairs.size());
+	if(baseState)
+		size += getBitmapSize(reinterpret_cast<const ContactStateHeader*>(baseState)->mNbRecords);
+
+	if(mUseGpuRigidBodies)
+		return size;
+
+	PxsNphaseImplementationContext* npContext = static_cast<PxsNphaseImplementationContext*>(mLLContext->getNphaseImplementationContext());
+	const PxU32 frictionPatchSize = Dy::getFrictionPatchSize();
+
+	Interaction*const* interactions = mInteractions[InteractionType::eOVERLAP].begin();
+	const PxU32 nbInteractions = mInteractions[InteractionType::eOVERLAP].size();
+	for(PxU32 i=0;i<nbInteractions;i++)
+		size += getRecordSize(static_cast<ShapeInteraction*>(interactions[i]), npContext, frictionPatchSize);
+	return size;
+}
+
+PxU32 Sc::Scene::saveContactState(PxU8* buffer, const PxU8* baseState) const
+{
+	PX_ASSERT((size_t(buffer) & 15) == 0);
+
+	const ContactStateHeader* baseHeader = reinterpret_cast<const ContactStateHeader*>(baseState);
+	const PxU32 nbBaseRecords = baseHeader ? baseHeader->mNbRecords : 0;
+	const PxU32 bitmapSize = baseHeader ? getBitmapSize(nbBaseRecords) : 0;
+
+	const PxU32 nbLostTouchPairs = mLostTouchPairs.size();
+	const PxU32 lostTouchPairsSize = getLostTouchPairsSize(nbLostTouchPairs);
+
+	ContactStateHeader* header = reinterpret_cast<ContactStateHeader*>(buffer);
+	PxMemZero(header, sizeof(ContactStateHeader) + lostTouchPairsSize);
+	header->mNbRecords			= 0;
+	header->mNbBaseRecords		= nbBaseRecords;
+	header->mShapeRemovalCount	= mShapeRemovalCount;
+	header->mIsDelta			= baseHeader ? 1u : 0u;
+	header->mNbLostTouchPairs	= nbLostTouchPairs;
+
+	LostTouchPair* lostTouchPairs = reinterpret_cast<LostTouchPair*>(buffer + sizeof(ContactStateHeader));
+	for(PxU32 i=0;i<nbLostTouchPairs;i++)
+	{
+		const SimpleBodyPair& pair = mLostTouchPairs[i];
+		lostTouchPairs[i].mBody0	= mLostTouchPairsDeletedBodyIDs.boundedTest(pair.body1ID) ? NULL : pair.body1;
+		lostTouchPairs[i].mBody1	= mLostTouchPairsDeletedBodyIDs.boundedTest(pair.body2ID) ? NULL : pair.body2;
+		lostTouchPairs[i].mBodyID0	= pair.body1ID;
+		lostTouchPairs[i].mBodyID1	= pair.body2ID;
+	}
+
+	PxU32* bitmap = reinterpret_cast<PxU32*>(buffer + sizeof(ContactStateHeader) + lostTouchPairsSize);
+	PxMemZero(bitmap, bitmapSize);
+
+	PxU8* dst = reinterpret_cast<PxU8*>(bitmap) + bitmapSize;
+	if(mUseGpuRigidBodies)
+		return PxU32(dst - buffer);
+
+	// PT: maps the pairs of the base state to their record index
+	typedef Ps::HashMap<ShapePair, PxU32> BaseRecordMap;
+	BaseRecordMap baseRecordMap;
+	Ps::Array<const ContactStateRecord*> baseRecords;
+	if(baseHeader)
+	{
+		baseRecords.reserve(nbBaseRecords);
+		const ContactStateRecord* r = getFirstRecord(baseState);
+		for(PxU32 i=0;i<nbBaseRecords;i++, r = getNextRecord(r))
+		{
+			baseRecords.pushBack(r);
+			baseRecordMap.insert(getShapePair(r->mShape0, r->mShape1), i);
+		}
+	}
+
+	PxsNphaseImplementationContext* npContext = static_cast<PxsNphaseImplementationContext*>(mLLContext->getNphaseImplementationContext());
+	PxsContactManagerOutputIterator outputs = npContext->getContactManagerOutputs();
+	const PxU32 frictionPatchSize = Dy::getFrictionPatchSize();
+
+	Interaction*const* interactions = mInteractions[InteractionType::eOVERLAP].begin();
+	const PxU32 nbInteractions = mInteractions[InteractionType::eOVERLAP].size();
+	for(PxU32 i=0;i<nbInteractions;i++)
+	{
+		ShapeInteraction* si = static_cast<ShapeInteraction*>(interactions[i]);
+		const PxU32 recordSize = writeRecord(dst, si, npContext, outputs, frictionPatchSize);
+
+		if(baseHeader)
+		{
+			const BaseRecordMap::Entry* entry = baseRecordMap.find(getShapePair(&si->getShape0(), &si->getShape1()));
+			if(entry && baseRecords[entry->second]->mRecordSize == recordSize && !memcmp(baseRecords[entry->second], dst, recordSize))
+			{
+				bitmap[entry->second>>5] |= 1u << (entry->second & 31);
+				continue;
+			}
+		}
+
+		dst += recordSize;
+		header->mNbRecords++;
+	}
+	return PxU32(dst - buffer);
+}
+
+bool Sc::Scene::isValidContactState(const PxU8* state, const PxU8* baseState) const
+{
+	const ContactStateHeader* header = reinterpret_cast<const ContactStateHeader*>(state);
+	if(header->mShapeRemovalCount != mShapeRemovalCount)
+		return false;
+	if(!header->mIsDelta)
+		return true;
+
+	const ContactStateHeader* baseHeader = reinterpret_cast<const ContactStateHeader*>(baseState);
+	return baseHeader && !baseHeader->mIsDelta && baseHeader->mNbRecords == header->mNbBaseRecords && baseHeader->mShapeRemovalCount == mShapeRemovalCount;
+}
+
+void Sc::Scene::restoreContactState(const PxU8* state, const PxU8* baseState)
+{
+	PX_ASSERT((size_t(state) & 15) == 0);
+	PX_ASSERT(isValidContactState(state, baseState));
+
+	mHasPendingContactState = false;
+
+	if(mUseGpuRigidBodies)
+	{
+		restoreIslands();
+		restoreLostTouchPairs(state);
+		return;
+	}
+
+	// The narrow phase and the solver of the next step read cached data and friction patches from this copy, then
+	// write their results to their own streams.
+	copyRecords(mRestoredContactData, state, baseState);
+	PxU8* records = mRestoredContactData.begin();
+	const PxU32 size = mRestoredContactData.size();
+	for(ContactStateRecord* r = reinterpret_cast<ContactStateRecord*>(records); reinterpret_cast<PxU8*>(r) < records + size; r = getNextRecord(r))
+	{
+		if(r->mFlags & RecordFlag::eHAS_MANAGER)
+			r->mFlags |= RecordFlag::ePENDING;
+	}
+
+	RecordMap recordMap;
+	buildRecordMap(recordMap, records, size);
+
+	const bool useAdaptiveForce = mPublicFlags & PxSceneFlag::eADAPTIVE_FORCE;
+	PxsNphaseImplementationContext* npContext = static_cast<PxsNphaseImplementationContext*>(mLLContext->getNphaseImplementationContext());
+	PxsContactManagerOutputIterator outputs = npContext->getContactManagerOutputs();
+
+	// Release the pairs found since the snapshot was taken
+	{
+		Ps::Array<ShapeInteraction*> releasedInteractions;
+		Interaction*const* interactions = mInteractions[InteractionType::eOVERLAP].begin();
+		const PxU32 nbInteractions = mInteractions[InteractionType::eOVERLAP].size();
+		for(PxU32 i=0;i<nbInteractions;i++)
+		{
+			ShapeInteraction* si = static_cast<ShapeInteraction*>(interactions[i]);
+			const RecordMap::Entry* entry = recordMap.find(getShapePair(&si->getShape0(), &si->getShape1()));
+			if(entry)
+				entry->second->mFlags |= RecordFlag::eFOUND;
+			else
+				releasedInteractions.pushBack(si);
+		}
+
+		for(PxU32 i=0;i<releasedInteractions.size();i++)
+		{
+			ShapeInteraction* si = releasedInteractions[i];
+			ShapeSim& shape0 = si->getShape0();
+			ShapeSim& shape1 = si->getShape1();
+
+			restoreTouchState(*si, -1, useAdaptiveForce);
+			mNPhaseCore->lostTouchReports(si, 0, 0, outputs, useAdaptiveForce);
+			mNPhaseCore->releaseElementPair(si, 0, 0, true, outputs, useAdaptiveForce);
+			toggleRestoredOverlap(shape0, shape1, false);
+		}
+	}
+
+	// Create the pairs lost since the snapshot was taken
+	for(ContactStateRecord* r = reinterpret_cast<ContactStateRecord*>(records); reinterpret_cast<PxU8*>(r) < records + size; r = getNextRecord(r))
+	{
+		if(!(r->mFlags & RecordFlag::eFOUND) && mNPhaseCore->createRbElementInteraction(*r->mShape0, *r->mShape1, NULL, NULL, NULL))
+			toggleRestoredOverlap(*r->mShape0, *r->mShape1, true);
+	}
+
+	// Restore touch states, then islands, which activate and deactivate pairs with their bodies
+	{
+		Interaction*const* interactions = mInteractions[InteractionType::eOVERLAP].begin();
+		const PxU32 nbInteractions = mInteractions[InteractionType::eOVERLAP].size();
+		for(PxU32 i=0;i<nbInteractions;i++)
+		{
+			ShapeInteraction* si = static_cast<ShapeInteraction*>(interactions[i]);
+			const RecordMap::Entry* entry = recordMap.find(getShapePair(&si->getShape0(), &si->getShape1()));
+			if(entry)
+				restoreTouchState(*si, entry->second->mTouch, useAdaptiveForce);
+		}
+	}
+	restoreIslands();
+
+	// Restore cached data
+	Interaction*const* interactions = mInteractions[InteractionType::eOVERLAP].begin();
+	const PxU32 nbInteractions = mInteractions[InteractionType::eOVERLAP].size();
+	for(PxU32 i=0;i<nbInteractions;i++)
+	{
+		ShapeInteraction* si = static_cast<ShapeInteraction*>(interactions[i]);
+		const RecordMap::Entry* entry = recordMap.find(getShapePair(&si->getShape0(), &si->getShape1()));
+		if(!entry)
+			continue;
+
+		ContactStateRecord& record = *entry->second;
+
+		PxsContactManager* cm = getRegisteredManager(si);
+		if(cm)
+		{
+			PxcNpWorkUnit& unit = cm->getWorkUnit();
+			Gu::Cache& cache = npContext->getContactManagerCache(unit.mNpIndex);
+			if(isCompatible(record, si, cache))
+				applyRecord(record, cache, unit, getManagerOutput(npContext, outputs, unit.mNpIndex));
+			else
+				resetCache(cache, unit);
+		}
+	}
+
+	for(ContactStateRecord* r = reinterpret_cast<ContactStateRecord*>(records); reinterpret_cast<PxU8*>(r) < records + size && !mHasPendingContactState; r = getNextRecord(r))
+		mHasPendingContactState = (r->mFlags & RecordFlag::ePENDING) != 0;
+
+	restoreLostTouchPairs(state);
+}
+
+// The pairs that lost touch in the step before the snapshot wake their bodies up in the next step. They replace the pairs
+// lost since then, as well as the pairs that lost touch because of the restore itself (released pairs, restored poses of
+// sleeping bodies), which must not wake bodies up.
+void Sc::Scene::restoreLostTouchPairs(const PxU8* state)
+{
+	const ContactStateHeader* header = reinterpret_cast<const ContactStateHeader*>(state);
+	const LostTouchPair* lostTouchPairs = reinterpret_cast<const LostTouchPair*>(state + sizeof(ContactStateHeader));
+
+	mLostTouchPairs.clear();
+	mLostTouchPairsDeletedBodyIDs.clear();
+	for(PxU32 i=0;i<header->mNbLostTouchPairs;i++)
+	{
+		const LostTouchPair& pair = lostTouchPairs[i];
+		const SimpleBodyPair p = { pair.mBody0, pair.mBody1, pair.mBodyID0, pair.mBodyID1 };
+		mLostTouchPairs.pushBack(p);
+		if(!pair.mBody0)
+			markReleasedBodyIDForLostTouch(pair.mBodyID0);
+		if(!pair.mBody1)
+			markReleasedBodyIDForLostTouch(pair.mBodyID1);
+	}
+}
+
+void Sc::Scene::applyPendingContactState()
+{
+	PX_ASSERT(mHasPendingContactState);
+	mHasPendingContactState = false;
+
+	PxsNphaseImplementationContext* npContext = static_cast<PxsNphaseImplementationContext*>(mLLContext->getNphaseImplementationContext());
+	PxsContactManagerOutputIterator outputs = npContext->getContactManagerOutputs();
+
+	RecordMap recordMap;
+	buildRecordMap(recordMap, mRestoredContactData.begin(), mRestoredContactData.size());
+
+	Interaction*const* interactions = mInteractions[InteractionType::eOVERLAP].begin();
+	const PxU32 nbInteractions = mActiveInteractionCount[InteractionType::eOVERLAP];
+	for(PxU32 i=0;i<nbInteractions;i++)
+	{
+		ShapeInteraction* si = static_cast<ShapeInteraction*>(interactions[i]);
+		PxsContactManager* cm = getRegisteredManager(si);
+		if(!cm || !(cm->getWorkUnit().mNpIndex & PxsContactManagerBase::NEW_CONTACT_MANAGER_MASK))
+			continue;
+
+		const RecordMap::Entry* entry = recordMap.find(getShapePair(&si->getShape0(), &si->getShape1()));
+		PxcNpWorkUnit& unit = cm->getWorkUnit();
+		Gu::Cache& cache = npContext->getContactManagerCache(unit.mNpIndex);
+		if(entry && isCompatible(*entry->second, si, cache))
+			applyRecord(*entry->second, cache, unit, getManagerOutput(npContext, outputs, unit.mNpIndex));
+	}
+}
+
+// Sets the touch state of a pair like narrow phase touch events do, including the edge of the island graph, without
+// sending reports or waking bodies up.
+void Sc::Scene::restoreTouchState(ShapeInteraction& si, PxI32 touch, bool useAdaptiveForce)
+{
+	if(touch > 0 && !si.hasTouch())
+	{
+		mNPhaseCore->managerNewTouch(si);
+		si.setHasTouch();
+		si.adjustCountersOnNewTouch(useAdaptiveForce);
+
+		if(si.isReportPair())
+		{
+			const PxU32 pairFlags = si.getPairFlags();
+			if(!si.readInteractionFlag(InteractionFlag::eIS_ACTIVE))
+			{
+				if(pairFlags & PxPairFlag::eNOTIFY_TOUCH_PERSISTS)
+					si.raiseFlag(ShapeInteraction::WAS_IN_PERSISTENT_EVENT_LIST);
+			}
+			else if(pairFlags & PxPairFlag::eNOTIFY_TOUCH_PERSISTS)
+				mNPhaseCore->addToPersistentContactEventPairs(&si);
+			else if(pairFlags & ShapeInteraction::CONTACT_FORCE_THRESHOLD_PAIRS)
+				mNPhaseCore->addToForceThresholdContactEventPairs(&si);
+		}
+
+		if(!si.readFlag(ShapeInteraction::CONTACTS_RESPONSE_DISABLED))
+			mSimpleIslandManager->setEdgeConnected(si.getEdgeIndex());
+	}
+	else if(touch <= 0 && si.hasTouch())
+	{
+		if(si.readFlag(ShapeInteraction::IS_IN_CONTACT_EVENT_LIST))
+		{
+			si.removeFromReportPairList();
+			si.clearFlag(ShapeInteraction::FORCE_THRESHOLD_EXCEEDED_FLAGS);
+		}
+		si.clearFlag(ShapeInteraction::WAS_IN_PERSISTENT_EVENT_LIST);
+		si.setHasNoTouch();
+		si.adjustCountersOnLostTouch(si.getShape0().getBodySim(), si.getShape1().getBodySim(), useAdaptiveForce);
+		mSimpleIslandManager->setEdgeDisconnected(si.getEdgeIndex());
+	}
+
+	if(touch < 0)
+		si.setHasNoTouch();
+	else if(!touch)
+		si.clearFlag(ShapeInteraction::TOUCH_KNOWN);
+}
+
+// Records a pair that restoreContactState() created (inScene) or released without telling the broad phase. Doing the
+// opposite later on the same pair cancels it.
+void Sc::Scene::toggleRestoredOverlap(ShapeSim& shape0, ShapeSim& shape1, bool inScene)
+{
+	const ShapePair pair = getShapePair(&shape0, &shape1);
+	const RestoredOverlapMap::Entry* entry = mRestoredOverlaps.find(pair);
+	if(entry)
+	{
+		PX_ASSERT(entry->second != inScene);
+		mRestoredOverlaps.erase(pair);
+	}
+	else
+		mRestoredOverlaps.insert(pair, inScene);
+}
+
+// The first broad phase update after a restore reports overlaps against the pairs of the scene before the restore.
+// Turn them into overlaps against the restored pairs, as the broad phase would have reported them after the snapshot:
+// - created pairs that the restore created already are dropped, and so are lost pairs that it released already.
+// - restored pairs that the broad phase does not report as created are lost, and released pairs that it does not
+//   report as lost are created.
+void Sc::Scene::reconcileRestoredOverlaps()
+{
+	Ps::Array<Bp::AABBOverlap>& createdOverlaps = mAABBManager->getCreatedOverlapArray(Bp::ElementType::eSHAPE);
+	Ps::Array<Bp::AABBOverlap>& destroyedOverlaps = mAABBManager->getDestroyedOverlapArray(Bp::ElementType::eSHAPE);
+
+	Ps::Array<Bp::AABBOverlap>* overlaps[2] = { &destroyedOverlaps, &createdOverlaps };
+	for(PxU32 a=0;a<2;a++)
+	{
+		Ps::Array<Bp::AABBOverlap>& array = *overlaps[a];
+		PxU32 nbKept = 0;
+		for(PxU32 i=0;i<array.size();i++)
+		{
+			const ShapePair pair = getShapePair(reinterpret_cast<ShapeSim*>(array[i].mUserData0), reinterpret_cast<ShapeSim*>(array[i].mUserData1));
+			const RestoredOverlapMap::Entry* entry = mRestoredOverlaps.find(pair);
+			if(entry)
+			{
+				PX_ASSERT(entry->second == (a == 1));
+				mRestoredOverlaps.erase(pair);
+			}
+			else
+				array[nbKept++] = array[i];
+		}
+		array.forceSize_Unsafe(nbKept);
+	}
+
+	const PxU32 nbDestroyed = destroyedOverlaps.size();
+	const PxU32 nbCreated = createdOverlaps.size();
+	for(RestoredOverlapMap::Iterator iter = mRestoredOverlaps.getIterator(); !iter.done(); ++iter)
+	{
+		ShapeSim* shape0 = iter->first.first;
+		ShapeSim* shape1 = iter->first.second;
+		if(shape1->getElementID() < shape0->getElementID())
+			Ps::swap(shape0, shape1);
+		Bp::AABBOverlap overlap(shape0, shape1);
+		overlap.mPairUserData = NULL;
+		if(iter->second)
+			destroyedOverlaps.pushBack(overlap);
+		else
+			createdOverlaps.pushBack(overlap);
+	}
+	mRestoredOverlaps.clear();
+
+	Ps::sort(destroyedOverlaps.begin() + nbDestroyed, destroyedOverlaps.size() - nbDestroyed, OverlapLess());
+	Ps::sort(createdOverlaps.begin() + nbCreated, createdOverlaps.size() - nbCreated, OverlapLess());
+}
+
+// The pairs of a removed shape are released with it, and the broad phase drops its overlaps.
+void Sc::Scene::removeRestoredOverlaps(ShapeSim& shape)
+{
+	Ps::Array<ShapePair> pairs;
+	for(RestoredOverlapMap::Iterator iter = mRestoredOverlaps.getIterator(); !iter.done(); ++iter)
+	{
+		if(iter->first.first == &shape || iter->first.second == &shape)
+			pairs.pushBack(iter->first);
+	}
+	for(PxU32 i=0;i<pairs.size();i++)
+		mRestoredOverlaps.erase(pairs[i]);
+}
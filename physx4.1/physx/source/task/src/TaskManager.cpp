@@ -38,6 +38,7 @@
 
 #define DOT_LOG 0
 
+// Only guards the name map, the task and dependency tables are lock-free.
 #define LOCK()  shdfnd::Mutex::ScopedLock __lock__(mMutex)
 
 namespace physx
@@ -45,43 +46,172 @@ namespace physx
     const int EOL = -1;
 	typedef shdfnd::HashMap<const char *, PxTaskID> PxTaskNameToIDMap;
 
+	/*
+	 * Append-only table with stable row addresses. Rows live in fixed-size chunks that are never
+	 * moved or freed before destruction, so rows can be added by one thread while other threads
+	 * read and update existing rows. Chunks are kept across clear() and reused the next frame.
+	 * Chunks are reached through a two-level directory whose blocks are also allocated on demand,
+	 * so the table grows up to MAX_ROWS rows without reserving the whole directory upfront.
+	 */
+	template<class T>
+	class PxTaskChunkedTable
+	{
+		PX_NOCOPY(PxTaskChunkedTable)
+	public:
+		static const uint32_t CHUNK_SHIFT = 10;
+		static const uint32_t CHUNK_SIZE = 1 << CHUNK_SHIFT;
+		static const uint32_t DIR_SHIFT = 10;
+		static const uint32_t DIR_SIZE = 1 << DIR_SHIFT;
+		static const uint32_t MAX_DIRS = 1024;
+		static const uint32_t MAX_ROWS = MAX_DIRS << ( DIR_SHIFT + CHUNK_SHIFT );	// 2^30, row indices also fit the int dependency links
+		static const uint32_t INVALID_ROW = 0xffffffff;
+
+		PxTaskChunkedTable() : mSize(0)
+		{
+			for( uint32_t i = 0 ; i < MAX_DIRS ; i++ )
+				mDirs[ i ] = NULL;
+		}
+
+		~PxTaskChunkedTable()
+		{
+			for( uint32_t i = 0 ; i < MAX_DIRS ; i++ )
+			{
+				volatile void** dir = getDir( i );
+				if( !dir )
+					continue;
+				for( uint32_t j = 0 ; j < DIR_SIZE ; j++ )
+				{
+					if( dir[ j ] )
+						PX_FREE( const_cast<void*>( dir[ j ] ) );
+				}
+				PX_FREE( dir );
+			}
+		}
+
+		/* Reserve a new row and return its index, or INVALID_ROW if the table is full. Safe to call concurrently. */
+		uint32_t allocate()
+		{
+			const uint32_t index = uint32_t( shdfnd::atomicIncrement( &mSize ) - 1 );
+			if( index >= MAX_ROWS )
+			{
+				shdfnd::atomicDecrement( &mSize );
+				return INVALID_ROW;
+			}
+
+			volatile void** dir = getOrCreate( &mDirs[ index >> ( DIR_SHIFT + CHUNK_SHIFT ) ], sizeof(void*) * DIR_SIZE, true );
+			getOrCreate( &dir[ ( index >> CHUNK_SHIFT ) & ( DIR_SIZE - 1 ) ], sizeof(T) * CHUNK_SIZE, false );
+			return index;
+		}
+
+		PX_FORCE_INLINE T& operator[]( uint32_t index )
+		{
+			PX_ASSERT( index < size() );
+			return getChunk( index )[ index & ( CHUNK_SIZE - 1 ) ];
+		}
+
+		PX_FORCE_INLINE const T& operator[]( uint32_t index ) const
+		{
+			PX_ASSERT( index < size() );
+			return getChunk( index )[ index & ( CHUNK_SIZE - 1 ) ];
+		}
+
+		PX_FORCE_INLINE uint32_t size() const
+		{
+			// a failing allocate() can briefly push mSize past MAX_ROWS before restoring it
+			const uint32_t size = uint32_t( mSize );
+			return size < MAX_ROWS ? size : MAX_ROWS;
+		}
+
+		/* Not thread safe, only called between frames. */
+		void clear()
+		{
+			mSize = 0;
+		}
+
+	private:
+		/* Return the block stored in 'slot', installing a new one if there is none yet. */
+		static volatile void** getOrCreate( volatile void** slot, size_t size, bool isDir )
+		{
+			void* block = const_cast<void*>( *slot );
+			if( !block )
+			{
+				void* newBlock = PX_ALLOC( size, "PxTaskChunkedTable" );
+				if( isDir )
+				{
+					volatile void** dir = reinterpret_cast<volatile void**>( newBlock );
+					for( uint32_t i = 0 ; i < DIR_SIZE ; i++ )
+						dir[ i ] = NULL;
+				}
+				block = shdfnd::atomicCompareExchangePointer( slot, newBlock, NULL );
+				if( block )
+				{
+					// another thread installed the block first
+					PX_FREE( newBlock );
+				}
+				else
+				{
+					block = newBlock;
+				}
+			}
+			return reinterpret_cast<volatile void**>( block );
+		}
+
+		PX_FORCE_INLINE volatile void** getDir( uint32_t dir ) const
+		{
+			return reinterpret_cast<volatile void**>( const_cast<void*>( mDirs[ dir ] ) );
+		}
+
+		PX_FORCE_INLINE T* getChunk( uint32_t index ) const
+		{
+			volatile void** dir = getDir( index >> ( DIR_SHIFT + CHUNK_SHIFT ) );
+			return reinterpret_cast<T*>( const_cast<void*>( dir[ ( index >> CHUNK_SHIFT ) & ( DIR_SIZE - 1 ) ] ) );
+		}
+
+		volatile void*		mDirs[ MAX_DIRS ];
+		volatile int32_t	mSize;
+	};
+
 	struct PxTaskDepTableRow
 	{
 		PxTaskID    mTaskID;
 		int       mNextDep;
 	};
-	typedef shdfnd::Array<PxTaskDepTableRow> PxTaskDepTable;
+	typedef PxTaskChunkedTable<PxTaskDepTableRow> PxTaskDepTable;
 
 	class PxTaskTableRow
 	{
 	public:
-		PxTaskTableRow() : mRefCount( 1 ), mStartDep(EOL), mLastDep(EOL) {}
-		void addDependency( PxTaskDepTable& depTable, PxTaskID taskID )
+		PxTaskTableRow( PxTask* task, PxTaskType::Enum type ) : mTask( task ), mRefCount( 1 ), mType( type ), mStartDep(EOL) {}
+
+		/* Push the dependency at the head of this row's list, safe against concurrent additions.
+		 * The list is reversed when the task is resolved, so dependencies are still dispatched in
+		 * the order they were added. Returns false if the dependency table is full. */
+		bool addDependency( PxTaskDepTable& depTable, PxTaskID taskID )
 		{
-			int newDep = int(depTable.size());
-			PxTaskDepTableRow row;
+			const uint32_t newIndex = depTable.allocate();
+			if( newIndex == PxTaskDepTable::INVALID_ROW )
+				return false;
+
+			const int newDep = int(newIndex);
+			PxTaskDepTableRow& row = depTable[ newIndex ];
 			row.mTaskID = taskID;
-			row.mNextDep = EOL;
-			depTable.pushBack( row );
 
-			if( mLastDep == EOL )
-			{
-				mStartDep = mLastDep = newDep;
-			}
-			else
+			int head;
+			do
 			{
-				depTable[ uint32_t(mLastDep) ].mNextDep = newDep;
-				mLastDep = newDep;
+				head = mStartDep;
+				row.mNextDep = head;
 			}
+			while( shdfnd::atomicCompareExchange( &mStartDep, newDep, head ) != head );
+			return true;
 		}
 
 		PxTask *    mTask;
 		volatile int mRefCount;
-		PxTaskType::Enum mType;
-		int       mStartDep;
-		int       mLastDep;
+		volatile int mType;		// PxTaskType::Enum, swapped to TT_COMPLETED exactly once on dispatch
+		volatile int mStartDep;
 	};
-	typedef shdfnd::Array<PxTaskTableRow> PxTaskTable;
+	typedef PxTaskChunkedTable<PxTaskTableRow> PxTaskTable;
 
 
 /* Implementation of PxTaskManager abstract API */
@@ -114,6 +244,7 @@ public:
 
 	void    dispatchTask( PxTaskID taskID );
 	void    resolveRow( PxTaskID taskID );
+	PxTaskID addRow( PxTask* task, PxTaskType::Enum type );
 
 	void    release();
 
@@ -133,7 +264,7 @@ public:
 	volatile int			 mPendingTasks;
     shdfnd::Mutex            mMutex;
 
-	PxTaskDepTable				 mDepTable;
+	PxTaskDepTable			 mDepTable;
 	PxTaskTable				 mTaskTable;
 
 	shdfnd::Array<PxTaskID>	 mStartDispatch;
@@ -148,8 +279,6 @@ PxTaskMgr::PxTaskMgr(PxErrorCallback& errorCallback, PxCpuDispatcher* cpuDispatc
 	: mErrorCallback (errorCallback)
 	, mCpuDispatcher( cpuDispatcher )
 	, mPendingTasks( 0 )
-	, mDepTable(PX_DEBUG_EXP("PxTaskDepTable"))
-	, mTaskTable(PX_DEBUG_EXP("PxTaskTable"))	
 	, mStartDispatch(PX_DEBUG_EXP("StartDispatch"))
 {
 }
@@ -258,7 +387,6 @@ PxTaskID PxTaskMgr::getNamedTask( const char *name )
 
 PxTask* PxTaskMgr::getTaskFromID( PxTaskID id )
 {
-	LOCK(); // todo: reader lock necessary?
 	return mTaskTable[ id ].mTask;
 }
 
@@ -281,27 +409,30 @@ PxTaskID PxTaskMgr::submitNamedTask( PxTask *task, const char *name, PxTaskType:
 		if( task )
 		{
 			/* name was registered for us by a dependent task */
-			PX_ASSERT( !mTaskTable[ prereg ].mTask );
-			PX_ASSERT( mTaskTable[ prereg ].mType == PxTaskType::TT_NOT_PRESENT );
-			mTaskTable[ prereg ].mTask = task;
-			mTaskTable[ prereg ].mType = type;
+			PxTaskTableRow& row = mTaskTable[ prereg ];
+			PX_ASSERT( !row.mTask );
+			row.mTask = task;
 			task->mTaskID = prereg;
+
+			/* the placeholder may already have been resolved by a concurrent dispatch */
+			if( shdfnd::atomicCompareExchange( &row.mType, type, PxTaskType::TT_NOT_PRESENT ) != PxTaskType::TT_NOT_PRESENT )
+			{
+				mErrorCallback.reportError(PxErrorCode::eDEBUG_WARNING, "PxTask submitted after its name was dispatched", __FILE__, __LINE__);
+			}
 		}
 		return prereg;
     }
     else
     {
+        PxTaskID id = addRow( task, type );
+        if( id == PxTaskTable::INVALID_ROW )
+            return id;
         shdfnd::atomicIncrement(&mPendingTasks);
-        PxTaskID id = static_cast<PxTaskID>(mTaskTable.size());
         mName2IDmap[ name ] = id;
         if( task )
 		{
             task->mTaskID = id;
 		}
-        PxTaskTableRow r;
-        r.mTask = task;
-        r.mType = type;
-		mTaskTable.pushBack(r);
         return id;
     }
 }
@@ -311,17 +442,12 @@ PxTaskID PxTaskMgr::submitNamedTask( PxTask *task, const char *name, PxTaskType:
  */
 PxTaskID PxTaskMgr::submitUnnamedTask( PxTask& task, PxTaskType::Enum type )
 {
-    shdfnd::atomicIncrement(&mPendingTasks);
-
 	task.mTm = this;
     task.submitted();
     
-	LOCK();
-    task.mTaskID = static_cast<PxTaskID>(mTaskTable.size());
-    PxTaskTableRow r;
-    r.mTask = &task;
-    r.mType = type;
-    mTaskTable.pushBack(r);
+    task.mTaskID = addRow( &task, type );
+    if( task.mTaskID != PxTaskTable::INVALID_ROW )
+        shdfnd::atomicIncrement(&mPendingTasks);
     return task.mTaskID;
 }
 
@@ -333,23 +459,41 @@ PxTaskID PxTaskMgr::submitUnnamedTask( PxTask& task, PxTaskType::Enum type )
  */
 void PxTaskMgr::taskCompleted( PxTask& task )
 {
-    LOCK();
 	resolveRow(task.mTaskID);
 }
 
 /* ================== Private Functions ======================= */
 
+/*
+ * Append a row to the task table, safe to call concurrently.
+ */
+PxTaskID PxTaskMgr::addRow( PxTask* task, PxTaskType::Enum type )
+{
+	const PxTaskID id = static_cast<PxTaskID>(mTaskTable.allocate());
+	if( id == PxTaskTable::INVALID_ROW )
+	{
+		mErrorCallback.reportError(PxErrorCode::eOUT_OF_MEMORY, "PxTaskManager: too many tasks submitted in one frame", __FILE__, __LINE__);
+		return id;
+	}
+	PX_PLACEMENT_NEW( &mTaskTable[ id ], PxTaskTableRow )( task, type );
+	return id;
+}
+
 /*
  * Add a dependency to force 'task' to complete before the
  * referenced 'taskID' is allowed to be dispatched.
  */
 void PxTaskMgr::finishBefore( PxTask& task, PxTaskID taskID )
 {
-    LOCK();
 	PX_ASSERT( mTaskTable[ taskID ].mType != PxTaskType::TT_COMPLETED );
 
-    mTaskTable[ task.mTaskID ].addDependency( mDepTable, taskID );
+	// the reference must be taken before the dependency becomes visible to resolveRow()
 	shdfnd::atomicIncrement( &mTaskTable[ taskID ].mRefCount );
+    if( !mTaskTable[ task.mTaskID ].addDependency( mDepTable, taskID ) )
+	{
+		mErrorCallback.reportError(PxErrorCode::eOUT_OF_MEMORY, "PxTaskManager: too many task dependencies in one frame", __FILE__, __LINE__);
+		decrReference( taskID );
+	}
 }
 
 
@@ -359,27 +503,27 @@ void PxTaskMgr::finishBefore( PxTask& task, PxTaskID taskID )
  */
 void PxTaskMgr::startAfter( PxTask& task, PxTaskID taskID )
 {
-    LOCK();
 	PX_ASSERT( mTaskTable[ taskID ].mType != PxTaskType::TT_COMPLETED );
 
-    mTaskTable[ taskID ].addDependency( mDepTable, task.mTaskID );
 	shdfnd::atomicIncrement( &mTaskTable[ task.mTaskID ].mRefCount );
+    if( !mTaskTable[ taskID ].addDependency( mDepTable, task.mTaskID ) )
+	{
+		mErrorCallback.reportError(PxErrorCode::eOUT_OF_MEMORY, "PxTaskManager: too many task dependencies in one frame", __FILE__, __LINE__);
+		decrReference( task.mTaskID );
+	}
 }
 
 
 void PxTaskMgr::addReference( PxTaskID taskID )
 {
-    LOCK();
     shdfnd::atomicIncrement( &mTaskTable[ taskID ].mRefCount );
 }
 
 /*
- * Remove one reference count from a task. Must be done here to make it thread safe.
+ * Remove one reference count from a task. The decrement that reaches zero dispatches the task.
  */
 void PxTaskMgr::decrReference( PxTaskID taskID )
 {
-    LOCK();
-
     if( !shdfnd::atomicDecrement( &mTaskTable[ taskID ].mRefCount ) )
     {
 		dispatchTask(taskID);
@@ -398,20 +542,31 @@ int32_t PxTaskMgr::getReference(PxTaskID taskID) const
  */
 void PxTaskMgr::resolveRow( PxTaskID taskID )
 {
-    int depRow = mTaskTable[ taskID ].mStartDep;
-
+    // Dependencies were pushed at the head of the list. Nothing can be added to a resolved
+    // task, so the list is reversed in place to dispatch them in the order they were added.
+    int depRow = EOL;
+    int nextRow = mTaskTable[ taskID ].mStartDep;
+    while( nextRow != EOL )
+    {
+        PxTaskDepTableRow& row = mDepTable[ uint32_t(nextRow) ];
+        const int current = nextRow;
+        nextRow = row.mNextDep;
+        row.mNextDep = depRow;
+        depRow = current;
+    }
 
     while( depRow != EOL )
     {
         PxTaskDepTableRow& row = mDepTable[ uint32_t(depRow) ];
         PxTaskTableRow& dtt = mTaskTable[ row.mTaskID ];
 
+        // read the link before dispatching, the dependent task may run inline on this thread
+        depRow = row.mNextDep;
+
         if( !shdfnd::atomicDecrement( &dtt.mRefCount ) )
 		{
 			dispatchTask( row.mTaskID );
 		}
-
-        depRow = row.mNextDep;
     }
 
     shdfnd::atomicDecrement( &mPendingTasks );
@@ -422,17 +577,12 @@ void PxTaskMgr::resolveRow( PxTaskID taskID )
  */
 void PxTaskMgr::dispatchTask( PxTaskID taskID )
 {
-	LOCK(); // todo: reader lock necessary?
     PxTaskTableRow& tt = mTaskTable[ taskID ];
 
-    // prevent re-submission
-    if( tt.mType == PxTaskType::TT_COMPLETED )
-    {		
-		mErrorCallback.reportError(PxErrorCode::eDEBUG_WARNING, "PxTask dispatched twice", __FILE__, __LINE__);
-		return;
-    }
+    // prevent re-submission, only the first dispatch sees the original type
+    const int type = shdfnd::atomicExchange( &tt.mType, PxTaskType::TT_COMPLETED );
 
-    switch ( tt.mType )
+    switch ( type )
     {
     case PxTaskType::TT_CPU:
         mCpuDispatcher->submitTask( *tt.mTask );
@@ -444,13 +594,13 @@ void PxTaskMgr::dispatchTask( PxTaskID taskID )
         resolveRow( taskID );
 		break;
 	case PxTaskType::TT_COMPLETED:
+		mErrorCallback.reportError(PxErrorCode::eDEBUG_WARNING, "PxTask dispatched twice", __FILE__, __LINE__);
+		break;
     default:
         mErrorCallback.reportError(PxErrorCode::eDEBUG_WARNING, "Unknown task type", __FILE__, __LINE__);
         resolveRow( taskID );
         break;
     }
-
-    tt.mType = PxTaskType::TT_COMPLETED;
 }
 
 }// end physx namespace